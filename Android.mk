@@ -21,15 +21,23 @@ IGNORED_WARNINGS := -Wno-sign-compare -Wno-unused-parameter -Wno-sign-promo
 CC_LITE_SRC_FILES := \
     src/google/protobuf/stubs/common.cc                              \
     src/google/protobuf/stubs/once.cc                                \
+    src/google/protobuf/stubs/closure_pool.cc                        \
     src/google/protobuf/stubs/hash.cc                                \
     src/google/protobuf/stubs/hash.h                                 \
     src/google/protobuf/stubs/map-util.h                             \
     src/google/protobuf/stubs/stl_util-inl.h                         \
+    src/google/protobuf/allocation_profiler.cc                       \
     src/google/protobuf/extension_set.cc                             \
     src/google/protobuf/generated_message_util.cc                    \
+    src/google/protobuf/map_field.cc                                 \
+    src/google/protobuf/message_batch.cc                             \
     src/google/protobuf/message_lite.cc                              \
+    src/google/protobuf/message_profiler.cc                          \
     src/google/protobuf/repeated_field.cc                            \
+    src/google/protobuf/repeated_string_piece_field.cc               \
+    src/google/protobuf/slab_repeated_field.cc                       \
     src/google/protobuf/wire_format_lite.cc                          \
+    src/google/protobuf/wire_patch.cc                                \
     src/google/protobuf/io/coded_stream.cc                           \
     src/google/protobuf/io/coded_stream_inl.h                        \
     src/google/protobuf/io/zero_copy_stream.cc                       \
@@ -50,6 +58,8 @@ JAVA_LITE_SRC_FILES := \
     java/src/main/java/com/google/protobuf/GeneratedMessageLite.java
 
 COMPILER_SRC_FILES :=  \
+    src/google/protobuf/allocation_profiler.cc \
+    src/google/protobuf/columnar.cc \
     src/google/protobuf/descriptor.cc \
     src/google/protobuf/descriptor.pb.cc \
     src/google/protobuf/descriptor_database.cc \
@@ -58,15 +68,21 @@ COMPILER_SRC_FILES :=  \
     src/google/protobuf/extension_set_heavy.cc \
     src/google/protobuf/generated_message_reflection.cc \
     src/google/protobuf/generated_message_util.cc \
+    src/google/protobuf/map_field.cc \
     src/google/protobuf/message.cc \
+    src/google/protobuf/message_batch.cc \
     src/google/protobuf/message_lite.cc \
+    src/google/protobuf/message_profiler.cc \
     src/google/protobuf/reflection_ops.cc \
     src/google/protobuf/repeated_field.cc \
+    src/google/protobuf/repeated_string_piece_field.cc \
+    src/google/protobuf/slab_repeated_field.cc \
     src/google/protobuf/service.cc \
     src/google/protobuf/text_format.cc \
     src/google/protobuf/unknown_field_set.cc \
     src/google/protobuf/wire_format.cc \
     src/google/protobuf/wire_format_lite.cc \
+    src/google/protobuf/wire_patch.cc \
     src/google/protobuf/compiler/code_generator.cc \
     src/google/protobuf/compiler/command_line_interface.cc \
     src/google/protobuf/compiler/importer.cc \
@@ -83,6 +99,7 @@ COMPILER_SRC_FILES :=  \
     src/google/protobuf/compiler/cpp/cpp_file.cc \
     src/google/protobuf/compiler/cpp/cpp_generator.cc \
     src/google/protobuf/compiler/cpp/cpp_helpers.cc \
+    src/google/protobuf/compiler/cpp/cpp_map_field.cc \
     src/google/protobuf/compiler/cpp/cpp_message.cc \
     src/google/protobuf/compiler/cpp/cpp_message_field.cc \
     src/google/protobuf/compiler/cpp/cpp_primitive_field.cc \
@@ -252,6 +269,7 @@ protobuf_cc_full_src_files := \
     src/google/protobuf/stubs/substitute.cc                          \
     src/google/protobuf/stubs/substitute.h                           \
     src/google/protobuf/stubs/structurally_valid.cc                  \
+    src/google/protobuf/columnar.cc                                  \
     src/google/protobuf/descriptor.cc                                \
     src/google/protobuf/descriptor.pb.cc                             \
     src/google/protobuf/descriptor_database.cc                       \
@@ -356,6 +374,40 @@ LOCAL_CFLAGS := $(IGNORED_WARNINGS)
 
 include $(BUILD_HOST_EXECUTABLE)
 
+# C++ benchmarks (device executable); run it with no arguments.
+# =======================================================
+include $(CLEAR_VARS)
+
+LOCAL_MODULE := protobuf-cpp-benchmark
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_CPP_EXTENSION := .cc
+LOCAL_SRC_FILES := \
+    src/google/protobuf/benchmarks/benchmark.cc \
+    src/google/protobuf/benchmarks/benchmark_messages.proto \
+    src/google/protobuf/benchmarks/benchmark_messages_code_size.proto \
+    src/google/protobuf/benchmarks/benchmark_messages_lite.proto
+
+LOCAL_PROTOC_OPTIMIZE_TYPE := full
+LOCAL_PROTOC_FLAGS := --proto_path=$(LOCAL_PATH)/src
+
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/android \
+    $(LOCAL_PATH)/src
+
+LOCAL_STATIC_LIBRARIES := libprotobuf-cpp-2.3.0-full
+
+LOCAL_CFLAGS := -DGOOGLE_PROTOBUF_NO_RTTI $(IGNORED_WARNINGS)
+
+ifeq ($(TARGET_ARCH),arm)
+LOCAL_SDK_VERSION := 8
+else
+LOCAL_SDK_VERSION := 9
+endif
+LOCAL_NDK_STL_VARIANT := stlport_static
+
+include $(BUILD_EXECUTABLE)
+
 # To test java proto params build rules.
 # =======================================================
 include $(CLEAR_VARS)
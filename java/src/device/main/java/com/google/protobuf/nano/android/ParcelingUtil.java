@@ -33,21 +33,43 @@ package com.google.protobuf.nano.android;
 import android.os.Parcel;
 import android.util.Log;
 
+import com.google.protobuf.nano.InternalNano;
 import com.google.protobuf.nano.InvalidProtocolBufferNanoException;
 import com.google.protobuf.nano.MessageNano;
 
+import java.util.concurrent.ConcurrentHashMap;
+
 final class ParcelingUtil {
     private static final String TAG = "ParcelingUtil";
 
+    /**
+     * Message classes seen by {@link #createFromParcel}, keyed by name, so that
+     * unparceling does not go through {@link Class#forName} every time. Lookups
+     * take no lock; two threads may both load a new class, which is harmless.
+     */
+    private static final ConcurrentHashMap<String, Class<?>> sClassCache =
+            new ConcurrentHashMap<String, Class<?>>();
+
+    private static Class<?> loadClass(String className) throws ClassNotFoundException {
+        Class<?> clazz = sClassCache.get(className);
+        if (clazz == null) {
+            clazz = Class.forName(className);
+            sClassCache.putIfAbsent(className, clazz);
+        }
+        return clazz;
+    }
+
     @SuppressWarnings("unchecked")
     static <T extends MessageNano> T createFromParcel(Parcel in) {
         String className = in.readString();
+        // The parsed message copies everything it keeps out of this array, so
+        // it is parsed in place rather than wrapped or copied again.
         byte[] data = in.createByteArray();
 
         T proto = null;
 
         try {
-            Class<?> clazz = Class.forName(className);
+            Class<?> clazz = loadClass(className);
             Object instance = clazz.newInstance();
             proto = (T) instance;
             MessageNano.mergeFrom(proto, data);
@@ -67,6 +89,9 @@ final class ParcelingUtil {
     static <T extends MessageNano> void writeToParcel(Class<T> clazz, MessageNano message,
             Parcel out) {
         out.writeString(clazz.getName());
-        out.writeByteArray(MessageNano.toByteArray(message));
+        // Serialize into a reusable per-thread buffer; the Parcel copies the
+        // bytes out, so no per-call array is needed.
+        byte[] buffer = InternalNano.toScratchByteArray(message);
+        out.writeByteArray(buffer, 0, message.getCachedSize());
     }
 }
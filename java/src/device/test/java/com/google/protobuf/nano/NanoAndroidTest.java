@@ -64,6 +64,32 @@ public class NanoAndroidTest extends TestCase {
         assertEquals(SimpleMessageNano.FOO, message.defaultNestedEnum);
     }
 
+    public void testParcelingSameClassTwice() {
+        // The first unparceling loads the message class through ParcelingUtil's
+        // class cache, the second one finds it there.
+        for (int i = 0; i < 2; i++) {
+            SimpleMessageNano message = new SimpleMessageNano();
+            message.d = 100 + i;
+            message.nestedMsg = new NestedMessage();
+            message.nestedMsg.bb = 200 + i;
+
+            Parcel parcel = null;
+            try {
+                parcel = Parcel.obtain();
+                parcel.writeParcelable(message, 0);
+                parcel.setDataPosition(0);
+                message = parcel.readParcelable(getClass().getClassLoader());
+            } finally {
+                if (parcel != null) {
+                    parcel.recycle();
+                }
+            }
+
+            assertEquals(100 + i, message.d);
+            assertEquals(200 + i, message.nestedMsg.bb);
+        }
+    }
+
     public void testExtendableParceling() {
         ExtendableMessage message = new ExtendableMessage();
         message.field = 12345;
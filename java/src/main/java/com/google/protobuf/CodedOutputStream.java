@@ -32,7 +32,6 @@ package com.google.protobuf;
 
 import java.io.OutputStream;
 import java.io.IOException;
-import java.io.UnsupportedEncodingException;
 
 /**
  * Encodes and writes protocol message fields.
@@ -348,12 +347,47 @@ public final class CodedOutputStream {
 
   /** Write a {@code string} field to the stream. */
   public void writeStringNoTag(final String value) throws IOException {
-    // Unfortunately there does not appear to be any way to tell Java to encode
-    // UTF-8 directly into our buffer, so we have to let it create its own byte
-    // array and then copy.
-    final byte[] bytes = value.getBytes("UTF-8");
-    writeRawVarint32(bytes.length);
-    writeRawBytes(bytes);
+    // Encode the UTF-8 directly into our buffer rather than letting
+    // String.getBytes() allocate an array which we would then copy.
+    final int charCount = value.length();
+    final int space = limit - position;
+    if (charCount <= (space - MAX_VARINT32_SIZE) / MAX_UTF8_BYTES_PER_CHAR) {
+      // Fast path:  Even if every char takes three bytes, the string fits in
+      //   the buffer.  Reserve room for the largest possible length prefix,
+      //   encode, then write the real prefix and slide the bytes back if it
+      //   turned out shorter.  This avoids a separate pass to measure the
+      //   string.
+      final int prefixPosition = position;
+      final int maxPrefixSize =
+        computeRawVarint32Size(charCount * MAX_UTF8_BYTES_PER_CHAR);
+      final int start = prefixPosition + maxPrefixSize;
+      position = start;
+      writeUtf8Prefix(value, 0);
+      final int length = position - start;
+      final int prefixSize = computeRawVarint32Size(length);
+      if (prefixSize != maxPrefixSize) {
+        System.arraycopy(buffer, start, buffer, prefixPosition + prefixSize,
+                         length);
+      }
+      position = prefixPosition;
+      writeRawVarint32(length);
+      position += length;
+      return;
+    }
+
+    // Slow path:  Measure the string (without allocating), then encode it a
+    // bufferful at a time.
+    writeRawVarint32(computeUtf8Length(value));
+    if (buffer.length < MAX_UTF8_BYTES_PER_CODE_POINT) {
+      // The buffer is too small to be sure of making progress.
+      writeRawBytes(value.getBytes("UTF-8"));
+      return;
+    }
+    int i = writeUtf8Prefix(value, 0);
+    while (i < charCount) {
+      refreshBuffer();
+      i = writeUtf8Prefix(value, i);
+    }
   }
 
   /** Write a {@code group} field to the stream. */
@@ -690,13 +724,8 @@ public final class CodedOutputStream {
    * {@code string} field.
    */
   public static int computeStringSizeNoTag(final String value) {
-    try {
-      final byte[] bytes = value.getBytes("UTF-8");
-      return computeRawVarint32Size(bytes.length) +
-             bytes.length;
-    } catch (UnsupportedEncodingException e) {
-      throw new RuntimeException("UTF-8 not supported.", e);
-    }
+    final int length = computeUtf8Length(value);
+    return computeRawVarint32Size(length) + length;
   }
 
   /**
@@ -788,6 +817,87 @@ public final class CodedOutputStream {
 
   // =================================================================
 
+  private static final int MAX_VARINT32_SIZE = 5;
+  private static final int MAX_UTF8_BYTES_PER_CHAR = 3;
+  private static final int MAX_UTF8_BYTES_PER_CODE_POINT = 4;
+
+  /**
+   * Returns the number of bytes in the UTF-8 encoding of {@code value},
+   * without encoding it.  Unpaired surrogates count as one byte, since
+   * {@code String.getBytes("UTF-8")} replaces them with {@code '?'}.
+   */
+  static int computeUtf8Length(final String value) {
+    final int charCount = value.length();
+    int length = charCount;
+    for (int i = 0; i < charCount; i++) {
+      final char c = value.charAt(i);
+      if (c < 0x80) {
+        continue;
+      } else if (c < 0x800) {
+        length += 1;
+      } else if (c < Character.MIN_SURROGATE || c > Character.MAX_SURROGATE) {
+        length += 2;
+      } else if (c <= Character.MAX_HIGH_SURROGATE && i + 1 < charCount &&
+                 Character.isLowSurrogate(value.charAt(i + 1))) {
+        // Two chars, four bytes.
+        length += 2;
+        i++;
+      }
+    }
+    return length;
+  }
+
+  /**
+   * Encodes chars of {@code value} starting at index {@code i} as UTF-8 into
+   * the buffer, stopping at the end of the string or at the first character
+   * that does not fit.  Returns the index of the first char not written.
+   * The output matches {@code String.getBytes("UTF-8")}, including the
+   * {@code '?'} substituted for unpaired surrogates.
+   */
+  private int writeUtf8Prefix(final String value, int i) {
+    final int charCount = value.length();
+    final byte[] buf = buffer;
+    final int lim = limit;
+    int pos = position;
+
+    // Most strings are ASCII; handle a run of them with minimal checks.
+    for (char c; i < charCount && pos < lim && (c = value.charAt(i)) < 0x80;
+         i++) {
+      buf[pos++] = (byte) c;
+    }
+
+    for (; i < charCount; i++) {
+      final char c = value.charAt(i);
+      if (c < 0x80) {
+        if (pos == lim) break;
+        buf[pos++] = (byte) c;
+      } else if (c < 0x800) {
+        if (lim - pos < 2) break;
+        buf[pos++] = (byte) (0xC0 | (c >>> 6));
+        buf[pos++] = (byte) (0x80 | (c & 0x3F));
+      } else if (c < Character.MIN_SURROGATE || c > Character.MAX_SURROGATE) {
+        if (lim - pos < 3) break;
+        buf[pos++] = (byte) (0xE0 | (c >>> 12));
+        buf[pos++] = (byte) (0x80 | ((c >>> 6) & 0x3F));
+        buf[pos++] = (byte) (0x80 | (c & 0x3F));
+      } else if (c <= Character.MAX_HIGH_SURROGATE && i + 1 < charCount &&
+                 Character.isLowSurrogate(value.charAt(i + 1))) {
+        if (lim - pos < 4) break;
+        final int codePoint = Character.toCodePoint(c, value.charAt(++i));
+        buf[pos++] = (byte) (0xF0 | (codePoint >>> 18));
+        buf[pos++] = (byte) (0x80 | ((codePoint >>> 12) & 0x3F));
+        buf[pos++] = (byte) (0x80 | ((codePoint >>> 6) & 0x3F));
+        buf[pos++] = (byte) (0x80 | (codePoint & 0x3F));
+      } else {
+        if (pos == lim) break;
+        buf[pos++] = (byte) '?';
+      }
+    }
+
+    position = pos;
+    return i;
+  }
+
   /**
    * Internal helper that writes the current buffer to the output. The
    * buffer position is reset to its initial value when this returns.
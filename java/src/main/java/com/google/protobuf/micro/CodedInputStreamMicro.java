@@ -282,6 +282,169 @@ public final class CodedInputStreamMicro {
     return decodeZigZag64(readRawVarint64());
   }
 
+  // -----------------------------------------------------------------
+  // Bulk readers for packed repeated fields stored in primitive arrays.
+  //
+  // Each reads values until the current limit (which the caller pushes for
+  // the packed field's length) or until {@code dst} is full, storing them
+  // into {@code dst} starting at {@code offset}, and returns the index one
+  // past the last value stored.  The caller grows {@code dst} between calls,
+  // by {@link #getPackedCountHint(int)} elements, until
+  // {@link #getBytesUntilLimit()} reaches zero.  The length prefix of a
+  // packed field is never trusted for sizing, since the bytes it promises
+  // may not exist.
+
+  /**
+   * Returns how many more values of a packed field the caller should make
+   * room for before the next bulk read:  the number of values which are
+   * already buffered before the current limit, or 1 if none are.  Varints
+   * are counted by their terminating bytes when {@code fixedSize} is 0;
+   * otherwise {@code fixedSize} is the width of each value in bytes.
+   */
+  public int getPackedCountHint(final int fixedSize) {
+    int count;
+    if (fixedSize == 0) {
+      count = 0;
+      final byte[] buf = buffer;
+      for (int pos = bufferPos; pos < bufferSize; pos++) {
+        if (buf[pos] >= 0) {
+          count++;
+        }
+      }
+    } else {
+      count = (bufferSize - bufferPos) / fixedSize;
+    }
+    return count > 0 ? count : 1;
+  }
+
+  /** Read the payload of a packed {@code int32} field. */
+  public int readPackedInt32(final int[] dst, int offset) throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = readRawVarint32();
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code uint32} field. */
+  public int readPackedUInt32(final int[] dst, final int offset)
+      throws IOException {
+    return readPackedInt32(dst, offset);
+  }
+
+  /** Read the payload of a packed {@code sint32} field. */
+  public int readPackedSInt32(final int[] dst, int offset) throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = decodeZigZag32(readRawVarint32());
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code int64} field. */
+  public int readPackedInt64(final long[] dst, int offset) throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = readRawVarint64();
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code uint64} field. */
+  public int readPackedUInt64(final long[] dst, final int offset)
+      throws IOException {
+    return readPackedInt64(dst, offset);
+  }
+
+  /** Read the payload of a packed {@code sint64} field. */
+  public int readPackedSInt64(final long[] dst, int offset) throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = decodeZigZag64(readRawVarint64());
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code fixed32} field. */
+  public int readPackedFixed32(final int[] dst, int offset) throws IOException {
+    // Fast path:  Decode the values which are already buffered without going
+    //   through readRawByte() for every byte.
+    final byte[] buf = buffer;
+    int pos = bufferPos;
+    final int end = bufferSize - 3;
+    while (offset < dst.length && pos < end) {
+      dst[offset++] = ((buf[pos    ] & 0xff)      ) |
+                      ((buf[pos + 1] & 0xff) <<  8) |
+                      ((buf[pos + 2] & 0xff) << 16) |
+                      ((buf[pos + 3] & 0xff) << 24);
+      pos += 4;
+    }
+    bufferPos = pos;
+    // Slow path, for values which straddle a buffer refill.
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = readRawLittleEndian32();
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code sfixed32} field. */
+  public int readPackedSFixed32(final int[] dst, final int offset)
+      throws IOException {
+    return readPackedFixed32(dst, offset);
+  }
+
+  /** Read the payload of a packed {@code fixed64} field. */
+  public int readPackedFixed64(final long[] dst, int offset) throws IOException {
+    // Fast path:  See readPackedFixed32().
+    final byte[] buf = buffer;
+    int pos = bufferPos;
+    final int end = bufferSize - 7;
+    while (offset < dst.length && pos < end) {
+      dst[offset++] = (((long)buf[pos    ] & 0xff)      ) |
+                      (((long)buf[pos + 1] & 0xff) <<  8) |
+                      (((long)buf[pos + 2] & 0xff) << 16) |
+                      (((long)buf[pos + 3] & 0xff) << 24) |
+                      (((long)buf[pos + 4] & 0xff) << 32) |
+                      (((long)buf[pos + 5] & 0xff) << 40) |
+                      (((long)buf[pos + 6] & 0xff) << 48) |
+                      (((long)buf[pos + 7] & 0xff) << 56);
+      pos += 8;
+    }
+    bufferPos = pos;
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = readRawLittleEndian64();
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code sfixed64} field. */
+  public int readPackedSFixed64(final long[] dst, final int offset)
+      throws IOException {
+    return readPackedFixed64(dst, offset);
+  }
+
+  /** Read the payload of a packed {@code float} field. */
+  public int readPackedFloat(final float[] dst, int offset) throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = Float.intBitsToFloat(readRawLittleEndian32());
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code double} field. */
+  public int readPackedDouble(final double[] dst, int offset)
+      throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = Double.longBitsToDouble(readRawLittleEndian64());
+    }
+    return offset;
+  }
+
+  /** Read the payload of a packed {@code bool} field. */
+  public int readPackedBool(final boolean[] dst, int offset)
+      throws IOException {
+    while (offset < dst.length && getBytesUntilLimit() > 0) {
+      dst[offset++] = readRawVarint32() != 0;
+    }
+    return offset;
+  }
+
   // =================================================================
 
   /**
@@ -536,7 +699,8 @@ public final class CodedInputStreamMicro {
     }
     byteLimit += totalBytesRetired + bufferPos;
     final int oldLimit = currentLimit;
-    if (byteLimit > oldLimit) {
+    if (byteLimit > oldLimit || byteLimit < 0) {
+      // A negative sum means the limit overflowed, so it is past the end too.
       throw InvalidProtocolBufferMicroException.truncatedMessage();
     }
     currentLimit = byteLimit;
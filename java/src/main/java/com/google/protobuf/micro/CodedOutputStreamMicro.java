@@ -394,6 +394,115 @@ public final class CodedOutputStreamMicro {
     writeRawVarint64(encodeZigZag64(value));
   }
 
+  // -----------------------------------------------------------------
+  // Bulk writers for repeated fields stored in primitive arrays.  Each writes
+  // the first {@code count} elements of {@code values} back to back, without
+  // tags, i.e. the payload of a packed field.
+
+  /** Write the payload of a packed {@code int32} field to the stream. */
+  public void writePackedInt32NoTag(final int[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeInt32NoTag(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code uint32} field to the stream. */
+  public void writePackedUInt32NoTag(final int[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawVarint32(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code sint32} field to the stream. */
+  public void writePackedSInt32NoTag(final int[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawVarint32(encodeZigZag32(values[i]));
+    }
+  }
+
+  /** Write the payload of a packed {@code int64} field to the stream. */
+  public void writePackedInt64NoTag(final long[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawVarint64(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code uint64} field to the stream. */
+  public void writePackedUInt64NoTag(final long[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawVarint64(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code sint64} field to the stream. */
+  public void writePackedSInt64NoTag(final long[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawVarint64(encodeZigZag64(values[i]));
+    }
+  }
+
+  /** Write the payload of a packed {@code fixed32} field to the stream. */
+  public void writePackedFixed32NoTag(final int[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian32(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code sfixed32} field to the stream. */
+  public void writePackedSFixed32NoTag(final int[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian32(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code fixed64} field to the stream. */
+  public void writePackedFixed64NoTag(final long[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian64(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code sfixed64} field to the stream. */
+  public void writePackedSFixed64NoTag(final long[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian64(values[i]);
+    }
+  }
+
+  /** Write the payload of a packed {@code float} field to the stream. */
+  public void writePackedFloatNoTag(final float[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian32(Float.floatToIntBits(values[i]));
+    }
+  }
+
+  /** Write the payload of a packed {@code double} field to the stream. */
+  public void writePackedDoubleNoTag(final double[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawLittleEndian64(Double.doubleToLongBits(values[i]));
+    }
+  }
+
+  /** Write the payload of a packed {@code bool} field to the stream. */
+  public void writePackedBoolNoTag(final boolean[] values, final int count)
+      throws IOException {
+    for (int i = 0; i < count; i++) {
+      writeRawByte(values[i] ? 1 : 0);
+    }
+  }
+
   // =================================================================
 
   /**
@@ -750,6 +859,95 @@ public final class CodedOutputStreamMicro {
     return computeRawVarint64Size(encodeZigZag64(value));
   }
 
+  // -----------------------------------------------------------------
+  // Sizes of the payloads written by the writePacked*NoTag() methods, for the
+  // variable-width types.  Fixed-width payloads are simply the element size
+  // times the count.
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code int32} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedInt32SizeNoTag(final int[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeInt32SizeNoTag(values[i]);
+    }
+    return size;
+  }
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code uint32} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedUInt32SizeNoTag(final int[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeRawVarint32Size(values[i]);
+    }
+    return size;
+  }
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code sint32} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedSInt32SizeNoTag(final int[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeRawVarint32Size(encodeZigZag32(values[i]));
+    }
+    return size;
+  }
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code int64} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedInt64SizeNoTag(final long[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeRawVarint64Size(values[i]);
+    }
+    return size;
+  }
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code uint64} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedUInt64SizeNoTag(final long[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeRawVarint64Size(values[i]);
+    }
+    return size;
+  }
+
+  /**
+   * Compute the number of bytes that would be needed to encode the first
+   * {@code count} elements of a packed {@code sint64} field, excluding the tag
+   * and length.
+   */
+  public static int computePackedSInt64SizeNoTag(final long[] values,
+      final int count) {
+    int size = 0;
+    for (int i = 0; i < count; i++) {
+      size += computeRawVarint64Size(encodeZigZag64(values[i]));
+    }
+    return size;
+  }
+
   // =================================================================
 
   /**
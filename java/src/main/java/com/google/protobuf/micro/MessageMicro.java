@@ -133,4 +133,71 @@ public abstract class MessageMicro {
         final int tag) throws IOException {
       return input.skipField(tag);
     }
+
+    /**
+     * Called by subclasses storing repeated fields in primitive arrays to make
+     * room for {@code minCapacity} elements.  Returns {@code array} itself if
+     * it is already large enough, otherwise a larger copy holding the first
+     * {@code count} elements.
+     */
+    protected static int[] ensureCapacity(final int[] array, final int count,
+            final int minCapacity) {
+        if (minCapacity <= array.length) {
+            return array;
+        }
+        final int[] result = new int[newCapacity(array.length, minCapacity)];
+        System.arraycopy(array, 0, result, 0, count);
+        return result;
+    }
+
+    /** See {@link #ensureCapacity(int[], int, int)}. */
+    protected static long[] ensureCapacity(final long[] array, final int count,
+            final int minCapacity) {
+        if (minCapacity <= array.length) {
+            return array;
+        }
+        final long[] result = new long[newCapacity(array.length, minCapacity)];
+        System.arraycopy(array, 0, result, 0, count);
+        return result;
+    }
+
+    /** See {@link #ensureCapacity(int[], int, int)}. */
+    protected static float[] ensureCapacity(final float[] array, final int count,
+            final int minCapacity) {
+        if (minCapacity <= array.length) {
+            return array;
+        }
+        final float[] result = new float[newCapacity(array.length, minCapacity)];
+        System.arraycopy(array, 0, result, 0, count);
+        return result;
+    }
+
+    /** See {@link #ensureCapacity(int[], int, int)}. */
+    protected static double[] ensureCapacity(final double[] array, final int count,
+            final int minCapacity) {
+        if (minCapacity <= array.length) {
+            return array;
+        }
+        final double[] result = new double[newCapacity(array.length, minCapacity)];
+        System.arraycopy(array, 0, result, 0, count);
+        return result;
+    }
+
+    /** See {@link #ensureCapacity(int[], int, int)}. */
+    protected static boolean[] ensureCapacity(final boolean[] array, final int count,
+            final int minCapacity) {
+        if (minCapacity <= array.length) {
+            return array;
+        }
+        final boolean[] result = new boolean[newCapacity(array.length, minCapacity)];
+        System.arraycopy(array, 0, result, 0, count);
+        return result;
+    }
+
+    private static int newCapacity(final int oldCapacity, final int minCapacity) {
+        // Grow by half again so that repeated add() calls are amortized O(1)
+        // without doubling the footprint of large fields.
+        final int grown = oldCapacity + (oldCapacity >> 1) + 4;
+        return grown < minCapacity ? minCapacity : grown;
+    }
 }
@@ -84,4 +84,12 @@ public final class WireFormatMicro {
     makeTag(MESSAGE_SET_TYPE_ID, WIRETYPE_VARINT);
   static final int MESSAGE_SET_MESSAGE_TAG =
     makeTag(MESSAGE_SET_MESSAGE, WIRETYPE_LENGTH_DELIMITED);
+
+  // Shared initial values for repeated fields stored as primitive arrays
+  // (java_use_primitive_arrays=true).  They are never written to.
+  public static final int[] EMPTY_INT_ARRAY = {};
+  public static final long[] EMPTY_LONG_ARRAY = {};
+  public static final float[] EMPTY_FLOAT_ARRAY = {};
+  public static final double[] EMPTY_DOUBLE_ARRAY = {};
+  public static final boolean[] EMPTY_BOOLEAN_ARRAY = {};
 }
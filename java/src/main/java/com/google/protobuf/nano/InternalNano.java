@@ -330,4 +330,46 @@ public final class InternalNano {
     return result;
   }
 
+  /**
+   * Largest buffer {@link #toScratchByteArray} keeps for reuse. Larger
+   * messages get a temporary array, so that one large message does not pin
+   * its size in memory for the life of the thread.
+   */
+  private static final int MAX_SCRATCH_BUFFER_SIZE = 64 * 1024;
+
+  /**
+   * Per-thread scratch buffer used by {@link #toScratchByteArray}.
+   */
+  private static final ThreadLocal<byte[]> SCRATCH_BUFFER = new ThreadLocal<byte[]>();
+
+  /**
+   * Serializes {@code msg} into a buffer owned by the calling thread and
+   * returns that buffer. The encoded message occupies the first
+   * {@code msg.getCachedSize()} bytes; anything after that is garbage. The
+   * buffer is reused by the next call on the same thread, so callers must copy
+   * the bytes out (e.g. into a {@code Parcel}) before serializing again.
+   * <p>
+   * This avoids allocating a fresh array per message when the bytes are only
+   * needed transiently, which matters for code that serializes many
+   * messages per second. Messages larger than 64 KB are serialized into a
+   * new array which is not kept.
+   */
+  public static byte[] toScratchByteArray(MessageNano msg) {
+    final int size = msg.getSerializedSize();
+    byte[] buffer;
+    if (size > MAX_SCRATCH_BUFFER_SIZE) {
+      buffer = new byte[size];
+    } else {
+      buffer = SCRATCH_BUFFER.get();
+      if (buffer == null || buffer.length < size) {
+        // Grow geometrically so a slowly growing message does not reallocate
+        // on every call.
+        buffer = new byte[Math.min(MAX_SCRATCH_BUFFER_SIZE,
+            Math.max(size, buffer == null ? 256 : buffer.length * 2))];
+        SCRATCH_BUFFER.set(buffer);
+      }
+    }
+    MessageNano.toByteArray(msg, buffer, 0, size);
+    return buffer;
+  }
 }
@@ -154,11 +154,24 @@ public abstract class MessageNano {
      * Returns a string that is (mostly) compatible with ProtoBuffer's TextFormat. Note that groups
      * (which are deprecated) are not serialized with the correct field name.
      *
-     * <p>This is implemented using reflection, so it is not especially fast nor is it guaranteed
-     * to find all fields if you have method removal turned on for proguard.
+     * <p>Unless the message was generated with the {@code generate_to_string} option, this is
+     * implemented using reflection, so it is not especially fast nor is it guaranteed to find all
+     * fields if you have method removal turned on for proguard.
      */
     @Override
     public String toString() {
         return MessageNanoPrinter.print(this);
     }
+
+    /**
+     * Appends the fields of this message in the format of {@link #toString()} to {@code builder},
+     * with each line prefixed by {@code indent} levels of indentation. Nested messages are printed
+     * by calling this method on them, so a whole tree shares one {@code StringBuilder}.
+     *
+     * <p>Overridden by generated code if the {@code generate_to_string} option is set. The
+     * default implementation uses reflection.
+     */
+    public void printTo(StringBuilder builder, int indent) {
+        MessageNanoPrinter.printFields(this, builder, indent);
+    }
 }
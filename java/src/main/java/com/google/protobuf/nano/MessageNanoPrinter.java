@@ -47,6 +47,7 @@ public final class MessageNanoPrinter {
 
     private static final String INDENT = "  ";
     private static final int MAX_STRING_LEN = 200;
+    private static final char[] HEX_DIGITS = "0123456789abcdef".toCharArray();
 
     /**
      * Returns an text representation of a MessageNano suitable for debugging. The returned string
@@ -54,143 +55,170 @@ public final class MessageNanoPrinter {
      * buffers) -- groups (which are deprecated) are output with an underscore name (e.g. foo_bar
      * instead of FooBar) and will thus not parse.
      *
-     * <p>Employs Java reflection on the given object and recursively prints primitive fields,
-     * groups, and messages.</p>
+     * <p>Messages generated with the {@code generate_to_string} option print themselves through
+     * their generated {@link MessageNano#printTo} method. Otherwise this employs Java reflection on
+     * the given object and recursively prints primitive fields, groups, and messages.</p>
      */
     public static <T extends MessageNano> String print(T message) {
         if (message == null) {
             return "";
         }
 
-        StringBuffer buf = new StringBuffer();
-        try {
-            print(null, message, new StringBuffer(), buf);
-        } catch (IllegalAccessException e) {
-            return "Error printing proto: " + e.getMessage();
-        } catch (InvocationTargetException e) {
-            return "Error printing proto: " + e.getMessage();
-        }
+        StringBuilder buf = new StringBuilder();
+        message.printTo(buf, 0);
         return buf.toString();
     }
 
     /**
-     * Function that will print the given message/field into the StringBuffer.
-     * Meant to be called recursively.
+     * Appends the fields of {@code message} to {@code buf} using reflection. This is the default
+     * implementation of {@link MessageNano#printTo}.
      *
-     * @param identifier the identifier to use, or {@code null} if this is the root message to
-     *        print.
-     * @param object the value to print. May in fact be a primitive value or byte array and not a
-     *        message.
-     * @param indentBuf the indentation each line should begin with.
+     * @param message the message whose fields to print.
      * @param buf the output buffer.
+     * @param indent the number of indentation levels each line should begin with.
      */
-    private static void print(String identifier, Object object,
-            StringBuffer indentBuf, StringBuffer buf) throws IllegalAccessException,
-            InvocationTargetException {
-        if (object == null) {
-            // This can happen if...
-            //   - we're about to print a message, String, or byte[], but it not present;
-            //   - we're about to print a primitive, but "reftype" optional style is enabled, and
-            //     the field is unset.
-            // In both cases the appropriate behavior is to output nothing.
-        } else if (object instanceof MessageNano) {  // Nano proto message
-            int origIndentBufLength = indentBuf.length();
-            if (identifier != null) {
-                buf.append(indentBuf).append(deCamelCaseify(identifier)).append(" <\n");
-                indentBuf.append(INDENT);
-            }
-            Class<?> clazz = object.getClass();
+    static void printFields(MessageNano message, StringBuilder buf, int indent) {
+        try {
+            printFields(message, indent, buf);
+        } catch (IllegalAccessException e) {
+            buf.append("Error printing proto: ").append(e.getMessage());
+        } catch (InvocationTargetException e) {
+            buf.append("Error printing proto: ").append(e.getMessage());
+        }
+    }
 
-            // Proto fields follow one of two formats:
-            //
-            // 1) Public, non-static variables that do not begin or end with '_'
-            // Find and print these using declared public fields
-            for (Field field : clazz.getFields()) {
-                int modifiers = field.getModifiers();
-                String fieldName = field.getName();
+    private static void printFields(MessageNano message, int indent, StringBuilder buf)
+            throws IllegalAccessException, InvocationTargetException {
+        Class<?> clazz = message.getClass();
 
-                if ((modifiers & Modifier.PUBLIC) == Modifier.PUBLIC
-                        && (modifiers & Modifier.STATIC) != Modifier.STATIC
-                        && !fieldName.startsWith("_")
-                        && !fieldName.endsWith("_")) {
-                    Class<?> fieldType = field.getType();
-                    Object value = field.get(object);
+        // Proto fields follow one of two formats:
+        //
+        // 1) Public, non-static variables that do not begin or end with '_'
+        // Find and print these using declared public fields
+        for (Field field : clazz.getFields()) {
+            int modifiers = field.getModifiers();
+            String fieldName = field.getName();
 
-                    if (fieldType.isArray()) {
-                        Class<?> arrayType = fieldType.getComponentType();
+            if ((modifiers & Modifier.PUBLIC) == Modifier.PUBLIC
+                    && (modifiers & Modifier.STATIC) != Modifier.STATIC
+                    && !fieldName.startsWith("_")
+                    && !fieldName.endsWith("_")) {
+                Class<?> fieldType = field.getType();
+                Object value = field.get(message);
 
-                        // bytes is special since it's not repeated, but is represented by an array
-                        if (arrayType == byte.class) {
-                            print(fieldName, value, indentBuf, buf);
-                        } else {
-                            int len = value == null ? 0 : Array.getLength(value);
-                            for (int i = 0; i < len; i++) {
-                                Object elem = Array.get(value, i);
-                                print(fieldName, elem, indentBuf, buf);
-                            }
-                        }
+                if (fieldType.isArray()) {
+                    Class<?> arrayType = fieldType.getComponentType();
+
+                    // bytes is special since it's not repeated, but is represented by an array
+                    if (arrayType == byte.class) {
+                        print(fieldName, value, indent, buf);
                     } else {
-                        print(fieldName, value, indentBuf, buf);
+                        int len = value == null ? 0 : Array.getLength(value);
+                        for (int i = 0; i < len; i++) {
+                            Object elem = Array.get(value, i);
+                            print(fieldName, elem, indent, buf);
+                        }
                     }
+                } else {
+                    print(fieldName, value, indent, buf);
                 }
             }
+        }
 
-            // 2) Fields that are accessed via getter methods (when accessors
-            //    mode is turned on)
-            // Find and print these using getter methods.
-            for (Method method : clazz.getMethods()) {
-                String name = method.getName();
-                // Check for the setter accessor method since getters and hazzers both have
-                // non-proto-field name collisions (hashCode() and getSerializedSize())
-                if (name.startsWith("set")) {
-                    String subfieldName = name.substring(3);
-
-                    Method hazzer = null;
-                    try {
-                        hazzer = clazz.getMethod("has" + subfieldName);
-                    } catch (NoSuchMethodException e) {
-                        continue;
-                    }
-                    // If hazzer does't exist or returns false, no need to continue
-                    if (!(Boolean) hazzer.invoke(object)) {
-                        continue;
-                    }
+        // 2) Fields that are accessed via getter methods (when accessors
+        //    mode is turned on)
+        // Find and print these using getter methods.
+        for (Method method : clazz.getMethods()) {
+            String name = method.getName();
+            // Check for the setter accessor method since getters and hazzers both have
+            // non-proto-field name collisions (hashCode() and getSerializedSize())
+            if (name.startsWith("set")) {
+                String subfieldName = name.substring(3);
 
-                    Method getter = null;
-                    try {
-                        getter = clazz.getMethod("get" + subfieldName);
-                    } catch (NoSuchMethodException e) {
-                        continue;
-                    }
+                Method hazzer = null;
+                try {
+                    hazzer = clazz.getMethod("has" + subfieldName);
+                } catch (NoSuchMethodException e) {
+                    continue;
+                }
+                // If hazzer does't exist or returns false, no need to continue
+                if (!(Boolean) hazzer.invoke(message)) {
+                    continue;
+                }
 
-                    print(subfieldName, getter.invoke(object), indentBuf, buf);
+                Method getter = null;
+                try {
+                    getter = clazz.getMethod("get" + subfieldName);
+                } catch (NoSuchMethodException e) {
+                    continue;
                 }
+
+                print(subfieldName, getter.invoke(message), indent, buf);
             }
-            if (identifier != null) {
-                indentBuf.setLength(origIndentBufLength);
-                buf.append(indentBuf).append(">\n");
-            }
+        }
+    }
+
+    /**
+     * Function that will print the given field into the StringBuilder.
+     *
+     * @param identifier the Java identifier of the field.
+     * @param object the value to print. May in fact be a primitive value or byte array and not a
+     *        message.
+     * @param indent the number of indentation levels each line should begin with.
+     * @param buf the output buffer.
+     */
+    private static void print(String identifier, Object object, int indent, StringBuilder buf) {
+        if (object == null) {
+            // This can happen if...
+            //   - we're about to print a message, String, or byte[], but it not present;
+            //   - we're about to print a primitive, but "reftype" optional style is enabled, and
+            //     the field is unset.
+            // In both cases the appropriate behavior is to output nothing.
+        } else if (object instanceof MessageNano) {  // Nano proto message
+            appendIndent(buf, indent);
+            buf.append(deCamelCaseify(identifier)).append(" <\n");
+            // Nested messages may have a generated printTo(); otherwise this recurses back into
+            // printFields().
+            ((MessageNano) object).printTo(buf, indent + 1);
+            appendIndent(buf, indent);
+            buf.append(">\n");
         } else {
             // Non-null primitive value
-            identifier = deCamelCaseify(identifier);
-            buf.append(indentBuf).append(identifier).append(": ");
+            appendFieldName(buf, indent, deCamelCaseify(identifier));
             if (object instanceof String) {
-                String stringMessage = sanitizeString((String) object);
-                buf.append("\"").append(stringMessage).append("\"");
+                appendQuotedString(buf, (String) object);
             } else if (object instanceof byte[]) {
-                appendQuotedBytes((byte[]) object, buf);
+                appendQuotedBytes(buf, (byte[]) object);
             } else {
                 buf.append(object);
             }
-            buf.append("\n");
+            buf.append('\n');
         }
     }
 
+    /**
+     * Appends {@code indent} levels of indentation to {@code buf}. Used by generated code.
+     */
+    public static void appendIndent(StringBuilder buf, int indent) {
+        for (int i = 0; i < indent; i++) {
+            buf.append(INDENT);
+        }
+    }
+
+    /**
+     * Appends the indentation and "{@code name}: " prefix of a scalar field line to {@code buf},
+     * and returns {@code buf} so the caller can append the value. Used by generated code.
+     */
+    public static StringBuilder appendFieldName(StringBuilder buf, int indent, String name) {
+        appendIndent(buf, indent);
+        return buf.append(name).append(": ");
+    }
+
     /**
      * Converts an identifier of the format "FieldName" into "field_name".
      */
     private static String deCamelCaseify(String identifier) {
-        StringBuffer out = new StringBuffer();
+        StringBuilder out = new StringBuilder();
         for (int i = 0; i < identifier.length(); i++) {
             char currentChar = identifier.charAt(i);
             if (i == 0) {
@@ -205,53 +233,62 @@ public final class MessageNanoPrinter {
     }
 
     /**
-     * Shortens and escapes the given string.
+     * Appends the given string to {@code buf}, shortened, escaped and in double quotes. Everything
+     * except for low ASCII code points is escaped. Used by generated code.
      */
-    private static String sanitizeString(String str) {
-        if (!str.startsWith("http") && str.length() > MAX_STRING_LEN) {
+    public static void appendQuotedString(StringBuilder buf, String str) {
+        int strLen = str.length();
+        boolean trimmed = false;
+        if (!str.startsWith("http") && strLen > MAX_STRING_LEN) {
             // Trim non-URL strings.
-            str = str.substring(0, MAX_STRING_LEN) + "[...]";
+            strLen = MAX_STRING_LEN;
+            trimmed = true;
+        }
+        buf.append('"');
+        for (int i = 0; i < strLen; i++) {
+            appendEscapedChar(buf, str.charAt(i));
         }
-        return escapeString(str);
+        if (trimmed) {
+            buf.append("[...]");
+        }
+        buf.append('"');
     }
 
-    /**
-     * Escape everything except for low ASCII code points.
-     */
-    private static String escapeString(String str) {
-        int strLen = str.length();
-        StringBuilder b = new StringBuilder(strLen);
-        for (int i = 0; i < strLen; i++) {
-            char original = str.charAt(i);
-            if (original >= ' ' && original <= '~' && original != '"' && original != '\'') {
-                b.append(original);
-            } else {
-                b.append(String.format("\\u%04x", (int) original));
-            }
+    private static void appendEscapedChar(StringBuilder buf, char c) {
+        if (c >= ' ' && c <= '~' && c != '"' && c != '\'') {
+            buf.append(c);
+        } else {
+            buf.append("\\u")
+                    .append(HEX_DIGITS[(c >> 12) & 0xf])
+                    .append(HEX_DIGITS[(c >> 8) & 0xf])
+                    .append(HEX_DIGITS[(c >> 4) & 0xf])
+                    .append(HEX_DIGITS[c & 0xf]);
         }
-        return b.toString();
     }
 
     /**
-     * Appends a quoted byte array to the provided {@code StringBuffer}.
+     * Appends a quoted byte array to the provided {@code StringBuilder}. Used by generated code.
      */
-    private static void appendQuotedBytes(byte[] bytes, StringBuffer builder) {
+    public static void appendQuotedBytes(StringBuilder buf, byte[] bytes) {
         if (bytes == null) {
-            builder.append("\"\"");
+            buf.append("\"\"");
             return;
         }
 
-        builder.append('"');
+        buf.append('"');
         for (int i = 0; i < bytes.length; ++i) {
-            int ch = bytes[i];
+            int ch = bytes[i] & 0xff;
             if (ch == '\\' || ch == '"') {
-                builder.append('\\').append((char) ch);
+                buf.append('\\').append((char) ch);
             } else if (ch >= 32 && ch < 127) {
-                builder.append((char) ch);
+                buf.append((char) ch);
             } else {
-                builder.append(String.format("\\%03o", ch));
+                buf.append('\\')
+                        .append((char) ('0' + ((ch >> 6) & 07)))
+                        .append((char) ('0' + ((ch >> 3) & 07)))
+                        .append((char) ('0' + (ch & 07)));
             }
         }
-        builder.append('"');
+        buf.append('"');
     }
 }
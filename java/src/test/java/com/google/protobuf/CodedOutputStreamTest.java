@@ -301,4 +301,71 @@ public class CodedOutputStreamTest extends TestCase {
     assertEqualBytes(TestUtil.getGoldenPackedFieldsMessage().toByteArray(),
                      rawBytes);
   }
+
+  /**
+   * Writes {@code value} with writeStringNoTag() to a flat array and to
+   * streams with various buffer sizes, and checks the result against
+   * String.getBytes().
+   */
+  private void assertWriteString(String value) throws Exception {
+    byte[] utf8 = value.getBytes("UTF-8");
+    ByteArrayOutputStream expectedOutput = new ByteArrayOutputStream();
+    CodedOutputStream expectedCoded = CodedOutputStream.newInstance(expectedOutput);
+    expectedCoded.writeRawVarint32(utf8.length);
+    expectedCoded.writeRawBytes(utf8);
+    expectedCoded.flush();
+    byte[] expected = expectedOutput.toByteArray();
+
+    assertEquals(utf8.length, CodedOutputStream.computeUtf8Length(value));
+    assertEquals(expected.length, CodedOutputStream.computeStringSizeNoTag(value));
+
+    // Exactly sized flat array, as used by toByteArray().
+    byte[] flat = new byte[expected.length];
+    CodedOutputStream output = CodedOutputStream.newInstance(flat);
+    output.writeStringNoTag(value);
+    output.checkNoSpaceLeft();
+    assertEqualBytes(expected, flat);
+
+    // Roomy flat array, which takes the reserve-and-shift path.
+    byte[] roomy = new byte[expected.length * 4 + 10];
+    output = CodedOutputStream.newInstance(roomy);
+    output.writeStringNoTag(value);
+    assertEquals(expected.length, roomy.length - output.spaceLeft());
+    byte[] written = new byte[expected.length];
+    System.arraycopy(roomy, 0, written, 0, written.length);
+    assertEqualBytes(expected, written);
+
+    for (int blockSize = 1; blockSize < 256; blockSize *= 2) {
+      ByteArrayOutputStream rawOutput = new ByteArrayOutputStream();
+      output = CodedOutputStream.newInstance(rawOutput, blockSize);
+      output.writeStringNoTag(value);
+      output.flush();
+      assertEqualBytes(expected, rawOutput.toByteArray());
+    }
+  }
+
+  public void testWriteString() throws Exception {
+    assertWriteString("");
+    assertWriteString("a");
+    assertWriteString("Hello, world!");
+    assertWriteString("\u00e9t\u00e9");                 // two-byte chars
+    assertWriteString("\u65e5\u672c\u8a9e");           // three-byte chars
+    assertWriteString("\ud83d\ude00 smile \ud834\udd1e"); // surrogate pairs
+    assertWriteString("\ud800");                        // unpaired high
+    assertWriteString("x\udc00y");                      // unpaired low
+    assertWriteString("\ud800\ud800\udc00");           // high then pair
+
+    // Long enough to need a multi-byte length prefix and to cross buffer
+    // boundaries, with the prefix shrinking after encoding.
+    StringBuilder builder = new StringBuilder();
+    for (int i = 0; i < 100; i++) {
+      builder.append("ab\u00e9\u65e5\ud83d\ude00");
+    }
+    assertWriteString(builder.toString());
+    builder.setLength(0);
+    for (int i = 0; i < 50; i++) {
+      builder.append('z');
+    }
+    assertWriteString(builder.toString());
+  }
 }
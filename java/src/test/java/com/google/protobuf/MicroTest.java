@@ -33,9 +33,12 @@ package com.google.protobuf;
 import com.google.protobuf.micro.ByteStringMicro;
 import com.google.protobuf.micro.CodedInputStreamMicro;
 import com.google.protobuf.micro.FileScopeEnumRefMicro;
+import com.google.protobuf.micro.InvalidProtocolBufferMicroException;
 import com.google.protobuf.micro.MessageScopeEnumRefMicro;
 import com.google.protobuf.micro.MicroOuterClass;
 import com.google.protobuf.micro.MicroOuterClass.TestAllTypesMicro;
+import com.google.protobuf.micro.MicroRepeatedPackables.NonPackedMicro;
+import com.google.protobuf.micro.MicroRepeatedPackables.PackedMicro;
 import com.google.protobuf.micro.MultipleImportingNonMultipleMicro1;
 import com.google.protobuf.micro.MultipleImportingNonMultipleMicro2;
 import com.google.protobuf.micro.MultipleNameClashMicro;
@@ -52,6 +55,7 @@ import java.io.ByteArrayInputStream;
 import java.io.FilterInputStream;
 import java.io.InputStream;
 import java.io.IOException;
+import java.util.Arrays;
 
 /**
  * Test micro runtime.
@@ -2245,6 +2249,133 @@ public class MicroTest extends TestCase {
     assertEquals(5, input.readRawByte());
   }
 
+  public void testMicroPrimitiveArrays() throws Exception {
+    NonPackedMicro msg = new NonPackedMicro();
+    assertEquals(0, msg.getInt32SCount());
+    assertEquals(0, msg.getInt32SArray().length);
+    for (int i = 0; i < 100; i++) {
+      msg.addInt32S(i);
+    }
+    assertEquals(100, msg.getInt32SCount());
+    assertEquals(42, msg.getInt32S(42));
+    msg.setInt32S(42, -1);
+    assertEquals(-1, msg.getInt32S(42));
+    int[] copy = msg.getInt32SArray();
+    assertEquals(100, copy.length);
+    assertEquals(-1, copy[42]);
+    try {
+      msg.getInt32S(100);
+      fail("Expected IndexOutOfBoundsException");
+    } catch (IndexOutOfBoundsException e) {
+      // pass
+    }
+
+    msg.clearInt32S();
+    assertEquals(0, msg.getInt32SCount());
+    try {
+      msg.setInt32S(0, 1);
+      fail("Expected IndexOutOfBoundsException");
+    } catch (IndexOutOfBoundsException e) {
+      // pass
+    }
+    msg.addInt32S(7);
+    assertEquals(1, msg.getInt32SCount());
+    assertEquals(7, msg.getInt32S(0));
+  }
+
+  public void testMicroRepeatedPackables() throws Exception {
+    NonPackedMicro nonPacked = new NonPackedMicro();
+    PackedMicro packed = new PackedMicro();
+    for (int i = 0; i < 3; i++) {
+      int v = i == 1 ? -123 : 456 * i;
+      nonPacked.addInt32S(v);
+      nonPacked.addInt64S(v * 1000000000L);
+      nonPacked.addUint32S(v);
+      nonPacked.addUint64S(v);
+      nonPacked.addSint32S(v);
+      nonPacked.addSint64S(v * 1000000000L);
+      nonPacked.addFixed32S(v);
+      nonPacked.addFixed64S(v);
+      nonPacked.addSfixed32S(v);
+      nonPacked.addSfixed64S(v);
+      nonPacked.addFloats(v / 7.0f);
+      nonPacked.addDoubles(v / 7.0);
+      nonPacked.addBools(i != 1);
+    }
+    nonPacked.setNoise(13);
+
+    // Unpacked -> packed.
+    byte[] nonPackedBytes = nonPacked.toByteArray();
+    packed.mergeFrom(nonPackedBytes);
+    assertPackablesEqual(nonPacked, packed);
+    assertEquals(13, packed.getNoise());
+
+    // Packed -> unpacked, once from a flat array and once through small
+    // blocks so the bulk readers take both their fast and slow paths.
+    byte[] packedBytes = packed.toByteArray();
+    assertTrue(packedBytes.length < nonPackedBytes.length);
+    assertEquals(packedBytes.length, packed.getSerializedSize());
+    NonPackedMicro fromFlat = new NonPackedMicro();
+    fromFlat.mergeFrom(packedBytes);
+    assertPackablesEqual(fromFlat, packed);
+    assertTrue(Arrays.equals(nonPackedBytes, fromFlat.toByteArray()));
+
+    NonPackedMicro fromBlocks = new NonPackedMicro();
+    fromBlocks.mergeFrom(CodedInputStreamMicro.newInstance(
+        new SmallBlockInputStream(packedBytes, 3)));
+    assertTrue(Arrays.equals(nonPackedBytes, fromBlocks.toByteArray()));
+
+    // Mixed: packed and unpacked runs of the same field are concatenated.
+    PackedMicro twice = new PackedMicro();
+    twice.mergeFrom(packedBytes);
+    twice.mergeFrom(nonPackedBytes);
+    assertEquals(6, twice.getSfixed64SCount());
+    assertEquals(packed.getSfixed64S(1), twice.getSfixed64S(4));
+  }
+
+  public void testMicroPackedHugeLength() throws Exception {
+    // A packed field claiming nearly 2^31 bytes, followed by a single value.
+    // The array must be sized by what is actually read, so parsing fails as
+    // truncated instead of running out of memory.
+    byte[][] inputs = {
+      { 0x12, (byte) 0xf0, (byte) 0xff, (byte) 0xff, (byte) 0xff, 0x07, 1 },
+      { 0x42, (byte) 0xf0, (byte) 0xff, (byte) 0xff, (byte) 0xff, 0x07,
+        1, 2, 3, 4, 5, 6, 7, 8 },
+      { 0x6a, (byte) 0xf0, (byte) 0xff, (byte) 0xff, (byte) 0xff, 0x07, 1 },
+    };
+    for (byte[] input : inputs) {
+      try {
+        new PackedMicro().mergeFrom(input);
+        fail("Should have thrown an exception.");
+      } catch (InvalidProtocolBufferMicroException e) {
+        // success.
+      }
+      try {
+        new PackedMicro().mergeFrom(CodedInputStreamMicro.newInstance(
+            new SmallBlockInputStream(input, 3)));
+        fail("Should have thrown an exception.");
+      } catch (InvalidProtocolBufferMicroException e) {
+        // success.
+      }
+    }
+  }
+
+  private void assertPackablesEqual(NonPackedMicro nonPacked, PackedMicro packed) {
+    assertTrue(Arrays.equals(nonPacked.getInt32SArray(), packed.getInt32SArray()));
+    assertTrue(Arrays.equals(nonPacked.getInt64SArray(), packed.getInt64SArray()));
+    assertTrue(Arrays.equals(nonPacked.getUint32SArray(), packed.getUint32SArray()));
+    assertTrue(Arrays.equals(nonPacked.getUint64SArray(), packed.getUint64SArray()));
+    assertTrue(Arrays.equals(nonPacked.getSint32SArray(), packed.getSint32SArray()));
+    assertTrue(Arrays.equals(nonPacked.getSint64SArray(), packed.getSint64SArray()));
+    assertTrue(Arrays.equals(nonPacked.getFixed32SArray(), packed.getFixed32SArray()));
+    assertTrue(Arrays.equals(nonPacked.getFixed64SArray(), packed.getFixed64SArray()));
+    assertTrue(Arrays.equals(nonPacked.getSfixed32SArray(), packed.getSfixed32SArray()));
+    assertTrue(Arrays.equals(nonPacked.getSfixed64SArray(), packed.getSfixed64SArray()));
+    assertTrue(Arrays.equals(nonPacked.getFloatsArray(), packed.getFloatsArray()));
+    assertTrue(Arrays.equals(nonPacked.getDoublesArray(), packed.getDoublesArray()));
+    assertTrue(Arrays.equals(nonPacked.getBoolsArray(), packed.getBoolsArray()));
+  }
+
   /**
    * An InputStream which limits the number of bytes it reads at a time.
    * We use this to make sure that CodedInputStream doesn't screw up when
@@ -0,0 +1,216 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2013 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+package com.google.protobuf;
+
+import com.google.protobuf.nano.InternalNano;
+import com.google.protobuf.nano.MessageNano;
+import com.google.protobuf.nano.NanoOuterClass.TestAllTypesNano;
+
+import java.util.HashMap;
+
+/**
+ * Measures the cost of parceling nano messages on a plain JVM.
+ * <p>
+ * {@code android.os.Parcel} is not available off-device, so {@link FakeParcel}
+ * stands in for it: like the real thing it copies byte arrays into its own
+ * storage on write and allocates a fresh array on {@code createByteArray()}.
+ * The two strategies below mirror the old and current bodies of
+ * {@code ParcelingUtil}.  This is not run as part of the test suite; run it
+ * with
+ * <pre>
+ *   java -cp target/classes:target/test-classes \
+ *       com.google.protobuf.NanoParcelingBenchmark [iterations]
+ * </pre>
+ */
+public class NanoParcelingBenchmark {
+
+  /** Minimal stand-in for the parts of {@code android.os.Parcel} we use. */
+  static final class FakeParcel {
+    private byte[] data = new byte[1024];
+    private int size;
+    private int position;
+    private final HashMap<Integer, String> strings = new HashMap<Integer, String>();
+
+    void reset() {
+      size = 0;
+      position = 0;
+    }
+
+    void setDataPosition(int pos) {
+      position = pos;
+    }
+
+    void writeString(String value) {
+      // Strings are interned by position; their cost is the same for both
+      // strategies and is not what is being measured.
+      strings.put(size, value);
+      writeInt(0);
+    }
+
+    String readString() {
+      String value = strings.get(position);
+      readInt();
+      return value;
+    }
+
+    void writeByteArray(byte[] b) {
+      writeByteArray(b, 0, b.length);
+    }
+
+    void writeByteArray(byte[] b, int offset, int len) {
+      writeInt(len);
+      ensureCapacity(len);
+      System.arraycopy(b, offset, data, size, len);
+      size += len;
+    }
+
+    byte[] createByteArray() {
+      int len = readInt();
+      byte[] result = new byte[len];
+      System.arraycopy(data, position, result, 0, len);
+      position += len;
+      return result;
+    }
+
+    private void writeInt(int value) {
+      ensureCapacity(4);
+      data[size++] = (byte) value;
+      data[size++] = (byte) (value >> 8);
+      data[size++] = (byte) (value >> 16);
+      data[size++] = (byte) (value >> 24);
+    }
+
+    private int readInt() {
+      int value = (data[position] & 0xff)
+          | (data[position + 1] & 0xff) << 8
+          | (data[position + 2] & 0xff) << 16
+          | (data[position + 3] & 0xff) << 24;
+      position += 4;
+      return value;
+    }
+
+    private void ensureCapacity(int extra) {
+      if (size + extra > data.length) {
+        byte[] grown = new byte[Math.max(data.length * 2, size + extra)];
+        System.arraycopy(data, 0, grown, 0, size);
+        data = grown;
+      }
+    }
+  }
+
+  private interface Strategy {
+    void write(MessageNano message, FakeParcel out);
+    MessageNano read(FakeParcel in) throws Exception;
+  }
+
+  /** What ParcelingUtil used to do: a fresh array and a class lookup per call. */
+  private static final Strategy ALLOCATING = new Strategy() {
+    public void write(MessageNano message, FakeParcel out) {
+      out.writeString(message.getClass().getName());
+      out.writeByteArray(MessageNano.toByteArray(message));
+    }
+
+    public MessageNano read(FakeParcel in) throws Exception {
+      String className = in.readString();
+      byte[] data = in.createByteArray();
+      MessageNano proto = (MessageNano) Class.forName(className).newInstance();
+      return MessageNano.mergeFrom(proto, data);
+    }
+  };
+
+  /** What ParcelingUtil does now: a per-thread buffer and a class cache. */
+  private static final Strategy SCRATCH = new Strategy() {
+    private final HashMap<String, Class<?>> classCache = new HashMap<String, Class<?>>();
+
+    public void write(MessageNano message, FakeParcel out) {
+      out.writeString(message.getClass().getName());
+      byte[] buffer = InternalNano.toScratchByteArray(message);
+      out.writeByteArray(buffer, 0, message.getCachedSize());
+    }
+
+    public MessageNano read(FakeParcel in) throws Exception {
+      String className = in.readString();
+      byte[] data = in.createByteArray();
+      Class<?> clazz = classCache.get(className);
+      if (clazz == null) {
+        clazz = Class.forName(className);
+        classCache.put(className, clazz);
+      }
+      return MessageNano.mergeFrom((MessageNano) clazz.newInstance(), data);
+    }
+  };
+
+  private static TestAllTypesNano buildLargeMessage() {
+    TestAllTypesNano message = new TestAllTypesNano();
+    message.optionalString = "parceling benchmark";
+    message.repeatedInt64 = new long[4096];
+    for (int i = 0; i < message.repeatedInt64.length; i++) {
+      message.repeatedInt64[i] = (long) i * 0x10001L;
+    }
+    message.repeatedString = new String[256];
+    for (int i = 0; i < message.repeatedString.length; i++) {
+      message.repeatedString[i] = "element " + i;
+    }
+    return message;
+  }
+
+  private static long run(Strategy strategy, MessageNano message, FakeParcel parcel,
+      int iterations) throws Exception {
+    long start = System.nanoTime();
+    for (int i = 0; i < iterations; i++) {
+      parcel.reset();
+      strategy.write(message, parcel);
+      parcel.setDataPosition(0);
+      if (strategy.read(parcel) == null) {
+        throw new IllegalStateException("unparceling failed");
+      }
+    }
+    return System.nanoTime() - start;
+  }
+
+  public static void main(String[] args) throws Exception {
+    int iterations = args.length > 0 ? Integer.parseInt(args[0]) : 2000;
+    TestAllTypesNano message = buildLargeMessage();
+    FakeParcel parcel = new FakeParcel();
+    int bytes = message.getSerializedSize();
+
+    // Warm up both paths before timing either.
+    run(ALLOCATING, message, parcel, iterations);
+    run(SCRATCH, message, parcel, iterations);
+
+    long allocating = run(ALLOCATING, message, parcel, iterations);
+    long scratch = run(SCRATCH, message, parcel, iterations);
+
+    System.out.println("message size: " + bytes + " bytes, iterations: " + iterations);
+    System.out.println("allocating: " + (allocating / iterations) + " ns/round trip");
+    System.out.println("scratch:    " + (scratch / iterations) + " ns/round trip");
+  }
+}
@@ -50,6 +50,8 @@ import com.google.protobuf.nano.NanoAccessorsOuterClass.TestNanoAccessors;
 import com.google.protobuf.nano.NanoHasOuterClass.TestAllTypesNanoHas;
 import com.google.protobuf.nano.NanoOuterClass;
 import com.google.protobuf.nano.NanoOuterClass.TestAllTypesNano;
+import com.google.protobuf.nano.NanoOuterClassReuse;
+import com.google.protobuf.nano.NanoOuterClassToString;
 import com.google.protobuf.nano.NanoReferenceTypes;
 import com.google.protobuf.nano.NanoRepeatedPackables;
 import com.google.protobuf.nano.PackedExtensions;
@@ -2656,6 +2658,66 @@ public class NanoTest extends TestCase {
     assertEquals(5, input.readRawByte());
   }
 
+  public void testNanoReuseOnClear() throws Exception {
+    TestAllTypesNano msg = new TestAllTypesNano();
+    msg.optionalNestedMessage = new TestAllTypesNano.NestedMessage();
+    msg.optionalNestedMessage.bb = 7;
+    msg.repeatedInt32 = new int[] { 1, 2, 3 };
+    msg.repeatedString = new String[] { "a", "b" };
+    msg.repeatedNestedMessage = new TestAllTypesNano.NestedMessage[2];
+    msg.repeatedNestedMessage[0] = new TestAllTypesNano.NestedMessage();
+    msg.repeatedNestedMessage[0].bb = 77;
+    msg.repeatedNestedMessage[1] = new TestAllTypesNano.NestedMessage();
+    msg.repeatedNestedMessage[1].bb = 88;
+    byte[] data = MessageNano.toByteArray(msg);
+
+    NanoOuterClassReuse.TestAllTypesNano reused =
+        NanoOuterClassReuse.TestAllTypesNano.parseFrom(data);
+    NanoOuterClassReuse.TestAllTypesNano.NestedMessage nested = reused.optionalNestedMessage;
+    int[] int32s = reused.repeatedInt32;
+    String[] strings = reused.repeatedString;
+    NanoOuterClassReuse.TestAllTypesNano.NestedMessage[] nestedArray =
+        reused.repeatedNestedMessage;
+    NanoOuterClassReuse.TestAllTypesNano.NestedMessage nested0 = nestedArray[0];
+
+    // clear() still resets every field.
+    reused.clear();
+    assertNull(reused.optionalNestedMessage);
+    assertEquals(0, reused.repeatedInt32.length);
+    assertEquals(0, reused.repeatedString.length);
+    assertEquals(0, reused.repeatedNestedMessage.length);
+
+    // Parsing the same shape again reuses every sub-message and array.
+    MessageNano.mergeFrom(reused, data);
+    assertSame(nested, reused.optionalNestedMessage);
+    assertSame(int32s, reused.repeatedInt32);
+    assertSame(strings, reused.repeatedString);
+    assertSame(nestedArray, reused.repeatedNestedMessage);
+    assertEquals(7, reused.optionalNestedMessage.bb);
+    assertEquals(88, reused.repeatedNestedMessage[1].bb);
+    assertTrue(Arrays.equals(data, MessageNano.toByteArray(reused)));
+
+    // A different element count needs a new array, but the elements are still reused.
+    msg.repeatedNestedMessage = new TestAllTypesNano.NestedMessage[] {
+        msg.repeatedNestedMessage[0], msg.repeatedNestedMessage[1],
+        new TestAllTypesNano.NestedMessage() };
+    msg.repeatedNestedMessage[2].bb = 99;
+    data = MessageNano.toByteArray(msg);
+    reused.clear();
+    MessageNano.mergeFrom(reused, data);
+    assertNotSame(nestedArray, reused.repeatedNestedMessage);
+    assertEquals(3, reused.repeatedNestedMessage.length);
+    assertSame(nested0, reused.repeatedNestedMessage[0]);
+    assertEquals(77, reused.repeatedNestedMessage[0].bb);
+    assertEquals(99, reused.repeatedNestedMessage[2].bb);
+    assertTrue(Arrays.equals(data, MessageNano.toByteArray(reused)));
+
+    // Without clear(), repeated fields are still appended to.
+    MessageNano.mergeFrom(reused, data);
+    assertEquals(6, reused.repeatedNestedMessage.length);
+    assertEquals(6, reused.repeatedInt32.length);
+  }
+
   // Test a smattering of various proto types for printing
   public void testMessageNanoPrinter() {
     TestAllTypesNano msg = new TestAllTypesNano();
@@ -2712,6 +2774,76 @@ public class NanoTest extends TestCase {
     assertTrue(protoPrint.contains("repeated_string_piece: \"world\""));
   }
 
+  public void testMessageNanoPrinterGenerated() throws Exception {
+    TestAllTypesNano msg = new TestAllTypesNano();
+    msg.optionalInt32 = 14;
+    msg.optionalFloat = 42.3f;
+    msg.optionalString = "String \"with' both quotes";
+    msg.optionalBytes = new byte[] {'"', '\0', 1, 8, (byte) 0xff};
+    msg.optionalGroup = new TestAllTypesNano.OptionalGroup();
+    msg.optionalGroup.a = 15;
+    msg.repeatedInt64 = new long[] { 1L, -1L };
+    msg.repeatedBytes = new byte[][] { {'h', 'e', 'l', 'l', 'o'} };
+    msg.repeatedNestedMessage = new TestAllTypesNano.NestedMessage[2];
+    msg.repeatedNestedMessage[0] = new TestAllTypesNano.NestedMessage();
+    msg.repeatedNestedMessage[0].bb = 77;
+    msg.repeatedNestedMessage[1] = new TestAllTypesNano.NestedMessage();
+    msg.repeatedNestedMessage[1].bb = 88;
+    msg.optionalImportMessage = new UnittestImportNano.ImportMessageNano();
+    msg.optionalImportMessage.d = 5;
+    msg.optionalNestedEnum = TestAllTypesNano.BAZ;
+    msg.repeatedNestedEnum = new int[] { TestAllTypesNano.BAR, TestAllTypesNano.FOO };
+    msg.repeatedStringPiece = new String[] { "world" };
+
+    // Same message, with a generated printTo().
+    NanoOuterClassToString.TestAllTypesNano generatedMsg =
+        NanoOuterClassToString.TestAllTypesNano.parseFrom(MessageNano.toByteArray(msg));
+
+    String protoPrint = generatedMsg.toString();
+    assertTrue(protoPrint.contains("optional_int32: 14"));
+    assertTrue(protoPrint.contains("optional_float: 42.3"));
+    assertTrue(protoPrint.contains("optional_double: 0.0"));
+    assertTrue(protoPrint.contains("optional_string: \"String \\u0022with\\u0027 both quotes\""));
+    assertTrue(protoPrint.contains("optional_bytes: \"\\\"\\000\\001\\010\\377\""));
+    assertTrue(protoPrint.contains("optional_group <\n  a: 15\n>"));
+    assertTrue(protoPrint.contains("repeated_int64: 1\nrepeated_int64: -1"));
+    assertTrue(protoPrint.contains("repeated_bytes: \"hello\""));
+    assertTrue(protoPrint.contains("repeated_nested_message <\n  bb: 77\n>\n"
+            + "repeated_nested_message <\n  bb: 88\n>"));
+    // Imported message printed by reflection, nested in generated code.
+    assertTrue(protoPrint.contains("optional_import_message <\n  d: 5\n>"));
+    assertTrue(protoPrint.contains("optional_nested_enum: 3"));
+    assertTrue(protoPrint.contains("repeated_nested_enum: 2\nrepeated_nested_enum: 1"));
+    assertTrue(protoPrint.contains("default_int32: 41"));
+    assertTrue(protoPrint.contains("default_string: \"hello\""));
+    assertTrue(protoPrint.contains("repeated_string_piece: \"world\""));
+
+    // The generated printer goes in field number order.
+    int lastPosition = -1;
+    for (String field : new String[] {
+        "optional_int32:", "optional_float:", "optional_string:", "optional_bytes:",
+        "optional_group <", "optional_import_message <", "optional_nested_enum:",
+        "repeated_int64:", "repeated_bytes:", "repeated_nested_message <",
+        "repeated_nested_enum:", "repeated_string_piece:", "default_int32:",
+        "default_string:"}) {
+      int position = protoPrint.indexOf("\n" + field);
+      if (protoPrint.startsWith(field)) {
+        position = 0;
+      }
+      assertTrue(field, position > lastPosition);
+      lastPosition = position;
+    }
+
+    // The reflection-based printer prints the same lines, though not
+    // necessarily in the same order, since reflection doesn't report field
+    // numbers.
+    String[] reflectionLines = msg.toString().split("\n");
+    String[] generatedLines = protoPrint.split("\n");
+    Arrays.sort(reflectionLines);
+    Arrays.sort(generatedLines);
+    assertTrue(Arrays.equals(reflectionLines, generatedLines));
+  }
+
   public void testMessageNanoPrinterAccessors() throws Exception {
     TestNanoAccessors msg = new TestNanoAccessors();
     msg.setOptionalInt32(13);
@@ -3577,6 +3709,50 @@ public class NanoTest extends TestCase {
     assertTrue(Arrays.equals(nonPacked.enums, packed.enums));
   }
 
+  public void testToScratchByteArray() throws Exception {
+    TestAllTypesNano small = new TestAllTypesNano();
+    small.optionalInt32 = 123;
+    byte[] expectedSmall = MessageNano.toByteArray(small);
+
+    byte[] buffer = InternalNano.toScratchByteArray(small);
+    assertEquals(expectedSmall.length, small.getCachedSize());
+    assertBufferStartsWith(expectedSmall, buffer);
+
+    // The same buffer is handed back while the message fits.
+    assertSame(buffer, InternalNano.toScratchByteArray(small));
+
+    // A larger message grows the buffer and still encodes correctly.
+    TestAllTypesNano large = new TestAllTypesNano();
+    large.repeatedInt32 = new int[1000];
+    Arrays.fill(large.repeatedInt32, 0x7fffffff);
+    byte[] expectedLarge = MessageNano.toByteArray(large);
+    byte[] grown = InternalNano.toScratchByteArray(large);
+    assertBufferStartsWith(expectedLarge, grown);
+
+    TestAllTypesNano parsed = new TestAllTypesNano();
+    MessageNano.mergeFrom(parsed, grown, 0, large.getCachedSize());
+    assertEquals(1000, parsed.repeatedInt32.length);
+
+    // A message above the 64 KB cap gets a buffer of its own, which is not
+    // kept for the next call.
+    TestAllTypesNano huge = new TestAllTypesNano();
+    huge.optionalBytes = new byte[100 * 1024];
+    byte[] expectedHuge = MessageNano.toByteArray(huge);
+    byte[] temporary = InternalNano.toScratchByteArray(huge);
+    assertEquals(expectedHuge.length, temporary.length);
+    assertBufferStartsWith(expectedHuge, temporary);
+    byte[] reused = InternalNano.toScratchByteArray(small);
+    assertNotSame(temporary, reused);
+    assertSame(grown, reused);
+  }
+
+  private static void assertBufferStartsWith(byte[] expected, byte[] buffer) {
+    assertTrue(buffer.length >= expected.length);
+    for (int i = 0; i < expected.length; i++) {
+      assertEquals("Mismatch at byte " + i, expected[i], buffer[i]);
+    }
+  }
+
   private void assertHasWireData(MessageNano message, boolean expected) {
     byte[] bytes = MessageNano.toByteArray(message);
     int wireLength = bytes.length;
@@ -44,6 +44,11 @@ file, in types that make this information accessible in Python.
 
 __author__ = 'robinson@google.com (Will Robinson)'
 
+from google.protobuf.internal import api_implementation
+
+if api_implementation.Type() == 'cpp':
+  from google.protobuf.internal import _net_proto2___python
+
 
 class Error(Exception):
   """Base error for this module."""
@@ -570,6 +575,11 @@ class FileDescriptor(DescriptorBase):
     self.name = name
     self.package = package
     self.serialized_pb = serialized_pb
+    if (api_implementation.Type() == 'cpp' and
+        self.serialized_pb is not None):
+      # The C++ implementation needs the file in its own descriptor pool
+      # before any of its message classes are created.
+      _net_proto2___python.BuildFile(self.serialized_pb)
 
   def CopyToProto(self, proto):
     """Copies this to a descriptor_pb2.FileDescriptorProto.
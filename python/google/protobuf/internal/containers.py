@@ -128,6 +128,15 @@ class RepeatedScalarFieldContainer(BaseContainer):
     self._values.extend(other._values)
     self._message_listener.Modified()
 
+  def _ExtendUnchecked(self, elem_seq):
+    """Like extend(), but does not type-check the elements.  Only for use by
+    the decoder on values it produced itself.
+    """
+    if not elem_seq:
+      return
+    self._values.extend(elem_seq)
+    self._message_listener.Modified()
+
   def remove(self, elem):
     """Removes an item from the list. Similar to list.remove()."""
     self._values.remove(elem)
@@ -0,0 +1,754 @@
+# Protocol Buffers - Google's data interchange format
+# Copyright 2008 Google Inc.  All rights reserved.
+# http://code.google.com/p/protobuf/
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Contains helper functions used to create protocol message classes from
+Descriptor objects at runtime, backed by the protocol buffer C++ API.
+
+This is the counterpart of the pure-Python code in reflection.py, used when
+api_implementation.Type() is 'cpp'.  Each message object owns a CMessage from
+the _net_proto2___python extension module, which wraps a C++ DynamicMessage
+built from the serialized descriptors that generated modules embed.
+Parsing, serialization, merging and the required-field checks all run in
+C++; this module type-checks values and presents the same Python API as the
+pure-Python implementation.
+
+Sub-message and repeated-field objects returned by a message are views onto
+the parent's C++ object.  Before the parent clears or removes the C++ object
+behind such a view, the view is detached: it takes ownership of its current
+contents, matching the pure-Python behavior where a cleared sub-message keeps
+its values.
+"""
+
+from google.protobuf.internal import _net_proto2___python
+from google.protobuf.internal import type_checkers
+from google.protobuf import descriptor as descriptor_mod
+from google.protobuf import message as message_mod
+from google.protobuf import text_format
+
+_FieldDescriptor = descriptor_mod.FieldDescriptor
+_LABEL_REPEATED = _FieldDescriptor.LABEL_REPEATED
+_CPPTYPE_MESSAGE = _FieldDescriptor.CPPTYPE_MESSAGE
+
+
+def _GetCDescriptor(field):
+  """Returns the C++ descriptor for a Python FieldDescriptor, caching it on
+  the FieldDescriptor."""
+  try:
+    return field._cdescriptor
+  except AttributeError:
+    if field.is_extension:
+      cdescriptor = _net_proto2___python.GetExtensionDescriptor(
+          field.full_name)
+    else:
+      cdescriptor = _net_proto2___python.GetFieldDescriptor(field.full_name)
+    field._cdescriptor = cdescriptor
+    return cdescriptor
+
+
+def _NewWrapper(message_descriptor, cmessage):
+  """Returns a message object of the given type wrapping cmessage."""
+  cls = message_descriptor._concrete_class
+  result = cls.__new__(cls)
+  result._cmsg = cmessage
+  result._composite_fields = {}
+  return result
+
+
+def _NormalizeIndex(key, length):
+  if key < 0:
+    key += length
+  if key < 0 or key >= length:
+    raise IndexError('list index out of range')
+  return key
+
+
+def _SortedIndices(key, length):
+  """Returns the indices selected by an int or slice key, in ascending order.
+  """
+  indices = range(length)[key]
+  if isinstance(indices, list):
+    indices.sort()
+    return indices
+  return [indices]
+
+
+class RepeatedScalarContainer(object):
+
+  """List-like view of a repeated scalar field of a C++ message.
+
+  Simple reads and appends go straight to C++.  The rarer list edits
+  (insert, remove, slice assignment and deletion) rewrite the whole field.
+  """
+
+  __slots__ = ['_cmsg', '_cdescriptor', '_type_checker', '_values']
+
+  def __init__(self, cmessage, field):
+    self._cmsg = cmessage
+    self._cdescriptor = _GetCDescriptor(field)
+    self._type_checker = type_checkers.GetTypeChecker(field.cpp_type,
+                                                      field.type)
+    self._values = None
+
+  def _GetList(self):
+    if self._cmsg is None:
+      return list(self._values)
+    return self._cmsg.GetRepeatedList(self._cdescriptor)
+
+  def _SetList(self, values):
+    if self._cmsg is None:
+      self._values = values
+    else:
+      self._cmsg.AssignRepeated(self._cdescriptor, values)
+
+  def _Detach(self):
+    """Stops tracking the message, keeping a copy of the current values."""
+    self._values = self._GetList()
+    self._cmsg = None
+
+  def append(self, value):
+    """Appends an item to the list. Similar to list.append()."""
+    self._type_checker.CheckValue(value)
+    if self._cmsg is None:
+      self._values.append(value)
+    else:
+      self._cmsg.AddRepeated(self._cdescriptor, value)
+
+  def insert(self, key, value):
+    """Inserts the item at the specified position. Similar to list.insert()."""
+    self._type_checker.CheckValue(value)
+    values = self._GetList()
+    values.insert(key, value)
+    self._SetList(values)
+
+  def extend(self, elem_seq):
+    """Extends by appending the given sequence. Similar to list.extend()."""
+    if not elem_seq:
+      return
+    new_values = []
+    for elem in elem_seq:
+      self._type_checker.CheckValue(elem)
+      new_values.append(elem)
+    if self._cmsg is None:
+      self._values.extend(new_values)
+    else:
+      for value in new_values:
+        self._cmsg.AddRepeated(self._cdescriptor, value)
+
+  def MergeFrom(self, other):
+    """Appends the contents of another repeated field of the same type to this
+    one."""
+    self.extend(other._GetList())
+
+  def remove(self, elem):
+    """Removes an item from the list. Similar to list.remove()."""
+    values = self._GetList()
+    values.remove(elem)
+    self._SetList(values)
+
+  def __getitem__(self, key):
+    """Retrieves item by the specified key."""
+    if self._cmsg is not None and isinstance(key, (int, long)):
+      return self._cmsg.GetRepeated(
+          self._cdescriptor, _NormalizeIndex(key, len(self)))
+    return self._GetList()[key]
+
+  def __setitem__(self, key, value):
+    """Sets the item on the specified position."""
+    self._type_checker.CheckValue(value)
+    if self._cmsg is not None and isinstance(key, (int, long)):
+      self._cmsg.SetRepeated(
+          self._cdescriptor, _NormalizeIndex(key, len(self)), value)
+    else:
+      values = self._GetList()
+      values[key] = value
+      self._SetList(values)
+
+  def __getslice__(self, start, stop):
+    """Retrieves the subset of items from between the specified indices."""
+    return self._GetList()[start:stop]
+
+  def __setslice__(self, start, stop, values):
+    """Sets the subset of items from between the specified indices."""
+    new_values = []
+    for value in values:
+      self._type_checker.CheckValue(value)
+      new_values.append(value)
+    all_values = self._GetList()
+    all_values[start:stop] = new_values
+    self._SetList(all_values)
+
+  def __delitem__(self, key):
+    """Deletes the item at the specified position."""
+    values = self._GetList()
+    del values[key]
+    self._SetList(values)
+
+  def __delslice__(self, start, stop):
+    """Deletes the subset of items from between the specified indices."""
+    values = self._GetList()
+    del values[start:stop]
+    self._SetList(values)
+
+  def __len__(self):
+    """Returns the number of elements in the container."""
+    if self._cmsg is None:
+      return len(self._values)
+    return self._cmsg.FieldLength(self._cdescriptor)
+
+  def __iter__(self):
+    return iter(self._GetList())
+
+  def __eq__(self, other):
+    """Compares the current instance with another one."""
+    if self is other:
+      return True
+    if isinstance(other, self.__class__):
+      return other._GetList() == self._GetList()
+    # We are presumably comparing against some other sequence type.
+    return other == self._GetList()
+
+  def __ne__(self, other):
+    """Checks if another instance isn't equal to this one."""
+    return not self == other
+
+  def __repr__(self):
+    return repr(self._GetList())
+
+
+class RepeatedCompositeContainer(object):
+
+  """List-like view of a repeated message field of a C++ message.
+
+  Element wrappers are created once and kept in _values, so the same Python
+  object is returned for an element each time.  Elements appended in C++
+  (by parsing or merging into the parent) are wrapped when next accessed.
+  """
+
+  __slots__ = ['_cmsg', '_cdescriptor', '_message_descriptor', '_values']
+
+  def __init__(self, cmessage, field):
+    self._cmsg = cmessage
+    self._cdescriptor = _GetCDescriptor(field)
+    self._message_descriptor = field.message_type
+    self._values = []
+
+  def _Sync(self):
+    values = self._values
+    if self._cmsg is not None:
+      size = self._cmsg.FieldLength(self._cdescriptor)
+      for index in xrange(len(values), size):
+        values.append(_NewWrapper(
+            self._message_descriptor,
+            self._cmsg.GetRepeatedMessage(self._cdescriptor, index)))
+    return values
+
+  def _Detach(self):
+    """Detaches every element, and stops tracking the message."""
+    for element in self._Sync():
+      element._cmsg.Detach()
+    self._cmsg = None
+
+  def add(self):
+    values = self._Sync()
+    if self._cmsg is None:
+      new_element = self._message_descriptor._concrete_class()
+    else:
+      new_element = _NewWrapper(self._message_descriptor,
+                                self._cmsg.AddMessage(self._cdescriptor))
+    values.append(new_element)
+    return new_element
+
+  def MergeFrom(self, other):
+    """Appends the contents of another repeated field of the same type to this
+    one, copying each individual message.
+    """
+    for message in other._Sync():
+      self.add().MergeFrom(message)
+
+  def __getitem__(self, key):
+    """Retrieves item by the specified key."""
+    return self._Sync()[key]
+
+  def __getslice__(self, start, stop):
+    """Retrieves the subset of items from between the specified indices."""
+    return self._Sync()[start:stop]
+
+  def _Delete(self, key):
+    values = self._Sync()
+    indices = _SortedIndices(key, len(values))
+    if self._cmsg is not None:
+      for index in indices:
+        values[index]._cmsg.Detach()
+      self._cmsg.DeleteRepeated(self._cdescriptor, indices)
+    del values[key]
+
+  def __delitem__(self, key):
+    """Deletes the item at the specified position."""
+    self._Delete(key)
+
+  def __delslice__(self, start, stop):
+    """Deletes the subset of items from between the specified indices."""
+    self._Delete(slice(start, stop))
+
+  def __len__(self):
+    """Returns the number of elements in the container."""
+    if self._cmsg is None:
+      return len(self._values)
+    return self._cmsg.FieldLength(self._cdescriptor)
+
+  def __iter__(self):
+    return iter(self._Sync())
+
+  def __eq__(self, other):
+    """Compares the current instance with another one."""
+    if self is other:
+      return True
+    if not isinstance(other, self.__class__):
+      raise TypeError('Can only compare repeated composite fields against '
+                      'other repeated composite fields.')
+    return self._Sync() == other._Sync()
+
+  def __ne__(self, other):
+    """Checks if another instance isn't equal to this one."""
+    return not self == other
+
+  def __repr__(self):
+    return repr(self._Sync())
+
+
+def _DetachFieldValue(value):
+  """Detaches a cached sub-message or repeated field from its parent."""
+  if isinstance(value, (RepeatedScalarContainer, RepeatedCompositeContainer)):
+    value._Detach()
+  else:
+    value._cmsg.Detach()
+
+
+def _GetCompositeValue(message, field):
+  """Returns the cached view for a composite or repeated field, creating it
+  the first time the field is accessed."""
+  value = message._composite_fields.get(field)
+  if value is None:
+    if field.label == _LABEL_REPEATED:
+      if field.cpp_type == _CPPTYPE_MESSAGE:
+        value = RepeatedCompositeContainer(message._cmsg, field)
+      else:
+        value = RepeatedScalarContainer(message._cmsg, field)
+    else:
+      value = _NewWrapper(field.message_type,
+                          message._cmsg.NewSubMessage(_GetCDescriptor(field)))
+    message._composite_fields[field] = value
+  return value
+
+
+def _VerifyExtensionHandle(message, extension_handle):
+  """Verify that the given extension handle is valid."""
+
+  if not isinstance(extension_handle, _FieldDescriptor):
+    raise KeyError('HasExtension() expects an extension handle, got: %s' %
+                   extension_handle)
+
+  if not extension_handle.is_extension:
+    raise KeyError('"%s" is not an extension.' % extension_handle.full_name)
+
+  if extension_handle.containing_type is not message.DESCRIPTOR:
+    raise KeyError('Extension "%s" extends message type "%s", but this '
+                   'message is of type "%s".' %
+                   (extension_handle.full_name,
+                    extension_handle.containing_type.full_name,
+                    message.DESCRIPTOR.full_name))
+
+
+class ExtensionDict(object):
+
+  """Dict-like container for the "Extensions" field of a C++-backed message.
+  """
+
+  def __init__(self, extended_message):
+    self._extended_message = extended_message
+
+  def __getitem__(self, extension_handle):
+    """Returns the current value of the given extension handle."""
+    _VerifyExtensionHandle(self._extended_message, extension_handle)
+    if (extension_handle.label == _LABEL_REPEATED or
+        extension_handle.cpp_type == _CPPTYPE_MESSAGE):
+      return _GetCompositeValue(self._extended_message, extension_handle)
+    return self._extended_message._cmsg.Get(_GetCDescriptor(extension_handle))
+
+  def __eq__(self, other):
+    if not isinstance(other, self.__class__):
+      return False
+
+    my_fields = self._extended_message.ListFields()
+    other_fields = other._extended_message.ListFields()
+
+    # Get rid of non-extension fields.
+    my_fields = [field for field in my_fields if field[0].is_extension]
+    other_fields = [field for field in other_fields if field[0].is_extension]
+
+    return my_fields == other_fields
+
+  def __ne__(self, other):
+    return not self == other
+
+  def __setitem__(self, extension_handle, value):
+    """If extension_handle specifies a non-repeated, scalar extension
+    field, sets the value of that field.
+    """
+    _VerifyExtensionHandle(self._extended_message, extension_handle)
+
+    if (extension_handle.label == _LABEL_REPEATED or
+        extension_handle.cpp_type == _CPPTYPE_MESSAGE):
+      raise TypeError(
+          'Cannot assign to extension "%s" because it is a repeated or '
+          'composite type.' % extension_handle.full_name)
+
+    type_checker = type_checkers.GetTypeChecker(
+        extension_handle.cpp_type, extension_handle.type)
+    type_checker.CheckValue(value)
+    self._extended_message._cmsg.Set(_GetCDescriptor(extension_handle), value)
+
+  def _FindExtensionByName(self, name):
+    """Tries to find a known extension with the specified name.
+
+    Args:
+      name: Extension full name.
+
+    Returns:
+      Extension field descriptor.
+    """
+    return self._extended_message._extensions_by_name.get(name, None)
+
+
+def NewMessage(descriptor, dictionary):
+  """Prepares the class dictionary of a C++-backed message class; called from
+  GeneratedProtocolMessageType.__new__."""
+  _AddClassAttributesForNestedExtensions(descriptor, dictionary)
+  dictionary['__slots__'] = ['_cmsg', '_composite_fields', '__weakref__']
+
+
+def InitMessage(descriptor, cls):
+  """Fills in a C++-backed message class; called from
+  GeneratedProtocolMessageType.__init__."""
+  cls._extensions_by_name = {}
+  cls._extensions_by_number = {}
+  if not hasattr(descriptor, '_concrete_class'):
+    descriptor._concrete_class = cls
+
+  _AddEnumValues(descriptor, cls)
+  _AddInitMethod(descriptor, cls)
+  _AddPropertiesForFields(descriptor, cls)
+  _AddPropertiesForExtensions(descriptor, cls)
+  _AddStaticMethods(cls)
+  _AddMessageMethods(descriptor, cls)
+
+
+def _AddClassAttributesForNestedExtensions(descriptor, dictionary):
+  extension_dict = descriptor.extensions_by_name
+  for extension_name, extension_field in extension_dict.iteritems():
+    assert extension_name not in dictionary
+    dictionary[extension_name] = extension_field
+
+
+def _AddEnumValues(descriptor, cls):
+  """Sets class-level attributes for all enum fields defined in this message.
+  """
+  for enum_type in descriptor.enum_types:
+    for enum_value in enum_type.values:
+      setattr(cls, enum_value.name, enum_value.number)
+
+
+def _AddInitMethod(message_descriptor, cls):
+  """Adds an __init__ method to cls."""
+  full_message_name = message_descriptor.full_name
+  new_cmessage = _net_proto2___python.NewCMessage
+
+  def init(self, **kwargs):
+    self._cmsg = new_cmessage(full_message_name)
+    self._composite_fields = {}
+    for field_name, field_value in kwargs.iteritems():
+      try:
+        field = message_descriptor.fields_by_name[field_name]
+      except KeyError:
+        raise ValueError('Protocol message has no "%s" field.' % field_name)
+      if field.label == _LABEL_REPEATED:
+        container = _GetCompositeValue(self, field)
+        if field.cpp_type == _CPPTYPE_MESSAGE:
+          for val in field_value:
+            container.add().MergeFrom(val)
+        else:
+          container.extend(field_value)
+      elif field.cpp_type == _CPPTYPE_MESSAGE:
+        _GetCompositeValue(self, field).MergeFrom(field_value)
+      else:
+        setattr(self, field_name, field_value)
+
+  init.__module__ = None
+  init.__doc__ = None
+  cls.__init__ = init
+
+
+def _AddPropertiesForFields(descriptor, cls):
+  """Adds properties for all fields in this protocol message type."""
+  for field in descriptor.fields:
+    _AddPropertiesForField(field, cls)
+
+  if descriptor.is_extendable:
+    cls.Extensions = property(lambda self: ExtensionDict(self))
+
+
+def _AddPropertiesForField(field, cls):
+  """Adds a public property for a protocol message field."""
+  constant_name = field.name.upper() + "_FIELD_NUMBER"
+  setattr(cls, constant_name, field.number)
+
+  proto_field_name = field.name
+  doc = 'Magic attribute generated for "%s" proto field.' % proto_field_name
+
+  if field.label == _LABEL_REPEATED or field.cpp_type == _CPPTYPE_MESSAGE:
+    def getter(self):
+      return _GetCompositeValue(self, field)
+
+    if field.label == _LABEL_REPEATED:
+      kind = 'repeated'
+    else:
+      kind = 'composite'
+    def setter(self, new_value):
+      raise AttributeError('Assignment not allowed to %s field '
+                           '"%s" in protocol message object.' %
+                           (kind, proto_field_name))
+  else:
+    cdescriptor = _GetCDescriptor(field)
+    type_checker = type_checkers.GetTypeChecker(field.cpp_type, field.type)
+
+    def getter(self):
+      return self._cmsg.Get(cdescriptor)
+
+    def setter(self, new_value):
+      type_checker.CheckValue(new_value)
+      self._cmsg.Set(cdescriptor, new_value)
+
+  getter.__module__ = None
+  getter.__doc__ = 'Getter for %s.' % proto_field_name
+  setter.__module__ = None
+  setter.__doc__ = 'Setter for %s.' % proto_field_name
+  setattr(cls, proto_field_name, property(getter, setter, doc=doc))
+
+
+def _AddPropertiesForExtensions(descriptor, cls):
+  """Adds properties for all fields in this protocol message type."""
+  extension_dict = descriptor.extensions_by_name
+  for extension_name, extension_field in extension_dict.iteritems():
+    constant_name = extension_name.upper() + "_FIELD_NUMBER"
+    setattr(cls, constant_name, extension_field.number)
+
+
+def _IsMessageSetExtension(field):
+  return (field.is_extension and
+          field.containing_type.has_options and
+          field.containing_type.GetOptions().message_set_wire_format and
+          field.type == _FieldDescriptor.TYPE_MESSAGE and
+          field.message_type == field.extension_scope and
+          field.label == _FieldDescriptor.LABEL_OPTIONAL)
+
+
+def _AddStaticMethods(cls):
+
+  def RegisterExtension(extension_handle):
+    extension_handle.containing_type = cls.DESCRIPTOR
+    _GetCDescriptor(extension_handle)
+
+    actual_handle = cls._extensions_by_number.setdefault(
+        extension_handle.number, extension_handle)
+    if actual_handle is not extension_handle:
+      raise AssertionError(
+          'Extensions "%s" and "%s" both try to extend message type "%s" with '
+          'field number %d.' %
+          (extension_handle.full_name, actual_handle.full_name,
+           cls.DESCRIPTOR.full_name, extension_handle.number))
+
+    cls._extensions_by_name[extension_handle.full_name] = extension_handle
+
+    if _IsMessageSetExtension(extension_handle):
+      # MessageSet extension.  Also register under type name.
+      cls._extensions_by_name[
+          extension_handle.message_type.full_name] = extension_handle
+
+  cls.RegisterExtension = staticmethod(RegisterExtension)
+
+  def FromString(string):
+    msg = cls()
+    msg.MergeFromString(string)
+    return msg
+  cls.FromString = staticmethod(FromString)
+
+
+def _AddMessageMethods(message_descriptor, cls):
+  """Adds implementations of all Message methods to cls."""
+
+  fields_by_name = message_descriptor.fields_by_name
+  fields_by_number = message_descriptor.fields_by_number
+
+  singular_fields = {}
+  for field in message_descriptor.fields:
+    if field.label != _LABEL_REPEATED:
+      singular_fields[field.name] = field
+
+  def _GetFieldValue(self, field):
+    if field.label == _LABEL_REPEATED or field.cpp_type == _CPPTYPE_MESSAGE:
+      return _GetCompositeValue(self, field)
+    return self._cmsg.Get(_GetCDescriptor(field))
+
+  def _DetachField(self, field):
+    value = self._composite_fields.pop(field, None)
+    if value is not None:
+      _DetachFieldValue(value)
+
+  def ListFields(self):
+    all_fields = []
+    for number, is_extension in self._cmsg.ListFields():
+      if is_extension:
+        field = self._extensions_by_number.get(number)
+        if field is None:
+          # Known to the C++ pool but never registered with this class.
+          continue
+      else:
+        field = fields_by_number[number]
+      all_fields.append((field, _GetFieldValue(self, field)))
+    return all_fields
+  cls.ListFields = ListFields
+
+  def HasField(self, field_name):
+    try:
+      field = singular_fields[field_name]
+    except KeyError:
+      raise ValueError(
+          'Protocol message has no singular "%s" field.' % field_name)
+    return self._cmsg.HasField(_GetCDescriptor(field))
+  cls.HasField = HasField
+
+  def ClearField(self, field_name):
+    try:
+      field = fields_by_name[field_name]
+    except KeyError:
+      raise ValueError('Protocol message has no "%s" field.' % field_name)
+    _DetachField(self, field)
+    self._cmsg.ClearField(_GetCDescriptor(field))
+  cls.ClearField = ClearField
+
+  if message_descriptor.is_extendable:
+    def HasExtension(self, extension_handle):
+      _VerifyExtensionHandle(self, extension_handle)
+      if extension_handle.label == _LABEL_REPEATED:
+        raise KeyError('"%s" is repeated.' % extension_handle.full_name)
+      return self._cmsg.HasField(_GetCDescriptor(extension_handle))
+    cls.HasExtension = HasExtension
+
+    def ClearExtension(self, extension_handle):
+      _VerifyExtensionHandle(self, extension_handle)
+      _DetachField(self, extension_handle)
+      self._cmsg.ClearField(_GetCDescriptor(extension_handle))
+    cls.ClearExtension = ClearExtension
+
+  def Clear(self):
+    for value in self._composite_fields.itervalues():
+      _DetachFieldValue(value)
+    self._composite_fields = {}
+    self._cmsg.Clear()
+  cls.Clear = Clear
+
+  def __eq__(self, other):
+    if (not isinstance(other, message_mod.Message) or
+        other.DESCRIPTOR != self.DESCRIPTOR):
+      return False
+
+    if self is other:
+      return True
+
+    return self.ListFields() == other.ListFields()
+  cls.__eq__ = __eq__
+
+  def __str__(self):
+    return text_format.MessageToString(self)
+  cls.__str__ = __str__
+
+  def SetInParent(self):
+    self._cmsg.SetInParent()
+  cls.SetInParent = SetInParent
+
+  def ByteSize(self):
+    return self._cmsg.ByteSize()
+  cls.ByteSize = ByteSize
+
+  def SerializeToString(self):
+    if not self._cmsg.IsInitialized():
+      raise message_mod.EncodeError(
+          'Message is missing required fields: ' +
+          ','.join(self._cmsg.FindInitializationErrors()))
+    return self._cmsg.SerializePartialToString()
+  cls.SerializeToString = SerializeToString
+
+  def SerializePartialToString(self):
+    return self._cmsg.SerializePartialToString()
+  cls.SerializePartialToString = SerializePartialToString
+
+  def MergeFromString(self, serialized):
+    length = self._cmsg.MergeFromString(serialized)
+    if length < 0:
+      raise message_mod.DecodeError('Error parsing message.')
+    return length
+  cls.MergeFromString = MergeFromString
+
+  def InternalParse(self, buffer, pos, end):
+    # Only here for callers that parse a sub-range of a buffer; C++ always
+    # consumes the whole range or fails.
+    self.MergeFromString(buffer[pos:end])
+    return end
+  cls._InternalParse = InternalParse
+
+  def IsInitialized(self, errors=None):
+    if self._cmsg.IsInitialized():
+      return True
+    if errors is not None:
+      errors.extend(self.FindInitializationErrors())
+    return False
+  cls.IsInitialized = IsInitialized
+
+  def FindInitializationErrors(self):
+    return self._cmsg.FindInitializationErrors()
+  cls.FindInitializationErrors = FindInitializationErrors
+
+  def MergeFrom(self, msg):
+    assert msg is not self
+    if not isinstance(msg, cls):
+      raise TypeError('Parameter to MergeFrom() must be instance of same '
+                      'class.')
+    self._cmsg.MergeFrom(msg._cmsg)
+  cls.MergeFrom = MergeFrom
@@ -85,12 +85,27 @@ from google.protobuf.internal import encoder
 from google.protobuf.internal import wire_format
 from google.protobuf import message
 
+try:
+  # Optional accelerator for packed repeated fields; see
+  # pyext/packed_codec.cc.
+  from google.protobuf.internal import _packed_codec
+except ImportError:
+  _packed_codec = None
+
 
 # This is not for optimization, but rather to avoid conflicts with local
 # variables named "message".
 _DecodeError = message.DecodeError
 
 
+def _PackedKind(name):
+  """Returns the _packed_codec constant with the given name, or None if the
+  accelerator is not available."""
+  if _packed_codec is None:
+    return None
+  return getattr(_packed_codec, name)
+
+
 def _VarintDecoder(mask):
   """Return an encoder for a basic varint value (does not include tag).
 
@@ -171,18 +186,22 @@ def ReadTag(buffer, pos):
 # --------------------------------------------------------------------
 
 
-def _SimpleDecoder(wire_type, decode_value):
+def _SimpleDecoder(wire_type, decode_value, packed_kind=None):
   """Return a constructor for a decoder for fields of a particular type.
 
   Args:
       wire_type:  The field's wire type.
       decode_value:  A function which decodes an individual value, e.g.
         _DecodeVarint()
+      packed_kind:  The _packed_codec constant for the field type, used to
+        decode packed fields in bulk.  None to always decode them in Python.
   """
 
   def SpecificDecoder(field_number, is_repeated, is_packed, key, new_default):
     if is_packed:
       local_DecodeVarint = _DecodeVarint
+      if packed_kind is not None:
+        local_DecodePacked = _packed_codec.DecodePacked
       def DecodePackedField(buffer, pos, end, message, field_dict):
         value = field_dict.get(key)
         if value is None:
@@ -191,6 +210,13 @@ def _SimpleDecoder(wire_type, decode_value):
         endpoint += pos
         if endpoint > end:
           raise _DecodeError('Truncated message.')
+        if packed_kind is not None:
+          # The accelerator returns None for anything malformed, in which case
+          # the loop below decodes the field again and reports the error.
+          elements = local_DecodePacked(packed_kind, buffer, pos, endpoint)
+          if elements is not None:
+            value._ExtendUnchecked(elements)
+            return endpoint
         while pos < endpoint:
           (element, pos) = decode_value(buffer, pos)
           value.append(element)
@@ -230,7 +256,7 @@ def _SimpleDecoder(wire_type, decode_value):
   return SpecificDecoder
 
 
-def _ModifiedDecoder(wire_type, decode_value, modify_value):
+def _ModifiedDecoder(wire_type, decode_value, modify_value, packed_kind=None):
   """Like SimpleDecoder but additionally invokes modify_value on every value
   before storing it.  Usually modify_value is ZigZagDecode.
   """
@@ -241,15 +267,16 @@ def _ModifiedDecoder(wire_type, decode_value, modify_value):
   def InnerDecode(buffer, pos):
     (result, new_pos) = decode_value(buffer, pos)
     return (modify_value(result), new_pos)
-  return _SimpleDecoder(wire_type, InnerDecode)
+  return _SimpleDecoder(wire_type, InnerDecode, packed_kind)
 
 
-def _StructPackDecoder(wire_type, format):
+def _StructPackDecoder(wire_type, format, packed_kind=None):
   """Return a constructor for a decoder for a fixed-width field.
 
   Args:
       wire_type:  The field's wire type.
       format:  The format string to pass to struct.unpack().
+      packed_kind:  As for _SimpleDecoder().
   """
 
   value_size = struct.calcsize(format)
@@ -266,39 +293,49 @@ def _StructPackDecoder(wire_type, format):
     new_pos = pos + value_size
     result = local_unpack(format, buffer[pos:new_pos])[0]
     return (result, new_pos)
-  return _SimpleDecoder(wire_type, InnerDecode)
+  return _SimpleDecoder(wire_type, InnerDecode, packed_kind)
 
 
 # --------------------------------------------------------------------
 
 
 Int32Decoder = EnumDecoder = _SimpleDecoder(
-    wire_format.WIRETYPE_VARINT, _DecodeSignedVarint32)
+    wire_format.WIRETYPE_VARINT, _DecodeSignedVarint32, _PackedKind('INT32'))
 
 Int64Decoder = _SimpleDecoder(
-    wire_format.WIRETYPE_VARINT, _DecodeSignedVarint)
+    wire_format.WIRETYPE_VARINT, _DecodeSignedVarint, _PackedKind('INT64'))
 
-UInt32Decoder = _SimpleDecoder(wire_format.WIRETYPE_VARINT, _DecodeVarint32)
-UInt64Decoder = _SimpleDecoder(wire_format.WIRETYPE_VARINT, _DecodeVarint)
+UInt32Decoder = _SimpleDecoder(
+    wire_format.WIRETYPE_VARINT, _DecodeVarint32, _PackedKind('UINT32'))
+UInt64Decoder = _SimpleDecoder(
+    wire_format.WIRETYPE_VARINT, _DecodeVarint, _PackedKind('UINT64'))
 
 SInt32Decoder = _ModifiedDecoder(
-    wire_format.WIRETYPE_VARINT, _DecodeVarint32, wire_format.ZigZagDecode)
+    wire_format.WIRETYPE_VARINT, _DecodeVarint32, wire_format.ZigZagDecode,
+    _PackedKind('SINT32'))
 SInt64Decoder = _ModifiedDecoder(
-    wire_format.WIRETYPE_VARINT, _DecodeVarint, wire_format.ZigZagDecode)
+    wire_format.WIRETYPE_VARINT, _DecodeVarint, wire_format.ZigZagDecode,
+    _PackedKind('SINT64'))
 
 # Note that Python conveniently guarantees that when using the '<' prefix on
 # formats, they will also have the same size across all platforms (as opposed
 # to without the prefix, where their sizes depend on the C compiler's basic
 # type sizes).
-Fixed32Decoder  = _StructPackDecoder(wire_format.WIRETYPE_FIXED32, '<I')
-Fixed64Decoder  = _StructPackDecoder(wire_format.WIRETYPE_FIXED64, '<Q')
-SFixed32Decoder = _StructPackDecoder(wire_format.WIRETYPE_FIXED32, '<i')
-SFixed64Decoder = _StructPackDecoder(wire_format.WIRETYPE_FIXED64, '<q')
-FloatDecoder    = _StructPackDecoder(wire_format.WIRETYPE_FIXED32, '<f')
-DoubleDecoder   = _StructPackDecoder(wire_format.WIRETYPE_FIXED64, '<d')
+Fixed32Decoder  = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED32, '<I', _PackedKind('FIXED32'))
+Fixed64Decoder  = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED64, '<Q', _PackedKind('FIXED64'))
+SFixed32Decoder = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED32, '<i', _PackedKind('SFIXED32'))
+SFixed64Decoder = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED64, '<q', _PackedKind('SFIXED64'))
+FloatDecoder    = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED32, '<f', _PackedKind('FLOAT'))
+DoubleDecoder   = _StructPackDecoder(
+    wire_format.WIRETYPE_FIXED64, '<d', _PackedKind('DOUBLE'))
 
 BoolDecoder = _ModifiedDecoder(
-    wire_format.WIRETYPE_VARINT, _DecodeVarint, bool)
+    wire_format.WIRETYPE_VARINT, _DecodeVarint, bool, _PackedKind('BOOL'))
 
 
 def StringDecoder(field_number, is_repeated, is_packed, key, new_default):
@@ -69,6 +69,21 @@ __author__ = 'kenton@google.com (Kenton Varda)'
 import struct
 from google.protobuf.internal import wire_format
 
+try:
+  # Optional accelerator for packed repeated fields; see
+  # pyext/packed_codec.cc.
+  from google.protobuf.internal import _packed_codec
+except ImportError:
+  _packed_codec = None
+
+
+def _PackedKind(name):
+  """Returns the _packed_codec constant with the given name, or None if the
+  accelerator is not available."""
+  if _packed_codec is None:
+    return None
+  return getattr(_packed_codec, name)
+
 
 def _VarintSize(value):
   """Compute the size of a varint value."""
@@ -384,12 +399,34 @@ def TagBytes(field_number, wire_type):
 
   return _VarintBytes(wire_format.PackTag(field_number, wire_type))
 
+def _PackedEncoder(packed_kind):
+  """Returns a function which writes the length and payload of a packed field
+  using _packed_codec, and returns whether it did so.  If it returns False,
+  nothing has been written and the caller must encode the field itself.
+  Returns None if the accelerator is not available.
+  """
+
+  if packed_kind is None:
+    return None
+
+  local_EncodePacked = _packed_codec.EncodePacked
+  local_EncodeVarint = _EncodeVarint
+  def EncodePacked(write, value):
+    data = local_EncodePacked(packed_kind, value)
+    if data is None:
+      return False
+    local_EncodeVarint(write, len(data))
+    write(data)
+    return True
+  return EncodePacked
+
 # --------------------------------------------------------------------
 # As with sizers (see above), we have a number of common encoder
 # implementations.
 
 
-def _SimpleEncoder(wire_type, encode_value, compute_value_size):
+def _SimpleEncoder(wire_type, encode_value, compute_value_size,
+                   packed_kind=None):
   """Return a constructor for an encoder for fields of a particular type.
 
   Args:
@@ -398,14 +435,19 @@ def _SimpleEncoder(wire_type, encode_value, compute_value_size):
         _EncodeVarint().
       compute_value_size:  A function which computes the size of an individual
         value, e.g. _VarintSize().
+      packed_kind:  The _packed_codec constant for the field type, used to
+        encode packed fields in bulk.  None to always encode them in Python.
   """
 
   def SpecificEncoder(field_number, is_repeated, is_packed):
     if is_packed:
       tag_bytes = TagBytes(field_number, wire_format.WIRETYPE_LENGTH_DELIMITED)
       local_EncodeVarint = _EncodeVarint
+      local_EncodePacked = _PackedEncoder(packed_kind)
       def EncodePackedField(write, value):
         write(tag_bytes)
+        if local_EncodePacked is not None and local_EncodePacked(write, value):
+          return
         size = 0
         for element in value:
           size += compute_value_size(element)
@@ -430,7 +472,8 @@ def _SimpleEncoder(wire_type, encode_value, compute_value_size):
   return SpecificEncoder
 
 
-def _ModifiedEncoder(wire_type, encode_value, compute_value_size, modify_value):
+def _ModifiedEncoder(wire_type, encode_value, compute_value_size, modify_value,
+                     packed_kind=None):
   """Like SimpleEncoder but additionally invokes modify_value on every value
   before passing it to encode_value.  Usually modify_value is ZigZagEncode."""
 
@@ -438,8 +481,11 @@ def _ModifiedEncoder(wire_type, encode_value, compute_value_size, modify_value):
     if is_packed:
       tag_bytes = TagBytes(field_number, wire_format.WIRETYPE_LENGTH_DELIMITED)
       local_EncodeVarint = _EncodeVarint
+      local_EncodePacked = _PackedEncoder(packed_kind)
       def EncodePackedField(write, value):
         write(tag_bytes)
+        if local_EncodePacked is not None and local_EncodePacked(write, value):
+          return
         size = 0
         for element in value:
           size += compute_value_size(modify_value(element))
@@ -464,12 +510,13 @@ def _ModifiedEncoder(wire_type, encode_value, compute_value_size, modify_value):
   return SpecificEncoder
 
 
-def _StructPackEncoder(wire_type, format):
+def _StructPackEncoder(wire_type, format, packed_kind=None):
   """Return a constructor for an encoder for a fixed-width field.
 
   Args:
       wire_type:  The field's wire type, for encoding tags.
       format:  The format string to pass to struct.pack().
+      packed_kind:  As for _SimpleEncoder().
   """
 
   value_size = struct.calcsize(format)
@@ -479,8 +526,11 @@ def _StructPackEncoder(wire_type, format):
     if is_packed:
       tag_bytes = TagBytes(field_number, wire_format.WIRETYPE_LENGTH_DELIMITED)
       local_EncodeVarint = _EncodeVarint
+      local_EncodePacked = _PackedEncoder(packed_kind)
       def EncodePackedField(write, value):
         write(tag_bytes)
+        if local_EncodePacked is not None and local_EncodePacked(write, value):
+          return
         local_EncodeVarint(write, len(value) * value_size)
         for element in value:
           write(local_struct_pack(format, element))
@@ -507,26 +557,37 @@ def _StructPackEncoder(wire_type, format):
 # very similarly to sizer constructors, described earlier.
 
 
+# The accelerator encodes every signed varint type as a 64-bit value and every
+# unsigned one as its magnitude, just as the shared encoders below do, so the
+# 32- and 64-bit kinds are interchangeable here.
 Int32Encoder = Int64Encoder = EnumEncoder = _SimpleEncoder(
-    wire_format.WIRETYPE_VARINT, _EncodeSignedVarint, _SignedVarintSize)
+    wire_format.WIRETYPE_VARINT, _EncodeSignedVarint, _SignedVarintSize,
+    _PackedKind('INT64'))
 
 UInt32Encoder = UInt64Encoder = _SimpleEncoder(
-    wire_format.WIRETYPE_VARINT, _EncodeVarint, _VarintSize)
+    wire_format.WIRETYPE_VARINT, _EncodeVarint, _VarintSize,
+    _PackedKind('UINT64'))
 
 SInt32Encoder = SInt64Encoder = _ModifiedEncoder(
     wire_format.WIRETYPE_VARINT, _EncodeVarint, _VarintSize,
-    wire_format.ZigZagEncode)
+    wire_format.ZigZagEncode, _PackedKind('SINT64'))
 
 # Note that Python conveniently guarantees that when using the '<' prefix on
 # formats, they will also have the same size across all platforms (as opposed
 # to without the prefix, where their sizes depend on the C compiler's basic
 # type sizes).
-Fixed32Encoder  = _StructPackEncoder(wire_format.WIRETYPE_FIXED32, '<I')
-Fixed64Encoder  = _StructPackEncoder(wire_format.WIRETYPE_FIXED64, '<Q')
-SFixed32Encoder = _StructPackEncoder(wire_format.WIRETYPE_FIXED32, '<i')
-SFixed64Encoder = _StructPackEncoder(wire_format.WIRETYPE_FIXED64, '<q')
-FloatEncoder    = _StructPackEncoder(wire_format.WIRETYPE_FIXED32, '<f')
-DoubleEncoder   = _StructPackEncoder(wire_format.WIRETYPE_FIXED64, '<d')
+Fixed32Encoder  = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED32, '<I', _PackedKind('FIXED32'))
+Fixed64Encoder  = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED64, '<Q', _PackedKind('FIXED64'))
+SFixed32Encoder = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED32, '<i', _PackedKind('SFIXED32'))
+SFixed64Encoder = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED64, '<q', _PackedKind('SFIXED64'))
+FloatEncoder    = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED32, '<f', _PackedKind('FLOAT'))
+DoubleEncoder   = _StructPackEncoder(
+    wire_format.WIRETYPE_FIXED64, '<d', _PackedKind('DOUBLE'))
 
 
 def BoolEncoder(field_number, is_repeated, is_packed):
@@ -537,8 +598,11 @@ def BoolEncoder(field_number, is_repeated, is_packed):
   if is_packed:
     tag_bytes = TagBytes(field_number, wire_format.WIRETYPE_LENGTH_DELIMITED)
     local_EncodeVarint = _EncodeVarint
+    local_EncodePacked = _PackedEncoder(_PackedKind('BOOL'))
     def EncodePackedField(write, value):
       write(tag_bytes)
+      if local_EncodePacked is not None and local_EncodePacked(write, value):
+        return
       local_EncodeVarint(write, len(value))
       for element in value:
         if element:
@@ -0,0 +1,174 @@
+#! /usr/bin/python
+#
+# Protocol Buffers - Google's data interchange format
+# Copyright 2008 Google Inc.  All rights reserved.
+# http://code.google.com/p/protobuf/
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Checks the optional _packed_codec accelerator against the pure-Python
+encoders and decoders.  Does nothing if the accelerator was not built.
+"""
+
+import struct
+import unittest
+from google.protobuf import message
+from google.protobuf import unittest_pb2
+from google.protobuf.internal import decoder
+from google.protobuf.internal import encoder
+from google.protobuf.internal import wire_format
+
+_packed_codec = decoder._packed_codec
+
+
+def _StructCodec(format):
+  size = struct.calcsize(format)
+  def Encode(write, value):
+    write(struct.pack(format, value))
+  def Decode(buffer, pos):
+    return (struct.unpack(format, buffer[pos:pos + size])[0], pos + size)
+  return (Encode, Decode)
+
+
+def _ZigZagCodec(decode_value):
+  def Encode(write, value):
+    encoder._EncodeVarint(write, wire_format.ZigZagEncode(value))
+  def Decode(buffer, pos):
+    (value, pos) = decode_value(buffer, pos)
+    return (wire_format.ZigZagDecode(value), pos)
+  return (Encode, Decode)
+
+
+def _BoolCodec():
+  def Encode(write, value):
+    write(chr(bool(value)))
+  def Decode(buffer, pos):
+    (value, pos) = decoder._DecodeVarint(buffer, pos)
+    return (bool(value), pos)
+  return (Encode, Decode)
+
+
+# For each kind: the pure-Python (encode, decode) pair and some edge values.
+_KINDS = [
+  ('INT32', (encoder._EncodeSignedVarint, decoder._DecodeSignedVarint32),
+   [0, 1, -1, 127, 128, -(1 << 31), (1 << 31) - 1]),
+  ('INT64', (encoder._EncodeSignedVarint, decoder._DecodeSignedVarint),
+   [0, 1, -1, 300, -(1 << 63), (1 << 63) - 1]),
+  ('UINT32', (encoder._EncodeVarint, decoder._DecodeVarint32),
+   [0, 1, 127, 128, 16383, 16384, (1 << 32) - 1]),
+  ('UINT64', (encoder._EncodeVarint, decoder._DecodeVarint),
+   [0, 1, (1 << 63) - 1, 1 << 63, (1 << 64) - 1]),
+  ('SINT32', _ZigZagCodec(decoder._DecodeVarint32),
+   [0, 1, -1, -(1 << 31), (1 << 31) - 1]),
+  ('SINT64', _ZigZagCodec(decoder._DecodeVarint),
+   [0, 1, -1, -(1 << 63), (1 << 63) - 1]),
+  ('BOOL', _BoolCodec(), [True, False, True]),
+  ('FIXED32', _StructCodec('<I'), [0, 1, (1 << 32) - 1]),
+  ('FIXED64', _StructCodec('<Q'), [0, 1, (1 << 64) - 1]),
+  ('SFIXED32', _StructCodec('<i'), [0, -1, -(1 << 31), (1 << 31) - 1]),
+  ('SFIXED64', _StructCodec('<q'), [0, -1, -(1 << 63), (1 << 63) - 1]),
+  ('FLOAT', _StructCodec('<f'), [0.0, -0.0, 1.5, -2.25, 1e30, 7, 1e-40]),
+  ('DOUBLE', _StructCodec('<d'), [0.0, -0.0, 1.5, 1e300, 5e-324, 7]),
+]
+
+
+def _PythonEncode(encode_value, values):
+  pieces = []
+  for value in values:
+    encode_value(pieces.append, value)
+  return ''.join(pieces)
+
+
+def _PythonDecode(decode_value, data):
+  values = []
+  pos = 0
+  while pos < len(data):
+    (value, pos) = decode_value(data, pos)
+    values.append(value)
+  return values
+
+
+class PackedCodecTest(unittest.TestCase):
+
+  def testRoundTripMatchesPython(self):
+    if _packed_codec is None:
+      return
+    for (name, (encode_value, decode_value), values) in _KINDS:
+      kind = getattr(_packed_codec, name)
+      expected = _PythonEncode(encode_value, values)
+      self.assertEqual(expected, _packed_codec.EncodePacked(kind, values),
+                       name)
+      decoded = _packed_codec.DecodePacked(kind, expected, 0, len(expected))
+      self.assertEqual(_PythonDecode(decode_value, expected), decoded, name)
+
+  def testDecodeHonorsBounds(self):
+    if _packed_codec is None:
+      return
+    data = 'x' + _PythonEncode(encoder._EncodeVarint, [1, 300, 2]) + 'y'
+    self.assertEqual([1, 300, 2],
+                     _packed_codec.DecodePacked(_packed_codec.UINT32,
+                                                data, 1, len(data) - 1))
+    self.assertEqual([], _packed_codec.DecodePacked(_packed_codec.UINT32,
+                                                    data, 1, 1))
+
+  def testMalformedInputReturnsNone(self):
+    if _packed_codec is None:
+      return
+    DecodePacked = _packed_codec.DecodePacked
+    # Element runs past the end.
+    self.assertEqual(None, DecodePacked(_packed_codec.INT32, '\x80', 0, 1))
+    self.assertEqual(None, DecodePacked(_packed_codec.FIXED32, 'abc', 0, 3))
+    self.assertEqual(None, DecodePacked(_packed_codec.DOUBLE, 'a' * 9, 0, 9))
+    # Too many bytes.
+    self.assertEqual(None, DecodePacked(_packed_codec.UINT64,
+                                        '\xff' * 10 + '\x01', 0, 11))
+    # Endpoint beyond the buffer.
+    self.assertEqual(None, DecodePacked(_packed_codec.INT32, '\x01', 0, 2))
+
+  def testUnencodableValuesReturnNone(self):
+    if _packed_codec is None:
+      return
+    EncodePacked = _packed_codec.EncodePacked
+    self.assertEqual(None, EncodePacked(_packed_codec.FLOAT, [1.0, 1e300]))
+    self.assertEqual(None, EncodePacked(_packed_codec.UINT64, [-1]))
+    self.assertEqual(None, EncodePacked(_packed_codec.INT64, [1 << 64]))
+    self.assertEqual(None, EncodePacked(_packed_codec.FIXED32, [1 << 32]))
+
+  def testTruncatedElementStillRaises(self):
+    # Whether or not the accelerator is present, a packed field whose last
+    # element is cut off is reported the same way.
+    proto = unittest_pb2.TestPackedTypes()
+    proto.packed_fixed32.append(1)
+    serialized = proto.SerializeToString()
+    # Shorten the field length by one byte so the element no longer fits.
+    corrupt = serialized[:1] + chr(ord(serialized[1]) - 1) + serialized[2:-1]
+    self.assertRaises(message.DecodeError,
+                      unittest_pb2.TestPackedTypes().MergeFromString, corrupt)
+
+
+if __name__ == '__main__':
+  unittest.main()
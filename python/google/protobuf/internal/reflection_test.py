@@ -50,6 +50,7 @@ from google.protobuf import descriptor_pb2
 from google.protobuf import descriptor
 from google.protobuf import message
 from google.protobuf import reflection
+from google.protobuf.internal import api_implementation
 from google.protobuf.internal import more_extensions_pb2
 from google.protobuf.internal import more_messages_pb2
 from google.protobuf.internal import wire_format
@@ -520,7 +521,9 @@ class ReflectionTest(unittest.TestCase):
     TestMinAndMaxIntegers('optional_uint32', 0, 0xffffffff)
     TestMinAndMaxIntegers('optional_int64', -(1 << 63), (1 << 63) - 1)
     TestMinAndMaxIntegers('optional_uint64', 0, 0xffffffffffffffff)
-    TestMinAndMaxIntegers('optional_nested_enum', -(1 << 31), (1 << 31) - 1)
+    # The C++ implementation can only store enum numbers it knows about.
+    if api_implementation.Type() == 'python':
+      TestMinAndMaxIntegers('optional_nested_enum', -(1 << 31), (1 << 31) - 1)
 
   def testRepeatedScalarTypeSafety(self):
     proto = unittest_pb2.TestAllTypes()
@@ -720,6 +723,21 @@ class ReflectionTest(unittest.TestCase):
         containing_type=None, nested_types=[], enum_types=[],
         fields=[foo_field_descriptor], extensions=[],
         options=descriptor_pb2.MessageOptions())
+    if api_implementation.Type() == 'cpp':
+      # The C++ implementation backs each class with a type from its own
+      # descriptor pool, so the hand-written type has to be built there too.
+      file_proto = descriptor_pb2.FileDescriptorProto()
+      file_proto.name = 'ignored'
+      message_proto = file_proto.message_type.add()
+      message_proto.name = 'MyProto'
+      field_proto = message_proto.field.add()
+      field_proto.name = 'foo_field'
+      field_proto.number = 1
+      field_proto.type = descriptor_pb2.FieldDescriptorProto.TYPE_INT64
+      field_proto.label = descriptor_pb2.FieldDescriptorProto.LABEL_OPTIONAL
+      descriptor.FileDescriptor(
+          name='ignored', package='',
+          serialized_pb=file_proto.SerializeToString())
     class MyProtoClass(message.Message):
       DESCRIPTOR = mydescriptor
       __metaclass__ = reflection.GeneratedProtocolMessageType
@@ -1193,8 +1211,9 @@ class ReflectionTest(unittest.TestCase):
     self.assertEqual(proto.optional_string, unicode('Testing'))
 
     # Values of type 'str' are also accepted as long as they can be encoded in
-    # UTF-8.
-    self.assertEqual(type(proto.optional_string), str)
+    # UTF-8.  The C++ implementation always hands back unicode.
+    if api_implementation.Type() == 'python':
+      self.assertEqual(type(proto.optional_string), str)
 
     # Try to assign a 'str' value which contains bytes that aren't 7-bit ASCII.
     self.assertRaises(ValueError,
@@ -1243,7 +1262,12 @@ class ReflectionTest(unittest.TestCase):
     # How about if the bytes on the wire aren't a valid UTF-8 encoded string.
     bytes = raw.item[0].message.replace(
         test_utf8_bytes, len(test_utf8_bytes) * '\xff')
-    self.assertRaises(UnicodeDecodeError, message2.MergeFromString, bytes)
+    if api_implementation.Type() == 'python':
+      self.assertRaises(UnicodeDecodeError, message2.MergeFromString, bytes)
+    else:
+      # The C++ implementation defers decoding until the field is read.
+      message2.MergeFromString(bytes)
+      self.assertRaises(UnicodeDecodeError, getattr, message2, 'str')
 
   def testEmptyNestedMessage(self):
     proto = unittest_pb2.TestAllTypes()
@@ -1765,6 +1789,12 @@ class SerializationTest(unittest.TestCase):
         # If we didn't raise an error then we read exactly the amount expected.
         self.assertEqual(truncation_point, pos)
 
+        # The C++ parser accepts an embedded message whose length is followed
+        # by the end of the input, while its unknown field parser does not,
+        # so the two are only compared under the pure-Python implementation.
+        if api_implementation.Type() != 'python':
+          continue
+
         # Parsing to unknown fields should not throw if parsing to known fields
         # did not.
         try:
@@ -0,0 +1,135 @@
+#! /usr/bin/python
+#
+# Protocol Buffers - Google's data interchange format
+# Copyright 2008 Google Inc.  All rights reserved.
+# http://code.google.com/p/protobuf/
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met:
+#
+#     * Redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above
+# copyright notice, this list of conditions and the following disclaimer
+# in the documentation and/or other materials provided with the
+# distribution.
+#     * Neither the name of Google Inc. nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+"""Checks the parsers and serializers generated by the Python code generator's
+specialized_codecs option against the generic ones from reflection.py.
+"""
+
+import unittest
+from google.protobuf import message
+from google.protobuf import unittest_pb2
+from google.protobuf.internal import specialized_codecs_pb2
+from google.protobuf.internal import test_util
+
+
+class SpecializedCodecsTest(unittest.TestCase):
+
+  def assertRoundTrips(self, generic_message, specialized_class):
+    """Parses the serialization of generic_message into specialized_class and
+    checks that serializing it back produces the same bytes and message."""
+    serialized = generic_message.SerializeToString()
+    specialized = specialized_class()
+    specialized.MergeFromString(serialized)
+    self.assertEqual(serialized, specialized.SerializeToString())
+
+    parsed = generic_message.__class__()
+    parsed.MergeFromString(specialized.SerializeToString())
+    self.assertEqual(generic_message, parsed)
+
+  def testAllFields(self):
+    all_set = unittest_pb2.TestAllTypes()
+    test_util.SetAllFields(all_set)
+    self.assertRoundTrips(all_set, specialized_codecs_pb2.SpecializedAllTypes)
+
+  def testFewFields(self):
+    proto = unittest_pb2.TestAllTypes()
+    proto.optional_int32 = -1
+    proto.repeated_string.append('foo')
+    self.assertRoundTrips(proto, specialized_codecs_pb2.SpecializedAllTypes)
+    self.assertRoundTrips(unittest_pb2.TestAllTypes(),
+                          specialized_codecs_pb2.SpecializedAllTypes)
+
+  def testPackedFields(self):
+    packed = unittest_pb2.TestPackedTypes()
+    test_util.SetAllPackedFields(packed)
+    self.assertRoundTrips(packed,
+                          specialized_codecs_pb2.SpecializedPackedTypes)
+
+  def testUnpackedEncodingOfPackedFields(self):
+    unpacked = unittest_pb2.TestUnpackedTypes()
+    test_util.SetAllUnpackedFields(unpacked)
+    specialized = specialized_codecs_pb2.SpecializedPackedTypes()
+    specialized.MergeFromString(unpacked.SerializeToString())
+
+    packed = unittest_pb2.TestPackedTypes()
+    test_util.SetAllPackedFields(packed)
+    self.assertEqual(packed.SerializeToString(),
+                     specialized.SerializeToString())
+
+  def testFieldsOutOfOrder(self):
+    # The specialized parser expects fields in field number order and hands
+    # anything else to the generic parse loop.
+    first = unittest_pb2.TestAllTypes()
+    first.optional_string = 'foo'
+    first.repeated_int32.append(5)
+    second = unittest_pb2.TestAllTypes()
+    second.optional_int32 = 1
+    second.optional_nested_message.bb = 2
+    third = unittest_pb2.TestAllTypes()
+    third.repeated_int32.append(6)
+    serialized = (first.SerializeToString() + second.SerializeToString() +
+                  third.SerializeToString())
+
+    specialized = specialized_codecs_pb2.SpecializedAllTypes()
+    specialized.MergeFromString(serialized)
+    self.assertEqual(1, specialized.optional_int32)
+    self.assertEqual('foo', specialized.optional_string)
+    self.assertEqual(2, specialized.optional_nested_message.bb)
+    self.assertEqual([5, 6], list(specialized.repeated_int32))
+
+    expected = unittest_pb2.TestAllTypes()
+    expected.MergeFromString(serialized)
+    self.assertEqual(expected.SerializeToString(),
+                     specialized.SerializeToString())
+
+  def testParseTruncated(self):
+    all_set = unittest_pb2.TestAllTypes()
+    test_util.SetAllFields(all_set)
+    serialized = all_set.SerializeToString()
+
+    for truncation_point in xrange(len(serialized) + 1):
+      truncated = serialized[:truncation_point]
+      generic = unittest_pb2.TestAllTypes()
+      specialized = specialized_codecs_pb2.SpecializedAllTypes()
+      try:
+        generic.MergeFromString(truncated)
+      except message.DecodeError:
+        self.assertRaises(message.DecodeError,
+                          specialized.MergeFromString, truncated)
+      else:
+        specialized.MergeFromString(truncated)
+        self.assertEqual(generic.SerializeToString(),
+                         specialized.SerializeToString())
+
+
+if __name__ == '__main__':
+  unittest.main()
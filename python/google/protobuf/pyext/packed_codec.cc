@@ -0,0 +1,460 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// Bulk encoding and decoding of packed repeated fields for the pure-Python
+// implementation.  decoder.py and encoder.py use this module when it is
+// available and fall back to their own per-element loops otherwise.
+//
+// Both entry points produce exactly what the pure-Python code would.  Any
+// input they cannot handle that way -- a truncated or over-long element, a
+// value out of range -- makes them return None rather than raise, and the
+// caller re-runs the Python loop, which then reports the error in its usual
+// form.  This keeps the error behavior in one place.
+//
+// The module does not depend on libprotobuf.
+
+#include <Python.h>
+
+#include <string.h>
+
+#include <string>
+
+namespace google {
+namespace protobuf {
+namespace python {
+
+namespace {
+
+typedef signed long long int64;
+typedef unsigned long long uint64;
+typedef unsigned int uint32;
+typedef int int32;
+typedef unsigned char uint8;
+
+// Field types understood by DecodePacked() and EncodePacked().  The values
+// are exported as module constants of the same name.
+enum Kind {
+  INT32,      // Also used for enums.
+  INT64,
+  UINT32,
+  UINT64,
+  SINT32,
+  SINT64,
+  BOOL,
+  FIXED32,
+  FIXED64,
+  SFIXED32,
+  SFIXED64,
+  FLOAT,
+  DOUBLE,
+  NUM_KINDS
+};
+
+// Reads one varint.  Fails on truncation and on varints that the Python
+// decoder would not reduce to the same 64-bit value (more than ten bytes,
+// or bits beyond the 64th).
+inline bool ReadVarint(const uint8** ptr, const uint8* limit,
+                       uint64* value) {
+  const uint8* p = *ptr;
+  uint64 result = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    if (p >= limit) return false;
+    uint8 b = *p++;
+    if (shift == 63 && b > 1) return false;
+    result |= static_cast<uint64>(b & 0x7f) << shift;
+    if (!(b & 0x80)) {
+      *ptr = p;
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+inline uint32 ReadLittleEndian32(const uint8* p) {
+  return static_cast<uint32>(p[0]) |
+         (static_cast<uint32>(p[1]) << 8) |
+         (static_cast<uint32>(p[2]) << 16) |
+         (static_cast<uint32>(p[3]) << 24);
+}
+
+inline uint64 ReadLittleEndian64(const uint8* p) {
+  return static_cast<uint64>(ReadLittleEndian32(p)) |
+         (static_cast<uint64>(ReadLittleEndian32(p + 4)) << 32);
+}
+
+inline void WriteLittleEndian32(uint32 value, std::string* out) {
+  char bytes[4];
+  bytes[0] = static_cast<char>(value);
+  bytes[1] = static_cast<char>(value >> 8);
+  bytes[2] = static_cast<char>(value >> 16);
+  bytes[3] = static_cast<char>(value >> 24);
+  out->append(bytes, 4);
+}
+
+inline void WriteLittleEndian64(uint64 value, std::string* out) {
+  WriteLittleEndian32(static_cast<uint32>(value), out);
+  WriteLittleEndian32(static_cast<uint32>(value >> 32), out);
+}
+
+inline void WriteVarint(uint64 value, std::string* out) {
+  char bytes[10];
+  int size = 0;
+  while (value > 0x7f) {
+    bytes[size++] = static_cast<char>((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  bytes[size++] = static_cast<char>(value);
+  out->append(bytes, size);
+}
+
+// Python ints where they fit, as struct.unpack() and the Python decoder do.
+PyObject* FromInt64(int64 value) {
+  if (value >= LONG_MIN && value <= LONG_MAX) {
+    return PyInt_FromLong(static_cast<long>(value));
+  }
+  return PyLong_FromLongLong(value);
+}
+
+PyObject* FromUInt64(uint64 value) {
+  if (value <= static_cast<uint64>(LONG_MAX)) {
+    return PyInt_FromLong(static_cast<long>(value));
+  }
+  return PyLong_FromUnsignedLongLong(value);
+}
+
+// Decodes a single element at *ptr, or returns NULL without setting an
+// exception if the element is malformed or runs past |limit|.
+PyObject* DecodeElement(Kind kind, const uint8** ptr, const uint8* limit) {
+  uint64 raw;
+  switch (kind) {
+    case INT32:
+    case INT64:
+    case UINT32:
+    case UINT64:
+    case SINT32:
+    case SINT64:
+    case BOOL:
+      if (!ReadVarint(ptr, limit, &raw)) return NULL;
+      break;
+    case FIXED32:
+    case SFIXED32:
+    case FLOAT:
+      if (limit - *ptr < 4) return NULL;
+      raw = ReadLittleEndian32(*ptr);
+      *ptr += 4;
+      break;
+    default:
+      if (limit - *ptr < 8) return NULL;
+      raw = ReadLittleEndian64(*ptr);
+      *ptr += 8;
+      break;
+  }
+
+  switch (kind) {
+    case INT32:
+      // Mirrors _SignedVarintDecoder((1 << 32) - 1) exactly, including its
+      // treatment of non-sign-extended negative values.
+      if (raw > 0x7fffffffffffffffULL) {
+        return FromInt64(static_cast<int64>(raw | ~0xffffffffULL));
+      }
+      return FromUInt64(raw & 0xffffffffULL);
+    case INT64:
+    case SFIXED64:
+      return FromInt64(static_cast<int64>(raw));
+    case UINT32:
+      return FromUInt64(raw & 0xffffffffULL);
+    case UINT64:
+    case FIXED32:
+    case FIXED64:
+      return FromUInt64(raw);
+    case SINT32:
+      raw &= 0xffffffffULL;
+      return FromInt64(static_cast<int64>(raw >> 1) ^
+                       -static_cast<int64>(raw & 1));
+    case SINT64:
+      return FromInt64(static_cast<int64>(raw >> 1) ^
+                       -static_cast<int64>(raw & 1));
+    case BOOL:
+      return PyBool_FromLong(raw != 0);
+    case SFIXED32:
+      return FromInt64(static_cast<int32>(static_cast<uint32>(raw)));
+    case FLOAT: {
+      uint32 bits = static_cast<uint32>(raw);
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return PyFloat_FromDouble(value);
+    }
+    case DOUBLE: {
+      double value;
+      memcpy(&value, &raw, sizeof(value));
+      return PyFloat_FromDouble(value);
+    }
+    default:
+      return NULL;
+  }
+}
+
+// Reads a Python int or long as a 64-bit two's complement value, the way
+// the Python encoders do ("value += (1 << 64)" for negatives).  Fails on
+// anything out of range.
+bool ToInt64(PyObject* obj, bool is_unsigned, uint64* value) {
+  if (PyInt_Check(obj)) {
+    long v = PyInt_AS_LONG(obj);
+    if (is_unsigned && v < 0) return false;
+    *value = static_cast<uint64>(static_cast<int64>(v));
+    return true;
+  }
+  if (PyLong_Check(obj)) {
+    if (is_unsigned) {
+      unsigned long long v = PyLong_AsUnsignedLongLong(obj);
+      if (v == static_cast<unsigned long long>(-1) && PyErr_Occurred()) {
+        PyErr_Clear();
+        return false;
+      }
+      *value = v;
+    } else {
+      long long v = PyLong_AsLongLong(obj);
+      if (v == -1 && PyErr_Occurred()) {
+        PyErr_Clear();
+        return false;
+      }
+      *value = static_cast<uint64>(v);
+    }
+    return true;
+  }
+  return false;
+}
+
+inline bool IsInfinite(double value) {
+  return value - value != value - value && value == value;
+}
+
+bool ToDouble(PyObject* obj, double* value) {
+  double v = PyFloat_AsDouble(obj);
+  if (v == -1.0 && PyErr_Occurred()) {
+    PyErr_Clear();
+    return false;
+  }
+  *value = v;
+  return true;
+}
+
+// Appends the encoding of one element to |out|.  Fails on any value the
+// Python encoder would reject or encode differently.
+bool EncodeElement(Kind kind, PyObject* obj, std::string* out) {
+  uint64 raw;
+  double d;
+  switch (kind) {
+    case INT32:
+    case INT64:
+      if (!ToInt64(obj, false, &raw)) return false;
+      WriteVarint(raw, out);
+      return true;
+    case UINT32:
+    case UINT64:
+      if (!ToInt64(obj, true, &raw)) return false;
+      WriteVarint(raw, out);
+      return true;
+    case SINT32:
+    case SINT64: {
+      if (!ToInt64(obj, false, &raw)) return false;
+      int64 v = static_cast<int64>(raw);
+      WriteVarint((static_cast<uint64>(v) << 1) ^ static_cast<uint64>(v >> 63),
+                  out);
+      return true;
+    }
+    case BOOL: {
+      int truth = PyObject_IsTrue(obj);
+      if (truth < 0) {
+        PyErr_Clear();
+        return false;
+      }
+      out->push_back(truth ? '\1' : '\0');
+      return true;
+    }
+    case FIXED32:
+      if (!ToInt64(obj, true, &raw) || raw > 0xffffffffULL) return false;
+      WriteLittleEndian32(static_cast<uint32>(raw), out);
+      return true;
+    case SFIXED32: {
+      if (!ToInt64(obj, false, &raw)) return false;
+      int64 v = static_cast<int64>(raw);
+      if (v < -0x80000000LL || v > 0x7fffffffLL) return false;
+      WriteLittleEndian32(static_cast<uint32>(raw), out);
+      return true;
+    }
+    case FIXED64:
+      if (!ToInt64(obj, true, &raw)) return false;
+      WriteLittleEndian64(raw, out);
+      return true;
+    case SFIXED64:
+      if (!ToInt64(obj, false, &raw)) return false;
+      WriteLittleEndian64(raw, out);
+      return true;
+    case FLOAT: {
+      if (!ToDouble(obj, &d)) return false;
+      float f = static_cast<float>(d);
+      // struct.pack('<f') refuses finite values that overflow a float.
+      if (IsInfinite(f) && !IsInfinite(d)) return false;
+      uint32 bits;
+      memcpy(&bits, &f, sizeof(bits));
+      WriteLittleEndian32(bits, out);
+      return true;
+    }
+    case DOUBLE: {
+      if (!ToDouble(obj, &d)) return false;
+      memcpy(&raw, &d, sizeof(raw));
+      WriteLittleEndian64(raw, out);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+static const char kDecodePackedDoc[] =
+    "DecodePacked(kind, buffer, pos, endpoint) -> list or None\n\n"
+    "Decodes the packed elements in buffer[pos:endpoint].  Returns None if\n"
+    "they are malformed.";
+
+PyObject* Python_DecodePacked(PyObject* ignored, PyObject* args) {
+  int kind;
+  PyObject* buffer;
+  Py_ssize_t pos;
+  Py_ssize_t endpoint;
+  if (!PyArg_ParseTuple(args, "iOnn", &kind, &buffer, &pos, &endpoint)) {
+    return NULL;
+  }
+  if (kind < 0 || kind >= NUM_KINDS) {
+    PyErr_SetString(PyExc_ValueError, "Unknown packed field kind.");
+    return NULL;
+  }
+  if (!PyString_Check(buffer) || pos < 0 || pos > endpoint ||
+      endpoint > PyString_GET_SIZE(buffer)) {
+    Py_RETURN_NONE;
+  }
+
+  const uint8* ptr =
+      reinterpret_cast<const uint8*>(PyString_AS_STRING(buffer)) + pos;
+  const uint8* limit = ptr + (endpoint - pos);
+
+  PyObject* result = PyList_New(0);
+  if (result == NULL) return NULL;
+  while (ptr < limit) {
+    PyObject* element = DecodeElement(static_cast<Kind>(kind), &ptr, limit);
+    if (element == NULL) {
+      Py_DECREF(result);
+      if (PyErr_Occurred()) return NULL;
+      Py_RETURN_NONE;
+    }
+    int status = PyList_Append(result, element);
+    Py_DECREF(element);
+    if (status < 0) {
+      Py_DECREF(result);
+      return NULL;
+    }
+  }
+  return result;
+}
+
+static const char kEncodePackedDoc[] =
+    "EncodePacked(kind, values) -> str or None\n\n"
+    "Returns the packed encoding of values, without tag or length.  Returns\n"
+    "None if any value cannot be encoded.";
+
+PyObject* Python_EncodePacked(PyObject* ignored, PyObject* args) {
+  int kind;
+  PyObject* values;
+  if (!PyArg_ParseTuple(args, "iO", &kind, &values)) {
+    return NULL;
+  }
+  if (kind < 0 || kind >= NUM_KINDS) {
+    PyErr_SetString(PyExc_ValueError, "Unknown packed field kind.");
+    return NULL;
+  }
+
+  PyObject* sequence = PySequence_Fast(values, "Expected a sequence.");
+  if (sequence == NULL) return NULL;
+
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+  PyObject** items = PySequence_Fast_ITEMS(sequence);
+  std::string out;
+  out.reserve(size * (kind == FIXED64 || kind == SFIXED64 ||
+                      kind == DOUBLE ? 8 : 4));
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    if (!EncodeElement(static_cast<Kind>(kind), items[i], &out)) {
+      Py_DECREF(sequence);
+      Py_RETURN_NONE;
+    }
+  }
+  Py_DECREF(sequence);
+  return PyString_FromStringAndSize(out.data(), out.size());
+}
+
+PyMethodDef module_methods[] = {
+  { "DecodePacked", (PyCFunction)Python_DecodePacked, METH_VARARGS,
+    kDecodePackedDoc },
+  { "EncodePacked", (PyCFunction)Python_EncodePacked, METH_VARARGS,
+    kEncodePackedDoc },
+  { NULL, NULL }
+};
+
+}  // namespace
+
+}  // namespace python
+}  // namespace protobuf
+}  // namespace google
+
+extern "C" {
+PyMODINIT_FUNC init_packed_codec() {
+  namespace python = google::protobuf::python;
+
+  PyObject* module = Py_InitModule3(
+      "_packed_codec", python::module_methods,
+      "Bulk encoding and decoding of packed repeated fields.");
+  if (module == NULL) return;
+
+  PyModule_AddIntConstant(module, "INT32", python::INT32);
+  PyModule_AddIntConstant(module, "INT64", python::INT64);
+  PyModule_AddIntConstant(module, "UINT32", python::UINT32);
+  PyModule_AddIntConstant(module, "UINT64", python::UINT64);
+  PyModule_AddIntConstant(module, "SINT32", python::SINT32);
+  PyModule_AddIntConstant(module, "SINT64", python::SINT64);
+  PyModule_AddIntConstant(module, "BOOL", python::BOOL);
+  PyModule_AddIntConstant(module, "FIXED32", python::FIXED32);
+  PyModule_AddIntConstant(module, "FIXED64", python::FIXED64);
+  PyModule_AddIntConstant(module, "SFIXED32", python::SFIXED32);
+  PyModule_AddIntConstant(module, "SFIXED64", python::SFIXED64);
+  PyModule_AddIntConstant(module, "FLOAT", python::FLOAT);
+  PyModule_AddIntConstant(module, "DOUBLE", python::DOUBLE);
+}
+}
@@ -0,0 +1,948 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+// The C++ half of the C++ implementation of Python messages.  Each Python
+// message object owns a CMessage, which wraps a DynamicMessage built from
+// the pool in python_descriptor.cc.  cpp_message.py layers the Python
+// message API on top of the methods defined here; it is responsible for
+// type-checking values before they get here, and for detaching sub-message
+// wrappers before the C++ objects behind them are cleared or removed.
+
+#include <Python.h>
+
+#include <string>
+#include <vector>
+
+#include <google/protobuf/pyext/python_descriptor.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
+
+namespace google {
+namespace protobuf {
+namespace python {
+
+namespace {
+
+DynamicMessageFactory* global_message_factory = NULL;
+
+// A Python object holding a C++ message.
+//
+// A top-level message owns its Message.  A sub-message obtained through its
+// parent holds a reference to the parent's CMessage instead, and points
+// either at the parent's sub-message object or, while that field is unset,
+// at the type's default instance.  In the latter case |read_only| is true and
+// the first mutation calls MutableMessage() on the parent, which is what
+// makes "foo.bar.baz = 1" set foo.bar.
+struct CMessage {
+  PyObject_HEAD
+
+  Message* message;
+
+  // True if |message| is owned by this object and deleted with it.
+  bool free_message;
+
+  // True if |message| is a default instance that must not be modified.
+  bool read_only;
+
+  // The message this one was obtained from, and the field it lives in.
+  // NULL/NULL for top-level and detached messages.
+  CMessage* parent;
+  const FieldDescriptor* parent_field;
+};
+
+extern PyTypeObject CMessage_Type;
+
+enum Cardinality { SINGULAR, REPEATED };
+enum Kind { SCALAR, COMPOSITE };
+
+// Brings a read-only sub-message up to date with its parent: if the parent
+// has acquired the field since we were created (through MergeFromString(),
+// say), start pointing at the real object.
+void UpdateFromParent(CMessage* self) {
+  if (!self->read_only || self->parent == NULL) return;
+  UpdateFromParent(self->parent);
+  if (self->parent->read_only) return;
+
+  Message* parent = self->parent->message;
+  const Reflection* reflection = parent->GetReflection();
+  if (reflection->HasField(*parent, self->parent_field)) {
+    self->message = reflection->MutableMessage(
+        parent, self->parent_field, global_message_factory);
+    self->read_only = false;
+  }
+}
+
+// Makes |self| safe to modify, setting the field in every read-only ancestor
+// on the way.
+void AssureWritable(CMessage* self) {
+  if (!self->read_only) return;
+  AssureWritable(self->parent);
+  self->message = self->parent->message->GetReflection()->MutableMessage(
+      self->parent->message, self->parent_field, global_message_factory);
+  self->read_only = false;
+}
+
+CMessage* NewCMessageObject(Message* message, bool free_message,
+                            bool read_only, CMessage* parent,
+                            const FieldDescriptor* parent_field) {
+  CMessage* result = PyObject_New(CMessage, &CMessage_Type);
+  if (result == NULL) {
+    if (free_message) delete message;
+    return NULL;
+  }
+  result->message = message;
+  result->free_message = free_message;
+  result->read_only = read_only;
+  result->parent = parent;
+  result->parent_field = parent_field;
+  Py_XINCREF(parent);
+  return result;
+}
+
+// Validates a CFieldDescriptor argument against |self|'s type.  Reflection
+// GOOGLE_LOG(FATAL)s on a mismatch, which would take the interpreter down with
+// it, so every entry point goes through here first.
+const FieldDescriptor* GetField(CMessage* self, PyObject* arg,
+                                Cardinality cardinality, Kind kind) {
+  if (!PyObject_TypeCheck(arg, &CFieldDescriptor_Type)) {
+    PyErr_SetString(PyExc_TypeError, "Expected a CFieldDescriptor.");
+    return NULL;
+  }
+  const FieldDescriptor* field =
+      reinterpret_cast<CFieldDescriptor*>(arg)->descriptor;
+  if (field->containing_type() != self->message->GetDescriptor()) {
+    PyErr_Format(PyExc_KeyError, "Field %s does not belong to message %s.",
+                 field->full_name().c_str(),
+                 self->message->GetDescriptor()->full_name().c_str());
+    return NULL;
+  }
+  if (field->is_repeated() != (cardinality == REPEATED) ||
+      (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) !=
+          (kind == COMPOSITE)) {
+    PyErr_Format(PyExc_TypeError, "Field %s has the wrong type for this call.",
+                 field->full_name().c_str());
+    return NULL;
+  }
+  return field;
+}
+
+const FieldDescriptor* GetAnyField(CMessage* self, PyObject* arg) {
+  if (!PyObject_TypeCheck(arg, &CFieldDescriptor_Type)) {
+    PyErr_SetString(PyExc_TypeError, "Expected a CFieldDescriptor.");
+    return NULL;
+  }
+  const FieldDescriptor* field =
+      reinterpret_cast<CFieldDescriptor*>(arg)->descriptor;
+  if (field->containing_type() != self->message->GetDescriptor()) {
+    PyErr_Format(PyExc_KeyError, "Field %s does not belong to message %s.",
+                 field->full_name().c_str(),
+                 self->message->GetDescriptor()->full_name().c_str());
+    return NULL;
+  }
+  return field;
+}
+
+bool CheckIndex(const Message& message, const FieldDescriptor* field,
+                Py_ssize_t index) {
+  int size = message.GetReflection()->FieldSize(message, field);
+  if (index < 0 || index >= size) {
+    PyErr_Format(PyExc_IndexError, "list index (%zd) out of range", index);
+    return false;
+  }
+  return true;
+}
+
+// ===================================================================
+// Scalar conversion.
+
+template <typename T>
+bool ToSignedInteger(PyObject* arg, T* value) {
+  if (PyInt_Check(arg)) {
+    *value = static_cast<T>(PyInt_AsLong(arg));
+    return true;
+  }
+  if (PyLong_Check(arg)) {
+    PY_LONG_LONG result = PyLong_AsLongLong(arg);
+    if (result == -1 && PyErr_Occurred()) return false;
+    *value = static_cast<T>(result);
+    return true;
+  }
+  PyErr_Format(PyExc_TypeError, "value has type %.100s, but expected one of: "
+               "int, long", arg->ob_type->tp_name);
+  return false;
+}
+
+template <typename T>
+bool ToUnsignedInteger(PyObject* arg, T* value) {
+  if (PyInt_Check(arg)) {
+    *value = static_cast<T>(PyInt_AsLong(arg));
+    return true;
+  }
+  if (PyLong_Check(arg)) {
+    unsigned PY_LONG_LONG result = PyLong_AsUnsignedLongLong(arg);
+    if (PyErr_Occurred()) return false;
+    *value = static_cast<T>(result);
+    return true;
+  }
+  PyErr_Format(PyExc_TypeError, "value has type %.100s, but expected one of: "
+               "int, long", arg->ob_type->tp_name);
+  return false;
+}
+
+bool ToDouble(PyObject* arg, double* value) {
+  *value = PyFloat_AsDouble(arg);
+  return !(*value == -1.0 && PyErr_Occurred());
+}
+
+bool ToString(PyObject* arg, string* value) {
+  if (PyUnicode_Check(arg)) {
+    PyObject* encoded = PyUnicode_AsUTF8String(arg);
+    if (encoded == NULL) return false;
+    value->assign(PyString_AS_STRING(encoded), PyString_GET_SIZE(encoded));
+    Py_DECREF(encoded);
+    return true;
+  }
+  if (PyString_Check(arg)) {
+    value->assign(PyString_AS_STRING(arg), PyString_GET_SIZE(arg));
+    return true;
+  }
+  PyErr_Format(PyExc_TypeError, "value has type %.100s, but expected one of: "
+               "str, unicode", arg->ob_type->tp_name);
+  return false;
+}
+
+const EnumValueDescriptor* ToEnum(const FieldDescriptor* field,
+                                  PyObject* arg) {
+  int32 number;
+  if (!ToSignedInteger(arg, &number)) return NULL;
+  const EnumValueDescriptor* value =
+      field->enum_type()->FindValueByNumber(number);
+  if (value == NULL) {
+    PyErr_Format(PyExc_ValueError, "Unknown enum value: %d", number);
+  }
+  return value;
+}
+
+PyObject* FromString(const FieldDescriptor* field, const string& value) {
+  if (field->type() == FieldDescriptor::TYPE_STRING) {
+    // Raises UnicodeDecodeError on invalid UTF-8.  The pure-Python
+    // implementation raises the same error, but while parsing.
+    return PyUnicode_DecodeUTF8(value.data(), value.size(), NULL);
+  }
+  return PyString_FromStringAndSize(value.data(), value.size());
+}
+
+PyObject* FromInt64(int64 value) {
+  if (value >= LONG_MIN && value <= LONG_MAX) {
+    return PyInt_FromLong(static_cast<long>(value));
+  }
+  return PyLong_FromLongLong(value);
+}
+
+PyObject* FromUInt64(uint64 value) {
+  if (value <= static_cast<uint64>(LONG_MAX)) {
+    return PyInt_FromLong(static_cast<long>(value));
+  }
+  return PyLong_FromUnsignedLongLong(value);
+}
+
+// Reads a singular field (index < 0) or one element of a repeated field.
+PyObject* GetScalar(const Message& message, const FieldDescriptor* field,
+                    int index) {
+  const Reflection* reflection = message.GetReflection();
+  bool repeated = index >= 0;
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+      return PyInt_FromLong(repeated ?
+          reflection->GetRepeatedInt32(message, field, index) :
+          reflection->GetInt32(message, field));
+    case FieldDescriptor::CPPTYPE_INT64:
+      return FromInt64(repeated ?
+          reflection->GetRepeatedInt64(message, field, index) :
+          reflection->GetInt64(message, field));
+    case FieldDescriptor::CPPTYPE_UINT32:
+      return FromUInt64(repeated ?
+          reflection->GetRepeatedUInt32(message, field, index) :
+          reflection->GetUInt32(message, field));
+    case FieldDescriptor::CPPTYPE_UINT64:
+      return FromUInt64(repeated ?
+          reflection->GetRepeatedUInt64(message, field, index) :
+          reflection->GetUInt64(message, field));
+    case FieldDescriptor::CPPTYPE_FLOAT:
+      return PyFloat_FromDouble(repeated ?
+          reflection->GetRepeatedFloat(message, field, index) :
+          reflection->GetFloat(message, field));
+    case FieldDescriptor::CPPTYPE_DOUBLE:
+      return PyFloat_FromDouble(repeated ?
+          reflection->GetRepeatedDouble(message, field, index) :
+          reflection->GetDouble(message, field));
+    case FieldDescriptor::CPPTYPE_BOOL:
+      return PyBool_FromLong(repeated ?
+          reflection->GetRepeatedBool(message, field, index) :
+          reflection->GetBool(message, field));
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return PyInt_FromLong((repeated ?
+          reflection->GetRepeatedEnum(message, field, index) :
+          reflection->GetEnum(message, field))->number());
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string scratch;
+      const string& value = repeated ?
+          reflection->GetRepeatedStringReference(
+              message, field, index, &scratch) :
+          reflection->GetStringReference(message, field, &scratch);
+      return FromString(field, value);
+    }
+    default:
+      PyErr_Format(PyExc_SystemError, "Field %s is not a scalar.",
+                   field->full_name().c_str());
+      return NULL;
+  }
+}
+
+// How SetScalar() stores its value.
+enum StoreMode {
+  STORE_SINGULAR,  // Set the singular field.
+  STORE_INDEX,     // Overwrite element |index| of the repeated field.
+  STORE_ADD        // Append to the repeated field.
+};
+
+// Generates the switch arm storing a converted value in one of three ways.
+#define STORE_SCALAR(TYPE, value)                                     \
+  switch (mode) {                                                     \
+    case STORE_SINGULAR:                                              \
+      reflection->Set##TYPE(message, field, value);                   \
+      break;                                                          \
+    case STORE_INDEX:                                                 \
+      reflection->SetRepeated##TYPE(message, field, index, value);    \
+      break;                                                          \
+    case STORE_ADD:                                                   \
+      reflection->Add##TYPE(message, field, value);                   \
+      break;                                                          \
+  }                                                                   \
+  return true
+
+bool SetScalar(Message* message, const FieldDescriptor* field,
+               StoreMode mode, int index, PyObject* arg) {
+  const Reflection* reflection = message->GetReflection();
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32: {
+      int32 value;
+      if (!ToSignedInteger(arg, &value)) return false;
+      STORE_SCALAR(Int32, value);
+    }
+    case FieldDescriptor::CPPTYPE_INT64: {
+      int64 value;
+      if (!ToSignedInteger(arg, &value)) return false;
+      STORE_SCALAR(Int64, value);
+    }
+    case FieldDescriptor::CPPTYPE_UINT32: {
+      uint32 value;
+      if (!ToUnsignedInteger(arg, &value)) return false;
+      STORE_SCALAR(UInt32, value);
+    }
+    case FieldDescriptor::CPPTYPE_UINT64: {
+      uint64 value;
+      if (!ToUnsignedInteger(arg, &value)) return false;
+      STORE_SCALAR(UInt64, value);
+    }
+    case FieldDescriptor::CPPTYPE_FLOAT: {
+      double value;
+      if (!ToDouble(arg, &value)) return false;
+      STORE_SCALAR(Float, static_cast<float>(value));
+    }
+    case FieldDescriptor::CPPTYPE_DOUBLE: {
+      double value;
+      if (!ToDouble(arg, &value)) return false;
+      STORE_SCALAR(Double, value);
+    }
+    case FieldDescriptor::CPPTYPE_BOOL: {
+      int value = PyObject_IsTrue(arg);
+      if (value < 0) return false;
+      STORE_SCALAR(Bool, value != 0);
+    }
+    case FieldDescriptor::CPPTYPE_ENUM: {
+      const EnumValueDescriptor* value = ToEnum(field, arg);
+      if (value == NULL) return false;
+      STORE_SCALAR(Enum, value);
+    }
+    case FieldDescriptor::CPPTYPE_STRING: {
+      string value;
+      if (!ToString(arg, &value)) return false;
+      STORE_SCALAR(String, value);
+    }
+    default:
+      PyErr_Format(PyExc_SystemError, "Field %s is not a scalar.",
+                   field->full_name().c_str());
+      return false;
+  }
+}
+
+#undef STORE_SCALAR
+
+// ===================================================================
+// CMessage methods.
+
+void CMessageDealloc(CMessage* self) {
+  if (self->free_message) {
+    delete self->message;
+  }
+  Py_XDECREF(self->parent);
+  self->ob_type->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* CMessageRepr(CMessage* self) {
+  return PyString_FromFormat("<CMessage %s>",
+      self->message->GetDescriptor()->full_name().c_str());
+}
+
+PyObject* CMessage_Get(CMessage* self, PyObject* arg) {
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetField(self, arg, SINGULAR, SCALAR);
+  if (field == NULL) return NULL;
+  return GetScalar(*self->message, field, -1);
+}
+
+PyObject* CMessage_Set(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  PyObject* value;
+  if (!PyArg_ParseTuple(args, "OO:Set", &cdescriptor, &value)) return NULL;
+  const FieldDescriptor* field = GetField(self, cdescriptor, SINGULAR, SCALAR);
+  if (field == NULL) return NULL;
+  AssureWritable(self);
+  if (!SetScalar(self->message, field, STORE_SINGULAR, 0, value)) return NULL;
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_HasField(CMessage* self, PyObject* arg) {
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetAnyField(self, arg);
+  if (field == NULL) return NULL;
+  if (field->is_repeated()) {
+    PyErr_Format(PyExc_ValueError, "Field %s is repeated.",
+                 field->full_name().c_str());
+    return NULL;
+  }
+  return PyBool_FromLong(
+      self->message->GetReflection()->HasField(*self->message, field));
+}
+
+PyObject* CMessage_ClearField(CMessage* self, PyObject* arg) {
+  const FieldDescriptor* field = GetAnyField(self, arg);
+  if (field == NULL) return NULL;
+  // Clearing a field still marks the message present in its parent, just
+  // as in the pure-Python implementation.
+  AssureWritable(self);
+  self->message->GetReflection()->ClearField(self->message, field);
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_FieldLength(CMessage* self, PyObject* arg) {
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetAnyField(self, arg);
+  if (field == NULL) return NULL;
+  if (!field->is_repeated()) {
+    PyErr_Format(PyExc_TypeError, "Field %s is not repeated.",
+                 field->full_name().c_str());
+    return NULL;
+  }
+  return PyInt_FromLong(
+      self->message->GetReflection()->FieldSize(*self->message, field));
+}
+
+PyObject* CMessage_GetRepeated(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  Py_ssize_t index;
+  if (!PyArg_ParseTuple(args, "On:GetRepeated", &cdescriptor, &index)) {
+    return NULL;
+  }
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetField(self, cdescriptor, REPEATED, SCALAR);
+  if (field == NULL) return NULL;
+  if (!CheckIndex(*self->message, field, index)) return NULL;
+  return GetScalar(*self->message, field, index);
+}
+
+PyObject* CMessage_GetRepeatedList(CMessage* self, PyObject* arg) {
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetField(self, arg, REPEATED, SCALAR);
+  if (field == NULL) return NULL;
+  int size = self->message->GetReflection()->FieldSize(*self->message, field);
+  PyObject* list = PyList_New(size);
+  if (list == NULL) return NULL;
+  for (int i = 0; i < size; ++i) {
+    PyObject* value = GetScalar(*self->message, field, i);
+    if (value == NULL) {
+      Py_DECREF(list);
+      return NULL;
+    }
+    PyList_SET_ITEM(list, i, value);
+  }
+  return list;
+}
+
+PyObject* CMessage_SetRepeated(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  Py_ssize_t index;
+  PyObject* value;
+  if (!PyArg_ParseTuple(args, "OnO:SetRepeated",
+                        &cdescriptor, &index, &value)) {
+    return NULL;
+  }
+  const FieldDescriptor* field = GetField(self, cdescriptor, REPEATED, SCALAR);
+  if (field == NULL) return NULL;
+  AssureWritable(self);
+  if (!CheckIndex(*self->message, field, index)) return NULL;
+  if (!SetScalar(self->message, field, STORE_INDEX, index, value)) return NULL;
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_AddRepeated(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  PyObject* value;
+  if (!PyArg_ParseTuple(args, "OO:AddRepeated", &cdescriptor, &value)) {
+    return NULL;
+  }
+  const FieldDescriptor* field = GetField(self, cdescriptor, REPEATED, SCALAR);
+  if (field == NULL) return NULL;
+  AssureWritable(self);
+  if (!SetScalar(self->message, field, STORE_ADD, 0, value)) return NULL;
+  Py_RETURN_NONE;
+}
+
+// Replaces the contents of a repeated scalar field with a sequence.  The
+// list-editing operations of the Python container (insert, remove, slice
+// assignment, ...) are built on this rather than mirrored one by one.
+PyObject* CMessage_AssignRepeated(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  PyObject* values;
+  if (!PyArg_ParseTuple(args, "OO:AssignRepeated", &cdescriptor, &values)) {
+    return NULL;
+  }
+  const FieldDescriptor* field = GetField(self, cdescriptor, REPEATED, SCALAR);
+  if (field == NULL) return NULL;
+  PyObject* sequence = PySequence_Fast(values, "Expected a sequence.");
+  if (sequence == NULL) return NULL;
+
+  AssureWritable(self);
+  self->message->GetReflection()->ClearField(self->message, field);
+  Py_ssize_t size = PySequence_Fast_GET_SIZE(sequence);
+  for (Py_ssize_t i = 0; i < size; ++i) {
+    if (!SetScalar(self->message, field, STORE_ADD, 0,
+                   PySequence_Fast_GET_ITEM(sequence, i))) {
+      Py_DECREF(sequence);
+      return NULL;
+    }
+  }
+  Py_DECREF(sequence);
+  Py_RETURN_NONE;
+}
+
+// Removes the elements at the given indices, which must be sorted and
+// distinct, from a repeated field of any type.  Survivors keep their
+// relative order and, for message fields, their identity: elements are moved
+// by swapping pointers, so wrappers of the survivors remain valid.
+PyObject* CMessage_DeleteRepeated(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  PyObject* indices;
+  if (!PyArg_ParseTuple(args, "OO:DeleteRepeated", &cdescriptor, &indices)) {
+    return NULL;
+  }
+  const FieldDescriptor* field = GetAnyField(self, cdescriptor);
+  if (field == NULL) return NULL;
+  if (!field->is_repeated()) {
+    PyErr_Format(PyExc_TypeError, "Field %s is not repeated.",
+                 field->full_name().c_str());
+    return NULL;
+  }
+  PyObject* sequence = PySequence_Fast(indices, "Expected a sequence.");
+  if (sequence == NULL) return NULL;
+
+  AssureWritable(self);
+  Message* message = self->message;
+  const Reflection* reflection = message->GetReflection();
+  int size = reflection->FieldSize(*message, field);
+  Py_ssize_t num_indices = PySequence_Fast_GET_SIZE(sequence);
+  Py_ssize_t next = 0;
+  int write = 0;
+  for (int read = 0; read < size; ++read) {
+    if (next < num_indices) {
+      long index = PyInt_AsLong(PySequence_Fast_GET_ITEM(sequence, next));
+      if (index == -1 && PyErr_Occurred()) {
+        Py_DECREF(sequence);
+        return NULL;
+      }
+      if (index == read) {
+        ++next;
+        continue;
+      }
+    }
+    if (write != read) {
+      reflection->SwapElements(message, field, write, read);
+    }
+    ++write;
+  }
+  Py_DECREF(sequence);
+  for (int i = write; i < size; ++i) {
+    reflection->RemoveLast(message, field);
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_NewSubMessage(CMessage* self, PyObject* arg) {
+  UpdateFromParent(self);
+  const FieldDescriptor* field = GetField(self, arg, SINGULAR, COMPOSITE);
+  if (field == NULL) return NULL;
+
+  const Reflection* reflection = self->message->GetReflection();
+  Message* sub_message;
+  bool read_only;
+  if (!self->read_only && reflection->HasField(*self->message, field)) {
+    sub_message = reflection->MutableMessage(self->message, field,
+                                             global_message_factory);
+    read_only = false;
+  } else {
+    sub_message = const_cast<Message*>(&reflection->GetMessage(
+        *self->message, field, global_message_factory));
+    read_only = true;
+  }
+  return reinterpret_cast<PyObject*>(
+      NewCMessageObject(sub_message, false, read_only, self, field));
+}
+
+PyObject* CMessage_GetRepeatedMessage(CMessage* self, PyObject* args) {
+  PyObject* cdescriptor;
+  Py_ssize_t index;
+  if (!PyArg_ParseTuple(args, "On:GetRepeatedMessage", &cdescriptor, &index)) {
+    return NULL;
+  }
+  UpdateFromParent(self);
+  const FieldDescriptor* field =
+      GetField(self, cdescriptor, REPEATED, COMPOSITE);
+  if (field == NULL) return NULL;
+  if (!CheckIndex(*self->message, field, index)) return NULL;
+  // A message with elements in a repeated field cannot be read-only.
+  Message* element = self->message->GetReflection()->MutableRepeatedMessage(
+      self->message, field, index);
+  return reinterpret_cast<PyObject*>(
+      NewCMessageObject(element, false, false, self, field));
+}
+
+PyObject* CMessage_AddMessage(CMessage* self, PyObject* arg) {
+  const FieldDescriptor* field = GetField(self, arg, REPEATED, COMPOSITE);
+  if (field == NULL) return NULL;
+  AssureWritable(self);
+  Message* element = self->message->GetReflection()->AddMessage(
+      self->message, field, global_message_factory);
+  return reinterpret_cast<PyObject*>(
+      NewCMessageObject(element, false, false, self, field));
+}
+
+// Gives this message its own copy of its contents and cuts it loose from its
+// parent.  Called on sub-message wrappers just before the parent clears or
+// removes the object they point at, so that Python references to them stay
+// valid -- with the pure-Python implementation, a cleared sub-message also
+// keeps its values.
+PyObject* CMessage_Detach(CMessage* self, PyObject* ignored) {
+  if (self->parent == NULL) Py_RETURN_NONE;
+
+  UpdateFromParent(self);
+  Message* detached = self->message->New();
+  if (!self->read_only) {
+    // Swapping moves sub-objects by pointer, so wrappers of our own
+    // sub-messages follow the data into |detached|.
+    detached->GetReflection()->Swap(self->message, detached);
+  }
+  self->message = detached;
+  self->free_message = true;
+  self->read_only = false;
+  Py_CLEAR(self->parent);
+  self->parent_field = NULL;
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_SetInParent(CMessage* self, PyObject* ignored) {
+  AssureWritable(self);
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_Clear(CMessage* self, PyObject* ignored) {
+  AssureWritable(self);
+  self->message->Clear();
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_ByteSize(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  return PyInt_FromLong(self->message->ByteSize());
+}
+
+PyObject* CMessage_SerializePartialToString(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  string contents;
+  self->message->SerializePartialToString(&contents);
+  return PyString_FromStringAndSize(contents.data(), contents.size());
+}
+
+// Returns the number of bytes consumed, or -1 if the data could not be
+// parsed.  The caller raises DecodeError, which lives in a Python module.
+PyObject* CMessage_MergeFromString(CMessage* self, PyObject* arg) {
+  const char* data;
+  Py_ssize_t size;
+  if (PyString_AsStringAndSize(arg, const_cast<char**>(&data), &size) < 0) {
+    return NULL;
+  }
+  AssureWritable(self);
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(data), size);
+  bool success = self->message->MergePartialFromCodedStream(&input) &&
+                 input.ConsumedEntireMessage();
+  return PyInt_FromLong(success ? size : -1);
+}
+
+PyObject* CMessage_MergeFrom(CMessage* self, PyObject* arg) {
+  if (!PyObject_TypeCheck(arg, &CMessage_Type)) {
+    PyErr_SetString(PyExc_TypeError, "Expected a CMessage.");
+    return NULL;
+  }
+  CMessage* other = reinterpret_cast<CMessage*>(arg);
+  UpdateFromParent(other);
+  if (other->message->GetDescriptor() != self->message->GetDescriptor()) {
+    PyErr_Format(PyExc_TypeError,
+                 "Tried to merge from a message of type %s into %s.",
+                 other->message->GetDescriptor()->full_name().c_str(),
+                 self->message->GetDescriptor()->full_name().c_str());
+    return NULL;
+  }
+  AssureWritable(self);
+  self->message->MergeFrom(*other->message);
+  Py_RETURN_NONE;
+}
+
+PyObject* CMessage_IsInitialized(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  return PyBool_FromLong(self->message->IsInitialized());
+}
+
+PyObject* CMessage_FindInitializationErrors(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  vector<string> errors;
+  self->message->FindInitializationErrors(&errors);
+  PyObject* list = PyList_New(errors.size());
+  if (list == NULL) return NULL;
+  for (int i = 0; i < errors.size(); ++i) {
+    PyObject* error = PyString_FromStringAndSize(errors[i].data(),
+                                                 errors[i].size());
+    if (error == NULL) {
+      Py_DECREF(list);
+      return NULL;
+    }
+    PyList_SET_ITEM(list, i, error);
+  }
+  return list;
+}
+
+// Returns (number, is_extension) pairs for the fields that are set, ordered
+// by number.  Python maps them back to its own FieldDescriptors.
+PyObject* CMessage_ListFields(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  vector<const FieldDescriptor*> fields;
+  self->message->GetReflection()->ListFields(*self->message, &fields);
+  PyObject* list = PyList_New(fields.size());
+  if (list == NULL) return NULL;
+  for (int i = 0; i < fields.size(); ++i) {
+    PyObject* item = Py_BuildValue("(iO)", fields[i]->number(),
+        fields[i]->is_extension() ? Py_True : Py_False);
+    if (item == NULL) {
+      Py_DECREF(list);
+      return NULL;
+    }
+    PyList_SET_ITEM(list, i, item);
+  }
+  return list;
+}
+
+PyObject* CMessage_DebugString(CMessage* self, PyObject* ignored) {
+  UpdateFromParent(self);
+  string debug_string = self->message->DebugString();
+  return PyString_FromStringAndSize(debug_string.data(), debug_string.size());
+}
+
+PyMethodDef CMessage_methods[] = {
+  { "Get", (PyCFunction)CMessage_Get, METH_O,
+    "Returns the value of a singular scalar field." },
+  { "Set", (PyCFunction)CMessage_Set, METH_VARARGS,
+    "Sets the value of a singular scalar field." },
+  { "HasField", (PyCFunction)CMessage_HasField, METH_O,
+    "Checks whether a singular field is set." },
+  { "ClearField", (PyCFunction)CMessage_ClearField, METH_O,
+    "Clears a field." },
+  { "FieldLength", (PyCFunction)CMessage_FieldLength, METH_O,
+    "Returns the number of elements in a repeated field." },
+  { "GetRepeated", (PyCFunction)CMessage_GetRepeated, METH_VARARGS,
+    "Returns an element of a repeated scalar field." },
+  { "GetRepeatedList", (PyCFunction)CMessage_GetRepeatedList, METH_O,
+    "Returns all elements of a repeated scalar field as a list." },
+  { "SetRepeated", (PyCFunction)CMessage_SetRepeated, METH_VARARGS,
+    "Sets an element of a repeated scalar field." },
+  { "AddRepeated", (PyCFunction)CMessage_AddRepeated, METH_VARARGS,
+    "Appends to a repeated scalar field." },
+  { "AssignRepeated", (PyCFunction)CMessage_AssignRepeated, METH_VARARGS,
+    "Replaces the contents of a repeated scalar field." },
+  { "DeleteRepeated", (PyCFunction)CMessage_DeleteRepeated, METH_VARARGS,
+    "Removes elements, given by sorted indices, from a repeated field." },
+  { "NewSubMessage", (PyCFunction)CMessage_NewSubMessage, METH_O,
+    "Returns a CMessage for a singular message field." },
+  { "GetRepeatedMessage", (PyCFunction)CMessage_GetRepeatedMessage,
+    METH_VARARGS, "Returns a CMessage for an element of a repeated field." },
+  { "AddMessage", (PyCFunction)CMessage_AddMessage, METH_O,
+    "Appends to a repeated message field and returns the new CMessage." },
+  { "Detach", (PyCFunction)CMessage_Detach, METH_NOARGS,
+    "Makes this message own its contents, independent of its parent." },
+  { "SetInParent", (PyCFunction)CMessage_SetInParent, METH_NOARGS,
+    "Marks this message as present in its parent." },
+  { "Clear", (PyCFunction)CMessage_Clear, METH_NOARGS,
+    "Clears the message." },
+  { "ByteSize", (PyCFunction)CMessage_ByteSize, METH_NOARGS,
+    "Returns the size of the serialized message." },
+  { "SerializePartialToString",
+    (PyCFunction)CMessage_SerializePartialToString, METH_NOARGS,
+    "Serializes the message without checking required fields." },
+  { "MergeFromString", (PyCFunction)CMessage_MergeFromString, METH_O,
+    "Merges serialized data; returns the bytes read, or -1 on error." },
+  { "MergeFrom", (PyCFunction)CMessage_MergeFrom, METH_O,
+    "Merges another CMessage of the same type into this one." },
+  { "IsInitialized", (PyCFunction)CMessage_IsInitialized, METH_NOARGS,
+    "Checks whether all required fields are set." },
+  { "FindInitializationErrors",
+    (PyCFunction)CMessage_FindInitializationErrors, METH_NOARGS,
+    "Returns the paths of all missing required fields." },
+  { "ListFields", (PyCFunction)CMessage_ListFields, METH_NOARGS,
+    "Returns (number, is_extension) for each field that is set." },
+  { "DebugString", (PyCFunction)CMessage_DebugString, METH_NOARGS,
+    "Returns the message in text format." },
+  { NULL, NULL }
+};
+
+PyTypeObject CMessage_Type = {
+  PyObject_HEAD_INIT(&PyType_Type)
+  0,                                    // ob_size
+  "google.protobuf.internal._net_proto2___python.CMessage",
+  sizeof(CMessage),                     // tp_basicsize
+  0,                                    // tp_itemsize
+  (destructor)CMessageDealloc,          // tp_dealloc
+  0,                                    // tp_print
+  0,                                    // tp_getattr
+  0,                                    // tp_setattr
+  0,                                    // tp_compare
+  (reprfunc)CMessageRepr,               // tp_repr
+  0,                                    // tp_as_number
+  0,                                    // tp_as_sequence
+  0,                                    // tp_as_mapping
+  0,                                    // tp_hash
+  0,                                    // tp_call
+  0,                                    // tp_str
+  0,                                    // tp_getattro
+  0,                                    // tp_setattro
+  0,                                    // tp_as_buffer
+  Py_TPFLAGS_DEFAULT,                   // tp_flags
+  "A C++ protocol message",             // tp_doc
+  0,                                    // tp_traverse
+  0,                                    // tp_clear
+  0,                                    // tp_richcompare
+  0,                                    // tp_weaklistoffset
+  0,                                    // tp_iter
+  0,                                    // tp_iternext
+  CMessage_methods,                     // tp_methods
+};
+
+// ===================================================================
+// Module functions.
+
+PyObject* Python_NewCMessage(PyObject* ignored, PyObject* full_name) {
+  const char* name = PyString_AsString(full_name);
+  if (name == NULL) return NULL;
+
+  const Descriptor* descriptor =
+      GetDescriptorPool()->FindMessageTypeByName(name);
+  if (descriptor == NULL) {
+    PyErr_Format(PyExc_TypeError, "Couldn't find message %s", name);
+    return NULL;
+  }
+  Message* message =
+      global_message_factory->GetPrototype(descriptor)->New();
+  return reinterpret_cast<PyObject*>(
+      NewCMessageObject(message, true, false, NULL, NULL));
+}
+
+PyMethodDef module_methods[] = {
+  { "NewCMessage", (PyCFunction)Python_NewCMessage, METH_O,
+    "Creates a new C++ message of the given type." },
+  { "BuildFile", (PyCFunction)Python_BuildFile, METH_O,
+    "Adds a serialized FileDescriptorProto to the C++ descriptor pool." },
+  { "GetFieldDescriptor", (PyCFunction)Python_GetFieldDescriptor, METH_O,
+    "Looks up a field by full name." },
+  { "GetExtensionDescriptor", (PyCFunction)Python_GetExtensionDescriptor,
+    METH_O, "Looks up an extension by full name." },
+  { NULL, NULL }
+};
+
+}  // namespace
+
+}  // namespace python
+}  // namespace protobuf
+}  // namespace google
+
+extern "C" {
+PyMODINIT_FUNC init_net_proto2___python() {
+  using google::protobuf::python::CFieldDescriptor_Type;
+  using google::protobuf::python::CMessage_Type;
+
+  PyObject* module = Py_InitModule3(
+      "_net_proto2___python", google::protobuf::python::module_methods,
+      "C++ implementation of Python protocol messages.");
+  if (module == NULL) return;
+
+  if (PyType_Ready(&CFieldDescriptor_Type) < 0) return;
+  if (PyType_Ready(&CMessage_Type) < 0) return;
+
+  google::protobuf::python::global_message_factory =
+      new google::protobuf::DynamicMessageFactory(
+          google::protobuf::python::GetDescriptorPool());
+
+  Py_INCREF(&CFieldDescriptor_Type);
+  PyModule_AddObject(module, "CFieldDescriptor",
+                     reinterpret_cast<PyObject*>(&CFieldDescriptor_Type));
+  Py_INCREF(&CMessage_Type);
+  PyModule_AddObject(module, "CMessage",
+                     reinterpret_cast<PyObject*>(&CMessage_Type));
+}
+}
@@ -0,0 +1,180 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+#include <google/protobuf/pyext/python_descriptor.h>
+
+#include <string>
+
+#include <google/protobuf/descriptor.pb.h>
+
+namespace google {
+namespace protobuf {
+namespace python {
+
+namespace {
+
+// Collects the errors from a failed BuildFile() so they can be surfaced in
+// the Python exception rather than only in the log.
+class BuildFileErrorCollector : public DescriptorPool::ErrorCollector {
+ public:
+  BuildFileErrorCollector() {}
+
+  virtual void AddError(const string& filename,
+                        const string& element_name,
+                        const Message* descriptor,
+                        ErrorLocation location,
+                        const string& message) {
+    if (!error_message_.empty()) error_message_ += "\n";
+    error_message_ += filename + ": " + element_name + ": " + message;
+  }
+
+  const string& error_message() const { return error_message_; }
+
+ private:
+  string error_message_;
+};
+
+void CFieldDescriptorDealloc(CFieldDescriptor* self) {
+  Py_XDECREF(self->full_name);
+  self->ob_type->tp_free(reinterpret_cast<PyObject*>(self));
+}
+
+PyObject* CFieldDescriptorRepr(CFieldDescriptor* self) {
+  return PyString_FromFormat("<CFieldDescriptor %s>",
+                             PyString_AsString(self->full_name));
+}
+
+PyObject* NewCFieldDescriptor(const FieldDescriptor* descriptor) {
+  CFieldDescriptor* result = PyObject_New(CFieldDescriptor,
+                                          &CFieldDescriptor_Type);
+  if (result == NULL) return NULL;
+  result->descriptor = descriptor;
+  result->full_name = PyString_FromStringAndSize(
+      descriptor->full_name().data(), descriptor->full_name().size());
+  if (result->full_name == NULL) {
+    Py_DECREF(result);
+    return NULL;
+  }
+  return reinterpret_cast<PyObject*>(result);
+}
+
+}  // namespace
+
+PyTypeObject CFieldDescriptor_Type = {
+  PyObject_HEAD_INIT(&PyType_Type)
+  0,                                    // ob_size
+  "google.protobuf.internal._net_proto2___python.CFieldDescriptor",
+  sizeof(CFieldDescriptor),             // tp_basicsize
+  0,                                    // tp_itemsize
+  (destructor)CFieldDescriptorDealloc,  // tp_dealloc
+  0,                                    // tp_print
+  0,                                    // tp_getattr
+  0,                                    // tp_setattr
+  0,                                    // tp_compare
+  (reprfunc)CFieldDescriptorRepr,       // tp_repr
+  0,                                    // tp_as_number
+  0,                                    // tp_as_sequence
+  0,                                    // tp_as_mapping
+  0,                                    // tp_hash
+  0,                                    // tp_call
+  0,                                    // tp_str
+  0,                                    // tp_getattro
+  0,                                    // tp_setattro
+  0,                                    // tp_as_buffer
+  Py_TPFLAGS_DEFAULT,                   // tp_flags
+  "A C++ FieldDescriptor",              // tp_doc
+};
+
+DescriptorPool* GetDescriptorPool() {
+  static DescriptorPool* pool =
+      new DescriptorPool(DescriptorPool::generated_pool());
+  return pool;
+}
+
+PyObject* Python_BuildFile(PyObject* ignored, PyObject* serialized_pb) {
+  char* data;
+  Py_ssize_t size;
+  if (PyString_AsStringAndSize(serialized_pb, &data, &size) < 0) {
+    return NULL;
+  }
+
+  FileDescriptorProto file_proto;
+  if (!file_proto.ParseFromArray(data, size)) {
+    PyErr_SetString(PyExc_TypeError, "Couldn't parse file content!");
+    return NULL;
+  }
+
+  // Generated modules build their file every time they are imported, and
+  // descriptor.proto is already in the underlay; both are fine to skip.
+  DescriptorPool* pool = GetDescriptorPool();
+  if (pool->FindFileByName(file_proto.name()) != NULL) {
+    Py_RETURN_NONE;
+  }
+
+  BuildFileErrorCollector error_collector;
+  if (pool->BuildFileCollectingErrors(file_proto, &error_collector) == NULL) {
+    PyErr_Format(PyExc_TypeError, "Couldn't build proto file into pool:\n%s",
+                 error_collector.error_message().c_str());
+    return NULL;
+  }
+  Py_RETURN_NONE;
+}
+
+PyObject* Python_GetFieldDescriptor(PyObject* ignored, PyObject* full_name) {
+  const char* name = PyString_AsString(full_name);
+  if (name == NULL) return NULL;
+
+  const FieldDescriptor* descriptor =
+      GetDescriptorPool()->FindFieldByName(name);
+  if (descriptor == NULL) {
+    PyErr_Format(PyExc_KeyError, "Couldn't find field %s", name);
+    return NULL;
+  }
+  return NewCFieldDescriptor(descriptor);
+}
+
+PyObject* Python_GetExtensionDescriptor(PyObject* ignored,
+                                        PyObject* full_name) {
+  const char* name = PyString_AsString(full_name);
+  if (name == NULL) return NULL;
+
+  const FieldDescriptor* descriptor =
+      GetDescriptorPool()->FindExtensionByName(name);
+  if (descriptor == NULL) {
+    PyErr_Format(PyExc_KeyError, "Couldn't find extension %s", name);
+    return NULL;
+  }
+  return NewCFieldDescriptor(descriptor);
+}
+
+}  // namespace python
+}  // namespace protobuf
+}  // namespace google
@@ -45,7 +45,9 @@ output by the protocol compiler at compile-time.
 
 The upshot of all this is that the real implementation
 details for ALL pure-Python protocol buffers are *here in
-this file*.
+this file*.  When api_implementation.Type() is 'cpp', the
+metaclass instead hands the class to internal/cpp_message.py,
+which backs it with the C++ implementation.
 """
 
 __author__ = 'robinson@google.com (Will Robinson)'
@@ -58,6 +60,7 @@ import struct
 import weakref
 
 # We use "as" to avoid name collisions with variables.
+from google.protobuf.internal import api_implementation
 from google.protobuf.internal import containers
 from google.protobuf.internal import decoder
 from google.protobuf.internal import encoder
@@ -70,6 +73,11 @@ from google.protobuf import text_format
 
 _FieldDescriptor = descriptor_mod.FieldDescriptor
 
+if api_implementation.Type() == 'cpp':
+  from google.protobuf.internal import cpp_message as _cpp_message
+else:
+  _cpp_message = None
+
 
 class GeneratedProtocolMessageType(type):
 
@@ -120,8 +128,11 @@ class GeneratedProtocolMessageType(type):
       Newly-allocated class.
     """
     descriptor = dictionary[GeneratedProtocolMessageType._DESCRIPTOR_KEY]
-    _AddSlots(descriptor, dictionary)
-    _AddClassAttributesForNestedExtensions(descriptor, dictionary)
+    if _cpp_message is not None:
+      _cpp_message.NewMessage(descriptor, dictionary)
+    else:
+      _AddSlots(descriptor, dictionary)
+      _AddClassAttributesForNestedExtensions(descriptor, dictionary)
     superclass = super(GeneratedProtocolMessageType, cls)
     return superclass.__new__(cls, name, bases, dictionary)
 
@@ -143,6 +154,12 @@ class GeneratedProtocolMessageType(type):
         type.
     """
     descriptor = dictionary[GeneratedProtocolMessageType._DESCRIPTOR_KEY]
+    superclass = super(GeneratedProtocolMessageType, cls)
+
+    if _cpp_message is not None:
+      _cpp_message.InitMessage(descriptor, cls)
+      superclass.__init__(name, bases, dictionary)
+      return
 
     cls._decoders_by_tag = {}
     cls._extensions_by_name = {}
@@ -170,7 +187,6 @@ class GeneratedProtocolMessageType(type):
     _AddStaticMethods(cls)
     _AddMessageMethods(descriptor, cls)
     _AddPrivateHelperMethods(cls)
-    superclass = super(GeneratedProtocolMessageType, cls)
     superclass.__init__(name, bases, dictionary)
 
 
@@ -7,7 +7,7 @@
 from ez_setup import use_setuptools
 use_setuptools()
 
-from setuptools import setup
+from setuptools import setup, Extension
 from distutils.spawn import find_executable
 import sys
 import os
@@ -23,10 +23,10 @@ elif os.path.exists("../src/protoc.exe"):
 else:
   protoc = find_executable("protoc")
 
-def generate_proto(source):
+def generate_proto(source, options=None):
   """Invokes the Protocol Compiler to generate a _pb2.py from the given
-  .proto file.  Does nothing if the output already exists and is newer than
-  the input."""
+  .proto file, passing the given generator options, if any.  Does nothing if
+  the output already exists and is newer than the input."""
 
   output = source.replace(".proto", "_pb2.py").replace("../src/", "")
 
@@ -45,7 +45,11 @@ def generate_proto(source):
           "or install the binary package.\n")
       sys.exit(-1)
 
-    protoc_command = [ protoc, "-I../src", "-I.", "--python_out=.", source ]
+    python_out = "."
+    if options:
+      python_out = options + ":."
+    protoc_command = [ protoc, "-I../src", "-I.", "--python_out=" + python_out,
+                       source ]
     if subprocess.call(protoc_command) != 0:
       sys.exit(-1)
 
@@ -61,13 +65,18 @@ def MakeTestSuite():
   generate_proto("../src/google/protobuf/unittest_no_generic_services.proto")
   generate_proto("google/protobuf/internal/more_extensions.proto")
   generate_proto("google/protobuf/internal/more_messages.proto")
+  generate_proto("google/protobuf/internal/specialized_codecs.proto",
+                 "specialized_codecs")
 
   import unittest
   import google.protobuf.internal.generator_test     as generator_test
+  import google.protobuf.internal.packed_codec_test  as packed_codec_test
   import google.protobuf.internal.descriptor_test    as descriptor_test
   import google.protobuf.internal.reflection_test    as reflection_test
   import google.protobuf.internal.service_reflection_test \
     as service_reflection_test
+  import google.protobuf.internal.specialized_codecs_test \
+    as specialized_codecs_test
   import google.protobuf.internal.text_format_test   as text_format_test
   import google.protobuf.internal.wire_format_test   as wire_format_test
 
@@ -75,8 +84,10 @@ def MakeTestSuite():
   suite = unittest.TestSuite()
   for test in [ generator_test,
                 descriptor_test,
+                packed_codec_test,
                 reflection_test,
                 service_reflection_test,
+                specialized_codecs_test,
                 text_format_test,
                 wire_format_test ]:
     suite.addTest(loader.loadTestsFromModule(test))
@@ -97,6 +108,30 @@ if __name__ == '__main__':
     # TODO(kenton):  Maybe we should hook this into a distutils command?
     generate_proto("../src/google/protobuf/descriptor.proto")
 
+  ext_module_list = []
+
+  # C++ implementation extension
+  if '--cpp_implementation' in sys.argv:
+    sys.argv.remove('--cpp_implementation')
+    print "Using EXPERIMENTAL C++ Implementation."
+    ext_module_list.append(Extension(
+        "google.protobuf.internal._net_proto2___python",
+        [ "google/protobuf/pyext/python_descriptor.cc",
+          "google/protobuf/pyext/python-proto2.cc" ],
+        include_dirs = [ ".", "../src" ],
+        libraries = [ "protobuf" ],
+        library_dirs = [ "../src/.libs" ],
+        ))
+
+  # Optional accelerator for packed repeated fields in the pure-Python
+  # implementation.  It does not need libprotobuf.
+  if '--packed_codec' in sys.argv:
+    sys.argv.remove('--packed_codec')
+    ext_module_list.append(Extension(
+        "google.protobuf.internal._packed_codec",
+        [ "google/protobuf/pyext/packed_codec.cc" ],
+        ))
+
   setup(name = 'protobuf',
         version = '2.3.0',
         packages = [ 'google' ],
@@ -104,7 +139,9 @@ if __name__ == '__main__':
         test_suite = 'setup.MakeTestSuite',
         # Must list modules explicitly so that we don't install tests.
         py_modules = [
+          'google.protobuf.internal.api_implementation',
           'google.protobuf.internal.containers',
+          'google.protobuf.internal.cpp_message',
           'google.protobuf.internal.decoder',
           'google.protobuf.internal.encoder',
           'google.protobuf.internal.message_listener',
@@ -117,6 +154,7 @@ if __name__ == '__main__':
           'google.protobuf.service',
           'google.protobuf.service_reflection',
           'google.protobuf.text_format' ],
+        ext_modules = ext_module_list,
         url = 'http://code.google.com/p/protobuf/',
         maintainer = maintainer_email,
         maintainer_email = 'protobuf@googlegroups.com',
@@ -0,0 +1,345 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/allocation_profiler.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+
+#include <google/protobuf/stubs/once.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#define snprintf _snprintf    // see comment in strutil.cc
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+namespace google {
+namespace protobuf {
+
+namespace internal {
+
+AllocationProfiler* allocation_profiler = NULL;
+
+namespace {
+
+// What each thread needs to decide which allocations to sample, and the
+// field the innermost AllocationContext names.
+struct ThreadState {
+  ThreadState()
+    : profiler(NULL), bytes_until_sample(0),
+      random(static_cast<uint64>(reinterpret_cast<intptr_t>(this)) ^
+             static_cast<uint64>(time(NULL)) ^
+             GOOGLE_ULONGLONG(0x9e3779b97f4a7c15)),
+      type_name(NULL), field_name(NULL) {}
+
+  // The profiler bytes_until_sample was chosen for.
+  AllocationProfiler* profiler;
+  int64 bytes_until_sample;
+  uint64 random;
+
+  const char* type_name;
+  const char* field_name;
+};
+
+#ifdef _WIN32
+
+DWORD thread_state_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(thread_state_slot_once);
+
+void InitThreadStateSlot() {
+  thread_state_slot = TlsAlloc();
+}
+
+// Windows has no TLS destructors for TlsAlloc() slots, so each thread's
+// state is leaked when the thread exits.  It is a few dozen bytes, and
+// only allocated once a thread has touched a profiled allocation.
+ThreadState* GetThreadState() {
+  GoogleOnceInit(&thread_state_slot_once, &InitThreadStateSlot);
+  ThreadState* state =
+      reinterpret_cast<ThreadState*>(TlsGetValue(thread_state_slot));
+  if (state == NULL) {
+    state = new ThreadState;
+    TlsSetValue(thread_state_slot, state);
+  }
+  return state;
+}
+
+#else
+
+pthread_key_t thread_state_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(thread_state_slot_once);
+
+void DeleteThreadState(void* state) {
+  delete reinterpret_cast<ThreadState*>(state);
+}
+
+void InitThreadStateSlot() {
+  pthread_key_create(&thread_state_slot, &DeleteThreadState);
+}
+
+ThreadState* GetThreadState() {
+  GoogleOnceInit(&thread_state_slot_once, &InitThreadStateSlot);
+  ThreadState* state =
+      reinterpret_cast<ThreadState*>(pthread_getspecific(thread_state_slot));
+  if (state == NULL) {
+    state = new ThreadState;
+    pthread_setspecific(thread_state_slot, state);
+  }
+  return state;
+}
+
+#endif
+
+// Picks the number of bytes to let through before the next sample.  The
+// distances are exponentially distributed, so that every byte allocated is
+// equally likely to be the one which triggers a sample.
+int64 PickSampleDistance(ThreadState* state, int64 interval) {
+  if (interval <= 1) return 0;
+
+  // xorshift64*; plenty for spreading samples out.
+  state->random ^= state->random >> 12;
+  state->random ^= state->random << 25;
+  state->random ^= state->random >> 27;
+  uint64 bits = state->random * GOOGLE_ULONGLONG(2685821657736338717);
+
+  // Uniform in (0, 1).
+  double uniform = (static_cast<double>(bits >> 11) + 0.5) /
+                   9007199254740992.0;
+  return static_cast<int64>(-log(uniform) * interval);
+}
+
+}  // namespace
+
+void SampleAllocationSlow(int source, int bytes,
+                          const char* type_name, const char* field_name) {
+  AllocationProfiler* profiler = allocation_profiler;
+  if (profiler == NULL) return;
+  int64 interval = profiler->sample_interval_bytes();
+
+  ThreadState* state = GetThreadState();
+  if (state->profiler != profiler) {
+    state->profiler = profiler;
+    state->bytes_until_sample = PickSampleDistance(state, interval);
+  }
+
+  state->bytes_until_sample -= bytes;
+  if (state->bytes_until_sample >= 0) return;
+  state->bytes_until_sample = PickSampleDistance(state, interval);
+
+  if (type_name == NULL) {
+    type_name = state->type_name;
+    field_name = state->field_name;
+  }
+
+  // An allocation of s bytes is sampled with probability 1 - e^(-s/T), so
+  // each sample stands for the reciprocal of that many allocations.
+  double allocations = 1.0;
+  if (interval > 1) {
+    allocations = 1.0 / (1.0 - exp(-static_cast<double>(bytes) / interval));
+  }
+  profiler->Record(static_cast<AllocationProfiler::Source>(source),
+                   type_name, field_name, allocations, allocations * bytes);
+}
+
+void AllocationContext::Enter(const char* type_name, const char* field_name) {
+  ThreadState* state = GetThreadState();
+  thread_ = state;
+  saved_type_name_ = state->type_name;
+  saved_field_name_ = state->field_name;
+  state->type_name = type_name;
+  state->field_name = field_name;
+}
+
+void AllocationContext::Leave() {
+  ThreadState* state = reinterpret_cast<ThreadState*>(thread_);
+  state->type_name = saved_type_name_;
+  state->field_name = saved_field_name_;
+}
+
+}  // namespace internal
+
+AllocationProfiler* SetAllocationProfiler(AllocationProfiler* profiler) {
+  AllocationProfiler* old = internal::allocation_profiler;
+  internal::allocation_profiler = profiler;
+  return old;
+}
+
+// ===================================================================
+
+namespace {
+
+struct SiteTotals {
+  SiteTotals() : samples(0), allocations(0), bytes(0) {}
+
+  int64 samples;
+  double allocations;
+  double bytes;
+};
+
+struct ByBytesDescending {
+  bool operator()(const AllocationProfiler::Site& a,
+                  const AllocationProfiler::Site& b) const {
+    if (a.bytes != b.bytes) return a.bytes > b.bytes;
+    if (a.type_name != b.type_name) return a.type_name < b.type_name;
+    if (a.field_name != b.field_name) return a.field_name < b.field_name;
+    return a.source < b.source;
+  }
+};
+
+string FormatInt64(int64 value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.0f", static_cast<double>(value));
+  return buffer;
+}
+
+}  // namespace
+
+// Keyed by (type name, field name, source).  Only samples are recorded, so
+// this need not be fast.
+struct AllocationProfiler::Table {
+  typedef pair<pair<string, string>, int> Key;
+  typedef map<Key, SiteTotals> Map;
+  Map sites;
+};
+
+AllocationProfiler::AllocationProfiler(int64 sample_interval_bytes)
+  : sample_interval_bytes_(sample_interval_bytes),
+    table_(new Table) {}
+
+AllocationProfiler::~AllocationProfiler() {
+  delete table_;
+}
+
+const char* AllocationProfiler::SourceName(Source source) {
+  switch (source) {
+    case STRING:           return "string";
+    case SUB_MESSAGE:      return "sub_message";
+    case REPEATED_ELEMENT: return "repeated_element";
+    case REPEATED_ARRAY:   return "repeated_array";
+    case UNKNOWN_FIELD:    return "unknown_field";
+    default:               break;
+  }
+  GOOGLE_LOG(DFATAL) << "Unknown source: " << source;
+  return "unknown";
+}
+
+void AllocationProfiler::Record(Source source, const char* type_name,
+                                const char* field_name,
+                                double allocations, double bytes) {
+  Table::Key key(make_pair(string(type_name == NULL ? "" : type_name),
+                           string(field_name == NULL ? "" : field_name)),
+                 source);
+  MutexLock lock(&mutex_);
+  SiteTotals* totals = &table_->sites[key];
+  ++totals->samples;
+  totals->allocations += allocations;
+  totals->bytes += bytes;
+}
+
+void AllocationProfiler::GetSites(vector<Site>* sites) const {
+  int first = sites->size();
+  {
+    MutexLock lock(&mutex_);
+    for (Table::Map::const_iterator iter = table_->sites.begin();
+         iter != table_->sites.end(); ++iter) {
+      Site site;
+      site.type_name = iter->first.first.first;
+      site.field_name = iter->first.first.second;
+      site.source = static_cast<Source>(iter->first.second);
+      site.samples = iter->second.samples;
+      site.allocations = static_cast<int64>(iter->second.allocations + 0.5);
+      site.bytes = static_cast<int64>(iter->second.bytes + 0.5);
+      sites->push_back(site);
+    }
+  }
+  sort(sites->begin() + first, sites->end(), ByBytesDescending());
+}
+
+void AllocationProfiler::Reset() {
+  MutexLock lock(&mutex_);
+  table_->sites.clear();
+}
+
+string AllocationProfiler::Report() const {
+  vector<Site> sites;
+  GetSites(&sites);
+
+  int64 total_bytes = 0;
+  int64 total_allocations = 0;
+  for (int i = 0; i < sites.size(); i++) {
+    total_bytes += sites[i].bytes;
+    total_allocations += sites[i].allocations;
+  }
+
+  string result = "Allocation profile (sample interval " +
+      FormatInt64(sample_interval_bytes_) + " bytes): ~" +
+      FormatInt64(total_bytes) + " bytes in ~" +
+      FormatInt64(total_allocations) + " allocations\n";
+
+  char line[128];
+  snprintf(line, sizeof(line), "\n%14s %6s %12s %8s  %-17s %s\n",
+           "bytes", "", "allocations", "samples", "source", "site");
+  result += line;
+  for (int i = 0; i < sites.size(); i++) {
+    const Site& site = sites[i];
+    char percent[16];
+    snprintf(percent, sizeof(percent), "%.1f%%",
+             total_bytes == 0 ? 0.0 : 100.0 * site.bytes / total_bytes);
+    snprintf(line, sizeof(line), "%14s %6s %12s %8s  %-17s ",
+             FormatInt64(site.bytes).c_str(), percent,
+             FormatInt64(site.allocations).c_str(),
+             FormatInt64(site.samples).c_str(), SourceName(site.source));
+    result += line;
+
+    if (site.type_name.empty()) {
+      result += "(unattributed)";
+    } else if (site.field_name.empty()) {
+      result += site.type_name;
+    } else {
+      result += site.type_name + "." + site.field_name;
+    }
+    result += "\n";
+  }
+  return result;
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,209 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Sampling profiler for the heap allocations made by messages.
+//
+// Once an AllocationProfiler is installed with SetAllocationProfiler(), a
+// sample of the allocations messages make for their fields is attributed to
+// the message type and field which made them:
+//
+//   * Code generated with the "profile_allocations" option, e.g.:
+//       protoc --cpp_out=profile_allocations:outdir foo.proto
+//     reports the strings allocated by string field setters, the embedded
+//     messages allocated by mutable_foo(), and the elements added to
+//     repeated string and message fields, each under its own field.
+//
+//   * RepeatedPtrField reports the elements it allocates and the arrays it
+//     grows, and UnknownFieldSet the length-delimited values it stores.
+//     These are attributed to the field or message being worked on by
+//     profiled generated code on the same thread, if any.
+//
+// Sampling works like tcmalloc's heap profiler: on average one sample is
+// taken per sample interval bytes allocated, with larger allocations more
+// likely to be picked, and each sample is scaled up to estimate the
+// allocations it stands for.  When no profiler is installed, each reporting
+// point costs a load and a branch.
+//
+//   AllocationProfiler profiler(512 * 1024);
+//   SetAllocationProfiler(&profiler);
+//   ... run the workload ...
+//   SetAllocationProfiler(NULL);
+//   cerr << profiler.Report();
+
+#ifndef GOOGLE_PROTOBUF_ALLOCATION_PROFILER_H__
+#define GOOGLE_PROTOBUF_ALLOCATION_PROFILER_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class AllocationProfiler;
+
+namespace internal {
+  class AllocationContext;
+
+  // Called by SampleAllocation() when a profiler is installed.
+  LIBPROTOBUF_EXPORT void SampleAllocationSlow(int source, int bytes,
+                                               const char* type_name,
+                                               const char* field_name);
+}
+
+// Aggregates sampled allocations by message type, field and source.  All
+// methods are thread-safe.
+class LIBPROTOBUF_EXPORT AllocationProfiler {
+ public:
+  // What was allocated.
+  enum Source {
+    STRING,            // A string field's value.
+    SUB_MESSAGE,       // An embedded message.
+    REPEATED_ELEMENT,  // A new element of a repeated string or message field.
+    REPEATED_ARRAY,    // The pointer array of a repeated field, as it grows.
+    UNKNOWN_FIELD,     // The value of a length-delimited unknown field.
+
+    NUM_SOURCES
+  };
+
+  // Estimated totals for one allocation site.
+  struct Site {
+    // Full name of the message type, e.g. "foo.bar.Baz", and the field's
+    // name.  Either may be empty if the allocation could not be attributed.
+    string type_name;
+    string field_name;
+    Source source;
+
+    int64 samples;
+    int64 allocations;
+    int64 bytes;
+  };
+
+  // One sample is taken per sample_interval_bytes allocated, on average.
+  // 1 (or less) samples every allocation, which makes the counts exact.
+  explicit AllocationProfiler(int64 sample_interval_bytes);
+  ~AllocationProfiler();
+
+  int64 sample_interval_bytes() const { return sample_interval_bytes_; }
+
+  // Appends every site with at least one sample to *sites, with the most
+  // bytes first.
+  void GetSites(vector<Site>* sites) const;
+
+  // Returns a table of the sites, with the most bytes first.
+  string Report() const;
+
+  // Forgets everything recorded.
+  void Reset();
+
+  // Returns the name of the source as used in reports, e.g. "string".
+  static const char* SourceName(Source source);
+
+ private:
+  friend void internal::SampleAllocationSlow(int source, int bytes,
+                                             const char* type_name,
+                                             const char* field_name);
+  struct Table;
+
+  void Record(Source source, const char* type_name, const char* field_name,
+              double allocations, double bytes);
+
+  const int64 sample_interval_bytes_;
+  mutable internal::Mutex mutex_;
+  Table* table_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AllocationProfiler);
+};
+
+// Installs the profiler which receives all samples, replacing the current
+// one, which is returned.  NULL turns profiling off.  The profiler is not
+// owned, and must stay alive until allocations which started while it was
+// installed have finished.  Like SetLogHandler(), this is not meant to be
+// called concurrently with itself.
+LIBPROTOBUF_EXPORT AllocationProfiler* SetAllocationProfiler(
+    AllocationProfiler* profiler);
+
+namespace internal {
+
+// The installed profiler.  Use SetAllocationProfiler() to change it.
+LIBPROTOBUF_EXPORT extern AllocationProfiler* allocation_profiler;
+
+// Reports an allocation of the given number of bytes, made for the given
+// field.  Used by generated code; not for general use.
+inline void SampleFieldAllocation(AllocationProfiler::Source source,
+                                  int bytes, const char* type_name,
+                                  const char* field_name) {
+  if (allocation_profiler != NULL) {
+    SampleAllocationSlow(source, bytes, type_name, field_name);
+  }
+}
+
+// Reports an allocation made for whatever field the innermost
+// AllocationContext on this thread names.
+inline void SampleAllocation(AllocationProfiler::Source source, int bytes) {
+  if (allocation_profiler != NULL) {
+    SampleAllocationSlow(source, bytes, NULL, NULL);
+  }
+}
+
+// Attributes the allocations made by library code while it is in scope,
+// on the same thread, to the given message type and field.  field_name may
+// be NULL while working on a whole message, e.g. parsing it.  Both must
+// outlive the scope.  Used by generated code; not for general use.
+class LIBPROTOBUF_EXPORT AllocationContext {
+ public:
+  inline AllocationContext(const char* type_name, const char* field_name)
+      : thread_(NULL) {
+    if (allocation_profiler != NULL) Enter(type_name, field_name);
+  }
+
+  inline ~AllocationContext() {
+    if (thread_ != NULL) Leave();
+  }
+
+ private:
+  void Enter(const char* type_name, const char* field_name);
+  void Leave();
+
+  // The per-thread state whose context this scope replaced, or NULL if it
+  // replaced nothing.
+  void* thread_;
+  const char* saved_type_name_;
+  const char* saved_field_name_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(AllocationContext);
+};
+
+}  // namespace internal
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_ALLOCATION_PROFILER_H__
@@ -0,0 +1,234 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/allocation_profiler.h>
+
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/unittest_profile.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+using protobuf_unittest::TestProfileInner;
+using protobuf_unittest::TestProfileOuter;
+
+const char kInner[] = "protobuf_unittest.TestProfileInner";
+const char kOuter[] = "protobuf_unittest.TestProfileOuter";
+
+class AllocationProfilerTest : public testing::Test {
+ protected:
+  // Sampling every allocation makes the counts exact.
+  AllocationProfilerTest() : profiler_(1) {}
+
+  virtual void SetUp() {
+    EXPECT_TRUE(SetAllocationProfiler(&profiler_) == NULL);
+  }
+
+  virtual void TearDown() {
+    EXPECT_TRUE(SetAllocationProfiler(NULL) == &profiler_);
+  }
+
+  // Returns the totals recorded for one site, or zeros.
+  AllocationProfiler::Site GetSite(const string& type_name,
+                                   const string& field_name,
+                                   AllocationProfiler::Source source) {
+    vector<AllocationProfiler::Site> sites;
+    profiler_.GetSites(&sites);
+    for (int i = 0; i < sites.size(); i++) {
+      if (sites[i].type_name == type_name &&
+          sites[i].field_name == field_name &&
+          sites[i].source == source) {
+        return sites[i];
+      }
+    }
+    AllocationProfiler::Site none;
+    none.source = source;
+    none.samples = 0;
+    none.allocations = 0;
+    none.bytes = 0;
+    return none;
+  }
+
+  int64 Allocations(const string& type_name, const string& field_name,
+                    AllocationProfiler::Source source) {
+    return GetSite(type_name, field_name, source).allocations;
+  }
+
+  AllocationProfiler profiler_;
+};
+
+TEST_F(AllocationProfilerTest, StringFields) {
+  TestProfileInner message;
+  message.set_name("foo");
+  message.set_name("bar");  // Reuses the string.
+  EXPECT_EQ(1, Allocations(kInner, "name", AllocationProfiler::STRING));
+  EXPECT_EQ(sizeof(string),
+            GetSite(kInner, "name", AllocationProfiler::STRING).bytes);
+
+  // A field with a default value copies it into the new string.
+  message.mutable_data()->append("def");
+  EXPECT_EQ(1, Allocations(kInner, "data", AllocationProfiler::STRING));
+  EXPECT_EQ("abcdef", message.data());
+}
+
+TEST_F(AllocationProfilerTest, SubMessages) {
+  TestProfileOuter message;
+  message.mutable_inner()->set_value(1);
+  message.mutable_inner()->set_value(2);
+  EXPECT_EQ(1, Allocations(kOuter, "inner", AllocationProfiler::SUB_MESSAGE));
+  EXPECT_EQ(sizeof(TestProfileInner),
+            GetSite(kOuter, "inner", AllocationProfiler::SUB_MESSAGE).bytes);
+}
+
+TEST_F(AllocationProfilerTest, RepeatedFields) {
+  TestProfileOuter message;
+  for (int i = 0; i < 5; i++) {
+    message.add_items()->add_tags("tag");
+  }
+  EXPECT_EQ(5, Allocations(kOuter, "items",
+                           AllocationProfiler::REPEATED_ELEMENT));
+  EXPECT_EQ(5, Allocations(kInner, "tags",
+                           AllocationProfiler::REPEATED_ELEMENT));
+
+  // The fifth element outgrew the initial space.
+  EXPECT_EQ(1, Allocations(kOuter, "items",
+                           AllocationProfiler::REPEATED_ARRAY));
+
+  // Cleared elements are reused, not allocated again.
+  message.Clear();
+  message.add_items();
+  EXPECT_EQ(5, Allocations(kOuter, "items",
+                           AllocationProfiler::REPEATED_ELEMENT));
+}
+
+TEST_F(AllocationProfilerTest, Parsing) {
+  TestProfileOuter message;
+  message.mutable_inner()->set_name("inner");
+  message.add_items()->add_tags("tag");
+  message.add_items()->set_data("data");
+  string data = message.SerializeAsString();
+
+  // Merges an unknown length-delimited field 15 into the embedded message.
+  data += "\x12\x05\x7a\x03" "abc";
+
+  profiler_.Reset();
+  TestProfileOuter parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+
+  EXPECT_EQ(1, Allocations(kOuter, "inner", AllocationProfiler::SUB_MESSAGE));
+  EXPECT_EQ(2, Allocations(kOuter, "items",
+                           AllocationProfiler::REPEATED_ELEMENT));
+  EXPECT_EQ(1, Allocations(kInner, "name", AllocationProfiler::STRING));
+  EXPECT_EQ(1, Allocations(kInner, "tags",
+                           AllocationProfiler::REPEATED_ELEMENT));
+  EXPECT_EQ(1, Allocations(kInner, "data", AllocationProfiler::STRING));
+
+  // Unknown fields are attributed to the message being parsed.
+  EXPECT_EQ(1, Allocations(kInner, "", AllocationProfiler::UNKNOWN_FIELD));
+  EXPECT_EQ(1, parsed.inner().unknown_fields().field_count());
+}
+
+TEST_F(AllocationProfilerTest, Unattributed) {
+  RepeatedPtrField<string> field;
+  field.Add();
+  EXPECT_EQ(1, Allocations("", "", AllocationProfiler::REPEATED_ELEMENT));
+
+  {
+    internal::AllocationContext outer(kOuter, "items");
+    {
+      internal::AllocationContext inner(kInner, NULL);
+      field.Add();
+    }
+    field.Add();
+  }
+  field.Add();
+  EXPECT_EQ(1, Allocations(kInner, "", AllocationProfiler::REPEATED_ELEMENT));
+  EXPECT_EQ(1, Allocations(kOuter, "items",
+                           AllocationProfiler::REPEATED_ELEMENT));
+  EXPECT_EQ(2, Allocations("", "", AllocationProfiler::REPEATED_ELEMENT));
+}
+
+TEST_F(AllocationProfilerTest, NotInstalled) {
+  EXPECT_TRUE(SetAllocationProfiler(NULL) == &profiler_);
+  TestProfileOuter message;
+  message.mutable_inner()->set_name("inner");
+  message.add_items();
+  EXPECT_TRUE(SetAllocationProfiler(&profiler_) == NULL);
+
+  vector<AllocationProfiler::Site> sites;
+  profiler_.GetSites(&sites);
+  EXPECT_EQ(0, sites.size());
+}
+
+TEST_F(AllocationProfilerTest, SamplingEstimatesTotals) {
+  AllocationProfiler sampler(1024);
+  EXPECT_TRUE(SetAllocationProfiler(&sampler) == &profiler_);
+
+  const int kMessages = 50000;
+  for (int i = 0; i < kMessages; i++) {
+    TestProfileInner message;
+    message.set_name("name");
+  }
+  EXPECT_TRUE(SetAllocationProfiler(&profiler_) == &sampler);
+
+  vector<AllocationProfiler::Site> sites;
+  sampler.GetSites(&sites);
+  ASSERT_EQ(1, sites.size());
+  EXPECT_EQ(kInner, sites[0].type_name);
+  EXPECT_EQ("name", sites[0].field_name);
+  EXPECT_LT(sites[0].samples, kMessages / 2);
+  EXPECT_NEAR(kMessages, sites[0].allocations, kMessages * 0.15);
+  EXPECT_NEAR(kMessages * sizeof(string), sites[0].bytes,
+              kMessages * sizeof(string) * 0.15);
+}
+
+TEST_F(AllocationProfilerTest, Report) {
+  TestProfileOuter message;
+  message.mutable_inner()->set_name("inner");
+  string report = profiler_.Report();
+  EXPECT_TRUE(report.find("sub_message") != string::npos) << report;
+  EXPECT_TRUE(report.find("protobuf_unittest.TestProfileOuter.inner") !=
+              string::npos) << report;
+  EXPECT_TRUE(report.find("protobuf_unittest.TestProfileInner.name") !=
+              string::npos) << report;
+
+  profiler_.Reset();
+  vector<AllocationProfiler::Site> sites;
+  profiler_.GetSites(&sites);
+  EXPECT_EQ(0, sites.size());
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
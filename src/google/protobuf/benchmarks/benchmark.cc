@@ -0,0 +1,718 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Times the common operations on the messages in benchmark_messages.proto,
+// for each of the SPEED, CODE_SIZE and LITE_RUNTIME versions of the generated
+// code and for DynamicMessage.  Usage:
+//   protobuf-benchmark [min_seconds [filter]]
+// Each operation is repeated for at least min_seconds (default 0.1).  If a
+// filter is given, only the benchmarks whose "kind/shape/op" name contains
+// it are run.  Each result is printed on one line of "name=value" pairs, so
+// that the output can be collected and compared between runs.
+//
+// The operations are:
+//   parse         ParseFromString() into a newly allocated message.
+//   clear_reuse   ParseFromString() into the same message every time, so
+//                 that the memory from the previous parse is reused.
+//   serialize     SerializeToString() into the same string every time.
+//   byte_size     ByteSize().
+//   copy          CopyFrom() into the same message every time.
+//   merge         Clear(), then MergeFrom() the sample twice.
+//   batch_separate  Reads a buffer of length-delimited copies of the sample,
+//                 calling ParseFromArray() once per message, into messages
+//                 which are reused from one buffer to the next.
+//   batch_parse   Reads the same buffer with a MessageBatch.
+//   text_print    TextFormat::PrintToString().
+//   text_parse    TextFormat::ParseFromString().
+//   reflection_read   Reads every field through Reflection.
+//   reflection_write  Clear(), then sets every field through Reflection.
+// The batch operations report the time per message, not per buffer.  The
+// last four need descriptors, so LITE_RUNTIME messages skip them.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/benchmarks/benchmark_messages.pb.h>
+#include <google/protobuf/benchmarks/benchmark_messages_code_size.pb.h>
+#include <google/protobuf/benchmarks/benchmark_messages_lite.pb.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/message_batch.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// Results that are otherwise unused are added here, so that the compiler
+// cannot optimize away the work that produced them.
+volatile uint64 sink = 0;
+
+// One operation on one message, repeated a given number of times.
+class Operation {
+ public:
+  virtual ~Operation() {}
+  virtual void Run(int iterations) = 0;
+};
+
+// Times each Operation and prints the results.
+class Runner {
+ public:
+  Runner(double min_seconds, const string& filter)
+    : min_seconds_(min_seconds), filter_(filter) {}
+
+  // Runs "operation" and deletes it.  "bytes" is the size of the serialized
+  // message it works on.
+  void Run(const char* kind, const char* shape, const char* op, int bytes,
+           Operation* operation) {
+    scoped_ptr<Operation> deleter(operation);
+    string name = string(kind) + "/" + shape + "/" + op;
+    if (name.find(filter_) == string::npos) return;
+
+    // Warm up, then keep increasing the iteration count until the
+    // operation runs for long enough to be timed.
+    operation->Run(1);
+    int iterations = 1;
+    double elapsed;
+    while (true) {
+      double start = Now();
+      operation->Run(iterations);
+      elapsed = Now() - start;
+      if (elapsed >= min_seconds_ || iterations >= kMaxIterations) break;
+
+      // Aim a little past the minimum so that the next round is usually
+      // the last.
+      double scale = elapsed > 0 ? min_seconds_ * 1.2 / elapsed : 100;
+      if (scale < 2) scale = 2;
+      if (scale > 100) scale = 100;
+      iterations = static_cast<int>(
+          min(static_cast<double>(kMaxIterations), iterations * scale));
+    }
+
+    double seconds_per_op = elapsed / iterations;
+    printf("kind=%s shape=%s op=%s bytes=%d iterations=%d ns_per_op=%.1f "
+           "mb_per_s=%.2f\n",
+           kind, shape, op, bytes, iterations, seconds_per_op * 1e9,
+           bytes / seconds_per_op / (1024 * 1024));
+    fflush(stdout);
+  }
+
+ private:
+  static const int kMaxIterations = 1 << 30;
+
+  double min_seconds_;
+  string filter_;
+};
+
+// ===================================================================
+// Filling in the samples.  The generated classes for the three
+// optimize_for modes have the same accessors, so each of these works for
+// all of them.
+
+template <typename Small>
+void FillSmall(int seed, Small* message) {
+  message->set_id(GOOGLE_LONGLONG(1000000007) * seed);
+  message->set_name("request-" + SimpleItoa(seed));
+  message->set_kind(Small::UPDATE);
+  message->set_urgent(seed % 2 == 0);
+  message->set_deadline_ms(250);
+}
+
+template <typename Wide>
+void FillWide(Wide* message) {
+  message->set_int32_1(1);
+  message->set_int32_2(-1);
+  message->set_int32_3(300);
+  message->set_int32_4(1 << 24);
+  message->set_int64_1(GOOGLE_LONGLONG(1234567890123));
+  message->set_int64_2(-5);
+  message->set_int64_3(7);
+  message->set_int64_4(GOOGLE_LONGLONG(1) << 50);
+  message->set_uint32_1(42);
+  message->set_uint32_2(4000000000U);
+  message->set_uint64_1(99);
+  message->set_uint64_2(GOOGLE_ULONGLONG(1) << 63);
+  message->set_sint32_1(-100);
+  message->set_sint32_2(100);
+  message->set_sint64_1(-(GOOGLE_LONGLONG(1) << 40));
+  message->set_sint64_2(3);
+  message->set_fixed32_1(0xdeadbeef);
+  message->set_fixed64_1(GOOGLE_ULONGLONG(0x0123456789abcdef));
+  message->set_sfixed32_1(-12345);
+  message->set_sfixed64_1(GOOGLE_LONGLONG(-1234567890));
+  message->set_float_1(1.5f);
+  message->set_float_2(-0.25f);
+  message->set_double_1(3.14159265358979);
+  message->set_double_2(2.5e-8);
+  message->set_double_3(-1e100);
+  message->set_bool_1(true);
+  message->set_bool_2(false);
+  message->set_bool_3(true);
+  message->set_string_1("frontend-7.example.com");
+  message->set_string_2("GET /index.html HTTP/1.1");
+  message->set_string_3("Mozilla/5.0 (X11; Linux x86_64)");
+  message->set_bytes_1(string("\x01\x02\x03\x00\xff\xfe", 6));
+  message->set_priority_1(Wide::HIGH);
+  message->set_priority_2(Wide::LOW);
+  FillSmall(1, message->mutable_small_1());
+  FillSmall(2, message->mutable_small_2());
+  for (int i = 0; i < 8; i++) {
+    message->add_repeated_int32(i * i * 1000);
+    message->add_repeated_string("value-" + SimpleItoa(i));
+  }
+  for (int i = 0; i < 4; i++) {
+    FillSmall(10 + i, message->add_repeated_small());
+  }
+  message->set_int32_5(5);
+}
+
+template <typename Deep>
+void FillDeep(Deep* message) {
+  for (int i = 0; i < 32; i++) {
+    message->set_value(i);
+    message->set_label("node-" + SimpleItoa(i));
+    message->mutable_right()->set_value(-i);
+    message = message->mutable_left();
+  }
+  message->set_value(-1);
+}
+
+template <typename StringHeavy>
+void FillStringHeavy(StringHeavy* message) {
+  message->set_title("On the Benchmarking of Serialization Libraries");
+  message->set_author("A. N. Author");
+
+  string body;
+  for (int i = 0; body.size() < 4096; i++) {
+    body += "Sentence number " + SimpleItoa(i) +
+            " of the body, which is long enough to be realistic. ";
+  }
+  message->set_body(body);
+
+  for (int i = 0; i < 20; i++) {
+    message->add_tags("tag-" + string(i % 12 + 1, 'a' + i % 26));
+  }
+
+  string chunk;
+  for (int i = 0; i < 256; i++) {
+    chunk.push_back(static_cast<char>(i * 7));
+  }
+  for (int i = 0; i < 8; i++) {
+    message->add_chunks(chunk);
+  }
+  message->set_checksum(chunk.substr(0, 32));
+}
+
+template <typename Packed>
+void FillPacked(Packed* message) {
+  uint32 random = 1;
+  for (int i = 0; i < 1024; i++) {
+    random = random * 1103515245 + 12345;
+    // Mostly small values, with the occasional large or negative one.
+    int32 value = static_cast<int32>(random >> 20);
+    if (i % 16 == 0) value = -value;
+    if (i % 7 != 0) value %= 128;
+    message->add_int32_values(value);
+    message->add_sint64_values(static_cast<int64>(value) * (i - 512));
+  }
+  for (int i = 0; i < 256; i++) {
+    message->add_fixed32_values(i * 2654435761U);
+    message->add_float_values(i * 0.5f);
+    message->add_double_values(i / 3.0);
+  }
+  for (int i = 0; i < 128; i++) {
+    message->add_bool_values(i % 3 == 0);
+  }
+}
+
+// ===================================================================
+// Operations which every message supports.  MessageType is either a
+// generated class or Message, which is how DynamicMessages are used.
+
+enum GenericOp {
+  PARSE,
+  CLEAR_REUSE,
+  SERIALIZE,
+  BYTE_SIZE,
+  COPY,
+  MERGE
+};
+
+template <typename MessageType>
+class GenericOperation : public Operation {
+ public:
+  GenericOperation(GenericOp op, const MessageType& sample)
+    : op_(op), sample_(sample), reused_(sample.New()) {
+    sample.SerializeToString(&data_);
+  }
+
+  void Run(int iterations) {
+    switch (op_) {
+      case PARSE:
+        for (int i = 0; i < iterations; i++) {
+          scoped_ptr<MessageType> message(sample_.New());
+          GOOGLE_CHECK(message->ParseFromString(data_));
+        }
+        break;
+      case CLEAR_REUSE:
+        for (int i = 0; i < iterations; i++) {
+          GOOGLE_CHECK(reused_->ParseFromString(data_));
+        }
+        break;
+      case SERIALIZE:
+        for (int i = 0; i < iterations; i++) {
+          sample_.SerializeToString(&output_);
+        }
+        break;
+      case BYTE_SIZE: {
+        int total = 0;
+        for (int i = 0; i < iterations; i++) {
+          total += sample_.ByteSize();
+        }
+        sink += total;
+        break;
+      }
+      case COPY:
+        for (int i = 0; i < iterations; i++) {
+          reused_->CopyFrom(sample_);
+        }
+        break;
+      case MERGE:
+        for (int i = 0; i < iterations; i++) {
+          reused_->Clear();
+          reused_->MergeFrom(sample_);
+          reused_->MergeFrom(sample_);
+        }
+        break;
+    }
+  }
+
+ private:
+  GenericOp op_;
+  const MessageType& sample_;
+  scoped_ptr<MessageType> reused_;
+  string data_;
+  string output_;
+};
+
+// ===================================================================
+// Parsing a buffer of length-delimited messages.  Each iteration parses one
+// message; the buffer holds kBatchSize of them, and the last buffer of a
+// run is cut short to make up the number of iterations.
+
+enum BatchOp {
+  BATCH_SEPARATE,
+  BATCH_PARSE
+};
+
+template <typename MessageType>
+class BatchOperation : public Operation {
+ public:
+  BatchOperation(BatchOp op, const MessageType& sample)
+    : op_(op), batch_(sample) {
+    {
+      io::StringOutputStream string_output(&data_);
+      io::CodedOutputStream coded_output(&string_output);
+      for (int i = 0; i < kBatchSize; i++) {
+        ends_.push_back(coded_output.ByteCount());
+        coded_output.WriteVarint32(sample.ByteSize());
+        sample.SerializeWithCachedSizes(&coded_output);
+      }
+      ends_.push_back(coded_output.ByteCount());
+    }
+    ends_.erase(ends_.begin());
+    for (int i = 0; i < kBatchSize; i++) {
+      separate_.push_back(sample.New());
+    }
+  }
+
+  ~BatchOperation() {
+    STLDeleteElements(&separate_);
+  }
+
+  void Run(int iterations) {
+    while (iterations > 0) {
+      int count = min(iterations, kBatchSize);
+      iterations -= count;
+      int size = ends_[count - 1];
+      switch (op_) {
+        case BATCH_SEPARATE: {
+          const uint8* data = reinterpret_cast<const uint8*>(data_.data());
+          io::CodedInputStream input(data, size);
+          for (int i = 0; i < count; i++) {
+            uint32 length;
+            GOOGLE_CHECK(input.ReadVarint32(&length));
+            const uint8* message = data + input.CurrentPosition();
+            GOOGLE_CHECK(separate_[i]->ParseFromArray(message, length));
+            GOOGLE_CHECK(input.Skip(length));
+          }
+          break;
+        }
+        case BATCH_PARSE:
+          GOOGLE_CHECK(batch_.ParseDelimitedFromArray(data_.data(), size));
+          break;
+      }
+    }
+  }
+
+ private:
+  static const int kBatchSize = 1000;
+
+  BatchOp op_;
+  string data_;
+  vector<int> ends_;  // ends_[i] is where message i ends in data_.
+  vector<MessageType*> separate_;
+  MessageBatch batch_;
+};
+
+#ifndef _MSC_VER  // min() takes kBatchSize by reference.
+template <typename MessageType>
+const int BatchOperation<MessageType>::kBatchSize;
+#endif  // !_MSC_VER
+
+// ===================================================================
+// Operations which need descriptors.
+
+// Reads every field of "message" through Reflection, the way generic code
+// such as a logger or a converter to some other format would.  Returns a
+// value derived from all of them.
+uint64 ReadAllFields(const Message& message) {
+  const Reflection* reflection = message.GetReflection();
+  vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+
+  uint64 result = 0;
+  string scratch;
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    int count = field->is_repeated() ? reflection->FieldSize(message, field)
+                                     : 1;
+    for (int j = 0; j < count; j++) {
+#define READ_FIELD(GETTER)                                            \
+      (field->is_repeated() ?                                         \
+         reflection->GetRepeated##GETTER(message, field, j) :         \
+         reflection->Get##GETTER(message, field))
+      switch (field->cpp_type()) {
+        case FieldDescriptor::CPPTYPE_INT32:
+          result += READ_FIELD(Int32);
+          break;
+        case FieldDescriptor::CPPTYPE_INT64:
+          result += READ_FIELD(Int64);
+          break;
+        case FieldDescriptor::CPPTYPE_UINT32:
+          result += READ_FIELD(UInt32);
+          break;
+        case FieldDescriptor::CPPTYPE_UINT64:
+          result += READ_FIELD(UInt64);
+          break;
+        case FieldDescriptor::CPPTYPE_FLOAT:
+          result += static_cast<uint64>(READ_FIELD(Float));
+          break;
+        case FieldDescriptor::CPPTYPE_DOUBLE:
+          result += static_cast<uint64>(READ_FIELD(Double));
+          break;
+        case FieldDescriptor::CPPTYPE_BOOL:
+          result += READ_FIELD(Bool);
+          break;
+        case FieldDescriptor::CPPTYPE_ENUM:
+          result += READ_FIELD(Enum)->number();
+          break;
+        case FieldDescriptor::CPPTYPE_STRING:
+          result += (field->is_repeated() ?
+            reflection->GetRepeatedStringReference(message, field, j,
+                                                   &scratch) :
+            reflection->GetStringReference(message, field, &scratch)).size();
+          break;
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          result += ReadAllFields(READ_FIELD(Message));
+          break;
+      }
+#undef READ_FIELD
+    }
+  }
+  return result;
+}
+
+// Sets every field of "to" which is set in "from", through Reflection.
+void WriteAllFields(const Message& from, Message* to) {
+  const Reflection* from_reflection = from.GetReflection();
+  const Reflection* to_reflection = to->GetReflection();
+  vector<const FieldDescriptor*> fields;
+  from_reflection->ListFields(from, &fields);
+
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->is_repeated()) {
+      int count = from_reflection->FieldSize(from, field);
+      for (int j = 0; j < count; j++) {
+        switch (field->cpp_type()) {
+#define COPY_REPEATED(CPPTYPE, METHOD)                                   \
+          case FieldDescriptor::CPPTYPE_##CPPTYPE:                       \
+            to_reflection->Add##METHOD(to, field,                        \
+              from_reflection->GetRepeated##METHOD(from, field, j));     \
+            break;
+          COPY_REPEATED(INT32 , Int32 )
+          COPY_REPEATED(INT64 , Int64 )
+          COPY_REPEATED(UINT32, UInt32)
+          COPY_REPEATED(UINT64, UInt64)
+          COPY_REPEATED(FLOAT , Float )
+          COPY_REPEATED(DOUBLE, Double)
+          COPY_REPEATED(BOOL  , Bool  )
+          COPY_REPEATED(ENUM  , Enum  )
+          COPY_REPEATED(STRING, String)
+#undef COPY_REPEATED
+          case FieldDescriptor::CPPTYPE_MESSAGE:
+            WriteAllFields(from_reflection->GetRepeatedMessage(from, field, j),
+                           to_reflection->AddMessage(to, field));
+            break;
+        }
+      }
+    } else {
+      switch (field->cpp_type()) {
+#define COPY_SINGULAR(CPPTYPE, METHOD)                                   \
+        case FieldDescriptor::CPPTYPE_##CPPTYPE:                         \
+          to_reflection->Set##METHOD(to, field,                          \
+            from_reflection->Get##METHOD(from, field));                  \
+          break;
+        COPY_SINGULAR(INT32 , Int32 )
+        COPY_SINGULAR(INT64 , Int64 )
+        COPY_SINGULAR(UINT32, UInt32)
+        COPY_SINGULAR(UINT64, UInt64)
+        COPY_SINGULAR(FLOAT , Float )
+        COPY_SINGULAR(DOUBLE, Double)
+        COPY_SINGULAR(BOOL  , Bool  )
+        COPY_SINGULAR(ENUM  , Enum  )
+        COPY_SINGULAR(STRING, String)
+#undef COPY_SINGULAR
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          WriteAllFields(from_reflection->GetMessage(from, field),
+                         to_reflection->MutableMessage(to, field));
+          break;
+      }
+    }
+  }
+}
+
+enum ReflectiveOp {
+  TEXT_PRINT,
+  TEXT_PARSE,
+  REFLECTION_READ,
+  REFLECTION_WRITE
+};
+
+class ReflectiveOperation : public Operation {
+ public:
+  ReflectiveOperation(ReflectiveOp op, const Message& sample)
+    : op_(op), sample_(sample), reused_(sample.New()) {
+    GOOGLE_CHECK(TextFormat::PrintToString(sample, &text_));
+  }
+
+  void Run(int iterations) {
+    switch (op_) {
+      case TEXT_PRINT:
+        for (int i = 0; i < iterations; i++) {
+          GOOGLE_CHECK(TextFormat::PrintToString(sample_, &output_));
+        }
+        break;
+      case TEXT_PARSE:
+        for (int i = 0; i < iterations; i++) {
+          GOOGLE_CHECK(TextFormat::ParseFromString(text_, reused_.get()));
+        }
+        break;
+      case REFLECTION_READ: {
+        uint64 total = 0;
+        for (int i = 0; i < iterations; i++) {
+          total += ReadAllFields(sample_);
+        }
+        sink += total;
+        break;
+      }
+      case REFLECTION_WRITE:
+        for (int i = 0; i < iterations; i++) {
+          reused_->Clear();
+          WriteAllFields(sample_, reused_.get());
+        }
+        break;
+    }
+  }
+
+ private:
+  ReflectiveOp op_;
+  const Message& sample_;
+  scoped_ptr<Message> reused_;
+  string text_;
+  string output_;
+};
+
+// ===================================================================
+
+// LITE_RUNTIME messages have no descriptors, so this overload does nothing
+// for them.
+void BenchmarkReflection(const char* kind, const char* shape, int bytes,
+                         const MessageLite& sample, Runner* runner) {}
+
+void BenchmarkReflection(const char* kind, const char* shape, int bytes,
+                         const Message& sample, Runner* runner) {
+  runner->Run(kind, shape, "text_print", bytes,
+              new ReflectiveOperation(TEXT_PRINT, sample));
+  runner->Run(kind, shape, "text_parse", bytes,
+              new ReflectiveOperation(TEXT_PARSE, sample));
+  runner->Run(kind, shape, "reflection_read", bytes,
+              new ReflectiveOperation(REFLECTION_READ, sample));
+  runner->Run(kind, shape, "reflection_write", bytes,
+              new ReflectiveOperation(REFLECTION_WRITE, sample));
+}
+
+template <typename MessageType>
+void BenchmarkMessage(const char* kind, const char* shape,
+                      const MessageType& sample, Runner* runner) {
+  int bytes = sample.ByteSize();
+  runner->Run(kind, shape, "parse", bytes,
+              new GenericOperation<MessageType>(PARSE, sample));
+  runner->Run(kind, shape, "clear_reuse", bytes,
+              new GenericOperation<MessageType>(CLEAR_REUSE, sample));
+  runner->Run(kind, shape, "serialize", bytes,
+              new GenericOperation<MessageType>(SERIALIZE, sample));
+  runner->Run(kind, shape, "byte_size", bytes,
+              new GenericOperation<MessageType>(BYTE_SIZE, sample));
+  runner->Run(kind, shape, "copy", bytes,
+              new GenericOperation<MessageType>(COPY, sample));
+  runner->Run(kind, shape, "merge", bytes,
+              new GenericOperation<MessageType>(MERGE, sample));
+  runner->Run(kind, shape, "batch_separate", bytes,
+              new BatchOperation<MessageType>(BATCH_SEPARATE, sample));
+  runner->Run(kind, shape, "batch_parse", bytes,
+              new BatchOperation<MessageType>(BATCH_PARSE, sample));
+  BenchmarkReflection(kind, shape, bytes, sample, runner);
+}
+
+// Benchmarks one set of generated classes.
+template <typename Small, typename Wide, typename Deep,
+          typename StringHeavy, typename Packed>
+void BenchmarkGenerated(const char* kind, Runner* runner) {
+  Small small;
+  FillSmall(1, &small);
+  BenchmarkMessage(kind, "small", small, runner);
+
+  Wide wide;
+  FillWide(&wide);
+  BenchmarkMessage(kind, "wide", wide, runner);
+
+  Deep deep;
+  FillDeep(&deep);
+  BenchmarkMessage(kind, "deep", deep, runner);
+
+  StringHeavy string_heavy;
+  FillStringHeavy(&string_heavy);
+  BenchmarkMessage(kind, "string_heavy", string_heavy, runner);
+
+  Packed packed;
+  FillPacked(&packed);
+  BenchmarkMessage(kind, "packed", packed, runner);
+}
+
+// Benchmarks a DynamicMessage holding the same data as "sample".
+void BenchmarkDynamic(const char* shape, const Message& sample,
+                      DynamicMessageFactory* factory, Runner* runner) {
+  scoped_ptr<Message> dynamic(
+      factory->GetPrototype(sample.GetDescriptor())->New());
+  GOOGLE_CHECK(dynamic->ParseFromString(sample.SerializeAsString()));
+  BenchmarkMessage<Message>("dynamic", shape, *dynamic, runner);
+}
+
+int Main(int argc, char* argv[]) {
+  double min_seconds = argc > 1 ? strtod(argv[1], NULL) : 0.1;
+  if (min_seconds <= 0 || argc > 3) {
+    fprintf(stderr, "Usage: %s [min_seconds [filter]]\n", argv[0]);
+    return 1;
+  }
+  Runner runner(min_seconds, argc > 2 ? argv[2] : "");
+
+  BenchmarkGenerated<protobuf_benchmark::Small,
+                     protobuf_benchmark::Wide,
+                     protobuf_benchmark::Deep,
+                     protobuf_benchmark::StringHeavy,
+                     protobuf_benchmark::Packed>("speed", &runner);
+  BenchmarkGenerated<protobuf_benchmark::code_size::Small,
+                     protobuf_benchmark::code_size::Wide,
+                     protobuf_benchmark::code_size::Deep,
+                     protobuf_benchmark::code_size::StringHeavy,
+                     protobuf_benchmark::code_size::Packed>("code_size",
+                                                            &runner);
+  BenchmarkGenerated<protobuf_benchmark::lite::Small,
+                     protobuf_benchmark::lite::Wide,
+                     protobuf_benchmark::lite::Deep,
+                     protobuf_benchmark::lite::StringHeavy,
+                     protobuf_benchmark::lite::Packed>("lite", &runner);
+
+  // The DynamicMessages use the descriptors of the SPEED classes, but none
+  // of their generated code.
+  DynamicMessageFactory factory;
+  protobuf_benchmark::Small small;
+  FillSmall(1, &small);
+  BenchmarkDynamic("small", small, &factory, &runner);
+  protobuf_benchmark::Wide wide;
+  FillWide(&wide);
+  BenchmarkDynamic("wide", wide, &factory, &runner);
+  protobuf_benchmark::Deep deep;
+  FillDeep(&deep);
+  BenchmarkDynamic("deep", deep, &factory, &runner);
+  protobuf_benchmark::StringHeavy string_heavy;
+  FillStringHeavy(&string_heavy);
+  BenchmarkDynamic("string_heavy", string_heavy, &factory, &runner);
+  protobuf_benchmark::Packed packed;
+  FillPacked(&packed);
+  BenchmarkDynamic("packed", packed, &factory, &runner);
+
+  return 0;
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  return google::protobuf::Main(argc, argv);
+}
@@ -0,0 +1,1032 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/columnar.h>
+
+#include <algorithm>
+#include <map>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+using internal::WireFormatLite;
+using io::CodedInputStream;
+using io::CodedOutputStream;
+
+namespace internal {
+
+// A field in the tree of fields of the record type.  Node 0 stands for the
+// record itself.
+struct SchemaNode {
+  const FieldDescriptor* field;  // NULL for the root.
+  string path;
+
+  // The number of repeated fields, and the number of optional or repeated
+  // fields, on the path to this field, including this one.
+  int repetition_level;
+  int definition_level;
+
+  // The columns under this node are numbered [first_column, end_column).
+  // A leaf has exactly one, and no children.
+  int first_column;
+  int end_column;
+  vector<int> children;
+
+  bool is_leaf() const { return field != NULL && children.empty(); }
+};
+
+class ColumnarSchema {
+ public:
+  explicit ColumnarSchema(const Descriptor* descriptor);
+
+  const Descriptor* descriptor() const { return descriptor_; }
+
+  const SchemaNode& node(int index) const { return nodes_[index]; }
+  int node_count() const { return nodes_.size(); }
+
+  int column_count() const { return column_nodes_.size(); }
+  const SchemaNode& column(int index) const {
+    return nodes_[column_nodes_[index]];
+  }
+
+  // Returns the index of the node with the given path, or -1.
+  int FindNode(const string& path) const {
+    map<string, int>::const_iterator iter = nodes_by_path_.find(path);
+    return iter == nodes_by_path_.end() ? -1 : iter->second;
+  }
+
+ private:
+  void AddChildren(int parent, const Descriptor* type,
+                   vector<const Descriptor*>* ancestors);
+
+  const Descriptor* descriptor_;
+  vector<SchemaNode> nodes_;
+  vector<int> column_nodes_;
+  map<string, int> nodes_by_path_;
+};
+
+ColumnarSchema::ColumnarSchema(const Descriptor* descriptor)
+  : descriptor_(descriptor) {
+  SchemaNode root;
+  root.field = NULL;
+  root.repetition_level = 0;
+  root.definition_level = 0;
+  root.first_column = 0;
+  nodes_.push_back(root);
+
+  vector<const Descriptor*> ancestors;
+  AddChildren(0, descriptor, &ancestors);
+  nodes_[0].end_column = column_nodes_.size();
+}
+
+void ColumnarSchema::AddChildren(int parent, const Descriptor* type,
+                                 vector<const Descriptor*>* ancestors) {
+  ancestors->push_back(type);
+  for (int i = 0; i < type->field_count(); i++) {
+    const FieldDescriptor* field = type->field(i);
+    const SchemaNode& parent_node = nodes_[parent];
+
+    SchemaNode node;
+    node.field = field;
+    node.path = parent == 0 ? field->name()
+                            : parent_node.path + "." + field->name();
+    node.repetition_level =
+        parent_node.repetition_level + (field->is_repeated() ? 1 : 0);
+    node.definition_level =
+        parent_node.definition_level + (field->is_required() ? 0 : 1);
+    node.first_column = column_nodes_.size();
+
+    int index = nodes_.size();
+    nodes_.push_back(node);
+    nodes_[parent].children.push_back(index);
+    nodes_by_path_[node.path] = index;
+
+    const Descriptor* message_type = field->message_type();
+    if (message_type != NULL && message_type->field_count() > 0 &&
+        find(ancestors->begin(), ancestors->end(), message_type) ==
+        ancestors->end()) {
+      AddChildren(index, message_type, ancestors);
+    } else {
+      column_nodes_.push_back(index);
+    }
+    nodes_[index].end_column = column_nodes_.size();
+  }
+  ancestors->pop_back();
+}
+
+// The entries of one column.  Numbers of every type are kept as 64-bit
+// patterns (see ToBits()); strings and whole messages as strings.
+struct ColumnData {
+  ColumnData() : next_entry(0), next_value(0) {}
+
+  vector<int> repetition_levels;
+  vector<int> definition_levels;
+  vector<uint64> numbers;
+  vector<string> strings;
+
+  // Where ColumnarReader::ReadRecord() is in the column.
+  int next_entry;
+  int next_value;
+};
+
+}  // namespace internal
+
+using internal::ColumnData;
+using internal::ColumnarSchema;
+using internal::SchemaNode;
+
+namespace {
+
+// How the values of a column are encoded.
+enum Encoding {
+  DELTA = 1,       // Varints of the ZigZag-encoded differences between
+                   // consecutive numbers, starting from zero.
+  RUN_LENGTH = 2,  // Pairs of (count, number) varints.
+  DICTIONARY = 3,  // The distinct values in order of first appearance,
+                   // then runs of their indices as (count, index) pairs.
+  PLAIN = 4        // Length-delimited strings.
+};
+
+bool IsStringColumn(const FieldDescriptor* field) {
+  return field->cpp_type() == FieldDescriptor::CPPTYPE_STRING ||
+         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE;
+}
+
+// Numbers are stored as the bit patterns of their 64-bit equivalents, with
+// signed numbers sign-extended.  This keeps small negative numbers small
+// after delta encoding.
+uint64 ToBits(const Message& message, const FieldDescriptor* field,
+              int index) {
+  const Reflection* reflection = message.GetReflection();
+  bool repeated = field->is_repeated();
+  switch (field->cpp_type()) {
+#define TO_BITS(CPPTYPE, METHOD, CONVERSION)                              \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                              \
+      return CONVERSION(repeated ?                                        \
+          reflection->GetRepeated##METHOD(message, field, index) :        \
+          reflection->Get##METHOD(message, field));
+    TO_BITS(INT32 , Int32 , static_cast<int64>)
+    TO_BITS(INT64 , Int64 , static_cast<int64>)
+    TO_BITS(UINT32, UInt32, static_cast<uint64>)
+    TO_BITS(UINT64, UInt64, static_cast<uint64>)
+    TO_BITS(FLOAT , Float , WireFormatLite::EncodeFloat)
+    TO_BITS(DOUBLE, Double, WireFormatLite::EncodeDouble)
+    TO_BITS(BOOL  , Bool  , static_cast<uint64>)
+#undef TO_BITS
+    case FieldDescriptor::CPPTYPE_ENUM:
+      return static_cast<int64>((repeated ?
+          reflection->GetRepeatedEnum(message, field, index) :
+          reflection->GetEnum(message, field))->number());
+    default:
+      GOOGLE_LOG(FATAL) << "Not a numeric field: " << field->full_name();
+      return 0;
+  }
+}
+
+int32  BitsToInt32 (uint64 bits) { return static_cast<int32>(bits); }
+int64  BitsToInt64 (uint64 bits) { return static_cast<int64>(bits); }
+uint32 BitsToUInt32(uint64 bits) { return static_cast<uint32>(bits); }
+uint64 BitsToUInt64(uint64 bits) { return bits; }
+bool   BitsToBool  (uint64 bits) { return bits != 0; }
+float  BitsToFloat (uint64 bits) {
+  return WireFormatLite::DecodeFloat(static_cast<uint32>(bits));
+}
+double BitsToDouble(uint64 bits) {
+  return WireFormatLite::DecodeDouble(bits);
+}
+
+// Sets or adds the value of a leaf field from its bit pattern.  Returns
+// false for an enum number which the type doesn't define.
+bool SetFromBits(Message* message, const FieldDescriptor* field,
+                 uint64 bits) {
+  const Reflection* reflection = message->GetReflection();
+  bool repeated = field->is_repeated();
+  switch (field->cpp_type()) {
+#define SET_FROM_BITS(CPPTYPE, METHOD)                                    \
+    case FieldDescriptor::CPPTYPE_##CPPTYPE:                              \
+      if (repeated) {                                                     \
+        reflection->Add##METHOD(message, field, BitsTo##METHOD(bits));    \
+      } else {                                                            \
+        reflection->Set##METHOD(message, field, BitsTo##METHOD(bits));    \
+      }                                                                   \
+      return true;
+    SET_FROM_BITS(INT32 , Int32 )
+    SET_FROM_BITS(INT64 , Int64 )
+    SET_FROM_BITS(UINT32, UInt32)
+    SET_FROM_BITS(UINT64, UInt64)
+    SET_FROM_BITS(FLOAT , Float )
+    SET_FROM_BITS(DOUBLE, Double)
+    SET_FROM_BITS(BOOL  , Bool  )
+#undef SET_FROM_BITS
+    case FieldDescriptor::CPPTYPE_ENUM: {
+      const EnumValueDescriptor* value =
+          field->enum_type()->FindValueByNumber(BitsToInt32(bits));
+      if (value == NULL) return false;
+      if (repeated) {
+        reflection->AddEnum(message, field, value);
+      } else {
+        reflection->SetEnum(message, field, value);
+      }
+      return true;
+    }
+    default:
+      GOOGLE_LOG(FATAL) << "Not a numeric field: " << field->full_name();
+      return false;
+  }
+}
+
+// -------------------------------------------------------------------
+// Encoding.
+
+void WriteLevels(const vector<int>& levels, CodedOutputStream* output) {
+  for (int i = 0; i < levels.size(); ) {
+    int run = 1;
+    while (i + run < levels.size() && levels[i + run] == levels[i]) ++run;
+    output->WriteVarint32(run);
+    output->WriteVarint32(levels[i]);
+    i += run;
+  }
+}
+
+void WriteDelta(const vector<uint64>& numbers, CodedOutputStream* output) {
+  uint64 previous = 0;
+  for (int i = 0; i < numbers.size(); i++) {
+    output->WriteVarint64(WireFormatLite::ZigZagEncode64(
+        static_cast<int64>(numbers[i] - previous)));
+    previous = numbers[i];
+  }
+}
+
+template <typename Type>
+void WriteValue(const Type& value, CodedOutputStream* output);
+
+template <>
+void WriteValue<uint64>(const uint64& value, CodedOutputStream* output) {
+  output->WriteVarint64(value);
+}
+
+template <>
+void WriteValue<string>(const string& value, CodedOutputStream* output) {
+  output->WriteVarint32(value.size());
+  output->WriteString(value);
+}
+
+template <typename Type>
+void WriteRuns(const vector<Type>& values, CodedOutputStream* output) {
+  for (int i = 0; i < values.size(); ) {
+    int run = 1;
+    while (i + run < values.size() && values[i + run] == values[i]) ++run;
+    output->WriteVarint32(run);
+    WriteValue(values[i], output);
+    i += run;
+  }
+}
+
+template <typename Type>
+void WriteDictionary(const vector<Type>& values, CodedOutputStream* output) {
+  map<Type, int> indices;
+  vector<const Type*> distinct;
+  vector<uint64> encoded;
+  for (int i = 0; i < values.size(); i++) {
+    typename map<Type, int>::iterator iter =
+        indices.insert(make_pair(values[i], distinct.size())).first;
+    if (iter->second == distinct.size()) distinct.push_back(&iter->first);
+    encoded.push_back(iter->second);
+  }
+
+  output->WriteVarint32(distinct.size());
+  for (int i = 0; i < distinct.size(); i++) {
+    WriteValue(*distinct[i], output);
+  }
+  WriteRuns(encoded, output);
+}
+
+void WritePlain(const vector<string>& strings, CodedOutputStream* output) {
+  for (int i = 0; i < strings.size(); i++) {
+    WriteValue(strings[i], output);
+  }
+}
+
+// Encodes the values of a column with each of the given encodings and
+// appends the shortest result, preceded by its encoding, to *output.
+template <typename Type>
+void WriteValues(const vector<Type>& values, const Encoding* encodings,
+                 int encoding_count,
+                 void (*write)(Encoding, const vector<Type>&,
+                               CodedOutputStream*),
+                 string* output) {
+  string best;
+  Encoding best_encoding = encodings[0];
+  for (int i = 0; i < encoding_count; i++) {
+    string candidate;
+    {
+      io::StringOutputStream string_output(&candidate);
+      CodedOutputStream coded_output(&string_output);
+      write(encodings[i], values, &coded_output);
+    }
+    if (i == 0 || candidate.size() < best.size()) {
+      best.swap(candidate);
+      best_encoding = encodings[i];
+    }
+  }
+  output->push_back(static_cast<char>(best_encoding));
+  output->append(best);
+}
+
+void WriteNumbers(Encoding encoding, const vector<uint64>& numbers,
+                  CodedOutputStream* output) {
+  switch (encoding) {
+    case DELTA:      WriteDelta(numbers, output);      break;
+    case RUN_LENGTH: WriteRuns(numbers, output);       break;
+    case DICTIONARY: WriteDictionary(numbers, output); break;
+    default:
+      GOOGLE_LOG(FATAL) << "Can't happen.";
+  }
+}
+
+void WriteStrings(Encoding encoding, const vector<string>& strings,
+                  CodedOutputStream* output) {
+  switch (encoding) {
+    case PLAIN:      WritePlain(strings, output);      break;
+    case DICTIONARY: WriteDictionary(strings, output); break;
+    default:
+      GOOGLE_LOG(FATAL) << "Can't happen.";
+  }
+}
+
+const Encoding kNumberEncodings[] = { DELTA, RUN_LENGTH, DICTIONARY };
+const Encoding kStringEncodings[] = { PLAIN, DICTIONARY };
+
+// Appends the levels and values of a column to *output.
+void WriteColumn(const SchemaNode& node, const ColumnData& column,
+                 string* output) {
+  string levels[2];
+  {
+    io::StringOutputStream string_output(&levels[0]);
+    CodedOutputStream coded_output(&string_output);
+    WriteLevels(column.repetition_levels, &coded_output);
+  }
+  {
+    io::StringOutputStream string_output(&levels[1]);
+    CodedOutputStream coded_output(&string_output);
+    WriteLevels(column.definition_levels, &coded_output);
+  }
+
+  {
+    io::StringOutputStream string_output(output);
+    CodedOutputStream coded_output(&string_output);
+    coded_output.WriteVarint32(column.repetition_levels.size());
+    for (int i = 0; i < 2; i++) {
+      coded_output.WriteVarint32(levels[i].size());
+      coded_output.WriteString(levels[i]);
+    }
+  }
+
+  if (IsStringColumn(node.field)) {
+    WriteValues(column.strings, kStringEncodings,
+                GOOGLE_ARRAYSIZE(kStringEncodings), &WriteStrings, output);
+  } else {
+    WriteValues(column.numbers, kNumberEncodings,
+                GOOGLE_ARRAYSIZE(kNumberEncodings), &WriteNumbers, output);
+  }
+}
+
+// -------------------------------------------------------------------
+// Decoding.  Each of these reads to the current limit of the input.
+
+// Runs let a few bytes stand for any number of entries, so the number of
+// entries a column may expand to is limited, much like CodedInputStream
+// limits the size of a message by default.
+const int kMaxColumnEntries = 64 << 20;
+
+bool ReadLevels(CodedInputStream* input, int count, int max_level,
+                vector<int>* levels) {
+  while (input->BytesUntilLimit() > 0) {
+    uint32 run, level;
+    if (!input->ReadVarint32(&run) || !input->ReadVarint32(&level)) {
+      return false;
+    }
+    int remaining = count - static_cast<int>(levels->size());
+    if (run == 0 || run > static_cast<uint32>(remaining) ||
+        level > static_cast<uint32>(max_level)) {
+      return false;
+    }
+    levels->insert(levels->end(), run, level);
+  }
+  return levels->size() == count;
+}
+
+template <typename Type>
+bool ReadValue(CodedInputStream* input, Type* value);
+
+template <>
+bool ReadValue<uint64>(CodedInputStream* input, uint64* value) {
+  return input->ReadVarint64(value);
+}
+
+template <>
+bool ReadValue<string>(CodedInputStream* input, string* value) {
+  uint32 size;
+  return input->ReadVarint32(&size) && input->ReadString(value, size);
+}
+
+template <typename Type>
+bool ReadRuns(CodedInputStream* input, int count, vector<Type>* values) {
+  while (input->BytesUntilLimit() > 0) {
+    uint32 run;
+    Type value;
+    if (!input->ReadVarint32(&run) || !ReadValue(input, &value)) return false;
+    int remaining = count - static_cast<int>(values->size());
+    if (run == 0 || run > static_cast<uint32>(remaining)) return false;
+    values->insert(values->end(), run, value);
+  }
+  return true;
+}
+
+bool ReadDelta(CodedInputStream* input, vector<uint64>* numbers) {
+  uint64 previous = 0;
+  while (input->BytesUntilLimit() > 0) {
+    uint64 delta;
+    if (!input->ReadVarint64(&delta)) return false;
+    previous += static_cast<uint64>(WireFormatLite::ZigZagDecode64(delta));
+    numbers->push_back(previous);
+  }
+  return true;
+}
+
+template <typename Type>
+bool ReadDictionary(CodedInputStream* input, int count,
+                    vector<Type>* values) {
+  uint32 size;
+  if (!input->ReadVarint32(&size)) return false;
+  vector<Type> distinct;
+  for (int i = 0; i < size; i++) {
+    Type value;
+    if (!ReadValue(input, &value)) return false;
+    distinct.push_back(value);
+  }
+
+  vector<uint64> indices;
+  if (!ReadRuns(input, count, &indices)) return false;
+  for (int i = 0; i < indices.size(); i++) {
+    if (indices[i] >= distinct.size()) return false;
+    values->push_back(distinct[indices[i]]);
+  }
+  return true;
+}
+
+bool ReadPlain(CodedInputStream* input, vector<string>* strings) {
+  while (input->BytesUntilLimit() > 0) {
+    strings->push_back(string());
+    if (!ReadValue(input, &strings->back())) return false;
+  }
+  return true;
+}
+
+// Reads a column written by WriteColumn().
+bool ReadColumnData(const SchemaNode& node, int record_count,
+                    CodedInputStream* input, ColumnData* column) {
+  uint32 count;
+  if (!input->ReadVarint32(&count)) return false;
+  // Each record has at least one entry.
+  if (count < static_cast<uint32>(record_count) ||
+      count > static_cast<uint32>(kMaxColumnEntries)) {
+    return false;
+  }
+
+  vector<int>* levels[2] = {
+    &column->repetition_levels, &column->definition_levels
+  };
+  int max_levels[2] = { node.repetition_level, node.definition_level };
+  for (int i = 0; i < 2; i++) {
+    uint32 size;
+    if (!input->ReadVarint32(&size)) return false;
+    if (size > input->BytesUntilLimit()) return false;
+    CodedInputStream::Limit limit = input->PushLimit(size);
+    if (!ReadLevels(input, count, max_levels[i], levels[i])) return false;
+    input->PopLimit(limit);
+  }
+
+  // Every record starts a new entry at repetition level 0, and only values
+  // with the maximum definition level have a value.
+  int records = 0;
+  int value_count = 0;
+  for (int i = 0; i < count; i++) {
+    if (column->repetition_levels[i] == 0) ++records;
+    if (column->definition_levels[i] == node.definition_level) ++value_count;
+  }
+  if (records != record_count) return false;
+  if (count > 0 && column->repetition_levels[0] != 0) return false;
+
+  uint8 encoding;
+  if (!input->ReadRaw(&encoding, 1)) return false;
+  bool ok;
+  if (IsStringColumn(node.field)) {
+    switch (encoding) {
+      case PLAIN:
+        ok = ReadPlain(input, &column->strings);
+        break;
+      case DICTIONARY:
+        ok = ReadDictionary(input, value_count, &column->strings);
+        break;
+      default:
+        ok = false;
+    }
+    ok = ok && column->strings.size() == value_count;
+  } else {
+    switch (encoding) {
+      case DELTA:
+        ok = ReadDelta(input, &column->numbers);
+        break;
+      case RUN_LENGTH:
+        ok = ReadRuns(input, value_count, &column->numbers);
+        break;
+      case DICTIONARY:
+        ok = ReadDictionary(input, value_count, &column->numbers);
+        break;
+      default:
+        ok = false;
+    }
+    ok = ok && column->numbers.size() == value_count;
+  }
+  return ok;
+}
+
+}  // namespace
+
+// ===================================================================
+
+ColumnarWriter::ColumnarWriter(const Descriptor* descriptor)
+  : schema_(new ColumnarSchema(descriptor)),
+    record_count_(0) {
+  for (int i = 0; i < schema_->column_count(); i++) {
+    columns_.push_back(new ColumnData);
+  }
+}
+
+ColumnarWriter::~ColumnarWriter() {
+  STLDeleteElements(&columns_);
+}
+
+void ColumnarWriter::AddRecord(const Message& record) {
+  GOOGLE_CHECK_EQ(record.GetDescriptor(), schema_->descriptor());
+  GOOGLE_DCHECK(record.IsInitialized())
+      << "Can't add record of type \"" << record.GetTypeName()
+      << "\" because it is missing required fields: "
+      << record.InitializationErrorString();
+  AddFields(record, 0, 0, 0);
+  ++record_count_;
+}
+
+void ColumnarWriter::AddNulls(int first_column, int end_column,
+                              int repetition_level, int definition_level) {
+  for (int i = first_column; i < end_column; i++) {
+    columns_[i]->repetition_levels.push_back(repetition_level);
+    columns_[i]->definition_levels.push_back(definition_level);
+  }
+}
+
+void ColumnarWriter::AddFields(const Message& message, int node,
+                               int repetition_level, int definition_level) {
+  const Reflection* reflection = message.GetReflection();
+  const vector<int>& children = schema_->node(node).children;
+  for (int i = 0; i < children.size(); i++) {
+    const SchemaNode& child = schema_->node(children[i]);
+    const FieldDescriptor* field = child.field;
+
+    int count;
+    if (field->is_repeated()) {
+      count = reflection->FieldSize(message, field);
+    } else {
+      count = field->is_required() || reflection->HasField(message, field);
+    }
+    if (count == 0) {
+      AddNulls(child.first_column, child.end_column, repetition_level,
+               definition_level);
+      continue;
+    }
+
+    for (int j = 0; j < count; j++) {
+      // The first element continues whatever the parent started; the rest
+      // each start a new element of this field.
+      int level = j == 0 ? repetition_level : child.repetition_level;
+      if (!child.is_leaf()) {
+        AddFields(field->is_repeated() ?
+                      reflection->GetRepeatedMessage(message, field, j) :
+                      reflection->GetMessage(message, field),
+                  children[i], level, child.definition_level);
+        continue;
+      }
+
+      ColumnData* column = columns_[child.first_column];
+      column->repetition_levels.push_back(level);
+      column->definition_levels.push_back(child.definition_level);
+      switch (field->cpp_type()) {
+        case FieldDescriptor::CPPTYPE_STRING:
+          column->strings.push_back(field->is_repeated() ?
+              reflection->GetRepeatedString(message, field, j) :
+              reflection->GetString(message, field));
+          break;
+        case FieldDescriptor::CPPTYPE_MESSAGE:
+          column->strings.push_back((field->is_repeated() ?
+              reflection->GetRepeatedMessage(message, field, j) :
+              reflection->GetMessage(message, field))
+                  .SerializePartialAsString());
+          break;
+        default:
+          column->numbers.push_back(ToBits(message, field, j));
+          break;
+      }
+    }
+  }
+}
+
+void ColumnarWriter::SerializeToString(string* output) const {
+  output->clear();
+  io::StringOutputStream string_output(output);
+  CodedOutputStream coded_output(&string_output);
+  coded_output.WriteVarint32(record_count_);
+  coded_output.WriteVarint32(schema_->column_count());
+
+  string column;
+  for (int i = 0; i < schema_->column_count(); i++) {
+    const SchemaNode& node = schema_->column(i);
+    column.clear();
+    WriteColumn(node, *columns_[i], &column);
+
+    // The directory entry lets a reader check that the column still
+    // matches its own view of the field before decoding it.
+    coded_output.WriteVarint32(node.path.size());
+    coded_output.WriteString(node.path);
+    coded_output.WriteVarint32(node.field->cpp_type());
+    coded_output.WriteVarint32(node.repetition_level);
+    coded_output.WriteVarint32(node.definition_level);
+    coded_output.WriteVarint32(column.size());
+    coded_output.WriteString(column);
+  }
+}
+
+void ColumnarWriter::Clear() {
+  for (int i = 0; i < columns_.size(); i++) {
+    delete columns_[i];
+    columns_[i] = new ColumnData;
+  }
+  record_count_ = 0;
+}
+
+// ===================================================================
+
+ColumnarReader::ColumnarReader(const Descriptor* descriptor)
+  : schema_(new ColumnarSchema(descriptor)),
+    record_count_(0),
+    ranges_(schema_->column_count(), make_pair(-1, 0)),
+    columns_(schema_->column_count(), static_cast<ColumnData*>(NULL)),
+    leads_(schema_->node_count(), -1),
+    selected_(schema_->column_count(), false),
+    next_record_(0) {}
+
+ColumnarReader::~ColumnarReader() {
+  STLDeleteElements(&columns_);
+}
+
+bool ColumnarReader::ParseFromString(const string& data) {
+  return ParseFromArray(data.data(), data.size());
+}
+
+bool ColumnarReader::ParseFromArray(const void* data, int size) {
+  STLDeleteElements(&columns_);
+  columns_.resize(schema_->column_count(), NULL);
+  ranges_.assign(schema_->column_count(), make_pair(-1, 0));
+  vector<pair<int, int> > ranges(ranges_);
+  leads_.assign(schema_->node_count(), -1);
+  selected_.assign(schema_->column_count(), false);
+  record_count_ = 0;
+  next_record_ = 0;
+  data_.assign(reinterpret_cast<const char*>(data), size);
+
+  CodedInputStream input(reinterpret_cast<const uint8*>(data_.data()),
+                         data_.size());
+  input.SetTotalBytesLimit(data_.size(), -1);
+  uint32 record_count, column_count;
+  if (!input.ReadVarint32(&record_count) ||
+      !input.ReadVarint32(&column_count) ||
+      record_count > kint32max) {
+    return false;
+  }
+
+  for (int i = 0; i < column_count; i++) {
+    uint32 path_size, cpp_type, repetition_level, definition_level, size;
+    string path;
+    if (!input.ReadVarint32(&path_size) ||
+        !input.ReadString(&path, path_size) ||
+        !input.ReadVarint32(&cpp_type) ||
+        !input.ReadVarint32(&repetition_level) ||
+        !input.ReadVarint32(&definition_level) ||
+        !input.ReadVarint32(&size) ||
+        size > input.BytesUntilLimit()) {
+      return false;
+    }
+    int start = input.CurrentPosition();
+    if (!input.Skip(size)) return false;
+
+    // Columns which this reader's type lacks, or has with a different type
+    // or place in the tree, are left out.
+    int node_index = schema_->FindNode(path);
+    if (node_index == -1) continue;
+    const SchemaNode& node = schema_->node(node_index);
+    if (!node.is_leaf() || node.field->cpp_type() != cpp_type ||
+        node.repetition_level != repetition_level ||
+        node.definition_level != definition_level) {
+      continue;
+    }
+    if (ranges[node.first_column].first != -1) return false;
+    ranges[node.first_column] = make_pair(start, static_cast<int>(size));
+  }
+  if (input.BytesUntilLimit() != 0) return false;
+
+  ranges_.swap(ranges);
+  record_count_ = record_count;
+  return true;
+}
+
+void ColumnarReader::ListColumns(vector<string>* paths) const {
+  for (int i = 0; i < schema_->column_count(); i++) {
+    if (ranges_[i].first != -1) paths->push_back(schema_->column(i).path);
+  }
+}
+
+const ColumnData* ColumnarReader::DecodeColumn(int column) {
+  if (columns_[column] != NULL) return columns_[column];
+  if (ranges_[column].first == -1) return NULL;
+
+  CodedInputStream input(
+      reinterpret_cast<const uint8*>(data_.data()) + ranges_[column].first,
+      ranges_[column].second);
+  input.SetTotalBytesLimit(ranges_[column].second, -1);
+  scoped_ptr<ColumnData> data(new ColumnData);
+  if (!ReadColumnData(schema_->column(column), record_count_, &input,
+                      data.get())) {
+    GOOGLE_LOG(ERROR) << "Column \"" << schema_->column(column).path
+                      << "\" is malformed.";
+    return NULL;
+  }
+  columns_[column] = data.release();
+  return columns_[column];
+}
+
+bool ColumnarReader::SelectColumns(const vector<string>& paths) {
+  leads_.assign(schema_->node_count(), -1);
+  selected_.assign(schema_->column_count(), false);
+  next_record_ = 0;
+
+  for (int i = 0; i < paths.size(); i++) {
+    int node = schema_->FindNode(paths[i]);
+    if (node == -1) continue;
+    for (int j = schema_->node(node).first_column;
+         j < schema_->node(node).end_column; j++) {
+      if (ranges_[j].first == -1) continue;
+      if (DecodeColumn(j) == NULL) return false;
+      selected_[j] = true;
+    }
+  }
+
+  for (int i = 0; i < schema_->column_count(); i++) {
+    if (columns_[i] != NULL) {
+      columns_[i]->next_entry = 0;
+      columns_[i]->next_value = 0;
+    }
+  }
+  // Nodes are numbered in preorder, as are the columns.  The lead of a node
+  // is the first selected column in its range.
+  for (int i = 0; i < schema_->node_count(); i++) {
+    const SchemaNode& node = schema_->node(i);
+    for (int j = node.first_column; j < node.end_column; j++) {
+      if (selected_[j]) {
+        leads_[i] = j;
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+bool ColumnarReader::ReadRecord(Message* record) {
+  GOOGLE_CHECK_EQ(record->GetDescriptor(), schema_->descriptor());
+  if (next_record_ >= record_count_) return false;
+  record->Clear();
+
+  // Every selected column must be at the start of the record before and
+  // after reading it.
+  for (int i = 0; i < selected_.size(); i++) {
+    if (!selected_[i]) continue;
+    const ColumnData& column = *columns_[i];
+    if (column.next_entry >= column.repetition_levels.size() ||
+        column.repetition_levels[column.next_entry] != 0) {
+      return false;
+    }
+  }
+  if (!ReadFields(record, 0)) return false;
+  ++next_record_;
+  for (int i = 0; i < selected_.size(); i++) {
+    if (!selected_[i]) continue;
+    const ColumnData& column = *columns_[i];
+    if (column.next_entry < column.repetition_levels.size() &&
+        column.repetition_levels[column.next_entry] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ColumnarReader::ReadFields(Message* message, int node) {
+  const vector<int>& children = schema_->node(node).children;
+  for (int i = 0; i < children.size(); i++) {
+    if (leads_[children[i]] == -1) continue;
+    if (!ReadField(message, children[i])) return false;
+  }
+  return true;
+}
+
+bool ColumnarReader::ReadField(Message* message, int node) {
+  const SchemaNode& schema_node = schema_->node(node);
+  const ColumnData& lead = *columns_[leads_[node]];
+  if (lead.next_entry >= lead.definition_levels.size()) return false;
+  if (lead.definition_levels[lead.next_entry] <
+      schema_node.definition_level) {
+    return SkipField(node);
+  }
+
+  while (true) {
+    if (!ReadValue(message, node)) return false;
+    if (!schema_node.field->is_repeated()) return true;
+
+    // Another element of this field follows if the lead column's next
+    // entry repeats at this field's level.
+    if (lead.next_entry >= lead.repetition_levels.size() ||
+        lead.repetition_levels[lead.next_entry] !=
+        schema_node.repetition_level) {
+      return true;
+    }
+    if (lead.definition_levels[lead.next_entry] <
+        schema_node.definition_level) {
+      return false;
+    }
+  }
+}
+
+bool ColumnarReader::ReadValue(Message* message, int node) {
+  const SchemaNode& schema_node = schema_->node(node);
+  const FieldDescriptor* field = schema_node.field;
+  const Reflection* reflection = message->GetReflection();
+
+  if (!schema_node.is_leaf()) {
+    return ReadFields(field->is_repeated() ?
+                          reflection->AddMessage(message, field) :
+                          reflection->MutableMessage(message, field),
+                      node);
+  }
+
+  // A leaf's only column is its lead.
+  ColumnData* column = columns_[leads_[node]];
+  ++column->next_entry;
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_STRING: {
+      const string& value = column->strings[column->next_value++];
+      if (field->is_repeated()) {
+        reflection->AddString(message, field, value);
+      } else {
+        reflection->SetString(message, field, value);
+      }
+      return true;
+    }
+    case FieldDescriptor::CPPTYPE_MESSAGE: {
+      const string& value = column->strings[column->next_value++];
+      return (field->is_repeated() ?
+                  reflection->AddMessage(message, field) :
+                  reflection->MutableMessage(message, field))
+          ->ParsePartialFromString(value);
+    }
+    default:
+      return SetFromBits(message, field,
+                         column->numbers[column->next_value++]);
+  }
+}
+
+bool ColumnarReader::SkipField(int node) {
+  // A missing field has one placeholder entry in each column under it.
+  const SchemaNode& schema_node = schema_->node(node);
+  for (int i = schema_node.first_column; i < schema_node.end_column; i++) {
+    if (!selected_[i]) continue;
+    ColumnData* column = columns_[i];
+    if (column->next_entry >= column->definition_levels.size() ||
+        column->definition_levels[column->next_entry] >=
+        schema_node.definition_level) {
+      return false;
+    }
+    ++column->next_entry;
+  }
+  return true;
+}
+
+// -------------------------------------------------------------------
+
+const ColumnData* ColumnarReader::FindNumericColumn(const string& path,
+                                                    int cpp_type) {
+  int node = schema_->FindNode(path);
+  if (node == -1 || !schema_->node(node).is_leaf()) return NULL;
+  int field_type = schema_->node(node).field->cpp_type();
+  if (field_type == FieldDescriptor::CPPTYPE_ENUM) {
+    field_type = FieldDescriptor::CPPTYPE_INT32;
+  }
+  if (field_type != cpp_type) return NULL;
+  return DecodeColumn(schema_->node(node).first_column);
+}
+
+#define READ_COLUMN(TYPE, CPPTYPE, CONVERSION)                            \
+  bool ColumnarReader::ReadColumn(const string& path,                     \
+                                  RepeatedField<TYPE>* values) {          \
+    const ColumnData* column =                                            \
+        FindNumericColumn(path, FieldDescriptor::CPPTYPE_##CPPTYPE);      \
+    if (column == NULL) return false;                                     \
+    values->Reserve(values->size() + column->numbers.size());             \
+    for (int i = 0; i < column->numbers.size(); i++) {                    \
+      values->AddAlreadyReserved(CONVERSION(column->numbers[i]));         \
+    }                                                                     \
+    return true;                                                          \
+  }
+
+READ_COLUMN(int32 , INT32 , BitsToInt32 )
+READ_COLUMN(int64 , INT64 , BitsToInt64 )
+READ_COLUMN(uint32, UINT32, BitsToUInt32)
+READ_COLUMN(uint64, UINT64, BitsToUInt64)
+READ_COLUMN(float , FLOAT , BitsToFloat )
+READ_COLUMN(double, DOUBLE, BitsToDouble)
+READ_COLUMN(bool  , BOOL  , BitsToBool  )
+#undef READ_COLUMN
+
+bool ColumnarReader::ReadColumn(const string& path,
+                                RepeatedPtrField<string>* values) {
+  int node = schema_->FindNode(path);
+  if (node == -1 || !schema_->node(node).is_leaf() ||
+      !IsStringColumn(schema_->node(node).field)) {
+    return false;
+  }
+  const ColumnData* column = DecodeColumn(schema_->node(node).first_column);
+  if (column == NULL) return false;
+  for (int i = 0; i < column->strings.size(); i++) {
+    values->Add()->assign(column->strings[i]);
+  }
+  return true;
+}
+
+bool ColumnarReader::ReadLevels(const string& path,
+                                RepeatedField<int32>* repetition_levels,
+                                RepeatedField<int32>* definition_levels) {
+  int node = schema_->FindNode(path);
+  if (node == -1 || !schema_->node(node).is_leaf()) return false;
+  const ColumnData* column = DecodeColumn(schema_->node(node).first_column);
+  if (column == NULL) return false;
+  for (int i = 0; i < column->repetition_levels.size(); i++) {
+    repetition_levels->Add(column->repetition_levels[i]);
+    definition_levels->Add(column->definition_levels[i]);
+  }
+  return true;
+}
+
+}  // namespace protobuf
+}  // namespace google
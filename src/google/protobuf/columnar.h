@@ -0,0 +1,206 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// A columnar encoding for large numbers of records of one message type,
+// after the record shredding of Dremel.  Programs which scan one or two
+// fields across millions of records would otherwise have to parse every
+// record in full; with the records stored as columns, they decode only the
+// columns they need.
+//
+// ColumnarWriter takes apart each record into one column per leaf field of
+// the record's type, where a leaf field is a non-message field, named by
+// the path of field names leading to it from the top-level message, such as
+// "links.backward".  Each entry of a column holds two small numbers along
+// with the value:
+//   - the repetition level, which tells at which repeated field in the path
+//     the entry starts a new element (0 means it starts a new record), and
+//   - the definition level, which tells how many of the optional or
+//     repeated fields in the path are actually present.  An entry with less
+//     than the maximum definition level is a placeholder for a missing field
+//     and has no value.
+// Together they are enough to put the records back together from any
+// subset of the columns.
+//
+// The levels are run-length encoded.  Each column's values are stored with
+// whichever of a few encodings comes out smallest: numbers as varints of
+// the differences between consecutive values, as runs of equal values, or
+// as indices into a dictionary of distinct values; strings either as they
+// are or through a dictionary.
+//
+// ColumnarReader reads a chosen set of columns back into messages, or the
+// values of one column straight into a RepeatedField.  It only needs a
+// Descriptor, so it works with dynamic messages.  Columns are matched by
+// path, so a reader whose type has gained or lost fields since the data
+// was written still reads the columns the two have in common.
+//
+// Message fields whose type contains no fields, or whose type already
+// appears further up the path, as in a recursive type, are stored whole as
+// serialized messages in a column of their own.  Extensions and unknown
+// fields are not stored.
+
+#ifndef GOOGLE_PROTOBUF_COLUMNAR_H__
+#define GOOGLE_PROTOBUF_COLUMNAR_H__
+
+#include <string>
+#include <utility>
+#include <vector>
+#include <google/protobuf/repeated_field.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Descriptor;                    // descriptor.h
+  class Message;                       // message.h
+  namespace internal {
+    class ColumnarSchema;              // columnar.cc
+    struct ColumnData;                 // columnar.cc
+  }
+}
+
+namespace protobuf {
+
+class LIBPROTOBUF_EXPORT ColumnarWriter {
+ public:
+  // The records must all be of the given type.
+  explicit ColumnarWriter(const Descriptor* descriptor);
+  ~ColumnarWriter();
+
+  // Adds a record to the end of the columns.  Required fields are expected
+  // to be set; as with serialization, this is only checked in debug builds.
+  void AddRecord(const Message& record);
+
+  int record_count() const { return record_count_; }
+
+  // Encodes the records added so far and stores them in *output.
+  void SerializeToString(string* output) const;
+
+  // Discards the records added so far.
+  void Clear();
+
+ private:
+  void AddNulls(int first_column, int end_column, int repetition_level,
+                int definition_level);
+  void AddFields(const Message& message, int node, int repetition_level,
+                 int definition_level);
+
+  scoped_ptr<internal::ColumnarSchema> schema_;
+  vector<internal::ColumnData*> columns_;
+  int record_count_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ColumnarWriter);
+};
+
+class LIBPROTOBUF_EXPORT ColumnarReader {
+ public:
+  // Reads records of the given type.  The Descriptor need not be the one
+  // the data was written with; see above.
+  explicit ColumnarReader(const Descriptor* descriptor);
+  ~ColumnarReader();
+
+  // Reads data written by ColumnarWriter::SerializeToString().  Only the
+  // layout of the columns is checked here; each column is decoded, and
+  // checked, the first time it is read; a column which would expand to
+  // more than 2^26 entries counts as malformed, to keep a few bytes of
+  // damaged data from taking up gigabytes once decoded.  Returns false if
+  // the data is malformed.  The data is copied.
+  bool ParseFromString(const string& data);
+  bool ParseFromArray(const void* data, int size);
+
+  int record_count() const { return record_count_; }
+
+  // Fills in *paths with the paths of the columns which are present in the
+  // data and known to this reader's Descriptor.
+  void ListColumns(vector<string>* paths) const;
+
+  // Chooses the columns which ReadRecord() reads, and goes back to the first
+  // record.  Each path names either a column or a message field, which
+  // stands for all the columns under it.  Paths which match no column are
+  // ignored.  Returns false if one of the selected columns is malformed.
+  bool SelectColumns(const vector<string>& paths);
+
+  // Clears *record and fills in the fields of the next record which belong
+  // to the selected columns.  record must be of this reader's type.
+  // Returns false after the last record, or if the columns are malformed.
+  bool ReadRecord(Message* record);
+
+  // Appends the values of one column, across all records, to *values,
+  // leaving out missing fields.  The type of values must match the C++
+  // type of the field; enums are read as int32, and whole-message columns
+  // as strings.  Returns false if the column isn't in the data, if its
+  // type doesn't match, or if it is malformed.
+  bool ReadColumn(const string& path, RepeatedField<int32>* values);
+  bool ReadColumn(const string& path, RepeatedField<int64>* values);
+  bool ReadColumn(const string& path, RepeatedField<uint32>* values);
+  bool ReadColumn(const string& path, RepeatedField<uint64>* values);
+  bool ReadColumn(const string& path, RepeatedField<float>* values);
+  bool ReadColumn(const string& path, RepeatedField<double>* values);
+  bool ReadColumn(const string& path, RepeatedField<bool>* values);
+  bool ReadColumn(const string& path, RepeatedPtrField<string>* values);
+
+  // Appends the repetition and definition levels of each entry of one
+  // column to the given fields.  These tell which record each value came
+  // from and which entries are missing fields, as explained above.
+  bool ReadLevels(const string& path,
+                  RepeatedField<int32>* repetition_levels,
+                  RepeatedField<int32>* definition_levels);
+
+ private:
+  // Returns the decoded column with the given index in the schema, or NULL
+  // if it isn't present or is malformed.
+  const internal::ColumnData* DecodeColumn(int column);
+  const internal::ColumnData* FindNumericColumn(const string& path,
+                                                int cpp_type);
+  bool ReadFields(Message* message, int node);
+  bool ReadField(Message* message, int node);
+  bool ReadValue(Message* message, int node);
+  bool SkipField(int node);
+
+  scoped_ptr<internal::ColumnarSchema> schema_;
+  string data_;
+  int record_count_;
+
+  // Indexed by the schema's column numbers.  The ranges of data_ holding
+  // each column, or -1 if it is absent, and the column once decoded.
+  vector<pair<int, int> > ranges_;
+  vector<internal::ColumnData*> columns_;
+
+  // Indexed by the schema's node numbers: the first selected column under
+  // each node, or -1 if there is none.
+  vector<int> leads_;
+  vector<bool> selected_;  // Indexed by column.
+  int next_record_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ColumnarReader);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COLUMNAR_H__
@@ -0,0 +1,478 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/columnar.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/text_format.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_map.pb.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/test_util.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Returns a varied set of records: some with every field set, some empty,
+// and some with repeated fields of every length from zero to three.
+vector<unittest::TestAllTypes> MakeRecords() {
+  vector<unittest::TestAllTypes> records(40);
+  for (int i = 0; i < records.size(); i++) {
+    unittest::TestAllTypes* record = &records[i];
+    if (i % 5 == 0) TestUtil::SetAllFields(record);
+    if (i % 5 == 1) continue;
+    record->set_optional_int32(i * 3);
+    record->set_optional_int64(-i);
+    record->set_optional_string(i % 2 == 0 ? "even" : "odd");
+    for (int j = 0; j < i % 4; j++) {
+      unittest::TestAllTypes::NestedMessage* nested =
+          record->add_repeated_nested_message();
+      if (j != 1) nested->set_bb(i * 10 + j);
+      record->add_repeated_double(i + j * 0.5);
+    }
+    if (i % 3 == 0) {
+      // Present but empty.
+      record->mutable_optional_foreign_message();
+    }
+  }
+  return records;
+}
+
+string WriteRecords(const vector<unittest::TestAllTypes>& records) {
+  ColumnarWriter writer(unittest::TestAllTypes::descriptor());
+  for (int i = 0; i < records.size(); i++) {
+    writer.AddRecord(records[i]);
+  }
+  EXPECT_EQ(records.size(), writer.record_count());
+  string data;
+  writer.SerializeToString(&data);
+  return data;
+}
+
+TEST(ColumnarTest, RoundTrip) {
+  vector<unittest::TestAllTypes> records = MakeRecords();
+  string data = WriteRecords(records);
+
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(data));
+  ASSERT_EQ(records.size(), reader.record_count());
+
+  vector<string> columns;
+  reader.ListColumns(&columns);
+  EXPECT_FALSE(columns.empty());
+  ASSERT_TRUE(reader.SelectColumns(columns));
+
+  unittest::TestAllTypes record;
+  for (int i = 0; i < records.size(); i++) {
+    ASSERT_TRUE(reader.ReadRecord(&record));
+    EXPECT_EQ(records[i].SerializeAsString(), record.SerializeAsString())
+        << "record " << i;
+  }
+  EXPECT_FALSE(reader.ReadRecord(&record));
+
+  // Selecting again starts over.
+  ASSERT_TRUE(reader.SelectColumns(columns));
+  ASSERT_TRUE(reader.ReadRecord(&record));
+  EXPECT_EQ(records[0].SerializeAsString(), record.SerializeAsString());
+}
+
+TEST(ColumnarTest, SelectColumns) {
+  vector<unittest::TestAllTypes> records = MakeRecords();
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(WriteRecords(records)));
+
+  // A message field's path selects every column under it.
+  vector<string> columns;
+  columns.push_back("optional_int32");
+  columns.push_back("repeated_nested_message");
+  columns.push_back("optional_foreign_message.c");
+  columns.push_back("no_such_field");
+  ASSERT_TRUE(reader.SelectColumns(columns));
+
+  unittest::TestAllTypes record;
+  for (int i = 0; i < records.size(); i++) {
+    unittest::TestAllTypes expected;
+    if (records[i].has_optional_int32()) {
+      expected.set_optional_int32(records[i].optional_int32());
+    }
+    expected.mutable_repeated_nested_message()->MergeFrom(
+        records[i].repeated_nested_message());
+    if (records[i].has_optional_foreign_message()) {
+      expected.mutable_optional_foreign_message()->CopyFrom(
+          records[i].optional_foreign_message());
+    }
+    ASSERT_TRUE(reader.ReadRecord(&record));
+    EXPECT_EQ(expected.SerializeAsString(), record.SerializeAsString())
+        << "record " << i;
+  }
+  EXPECT_FALSE(reader.ReadRecord(&record));
+
+  // With nothing selected, every record is empty.
+  ASSERT_TRUE(reader.SelectColumns(vector<string>()));
+  for (int i = 0; i < records.size(); i++) {
+    ASSERT_TRUE(reader.ReadRecord(&record));
+    EXPECT_EQ(0, record.ByteSize());
+  }
+  EXPECT_FALSE(reader.ReadRecord(&record));
+}
+
+TEST(ColumnarTest, ReadColumn) {
+  vector<unittest::TestAllTypes> records = MakeRecords();
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(WriteRecords(records)));
+
+  RepeatedField<int32> int32s, expected_int32s;
+  RepeatedField<double> doubles, expected_doubles;
+  RepeatedPtrField<string> strings, expected_strings;
+  RepeatedField<int32> enums, expected_enums;
+  for (int i = 0; i < records.size(); i++) {
+    for (int j = 0; j < records[i].repeated_nested_message_size(); j++) {
+      if (records[i].repeated_nested_message(j).has_bb()) {
+        expected_int32s.Add(records[i].repeated_nested_message(j).bb());
+      }
+    }
+    expected_doubles.MergeFrom(records[i].repeated_double());
+    if (records[i].has_optional_string()) {
+      expected_strings.Add()->assign(records[i].optional_string());
+    }
+    if (records[i].has_optional_nested_enum()) {
+      expected_enums.Add(records[i].optional_nested_enum());
+    }
+  }
+
+  ASSERT_TRUE(reader.ReadColumn("repeated_nested_message.bb", &int32s));
+  ASSERT_EQ(expected_int32s.size(), int32s.size());
+  for (int i = 0; i < int32s.size(); i++) {
+    EXPECT_EQ(expected_int32s.Get(i), int32s.Get(i));
+  }
+  ASSERT_TRUE(reader.ReadColumn("repeated_double", &doubles));
+  ASSERT_EQ(expected_doubles.size(), doubles.size());
+  for (int i = 0; i < doubles.size(); i++) {
+    EXPECT_EQ(expected_doubles.Get(i), doubles.Get(i));
+  }
+  ASSERT_TRUE(reader.ReadColumn("optional_string", &strings));
+  ASSERT_EQ(expected_strings.size(), strings.size());
+  for (int i = 0; i < strings.size(); i++) {
+    EXPECT_EQ(expected_strings.Get(i), strings.Get(i));
+  }
+  ASSERT_TRUE(reader.ReadColumn("optional_nested_enum", &enums));
+  ASSERT_EQ(expected_enums.size(), enums.size());
+  for (int i = 0; i < enums.size(); i++) {
+    EXPECT_EQ(expected_enums.Get(i), enums.Get(i));
+  }
+
+  // Wrong types, message fields and unknown paths are rejected.
+  RepeatedField<int64> int64s;
+  EXPECT_FALSE(reader.ReadColumn("repeated_nested_message.bb", &int64s));
+  EXPECT_FALSE(reader.ReadColumn("repeated_nested_message", &int32s));
+  EXPECT_FALSE(reader.ReadColumn("no_such_field", &int32s));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &strings));
+}
+
+TEST(ColumnarTest, Levels) {
+  // The example from the overview: three records whose nested messages
+  // are set, missing or absent altogether.
+  unittest::TestAllTypes records[3];
+  records[0].add_repeated_nested_message()->set_bb(1);
+  records[0].add_repeated_nested_message();
+  records[0].add_repeated_nested_message()->set_bb(2);
+  records[2].add_repeated_nested_message()->set_bb(3);
+
+  ColumnarWriter writer(unittest::TestAllTypes::descriptor());
+  for (int i = 0; i < 3; i++) {
+    writer.AddRecord(records[i]);
+  }
+  string data;
+  writer.SerializeToString(&data);
+
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(data));
+  RepeatedField<int32> repetition_levels, definition_levels, values;
+  ASSERT_TRUE(reader.ReadLevels("repeated_nested_message.bb",
+                                &repetition_levels, &definition_levels));
+  ASSERT_TRUE(reader.ReadColumn("repeated_nested_message.bb", &values));
+
+  const int kRepetitionLevels[] = { 0, 1, 1, 0, 0 };
+  const int kDefinitionLevels[] = { 2, 1, 2, 0, 2 };
+  ASSERT_EQ(GOOGLE_ARRAYSIZE(kRepetitionLevels), repetition_levels.size());
+  ASSERT_EQ(GOOGLE_ARRAYSIZE(kDefinitionLevels), definition_levels.size());
+  for (int i = 0; i < repetition_levels.size(); i++) {
+    EXPECT_EQ(kRepetitionLevels[i], repetition_levels.Get(i));
+    EXPECT_EQ(kDefinitionLevels[i], definition_levels.Get(i));
+  }
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(1, values.Get(0));
+  EXPECT_EQ(2, values.Get(1));
+  EXPECT_EQ(3, values.Get(2));
+}
+
+TEST(ColumnarTest, Encodings) {
+  // Long runs and sorted or repetitive values should take much less room
+  // than the records themselves.
+  ColumnarWriter writer(unittest::TestAllTypes::descriptor());
+  int serialized_size = 0;
+  for (int i = 0; i < 10000; i++) {
+    unittest::TestAllTypes record;
+    record.set_optional_int64(GOOGLE_LONGLONG(1000000000000) + i * 1000);
+    record.set_optional_string(i % 3 == 0 ? "GET" : "POST");
+    record.set_optional_bool(true);
+    record.set_optional_double(1.5);
+    serialized_size += record.ByteSize();
+    writer.AddRecord(record);
+  }
+  string data;
+  writer.SerializeToString(&data);
+  EXPECT_LT(data.size(), serialized_size / 5);
+
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(data));
+  RepeatedField<int64> timestamps;
+  ASSERT_TRUE(reader.ReadColumn("optional_int64", &timestamps));
+  ASSERT_EQ(10000, timestamps.size());
+  EXPECT_EQ(GOOGLE_LONGLONG(1000000000000) + 9999 * 1000, timestamps.Get(9999));
+  RepeatedPtrField<string> methods;
+  ASSERT_TRUE(reader.ReadColumn("optional_string", &methods));
+  ASSERT_EQ(10000, methods.size());
+  EXPECT_EQ("GET", methods.Get(9999));
+  EXPECT_EQ("POST", methods.Get(9998));
+}
+
+TEST(ColumnarTest, RecursiveType) {
+  // The nested message of a recursive type is stored whole.
+  unittest::TestRecursiveMessage record;
+  record.set_i(1);
+  record.mutable_a()->set_i(2);
+  record.mutable_a()->mutable_a()->mutable_a()->set_i(4);
+
+  ColumnarWriter writer(unittest::TestRecursiveMessage::descriptor());
+  writer.AddRecord(record);
+  writer.AddRecord(unittest::TestRecursiveMessage());
+  string data;
+  writer.SerializeToString(&data);
+
+  ColumnarReader reader(unittest::TestRecursiveMessage::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(data));
+  vector<string> columns;
+  reader.ListColumns(&columns);
+  ASSERT_EQ(2, columns.size());
+  EXPECT_EQ("a", columns[0]);
+  EXPECT_EQ("i", columns[1]);
+  ASSERT_TRUE(reader.SelectColumns(columns));
+
+  unittest::TestRecursiveMessage read;
+  ASSERT_TRUE(reader.ReadRecord(&read));
+  EXPECT_EQ(record.SerializeAsString(), read.SerializeAsString());
+  ASSERT_TRUE(reader.ReadRecord(&read));
+  EXPECT_EQ(0, read.ByteSize());
+}
+
+TEST(ColumnarTest, MapFields) {
+  // Map entries are shredded like any other repeated message, and looking
+  // up keys works on the records read back.
+  protobuf_unittest::TestMap record;
+  record.mutable_int32_to_int32()->Mutable(1)->set_value(10);
+  record.mutable_int32_to_int32()->Mutable(-2)->set_value(20);
+  record.mutable_uint64_to_message()->Mutable(7)->mutable_value()
+      ->set_a(7);
+
+  ColumnarWriter writer(protobuf_unittest::TestMap::descriptor());
+  writer.AddRecord(record);
+  string data;
+  writer.SerializeToString(&data);
+
+  ColumnarReader reader(protobuf_unittest::TestMap::descriptor());
+  ASSERT_TRUE(reader.ParseFromString(data));
+  vector<string> columns;
+  reader.ListColumns(&columns);
+  ASSERT_TRUE(reader.SelectColumns(columns));
+  protobuf_unittest::TestMap read;
+  ASSERT_TRUE(reader.ReadRecord(&read));
+  EXPECT_EQ(record.SerializeAsString(), read.SerializeAsString());
+  ASSERT_TRUE(read.int32_to_int32().Find(-2) != NULL);
+  EXPECT_EQ(20, read.int32_to_int32().Find(-2)->value());
+  ASSERT_TRUE(read.uint64_to_message().Find(7) != NULL);
+  EXPECT_EQ(7, read.uint64_to_message().Find(7)->value().a());
+}
+
+TEST(ColumnarTest, DifferentTypes) {
+  // A reader whose type has changed since the data was written reads the
+  // columns the two types still agree on.
+  DescriptorPool pool;
+  FileDescriptorProto file;
+  ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"record.proto\" "
+      "message_type { name: \"Old\" "
+      "  field { name: \"a\" number: 1 label: LABEL_OPTIONAL type: TYPE_INT32 }"
+      "field { name: \"b\" number: 2 label: LABEL_REPEATED type: TYPE_STRING }"
+      "  field { name: \"c\" number: 3 label: LABEL_OPTIONAL type: TYPE_INT32 }"
+      "} "
+      "message_type { name: \"New\" "
+      "field { name: \"b\" number: 2 label: LABEL_REPEATED type: TYPE_STRING }"
+      "  field { name: \"a\" number: 1 label: LABEL_OPTIONAL type: TYPE_INT64 }"
+      "  field { name: \"d\" number: 4 label: LABEL_OPTIONAL type: TYPE_INT32 }"
+      "}",
+      &file));
+  ASSERT_TRUE(pool.BuildFile(file) != NULL);
+  const Descriptor* old_type = pool.FindMessageTypeByName("Old");
+  const Descriptor* new_type = pool.FindMessageTypeByName("New");
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> old_record(factory.GetPrototype(old_type)->New());
+  ASSERT_TRUE(TextFormat::ParseFromString("a: 1 b: \"x\" b: \"y\" c: 3",
+                                          old_record.get()));
+  ColumnarWriter writer(old_type);
+  writer.AddRecord(*old_record);
+  string data;
+  writer.SerializeToString(&data);
+
+  ColumnarReader reader(new_type);
+  ASSERT_TRUE(reader.ParseFromString(data));
+  vector<string> columns;
+  reader.ListColumns(&columns);
+  ASSERT_EQ(1, columns.size());
+  EXPECT_EQ("b", columns[0]);
+
+  columns.push_back("a");
+  columns.push_back("d");
+  ASSERT_TRUE(reader.SelectColumns(columns));
+  scoped_ptr<Message> new_record(factory.GetPrototype(new_type)->New());
+  ASSERT_TRUE(reader.ReadRecord(new_record.get()));
+  EXPECT_EQ("b: \"x\"\nb: \"y\"\n", new_record->DebugString());
+}
+
+TEST(ColumnarTest, Malformed) {
+  vector<unittest::TestAllTypes> records = MakeRecords();
+  records.resize(8);
+  string data = WriteRecords(records);
+
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  EXPECT_FALSE(reader.ParseFromString(data.substr(0, data.size() - 1)));
+  EXPECT_FALSE(reader.ParseFromString(data + "x"));
+  EXPECT_EQ(0, reader.record_count());
+
+  // Damaged data must be rejected or read as something, but not crash.
+  vector<string> columns;
+  ASSERT_TRUE(reader.ParseFromString(data));
+  reader.ListColumns(&columns);
+  unittest::TestAllTypes record;
+  ScopedMemoryLog log;
+  for (int i = 0; i < data.size(); i++) {
+    string damaged = data;
+    damaged[i] ^= 1;
+    if (!reader.ParseFromString(damaged)) continue;
+    if (!reader.SelectColumns(columns)) continue;
+    for (int j = 0; j < reader.record_count(); j++) {
+      if (!reader.ReadRecord(&record)) break;
+    }
+  }
+}
+
+// Returns data holding only an optional_int32 column, which claims to have
+// the given number of entries, all in one run of the given length.
+string WriteLongRun(uint32 record_count, uint32 count, uint32 run) {
+  string column;
+  {
+    io::StringOutputStream column_output(&column);
+    io::CodedOutputStream coded_output(&column_output);
+    coded_output.WriteVarint32(count);
+    for (int i = 0; i < 2; i++) {
+      // Repetition level 0, then definition level 0: all entries are empty.
+      coded_output.WriteVarint32(
+          io::CodedOutputStream::VarintSize32(run) + 1);
+      coded_output.WriteVarint32(run);
+      coded_output.WriteVarint32(0);
+    }
+    coded_output.WriteRaw("\002", 1);  // RUN_LENGTH, with no values.
+  }
+
+  string data;
+  {
+    io::StringOutputStream string_output(&data);
+    io::CodedOutputStream coded_output(&string_output);
+    coded_output.WriteVarint32(record_count);
+    coded_output.WriteVarint32(1);
+    coded_output.WriteVarint32(strlen("optional_int32"));
+    coded_output.WriteString("optional_int32");
+    coded_output.WriteVarint32(FieldDescriptor::CPPTYPE_INT32);
+    coded_output.WriteVarint32(0);
+    coded_output.WriteVarint32(1);
+    coded_output.WriteVarint32(column.size());
+    coded_output.WriteString(column);
+  }
+  return data;
+}
+
+TEST(ColumnarTest, MalformedCounts) {
+  ColumnarReader reader(unittest::TestAllTypes::descriptor());
+  RepeatedField<int32> values;
+
+  // The well-formed version: three records without the field.
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, 3, 3)));
+  EXPECT_TRUE(reader.ReadColumn("optional_int32", &values));
+  EXPECT_EQ(0, values.size());
+
+  ScopedMemoryLog log;
+  // Entry counts which don't fit in an int, or which would take gigabytes
+  // once decoded, are rejected before anything is allocated.
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, kuint32max, 3)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+  ASSERT_TRUE(reader.ParseFromString(
+      WriteLongRun(kint32max, kint32max, kint32max)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+  ASSERT_TRUE(reader.ParseFromString(
+      WriteLongRun(1 << 30, 1 << 30, 1 << 30)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+
+  // Runs must add up to exactly the entry count.
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, 3, kuint32max)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, 3, 4)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, 4, 3)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+
+  // Fewer entries than records.
+  ASSERT_TRUE(reader.ParseFromString(WriteLongRun(3, 2, 2)));
+  EXPECT_FALSE(reader.ReadColumn("optional_int32", &values));
+
+  EXPECT_EQ(0, values.size());
+  EXPECT_EQ(7, log.GetMessages(ERROR).size());
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -38,6 +38,7 @@
 #include <google/protobuf/compiler/cpp/cpp_string_field.h>
 #include <google/protobuf/compiler/cpp/cpp_enum_field.h>
 #include <google/protobuf/compiler/cpp/cpp_message_field.h>
+#include <google/protobuf/compiler/cpp/cpp_map_field.h>
 #include <google/protobuf/descriptor.pb.h>
 #include <google/protobuf/wire_format.h>
 #include <google/protobuf/io/printer.h>
@@ -64,6 +65,34 @@ void SetCommonFieldVariables(const FieldDescriptor* descriptor,
   (*variables)["deprecation"] = descriptor->options().deprecated()
       ? " PROTOBUF_DEPRECATED" : "";
 
+  if (descriptor->containing_oneof() != NULL) {
+    const OneofDescriptor* oneof = descriptor->containing_oneof();
+    (*variables)["oneof_name"] = oneof->name();
+    (*variables)["oneof_index"] = SimpleItoa(oneof->index());
+    (*variables)["oneof_case"] = OneofCaseConstantName(descriptor);
+  }
+}
+
+void SetAllocationProfilingVariables(const FieldDescriptor* descriptor,
+                                     const Options& options,
+                                     const string& source,
+                                     const string& size,
+                                     map<string, string>* variables) {
+  if (!options.profile_allocations) {
+    (*variables)["sample_allocation"] = "";
+    (*variables)["allocation_context"] = "";
+    return;
+  }
+
+  string names = "\"" + descriptor->containing_type()->full_name() +
+                 "\", \"" + descriptor->name() + "\"";
+  (*variables)["sample_allocation"] =
+      "    ::google::protobuf::internal::SampleFieldAllocation(\n"
+      "        ::google::protobuf::AllocationProfiler::" + source + ",\n"
+      "        " + size + ", " + names + ");\n";
+  (*variables)["allocation_context"] =
+      "  ::google::protobuf::internal::AllocationContext allocation_context(\n"
+      "      " + names + ");\n";
 }
 
 FieldGenerator::~FieldGenerator() {}
@@ -80,41 +109,65 @@ GenerateMergeFromCodedStreamWithPacking(io::Printer* printer) const {
 
 }
 
-FieldGeneratorMap::FieldGeneratorMap(const Descriptor* descriptor)
+FieldGeneratorMap::FieldGeneratorMap(const Descriptor* descriptor,
+                                     const Options& options)
   : descriptor_(descriptor),
     field_generators_(
       new scoped_ptr<FieldGenerator>[descriptor->field_count()]) {
   // Construct all the FieldGenerators.
   for (int i = 0; i < descriptor->field_count(); i++) {
-    field_generators_[i].reset(MakeGenerator(descriptor->field(i)));
+    field_generators_[i].reset(MakeGenerator(descriptor->field(i), options));
   }
 }
 
-FieldGenerator* FieldGeneratorMap::MakeGenerator(const FieldDescriptor* field) {
-  if (field->is_repeated()) {
+FieldGenerator* FieldGeneratorMap::MakeGenerator(const FieldDescriptor* field,
+                                                 const Options& options) {
+  if (IsMapField(field)) {
+    return new MapFieldGenerator(field, options);
+  } else if (field->is_repeated()) {
     switch (field->cpp_type()) {
       case FieldDescriptor::CPPTYPE_MESSAGE:
-        return new RepeatedMessageFieldGenerator(field);
+        if (IsSlabField(field)) {
+          return new SlabRepeatedMessageFieldGenerator(field, options);
+        }
+        return new RepeatedMessageFieldGenerator(field, options);
       case FieldDescriptor::CPPTYPE_STRING:
         switch (field->options().ctype()) {
+          case FieldOptions::STRING_PIECE:
+            return new RepeatedStringPieceFieldGenerator(field, options);
           default:  // RepeatedStringFieldGenerator handles unknown ctypes.
           case FieldOptions::STRING:
-            return new RepeatedStringFieldGenerator(field);
+            return new RepeatedStringFieldGenerator(field, options);
         }
       case FieldDescriptor::CPPTYPE_ENUM:
         return new RepeatedEnumFieldGenerator(field);
       default:
         return new RepeatedPrimitiveFieldGenerator(field);
     }
+  } else if (field->containing_oneof() != NULL) {
+    switch (field->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_MESSAGE:
+        return new MessageOneofFieldGenerator(field, options);
+      case FieldDescriptor::CPPTYPE_STRING:
+        switch (field->options().ctype()) {
+          default:  // StringOneofFieldGenerator handles unknown ctypes.
+          case FieldOptions::STRING:
+            return new StringOneofFieldGenerator(field, options);
+        }
+      case FieldDescriptor::CPPTYPE_ENUM:
+        return new EnumOneofFieldGenerator(field);
+      default:
+        return new PrimitiveOneofFieldGenerator(field);
+    }
   } else {
     switch (field->cpp_type()) {
       case FieldDescriptor::CPPTYPE_MESSAGE:
-        return new MessageFieldGenerator(field);
+        return new MessageFieldGenerator(field, options);
       case FieldDescriptor::CPPTYPE_STRING:
         switch (field->options().ctype()) {
           default:  // StringFieldGenerator handles unknown ctypes.
           case FieldOptions::STRING:
-            return new StringFieldGenerator(field);
+            return new StringFieldGenerator(field, options);
         }
       case FieldDescriptor::CPPTYPE_ENUM:
         return new EnumFieldGenerator(field);
@@ -40,6 +40,7 @@
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/descriptor.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 namespace google {
 namespace protobuf {
@@ -55,10 +56,22 @@ namespace cpp {
 // Helper function: set variables in the map that are the same for all
 // field code generators.
 // ['name', 'index', 'number', 'classname', 'declared_type', 'tag_size',
-// 'deprecation'].
+// 'deprecation'], plus ['oneof_name', 'oneof_index', 'oneof_case'] for
+// members of a oneof.
 void SetCommonFieldVariables(const FieldDescriptor* descriptor,
                              map<string, string>* variables);
 
+// Helper function: set the variables used to report a field's allocations
+// when the profile_allocations option is set, or to nothing when it is not.
+// 'sample_allocation' is a statement reporting an allocation of the given
+// AllocationProfiler::Source and size; 'allocation_context' declares an
+// AllocationContext naming the field.
+void SetAllocationProfilingVariables(const FieldDescriptor* descriptor,
+                                     const Options& options,
+                                     const string& source,
+                                     const string& size,
+                                     map<string, string>* variables);
+
 class FieldGenerator {
  public:
   FieldGenerator() {}
@@ -69,6 +82,12 @@ class FieldGenerator {
   // class.
   virtual void GeneratePrivateMembers(io::Printer* printer) const = 0;
 
+  // Generate declarations of static members of the message class needed by
+  // this field.  These are only generated separately from the private members
+  // for oneof fields, whose private members are placed inside a union.
+  // Most field types don't need this, so the default implementation is empty.
+  virtual void GenerateStaticMembers(io::Printer* printer) const {}
+
   // Generate prototypes for all of the accessor functions related to this
   // field.  These are placed inside the class definition.
   virtual void GenerateAccessorDeclarations(io::Printer* printer) const = 0;
@@ -144,7 +163,7 @@ class FieldGenerator {
 // Convenience class which constructs FieldGenerators for a Descriptor.
 class FieldGeneratorMap {
  public:
-  explicit FieldGeneratorMap(const Descriptor* descriptor);
+  FieldGeneratorMap(const Descriptor* descriptor, const Options& options);
   ~FieldGeneratorMap();
 
   const FieldGenerator& get(const FieldDescriptor* field) const;
@@ -153,7 +172,8 @@ class FieldGeneratorMap {
   const Descriptor* descriptor_;
   scoped_array<scoped_ptr<FieldGenerator> > field_generators_;
 
-  static FieldGenerator* MakeGenerator(const FieldDescriptor* field);
+  static FieldGenerator* MakeGenerator(const FieldDescriptor* field,
+                                       const Options& options);
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FieldGeneratorMap);
 };
@@ -51,7 +51,7 @@ namespace cpp {
 // ===================================================================
 
 FileGenerator::FileGenerator(const FileDescriptor* file,
-                             const string& dllexport_decl)
+                             const Options& options)
   : file_(file),
     message_generators_(
       new scoped_ptr<MessageGenerator>[file->message_type_count()]),
@@ -61,26 +61,26 @@ FileGenerator::FileGenerator(const FileDescriptor* file,
       new scoped_ptr<ServiceGenerator>[file->service_count()]),
     extension_generators_(
       new scoped_ptr<ExtensionGenerator>[file->extension_count()]),
-    dllexport_decl_(dllexport_decl) {
+    options_(options) {
 
   for (int i = 0; i < file->message_type_count(); i++) {
     message_generators_[i].reset(
-      new MessageGenerator(file->message_type(i), dllexport_decl));
+      new MessageGenerator(file->message_type(i), options));
   }
 
   for (int i = 0; i < file->enum_type_count(); i++) {
     enum_generators_[i].reset(
-      new EnumGenerator(file->enum_type(i), dllexport_decl));
+      new EnumGenerator(file->enum_type(i), options.dllexport_decl));
   }
 
   for (int i = 0; i < file->service_count(); i++) {
     service_generators_[i].reset(
-      new ServiceGenerator(file->service(i), dllexport_decl));
+      new ServiceGenerator(file->service(i), options.dllexport_decl));
   }
 
   for (int i = 0; i < file->extension_count(); i++) {
     extension_generators_[i].reset(
-      new ExtensionGenerator(file->extension(i), dllexport_decl));
+      new ExtensionGenerator(file->extension(i), options.dllexport_decl));
   }
 
   SplitStringUsing(file_->package(), ".", &package_parts_);
@@ -137,6 +137,26 @@ void FileGenerator::GenerateHeader(io::Printer* printer) {
       "#include <google/protobuf/generated_message_reflection.h>\n");
   }
 
+  if (HasMapFields(file_)) {
+    printer->Print(
+      "#include <google/protobuf/map_field.h>\n");
+  }
+
+  if (HasSlabFields(file_)) {
+    printer->Print(
+      "#include <google/protobuf/slab_repeated_field.h>\n");
+  }
+
+  if (HasStringPieceFields(file_)) {
+    printer->Print(
+      "#include <google/protobuf/repeated_string_piece_field.h>\n");
+  }
+
+  if (options_.profile_allocations) {
+    printer->Print(
+      "#include <google/protobuf/allocation_profiler.h>\n");
+  }
+
   if (HasGenericServices(file_)) {
     printer->Print(
       "#include <google/protobuf/service.h>\n");
@@ -162,7 +182,7 @@ void FileGenerator::GenerateHeader(io::Printer* printer) {
     "// Internal implementation detail -- do not call these.\n"
     "void $dllexport_decl$ $adddescriptorsname$();\n",
     "adddescriptorsname", GlobalAddDescriptorsName(file_->name()),
-    "dllexport_decl", dllexport_decl_);
+    "dllexport_decl", options_.dllexport_decl);
 
   printer->Print(
     // Note that we don't put dllexport_decl on these because they are only
@@ -300,6 +320,11 @@ void FileGenerator::GenerateSource(io::Printer* printer) {
       "#include <google/protobuf/wire_format.h>\n");
   }
 
+  if (options_.profile_messages) {
+    printer->Print(
+      "#include <google/protobuf/message_profiler.h>\n");
+  }
+
   printer->Print(
     "// @@protoc_insertion_point(includes)\n");
 
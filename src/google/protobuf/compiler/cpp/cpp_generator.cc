@@ -61,12 +61,6 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   // -----------------------------------------------------------------
   // parse generator options
 
-  // TODO(kenton):  If we ever have more options, we may want to create a
-  //   class that encapsulates them which we can pass down to all the
-  //   generator classes.  Currently we pass dllexport_decl down to all of
-  //   them via the constructors, but we don't want to have to add another
-  //   constructor parameter for every option.
-
   // If the dllexport_decl option is passed to the compiler, we need to write
   // it in front of every symbol that should be exported if this .proto is
   // compiled into a Windows DLL.  E.g., if the user invokes the protocol
@@ -78,11 +72,24 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   //   }
   // FOO_EXPORT is a macro which should expand to __declspec(dllexport) or
   // __declspec(dllimport) depending on what is being compiled.
-  string dllexport_decl;
+  //
+  // If the profile_messages option is passed, the generated parsing,
+  // serialization and ByteSize() methods report each call to the installed
+  // MessageProfiler (see message_profiler.h), including calls for embedded
+  // messages.
+  //
+  // If the profile_allocations option is passed, string and message fields
+  // report the memory they allocate to the installed AllocationProfiler
+  // (see allocation_profiler.h), attributed to the field.
+  Options file_options;
 
   for (int i = 0; i < options.size(); i++) {
     if (options[i].first == "dllexport_decl") {
-      dllexport_decl = options[i].second;
+      file_options.dllexport_decl = options[i].second;
+    } else if (options[i].first == "profile_messages") {
+      file_options.profile_messages = true;
+    } else if (options[i].first == "profile_allocations") {
+      file_options.profile_allocations = true;
     } else {
       *error = "Unknown generator option: " + options[i].first;
       return false;
@@ -95,7 +102,7 @@ bool CppGenerator::Generate(const FileDescriptor* file,
   string basename = StripProto(file->name());
   basename.append(".pb");
 
-  FileGenerator file_generator(file, dllexport_decl);
+  FileGenerator file_generator(file, file_options);
 
   // Generate header.
   {
@@ -37,6 +37,7 @@
 #include <google/protobuf/stubs/hash.h>
 
 #include <google/protobuf/compiler/cpp/cpp_helpers.h>
+#include <google/protobuf/generated_message_reflection.h>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/stubs/strutil.h>
 #include <google/protobuf/stubs/substitute.h>
@@ -175,6 +176,24 @@ string FieldConstantName(const FieldDescriptor *field) {
   return result;
 }
 
+string OneofCaseEnumName(const OneofDescriptor* oneof) {
+  return UnderscoresToCamelCase(oneof->name(), true) + "Case";
+}
+
+string OneofUnionName(const OneofDescriptor* oneof) {
+  return UnderscoresToCamelCase(oneof->name(), true) + "Union";
+}
+
+string OneofCaseConstantName(const FieldDescriptor* field) {
+  return "k" + UnderscoresToCamelCase(field->name(), true);
+}
+
+string OneofNotSetConstantName(const OneofDescriptor* oneof) {
+  string result = oneof->name();
+  UpperString(&result);
+  return result + "_NOT_SET";
+}
+
 string FieldMessageTypeName(const FieldDescriptor* field) {
   // Note:  The Google-internal version of Protocol Buffers uses this function
   //   as a hook point for hacks to support legacy code.
@@ -335,6 +354,72 @@ string GlobalShutdownFileName(const string& filename) {
   return "protobuf_ShutdownFile_" + FilenameIdentifier(filename);
 }
 
+bool IsMapField(const FieldDescriptor* field) {
+  // Generated code must store the field the way reflection expects.
+  return internal::IsMapField(field);
+}
+
+static bool HasMapFields(const Descriptor* descriptor) {
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (IsMapField(descriptor->field(i))) return true;
+  }
+  for (int i = 0; i < descriptor->nested_type_count(); i++) {
+    if (HasMapFields(descriptor->nested_type(i))) return true;
+  }
+  return false;
+}
+
+bool HasMapFields(const FileDescriptor* file) {
+  for (int i = 0; i < file->message_type_count(); i++) {
+    if (HasMapFields(file->message_type(i))) return true;
+  }
+  return false;
+}
+
+bool IsSlabField(const FieldDescriptor* field) {
+  // Generated code must store the field the way reflection expects.
+  return internal::IsSlabField(field);
+}
+
+static bool HasSlabFields(const Descriptor* descriptor) {
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (IsSlabField(descriptor->field(i))) return true;
+  }
+  for (int i = 0; i < descriptor->nested_type_count(); i++) {
+    if (HasSlabFields(descriptor->nested_type(i))) return true;
+  }
+  return false;
+}
+
+bool HasSlabFields(const FileDescriptor* file) {
+  for (int i = 0; i < file->message_type_count(); i++) {
+    if (HasSlabFields(file->message_type(i))) return true;
+  }
+  return false;
+}
+
+bool IsStringPieceField(const FieldDescriptor* field) {
+  // Generated code must store the field the way reflection expects.
+  return internal::IsStringPieceField(field);
+}
+
+static bool HasStringPieceFields(const Descriptor* descriptor) {
+  for (int i = 0; i < descriptor->field_count(); i++) {
+    if (IsStringPieceField(descriptor->field(i))) return true;
+  }
+  for (int i = 0; i < descriptor->nested_type_count(); i++) {
+    if (HasStringPieceFields(descriptor->nested_type(i))) return true;
+  }
+  return false;
+}
+
+bool HasStringPieceFields(const FileDescriptor* file) {
+  for (int i = 0; i < file->message_type_count(); i++) {
+    if (HasStringPieceFields(file->message_type(i))) return true;
+  }
+  return false;
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
@@ -72,6 +72,22 @@ string FieldName(const FieldDescriptor* field);
 // number constant.
 string FieldConstantName(const FieldDescriptor *field);
 
+// Get the name of the enum listing the cases of a oneof, e.g. "FooCase" for
+// a oneof named "foo".
+string OneofCaseEnumName(const OneofDescriptor* oneof);
+
+// Get the name of the union type holding the members of a oneof, e.g.
+// "FooUnion" for a oneof named "foo".
+string OneofUnionName(const OneofDescriptor* oneof);
+
+// Get the name of the enum constant for the oneof case in which the given
+// field is set, e.g. "kBarBaz" for a member named "bar_baz".
+string OneofCaseConstantName(const FieldDescriptor* field);
+
+// Get the name of the enum constant for the oneof case in which no member is
+// set, e.g. "FOO_NOT_SET" for a oneof named "foo".
+string OneofNotSetConstantName(const OneofDescriptor* oneof);
+
 // Returns the scope where the field was defined (for extensions, this is
 // different from the message type to which the field applies).
 inline const Descriptor* FieldScope(const FieldDescriptor* field) {
@@ -147,6 +163,28 @@ inline bool HasFastArraySerialization(const FileDescriptor* file) {
   return file->options().optimize_for() == FileOptions::SPEED;
 }
 
+// Is this a map field which is stored in a MapField?  That is, was it declared
+// as "map<K, V>", with a key type which can be hashed?  Hand-written fields
+// with a map key are ordinary repeated fields.
+bool IsMapField(const FieldDescriptor* field);
+
+// Does this file declare any fields for which IsMapField() is true?
+bool HasMapFields(const FileDescriptor* file);
+
+// Is this a repeated message field with the contiguous option, which is
+// stored in a SlabRepeatedField?  Map fields never are.
+bool IsSlabField(const FieldDescriptor* field);
+
+// Does this file declare any fields for which IsSlabField() is true?
+bool HasSlabFields(const FileDescriptor* file);
+
+// Is this a repeated string or bytes field with ctype=STRING_PIECE, which is
+// stored in a RepeatedStringPieceField?
+bool IsStringPieceField(const FieldDescriptor* field);
+
+// Does this file declare any fields for which IsStringPieceField() is true?
+bool HasStringPieceFields(const FileDescriptor* file);
+
 
 }  // namespace cpp
 }  // namespace compiler
@@ -143,16 +143,22 @@ static bool HasRequiredFields(const Descriptor* type) {
   return HasRequiredFields(type, &already_seen);
 }
 
+// Returns true if the generated class keeps _children_initialized_ up to date
+// while parsing and so overrides IsInitializedAfterParse().
+static bool TracksChildInitialization(const Descriptor* type) {
+  return HasGeneratedMethods(type->file()) && HasRequiredFields(type);
+}
+
 }
 
 // ===================================================================
 
 MessageGenerator::MessageGenerator(const Descriptor* descriptor,
-                                   const string& dllexport_decl)
+                                   const Options& options)
   : descriptor_(descriptor),
     classname_(ClassName(descriptor, false)),
-    dllexport_decl_(dllexport_decl),
-    field_generators_(descriptor),
+    options_(options),
+    field_generators_(descriptor, options),
     nested_generators_(new scoped_ptr<MessageGenerator>[
       descriptor->nested_type_count()]),
     enum_generators_(new scoped_ptr<EnumGenerator>[
@@ -162,17 +168,18 @@ MessageGenerator::MessageGenerator(const Descriptor* descriptor,
 
   for (int i = 0; i < descriptor->nested_type_count(); i++) {
     nested_generators_[i].reset(
-      new MessageGenerator(descriptor->nested_type(i), dllexport_decl));
+      new MessageGenerator(descriptor->nested_type(i), options));
   }
 
   for (int i = 0; i < descriptor->enum_type_count(); i++) {
     enum_generators_[i].reset(
-      new EnumGenerator(descriptor->enum_type(i), dllexport_decl));
+      new EnumGenerator(descriptor->enum_type(i), options.dllexport_decl));
   }
 
   for (int i = 0; i < descriptor->extension_count(); i++) {
     extension_generators_[i].reset(
-      new ExtensionGenerator(descriptor->extension(i), dllexport_decl));
+      new ExtensionGenerator(descriptor->extension(i),
+                             options.dllexport_decl));
   }
 }
 
@@ -235,6 +242,30 @@ GenerateFieldAccessorDeclarations(io::Printer* printer) {
     printer->Print("\n");
   }
 
+  // Generate the case enum and accessors for each oneof.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    map<string, string> vars;
+    vars["oneof_name"] = oneof->name();
+    vars["case_enum"] = OneofCaseEnumName(oneof);
+
+    printer->Print(vars, "enum $case_enum$ {\n");
+    printer->Indent();
+    for (int j = 0; j < oneof->field_count(); j++) {
+      printer->Print("$constant$ = $number$,\n",
+                     "constant", OneofCaseConstantName(oneof->field(j)),
+                     "number", SimpleItoa(oneof->field(j)->number()));
+    }
+    printer->Print("$not_set$ = 0\n",
+                   "not_set", OneofNotSetConstantName(oneof));
+    printer->Outdent();
+    printer->Print(vars,
+      "};\n"
+      "inline $case_enum$ $oneof_name$_case() const;\n"
+      "void clear_$oneof_name$();\n"
+      "\n");
+  }
+
   if (descriptor_->extension_range_count() > 0) {
     // Generate accessors for extensions.  We just call a macro located in
     // extension_set.h since the accessors about 80 lines of static code.
@@ -262,6 +293,15 @@ GenerateFieldAccessorDefinitions(io::Printer* printer) {
         "inline int $classname$::$name$_size() const {\n"
         "  return $name$_.size();\n"
         "}\n");
+    } else if (field->containing_oneof() != NULL) {
+      // Oneof members are set when the oneof's case names them.
+      printer->Print(vars,
+        "inline bool $classname$::has_$name$() const {\n"
+        "  return $oneof_name$_case() == $oneof_case$;\n"
+        "}\n"
+        "inline void $classname$::set_has_$name$() {\n"
+        "  _oneof_case_[$oneof_index$] = $oneof_case$;\n"
+        "}\n");
     } else {
       // Singular field.
       printer->Print(vars,
@@ -275,10 +315,20 @@ GenerateFieldAccessorDefinitions(io::Printer* printer) {
       "inline void $classname$::clear_$name$() {\n");
 
     printer->Indent();
-    field_generators_.get(field).GenerateClearingCode(printer);
+    if (field->containing_oneof() != NULL) {
+      // Clearing an inactive member must not disturb the active one.
+      printer->Print(vars, "if (has_$name$()) {\n");
+      printer->Indent();
+      field_generators_.get(field).GenerateClearingCode(printer);
+      printer->Print(vars, "clear_has_$oneof_name$();\n");
+      printer->Outdent();
+      printer->Print("}\n");
+    } else {
+      field_generators_.get(field).GenerateClearingCode(printer);
+    }
     printer->Outdent();
 
-    if (!field->is_repeated()) {
+    if (!field->is_repeated() && field->containing_oneof() == NULL) {
       printer->Print(vars, "  _clear_bit($index$);\n");
     }
 
@@ -289,6 +339,27 @@ GenerateFieldAccessorDefinitions(io::Printer* printer) {
 
     printer->Print("\n");
   }
+
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    map<string, string> vars;
+    vars["classname"] = classname_;
+    vars["oneof_name"] = oneof->name();
+    vars["oneof_index"] = SimpleItoa(oneof->index());
+    vars["case_enum"] = OneofCaseEnumName(oneof);
+    vars["not_set"] = OneofNotSetConstantName(oneof);
+    printer->Print(vars,
+      "inline bool $classname$::has_$oneof_name$() const {\n"
+      "  return $oneof_name$_case() != $not_set$;\n"
+      "}\n"
+      "inline void $classname$::clear_has_$oneof_name$() {\n"
+      "  _oneof_case_[$oneof_index$] = $not_set$;\n"
+      "}\n"
+      "inline $classname$::$case_enum$ $classname$::$oneof_name$_case() const {\n"
+      "  return $classname$::$case_enum$(_oneof_case_[$oneof_index$]);\n"
+      "}\n"
+      "\n");
+  }
 }
 
 void MessageGenerator::
@@ -303,10 +374,10 @@ GenerateClassDefinition(io::Printer* printer) {
   map<string, string> vars;
   vars["classname"] = classname_;
   vars["field_count"] = SimpleItoa(descriptor_->field_count());
-  if (dllexport_decl_.empty()) {
+  if (options_.dllexport_decl.empty()) {
     vars["dllexport"] = "";
   } else {
-    vars["dllexport"] = dllexport_decl_ + " ";
+    vars["dllexport"] = options_.dllexport_decl + " ";
   }
   vars["superclass"] = SuperClassName(descriptor_);
 
@@ -383,6 +454,10 @@ GenerateClassDefinition(io::Printer* printer) {
       printer->Print(
         "::google::protobuf::uint8* SerializeWithCachedSizesToArray(::google::protobuf::uint8* output) const;\n");
     }
+    if (TracksChildInitialization(descriptor_)) {
+      printer->Print(
+        "bool IsInitializedAfterParse() const;\n");
+    }
   }
 
   printer->Print(vars,
@@ -461,11 +536,46 @@ GenerateClassDefinition(io::Printer* printer) {
 
   // TODO(kenton):  Make _cached_size_ an atomic<int> when C++ supports it.
   printer->Print(
-    "mutable int _cached_size_;\n"
-    "\n");
+    "mutable int _cached_size_;\n");
+  if (TracksChildInitialization(descriptor_)) {
+    // Cleared whenever the parser reads a sub-message which is not itself
+    // initialized.  See IsInitializedAfterParse().
+    printer->Print(
+      "bool _children_initialized_;\n");
+  }
+  printer->Print("\n");
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    const FieldDescriptor* field = descriptor_->field(i);
+    if (field->containing_oneof() == NULL) {
+      field_generators_.get(field).GeneratePrivateMembers(printer);
+    }
+  }
+
+  // The members of each oneof share storage in a union.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    for (int j = 0; j < oneof->field_count(); j++) {
+      printer->Print("inline void set_has_$name$();\n",
+                     "name", FieldName(oneof->field(j)));
+    }
+    printer->Print(
+      "inline bool has_$oneof_name$() const;\n"
+      "inline void clear_has_$oneof_name$();\n"
+      "union $union_name$ {\n",
+      "oneof_name", oneof->name(),
+      "union_name", OneofUnionName(oneof));
+    printer->Indent();
+    for (int j = 0; j < oneof->field_count(); j++) {
+      field_generators_.get(oneof->field(j)).GeneratePrivateMembers(printer);
+    }
+    printer->Outdent();
+    printer->Print(
+      "} $oneof_name$_;\n",
+      "oneof_name", oneof->name());
+  }
   for (int i = 0; i < descriptor_->field_count(); i++) {
     field_generators_.get(descriptor_->field(i))
-                     .GeneratePrivateMembers(printer);
+                     .GenerateStaticMembers(printer);
   }
 
   // Declare AddDescriptors(), BuildDescriptors(), and ShutdownFile() as
@@ -473,7 +583,7 @@ GenerateClassDefinition(io::Printer* printer) {
   // default_instance_ and reflection_.
   printer->Print(
     "friend void $dllexport_decl$ $adddescriptorsname$();\n",
-    "dllexport_decl", dllexport_decl_,
+    "dllexport_decl", options_.dllexport_decl,
     "adddescriptorsname",
       GlobalAddDescriptorsName(descriptor_->file()->name()));
   printer->Print(
@@ -497,6 +607,12 @@ GenerateClassDefinition(io::Printer* printer) {
       "::google::protobuf::uint32 _has_bits_[1];\n");
   }
 
+  if (descriptor_->oneof_decl_count() > 0) {
+    printer->Print(
+      "::google::protobuf::uint32 _oneof_case_[$oneof_decl_count$];\n",
+      "oneof_decl_count", SimpleItoa(descriptor_->oneof_decl_count()));
+  }
+
   printer->Print(
     "\n"
     "// WHY DOES & HAVE LOWER PRECEDENCE THAN != !?\n"
@@ -592,7 +708,14 @@ GenerateDescriptorInitializer(io::Printer* printer, int index) {
   printer->Print(vars,
     "    ::google::protobuf::DescriptorPool::generated_pool(),\n"
     "    ::google::protobuf::MessageFactory::generated_factory(),\n"
-    "    sizeof($classname$));\n");
+    "    sizeof($classname$)");
+  if (descriptor_->oneof_decl_count() > 0) {
+    printer->Print(vars,
+      ",\n"
+      "    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET("
+        "$classname$, _oneof_case_[0])");
+  }
+  printer->Print(");\n");
 
   // Handle nested types.
   for (int i = 0; i < descriptor_->nested_type_count(); i++) {
@@ -688,6 +811,8 @@ GenerateClassMethods(io::Printer* printer) {
                      .GenerateNonInlineAccessorDefinitions(printer);
   }
 
+  GenerateOneofClear(printer);
+
   // Generate field number constants.
   printer->Print("#ifndef _MSC_VER\n");
   for (int i = 0; i < descriptor_->field_count(); i++) {
@@ -735,6 +860,11 @@ GenerateClassMethods(io::Printer* printer) {
 
     GenerateIsInitialized(printer);
     printer->Print("\n");
+
+    if (TracksChildInitialization(descriptor_)) {
+      GenerateIsInitializedAfterParse(printer);
+      printer->Print("\n");
+    }
   }
 
   GenerateSwap(printer);
@@ -763,6 +893,46 @@ GenerateClassMethods(io::Printer* printer) {
 
 }
 
+void MessageGenerator::
+GenerateOneofClear(io::Printer* printer) {
+  // Generate clear_$oneof_name$(), which releases the active member.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    map<string, string> vars;
+    vars["classname"] = classname_;
+    vars["oneof_name"] = oneof->name();
+    vars["oneof_index"] = SimpleItoa(oneof->index());
+    vars["not_set"] = OneofNotSetConstantName(oneof);
+
+    printer->Print(vars,
+      "void $classname$::clear_$oneof_name$() {\n"
+      "  switch ($oneof_name$_case()) {\n");
+    printer->Indent();
+    printer->Indent();
+    for (int j = 0; j < oneof->field_count(); j++) {
+      const FieldDescriptor* field = oneof->field(j);
+      printer->Print(
+        "case $constant$: {\n",
+        "constant", OneofCaseConstantName(field));
+      printer->Indent();
+      field_generators_.get(field).GenerateClearingCode(printer);
+      printer->Print("break;\n");
+      printer->Outdent();
+      printer->Print("}\n");
+    }
+    printer->Print(vars,
+      "case $not_set$: {\n"
+      "  break;\n"
+      "}\n");
+    printer->Outdent();
+    printer->Print(vars,
+      "}\n"
+      "_oneof_case_[$oneof_index$] = $not_set$;\n");
+    printer->Outdent();
+    printer->Print("}\n\n");
+  }
+}
+
 void MessageGenerator::
 GenerateOffsets(io::Printer* printer) {
   printer->Print(
@@ -773,10 +943,12 @@ GenerateOffsets(io::Printer* printer) {
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
+    // All members of a oneof are stored at the offset of its union.
     printer->Print(
       "GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET($classname$, $name$_),\n",
       "classname", classname_,
-      "name", FieldName(field));
+      "name", field->containing_oneof() == NULL ?
+                FieldName(field) : field->containing_oneof()->name());
   }
 
   printer->Outdent();
@@ -792,6 +964,10 @@ GenerateSharedConstructorCode(io::Printer* printer) {
 
   printer->Print(
     "_cached_size_ = 0;\n");
+  if (TracksChildInitialization(descriptor_)) {
+    printer->Print(
+      "_children_initialized_ = true;\n");
+  }
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
     field_generators_.get(descriptor_->field(i))
@@ -801,6 +977,12 @@ GenerateSharedConstructorCode(io::Printer* printer) {
   printer->Print(
     "::memset(_has_bits_, 0, sizeof(_has_bits_));\n");
 
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+      "clear_has_$oneof_name$();\n",
+      "oneof_name", descriptor_->oneof_decl(i)->name());
+  }
+
   printer->Outdent();
   printer->Print("}\n\n");
 }
@@ -817,6 +999,15 @@ GenerateSharedDestructorCode(io::Printer* printer) {
                      .GenerateDestructorCode(printer);
   }
 
+  // Deletes the active member of each oneof, if it owns any memory.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+      "if (has_$oneof_name$()) {\n"
+      "  clear_$oneof_name$();\n"
+      "}\n",
+      "oneof_name", descriptor_->oneof_decl(i)->name());
+  }
+
   printer->Print(
     "if (this != default_instance_) {\n");
 
@@ -827,7 +1018,7 @@ GenerateSharedDestructorCode(io::Printer* printer) {
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated() &&
+    if (!field->is_repeated() && field->containing_oneof() == NULL &&
         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
       printer->Print("  delete $name$_;\n",
                      "name", FieldName(field));
@@ -865,10 +1056,12 @@ GenerateStructors(io::Printer* printer) {
   // constructed yet at that time.
   // TODO(kenton):  Maybe all message fields (even for non-default messages)
   //   should be initialized to point at default instances rather than NULL?
+  // Members of a oneof are not set in the default instance, so they don't
+  // need this.
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated() &&
+    if (!field->is_repeated() && field->containing_oneof() == NULL &&
         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
       printer->Print(
           "  $name$_ = const_cast< $type$*>(&$type$::default_instance());\n",
@@ -960,7 +1153,7 @@ GenerateClear(io::Printer* printer) {
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated()) {
+    if (!field->is_repeated() && field->containing_oneof() == NULL) {
       map<string, string> vars;
       vars["index"] = SimpleItoa(field->index());
 
@@ -1017,8 +1210,19 @@ GenerateClear(io::Printer* printer) {
     }
   }
 
+  // Only the active member of each oneof needs clearing.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    printer->Print(
+      "clear_$oneof_name$();\n",
+      "oneof_name", descriptor_->oneof_decl(i)->name());
+  }
+
   printer->Print(
     "::memset(_has_bits_, 0, sizeof(_has_bits_));\n");
+  if (TracksChildInitialization(descriptor_)) {
+    printer->Print(
+      "_children_initialized_ = true;\n");
+  }
 
   if (HasUnknownFields(descriptor_->file())) {
     printer->Print(
@@ -1044,6 +1248,14 @@ GenerateSwap(io::Printer* printer) {
       field_generators_.get(field).GenerateSwappingCode(printer);
     }
 
+    for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+      printer->Print(
+        "std::swap($oneof_name$_, other->$oneof_name$_);\n"
+        "std::swap(_oneof_case_[$i$], other->_oneof_case_[$i$]);\n",
+        "oneof_name", descriptor_->oneof_decl(i)->name(),
+        "i", SimpleItoa(i));
+    }
+
     for (int i = 0; i < (descriptor_->field_count() + 31) / 32; ++i) {
       printer->Print("std::swap(_has_bits_[$i$], other->_has_bits_[$i$]);\n",
                      "i", SimpleItoa(i));
@@ -1053,6 +1265,10 @@ GenerateSwap(io::Printer* printer) {
       printer->Print("_unknown_fields_.Swap(&other->_unknown_fields_);\n");
     }
     printer->Print("std::swap(_cached_size_, other->_cached_size_);\n");
+    if (TracksChildInitialization(descriptor_)) {
+      printer->Print(
+        "std::swap(_children_initialized_, other->_children_initialized_);\n");
+    }
     if (descriptor_->extension_range_count() > 0) {
       printer->Print("_extensions_.Swap(&other->_extensions_);\n");
     }
@@ -1110,6 +1326,7 @@ GenerateMergeFrom(io::Printer* printer) {
     "void $classname$::MergeFrom(const $classname$& from) {\n"
     "  GOOGLE_CHECK_NE(&from, this);\n",
     "classname", classname_);
+  GenerateAllocationContext(printer);
   printer->Indent();
 
   // Merge Repeated fields. These fields do not require a
@@ -1128,7 +1345,7 @@ GenerateMergeFrom(io::Printer* printer) {
   for (int i = 0; i < descriptor_->field_count(); ++i) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated()) {
+    if (!field->is_repeated() && field->containing_oneof() == NULL) {
       map<string, string> vars;
       vars["index"] = SimpleItoa(field->index());
 
@@ -1161,6 +1378,33 @@ GenerateMergeFrom(io::Printer* printer) {
     printer->Print("}\n");
   }
 
+  // Merge the active member of each oneof.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    printer->Print(
+      "switch (from.$oneof_name$_case()) {\n",
+      "oneof_name", oneof->name());
+    printer->Indent();
+    for (int j = 0; j < oneof->field_count(); j++) {
+      const FieldDescriptor* field = oneof->field(j);
+      printer->Print(
+        "case $constant$: {\n",
+        "constant", OneofCaseConstantName(field));
+      printer->Indent();
+      field_generators_.get(field).GenerateMergingCode(printer);
+      printer->Print("break;\n");
+      printer->Outdent();
+      printer->Print("}\n");
+    }
+    printer->Print(
+      "case $not_set$: {\n"
+      "  break;\n"
+      "}\n",
+      "not_set", OneofNotSetConstantName(oneof));
+    printer->Outdent();
+    printer->Print("}\n");
+  }
+
   if (descriptor_->extension_range_count() > 0) {
     printer->Print("_extensions_.MergeFrom(from._extensions_);\n");
   }
@@ -1208,27 +1452,58 @@ GenerateCopyFrom(io::Printer* printer) {
   printer->Print("}\n");
 }
 
+void MessageGenerator::
+GenerateAllocationContext(io::Printer* printer) {
+  if (!options_.profile_allocations) return;
+
+  // Allocations made by the library on this message's behalf, such as for
+  // unknown fields, are attributed to the message itself.
+  printer->Print(
+    "  ::google::protobuf::internal::AllocationContext allocation_context(\n"
+    "      \"$full_name$\", NULL);\n",
+    "full_name", descriptor_->full_name());
+}
+
+void MessageGenerator::
+GenerateProfileScope(io::Printer* printer, const string& argument) {
+  if (!options_.profile_messages) return;
+
+  // The scope reports the call to the installed MessageProfiler, if any,
+  // when the method returns.
+  printer->Print(
+    "  ::google::protobuf::internal::MessageProfileScope profile_scope(\n"
+    "      this, \"$full_name$\", $argument$);\n",
+    "full_name", descriptor_->full_name(),
+    "argument", argument);
+}
+
 void MessageGenerator::
 GenerateMergeFromCodedStream(io::Printer* printer) {
   if (descriptor_->options().message_set_wire_format()) {
     // Special-case MessageSet.
     printer->Print(
       "bool $classname$::MergePartialFromCodedStream(\n"
-      "    ::google::protobuf::io::CodedInputStream* input) {\n"
+      "    ::google::protobuf::io::CodedInputStream* input) {\n",
+      "classname", classname_);
+    GenerateProfileScope(printer, "input");
+    GenerateAllocationContext(printer);
+    printer->Print(
       "  return _extensions_.ParseMessageSet(input, default_instance_,\n"
       "                                      mutable_unknown_fields());\n"
-      "}\n",
-      "classname", classname_);
+      "}\n");
     return;
   }
 
   printer->Print(
     "bool $classname$::MergePartialFromCodedStream(\n"
-    "    ::google::protobuf::io::CodedInputStream* input) {\n"
+    "    ::google::protobuf::io::CodedInputStream* input) {\n",
+    "classname", classname_);
+  GenerateProfileScope(printer, "input");
+  GenerateAllocationContext(printer);
+  printer->Print(
     "#define DO_(EXPRESSION) if (!(EXPRESSION)) return false\n"
     "  ::google::protobuf::uint32 tag;\n"
-    "  while ((tag = input->ReadTag()) != 0) {\n",
-    "classname", classname_);
+    "  while ((tag = input->ReadTag()) != 0) {\n");
 
   printer->Indent();
   printer->Indent();
@@ -1278,6 +1553,7 @@ GenerateMergeFromCodedStream(io::Printer* printer) {
         field_generator.GenerateMergeFromCodedStreamWithPacking(printer);
       } else {
         field_generator.GenerateMergeFromCodedStream(printer);
+        GenerateChildInitializationCheck(printer, field);
       }
       printer->Outdent();
 
@@ -1421,7 +1697,12 @@ void MessageGenerator::GenerateSerializeOneField(
     io::Printer* printer, const FieldDescriptor* field, bool to_array) {
   PrintFieldComment(printer, field);
 
-  if (!field->is_repeated()) {
+  if (field->containing_oneof() != NULL) {
+    printer->Print(
+      "if (has_$name$()) {\n",
+      "name", FieldName(field));
+    printer->Indent();
+  } else if (!field->is_repeated()) {
     printer->Print(
       "if (_has_bit($index$)) {\n",
       "index", SimpleItoa(field->index()));
@@ -1467,9 +1748,12 @@ GenerateSerializeWithCachedSizes(io::Printer* printer) {
     // Special-case MessageSet.
     printer->Print(
       "void $classname$::SerializeWithCachedSizes(\n"
-      "    ::google::protobuf::io::CodedOutputStream* output) const {\n"
-      "  _extensions_.SerializeMessageSetWithCachedSizes(output);\n",
+      "    ::google::protobuf::io::CodedOutputStream* output) const {\n",
       "classname", classname_);
+    GenerateProfileScope(printer,
+      "::google::protobuf::MessageProfiler::SERIALIZE");
+    printer->Print(
+      "  _extensions_.SerializeMessageSetWithCachedSizes(output);\n");
     if (HasUnknownFields(descriptor_->file())) {
       printer->Print(
         "  ::google::protobuf::internal::WireFormat::SerializeUnknownMessageSetItems(\n"
@@ -1484,6 +1768,8 @@ GenerateSerializeWithCachedSizes(io::Printer* printer) {
     "void $classname$::SerializeWithCachedSizes(\n"
     "    ::google::protobuf::io::CodedOutputStream* output) const {\n",
     "classname", classname_);
+  GenerateProfileScope(printer,
+    "::google::protobuf::MessageProfiler::SERIALIZE");
   printer->Indent();
 
   GenerateSerializeWithCachedSizesBody(printer, false);
@@ -1499,10 +1785,13 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) {
     // Special-case MessageSet.
     printer->Print(
       "::google::protobuf::uint8* $classname$::SerializeWithCachedSizesToArray(\n"
-      "    ::google::protobuf::uint8* target) const {\n"
-      "  target =\n"
-      "      _extensions_.SerializeMessageSetWithCachedSizesToArray(target);\n",
+      "    ::google::protobuf::uint8* target) const {\n",
       "classname", classname_);
+    GenerateProfileScope(printer,
+      "::google::protobuf::MessageProfiler::SERIALIZE");
+    printer->Print(
+      "  target =\n"
+      "      _extensions_.SerializeMessageSetWithCachedSizesToArray(target);\n");
     if (HasUnknownFields(descriptor_->file())) {
       printer->Print(
         "  target = ::google::protobuf::internal::WireFormat::\n"
@@ -1519,6 +1808,8 @@ GenerateSerializeWithCachedSizesToArray(io::Printer* printer) {
     "::google::protobuf::uint8* $classname$::SerializeWithCachedSizesToArray(\n"
     "    ::google::protobuf::uint8* target) const {\n",
     "classname", classname_);
+  GenerateProfileScope(printer,
+    "::google::protobuf::MessageProfiler::SERIALIZE");
   printer->Indent();
 
   GenerateSerializeWithCachedSizesBody(printer, true);
@@ -1586,9 +1877,12 @@ GenerateByteSize(io::Printer* printer) {
   if (descriptor_->options().message_set_wire_format()) {
     // Special-case MessageSet.
     printer->Print(
-      "int $classname$::ByteSize() const {\n"
-      "  int total_size = _extensions_.MessageSetByteSize();\n",
+      "int $classname$::ByteSize() const {\n",
       "classname", classname_);
+    GenerateProfileScope(printer,
+      "::google::protobuf::MessageProfiler::BYTE_SIZE");
+    printer->Print(
+      "  int total_size = _extensions_.MessageSetByteSize();\n");
     if (HasUnknownFields(descriptor_->file())) {
       printer->Print(
         "  total_size += ::google::protobuf::internal::WireFormat::\n"
@@ -1606,6 +1900,8 @@ GenerateByteSize(io::Printer* printer) {
   printer->Print(
     "int $classname$::ByteSize() const {\n",
     "classname", classname_);
+  GenerateProfileScope(printer,
+    "::google::protobuf::MessageProfiler::BYTE_SIZE");
   printer->Indent();
   printer->Print(
     "int total_size = 0;\n"
@@ -1616,7 +1912,7 @@ GenerateByteSize(io::Printer* printer) {
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
 
-    if (!field->is_repeated()) {
+    if (!field->is_repeated() && field->containing_oneof() == NULL) {
       // See above in GenerateClear for an explanation of this.
       // TODO(kenton):  Share code?  Unclear how to do so without
       //   over-engineering.
@@ -1666,6 +1962,35 @@ GenerateByteSize(io::Printer* printer) {
     }
   }
 
+  // At most one member of each oneof is set, so switch on the case rather
+  // than checking each member.
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor_->oneof_decl(i);
+    printer->Print(
+      "switch ($oneof_name$_case()) {\n",
+      "oneof_name", oneof->name());
+    printer->Indent();
+    for (int j = 0; j < oneof->field_count(); j++) {
+      const FieldDescriptor* field = oneof->field(j);
+      PrintFieldComment(printer, field);
+      printer->Print(
+        "case $constant$: {\n",
+        "constant", OneofCaseConstantName(field));
+      printer->Indent();
+      field_generators_.get(field).GenerateByteSize(printer);
+      printer->Print("break;\n");
+      printer->Outdent();
+      printer->Print("}\n");
+    }
+    printer->Print(
+      "case $not_set$: {\n"
+      "  break;\n"
+      "}\n",
+      "not_set", OneofNotSetConstantName(oneof));
+    printer->Outdent();
+    printer->Print("}\n");
+  }
+
   if (descriptor_->extension_range_count() > 0) {
     printer->Print(
       "total_size += _extensions_.ByteSize();\n"
@@ -1699,12 +2024,7 @@ GenerateByteSize(io::Printer* printer) {
 }
 
 void MessageGenerator::
-GenerateIsInitialized(io::Printer* printer) {
-  printer->Print(
-    "bool $classname$::IsInitialized() const {\n",
-    "classname", classname_);
-  printer->Indent();
-
+GenerateRequiredFieldChecks(io::Printer* printer) {
   // Check that all required fields in this message are set.  We can do this
   // most efficiently by checking 32 "has bits" at a time.
   int has_bits_array_size = (descriptor_->field_count() + 31) / 32;
@@ -1728,6 +2048,16 @@ GenerateIsInitialized(io::Printer* printer) {
         "mask", FastHex32ToBuffer(mask, buffer));
     }
   }
+}
+
+void MessageGenerator::
+GenerateIsInitialized(io::Printer* printer) {
+  printer->Print(
+    "bool $classname$::IsInitialized() const {\n",
+    "classname", classname_);
+  printer->Indent();
+
+  GenerateRequiredFieldChecks(printer);
 
   // Now check that all embedded messages are initialized.
   printer->Print("\n");
@@ -1763,6 +2093,59 @@ GenerateIsInitialized(io::Printer* printer) {
     "}\n");
 }
 
+void MessageGenerator::
+GenerateIsInitializedAfterParse(io::Printer* printer) {
+  // The sub-messages were checked as they were parsed, so unless one of them
+  // turned out to be incomplete only our own required fields are left.
+  // Extensions are parsed by the ExtensionSet, which does not record this,
+  // so they are still checked in full.
+  printer->Print(
+    "bool $classname$::IsInitializedAfterParse() const {\n"
+    "  if (!_children_initialized_) return IsInitialized();\n",
+    "classname", classname_);
+  printer->Indent();
+
+  GenerateRequiredFieldChecks(printer);
+
+  if (descriptor_->extension_range_count() > 0) {
+    printer->Print(
+      "if (!_extensions_.IsInitialized()) return false;\n");
+  }
+
+  printer->Outdent();
+  printer->Print(
+    "  return true;\n"
+    "}\n");
+}
+
+void MessageGenerator::
+GenerateChildInitializationCheck(io::Printer* printer,
+                                 const FieldDescriptor* field) {
+  if (field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE ||
+      !HasRequiredFields(field->message_type()) ||
+      !TracksChildInitialization(descriptor_)) {
+    return;
+  }
+
+  if (IsMapField(field)) {
+    // A duplicate key replaces an earlier entry, so the entry just parsed is
+    // not necessarily the last one.  Fall back to the full check.
+    printer->Print("_children_initialized_ = false;\n");
+  } else if (field->is_repeated()) {
+    printer->Print(
+      "if (!this->$name$(this->$name$_size() - 1).IsInitializedAfterParse()) {\n"
+      "  _children_initialized_ = false;\n"
+      "}\n",
+      "name", FieldName(field));
+  } else {
+    printer->Print(
+      "if (!this->$name$().IsInitializedAfterParse()) {\n"
+      "  _children_initialized_ = false;\n"
+      "}\n",
+      "name", FieldName(field));
+  }
+}
+
 
 }  // namespace cpp
 }  // namespace compiler
@@ -38,6 +38,7 @@
 #include <string>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/compiler/cpp/cpp_field.h>
+#include <google/protobuf/compiler/cpp/cpp_options.h>
 
 namespace google {
 namespace protobuf {
@@ -55,9 +56,9 @@ class ExtensionGenerator;      // extension.h
 
 class MessageGenerator {
  public:
-  // See generator.cc for the meaning of dllexport_decl.
+  // See generator.cc for the meaning of the options.
   explicit MessageGenerator(const Descriptor* descriptor,
-                            const string& dllexport_decl);
+                            const Options& options);
   ~MessageGenerator();
 
   // Header stuff.
@@ -114,6 +115,9 @@ class MessageGenerator {
   void GenerateFieldAccessorDeclarations(io::Printer* printer);
   void GenerateFieldAccessorDefinitions(io::Printer* printer);
 
+  // Generate clear_$oneof_name$() for each oneof.
+  void GenerateOneofClear(io::Printer* printer);
+
   // Generate the field offsets array.
   void GenerateOffsets(io::Printer* printer);
 
@@ -141,6 +145,25 @@ class MessageGenerator {
   void GenerateCopyFrom(io::Printer* printer);
   void GenerateSwap(io::Printer* printer);
   void GenerateIsInitialized(io::Printer* printer);
+  void GenerateIsInitializedAfterParse(io::Printer* printer);
+
+  // Emits the checks of this message's own required fields shared by
+  // IsInitialized() and IsInitializedAfterParse().
+  void GenerateRequiredFieldChecks(io::Printer* printer);
+
+  // After a sub-message of the given field has been parsed, emits code which
+  // folds its initialization state into _children_initialized_.
+  void GenerateChildInitializationCheck(io::Printer* printer,
+                                        const FieldDescriptor* field);
+
+  // Declares a MessageProfileScope at the top of a method, if the
+  // profile_messages option is set.  The argument is the input stream or
+  // the operation.
+  void GenerateProfileScope(io::Printer* printer, const string& argument);
+
+  // Declares an AllocationContext naming the message at the top of a method,
+  // if the profile_allocations option is set.
+  void GenerateAllocationContext(io::Printer* printer);
 
   // Helpers for GenerateSerializeWithCachedSizes().
   void GenerateSerializeOneField(io::Printer* printer,
@@ -153,7 +176,7 @@ class MessageGenerator {
 
   const Descriptor* descriptor_;
   string classname_;
-  string dllexport_decl_;
+  Options options_;
   FieldGeneratorMap field_generators_;
   scoped_array<scoped_ptr<MessageGenerator> > nested_generators_;
   scoped_array<scoped_ptr<EnumGenerator> > enum_generators_;
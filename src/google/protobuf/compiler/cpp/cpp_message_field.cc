@@ -45,9 +45,13 @@ namespace cpp {
 namespace {
 
 void SetMessageVariables(const FieldDescriptor* descriptor,
+                         const Options& options,
                          map<string, string>* variables) {
   SetCommonFieldVariables(descriptor, variables);
   (*variables)["type"] = FieldMessageTypeName(descriptor);
+  SetAllocationProfilingVariables(descriptor, options, "SUB_MESSAGE",
+                                  "sizeof(" + (*variables)["type"] + ")",
+                                  variables);
   (*variables)["stream_writer"] = (*variables)["declared_type"] +
       (HasFastArraySerialization(descriptor->message_type()->file()) ?
        "MaybeToArray" :
@@ -59,9 +63,11 @@ void SetMessageVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 MessageFieldGenerator::
-MessageFieldGenerator(const FieldDescriptor* descriptor)
-  : descriptor_(descriptor) {
-  SetMessageVariables(descriptor, &variables_);
+MessageFieldGenerator(const FieldDescriptor* descriptor,
+                      const Options& options)
+  : descriptor_(descriptor),
+    profile_allocations_(options.profile_allocations) {
+  SetMessageVariables(descriptor, options, &variables_);
 }
 
 MessageFieldGenerator::~MessageFieldGenerator() {}
@@ -85,8 +91,18 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "  return $name$_ != NULL ? *$name$_ : *default_instance_->$name$_;\n"
     "}\n"
     "inline $type$* $classname$::mutable_$name$() {\n"
-    "  _set_bit($index$);\n"
-    "  if ($name$_ == NULL) $name$_ = new $type$;\n"
+    "  _set_bit($index$);\n");
+  if (profile_allocations_) {
+    printer->Print(variables_,
+      "  if ($name$_ == NULL) {\n"
+      "$sample_allocation$"
+      "    $name$_ = new $type$;\n"
+      "  }\n");
+  } else {
+    printer->Print(variables_,
+      "  if ($name$_ == NULL) $name$_ = new $type$;\n");
+  }
+  printer->Print(variables_,
     "  return $name$_;\n"
     "}\n");
 }
@@ -151,10 +167,53 @@ GenerateByteSize(io::Printer* printer) const {
 
 // ===================================================================
 
+MessageOneofFieldGenerator::
+MessageOneofFieldGenerator(const FieldDescriptor* descriptor,
+                           const Options& options)
+  : MessageFieldGenerator(descriptor, options) {}
+
+MessageOneofFieldGenerator::~MessageOneofFieldGenerator() {}
+
+void MessageOneofFieldGenerator::
+GenerateInlineAccessorDefinitions(io::Printer* printer) const {
+  printer->Print(variables_,
+    "inline const $type$& $classname$::$name$() const {\n"
+    "  return has_$name$() ? *$oneof_name$_.$name$_\n"
+    "                      : $type$::default_instance();\n"
+    "}\n"
+    "inline $type$* $classname$::mutable_$name$() {\n"
+    "  if (!has_$name$()) {\n"
+    "    clear_$oneof_name$();\n"
+    "    set_has_$name$();\n"
+    "$sample_allocation$"
+    "    $oneof_name$_.$name$_ = new $type$;\n"
+    "  }\n"
+    "  return $oneof_name$_.$name$_;\n"
+    "}\n");
+}
+
+void MessageOneofFieldGenerator::
+GenerateClearingCode(io::Printer* printer) const {
+  printer->Print(variables_, "delete $oneof_name$_.$name$_;\n");
+}
+
+void MessageOneofFieldGenerator::
+GenerateSwappingCode(io::Printer* printer) const {
+  // Don't print any swapping code.  Swapping the union will swap this field.
+}
+
+void MessageOneofFieldGenerator::
+GenerateConstructorCode(io::Printer* printer) const {
+  // Nothing to do:  the oneof starts out with no member set.
+}
+
+// ===================================================================
+
 RepeatedMessageFieldGenerator::
-RepeatedMessageFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedMessageFieldGenerator(const FieldDescriptor* descriptor,
+                              const Options& options)
   : descriptor_(descriptor) {
-  SetMessageVariables(descriptor, &variables_);
+  SetMessageVariables(descriptor, options, &variables_);
 }
 
 RepeatedMessageFieldGenerator::~RepeatedMessageFieldGenerator() {}
@@ -188,6 +247,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "  return $name$_.Mutable(index);\n"
     "}\n"
     "inline $type$* $classname$::add_$name$() {\n"
+    "$allocation_context$"
     "  return $name$_.Add();\n"
     "}\n");
   printer->Print(variables_,
@@ -264,6 +324,58 @@ GenerateByteSize(io::Printer* printer) const {
     "}\n");
 }
 
+// ===================================================================
+
+SlabRepeatedMessageFieldGenerator::
+SlabRepeatedMessageFieldGenerator(const FieldDescriptor* descriptor,
+                                  const Options& options)
+  : RepeatedMessageFieldGenerator(descriptor, options) {}
+
+SlabRepeatedMessageFieldGenerator::~SlabRepeatedMessageFieldGenerator() {}
+
+void SlabRepeatedMessageFieldGenerator::
+GeneratePrivateMembers(io::Printer* printer) const {
+  printer->Print(variables_,
+    "::google::protobuf::SlabRepeatedField< $type$ > $name$_;\n");
+}
+
+void SlabRepeatedMessageFieldGenerator::
+GenerateAccessorDeclarations(io::Printer* printer) const {
+  printer->Print(variables_,
+    "inline const $type$& $name$(int index) const$deprecation$;\n"
+    "inline $type$* mutable_$name$(int index)$deprecation$;\n"
+    "inline $type$* add_$name$()$deprecation$;\n");
+  printer->Print(variables_,
+    "inline const ::google::protobuf::RepeatedPtrField< $type$ >&\n"
+    "    $name$() const$deprecation$;\n"
+    "inline ::google::protobuf::SlabRepeatedField< $type$ >*\n"
+    "    mutable_$name$()$deprecation$;\n");
+}
+
+void SlabRepeatedMessageFieldGenerator::
+GenerateInlineAccessorDefinitions(io::Printer* printer) const {
+  printer->Print(variables_,
+    "inline const $type$& $classname$::$name$(int index) const {\n"
+    "  return $name$_.Get(index);\n"
+    "}\n"
+    "inline $type$* $classname$::mutable_$name$(int index) {\n"
+    "  return $name$_.Mutable(index);\n"
+    "}\n"
+    "inline $type$* $classname$::add_$name$() {\n"
+    "$allocation_context$"
+    "  return $name$_.Add();\n"
+    "}\n");
+  printer->Print(variables_,
+    "inline const ::google::protobuf::RepeatedPtrField< $type$ >&\n"
+    "$classname$::$name$() const {\n"
+    "  return $name$_.elements();\n"
+    "}\n"
+    "inline ::google::protobuf::SlabRepeatedField< $type$ >*\n"
+    "$classname$::mutable_$name$() {\n"
+    "  return &$name$_;\n"
+    "}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
@@ -46,8 +46,11 @@ namespace cpp {
 namespace {
 
 void SetStringVariables(const FieldDescriptor* descriptor,
+                        const Options& options,
                         map<string, string>* variables) {
   SetCommonFieldVariables(descriptor, variables);
+  SetAllocationProfilingVariables(descriptor, options, "STRING",
+                                  "sizeof(::std::string)", variables);
   (*variables)["default"] =
     "\"" + CEscape(descriptor->default_value_string()) + "\"";
   (*variables)["pointer_type"] =
@@ -59,9 +62,10 @@ void SetStringVariables(const FieldDescriptor* descriptor,
 // ===================================================================
 
 StringFieldGenerator::
-StringFieldGenerator(const FieldDescriptor* descriptor)
+StringFieldGenerator(const FieldDescriptor* descriptor,
+                     const Options& options)
   : descriptor_(descriptor) {
-  SetStringVariables(descriptor, &variables_);
+  SetStringVariables(descriptor, options, &variables_);
 }
 
 StringFieldGenerator::~StringFieldGenerator() {}
@@ -123,6 +127,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "inline void $classname$::set_$name$(const ::std::string& value) {\n"
     "  _set_bit($index$);\n"
     "  if ($name$_ == &_default_$name$_) {\n"
+    "$sample_allocation$"
     "    $name$_ = new ::std::string;\n"
     "  }\n"
     "  $name$_->assign(value);\n"
@@ -130,6 +135,7 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "inline void $classname$::set_$name$(const char* value) {\n"
     "  _set_bit($index$);\n"
     "  if ($name$_ == &_default_$name$_) {\n"
+    "$sample_allocation$"
     "    $name$_ = new ::std::string;\n"
     "  }\n"
     "  $name$_->assign(value);\n"
@@ -138,13 +144,15 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "void $classname$::set_$name$(const $pointer_type$* value, size_t size) {\n"
     "  _set_bit($index$);\n"
     "  if ($name$_ == &_default_$name$_) {\n"
+    "$sample_allocation$"
     "    $name$_ = new ::std::string;\n"
     "  }\n"
     "  $name$_->assign(reinterpret_cast<const char*>(value), size);\n"
     "}\n"
     "inline ::std::string* $classname$::mutable_$name$() {\n"
     "  _set_bit($index$);\n"
-    "  if ($name$_ == &_default_$name$_) {\n");
+    "  if ($name$_ == &_default_$name$_) {\n"
+    "$sample_allocation$");
   if (descriptor_->default_value_string().empty()) {
     printer->Print(variables_,
       "    $name$_ = new ::std::string;\n");
@@ -261,10 +269,107 @@ GenerateByteSize(io::Printer* printer) const {
 
 // ===================================================================
 
+StringOneofFieldGenerator::
+StringOneofFieldGenerator(const FieldDescriptor* descriptor,
+                          const Options& options)
+  : StringFieldGenerator(descriptor, options) {}
+
+StringOneofFieldGenerator::~StringOneofFieldGenerator() {}
+
+void StringOneofFieldGenerator::
+GeneratePrivateMembers(io::Printer* printer) const {
+  // The default value is declared by GenerateStaticMembers(), since static
+  // members cannot be placed in a union.
+  printer->Print(variables_, "::std::string* $name$_;\n");
+}
+
+void StringOneofFieldGenerator::
+GenerateStaticMembers(io::Printer* printer) const {
+  printer->Print(variables_,
+    "static const ::std::string _default_$name$_;\n");
+}
+
+void StringOneofFieldGenerator::
+GenerateInlineAccessorDefinitions(io::Printer* printer) const {
+  // Unlike ordinary string fields, a set member always owns its string, so
+  // there is no need to compare against the default.
+  map<string, string> vars(variables_);
+  vars["activate"] =
+    "  if (!has_" + vars["name"] + "()) {\n"
+    "    clear_" + vars["oneof_name"] + "();\n"
+    "    set_has_" + vars["name"] + "();\n" +
+    vars["sample_allocation"] +
+    "    " + vars["oneof_name"] + "_." + vars["name"] + "_ = "
+        "new ::std::string;\n"
+    "  }\n";
+
+  printer->Print(vars,
+    "inline const ::std::string& $classname$::$name$() const {\n"
+    "  if (has_$name$()) {\n"
+    "    return *$oneof_name$_.$name$_;\n"
+    "  }\n"
+    "  return _default_$name$_;\n"
+    "}\n"
+    "inline void $classname$::set_$name$(const ::std::string& value) {\n"
+    "$activate$"
+    "  $oneof_name$_.$name$_->assign(value);\n"
+    "}\n"
+    "inline void $classname$::set_$name$(const char* value) {\n"
+    "$activate$"
+    "  $oneof_name$_.$name$_->assign(value);\n"
+    "}\n"
+    "inline "
+    "void $classname$::set_$name$(const $pointer_type$* value, size_t size) {\n"
+    "$activate$"
+    "  $oneof_name$_.$name$_->assign(\n"
+    "      reinterpret_cast<const char*>(value), size);\n"
+    "}\n"
+    "inline ::std::string* $classname$::mutable_$name$() {\n"
+    "  if (!has_$name$()) {\n"
+    "    clear_$oneof_name$();\n"
+    "    set_has_$name$();\n"
+    "$sample_allocation$");
+  if (descriptor_->default_value_string().empty()) {
+    printer->Print(vars,
+      "    $oneof_name$_.$name$_ = new ::std::string;\n");
+  } else {
+    printer->Print(vars,
+      "    $oneof_name$_.$name$_ = new ::std::string(_default_$name$_);\n");
+  }
+  printer->Print(vars,
+    "  }\n"
+    "  return $oneof_name$_.$name$_;\n"
+    "}\n");
+}
+
+void StringOneofFieldGenerator::
+GenerateClearingCode(io::Printer* printer) const {
+  printer->Print(variables_, "delete $oneof_name$_.$name$_;\n");
+}
+
+void StringOneofFieldGenerator::
+GenerateSwappingCode(io::Printer* printer) const {
+  // Don't print any swapping code.  Swapping the union will swap this field.
+}
+
+void StringOneofFieldGenerator::
+GenerateConstructorCode(io::Printer* printer) const {
+  // Nothing to do:  the oneof starts out with no member set.
+}
+
+void StringOneofFieldGenerator::
+GenerateDestructorCode(io::Printer* printer) const {
+  // The containing message clears the oneof, deleting the string if this
+  // member is set.
+}
+
+// ===================================================================
+
 RepeatedStringFieldGenerator::
-RepeatedStringFieldGenerator(const FieldDescriptor* descriptor)
+RepeatedStringFieldGenerator(const FieldDescriptor* descriptor,
+                             const Options& options)
   : descriptor_(descriptor) {
-  SetStringVariables(descriptor, &variables_);
+  SetStringVariables(descriptor, options, &variables_);
 }
 
 RepeatedStringFieldGenerator::~RepeatedStringFieldGenerator() {}
@@ -335,16 +440,20 @@ GenerateInlineAccessorDefinitions(io::Printer* printer) const {
     "    reinterpret_cast<const char*>(value), size);\n"
     "}\n"
     "inline ::std::string* $classname$::add_$name$() {\n"
+    "$allocation_context$"
     "  return $name$_.Add();\n"
     "}\n"
     "inline void $classname$::add_$name$(const ::std::string& value) {\n"
+    "$allocation_context$"
     "  $name$_.Add()->assign(value);\n"
     "}\n"
     "inline void $classname$::add_$name$(const char* value) {\n"
+    "$allocation_context$"
     "  $name$_.Add()->assign(value);\n"
     "}\n"
     "inline void "
     "$classname$::add_$name$(const $pointer_type$* value, size_t size) {\n"
+    "$allocation_context$"
     "  $name$_.Add()->assign(reinterpret_cast<const char*>(value), size);\n"
     "}\n");
   printer->Print(variables_,
@@ -436,6 +545,167 @@ GenerateByteSize(io::Printer* printer) const {
     "}\n");
 }
 
+// ===================================================================
+
+RepeatedStringPieceFieldGenerator::
+RepeatedStringPieceFieldGenerator(const FieldDescriptor* descriptor,
+                                  const Options& options)
+  : descriptor_(descriptor) {
+  SetStringVariables(descriptor, options, &variables_);
+}
+
+RepeatedStringPieceFieldGenerator::~RepeatedStringPieceFieldGenerator() {}
+
+void RepeatedStringPieceFieldGenerator::
+GeneratePrivateMembers(io::Printer* printer) const {
+  printer->Print(variables_,
+    "::google::protobuf::RepeatedStringPieceField $name$_;\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateAccessorDeclarations(io::Printer* printer) const {
+  // Elements are not strings, so there is no mutable_$name$(index) or
+  // add_$name$() returning a string to fill in.
+  printer->Print(variables_,
+    "inline ::google::protobuf::StringPiece $name$(int index) const$deprecation$;\n"
+    "inline void set_$name$(int index, const ::std::string& value)$deprecation$;\n"
+    "inline void set_$name$(int index, const char* value)$deprecation$;\n"
+    "inline "
+    "void set_$name$(int index, const $pointer_type$* value, size_t size)"
+                 "$deprecation$;\n"
+    "inline void add_$name$(const ::std::string& value)$deprecation$;\n"
+    "inline void add_$name$(const char* value)$deprecation$;\n"
+    "inline void add_$name$(const $pointer_type$* value, size_t size)"
+                 "$deprecation$;\n");
+
+  printer->Print(variables_,
+    "inline const ::google::protobuf::RepeatedStringPieceField& $name$() const"
+                 "$deprecation$;\n"
+    "inline ::google::protobuf::RepeatedStringPieceField* mutable_$name$()"
+                 "$deprecation$;\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateInlineAccessorDefinitions(io::Printer* printer) const {
+  printer->Print(variables_,
+    "inline ::google::protobuf::StringPiece $classname$::$name$(int index) const {\n"
+    "  return $name$_.Get(index);\n"
+    "}\n"
+    "inline void $classname$::set_$name$(int index, const ::std::string& value) {\n"
+    "  $name$_.Set(index, value.data(), value.size());\n"
+    "}\n"
+    "inline void $classname$::set_$name$(int index, const char* value) {\n"
+    "  $name$_.Set(index, value, strlen(value));\n"
+    "}\n"
+    "inline void "
+    "$classname$::set_$name$"
+    "(int index, const $pointer_type$* value, size_t size) {\n"
+    "  $name$_.Set(index, reinterpret_cast<const char*>(value), size);\n"
+    "}\n"
+    "inline void $classname$::add_$name$(const ::std::string& value) {\n"
+    "$allocation_context$"
+    "  $name$_.Add(value.data(), value.size());\n"
+    "}\n"
+    "inline void $classname$::add_$name$(const char* value) {\n"
+    "$allocation_context$"
+    "  $name$_.Add(value, strlen(value));\n"
+    "}\n"
+    "inline void "
+    "$classname$::add_$name$(const $pointer_type$* value, size_t size) {\n"
+    "$allocation_context$"
+    "  $name$_.Add(reinterpret_cast<const char*>(value), size);\n"
+    "}\n");
+  printer->Print(variables_,
+    "inline const ::google::protobuf::RepeatedStringPieceField&\n"
+    "$classname$::$name$() const {\n"
+    "  return $name$_;\n"
+    "}\n"
+    "inline ::google::protobuf::RepeatedStringPieceField*\n"
+    "$classname$::mutable_$name$() {\n"
+    "  return &$name$_;\n"
+    "}\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateClearingCode(io::Printer* printer) const {
+  printer->Print(variables_, "$name$_.Clear();\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateMergingCode(io::Printer* printer) const {
+  printer->Print(variables_, "$name$_.MergeFrom(from.$name$_);\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateSwappingCode(io::Printer* printer) const {
+  printer->Print(variables_, "$name$_.Swap(&other->$name$_);\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateConstructorCode(io::Printer* printer) const {
+  // Not needed for repeated fields.
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateMergeFromCodedStream(io::Printer* printer) const {
+  printer->Print(variables_,
+    "DO_(::google::protobuf::internal::WireFormatLite::ReadStringPiece(\n"
+    "      input, &$name$_));\n");
+  if (HasUtf8Verification(descriptor_->file()) &&
+      descriptor_->type() == FieldDescriptor::TYPE_STRING) {
+    printer->Print(variables_,
+      "::google::protobuf::internal::WireFormat::VerifyUTF8String(\n"
+      "  this->$name$(this->$name$_size() - 1).data(),\n"
+      "  this->$name$(this->$name$_size() - 1).length(),\n"
+      "  ::google::protobuf::internal::WireFormat::PARSE);\n");
+  }
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateSerializeWithCachedSizes(io::Printer* printer) const {
+  printer->Print(variables_,
+    "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  if (HasUtf8Verification(descriptor_->file()) &&
+      descriptor_->type() == FieldDescriptor::TYPE_STRING) {
+    printer->Print(variables_,
+      "::google::protobuf::internal::WireFormat::VerifyUTF8String(\n"
+      "  this->$name$(i).data(), this->$name$(i).length(),\n"
+      "  ::google::protobuf::internal::WireFormat::SERIALIZE);\n");
+  }
+  printer->Print(variables_,
+    "  ::google::protobuf::internal::WireFormatLite::WriteStringPiece(\n"
+    "    $number$, this->$name$(i), output);\n"
+    "}\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateSerializeWithCachedSizesToArray(io::Printer* printer) const {
+  printer->Print(variables_,
+    "for (int i = 0; i < this->$name$_size(); i++) {\n");
+  if (HasUtf8Verification(descriptor_->file()) &&
+      descriptor_->type() == FieldDescriptor::TYPE_STRING) {
+    printer->Print(variables_,
+      "  ::google::protobuf::internal::WireFormat::VerifyUTF8String(\n"
+      "    this->$name$(i).data(), this->$name$(i).length(),\n"
+      "    ::google::protobuf::internal::WireFormat::SERIALIZE);\n");
+  }
+  printer->Print(variables_,
+    "  target = ::google::protobuf::internal::WireFormatLite::\n"
+    "    WriteStringPieceToArray($number$, this->$name$(i), target);\n"
+    "}\n");
+}
+
+void RepeatedStringPieceFieldGenerator::
+GenerateByteSize(io::Printer* printer) const {
+  // Every element costs its bytes plus a tag and a length.
+  printer->Print(variables_,
+    "total_size += $tag_size$ * this->$name$_size() + $name$_.bytes_size();\n"
+    "for (int i = 0; i < this->$name$_size(); i++) {\n"
+    "  total_size += ::google::protobuf::io::CodedOutputStream::VarintSize32(\n"
+    "    this->$name$(i).size());\n"
+    "}\n");
+}
+
 }  // namespace cpp
 }  // namespace compiler
 }  // namespace protobuf
@@ -559,6 +559,68 @@ TEST(GeneratedMessageTest, RequiredForeign) {
   EXPECT_TRUE(message.IsInitialized());
 }
 
+#ifndef PROTOBUF_TEST_NO_DESCRIPTORS
+
+TEST(GeneratedMessageTest, RequiredCheckedDuringParse) {
+  // The parse error message is built using reflection.
+
+  // Test that parsing records whether nested messages were initialized, and
+  // that IsInitializedAfterParse() agrees with IsInitialized().
+  unittest::TestRequiredForeign message;
+  message.mutable_optional_message()->set_a(1);
+  message.mutable_optional_message()->set_b(2);
+  message.mutable_optional_message()->set_c(3);
+  message.add_repeated_message()->CopyFrom(message.optional_message());
+  message.add_repeated_message()->CopyFrom(message.optional_message());
+  string complete = message.SerializeAsString();
+
+  message.mutable_repeated_message(1)->clear_b();
+  string incomplete = message.SerializePartialAsString();
+
+  unittest::TestRequiredForeign message2;
+  EXPECT_TRUE(message2.ParseFromString(complete));
+  EXPECT_TRUE(message2.IsInitializedAfterParse());
+  EXPECT_EQ(2, message2.repeated_message_size());
+
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(message2.ParseFromString(incomplete));
+    EXPECT_EQ(1, log.GetMessages(ERROR).size());
+  }
+  EXPECT_TRUE(message2.ParsePartialFromString(incomplete));
+  EXPECT_FALSE(message2.IsInitializedAfterParse());
+  EXPECT_FALSE(message2.IsInitialized());
+
+  // Swap() carries the recorded state along with the fields.
+  unittest::TestRequiredForeign message3;
+  EXPECT_TRUE(message3.ParseFromString(complete));
+  message2.Swap(&message3);
+  EXPECT_TRUE(message2.IsInitializedAfterParse());
+  EXPECT_FALSE(message3.IsInitializedAfterParse());
+
+  // Parsing again starts from a clean state.
+  EXPECT_TRUE(message3.ParseFromString(complete));
+  EXPECT_TRUE(message3.IsInitializedAfterParse());
+}
+
+#endif  // !PROTOBUF_TEST_NO_DESCRIPTORS
+
+TEST(GeneratedMessageTest, RequiredSplitAcrossOccurrences) {
+  // A nested message which is incomplete in its first occurrence may be
+  // completed by a later one; the parse must still succeed.
+  unittest::TestRequiredForeign first, second;
+  first.mutable_optional_message()->set_a(1);
+  second.mutable_optional_message()->set_b(2);
+  second.mutable_optional_message()->set_c(3);
+  string data = first.SerializePartialAsString() +
+                second.SerializePartialAsString();
+
+  unittest::TestRequiredForeign message;
+  EXPECT_TRUE(message.ParseFromString(data));
+  EXPECT_EQ(1, message.optional_message().a());
+  EXPECT_EQ(3, message.optional_message().c());
+}
+
 TEST(GeneratedMessageTest, ForeignNested) {
   // Test that TestAllTypes::NestedMessage can be embedded directly into
   // another message.
@@ -744,6 +806,308 @@ TEST(GeneratedMessageTest, ExtensionConstantValues) {
   EXPECT_EQ(unittest::kRepeatedNestedEnumExtensionFieldNumber, 51);
 }
 
+TEST(GeneratedMessageTest, OneofDefaults) {
+  unittest::TestOneof message;
+
+  EXPECT_EQ(unittest::TestOneof::FOO_NOT_SET, message.foo_case());
+  EXPECT_EQ(unittest::TestOneof::BAR_NOT_SET, message.bar_case());
+  EXPECT_FALSE(message.has_foo_int());
+  EXPECT_FALSE(message.has_foo_string());
+  EXPECT_FALSE(message.has_foo_message());
+
+  EXPECT_EQ(0, message.foo_int());
+  EXPECT_EQ("abc", message.foo_string());
+  EXPECT_EQ(&unittest::TestAllTypes::default_instance(),
+            &message.foo_message());
+  EXPECT_EQ(unittest::TestAllTypes::BAZ, message.foo_enum());
+  EXPECT_EQ("", message.bar_bytes());
+}
+
+TEST(GeneratedMessageTest, OneofSetReplacesOtherMembers) {
+  unittest::TestOneof message;
+
+  message.set_foo_int(123);
+  EXPECT_EQ(unittest::TestOneof::kFooInt, message.foo_case());
+  EXPECT_TRUE(message.has_foo_int());
+  EXPECT_EQ(123, message.foo_int());
+
+  message.set_foo_string("hello");
+  EXPECT_EQ(unittest::TestOneof::kFooString, message.foo_case());
+  EXPECT_FALSE(message.has_foo_int());
+  EXPECT_EQ(0, message.foo_int());
+  EXPECT_EQ("hello", message.foo_string());
+
+  message.mutable_foo_message()->set_optional_int32(456);
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message.foo_case());
+  EXPECT_FALSE(message.has_foo_string());
+  EXPECT_EQ("abc", message.foo_string());
+  EXPECT_EQ(456, message.foo_message().optional_int32());
+
+  // Oneofs are independent of each other and of ordinary fields.
+  message.set_bar_bool(true);
+  message.set_before(1);
+  message.set_after("x");
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message.foo_case());
+  EXPECT_EQ(unittest::TestOneof::kBarBool, message.bar_case());
+
+  // A mutable string member starts out as the field's default.
+  message.mutable_foo_string()->append("def");
+  EXPECT_EQ("abcdef", message.foo_string());
+}
+
+TEST(GeneratedMessageTest, OneofClear) {
+  unittest::TestOneof message;
+
+  message.set_foo_string("hello");
+  message.set_bar_bytes("world");
+  message.clear_foo_int();
+  EXPECT_EQ(unittest::TestOneof::kFooString, message.foo_case());
+
+  message.clear_foo_string();
+  EXPECT_EQ(unittest::TestOneof::FOO_NOT_SET, message.foo_case());
+  EXPECT_EQ(unittest::TestOneof::kBarBytes, message.bar_case());
+
+  message.mutable_foo_message()->set_optional_int32(1);
+  message.clear_foo();
+  EXPECT_EQ(unittest::TestOneof::FOO_NOT_SET, message.foo_case());
+
+  message.set_foo_double(1.5);
+  message.Clear();
+  EXPECT_EQ(unittest::TestOneof::FOO_NOT_SET, message.foo_case());
+  EXPECT_EQ(unittest::TestOneof::BAR_NOT_SET, message.bar_case());
+  EXPECT_EQ(0, message.foo_double());
+}
+
+TEST(GeneratedMessageTest, OneofCopyAndMerge) {
+  unittest::TestOneof message1, message2;
+
+  message1.set_foo_string("hello");
+  message1.set_before(7);
+
+  message2.CopyFrom(message1);
+  EXPECT_EQ(unittest::TestOneof::kFooString, message2.foo_case());
+  EXPECT_EQ("hello", message2.foo_string());
+  EXPECT_EQ(7, message2.before());
+
+  // Merging a different member replaces the one that was set.
+  unittest::TestOneof message3;
+  message3.mutable_foo_message()->set_optional_int32(5);
+  message3.set_bar_bool(true);
+  message2.MergeFrom(message3);
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message2.foo_case());
+  EXPECT_EQ(5, message2.foo_message().optional_int32());
+  EXPECT_EQ(unittest::TestOneof::kBarBool, message2.bar_case());
+
+  // Merging the same member merges its value.
+  unittest::TestOneof message4;
+  message4.mutable_foo_message()->set_optional_int64(6);
+  message2.MergeFrom(message4);
+  EXPECT_EQ(5, message2.foo_message().optional_int32());
+  EXPECT_EQ(6, message2.foo_message().optional_int64());
+
+  // Merging a message with nothing set leaves the oneof alone.
+  message2.MergeFrom(unittest::TestOneof::default_instance());
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message2.foo_case());
+}
+
+TEST(GeneratedMessageTest, OneofSwap) {
+  unittest::TestOneof message1, message2;
+
+  message1.set_foo_string("hello");
+  message2.set_foo_int(123);
+  message2.set_bar_bytes("world");
+
+  message1.Swap(&message2);
+  EXPECT_EQ(unittest::TestOneof::kFooInt, message1.foo_case());
+  EXPECT_EQ(123, message1.foo_int());
+  EXPECT_EQ("world", message1.bar_bytes());
+  EXPECT_EQ(unittest::TestOneof::kFooString, message2.foo_case());
+  EXPECT_EQ("hello", message2.foo_string());
+  EXPECT_EQ(unittest::TestOneof::BAR_NOT_SET, message2.bar_case());
+}
+
+TEST(GeneratedMessageTest, OneofSerialization) {
+  unittest::TestOneof message1, message2;
+  string data;
+
+  message1.set_foo_enum(unittest::TestAllTypes::FOO);
+  message1.set_bar_bytes(string("\0\1", 2));
+  message1.set_after("end");
+  message1.SerializeToString(&data);
+
+  ASSERT_TRUE(message2.ParseFromString(data));
+  EXPECT_EQ(unittest::TestOneof::kFooEnum, message2.foo_case());
+  EXPECT_EQ(unittest::TestAllTypes::FOO, message2.foo_enum());
+  EXPECT_EQ(string("\0\1", 2), message2.bar_bytes());
+  EXPECT_EQ("end", message2.after());
+
+  // When several members appear on the wire, the last one wins.
+  unittest::TestOneof message3;
+  message3.set_foo_int(5);
+  message3.AppendToString(&data);
+  message3.set_foo_string("last");
+  message3.AppendToString(&data);
+  ASSERT_TRUE(message2.ParseFromString(data));
+  EXPECT_EQ(unittest::TestOneof::kFooString, message2.foo_case());
+  EXPECT_EQ("last", message2.foo_string());
+}
+
+TEST(GeneratedMessageTest, ContiguousAccessors) {
+  unittest::TestContiguous message;
+  message.add_items()->set_bb(1);
+  message.add_items()->set_bb(2);
+  message.add_foreign()->set_c(3);
+
+  ASSERT_EQ(2, message.items_size());
+  EXPECT_EQ(1, message.items(0).bb());
+  EXPECT_EQ(2, message.items(1).bb());
+  message.mutable_items(1)->set_bb(5);
+  EXPECT_EQ(5, message.items().Get(1).bb());
+  EXPECT_EQ(3, message.foreign(0).c());
+
+  int sum = 0;
+  for (RepeatedPtrField<unittest::TestAllTypes::NestedMessage>::const_iterator
+         iter = message.items().begin();
+       iter != message.items().end(); ++iter) {
+    sum += iter->bb();
+  }
+  EXPECT_EQ(6, sum);
+}
+
+TEST(GeneratedMessageTest, ContiguousReserveAndReuse) {
+  unittest::TestContiguous message;
+  message.mutable_items()->Reserve(10);
+  vector<const unittest::TestAllTypes::NestedMessage*> addresses;
+  for (int i = 0; i < 10; i++) {
+    addresses.push_back(message.add_items());
+  }
+  // Reserved elements are laid out next to each other.
+  for (int i = 1; i < 10; i++) {
+    EXPECT_EQ(addresses[0] + i, addresses[i]);
+  }
+  int capacity = message.items().size();
+  EXPECT_LE(capacity, message.mutable_items()->SlabCapacity());
+  capacity = message.mutable_items()->SlabCapacity();
+
+  // Clearing and refilling reuses the same elements, without new slabs.
+  message.Clear();
+  EXPECT_EQ(0, message.items_size());
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(addresses[i], message.add_items());
+    EXPECT_FALSE(message.items(i).has_bb());
+  }
+  EXPECT_EQ(capacity, message.mutable_items()->SlabCapacity());
+
+  // Adding more elements never moves existing ones.
+  for (int i = 0; i < 100; i++) {
+    message.add_items()->set_bb(i);
+  }
+  for (int i = 0; i < 10; i++) {
+    EXPECT_EQ(addresses[i], &message.items(i));
+  }
+}
+
+TEST(GeneratedMessageTest, ContiguousCopySwapAndSerialize) {
+  unittest::TestContiguous message1, message2;
+  for (int i = 0; i < 20; i++) {
+    message1.add_items()->set_bb(i);
+  }
+  message1.add_foreign()->set_c(7);
+  message1.set_after(8);
+
+  message2.CopyFrom(message1);
+  ASSERT_EQ(20, message2.items_size());
+  EXPECT_EQ(19, message2.items(19).bb());
+  EXPECT_EQ(message1.SerializeAsString(), message2.SerializeAsString());
+
+  message2.MergeFrom(message1);
+  EXPECT_EQ(40, message2.items_size());
+
+  const unittest::TestAllTypes::NestedMessage* first = &message1.items(0);
+  message1.Swap(&message2);
+  EXPECT_EQ(40, message1.items_size());
+  EXPECT_EQ(20, message2.items_size());
+  EXPECT_EQ(first, &message2.items(0));
+
+  unittest::TestContiguous message3;
+  ASSERT_TRUE(message3.ParseFromString(message1.SerializeAsString()));
+  EXPECT_EQ(message1.SerializeAsString(), message3.SerializeAsString());
+  EXPECT_EQ(39 % 20, message3.items(39).bb());
+  EXPECT_EQ(7, message3.foreign(1).c());
+}
+
+TEST(GeneratedMessageTest, StringPieceAccessors) {
+  unittest::TestAllTypes message;
+  message.add_repeated_string_piece("foo");
+  message.add_repeated_string_piece(string("bar"));
+  message.add_repeated_string_piece("bazqux", 3);
+
+  ASSERT_EQ(3, message.repeated_string_piece_size());
+  EXPECT_EQ("foo", message.repeated_string_piece(0).ToString());
+  EXPECT_EQ("bar", message.repeated_string_piece(1).ToString());
+  EXPECT_EQ("baz", message.repeated_string_piece(2).ToString());
+  EXPECT_EQ(9, message.repeated_string_piece().bytes_size());
+
+  message.set_repeated_string_piece(1, "longer");
+  EXPECT_EQ("longer", message.repeated_string_piece(1).ToString());
+  EXPECT_EQ("baz", message.repeated_string_piece(2).ToString());
+
+  message.mutable_repeated_string_piece()->RemoveLast();
+  EXPECT_EQ(2, message.repeated_string_piece_size());
+  message.clear_repeated_string_piece();
+  EXPECT_EQ(0, message.repeated_string_piece_size());
+}
+
+TEST(GeneratedMessageTest, StringPieceSerialization) {
+  unittest::TestAllTypes message1, message2;
+  for (int i = 0; i < 100; i++) {
+    message1.add_repeated_string_piece(SimpleItoa(i));
+  }
+  message1.add_repeated_string_piece(string(1000, 'x'));
+  string data = message1.SerializeAsString();
+
+  ASSERT_TRUE(message2.ParseFromString(data));
+  ASSERT_EQ(101, message2.repeated_string_piece_size());
+  EXPECT_EQ("42", message2.repeated_string_piece(42).ToString());
+  EXPECT_EQ(data, message2.SerializeAsString());
+
+  // Elements which straddle the input's buffers are read too.
+  message2.Clear();
+  io::ArrayInputStream raw_input(data.data(), data.size(), 7);
+  io::CodedInputStream input(&raw_input);
+  ASSERT_TRUE(message2.MergePartialFromCodedStream(&input));
+  ASSERT_EQ(101, message2.repeated_string_piece_size());
+  EXPECT_EQ(string(1000, 'x'), message2.repeated_string_piece(100).ToString());
+  EXPECT_EQ(data, message2.SerializeAsString());
+
+  // A length running past the end of the input fails cleanly.
+  ASSERT_FALSE(message2.ParseFromString(data.substr(0, data.size() - 1)));
+}
+
+#ifndef PROTOBUF_TEST_NO_DESCRIPTORS
+
+TEST(GeneratedMessageTest, ContiguousWithReflection) {
+  // Mix elements from the slabs with ones added through reflection.
+  unittest::TestContiguous message;
+  const Reflection* reflection = message.GetReflection();
+  const FieldDescriptor* items =
+    message.GetDescriptor()->FindFieldByName("items");
+
+  message.add_items()->set_bb(1);
+  reflection->AddMessage(&message, items);
+  message.mutable_items(1)->set_bb(2);
+  message.add_items()->set_bb(3);
+  EXPECT_EQ(3, message.items_size());
+  EXPECT_EQ(2, message.items(1).bb());
+
+  message.Clear();
+  message.add_items();
+  message.add_items();
+  EXPECT_EQ(2, reflection->FieldSize(message, items));
+}
+
+#endif  // !PROTOBUF_TEST_NO_DESCRIPTORS
+
 // ===================================================================
 
 TEST(GeneratedEnumTest, EnumValuesAsSwitchCases) {
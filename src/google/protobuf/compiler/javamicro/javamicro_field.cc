@@ -46,6 +46,11 @@ namespace javamicro {
 
 FieldGenerator::~FieldGenerator() {}
 
+void FieldGenerator::GenerateParsingCodeFromPacked(io::Printer* printer) const {
+  GOOGLE_LOG(FATAL) << "GenerateParsingCodeFromPacked() "
+             << "called on field generator that does not support packing.";
+}
+
 FieldGeneratorMap::FieldGeneratorMap(const Descriptor* descriptor, const Params &params)
   : descriptor_(descriptor),
     field_generators_(
@@ -70,6 +75,9 @@ FieldGenerator* FieldGeneratorMap::MakeGenerator(const FieldDescriptor* field, c
       case JAVATYPE_ENUM:
         return new RepeatedEnumFieldGenerator(field, params);
       default:
+        if (IsPrimitiveArrayField(params, field)) {
+          return new RepeatedPrimitiveArrayFieldGenerator(field, params);
+        }
         return new RepeatedPrimitiveFieldGenerator(field, params);
     }
   } else {
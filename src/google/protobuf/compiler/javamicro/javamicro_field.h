@@ -63,6 +63,10 @@ class FieldGenerator {
   virtual void GenerateSerializationCode(io::Printer* printer) const = 0;
   virtual void GenerateSerializedSizeCode(io::Printer* printer) const = 0;
 
+  // Generates the parsing code for the packed form of a repeated field.  Only
+  // called for fields where IsPrimitiveArrayField() is true.
+  virtual void GenerateParsingCodeFromPacked(io::Printer* printer) const;
+
   virtual string GetBoxedType() const = 0;
 
  protected:
@@ -135,6 +135,8 @@ bool JavaMicroGenerator::Generate(const FileDescriptor* file,
         params.set_override_java_multiple_files(options[i].second == "true");
     } else if (options[i].first == "java_use_vector") {
         params.set_java_use_vector(options[i].second == "true");
+    } else if (options[i].first == "java_use_primitive_arrays") {
+        params.set_java_use_primitive_arrays(options[i].second == "true");
     } else {
       *error = "Ignore unknown javamicro generator option: " + options[i].first;
     }
@@ -144,6 +146,8 @@ bool JavaMicroGenerator::Generate(const FileDescriptor* file,
   GOOGLE_LOG(WARNING) << "optimization()=" << params.optimization();
   GOOGLE_LOG(WARNING) << "java_multiple_files()=" << params.java_multiple_files();
   GOOGLE_LOG(WARNING) << "java_use_vector()=" << params.java_use_vector();
+  GOOGLE_LOG(WARNING) << "java_use_primitive_arrays()="
+                      << params.java_use_primitive_arrays();
 
   GOOGLE_LOG(WARNING) << "----------";
   for (Params::NameMap::const_iterator it = params.java_packages().begin();
@@ -350,6 +350,22 @@ string DefaultValue(const Params& params, const FieldDescriptor* field) {
   return "";
 }
 
+bool IsPrimitiveArrayField(const Params& params, const FieldDescriptor* field) {
+  if (!params.java_use_primitive_arrays() || !field->is_repeated()) {
+    return false;
+  }
+  switch (GetJavaType(field)) {
+    case JAVATYPE_INT:
+    case JAVATYPE_LONG:
+    case JAVATYPE_FLOAT:
+    case JAVATYPE_DOUBLE:
+    case JAVATYPE_BOOLEAN:
+      return true;
+    default:
+      return false;
+  }
+}
+
 }  // namespace javamicro
 }  // namespace compiler
 }  // namespace protobuf
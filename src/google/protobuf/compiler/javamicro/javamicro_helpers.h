@@ -130,6 +130,12 @@ const char* BoxedPrimitiveTypeName(JavaType type);
 
 string DefaultValue(const Params& params, const FieldDescriptor* field);
 
+// Returns true if the field is a repeated numeric or bool field that should
+// be stored in a primitive array rather than a List or Vector of boxed
+// values, i.e. java_use_primitive_arrays=true was given.  Such fields accept
+// both packed and unpacked input and may be declared [packed=true].
+bool IsPrimitiveArrayField(const Params& params, const FieldDescriptor* field);
+
 }  // namespace javamicro
 }  // namespace compiler
 }  // namespace protobuf
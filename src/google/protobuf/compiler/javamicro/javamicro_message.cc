@@ -326,8 +326,13 @@ void MessageGenerator::GenerateMergeFromMethods(io::Printer* printer) {
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = sorted_fields[i];
-    uint32 tag = WireFormatLite::MakeTag(field->number(),
-      WireFormat::WireTypeForField(field));
+    // Primitive array fields accept both encodings regardless of
+    // field->options().packed(), so GenerateParsingCode() handles the
+    // unpacked tag and GenerateParsingCodeFromPacked() the packed one.
+    bool accept_packed = IsPrimitiveArrayField(params_, field);
+    uint32 tag = WireFormatLite::MakeTag(field->number(), accept_packed
+      ? WireFormat::WireTypeForFieldType(field->type())
+      : WireFormat::WireTypeForField(field));
 
     printer->Print(
       "case $tag$: {\n",
@@ -340,6 +345,22 @@ void MessageGenerator::GenerateMergeFromMethods(io::Printer* printer) {
     printer->Print(
       "  break;\n"
       "}\n");
+
+    if (accept_packed) {
+      uint32 packed_tag = WireFormatLite::MakeTag(field->number(),
+        WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+      printer->Print(
+        "case $tag$: {\n",
+        "tag", SimpleItoa(packed_tag));
+      printer->Indent();
+
+      field_generators_.get(field).GenerateParsingCodeFromPacked(printer);
+
+      printer->Outdent();
+      printer->Print(
+        "  break;\n"
+        "}\n");
+    }
   }
 
   printer->Outdent();
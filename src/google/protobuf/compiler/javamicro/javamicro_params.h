@@ -56,6 +56,7 @@ class Params {
   eOptimization optimization_;
   eMultipleFiles override_java_multiple_files_;
   bool java_use_vector_;
+  bool java_use_primitive_arrays_;
   NameMap java_packages_;
   NameMap java_outer_classnames_;
   NameSet java_multiple_files_;
@@ -66,7 +67,8 @@ class Params {
     base_name_(base_name),
     optimization_(JAVAMICRO_OPT_DEFAULT),
     override_java_multiple_files_(JAVAMICRO_MUL_UNSET),
-    java_use_vector_(false) {
+    java_use_vector_(false),
+    java_use_primitive_arrays_(false) {
   }
 
   const string& base_name() const {
@@ -161,6 +163,13 @@ class Params {
     return java_use_vector_;
   }
 
+  void set_java_use_primitive_arrays(bool value) {
+    java_use_primitive_arrays_ = value;
+  }
+  bool java_use_primitive_arrays() const {
+    return java_use_primitive_arrays_;
+  }
+
 };
 
 }  // namespace javamicro
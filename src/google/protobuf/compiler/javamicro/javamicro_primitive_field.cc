@@ -175,6 +175,22 @@ bool IsVariableLenType(JavaType type) {
   return false;
 }
 
+// Name of the shared empty array in WireFormatMicro used to initialize
+// primitive array fields of the given type.
+const char* EmptyArrayName(JavaType type) {
+  switch (type) {
+    case JAVATYPE_INT    : return "EMPTY_INT_ARRAY";
+    case JAVATYPE_LONG   : return "EMPTY_LONG_ARRAY";
+    case JAVATYPE_FLOAT  : return "EMPTY_FLOAT_ARRAY";
+    case JAVATYPE_DOUBLE : return "EMPTY_DOUBLE_ARRAY";
+    case JAVATYPE_BOOLEAN: return "EMPTY_BOOLEAN_ARRAY";
+    default: break;
+  }
+
+  GOOGLE_LOG(FATAL) << "Not a primitive array type.";
+  return NULL;
+}
+
 bool IsFastStringHandling(const FieldDescriptor* descriptor,
       const Params params) {
   return ((params.optimization() == JAVAMICRO_OPT_SPEED)
@@ -670,6 +686,160 @@ string RepeatedPrimitiveFieldGenerator::GetBoxedType() const {
   return BoxedPrimitiveTypeName(GetJavaType(descriptor_));
 }
 
+// ===================================================================
+
+RepeatedPrimitiveArrayFieldGenerator::
+RepeatedPrimitiveArrayFieldGenerator(const FieldDescriptor* descriptor,
+                                     const Params& params)
+  : FieldGenerator(params), descriptor_(descriptor) {
+  SetPrimitiveVariables(descriptor, params, &variables_);
+  variables_["empty_array"] = EmptyArrayName(GetJavaType(descriptor));
+}
+
+RepeatedPrimitiveArrayFieldGenerator::~RepeatedPrimitiveArrayFieldGenerator() {}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateMembers(io::Printer* printer) const {
+  printer->Print(variables_,
+    "private $type$[] $name$_ =\n"
+    "  com.google.protobuf.micro.WireFormatMicro.$empty_array$;\n"
+    "private int $name$Count_;\n"
+    "public int get$capitalized_name$Count() { return $name$Count_; }\n"
+    "public $type$ get$capitalized_name$(int index) {\n"
+    "  if (index >= $name$Count_) {\n"
+    "    throw new IndexOutOfBoundsException();\n"
+    "  }\n"
+    "  return $name$_[index];\n"
+    "}\n"
+    "public $type$[] get$capitalized_name$Array() {\n"
+    "  $type$[] result = new $type$[$name$Count_];\n"
+    "  System.arraycopy($name$_, 0, result, 0, $name$Count_);\n"
+    "  return result;\n"
+    "}\n"
+    "public $message_name$ set$capitalized_name$(int index, $type$ value) {\n"
+    "  if (index >= $name$Count_) {\n"
+    "    throw new IndexOutOfBoundsException();\n"
+    "  }\n"
+    "  $name$_[index] = value;\n"
+    "  return this;\n"
+    "}\n"
+    "public $message_name$ add$capitalized_name$($type$ value) {\n"
+    "  if ($name$Count_ == $name$_.length) {\n"
+    "    $name$_ = ensureCapacity($name$_, $name$Count_, $name$Count_ + 1);\n"
+    "  }\n"
+    "  $name$_[$name$Count_++] = value;\n"
+    "  return this;\n"
+    "}\n"
+    "public $message_name$ clear$capitalized_name$() {\n"
+    // Keep the array so that a cleared message can be refilled without
+    // allocating.
+    "  $name$Count_ = 0;\n"
+    "  return this;\n"
+    "}\n");
+  if (descriptor_->options().packed()) {
+    printer->Print(variables_,
+      "private int $name$MemoizedSerializedSize;\n");
+  }
+}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateMergingCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (other.$name$Count_ != 0) {\n"
+    "  $name$_ = ensureCapacity($name$_, $name$Count_,\n"
+    "      $name$Count_ + other.$name$Count_);\n"
+    "  System.arraycopy(other.$name$_, 0, $name$_, $name$Count_,\n"
+    "      other.$name$Count_);\n"
+    "  $name$Count_ += other.$name$Count_;\n"
+    "}\n");
+}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateParsingCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "add$capitalized_name$(input.read$capitalized_type$());\n");
+}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateParsingCodeFromPacked(io::Printer* printer) const {
+  printer->Print(variables_,
+    "int length = input.readRawVarint32();\n"
+    "int limit = input.pushLimit(length);\n");
+  // Grow the array only for values which have actually been read into the
+  // input buffer; the length prefix may promise bytes that never arrive.
+  // Bools are varints, so they are counted like the other varint types.
+  map<string, string> vars(variables_);
+  vars["hint_size"] = "0";
+  if (descriptor_->type() != FieldDescriptor::TYPE_BOOL &&
+      FixedSize(descriptor_->type()) != -1) {
+    vars["hint_size"] = vars["fixed_size"];
+  }
+  printer->Print(vars,
+    "while (input.getBytesUntilLimit() > 0) {\n"
+    "  $name$_ = ensureCapacity($name$_, $name$Count_,\n"
+    "      $name$Count_ + input.getPackedCountHint($hint_size$));\n"
+    "  $name$Count_ = input.readPacked$capitalized_type$($name$_, $name$Count_);\n"
+    "}\n"
+    "input.popLimit(limit);\n");
+}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateSerializationCode(io::Printer* printer) const {
+  if (descriptor_->options().packed()) {
+    printer->Print(variables_,
+      "if ($name$Count_ > 0) {\n"
+      "  output.writeRawVarint32($tag$);\n"
+      "  output.writeRawVarint32($name$MemoizedSerializedSize);\n"
+      "  output.writePacked$capitalized_type$NoTag($name$_, $name$Count_);\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "for (int i = 0; i < $name$Count_; i++) {\n"
+      "  output.write$capitalized_type$($number$, $name$_[i]);\n"
+      "}\n");
+  }
+}
+
+void RepeatedPrimitiveArrayFieldGenerator::
+GenerateSerializedSizeCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "{\n"
+    "  int dataSize = 0;\n");
+  printer->Indent();
+
+  if (FixedSize(descriptor_->type()) == -1) {
+    printer->Print(variables_,
+      "dataSize = com.google.protobuf.micro.CodedOutputStreamMicro\n"
+      "  .computePacked$capitalized_type$SizeNoTag($name$_, $name$Count_);\n");
+  } else {
+    printer->Print(variables_,
+      "dataSize = $fixed_size$ * $name$Count_;\n");
+  }
+
+  printer->Print(
+    "size += dataSize;\n");
+
+  if (descriptor_->options().packed()) {
+    printer->Print(variables_,
+      "if ($name$Count_ != 0) {\n"
+      "  size += $tag_size$;\n"
+      "  size += com.google.protobuf.micro.CodedOutputStreamMicro\n"
+      "      .computeRawVarint32Size(dataSize);\n"
+      "}\n"
+      "$name$MemoizedSerializedSize = dataSize;\n");
+  } else {
+    printer->Print(variables_,
+      "size += $tag_size$ * $name$Count_;\n");
+  }
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
+string RepeatedPrimitiveArrayFieldGenerator::GetBoxedType() const {
+  return BoxedPrimitiveTypeName(GetJavaType(descriptor_));
+}
+
 }  // namespace javamicro
 }  // namespace compiler
 }  // namespace protobuf
@@ -86,6 +86,33 @@ class RepeatedPrimitiveFieldGenerator : public FieldGenerator {
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RepeatedPrimitiveFieldGenerator);
 };
 
+// Repeated numeric and bool fields when java_use_primitive_arrays=true.  The
+// values live in a primitive array plus a count instead of a List or Vector of
+// boxed values, and packed payloads are read and written with the bulk
+// helpers in CodedInputStreamMicro / CodedOutputStreamMicro.
+class RepeatedPrimitiveArrayFieldGenerator : public FieldGenerator {
+ public:
+  explicit RepeatedPrimitiveArrayFieldGenerator(
+      const FieldDescriptor* descriptor, const Params& params);
+  ~RepeatedPrimitiveArrayFieldGenerator();
+
+  // implements FieldGenerator ---------------------------------------
+  void GenerateMembers(io::Printer* printer) const;
+  void GenerateMergingCode(io::Printer* printer) const;
+  void GenerateParsingCode(io::Printer* printer) const;
+  void GenerateParsingCodeFromPacked(io::Printer* printer) const;
+  void GenerateSerializationCode(io::Printer* printer) const;
+  void GenerateSerializedSizeCode(io::Printer* printer) const;
+
+  string GetBoxedType() const;
+
+ private:
+  const FieldDescriptor* descriptor_;
+  map<string, string> variables_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RepeatedPrimitiveArrayFieldGenerator);
+};
+
 }  // namespace javamicro
 }  // namespace compiler
 }  // namespace protobuf
@@ -58,6 +58,7 @@ void SetEnumVariables(const Params& params,
   (*variables)["capitalized_name"] =
     RenameJavaKeywords(UnderscoresToCapitalizedCamelCase(descriptor));
   (*variables)["number"] = SimpleItoa(descriptor->number());
+  (*variables)["print_name"] = PrinterFieldName(descriptor);
   if (params.use_reference_types_for_primitives()
       && !descriptor->is_repeated()) {
     (*variables)["type"] = "java.lang.Integer";
@@ -238,6 +239,23 @@ void EnumFieldGenerator::GenerateHashCodeCode(io::Printer* printer) const {
   printer->Print(";\n");
 }
 
+void EnumFieldGenerator::GenerateToStringCode(io::Printer* printer) const {
+  if (params_.use_reference_types_for_primitives()) {
+    // Unbox to avoid the String.valueOf() allocation of append(Object).
+    printer->Print(variables_,
+      "if (this.$name$ != null) {\n"
+      "  com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+      "      builder, indent, \"$print_name$\")\n"
+      "      .append((int) this.$name$).append('\\n');\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+      "    builder, indent, \"$print_name$\")\n"
+      "    .append(this.$name$).append('\\n');\n");
+  }
+}
+
 // ===================================================================
 
 AccessorEnumFieldGenerator::
@@ -327,6 +345,16 @@ GenerateHashCodeCode(io::Printer* printer) const {
     "result = 31 * result + $name$_;\n");
 }
 
+void AccessorEnumFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if ($get_has$) {\n"
+    "  com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+    "      builder, indent, \"$print_name$\")\n"
+    "      .append($name$_).append('\\n');\n"
+    "}\n");
+}
+
 // ===================================================================
 
 RepeatedEnumFieldGenerator::
@@ -511,6 +539,18 @@ GenerateHashCodeCode(io::Printer* printer) const {
     "    + com.google.protobuf.nano.InternalNano.hashCode(this.$name$);\n");
 }
 
+void RepeatedEnumFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this.$name$ != null) {\n"
+    "  for (int i = 0; i < this.$name$.length; i++) {\n"
+    "    com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+    "        builder, indent, \"$print_name$\")\n"
+    "        .append(this.$name$[i]).append('\\n');\n"
+    "  }\n"
+    "}\n");
+}
+
 }  // namespace javanano
 }  // namespace compiler
 }  // namespace protobuf
@@ -59,6 +59,7 @@ class EnumFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
@@ -82,6 +83,7 @@ class AccessorEnumFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
@@ -106,6 +108,7 @@ class RepeatedEnumFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   void GenerateRepeatedDataSizeCode(io::Printer* printer) const;
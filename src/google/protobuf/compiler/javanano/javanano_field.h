@@ -83,6 +83,12 @@ class FieldGenerator {
   virtual void GenerateEqualsCode(io::Printer* printer) const = 0;
   virtual void GenerateHashCodeCode(io::Printer* printer) const = 0;
 
+  // Generates the body of this field's part of the message's printTo()
+  // method, which appends the field in text form to a StringBuilder named
+  // 'builder', indented by 'indent' levels. Must produce the same output as
+  // the reflection-based MessageNanoPrinter.
+  virtual void GenerateToStringCode(io::Printer* printer) const = 0;
+
  protected:
   const Params& params_;
  private:
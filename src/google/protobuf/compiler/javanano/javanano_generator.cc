@@ -146,6 +146,10 @@ bool JavaNanoGenerator::Generate(const FileDescriptor* file,
       params.set_ignore_services(option_value == "true");
     } else if (option_name == "parcelable_messages") {
       params.set_parcelable_messages(option_value == "true");
+    } else if (option_name == "generate_to_string") {
+      params.set_generate_to_string(option_value == "true");
+    } else if (option_name == "reuse_on_clear") {
+      params.set_reuse_on_clear(option_value == "true");
     } else {
       *error = "Ignore unknown javanano generator option: " + option_name;
     }
@@ -264,6 +264,27 @@ string FieldDefaultConstantName(const FieldDescriptor *field) {
   return "_" + RenameJavaKeywords(UnderscoresToCamelCase(field)) + "Default";
 }
 
+string FieldRecycledName(const FieldDescriptor *field) {
+  return "_" + RenameJavaKeywords(UnderscoresToCamelCase(field)) + "Recycled";
+}
+
+string PrinterFieldName(const FieldDescriptor *field) {
+  string camel_case_name = UnderscoresToCamelCase(field);
+  string result;
+  for (int i = 0; i < camel_case_name.size(); i++) {
+    char c = camel_case_name[i];
+    if ('A' <= c && c <= 'Z') {
+      if (i != 0) {
+        result += '_';
+      }
+      result += c + ('a' - 'A');
+    } else {
+      result += c;
+    }
+  }
+  return result;
+}
+
 void PrintFieldComment(io::Printer* printer, const FieldDescriptor* field) {
   // We don't want to print group bodies so we cut off after the first line
   // (the second line for extensions).
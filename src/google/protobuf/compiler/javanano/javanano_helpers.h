@@ -112,6 +112,15 @@ string FieldConstantName(const FieldDescriptor *field);
 
 string FieldDefaultConstantName(const FieldDescriptor *field);
 
+// Get the name of the private field in which clear() keeps the field's old
+// sub-message or array for reuse, if the reuse_on_clear option is set.
+string FieldRecycledName(const FieldDescriptor *field);
+
+// Get the name under which MessageNanoPrinter prints the field, i.e. the
+// Java field name converted back to lower case with underscores.  For
+// example, a group of type "OptionalGroup" is printed as "optional_group".
+string PrinterFieldName(const FieldDescriptor *field);
+
 // Print the field's proto-syntax definition as a comment.
 void PrintFieldComment(io::Printer* printer, const FieldDescriptor* field);
 
@@ -266,6 +266,10 @@ void MessageGenerator::Generate(io::Printer* printer) {
     GenerateHashCode(printer);
   }
 
+  if (params_.generate_to_string()) {
+    GenerateToString(printer);
+  }
+
   GenerateMessageSerializationMethods(printer);
   GenerateMergeFromMethods(printer);
   GenerateParseFromMethods(printer);
@@ -544,6 +548,26 @@ void MessageGenerator::GenerateHashCode(io::Printer* printer) {
   printer->Print("}\n");
 }
 
+void MessageGenerator::GenerateToString(io::Printer* printer) {
+  // Override printTo() even if there are no fields, so that toString()
+  // never falls back to the reflection-based MessageNanoPrinter.
+  printer->Print(
+    "\n"
+    "@Override\n"
+    "public void printTo(java.lang.StringBuilder builder, int indent) {\n");
+  printer->Indent();
+
+  // Fields are printed in field number order, like they are serialized.
+  scoped_array<const FieldDescriptor*> sorted_fields(
+    SortFieldsByNumber(descriptor_));
+  for (int i = 0; i < descriptor_->field_count(); i++) {
+    field_generators_.get(sorted_fields[i]).GenerateToStringCode(printer);
+  }
+
+  printer->Outdent();
+  printer->Print("}\n");
+}
+
 // ===================================================================
 
 }  // namespace javanano
@@ -60,6 +60,7 @@ void SetMessageVariables(const Params& params,
   (*variables)["capitalized_name"] =
     RenameJavaKeywords(UnderscoresToCapitalizedCamelCase(descriptor));
   (*variables)["number"] = SimpleItoa(descriptor->number());
+  (*variables)["print_name"] = PrinterFieldName(descriptor);
   (*variables)["type"] = ClassName(params, descriptor->message_type());
   (*variables)["group_or_message"] =
     (descriptor->type() == FieldDescriptor::TYPE_GROUP) ?
@@ -67,6 +68,7 @@ void SetMessageVariables(const Params& params,
   (*variables)["message_name"] = descriptor->containing_type()->name();
   //(*variables)["message_type"] = descriptor->message_type()->name();
   (*variables)["tag"] = SimpleItoa(WireFormat::MakeTag(descriptor));
+  (*variables)["recycled"] = FieldRecycledName(descriptor);
 }
 
 }  // namespace
@@ -85,20 +87,43 @@ void MessageFieldGenerator::
 GenerateMembers(io::Printer* printer, bool /* unused lazy_init */) const {
   printer->Print(variables_,
     "public $type$ $name$;\n");
+
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "private $type$ $recycled$;\n");
+  }
 }
 
 void MessageFieldGenerator::
 GenerateClearCode(io::Printer* printer) const {
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "if ($name$ != null) {\n"
+      "  $recycled$ = $name$;\n"
+      "}\n");
+  }
   printer->Print(variables_,
     "$name$ = null;\n");
 }
 
 void MessageFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
-  printer->Print(variables_,
-    "if (this.$name$ == null) {\n"
-    "  this.$name$ = new $type$();\n"
-    "}\n");
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "if (this.$name$ == null) {\n"
+      "  if ($recycled$ != null) {\n"
+      "    this.$name$ = $recycled$.clear();\n"
+      "    $recycled$ = null;\n"
+      "  } else {\n"
+      "    this.$name$ = new $type$();\n"
+      "  }\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "if (this.$name$ == null) {\n"
+      "  this.$name$ = new $type$();\n"
+      "}\n");
+  }
 
   if (descriptor_->type() == FieldDescriptor::TYPE_GROUP) {
     printer->Print(variables_,
@@ -147,6 +172,18 @@ GenerateHashCodeCode(io::Printer* printer) const {
     "    (this.$name$ == null ? 0 : this.$name$.hashCode());\n");
 }
 
+void MessageFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this.$name$ != null) {\n"
+    "  com.google.protobuf.nano.MessageNanoPrinter.appendIndent(builder, indent);\n"
+    "  builder.append(\"$print_name$ <\\n\");\n"
+    "  this.$name$.printTo(builder, indent + 1);\n"
+    "  com.google.protobuf.nano.MessageNanoPrinter.appendIndent(builder, indent);\n"
+    "  builder.append(\">\\n\");\n"
+    "}\n");
+}
+
 // ===================================================================
 
 RepeatedMessageFieldGenerator::
@@ -161,10 +198,21 @@ void RepeatedMessageFieldGenerator::
 GenerateMembers(io::Printer* printer, bool /* unused lazy_init */) const {
   printer->Print(variables_,
     "public $type$[] $name$;\n");
+
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "private $type$[] $recycled$;\n");
+  }
 }
 
 void RepeatedMessageFieldGenerator::
 GenerateClearCode(io::Printer* printer) const {
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "if ($name$ != null && $name$.length != 0) {\n"
+      "  $recycled$ = $name$;\n"
+      "}\n");
+  }
   printer->Print(variables_,
     "$name$ = $type$.emptyArray();\n");
 }
@@ -175,14 +223,44 @@ GenerateMergingCode(io::Printer* printer) const {
   printer->Print(variables_,
     "int arrayLength = com.google.protobuf.nano.WireFormatNano\n"
     "    .getRepeatedFieldArrayLength(input, $tag$);\n"
-    "int i = this.$name$ == null ? 0 : this.$name$.length;\n"
-    "$type$[] newArray =\n"
-    "    new $type$[i + arrayLength];\n"
-    "if (i != 0) {\n"
-    "  java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
-    "}\n"
-    "for (; i < newArray.length - 1; i++) {\n"
-    "  newArray[i] = new $type$();\n");
+    "int i = this.$name$ == null ? 0 : this.$name$.length;\n");
+
+  if (params_.reuse_on_clear()) {
+    // Take the array from before the last clear() if it has exactly the
+    // right length, otherwise at least reuse its elements. Reused elements
+    // are cleared before parsing into them.
+    printer->Print(variables_,
+      "$type$[] newArray;\n"
+      "if (i == 0 && $recycled$ != null\n"
+      "    && $recycled$.length == arrayLength) {\n"
+      "  newArray = $recycled$;\n"
+      "} else {\n"
+      "  newArray = new $type$[i + arrayLength];\n"
+      "  if (i != 0) {\n"
+      "    java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
+      "  }\n"
+      "  if ($recycled$ != null) {\n"
+      "    java.lang.System.arraycopy($recycled$, 0, newArray, i,\n"
+      "        java.lang.Math.min($recycled$.length, arrayLength));\n"
+      "  }\n"
+      "}\n"
+      "$recycled$ = null;\n"
+      "for (; i < newArray.length - 1; i++) {\n"
+      "  if (newArray[i] == null) {\n"
+      "    newArray[i] = new $type$();\n"
+      "  } else {\n"
+      "    newArray[i].clear();\n"
+      "  }\n");
+  } else {
+    printer->Print(variables_,
+      "$type$[] newArray =\n"
+      "    new $type$[i + arrayLength];\n"
+      "if (i != 0) {\n"
+      "  java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
+      "}\n"
+      "for (; i < newArray.length - 1; i++) {\n"
+      "  newArray[i] = new $type$();\n");
+  }
 
   if (descriptor_->type() == FieldDescriptor::TYPE_GROUP) {
     printer->Print(variables_,
@@ -195,8 +273,18 @@ GenerateMergingCode(io::Printer* printer) const {
   printer->Print(variables_,
     "  input.readTag();\n"
     "}\n"
-    "// Last one without readTag.\n"
-    "newArray[i] = new $type$();\n");
+    "// Last one without readTag.\n");
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "if (newArray[i] == null) {\n"
+      "  newArray[i] = new $type$();\n"
+      "} else {\n"
+      "  newArray[i].clear();\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "newArray[i] = new $type$();\n");
+  }
 
   if (descriptor_->type() == FieldDescriptor::TYPE_GROUP) {
     printer->Print(variables_,
@@ -253,6 +341,23 @@ GenerateHashCodeCode(io::Printer* printer) const {
     "    + com.google.protobuf.nano.InternalNano.hashCode(this.$name$);\n");
 }
 
+void RepeatedMessageFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  printer->Print(variables_,
+    "if (this.$name$ != null) {\n"
+    "  for (int i = 0; i < this.$name$.length; i++) {\n"
+    "    $type$ element = this.$name$[i];\n"
+    "    if (element != null) {\n"
+    "      com.google.protobuf.nano.MessageNanoPrinter.appendIndent(builder, indent);\n"
+    "      builder.append(\"$print_name$ <\\n\");\n"
+    "      element.printTo(builder, indent + 1);\n"
+    "      com.google.protobuf.nano.MessageNanoPrinter.appendIndent(builder, indent);\n"
+    "      builder.append(\">\\n\");\n"
+    "    }\n"
+    "  }\n"
+    "}\n");
+}
+
 }  // namespace javanano
 }  // namespace compiler
 }  // namespace protobuf
@@ -64,6 +64,8 @@ class Params {
   bool generate_equals_;
   bool ignore_services_;
   bool parcelable_messages_;
+  bool generate_to_string_;
+  bool reuse_on_clear_;
 
  public:
   Params(const string & base_name) :
@@ -77,7 +79,9 @@ class Params {
     use_reference_types_for_primitives_(false),
     generate_equals_(false),
     ignore_services_(false),
-    parcelable_messages_(false) {
+    parcelable_messages_(false),
+    generate_to_string_(false),
+    reuse_on_clear_(false) {
   }
 
   const string& base_name() const {
@@ -213,6 +217,20 @@ class Params {
   bool parcelable_messages() const {
     return parcelable_messages_;
   }
+
+  void set_generate_to_string(bool value) {
+    generate_to_string_ = value;
+  }
+  bool generate_to_string() const {
+    return generate_to_string_;
+  }
+
+  void set_reuse_on_clear(bool value) {
+    reuse_on_clear_ = value;
+  }
+  bool reuse_on_clear() const {
+    return reuse_on_clear_;
+  }
 };
 
 }  // namespace javanano
@@ -193,6 +193,7 @@ void SetPrimitiveVariables(const FieldDescriptor* descriptor, const Params param
   (*variables)["capitalized_name"] =
     RenameJavaKeywords(UnderscoresToCapitalizedCamelCase(descriptor));
   (*variables)["number"] = SimpleItoa(descriptor->number());
+  (*variables)["print_name"] = PrinterFieldName(descriptor);
   if (params.use_reference_types_for_primitives()
       && !descriptor->is_repeated()) {
     (*variables)["type"] = BoxedPrimitiveTypeName(GetJavaType(descriptor));
@@ -250,6 +251,13 @@ void SetPrimitiveVariables(const FieldDescriptor* descriptor, const Params param
   }
   (*variables)["message_name"] = descriptor->containing_type()->name();
   (*variables)["empty_array_name"] = EmptyArrayName(params, descriptor);
+  (*variables)["recycled"] = FieldRecycledName(descriptor);
+  if (descriptor->type() == FieldDescriptor::TYPE_BYTES) {
+    (*variables)["new_array"] = "new byte[i + arrayLength][]";
+  } else {
+    (*variables)["new_array"] =
+        "new " + (*variables)["type"] + "[i + arrayLength]";
+  }
 }
 }  // namespace
 
@@ -513,6 +521,49 @@ GenerateHashCodeCode(io::Printer* printer) const {
   }
 }
 
+void PrimitiveFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  JavaType java_type = GetJavaType(descriptor_);
+  bool nullable = IsReferenceType(java_type)
+      || params_.use_reference_types_for_primitives();
+  if (nullable) {
+    printer->Print(variables_,
+      "if (this.$name$ != null) {\n");
+    printer->Indent();
+  }
+  printer->Print(variables_,
+    "com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+    "    builder, indent, \"$print_name$\")");
+  if (java_type == JAVATYPE_STRING) {
+    printer->Print(variables_,
+      ";\n"
+      "com.google.protobuf.nano.MessageNanoPrinter.appendQuotedString(\n"
+      "    builder, this.$name$);\n"
+      "builder.append('\\n');\n");
+  } else if (java_type == JAVATYPE_BYTES) {
+    printer->Print(variables_,
+      ";\n"
+      "com.google.protobuf.nano.MessageNanoPrinter.appendQuotedBytes(\n"
+      "    builder, this.$name$);\n"
+      "builder.append('\\n');\n");
+  } else if (params_.use_reference_types_for_primitives()) {
+    // Unbox to avoid the String.valueOf() allocation of append(Object).
+    printer->Print(
+      "\n"
+      "    .append(($primitive_type$) this.$name$).append('\\n');\n",
+      "primitive_type", PrimitiveTypeName(java_type),
+      "name", variables_.find("name")->second);
+  } else {
+    printer->Print(variables_,
+      "\n"
+      "    .append(this.$name$).append('\\n');\n");
+  }
+  if (nullable) {
+    printer->Outdent();
+    printer->Print("}\n");
+  }
+}
+
 // ===================================================================
 
 AccessorPrimitiveFieldGenerator::
@@ -704,6 +755,37 @@ GenerateHashCodeCode(io::Printer* printer) const {
   }
 }
 
+void AccessorPrimitiveFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  // Accessor style would guarantee $name$_ non-null
+  printer->Print(variables_,
+    "if ($get_has$) {\n"
+    "  com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+    "      builder, indent, \"$print_name$\")");
+  switch (GetJavaType(descriptor_)) {
+    case JAVATYPE_STRING:
+      printer->Print(variables_,
+        ";\n"
+        "  com.google.protobuf.nano.MessageNanoPrinter.appendQuotedString(\n"
+        "      builder, $name$_);\n"
+        "  builder.append('\\n');\n");
+      break;
+    case JAVATYPE_BYTES:
+      printer->Print(variables_,
+        ";\n"
+        "  com.google.protobuf.nano.MessageNanoPrinter.appendQuotedBytes(\n"
+        "      builder, $name$_);\n"
+        "  builder.append('\\n');\n");
+      break;
+    default:
+      printer->Print(variables_,
+        "\n"
+        "      .append($name$_).append('\\n');\n");
+      break;
+  }
+  printer->Print("}\n");
+}
+
 // ===================================================================
 
 RepeatedPrimitiveFieldGenerator::
@@ -718,14 +800,53 @@ void RepeatedPrimitiveFieldGenerator::
 GenerateMembers(io::Printer* printer, bool /*unused init_defaults*/) const {
   printer->Print(variables_,
     "public $type$[] $name$;\n");
+
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "private $type$[] $recycled$;\n");
+  }
 }
 
 void RepeatedPrimitiveFieldGenerator::
 GenerateClearCode(io::Printer* printer) const {
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "if ($name$ != null && $name$.length != 0) {\n"
+      "  $recycled$ = $name$;\n"
+      "}\n");
+  }
   printer->Print(variables_,
     "$name$ = $default$;\n");
 }
 
+void RepeatedPrimitiveFieldGenerator::
+GenerateNewArrayCode(io::Printer* printer) const {
+  // Declares newArray with room for 'i' existing and 'arrayLength' new
+  // elements, and copies the existing ones over. The array from before the
+  // last clear() is taken instead if it has exactly the right length; as
+  // the array length is the element count, a longer one cannot be used.
+  if (params_.reuse_on_clear()) {
+    printer->Print(variables_,
+      "$type$[] newArray;\n"
+      "if (i == 0 && $recycled$ != null\n"
+      "    && $recycled$.length == arrayLength) {\n"
+      "  newArray = $recycled$;\n"
+      "} else {\n"
+      "  newArray = $new_array$;\n"
+      "  if (i != 0) {\n"
+      "    java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
+      "  }\n"
+      "}\n"
+      "$recycled$ = null;\n");
+  } else {
+    printer->Print(variables_,
+      "$type$[] newArray = $new_array$;\n"
+      "if (i != 0) {\n"
+      "  java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
+      "}\n");
+  }
+}
+
 void RepeatedPrimitiveFieldGenerator::
 GenerateMergingCode(io::Printer* printer) const {
   // First, figure out the length of the array, then parse.
@@ -733,18 +854,8 @@ GenerateMergingCode(io::Printer* printer) const {
     "int arrayLength = com.google.protobuf.nano.WireFormatNano\n"
     "    .getRepeatedFieldArrayLength(input, $non_packed_tag$);\n"
     "int i = this.$name$ == null ? 0 : this.$name$.length;\n");
-
-  if (GetJavaType(descriptor_) == JAVATYPE_BYTES) {
-    printer->Print(variables_,
-      "byte[][] newArray = new byte[i + arrayLength][];\n");
-  } else {
-    printer->Print(variables_,
-      "$type$[] newArray = new $type$[i + arrayLength];\n");
-  }
+  GenerateNewArrayCode(printer);
   printer->Print(variables_,
-    "if (i != 0) {\n"
-    "  java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
-    "}\n"
     "for (; i < newArray.length - 1; i++) {\n"
     "  newArray[i] = input.read$capitalized_type$();\n"
     "  input.readTag();\n"
@@ -783,11 +894,9 @@ GenerateMergingCodeFromPacked(io::Printer* printer) const {
   }
 
   printer->Print(variables_,
-    "int i = this.$name$ == null ? 0 : this.$name$.length;\n"
-    "$type$[] newArray = new $type$[i + arrayLength];\n"
-    "if (i != 0) {\n"
-    "  java.lang.System.arraycopy(this.$name$, 0, newArray, 0, i);\n"
-    "}\n"
+    "int i = this.$name$ == null ? 0 : this.$name$.length;\n");
+  GenerateNewArrayCode(printer);
+  printer->Print(variables_,
     "for (; i < newArray.length; i++) {\n"
     "  newArray[i] = input.read$capitalized_type$();\n"
     "}\n"
@@ -904,6 +1013,38 @@ GenerateHashCodeCode(io::Printer* printer) const {
     "    + com.google.protobuf.nano.InternalNano.hashCode(this.$name$);\n");
 }
 
+void RepeatedPrimitiveFieldGenerator::
+GenerateToStringCode(io::Printer* printer) const {
+  JavaType java_type = GetJavaType(descriptor_);
+  printer->Print(variables_,
+    "if (this.$name$ != null) {\n"
+    "  for (int i = 0; i < this.$name$.length; i++) {\n");
+  printer->Indent();
+  printer->Indent();
+  if (IsReferenceType(java_type)) {
+    // Null elements are silently ignored, as in serialization.
+    printer->Print(variables_,
+      "$type$ element = this.$name$[i];\n"
+      "if (element != null) {\n"
+      "  com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+      "      builder, indent, \"$print_name$\");\n"
+      "  com.google.protobuf.nano.MessageNanoPrinter.appendQuoted$capitalized_type$(\n"
+      "      builder, element);\n"
+      "  builder.append('\\n');\n"
+      "}\n");
+  } else {
+    printer->Print(variables_,
+      "com.google.protobuf.nano.MessageNanoPrinter.appendFieldName(\n"
+      "    builder, indent, \"$print_name$\")\n"
+      "    .append(this.$name$[i]).append('\\n');\n");
+  }
+  printer->Outdent();
+  printer->Outdent();
+  printer->Print(
+    "  }\n"
+    "}\n");
+}
+
 }  // namespace javanano
 }  // namespace compiler
 }  // namespace protobuf
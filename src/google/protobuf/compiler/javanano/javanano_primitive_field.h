@@ -60,6 +60,7 @@ class PrimitiveFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   void GenerateSerializationConditional(io::Printer* printer) const;
@@ -86,6 +87,7 @@ class AccessorPrimitiveFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   const FieldDescriptor* descriptor_;
@@ -108,9 +110,11 @@ class RepeatedPrimitiveFieldGenerator : public FieldGenerator {
   void GenerateSerializedSizeCode(io::Printer* printer) const;
   void GenerateEqualsCode(io::Printer* printer) const;
   void GenerateHashCodeCode(io::Printer* printer) const;
+  void GenerateToStringCode(io::Printer* printer) const;
 
  private:
   void GenerateRepeatedDataSizeCode(io::Printer* printer) const;
+  void GenerateNewArrayCode(io::Printer* printer) const;
 
   const FieldDescriptor* descriptor_;
   map<string, string> variables_;
@@ -433,6 +433,9 @@ bool Parser::ParseMessageStatement(DescriptorProto* message) {
                        message->mutable_nested_type());
   } else if (LookingAt("option")) {
     return ParseOption(message->mutable_options());
+  } else if (LookingAt("oneof")) {
+    int oneof_index = message->oneof_decl_size();
+    return ParseOneof(message->add_oneof_decl(), message, oneof_index);
   } else {
     return ParseMessageField(message->add_field(),
                              message->mutable_nested_type());
@@ -441,11 +444,21 @@ bool Parser::ParseMessageStatement(DescriptorProto* message) {
 
 bool Parser::ParseMessageField(FieldDescriptorProto* field,
                                RepeatedPtrField<DescriptorProto>* messages) {
+  if (LookingAt("map")) {
+    return ParseMapField(field, messages);
+  }
+
   // Parse label and type.
   FieldDescriptorProto::Label label;
   DO(ParseLabel(&label));
   field->set_label(label);
 
+  return ParseMessageFieldNoLabel(field, messages);
+}
+
+bool Parser::ParseMessageFieldNoLabel(
+    FieldDescriptorProto* field,
+    RepeatedPtrField<DescriptorProto>* messages) {
   RecordLocation(field, DescriptorPool::ErrorCollector::TYPE);
   FieldDescriptorProto::Type type = FieldDescriptorProto::TYPE_INT32;
   string type_name;
@@ -502,6 +515,161 @@ bool Parser::ParseMessageField(FieldDescriptorProto* field,
   return true;
 }
 
+bool Parser::ParseMapField(FieldDescriptorProto* field,
+                           RepeatedPtrField<DescriptorProto>* messages) {
+  if (field->has_extendee()) {
+    AddError("Map fields are not allowed in extensions.");
+  }
+  field->set_label(FieldDescriptorProto::LABEL_REPEATED);
+
+  // Parse the key and value types.  They become the fields of the entry
+  // type:
+  //   message FooEntry {
+  //     optional KeyType key = 1;
+  //     optional ValueType value = 2;
+  //   }
+  //   repeated FooEntry foo = 1 [experimental_map_key = "key"];
+  RecordLocation(field, DescriptorPool::ErrorCollector::TYPE);
+  DO(Consume("map"));
+  DO(Consume("<"));
+  FieldDescriptorProto::Type key_type = FieldDescriptorProto::TYPE_INT32;
+  string key_type_name;
+  io::Tokenizer::Token key_token = input_->current();
+  DO(ParseType(&key_type, &key_type_name));
+  if (key_type_name.empty() &&
+      (key_type == FieldDescriptorProto::TYPE_FLOAT ||
+       key_type == FieldDescriptorProto::TYPE_DOUBLE ||
+       key_type == FieldDescriptorProto::TYPE_GROUP)) {
+    AddError(key_token.line, key_token.column,
+      "Map keys must be integers, bools, strings or enums.");
+  }
+  DO(Consume(","));
+  FieldDescriptorProto::Type value_type = FieldDescriptorProto::TYPE_INT32;
+  string value_type_name;
+  io::Tokenizer::Token value_token = input_->current();
+  DO(ParseType(&value_type, &value_type_name));
+  if (value_type_name.empty() &&
+      value_type == FieldDescriptorProto::TYPE_GROUP) {
+    AddError(value_token.line, value_token.column,
+      "Map values cannot be groups.");
+  }
+  DO(Consume(">"));
+
+  // Parse name and '='.
+  RecordLocation(field, DescriptorPool::ErrorCollector::NAME);
+  io::Tokenizer::Token name_token = input_->current();
+  DO(ConsumeIdentifier(field->mutable_name(), "Expected field name."));
+  DO(Consume("=", "Missing field number."));
+
+  // Parse field number.
+  RecordLocation(field, DescriptorPool::ErrorCollector::NUMBER);
+  int number;
+  DO(ConsumeInteger(&number, "Expected field number."));
+  field->set_number(number);
+
+  // Parse options.
+  DO(ParseFieldOptions(field));
+  DO(Consume(";"));
+
+  // The entry type is named after the field, e.g. "foo_bar" gets a
+  // "FooBarEntry".
+  string entry_name;
+  bool capitalize_next = true;
+  for (int i = 0; i < field->name().size(); i++) {
+    char c = field->name()[i];
+    if (c == '_') {
+      capitalize_next = true;
+    } else if (capitalize_next && 'a' <= c && c <= 'z') {
+      entry_name.push_back(c - 'a' + 'A');
+      capitalize_next = false;
+    } else {
+      entry_name.push_back(c);
+      capitalize_next = false;
+    }
+  }
+  entry_name.append("Entry");
+
+  DescriptorProto* entry = messages->Add();
+  entry->set_name(entry_name);
+  entry->mutable_options()->set_map_entry(true);
+  // Record name location to match the field name's location.
+  RecordLocation(entry, DescriptorPool::ErrorCollector::NAME,
+                 name_token.line, name_token.column);
+
+  FieldDescriptorProto* key = entry->add_field();
+  key->set_name("key");
+  key->set_number(1);
+  key->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+  if (key_type_name.empty()) {
+    key->set_type(key_type);
+  } else {
+    key->set_type_name(key_type_name);
+  }
+
+  FieldDescriptorProto* value = entry->add_field();
+  value->set_name("value");
+  value->set_number(2);
+  value->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+  if (value_type_name.empty()) {
+    value->set_type(value_type);
+  } else {
+    value->set_type_name(value_type_name);
+  }
+
+  field->set_type_name(entry_name);
+  field->mutable_options()->set_experimental_map_key("key");
+  return true;
+}
+
+bool Parser::ParseOneof(OneofDescriptorProto* oneof_decl,
+                        DescriptorProto* containing_type,
+                        int oneof_index) {
+  DO(Consume("oneof"));
+
+  RecordLocation(oneof_decl, DescriptorPool::ErrorCollector::NAME);
+  DO(ConsumeIdentifier(oneof_decl->mutable_name(), "Expected oneof name."));
+
+  DO(Consume("{"));
+
+  do {
+    if (AtEnd()) {
+      AddError("Reached end of input in oneof definition (missing '}').");
+      return false;
+    }
+
+    // Print a nice error if the user accidentally tries to place a label
+    // on an individual member of a oneof.
+    if (LookingAt("required") ||
+        LookingAt("optional") ||
+        LookingAt("repeated")) {
+      AddError("Fields in oneofs must not have labels (required / optional "
+               "/ repeated).");
+      // We can continue parsing here because we understand what the user
+      // meant.  The error report will still make parsing fail overall.
+      input_->Next();
+    }
+
+    if (LookingAt("map")) {
+      AddError("Map fields are not allowed in oneofs.");
+      SkipStatement();
+      continue;
+    }
+
+    FieldDescriptorProto* field = containing_type->add_field();
+    field->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+    field->set_oneof_index(oneof_index);
+
+    if (!ParseMessageFieldNoLabel(field,
+                                  containing_type->mutable_nested_type())) {
+      // This statement failed to parse.  Skip it, but keep looping to
+      // parse other statements.
+      SkipStatement();
+    }
+  } while (!TryConsume("}"));
+
+  return true;
+}
+
 bool Parser::ParseFieldOptions(FieldDescriptorProto* field) {
   if (!TryConsume("[")) return true;
 
@@ -238,6 +238,23 @@ class LIBPROTOBUF_EXPORT Parser {
   bool ParseMessageField(FieldDescriptorProto* field,
                          RepeatedPtrField<DescriptorProto>* messages);
 
+  // Like ParseMessageField(), but the label has already been determined by
+  // the caller.  Used for oneof members, which are always optional.
+  bool ParseMessageFieldNoLabel(FieldDescriptorProto* field,
+                                RepeatedPtrField<DescriptorProto>* messages);
+
+  // Parse a "oneof" block, e.g. "oneof choice { int32 a = 1; string b = 2; }".
+  // Its members are added to containing_type's fields with their
+  // oneof_index set to oneof_index.
+  bool ParseOneof(OneofDescriptorProto* oneof_decl,
+                  DescriptorProto* containing_type,
+                  int oneof_index);
+
+  // Parse a map field, e.g. "map<string, int32> counts = 1;".  It is lowered
+  // to a repeated field of a new entry type, which is added to "messages".
+  bool ParseMapField(FieldDescriptorProto* field,
+                     RepeatedPtrField<DescriptorProto>* messages);
+
   // Parse an "extensions" declaration.
   bool ParseExtensions(DescriptorProto* message);
 
@@ -444,6 +444,52 @@ TEST_F(ParseMessageTest, Group) {
     "}");
 }
 
+TEST_F(ParseMessageTest, MapField) {
+  ExpectParsesTo(
+    "message TestMessage {\n"
+    "  map<string, Foo> foo_bar = 1;\n"
+    "}\n",
+
+    "message_type {"
+    "  name: \"TestMessage\""
+    "  nested_type {"
+    "    name: \"FooBarEntry\""
+    "    field { name:\"key\" label:LABEL_OPTIONAL number:1"
+    "            type:TYPE_STRING }"
+    "    field { name:\"value\" label:LABEL_OPTIONAL number:2"
+    "            type_name:\"Foo\" }"
+    "    options { map_entry: true }"
+    "  }"
+    "  field { name:\"foo_bar\" label:LABEL_REPEATED number:1"
+    "          type_name: \"FooBarEntry\""
+    "          options { experimental_map_key: \"key\" } }"
+    "}");
+}
+
+TEST_F(ParseMessageTest, Oneof) {
+  ExpectParsesTo(
+    "message TestMessage {\n"
+    "  oneof foo {\n"
+    "    int32 a = 1;\n"
+    "    string b = 2;\n"
+    "    TestMessage c = 3;\n"
+    "  }\n"
+    "  optional int32 d = 4;\n"
+    "}\n",
+
+    "message_type {"
+    "  name: \"TestMessage\""
+    "  field { name:\"a\" label:LABEL_OPTIONAL type:TYPE_INT32 number:1 "
+    "          oneof_index:0 }"
+    "  field { name:\"b\" label:LABEL_OPTIONAL type:TYPE_STRING number:2 "
+    "          oneof_index:0 }"
+    "  field { name:\"c\" label:LABEL_OPTIONAL type_name:\"TestMessage\" "
+    "          number:3 oneof_index:0 }"
+    "  field { name:\"d\" label:LABEL_OPTIONAL type:TYPE_INT32 number:4 }"
+    "  oneof_decl { name:\"foo\" }"
+    "}");
+}
+
 TEST_F(ParseMessageTest, NestedMessage) {
   ExpectParsesTo(
     "message TestMessage {\n"
@@ -902,6 +948,41 @@ TEST_F(ParseErrorTest, GroupMissingBody) {
     "1:24: Missing group body.\n");
 }
 
+TEST_F(ParseErrorTest, MapFloatKey) {
+  ExpectHasErrors(
+    "message TestMessage {\n"
+    "  map<double, int32> foo = 1;\n"
+    "}\n",
+    "1:6: Map keys must be integers, bools, strings or enums.\n");
+}
+
+TEST_F(ParseErrorTest, MapInExtension) {
+  ExpectHasErrors(
+    "extend Foo { map<int32, int32> foo = 1; }\n",
+    "0:13: Map fields are not allowed in extensions.\n");
+}
+
+TEST_F(ParseErrorTest, LabelInOneof) {
+  ExpectHasErrors(
+    "message TestMessage {\n"
+    "  oneof foo {\n"
+    "    optional int32 bar = 1;\n"
+    "  }\n"
+    "}\n",
+    "2:4: Fields in oneofs must not have labels (required / optional "
+      "/ repeated).\n");
+}
+
+TEST_F(ParseErrorTest, MapInOneof) {
+  ExpectHasErrors(
+    "message TestMessage {\n"
+    "  oneof foo {\n"
+    "    map<int32, int32> bar = 1;\n"
+    "  }\n"
+    "}\n",
+    "2:4: Map fields are not allowed in oneofs.\n");
+}
+
 TEST_F(ParseErrorTest, ExtendingPrimitive) {
   ExpectHasErrors(
     "extend int32 { optional string foo = 4; }\n",
@@ -1052,6 +1133,25 @@ TEST_F(ParserValidationErrorTest, FieldTypeError) {
     "1:11: \"Baz\" is not defined.\n");
 }
 
+TEST_F(ParserValidationErrorTest, MapMessageKeyError) {
+  ExpectHasValidationErrors(
+    "message Foo {\n"
+    "  map<Foo, int32> bar = 1;\n"
+    "}\n",
+    "1:2: Map keys must be integers, bools, strings or enums.\n");
+}
+
+TEST_F(ParserValidationErrorTest, MapEntryNameConflict) {
+  ExpectHasValidationErrors(
+    "message Foo {\n"
+    "  message BarEntry {}\n"
+    "  map<int32, int32> bar = 1;\n"
+    "}\n",
+    "2:20: \"BarEntry\" is already defined in \"Foo\".\n"
+    "1:10: Map entry type \"BarEntry\" conflicts with an existing nested "
+      "message type.\n");
+}
+
 TEST_F(ParserValidationErrorTest, FieldNumberError) {
   ExpectHasValidationErrors(
     "message Foo {\n"
@@ -178,6 +178,7 @@ CodeGeneratorRequest::CodeGeneratorRequest(const CodeGeneratorRequest& from)
 
 void CodeGeneratorRequest::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   parameter_ = const_cast< ::std::string*>(&_default_parameter_);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
@@ -225,6 +226,7 @@ void CodeGeneratorRequest::Clear() {
   file_to_generate_.Clear();
   proto_file_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -276,6 +278,9 @@ bool CodeGeneratorRequest::MergePartialFromCodedStream(
          parse_proto_file:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_proto_file()));
+          if (!this->proto_file(this->proto_file_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -449,6 +454,11 @@ bool CodeGeneratorRequest::IsInitialized() const {
   return true;
 }
 
+bool CodeGeneratorRequest::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void CodeGeneratorRequest::Swap(CodeGeneratorRequest* other) {
   if (other != this) {
     file_to_generate_.Swap(&other->file_to_generate_);
@@ -457,6 +467,7 @@ void CodeGeneratorRequest::Swap(CodeGeneratorRequest* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -42,6 +42,7 @@
 // performance-minded Python code leverage the fast C++ implementation
 // directly.
 
+#include <algorithm>
 #include <limits>
 #include <map>
 #include <utility>
@@ -52,10 +53,12 @@
 #include <google/protobuf/descriptor.pb.h>
 
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/printer.h>
 #include <google/protobuf/descriptor.h>
 #include <google/protobuf/io/zero_copy_stream.h>
 #include <google/protobuf/stubs/strutil.h>
+#include <google/protobuf/wire_format.h>
 #include <google/protobuf/stubs/substitute.h>
 
 namespace google {
@@ -106,6 +109,25 @@ string NamePrefixedWithNestedTypes(const DescriptorT& descriptor,
 const char kDescriptorKey[] = "DESCRIPTOR";
 
 
+// Sort fields by field number.
+struct FieldOrderingByNumber {
+  inline bool operator()(const FieldDescriptor* a,
+                         const FieldDescriptor* b) const {
+    return a->number() < b->number();
+  }
+};
+
+
+// Returns the encoded tag that introduces |field| on the wire, taking its
+// packed option into account.
+string TagBytes(const FieldDescriptor& field) {
+  uint8 buffer[5];
+  uint8* end = io::CodedOutputStream::WriteVarint32ToArray(
+      internal::WireFormat::MakeTag(&field), buffer);
+  return string(reinterpret_cast<char*>(buffer), end - buffer);
+}
+
+
 // Should we generate generic services for this file?
 inline bool HasGenericServices(const FileDescriptor *file) {
   return file->service_count() > 0 &&
@@ -116,7 +138,8 @@ inline bool HasGenericServices(const FileDescriptor *file) {
 // Prints the common boilerplate needed at the top of every .py
 // file output by this generator.
 void PrintTopBoilerplate(
-    io::Printer* printer, const FileDescriptor* file, bool descriptor_proto) {
+    io::Printer* printer, const FileDescriptor* file, bool descriptor_proto,
+    bool specialized_codecs) {
   // TODO(robinson): Allow parameterization of Python version?
   printer->Print(
       "# Generated by the protocol buffer compiler.  DO NOT EDIT!\n"
@@ -135,6 +158,13 @@ void PrintTopBoilerplate(
     printer->Print(
         "from google.protobuf import descriptor_pb2\n");
   }
+  if (specialized_codecs) {
+    printer->Print(
+        "from google.protobuf.internal import api_implementation\n"
+        "from google.protobuf.internal import decoder\n"
+        "from google.protobuf.internal import wire_format\n"
+        "import struct\n");
+  }
   printer->Print(
     "# @@protoc_insertion_point(imports)\n");
   printer->Print("\n\n");
@@ -222,7 +252,7 @@ string StringifyDefaultValue(const FieldDescriptor& field) {
 }  // namespace
 
 
-Generator::Generator() : file_(NULL) {
+Generator::Generator() : file_(NULL), specialized_codecs_(false) {
 }
 
 Generator::~Generator() {
@@ -241,6 +271,18 @@ bool Generator::Generate(const FileDescriptor* file,
   //   the stack and use that, so that the Generator class itself does not need
   //   to have any mutable members.  Then it is implicitly thread-safe.
   MutexLock lock(&mutex_);
+
+  vector<pair<string, string> > options;
+  ParseGeneratorParameter(parameter, &options);
+
+  specialized_codecs_ = false;
+  for (int i = 0; i < options.size(); i++) {
+    // Unknown options are ignored, as they always have been.
+    if (options[i].first == "specialized_codecs") {
+      specialized_codecs_ = true;
+    }
+  }
+
   file_ = file;
   string module_name = ModuleName(file->name());
   string filename = module_name;
@@ -257,21 +299,27 @@ bool Generator::Generate(const FileDescriptor* file,
   io::Printer printer(output.get(), '$');
   printer_ = &printer;
 
-  PrintTopBoilerplate(printer_, file_, GeneratingDescriptorProto());
+  PrintTopBoilerplate(printer_, file_, GeneratingDescriptorProto(),
+                      specialized_codecs_);
+  // Dependencies are imported before our own FileDescriptor is constructed:
+  // the C++ implementation of the Python API (see internal/cpp_message.py)
+  // adds each file to its DescriptorPool at that point, and the pool needs
+  // the dependencies first.
+  PrintImports();
   PrintFileDescriptor();
   PrintTopLevelEnums();
   PrintTopLevelExtensions();
   PrintAllNestedEnumsInFile();
   PrintMessageDescriptors();
-  // We have to print the imports after the descriptors, so that mutually
-  // recursive protos in separate files can successfully reference each other.
-  PrintImports();
   FixForeignFieldsInDescriptors();
   PrintMessages();
   // We have to fix up the extensions after the message classes themselves,
   // since they need to call static RegisterExtension() methods on these
   // classes.
   FixForeignFieldsInExtensions();
+  if (specialized_codecs_) {
+    PrintSpecializedCodecs();
+  }
   if (HasGenericServices(file)) {
     PrintServices();
   }
@@ -802,6 +850,277 @@ void Generator::FixForeignFieldsInNestedExtensions(
   }
 }
 
+// Prints, for every message type in the file, a function that replaces the
+// class's generic _InternalParse() and _InternalSerialize() (see
+// reflection.py) with ones written out for that type.  Only used with the
+// "specialized_codecs" option, and only installed when the pure-Python
+// implementation is in use.
+void Generator::PrintSpecializedCodecs() const {
+  printer_->Print(
+      "# Parsing and serialization specialized for each message type.\n"
+      "if api_implementation.Type() == 'python':\n");
+  printer_->Indent();
+  printer_->Print(
+      "_DecodeError = message.DecodeError\n"
+      "_DecodeVarint = decoder._DecodeVarint\n"
+      "_DecodeVarint32 = decoder._DecodeVarint32\n"
+      "_DecodeSignedVarint = decoder._DecodeSignedVarint\n"
+      "_DecodeSignedVarint32 = decoder._DecodeSignedVarint32\n"
+      "_ZigZagDecode = wire_format.ZigZagDecode\n"
+      "_Unpack = struct.unpack\n");
+  for (int i = 0; i < file_->message_type_count(); ++i) {
+    PrintSpecializedCodecsForMessage(*file_->message_type(i));
+  }
+  printer_->Outdent();
+  printer_->Print("\n");
+}
+
+// Mutually recursive with itself, for nested types.
+void Generator::PrintSpecializedCodecsForMessage(
+    const Descriptor& descriptor) const {
+  for (int i = 0; i < descriptor.nested_type_count(); ++i) {
+    PrintSpecializedCodecsForMessage(*descriptor.nested_type(i));
+  }
+  // MessageSets have their own wire format, and there is nothing to gain for
+  // types without fields.
+  if (descriptor.options().message_set_wire_format() ||
+      descriptor.field_count() == 0) {
+    return;
+  }
+
+  map<string, string> m;
+  m["function"] = "_Specialize" + NamePrefixedWithNestedTypes(descriptor, "_");
+  m["class"] = ModuleLevelMessageName(descriptor);
+  printer_->Print(m,
+      "\n"
+      "def $function$(cls):\n");
+  printer_->Indent();
+  printer_->Print(
+      "fields = cls.DESCRIPTOR.fields_by_name\n"
+      "decoders = cls._decoders_by_tag\n"
+      "generic_parse = cls._InternalParse\n");
+  for (int i = 0; i < descriptor.field_count(); ++i) {
+    const FieldDescriptor& field = *descriptor.field(i);
+    map<string, string> fm;
+    fm["number"] = SimpleItoa(field.number());
+    fm["name"] = field.name();
+    printer_->Print(fm, "field_$number$ = fields['$name$']\n");
+    if (field.is_repeated() ||
+        field.cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+      // Not decoded inline; see PrintSpecializedParseOfField().
+      fm["tag"] = CEscape(TagBytes(field));
+      printer_->Print(fm, "decode_$number$ = decoders['$tag$']\n");
+    }
+  }
+  PrintSpecializedParse(descriptor);
+  // With extensions, the fields must be merged with the extensions in number
+  // order, which the generic method already does.
+  if (descriptor.extension_range_count() == 0) {
+    PrintSpecializedSerialize(descriptor);
+  }
+  printer_->Outdent();
+  printer_->Print(m, "$function$($class$)\n");
+}
+
+// Prints an _InternalParse() which expects the fields in field-number order,
+// which is the order every implementation writes them in.  It tries each
+// field's tag in turn, decoding scalar fields inline and calling the field's
+// generic decoder for everything else, and hands whatever is left -- fields
+// out of order, unknown fields, extensions, the other encoding of a packable
+// field -- to the generic parse loop.
+void Generator::PrintSpecializedParse(const Descriptor& descriptor) const {
+  printer_->Print(
+      "\n"
+      "def InternalParse(self, buffer, pos, end):\n");
+  printer_->Indent();
+  printer_->Print(
+      "self._Modified()\n"
+      "field_dict = self._fields\n");
+
+  vector<const FieldDescriptor*> fields;
+  for (int i = 0; i < descriptor.field_count(); ++i) {
+    fields.push_back(descriptor.field(i));
+  }
+  sort(fields.begin(), fields.end(), FieldOrderingByNumber());
+  for (int i = 0; i < fields.size(); ++i) {
+    PrintSpecializedParseOfField(*fields[i]);
+  }
+
+  printer_->Print(
+      "if pos == end:\n"
+      "  return pos\n"
+      "return generic_parse(self, buffer, pos, end)\n");
+  printer_->Outdent();
+  printer_->Print("cls._InternalParse = InternalParse\n");
+}
+
+// Prints the part of a specialized _InternalParse() that handles one field.
+// Error handling matches the corresponding decoder in decoder.py.
+void Generator::PrintSpecializedParseOfField(
+    const FieldDescriptor& field) const {
+  string tag = TagBytes(field);
+  int tag_size = tag.size();
+
+  map<string, string> m;
+  m["number"] = SimpleItoa(field.number());
+  m["tag"] = CEscape(tag);
+  m["tag_size"] = SimpleItoa(tag_size);
+  printer_->Print(m,
+      "if (buffer[pos:pos + $tag_size$] == '$tag$' and\n"
+      "    pos + $tag_size$ <= end):\n");
+  printer_->Indent();
+
+  if (field.is_repeated() ||
+      field.cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+    printer_->Print(m,
+        "pos = decode_$number$(buffer, pos + $tag_size$, end, self, "
+        "field_dict)\n");
+  } else if (field.type() == FieldDescriptor::TYPE_STRING ||
+             field.type() == FieldDescriptor::TYPE_BYTES) {
+    m["value"] = field.type() == FieldDescriptor::TYPE_STRING ?
+        "unicode(buffer[pos:new_pos], 'utf-8')" : "buffer[pos:new_pos]";
+    printer_->Print(m,
+        "(size, pos) = _DecodeVarint(buffer, pos + $tag_size$)\n"
+        "new_pos = pos + size\n"
+        "if new_pos > end:\n"
+        "  raise _DecodeError('Truncated string.')\n"
+        "field_dict[field_$number$] = $value$\n"
+        "pos = new_pos\n");
+  } else {
+    string format;
+    int fixed_size = 0;
+    string varint_decoder;
+    m["value"] = "value";
+    switch (field.type()) {
+      case FieldDescriptor::TYPE_INT32:
+      case FieldDescriptor::TYPE_ENUM:
+        varint_decoder = "_DecodeSignedVarint32";
+        break;
+      case FieldDescriptor::TYPE_INT64:
+        varint_decoder = "_DecodeSignedVarint";
+        break;
+      case FieldDescriptor::TYPE_UINT32:
+        varint_decoder = "_DecodeVarint32";
+        break;
+      case FieldDescriptor::TYPE_UINT64:
+        varint_decoder = "_DecodeVarint";
+        break;
+      case FieldDescriptor::TYPE_SINT32:
+        varint_decoder = "_DecodeVarint32";
+        m["value"] = "_ZigZagDecode(value)";
+        break;
+      case FieldDescriptor::TYPE_SINT64:
+        varint_decoder = "_DecodeVarint";
+        m["value"] = "_ZigZagDecode(value)";
+        break;
+      case FieldDescriptor::TYPE_BOOL:
+        varint_decoder = "_DecodeVarint";
+        m["value"] = "bool(value)";
+        break;
+      case FieldDescriptor::TYPE_FIXED32:
+        format = "<I";
+        fixed_size = 4;
+        break;
+      case FieldDescriptor::TYPE_FIXED64:
+        format = "<Q";
+        fixed_size = 8;
+        break;
+      case FieldDescriptor::TYPE_SFIXED32:
+        format = "<i";
+        fixed_size = 4;
+        break;
+      case FieldDescriptor::TYPE_SFIXED64:
+        format = "<q";
+        fixed_size = 8;
+        break;
+      case FieldDescriptor::TYPE_FLOAT:
+        format = "<f";
+        fixed_size = 4;
+        break;
+      case FieldDescriptor::TYPE_DOUBLE:
+        format = "<d";
+        fixed_size = 8;
+        break;
+      default:
+        GOOGLE_LOG(FATAL) << "Unexpected field type: " << field.type();
+    }
+    if (fixed_size == 0) {
+      m["decoder"] = varint_decoder;
+      printer_->Print(m,
+          "(value, pos) = $decoder$(buffer, pos + $tag_size$)\n");
+    } else {
+      m["format"] = format;
+      m["fixed_size"] = SimpleItoa(fixed_size);
+      m["advance"] = SimpleItoa(tag_size + fixed_size);
+      printer_->Print(m,
+          "pos += $advance$\n"
+          "value = _Unpack('$format$', buffer[pos - $fixed_size$:pos])[0]\n");
+    }
+    printer_->Print(m,
+        "if pos > end:\n"
+        "  raise _DecodeError('Truncated message.')\n"
+        "field_dict[field_$number$] = $value$\n");
+  }
+
+  printer_->Print(
+      "if pos == end:\n"
+      "  return pos\n");
+  printer_->Outdent();
+}
+
+// Prints an _InternalSerialize() that visits the fields in number order
+// directly instead of collecting and sorting them with ListFields().  That
+// costs a lookup per declared field, so messages with only a few of their
+// fields set still go through the generic method.
+void Generator::PrintSpecializedSerialize(const Descriptor& descriptor) const {
+  printer_->Print(
+      "generic_serialize = cls._InternalSerialize\n");
+  for (int i = 0; i < descriptor.field_count(); ++i) {
+    const FieldDescriptor& field = *descriptor.field(i);
+    printer_->Print("encode_$number$ = field_$number$._encoder\n",
+                    "number", SimpleItoa(field.number()));
+  }
+  printer_->Print(
+      "\n"
+      "def InternalSerialize(self, write_bytes):\n");
+  printer_->Indent();
+  printer_->Print("field_dict = self._fields\n");
+  // Roughly where the two approaches break even.
+  int sparse_limit = descriptor.field_count() / 8;
+  if (sparse_limit > 0) {
+    printer_->Print(
+        "if len(field_dict) < $limit$:\n"
+        "  return generic_serialize(self, write_bytes)\n",
+        "limit", SimpleItoa(sparse_limit));
+  }
+
+  vector<const FieldDescriptor*> fields;
+  for (int i = 0; i < descriptor.field_count(); ++i) {
+    fields.push_back(descriptor.field(i));
+  }
+  sort(fields.begin(), fields.end(), FieldOrderingByNumber());
+  for (int i = 0; i < fields.size(); ++i) {
+    const FieldDescriptor& field = *fields[i];
+    map<string, string> m;
+    m["number"] = SimpleItoa(field.number());
+    // Same notion of presence as ListFields().
+    if (field.is_repeated()) {
+      m["present"] = "value";
+    } else if (field.cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+      m["present"] = "value is not None and value._is_present_in_parent";
+    } else {
+      m["present"] = "value is not None";
+    }
+    printer_->Print(m,
+        "value = field_dict.get(field_$number$)\n"
+        "if $present$:\n"
+        "  encode_$number$(write_bytes, value)\n");
+  }
+
+  printer_->Outdent();
+  printer_->Print("cls._InternalSerialize = InternalSerialize\n");
+}
+
 // Returns a Python expression that instantiates a Python EnumValueDescriptor
 // object for the given C++ descriptor.
 void Generator::PrintEnumValueDescriptor(
@@ -117,6 +117,12 @@ class LIBPROTOC_EXPORT Generator : public CodeGenerator {
       const FieldDescriptor& extension_field) const;
   void FixForeignFieldsInNestedExtensions(const Descriptor& descriptor) const;
 
+  void PrintSpecializedCodecs() const;
+  void PrintSpecializedCodecsForMessage(const Descriptor& descriptor) const;
+  void PrintSpecializedParse(const Descriptor& descriptor) const;
+  void PrintSpecializedParseOfField(const FieldDescriptor& field) const;
+  void PrintSpecializedSerialize(const Descriptor& descriptor) const;
+
   void PrintServices() const;
   void PrintServiceDescriptor(const ServiceDescriptor& descriptor) const;
   void PrintServiceClass(const ServiceDescriptor& descriptor) const;
@@ -143,6 +149,8 @@ class LIBPROTOC_EXPORT Generator : public CodeGenerator {
   mutable const FileDescriptor* file_;  // Set in Generate().  Under mutex_.
   mutable string file_descriptor_serialized_;
   mutable io::Printer* printer_;  // Set in Generate().  Under mutex_.
+  // The "specialized_codecs" option.  Set in Generate().  Under mutex_.
+  mutable bool specialized_codecs_;
 
   GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Generator);
 };
@@ -109,6 +109,54 @@ TEST(PythonPluginTest, PluginTest) {
   EXPECT_EQ(0, cli.Run(5, argv));
 }
 
+// Like the above, this only checks that the code is emitted; the Python tests
+// run it on specialized_codecs.proto, which setup.py generates with the option.
+TEST(PythonPluginTest, SpecializedCodecs) {
+  File::WriteStringToFileOrDie(
+      "syntax = \"proto2\";\n"
+      "package foo;\n"
+      "message Bar {\n"
+      "  optional int32 a = 1;\n"
+      "  repeated string b = 2;\n"
+      "  message Baz {}\n"
+      "}\n",
+      TestTempDir() + "/test.proto");
+
+  google::protobuf::compiler::CommandLineInterface cli;
+  cli.SetInputsAreProtoPathRelative(true);
+
+  python::Generator python_generator;
+  cli.RegisterGenerator("--python_out", &python_generator, "");
+
+  string proto_path = "-I" + TestTempDir();
+  string python_out = "--python_out=specialized_codecs:" + TestTempDir();
+
+  const char* argv[] = {
+    "protoc",
+    proto_path.c_str(),
+    python_out.c_str(),
+    "test.proto"
+  };
+
+  EXPECT_EQ(0, cli.Run(4, argv));
+
+  string output;
+  File::ReadFileToStringOrDie(TestTempDir() + "/test_pb2.py", &output);
+  EXPECT_NE(string::npos, output.find("def _SpecializeBar(cls):"));
+  EXPECT_NE(string::npos, output.find("_SpecializeBar(Bar)"));
+  // Bar.Baz has no fields, so nothing is generated for it.
+  EXPECT_EQ(string::npos, output.find("_SpecializeBar_Baz"));
+
+  // Unknown options are ignored, and without the option the generic parser
+  // and serializer are used.
+  string other_out = "--python_out=no_such_option:" + TestTempDir();
+  argv[2] = other_out.c_str();
+  EXPECT_EQ(0, cli.Run(4, argv));
+  output.clear();
+  File::ReadFileToStringOrDie(TestTempDir() + "/test_pb2.py", &output);
+  EXPECT_EQ(string::npos, output.find("_SpecializeBar"));
+}
+
 }  // namespace
 }  // namespace python
 }  // namespace compiler
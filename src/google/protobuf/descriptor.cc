@@ -219,12 +219,14 @@ struct PointerStringPairHash {
 
 struct Symbol {
   enum Type {
-    NULL_SYMBOL, MESSAGE, FIELD, ENUM, ENUM_VALUE, SERVICE, METHOD, PACKAGE
+    NULL_SYMBOL, MESSAGE, FIELD, ONEOF, ENUM, ENUM_VALUE, SERVICE, METHOD,
+    PACKAGE
   };
   Type type;
   union {
     const Descriptor* descriptor;
     const FieldDescriptor* field_descriptor;
+    const OneofDescriptor* oneof_descriptor;
     const EnumDescriptor* enum_descriptor;
     const EnumValueDescriptor* enum_value_descriptor;
     const ServiceDescriptor* service_descriptor;
@@ -250,6 +252,7 @@ struct Symbol {
 
   CONSTRUCTOR(Descriptor         , MESSAGE   , descriptor             )
   CONSTRUCTOR(FieldDescriptor    , FIELD     , field_descriptor       )
+  CONSTRUCTOR(OneofDescriptor    , ONEOF     , oneof_descriptor       )
   CONSTRUCTOR(EnumDescriptor     , ENUM      , enum_descriptor        )
   CONSTRUCTOR(EnumValueDescriptor, ENUM_VALUE, enum_value_descriptor  )
   CONSTRUCTOR(ServiceDescriptor  , SERVICE   , service_descriptor     )
@@ -262,6 +265,7 @@ struct Symbol {
       case NULL_SYMBOL: return NULL;
       case MESSAGE    : return descriptor           ->file();
       case FIELD      : return field_descriptor     ->file();
+      case ONEOF      : return oneof_descriptor     ->containing_type()->file();
       case ENUM       : return enum_descriptor      ->file();
       case ENUM_VALUE : return enum_value_descriptor->type()->file();
       case SERVICE    : return service_descriptor   ->file();
@@ -927,6 +931,12 @@ const FieldDescriptor* DescriptorPool::FindExtensionByName(
   }
 }
 
+const OneofDescriptor* DescriptorPool::FindOneofByName(
+    const string& name) const {
+  Symbol result = tables_->FindByNameHelper(this, name);
+  return (result.type == Symbol::ONEOF) ? result.oneof_descriptor : NULL;
+}
+
 const EnumDescriptor* DescriptorPool::FindEnumTypeByName(
     const string& name) const {
   Symbol result = tables_->FindByNameHelper(this, name);
@@ -1046,6 +1056,17 @@ Descriptor::FindFieldByName(const string& key) const {
   }
 }
 
+const OneofDescriptor*
+Descriptor::FindOneofByName(const string& key) const {
+  Symbol result =
+    file()->tables_->FindNestedSymbolOfType(this, key, Symbol::ONEOF);
+  if (!result.IsNull()) {
+    return result.oneof_descriptor;
+  } else {
+    return NULL;
+  }
+}
+
 const FieldDescriptor*
 Descriptor::FindExtensionByName(const string& key) const {
   Symbol result =
@@ -1367,6 +1388,9 @@ void Descriptor::CopyTo(DescriptorProto* proto) const {
   for (int i = 0; i < field_count(); i++) {
     field(i)->CopyTo(proto->add_field());
   }
+  for (int i = 0; i < oneof_decl_count(); i++) {
+    oneof_decl(i)->CopyTo(proto->add_oneof_decl());
+  }
   for (int i = 0; i < nested_type_count(); i++) {
     nested_type(i)->CopyTo(proto->add_nested_type());
   }
@@ -1427,11 +1451,19 @@ void FieldDescriptor::CopyTo(FieldDescriptorProto* proto) const {
     proto->set_default_value(DefaultValueAsString(false));
   }
 
+  if (containing_oneof() != NULL && !is_extension()) {
+    proto->set_oneof_index(containing_oneof()->index());
+  }
+
   if (&options() != &FieldOptions::default_instance()) {
     proto->mutable_options()->CopyFrom(options());
   }
 }
 
+void OneofDescriptor::CopyTo(OneofDescriptorProto* proto) const {
+  proto->set_name(name());
+}
+
 void EnumDescriptor::CopyTo(EnumDescriptorProto* proto) const {
   proto->set_name(name());
 
@@ -1638,7 +1670,12 @@ void Descriptor::DebugString(int depth, string *contents) const {
     enum_type(i)->DebugString(depth, contents);
   }
   for (int i = 0; i < field_count(); i++) {
-    field(i)->DebugString(depth, contents);
+    if (field(i)->containing_oneof() == NULL) {
+      field(i)->DebugString(depth, contents);
+    } else if (field(i)->containing_oneof()->field(0) == field(i)) {
+      // This is the first field in this oneof, so print the whole oneof.
+      field(i)->containing_oneof()->DebugString(depth, contents);
+    }
   }
 
   for (int i = 0; i < extension_range_count(); i++) {
@@ -1694,9 +1731,17 @@ void FieldDescriptor::DebugString(int depth, string *contents) const {
       field_type = kTypeToName[type()];
   }
 
-  strings::SubstituteAndAppend(contents, "$0$1 $2 $3 = $4",
+  // Members of a oneof are always optional, and the label is not allowed in
+  // the .proto syntax.
+  string label_name;
+  if (containing_oneof() == NULL) {
+    label_name = kLabelToName[label()];
+    label_name.append(" ");
+  }
+
+  strings::SubstituteAndAppend(contents, "$0$1$2 $3 = $4",
                                prefix,
-                               kLabelToName[label()],
+                               label_name,
                                field_type,
                                type() == TYPE_GROUP ? message_type()->name() :
                                                       name(),
@@ -1727,6 +1772,22 @@ void FieldDescriptor::DebugString(int depth, string *contents) const {
   }
 }
 
+string OneofDescriptor::DebugString() const {
+  string contents;
+  DebugString(0, &contents);
+  return contents;
+}
+
+void OneofDescriptor::DebugString(int depth, string* contents) const {
+  string prefix(depth * 2, ' ');
+  ++depth;
+  strings::SubstituteAndAppend(contents, "$0oneof $1 {\n", prefix, name());
+  for (int i = 0; i < field_count(); i++) {
+    field(i)->DebugString(depth, contents);
+  }
+  strings::SubstituteAndAppend(contents, "$0}\n", prefix);
+}
+
 string EnumDescriptor::DebugString() const {
   string contents;
   DebugString(0, &contents);
@@ -2004,6 +2065,9 @@ class DescriptorBuilder {
                       FieldDescriptor* result) {
     BuildFieldOrExtension(proto, parent, result, true);
   }
+  void BuildOneof(const OneofDescriptorProto& proto,
+                  Descriptor* parent,
+                  OneofDescriptor* result);
   void BuildExtensionRange(const DescriptorProto::ExtensionRange& proto,
                            const Descriptor* parent,
                            Descriptor::ExtensionRange* result);
@@ -2169,6 +2233,13 @@ class DescriptorBuilder {
 
   void ValidateMapKey(FieldDescriptor* field,
                       const FieldDescriptorProto& proto);
+
+  // A map entry type synthesized by the parser for a "map<K, V> foo" field
+  // collides with anything else named "FooEntry" in the same scope.  AddSymbol
+  // reports that as an ordinary redefinition, which does not mention the map
+  // field; this adds an error naming the entry type.
+  void DetectMapConflicts(const Descriptor* message,
+                          const DescriptorProto& proto);
 };
 
 const FileDescriptor* DescriptorPool::BuildFile(
@@ -2849,6 +2920,13 @@ const FileDescriptor* DescriptorBuilder::BuildFile(
     ValidateFileOptions(result, proto);
   }
 
+  // A map entry type can only conflict if AddSymbol() has already failed.
+  if (had_errors_) {
+    for (int i = 0; i < result->message_type_count(); i++) {
+      DetectMapConflicts(result->message_type(i), proto.message_type(i));
+    }
+  }
+
   if (had_errors_) {
     tables_->Rollback();
     return NULL;
@@ -2876,6 +2954,8 @@ void DescriptorBuilder::BuildMessage(const DescriptorProto& proto,
   result->is_placeholder_  = false;
   result->is_unqualified_placeholder_ = false;
 
+  // Oneofs must be built before fields, which refer to them.
+  BUILD_ARRAY(proto, result, oneof_decl     , BuildOneof         , result);
   BUILD_ARRAY(proto, result, field          , BuildField         , result);
   BUILD_ARRAY(proto, result, nested_type    , BuildMessage       , result);
   BUILD_ARRAY(proto, result, enum_type      , BuildEnum          , result);
@@ -2892,6 +2972,33 @@ void DescriptorBuilder::BuildMessage(const DescriptorProto& proto,
   AddSymbol(result->full_name(), parent, result->name(),
             proto, Symbol(result));
 
+  // Point each oneof at its members, which must be declared consecutively.
+  for (int i = 0; i < result->field_count(); i++) {
+    const FieldDescriptor* field = result->field(i);
+    if (field->containing_oneof() == NULL) continue;
+    OneofDescriptor* oneof =
+      result->oneof_decls_ + field->containing_oneof()->index();
+    if (oneof->field_count_ == 0) {
+      oneof->fields_ = field;
+    } else if (result->field(i - 1)->containing_oneof() != oneof) {
+      AddError(field->full_name(), proto.field(i),
+               DescriptorPool::ErrorCollector::OTHER,
+               strings::Substitute(
+                 "Fields in the same oneof must be defined consecutively. "
+                 "\"$0\" cannot be defined before the completion of the "
+                 "\"$1\" oneof definition.",
+                 result->field(i - 1)->name(), oneof->name()));
+    }
+    ++oneof->field_count_;
+  }
+  for (int i = 0; i < result->oneof_decl_count(); i++) {
+    if (result->oneof_decl(i)->field_count() == 0) {
+      AddError(result->oneof_decl(i)->full_name(), proto.oneof_decl(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Oneof must have at least one field.");
+    }
+  }
+
   // Check that no fields have numbers in extension ranges.
   for (int i = 0; i < result->field_count(); i++) {
     const FieldDescriptor* field = result->field(i);
@@ -2968,6 +3075,7 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
 
   // Some of these may be filled in when cross-linking.
   result->containing_type_ = NULL;
+  result->containing_oneof_ = NULL;
   result->extension_scope_ = NULL;
   result->experimental_map_key_ = NULL;
   result->message_type_ = NULL;
@@ -3128,6 +3236,13 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
     }
 
     result->extension_scope_ = parent;
+
+    if (proto.has_oneof_index()) {
+      AddError(result->full_name(), proto,
+               DescriptorPool::ErrorCollector::OTHER,
+               "FieldDescriptorProto.oneof_index should not be set for "
+               "extensions.");
+    }
   } else {
     if (proto.has_extendee()) {
       AddError(result->full_name(), proto,
@@ -3136,6 +3251,24 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
     }
 
     result->containing_type_ = parent;
+
+    if (proto.has_oneof_index()) {
+      if (proto.oneof_index() < 0 ||
+          proto.oneof_index() >= parent->oneof_decl_count()) {
+        AddError(result->full_name(), proto,
+                 DescriptorPool::ErrorCollector::OTHER,
+                 strings::Substitute("FieldDescriptorProto.oneof_index $0 is "
+                                     "out of range for type \"$1\".",
+                                     proto.oneof_index(),
+                                     parent->name()));
+      } else if (!result->is_optional()) {
+        AddError(result->full_name(), proto,
+                 DescriptorPool::ErrorCollector::OTHER,
+                 "Fields of oneofs must be optional.");
+      } else {
+        result->containing_oneof_ = parent->oneof_decl(proto.oneof_index());
+      }
+    }
   }
 
   // Copy options.
@@ -3149,6 +3282,27 @@ void DescriptorBuilder::BuildFieldOrExtension(const FieldDescriptorProto& proto,
             proto, Symbol(result));
 }
 
+void DescriptorBuilder::BuildOneof(const OneofDescriptorProto& proto,
+                                   Descriptor* parent,
+                                   OneofDescriptor* result) {
+  string* full_name = tables_->AllocateString(parent->full_name());
+  full_name->append(1, '.');
+  full_name->append(proto.name());
+
+  ValidateSymbolName(proto.name(), *full_name, proto);
+
+  result->name_            = tables_->AllocateString(proto.name());
+  result->full_name_       = full_name;
+  result->containing_type_ = parent;
+
+  // Filled in when the containing message's fields are built.
+  result->field_count_ = 0;
+  result->fields_ = NULL;
+
+  AddSymbol(result->full_name(), parent, result->name(),
+            proto, Symbol(result));
+}
+
 void DescriptorBuilder::BuildExtensionRange(
     const DescriptorProto::ExtensionRange& proto,
     const Descriptor* parent,
@@ -3677,6 +3831,17 @@ void DescriptorBuilder::ValidateFieldOptions(FieldDescriptor* field,
       "[packed = true] can only be specified for repeated primitive fields.");
   }
 
+  // Only fields stored in a RepeatedPtrField may be contiguous.
+  if (field->options().contiguous() &&
+      (!field->is_repeated() || field->is_extension() ||
+       field->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE)) {
+    AddError(
+      field->full_name(), proto,
+      DescriptorPool::ErrorCollector::TYPE,
+      "[contiguous = true] can only be specified for repeated message fields "
+      "which are not extensions.");
+  }
+
   // Note:  Default instance may not yet be initialized here, so we have to
   //   avoid reading from it.
   if (field->containing_type_ != NULL &&
@@ -3778,6 +3943,17 @@ void DescriptorBuilder::ValidateMapKey(FieldDescriptor* field,
     return;
   }
 
+  // The parser cannot tell a message key from an enum key, so map<K, V>
+  // fields are checked here.
+  if (item_type->options().map_entry() &&
+      (key_field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE ||
+       key_field->cpp_type() == FieldDescriptor::CPPTYPE_FLOAT ||
+       key_field->cpp_type() == FieldDescriptor::CPPTYPE_DOUBLE)) {
+    AddError(field->full_name(), proto, DescriptorPool::ErrorCollector::TYPE,
+             "Map keys must be integers, bools, strings or enums.");
+    return;
+  }
+
   if (key_field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
     AddError(field->full_name(), proto, DescriptorPool::ErrorCollector::TYPE,
              "map key must name a scalar or string field.");
@@ -3787,6 +3963,66 @@ void DescriptorBuilder::ValidateMapKey(FieldDescriptor* field,
   field->experimental_map_key_ = key_field;
 }
 
+void DescriptorBuilder::DetectMapConflicts(const Descriptor* message,
+                                           const DescriptorProto& proto) {
+  map<string, const Descriptor*> entry_types;
+  for (int i = 0; i < message->nested_type_count(); i++) {
+    const Descriptor* nested = message->nested_type(i);
+    if (nested->options().map_entry()) {
+      entry_types[nested->name()] = nested;
+    }
+    DetectMapConflicts(nested, proto.nested_type(i));
+  }
+  if (entry_types.empty()) return;
+
+  for (int i = 0; i < message->nested_type_count(); i++) {
+    const Descriptor* nested = message->nested_type(i);
+    const Descriptor* entry = FindPtrOrNull(entry_types, nested->name());
+    if (entry != NULL && entry != nested) {
+      AddError(nested->full_name(), proto.nested_type(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Map entry type \"" + entry->name() + "\" conflicts with an "
+               "existing nested message type.");
+    }
+  }
+  for (int i = 0; i < message->enum_type_count(); i++) {
+    const EnumDescriptor* nested = message->enum_type(i);
+    if (entry_types.count(nested->name()) > 0) {
+      AddError(nested->full_name(), proto.enum_type(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Map entry type \"" + nested->name() + "\" conflicts with an "
+               "existing enum type.");
+    }
+  }
+  for (int i = 0; i < message->field_count(); i++) {
+    const FieldDescriptor* field = message->field(i);
+    if (entry_types.count(field->name()) > 0) {
+      AddError(field->full_name(), proto.field(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Map entry type \"" + field->name() + "\" conflicts with an "
+               "existing field.");
+    }
+  }
+  for (int i = 0; i < message->extension_count(); i++) {
+    const FieldDescriptor* field = message->extension(i);
+    if (entry_types.count(field->name()) > 0) {
+      AddError(field->full_name(), proto.extension(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Map entry type \"" + field->name() + "\" conflicts with an "
+               "existing extension.");
+    }
+  }
+  for (int i = 0; i < message->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = message->oneof_decl(i);
+    if (entry_types.count(oneof->name()) > 0) {
+      AddError(oneof->full_name(), proto.oneof_decl(i),
+               DescriptorPool::ErrorCollector::NAME,
+               "Map entry type \"" + oneof->name() + "\" conflicts with an "
+               "existing oneof.");
+    }
+  }
+}
+
 #undef VALIDATE_OPTIONS_FROM_ARRAY
 
 // -------------------------------------------------------------------
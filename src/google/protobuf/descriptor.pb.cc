@@ -32,6 +32,9 @@ const ::google::protobuf::internal::GeneratedMessageReflection*
   FieldDescriptorProto_reflection_ = NULL;
 const ::google::protobuf::EnumDescriptor* FieldDescriptorProto_Type_descriptor_ = NULL;
 const ::google::protobuf::EnumDescriptor* FieldDescriptorProto_Label_descriptor_ = NULL;
+const ::google::protobuf::Descriptor* OneofDescriptorProto_descriptor_ = NULL;
+const ::google::protobuf::internal::GeneratedMessageReflection*
+  OneofDescriptorProto_reflection_ = NULL;
 const ::google::protobuf::Descriptor* EnumDescriptorProto_descriptor_ = NULL;
 const ::google::protobuf::internal::GeneratedMessageReflection*
   EnumDescriptorProto_reflection_ = NULL;
@@ -121,13 +124,14 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(FileDescriptorProto));
   DescriptorProto_descriptor_ = file->message_type(2);
-  static const int DescriptorProto_offsets_[7] = {
+  static const int DescriptorProto_offsets_[8] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, field_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, extension_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, nested_type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, enum_type_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, extension_range_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, oneof_decl_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(DescriptorProto, options_),
   };
   DescriptorProto_reflection_ =
@@ -158,7 +162,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(DescriptorProto_ExtensionRange));
   FieldDescriptorProto_descriptor_ = file->message_type(3);
-  static const int FieldDescriptorProto_offsets_[8] = {
+  static const int FieldDescriptorProto_offsets_[9] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, number_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, label_),
@@ -166,6 +170,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, type_name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, extendee_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, default_value_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, oneof_index_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldDescriptorProto, options_),
   };
   FieldDescriptorProto_reflection_ =
@@ -181,7 +186,22 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       sizeof(FieldDescriptorProto));
   FieldDescriptorProto_Type_descriptor_ = FieldDescriptorProto_descriptor_->enum_type(0);
   FieldDescriptorProto_Label_descriptor_ = FieldDescriptorProto_descriptor_->enum_type(1);
-  EnumDescriptorProto_descriptor_ = file->message_type(4);
+  OneofDescriptorProto_descriptor_ = file->message_type(4);
+  static const int OneofDescriptorProto_offsets_[1] = {
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(OneofDescriptorProto, name_),
+  };
+  OneofDescriptorProto_reflection_ =
+    new ::google::protobuf::internal::GeneratedMessageReflection(
+      OneofDescriptorProto_descriptor_,
+      OneofDescriptorProto::default_instance_,
+      OneofDescriptorProto_offsets_,
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(OneofDescriptorProto, _has_bits_[0]),
+      GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(OneofDescriptorProto, _unknown_fields_),
+      -1,
+      ::google::protobuf::DescriptorPool::generated_pool(),
+      ::google::protobuf::MessageFactory::generated_factory(),
+      sizeof(OneofDescriptorProto));
+  EnumDescriptorProto_descriptor_ = file->message_type(5);
   static const int EnumDescriptorProto_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumDescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumDescriptorProto, value_),
@@ -198,7 +218,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(EnumDescriptorProto));
-  EnumValueDescriptorProto_descriptor_ = file->message_type(5);
+  EnumValueDescriptorProto_descriptor_ = file->message_type(6);
   static const int EnumValueDescriptorProto_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumValueDescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumValueDescriptorProto, number_),
@@ -215,7 +235,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(EnumValueDescriptorProto));
-  ServiceDescriptorProto_descriptor_ = file->message_type(6);
+  ServiceDescriptorProto_descriptor_ = file->message_type(7);
   static const int ServiceDescriptorProto_offsets_[3] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ServiceDescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ServiceDescriptorProto, method_),
@@ -232,7 +252,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ServiceDescriptorProto));
-  MethodDescriptorProto_descriptor_ = file->message_type(7);
+  MethodDescriptorProto_descriptor_ = file->message_type(8);
   static const int MethodDescriptorProto_offsets_[4] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MethodDescriptorProto, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MethodDescriptorProto, input_type_),
@@ -250,7 +270,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(MethodDescriptorProto));
-  FileOptions_descriptor_ = file->message_type(8);
+  FileOptions_descriptor_ = file->message_type(9);
   static const int FileOptions_offsets_[8] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FileOptions, java_package_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FileOptions, java_outer_classname_),
@@ -273,10 +293,11 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(FileOptions));
   FileOptions_OptimizeMode_descriptor_ = FileOptions_descriptor_->enum_type(0);
-  MessageOptions_descriptor_ = file->message_type(9);
-  static const int MessageOptions_offsets_[3] = {
+  MessageOptions_descriptor_ = file->message_type(10);
+  static const int MessageOptions_offsets_[4] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MessageOptions, message_set_wire_format_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MessageOptions, no_standard_descriptor_accessor_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MessageOptions, map_entry_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MessageOptions, uninterpreted_option_),
   };
   MessageOptions_reflection_ =
@@ -290,10 +311,11 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(MessageOptions));
-  FieldOptions_descriptor_ = file->message_type(10);
-  static const int FieldOptions_offsets_[5] = {
+  FieldOptions_descriptor_ = file->message_type(11);
+  static const int FieldOptions_offsets_[6] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, ctype_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, packed_),
+    GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, contiguous_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, deprecated_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, experimental_map_key_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(FieldOptions, uninterpreted_option_),
@@ -310,7 +332,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(FieldOptions));
   FieldOptions_CType_descriptor_ = FieldOptions_descriptor_->enum_type(0);
-  EnumOptions_descriptor_ = file->message_type(11);
+  EnumOptions_descriptor_ = file->message_type(12);
   static const int EnumOptions_offsets_[1] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumOptions, uninterpreted_option_),
   };
@@ -325,7 +347,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(EnumOptions));
-  EnumValueOptions_descriptor_ = file->message_type(12);
+  EnumValueOptions_descriptor_ = file->message_type(13);
   static const int EnumValueOptions_offsets_[1] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(EnumValueOptions, uninterpreted_option_),
   };
@@ -340,7 +362,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(EnumValueOptions));
-  ServiceOptions_descriptor_ = file->message_type(13);
+  ServiceOptions_descriptor_ = file->message_type(14);
   static const int ServiceOptions_offsets_[1] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(ServiceOptions, uninterpreted_option_),
   };
@@ -355,7 +377,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(ServiceOptions));
-  MethodOptions_descriptor_ = file->message_type(14);
+  MethodOptions_descriptor_ = file->message_type(15);
   static const int MethodOptions_offsets_[1] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(MethodOptions, uninterpreted_option_),
   };
@@ -370,7 +392,7 @@ void protobuf_AssignDesc_google_2fprotobuf_2fdescriptor_2eproto() {
       ::google::protobuf::DescriptorPool::generated_pool(),
       ::google::protobuf::MessageFactory::generated_factory(),
       sizeof(MethodOptions));
-  UninterpretedOption_descriptor_ = file->message_type(15);
+  UninterpretedOption_descriptor_ = file->message_type(16);
   static const int UninterpretedOption_offsets_[6] = {
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(UninterpretedOption, name_),
     GOOGLE_PROTOBUF_GENERATED_MESSAGE_FIELD_OFFSET(UninterpretedOption, identifier_value_),
@@ -428,6 +450,8 @@ void protobuf_RegisterTypes(const ::std::string&) {
     DescriptorProto_ExtensionRange_descriptor_, &DescriptorProto_ExtensionRange::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     FieldDescriptorProto_descriptor_, &FieldDescriptorProto::default_instance());
+  ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
+    OneofDescriptorProto_descriptor_, &OneofDescriptorProto::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
     EnumDescriptorProto_descriptor_, &EnumDescriptorProto::default_instance());
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedMessage(
@@ -469,6 +493,8 @@ void protobuf_ShutdownFile_google_2fprotobuf_2fdescriptor_2eproto() {
   delete DescriptorProto_ExtensionRange_reflection_;
   delete FieldDescriptorProto::default_instance_;
   delete FieldDescriptorProto_reflection_;
+  delete OneofDescriptorProto::default_instance_;
+  delete OneofDescriptorProto_reflection_;
   delete EnumDescriptorProto::default_instance_;
   delete EnumDescriptorProto_reflection_;
   delete EnumValueDescriptorProto::default_instance_;
@@ -515,7 +541,7 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
     "ice\030\006 \003(\0132\'.google.protobuf.ServiceDescr"
     "iptorProto\0228\n\textension\030\007 \003(\0132%.google.p"
     "rotobuf.FieldDescriptorProto\022-\n\007options\030"
-    "\010 \001(\0132\034.google.protobuf.FileOptions\"\251\003\n\017"
+    "\010 \001(\0132\034.google.protobuf.FileOptions\"\344\003\n\017"
     "DescriptorProto\022\014\n\004name\030\001 \001(\t\0224\n\005field\030\002"
     " \003(\0132%.google.protobuf.FieldDescriptorPr"
     "oto\0228\n\textension\030\006 \003(\0132%.google.protobuf"
@@ -524,15 +550,17 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
     "enum_type\030\004 \003(\0132$.google.protobuf.EnumDe"
     "scriptorProto\022H\n\017extension_range\030\005 \003(\0132/"
     ".google.protobuf.DescriptorProto.Extensi"
-    "onRange\0220\n\007options\030\007 \001(\0132\037.google.protob"
-    "uf.MessageOptions\032,\n\016ExtensionRange\022\r\n\005s"
-    "tart\030\001 \001(\005\022\013\n\003end\030\002 \001(\005\"\224\005\n\024FieldDescrip"
-    "torProto\022\014\n\004name\030\001 \001(\t\022\016\n\006number\030\003 \001(\005\022:"
-    "\n\005label\030\004 \001(\0162+.google.protobuf.FieldDes"
-    "criptorProto.Label\0228\n\004type\030\005 \001(\0162*.googl"
-    "e.protobuf.FieldDescriptorProto.Type\022\021\n\t"
-    "type_name\030\006 \001(\t\022\020\n\010extendee\030\002 \001(\t\022\025\n\rdef"
-    "ault_value\030\007 \001(\t\022.\n\007options\030\010 \001(\0132\035.goog"
+    "onRange\0229\n\noneof_decl\030\010 \003(\0132%.google.pro"
+    "tobuf.OneofDescriptorProto\0220\n\007options\030\007 "
+    "\001(\0132\037.google.protobuf.MessageOptions\032,\n\016"
+    "ExtensionRange\022\r\n\005start\030\001 \001(\005\022\013\n\003end\030\002 \001"
+    "(\005\"\251\005\n\024FieldDescriptorProto\022\014\n\004name\030\001 \001("
+    "\t\022\016\n\006number\030\003 \001(\005\022:\n\005label\030\004 \001(\0162+.googl"
+    "e.protobuf.FieldDescriptorProto.Label\0228\n"
+    "\004type\030\005 \001(\0162*.google.protobuf.FieldDescr"
+    "iptorProto.Type\022\021\n\ttype_name\030\006 \001(\t\022\020\n\010ex"
+    "tendee\030\002 \001(\t\022\025\n\rdefault_value\030\007 \001(\t\022\023\n\013o"
+    "neof_index\030\t \001(\005\022.\n\007options\030\010 \001(\0132\035.goog"
     "le.protobuf.FieldOptions\"\266\002\n\004Type\022\017\n\013TYP"
     "E_DOUBLE\020\001\022\016\n\nTYPE_FLOAT\020\002\022\016\n\nTYPE_INT64"
     "\020\003\022\017\n\013TYPE_UINT64\020\004\022\016\n\nTYPE_INT32\020\005\022\020\n\014T"
@@ -543,60 +571,62 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
     "32\020\017\022\021\n\rTYPE_SFIXED64\020\020\022\017\n\013TYPE_SINT32\020\021"
     "\022\017\n\013TYPE_SINT64\020\022\"C\n\005Label\022\022\n\016LABEL_OPTI"
     "ONAL\020\001\022\022\n\016LABEL_REQUIRED\020\002\022\022\n\016LABEL_REPE"
-    "ATED\020\003\"\214\001\n\023EnumDescriptorProto\022\014\n\004name\030\001"
-    " \001(\t\0228\n\005value\030\002 \003(\0132).google.protobuf.En"
-    "umValueDescriptorProto\022-\n\007options\030\003 \001(\0132"
-    "\034.google.protobuf.EnumOptions\"l\n\030EnumVal"
-    "ueDescriptorProto\022\014\n\004name\030\001 \001(\t\022\016\n\006numbe"
-    "r\030\002 \001(\005\0222\n\007options\030\003 \001(\0132!.google.protob"
-    "uf.EnumValueOptions\"\220\001\n\026ServiceDescripto"
-    "rProto\022\014\n\004name\030\001 \001(\t\0226\n\006method\030\002 \003(\0132&.g"
-    "oogle.protobuf.MethodDescriptorProto\0220\n\007"
-    "options\030\003 \001(\0132\037.google.protobuf.ServiceO"
-    "ptions\"\177\n\025MethodDescriptorProto\022\014\n\004name\030"
-    "\001 \001(\t\022\022\n\ninput_type\030\002 \001(\t\022\023\n\013output_type"
-    "\030\003 \001(\t\022/\n\007options\030\004 \001(\0132\036.google.protobu"
-    "f.MethodOptions\"\244\003\n\013FileOptions\022\024\n\014java_"
-    "package\030\001 \001(\t\022\034\n\024java_outer_classname\030\010 "
-    "\001(\t\022\"\n\023java_multiple_files\030\n \001(\010:\005false\022"
-    "F\n\014optimize_for\030\t \001(\0162).google.protobuf."
-    "FileOptions.OptimizeMode:\005SPEED\022!\n\023cc_ge"
-    "neric_services\030\020 \001(\010:\004true\022#\n\025java_gener"
-    "ic_services\030\021 \001(\010:\004true\022!\n\023py_generic_se"
-    "rvices\030\022 \001(\010:\004true\022C\n\024uninterpreted_opti"
-    "on\030\347\007 \003(\0132$.google.protobuf.Uninterprete"
-    "dOption\":\n\014OptimizeMode\022\t\n\005SPEED\020\001\022\r\n\tCO"
-    "DE_SIZE\020\002\022\020\n\014LITE_RUNTIME\020\003*\t\010\350\007\020\200\200\200\200\002\"\270"
-    "\001\n\016MessageOptions\022&\n\027message_set_wire_fo"
-    "rmat\030\001 \001(\010:\005false\022.\n\037no_standard_descrip"
-    "tor_accessor\030\002 \001(\010:\005false\022C\n\024uninterpret"
+    "ATED\020\003\"$\n\024OneofDescriptorProto\022\014\n\004name\030\001"
+    " \001(\t\"\214\001\n\023EnumDescriptorProto\022\014\n\004name\030\001 \001"
+    "(\t\0228\n\005value\030\002 \003(\0132).google.protobuf.Enum"
+    "ValueDescriptorProto\022-\n\007options\030\003 \001(\0132\034."
+    "google.protobuf.EnumOptions\"l\n\030EnumValue"
+    "DescriptorProto\022\014\n\004name\030\001 \001(\t\022\016\n\006number\030"
+    "\002 \001(\005\0222\n\007options\030\003 \001(\0132!.google.protobuf"
+    ".EnumValueOptions\"\220\001\n\026ServiceDescriptorP"
+    "roto\022\014\n\004name\030\001 \001(\t\0226\n\006method\030\002 \003(\0132&.goo"
+    "gle.protobuf.MethodDescriptorProto\0220\n\007op"
+    "tions\030\003 \001(\0132\037.google.protobuf.ServiceOpt"
+    "ions\"\177\n\025MethodDescriptorProto\022\014\n\004name\030\001 "
+    "\001(\t\022\022\n\ninput_type\030\002 \001(\t\022\023\n\013output_type\030\003"
+    " \001(\t\022/\n\007options\030\004 \001(\0132\036.google.protobuf."
+    "MethodOptions\"\244\003\n\013FileOptions\022\024\n\014java_pa"
+    "ckage\030\001 \001(\t\022\034\n\024java_outer_classname\030\010 \001("
+    "\t\022\"\n\023java_multiple_files\030\n \001(\010:\005false\022F\n"
+    "\014optimize_for\030\t \001(\0162).google.protobuf.Fi"
+    "leOptions.OptimizeMode:\005SPEED\022!\n\023cc_gene"
+    "ric_services\030\020 \001(\010:\004true\022#\n\025java_generic"
+    "_services\030\021 \001(\010:\004true\022!\n\023py_generic_serv"
+    "ices\030\022 \001(\010:\004true\022C\n\024uninterpreted_option"
+    "\030\347\007 \003(\0132$.google.protobuf.UninterpretedO"
+    "ption\":\n\014OptimizeMode\022\t\n\005SPEED\020\001\022\r\n\tCODE"
+    "_SIZE\020\002\022\020\n\014LITE_RUNTIME\020\003*\t\010\350\007\020\200\200\200\200\002\"\322\001\n"
+    "\016MessageOptions\022&\n\027message_set_wire_form"
+    "at\030\001 \001(\010:\005false\022.\n\037no_standard_descripto"
+    "r_accessor\030\002 \001(\010:\005false\022\030\n\tmap_entry\030\007 \001"
+    "(\010:\005false\022C\n\024uninterpreted_option\030\347\007 \003(\013"
+    "2$.google.protobuf.UninterpretedOption*\t"
+    "\010\350\007\020\200\200\200\200\002\"\257\002\n\014FieldOptions\022:\n\005ctype\030\001 \001("
+    "\0162#.google.protobuf.FieldOptions.CType:\006"
+    "STRING\022\016\n\006packed\030\002 \001(\010\022\031\n\ncontiguous\030\004 \001"
+    "(\010:\005false\022\031\n\ndeprecated\030\003 \001(\010:\005false\022\034\n\024"
+    "experimental_map_key\030\t \001(\t\022C\n\024uninterpre"
+    "ted_option\030\347\007 \003(\0132$.google.protobuf.Unin"
+    "terpretedOption\"/\n\005CType\022\n\n\006STRING\020\000\022\010\n\004"
+    "CORD\020\001\022\020\n\014STRING_PIECE\020\002*\t\010\350\007\020\200\200\200\200\002\"]\n\013E"
+    "numOptions\022C\n\024uninterpreted_option\030\347\007 \003("
+    "\0132$.google.protobuf.UninterpretedOption*"
+    "\t\010\350\007\020\200\200\200\200\002\"b\n\020EnumValueOptions\022C\n\024uninte"
+    "rpreted_option\030\347\007 \003(\0132$.google.protobuf."
+    "UninterpretedOption*\t\010\350\007\020\200\200\200\200\002\"`\n\016Servic"
+    "eOptions\022C\n\024uninterpreted_option\030\347\007 \003(\0132"
+    "$.google.protobuf.UninterpretedOption*\t\010"
+    "\350\007\020\200\200\200\200\002\"_\n\rMethodOptions\022C\n\024uninterpret"
     "ed_option\030\347\007 \003(\0132$.google.protobuf.Unint"
-    "erpretedOption*\t\010\350\007\020\200\200\200\200\002\"\224\002\n\014FieldOptio"
-    "ns\022:\n\005ctype\030\001 \001(\0162#.google.protobuf.Fiel"
-    "dOptions.CType:\006STRING\022\016\n\006packed\030\002 \001(\010\022\031"
-    "\n\ndeprecated\030\003 \001(\010:\005false\022\034\n\024experimenta"
-    "l_map_key\030\t \001(\t\022C\n\024uninterpreted_option\030"
-    "\347\007 \003(\0132$.google.protobuf.UninterpretedOp"
-    "tion\"/\n\005CType\022\n\n\006STRING\020\000\022\010\n\004CORD\020\001\022\020\n\014S"
-    "TRING_PIECE\020\002*\t\010\350\007\020\200\200\200\200\002\"]\n\013EnumOptions\022"
-    "C\n\024uninterpreted_option\030\347\007 \003(\0132$.google."
-    "protobuf.UninterpretedOption*\t\010\350\007\020\200\200\200\200\002\""
-    "b\n\020EnumValueOptions\022C\n\024uninterpreted_opt"
-    "ion\030\347\007 \003(\0132$.google.protobuf.Uninterpret"
-    "edOption*\t\010\350\007\020\200\200\200\200\002\"`\n\016ServiceOptions\022C\n"
-    "\024uninterpreted_option\030\347\007 \003(\0132$.google.pr"
-    "otobuf.UninterpretedOption*\t\010\350\007\020\200\200\200\200\002\"_\n"
-    "\rMethodOptions\022C\n\024uninterpreted_option\030\347"
-    "\007 \003(\0132$.google.protobuf.UninterpretedOpt"
-    "ion*\t\010\350\007\020\200\200\200\200\002\"\205\002\n\023UninterpretedOption\022;"
-    "\n\004name\030\002 \003(\0132-.google.protobuf.Uninterpr"
-    "etedOption.NamePart\022\030\n\020identifier_value\030"
-    "\003 \001(\t\022\032\n\022positive_int_value\030\004 \001(\004\022\032\n\022neg"
-    "ative_int_value\030\005 \001(\003\022\024\n\014double_value\030\006 "
-    "\001(\001\022\024\n\014string_value\030\007 \001(\014\0323\n\010NamePart\022\021\n"
-    "\tname_part\030\001 \002(\t\022\024\n\014is_extension\030\002 \002(\010B)"
-    "\n\023com.google.protobufB\020DescriptorProtosH"
-    "\001", 3681);
+    "erpretedOption*\t\010\350\007\020\200\200\200\200\002\"\205\002\n\023Uninterpre"
+    "tedOption\022;\n\004name\030\002 \003(\0132-.google.protobu"
+    "f.UninterpretedOption.NamePart\022\030\n\020identi"
+    "fier_value\030\003 \001(\t\022\032\n\022positive_int_value\030\004"
+    " \001(\004\022\032\n\022negative_int_value\030\005 \001(\003\022\024\n\014doub"
+    "le_value\030\006 \001(\001\022\024\n\014string_value\030\007 \001(\014\0323\n\010"
+    "NamePart\022\021\n\tname_part\030\001 \002(\t\022\024\n\014is_extens"
+    "ion\030\002 \002(\010B)\n\023com.google.protobufB\020Descri"
+    "ptorProtosH\001", 3852);
   ::google::protobuf::MessageFactory::InternalRegisterGeneratedFile(
     "google/protobuf/descriptor.proto", &protobuf_RegisterTypes);
   FileDescriptorSet::default_instance_ = new FileDescriptorSet();
@@ -604,6 +634,7 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
   DescriptorProto::default_instance_ = new DescriptorProto();
   DescriptorProto_ExtensionRange::default_instance_ = new DescriptorProto_ExtensionRange();
   FieldDescriptorProto::default_instance_ = new FieldDescriptorProto();
+  OneofDescriptorProto::default_instance_ = new OneofDescriptorProto();
   EnumDescriptorProto::default_instance_ = new EnumDescriptorProto();
   EnumValueDescriptorProto::default_instance_ = new EnumValueDescriptorProto();
   ServiceDescriptorProto::default_instance_ = new ServiceDescriptorProto();
@@ -622,6 +653,7 @@ void protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto() {
   DescriptorProto::default_instance_->InitAsDefaultInstance();
   DescriptorProto_ExtensionRange::default_instance_->InitAsDefaultInstance();
   FieldDescriptorProto::default_instance_->InitAsDefaultInstance();
+  OneofDescriptorProto::default_instance_->InitAsDefaultInstance();
   EnumDescriptorProto::default_instance_->InitAsDefaultInstance();
   EnumValueDescriptorProto::default_instance_->InitAsDefaultInstance();
   ServiceDescriptorProto::default_instance_->InitAsDefaultInstance();
@@ -668,6 +700,7 @@ FileDescriptorSet::FileDescriptorSet(const FileDescriptorSet& from)
 
 void FileDescriptorSet::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -703,6 +736,7 @@ FileDescriptorSet* FileDescriptorSet::New() const {
 void FileDescriptorSet::Clear() {
   file_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -719,6 +753,9 @@ bool FileDescriptorSet::MergePartialFromCodedStream(
          parse_file:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_file()));
+          if (!this->file(this->file_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -833,12 +870,18 @@ bool FileDescriptorSet::IsInitialized() const {
   return true;
 }
 
+bool FileDescriptorSet::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void FileDescriptorSet::Swap(FileDescriptorSet* other) {
   if (other != this) {
     file_.Swap(&other->file_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -883,6 +926,7 @@ FileDescriptorProto::FileDescriptorProto(const FileDescriptorProto& from)
 
 void FileDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   package_ = const_cast< ::std::string*>(&_default_package_);
   options_ = NULL;
@@ -947,6 +991,7 @@ void FileDescriptorProto::Clear() {
   service_.Clear();
   extension_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -1014,6 +1059,9 @@ bool FileDescriptorProto::MergePartialFromCodedStream(
          parse_message_type:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_message_type()));
+          if (!this->message_type(this->message_type_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1029,6 +1077,9 @@ bool FileDescriptorProto::MergePartialFromCodedStream(
          parse_enum_type:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_enum_type()));
+          if (!this->enum_type(this->enum_type_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1044,6 +1095,9 @@ bool FileDescriptorProto::MergePartialFromCodedStream(
          parse_service:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_service()));
+          if (!this->service(this->service_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1059,6 +1113,9 @@ bool FileDescriptorProto::MergePartialFromCodedStream(
          parse_extension:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_extension()));
+          if (!this->extension(this->extension_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1074,6 +1131,9 @@ bool FileDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1376,6 +1436,11 @@ bool FileDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool FileDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void FileDescriptorProto::Swap(FileDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -1389,6 +1454,7 @@ void FileDescriptorProto::Swap(FileDescriptorProto* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -1658,6 +1724,7 @@ const int DescriptorProto::kExtensionFieldNumber;
 const int DescriptorProto::kNestedTypeFieldNumber;
 const int DescriptorProto::kEnumTypeFieldNumber;
 const int DescriptorProto::kExtensionRangeFieldNumber;
+const int DescriptorProto::kOneofDeclFieldNumber;
 const int DescriptorProto::kOptionsFieldNumber;
 #endif  // !_MSC_VER
 
@@ -1678,6 +1745,7 @@ DescriptorProto::DescriptorProto(const DescriptorProto& from)
 
 void DescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   options_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -1723,7 +1791,7 @@ void DescriptorProto::Clear() {
         name_->clear();
       }
     }
-    if (_has_bit(6)) {
+    if (_has_bit(7)) {
       if (options_ != NULL) options_->::google::protobuf::MessageOptions::Clear();
     }
   }
@@ -1732,7 +1800,9 @@ void DescriptorProto::Clear() {
   nested_type_.Clear();
   enum_type_.Clear();
   extension_range_.Clear();
+  oneof_decl_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -1765,6 +1835,9 @@ bool DescriptorProto::MergePartialFromCodedStream(
          parse_field:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_field()));
+          if (!this->field(this->field_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1780,6 +1853,9 @@ bool DescriptorProto::MergePartialFromCodedStream(
          parse_nested_type:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_nested_type()));
+          if (!this->nested_type(this->nested_type_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1795,6 +1871,9 @@ bool DescriptorProto::MergePartialFromCodedStream(
          parse_enum_type:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_enum_type()));
+          if (!this->enum_type(this->enum_type_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1825,6 +1904,9 @@ bool DescriptorProto::MergePartialFromCodedStream(
          parse_extension:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_extension()));
+          if (!this->extension(this->extension_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -1840,9 +1922,27 @@ bool DescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(66)) goto parse_oneof_decl;
+        break;
+      }
+      
+      // repeated .google.protobuf.OneofDescriptorProto oneof_decl = 8;
+      case 8: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+         parse_oneof_decl:
+          DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
+                input, add_oneof_decl()));
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(66)) goto parse_oneof_decl;
         if (input->ExpectAtEnd()) return true;
         break;
       }
@@ -1905,11 +2005,17 @@ void DescriptorProto::SerializeWithCachedSizes(
   }
   
   // optional .google.protobuf.MessageOptions options = 7;
-  if (_has_bit(6)) {
+  if (_has_bit(7)) {
     ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
       7, this->options(), output);
   }
   
+  // repeated .google.protobuf.OneofDescriptorProto oneof_decl = 8;
+  for (int i = 0; i < this->oneof_decl_size(); i++) {
+    ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
+      8, this->oneof_decl(i), output);
+  }
+  
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -1964,12 +2070,19 @@ void DescriptorProto::SerializeWithCachedSizes(
   }
   
   // optional .google.protobuf.MessageOptions options = 7;
-  if (_has_bit(6)) {
+  if (_has_bit(7)) {
     target = ::google::protobuf::internal::WireFormatLite::
       WriteMessageNoVirtualToArray(
         7, this->options(), target);
   }
   
+  // repeated .google.protobuf.OneofDescriptorProto oneof_decl = 8;
+  for (int i = 0; i < this->oneof_decl_size(); i++) {
+    target = ::google::protobuf::internal::WireFormatLite::
+      WriteMessageNoVirtualToArray(
+        8, this->oneof_decl(i), target);
+  }
+  
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -2036,6 +2149,14 @@ int DescriptorProto::ByteSize() const {
         this->extension_range(i));
   }
   
+  // repeated .google.protobuf.OneofDescriptorProto oneof_decl = 8;
+  total_size += 1 * this->oneof_decl_size();
+  for (int i = 0; i < this->oneof_decl_size(); i++) {
+    total_size +=
+      ::google::protobuf::internal::WireFormatLite::MessageSizeNoVirtual(
+        this->oneof_decl(i));
+  }
+  
   if (!unknown_fields().empty()) {
     total_size +=
       ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
@@ -2066,11 +2187,12 @@ void DescriptorProto::MergeFrom(const DescriptorProto& from) {
   nested_type_.MergeFrom(from.nested_type_);
   enum_type_.MergeFrom(from.enum_type_);
   extension_range_.MergeFrom(from.extension_range_);
+  oneof_decl_.MergeFrom(from.oneof_decl_);
   if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     if (from._has_bit(0)) {
       set_name(from.name());
     }
-    if (from._has_bit(6)) {
+    if (from._has_bit(7)) {
       mutable_options()->::google::protobuf::MessageOptions::MergeFrom(from.options());
     }
   }
@@ -2109,6 +2231,11 @@ bool DescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool DescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void DescriptorProto::Swap(DescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -2117,10 +2244,12 @@ void DescriptorProto::Swap(DescriptorProto* other) {
     nested_type_.Swap(&other->nested_type_);
     enum_type_.Swap(&other->enum_type_);
     extension_range_.Swap(&other->extension_range_);
+    oneof_decl_.Swap(&other->oneof_decl_);
     std::swap(options_, other->options_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -2223,6 +2352,7 @@ const int FieldDescriptorProto::kTypeFieldNumber;
 const int FieldDescriptorProto::kTypeNameFieldNumber;
 const int FieldDescriptorProto::kExtendeeFieldNumber;
 const int FieldDescriptorProto::kDefaultValueFieldNumber;
+const int FieldDescriptorProto::kOneofIndexFieldNumber;
 const int FieldDescriptorProto::kOptionsFieldNumber;
 #endif  // !_MSC_VER
 
@@ -2243,6 +2373,7 @@ FieldDescriptorProto::FieldDescriptorProto(const FieldDescriptorProto& from)
 
 void FieldDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   number_ = 0;
   label_ = 1;
@@ -2250,6 +2381,7 @@ void FieldDescriptorProto::SharedCtor() {
   type_name_ = const_cast< ::std::string*>(&_default_type_name_);
   extendee_ = const_cast< ::std::string*>(&_default_extendee_);
   default_value_ = const_cast< ::std::string*>(&_default_default_value_);
+  oneof_index_ = 0;
   options_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
@@ -2321,11 +2453,15 @@ void FieldDescriptorProto::Clear() {
         default_value_->clear();
       }
     }
-    if (_has_bit(7)) {
+    oneof_index_ = 0;
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (_has_bit(8)) {
       if (options_ != NULL) options_->::google::protobuf::FieldOptions::Clear();
     }
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -2467,6 +2603,25 @@ bool FieldDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(72)) goto parse_oneof_index;
+        break;
+      }
+      
+      // optional int32 oneof_index = 9;
+      case 9: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_oneof_index:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   ::google::protobuf::int32, ::google::protobuf::internal::WireFormatLite::TYPE_INT32>(
+                 input, &oneof_index_)));
+          _set_bit(7);
         } else {
           goto handle_uninterpreted;
         }
@@ -2546,11 +2701,16 @@ void FieldDescriptorProto::SerializeWithCachedSizes(
   }
   
   // optional .google.protobuf.FieldOptions options = 8;
-  if (_has_bit(7)) {
+  if (_has_bit(8)) {
     ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
       8, this->options(), output);
   }
   
+  // optional int32 oneof_index = 9;
+  if (_has_bit(7)) {
+    ::google::protobuf::internal::WireFormatLite::WriteInt32(9, this->oneof_index(), output);
+  }
+  
   if (!unknown_fields().empty()) {
     ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
         unknown_fields(), output);
@@ -2617,12 +2777,17 @@ void FieldDescriptorProto::SerializeWithCachedSizes(
   }
   
   // optional .google.protobuf.FieldOptions options = 8;
-  if (_has_bit(7)) {
+  if (_has_bit(8)) {
     target = ::google::protobuf::internal::WireFormatLite::
       WriteMessageNoVirtualToArray(
         8, this->options(), target);
   }
   
+  // optional int32 oneof_index = 9;
+  if (_has_bit(7)) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteInt32ToArray(9, this->oneof_index(), target);
+  }
+  
   if (!unknown_fields().empty()) {
     target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
         unknown_fields(), target);
@@ -2681,6 +2846,15 @@ int FieldDescriptorProto::ByteSize() const {
           this->default_value());
     }
     
+    // optional int32 oneof_index = 9;
+    if (has_oneof_index()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::Int32Size(
+          this->oneof_index());
+    }
+    
+  }
+  if (_has_bits_[8 / 32] & (0xffu << (8 % 32))) {
     // optional .google.protobuf.FieldOptions options = 8;
     if (has_options()) {
       total_size += 1 +
@@ -2737,6 +2911,11 @@ void FieldDescriptorProto::MergeFrom(const FieldDescriptorProto& from) {
       set_default_value(from.default_value());
     }
     if (from._has_bit(7)) {
+      set_oneof_index(from.oneof_index());
+    }
+  }
+  if (from._has_bits_[8 / 32] & (0xffu << (8 % 32))) {
+    if (from._has_bit(8)) {
       mutable_options()->::google::protobuf::FieldOptions::MergeFrom(from.options());
     }
   }
@@ -2763,6 +2942,11 @@ bool FieldDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool FieldDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void FieldDescriptorProto::Swap(FieldDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -2772,10 +2956,12 @@ void FieldDescriptorProto::Swap(FieldDescriptorProto* other) {
     std::swap(type_name_, other->type_name_);
     std::swap(extendee_, other->extendee_);
     std::swap(default_value_, other->default_value_);
+    std::swap(oneof_index_, other->oneof_index_);
     std::swap(options_, other->options_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -2788,6 +2974,231 @@ void FieldDescriptorProto::Swap(FieldDescriptorProto* other) {
 }
 
 
+// ===================================================================
+
+const ::std::string OneofDescriptorProto::_default_name_;
+#ifndef _MSC_VER
+const int OneofDescriptorProto::kNameFieldNumber;
+#endif  // !_MSC_VER
+
+OneofDescriptorProto::OneofDescriptorProto()
+  : ::google::protobuf::Message() {
+  SharedCtor();
+}
+
+void OneofDescriptorProto::InitAsDefaultInstance() {
+}
+
+OneofDescriptorProto::OneofDescriptorProto(const OneofDescriptorProto& from)
+  : ::google::protobuf::Message() {
+  SharedCtor();
+  MergeFrom(from);
+}
+
+void OneofDescriptorProto::SharedCtor() {
+  _cached_size_ = 0;
+  name_ = const_cast< ::std::string*>(&_default_name_);
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+}
+
+OneofDescriptorProto::~OneofDescriptorProto() {
+  SharedDtor();
+}
+
+void OneofDescriptorProto::SharedDtor() {
+  if (name_ != &_default_name_) {
+    delete name_;
+  }
+  if (this != default_instance_) {
+  }
+}
+
+void OneofDescriptorProto::SetCachedSize(int size) const {
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+}
+const ::google::protobuf::Descriptor* OneofDescriptorProto::descriptor() {
+  protobuf_AssignDescriptorsOnce();
+  return OneofDescriptorProto_descriptor_;
+}
+
+const OneofDescriptorProto& OneofDescriptorProto::default_instance() {
+  if (default_instance_ == NULL) protobuf_AddDesc_google_2fprotobuf_2fdescriptor_2eproto();  return *default_instance_;
+}
+
+OneofDescriptorProto* OneofDescriptorProto::default_instance_ = NULL;
+
+OneofDescriptorProto* OneofDescriptorProto::New() const {
+  return new OneofDescriptorProto;
+}
+
+void OneofDescriptorProto::Clear() {
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (_has_bit(0)) {
+      if (name_ != &_default_name_) {
+        name_->clear();
+      }
+    }
+  }
+  ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  mutable_unknown_fields()->Clear();
+}
+
+bool OneofDescriptorProto::MergePartialFromCodedStream(
+    ::google::protobuf::io::CodedInputStream* input) {
+#define DO_(EXPRESSION) if (!(EXPRESSION)) return false
+  ::google::protobuf::uint32 tag;
+  while ((tag = input->ReadTag()) != 0) {
+    switch (::google::protobuf::internal::WireFormatLite::GetTagFieldNumber(tag)) {
+      // optional string name = 1;
+      case 1: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+          DO_(::google::protobuf::internal::WireFormatLite::ReadString(
+                input, this->mutable_name()));
+          ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+            this->name().data(), this->name().length(),
+            ::google::protobuf::internal::WireFormat::PARSE);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectAtEnd()) return true;
+        break;
+      }
+      
+      default: {
+      handle_uninterpreted:
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_END_GROUP) {
+          return true;
+        }
+        DO_(::google::protobuf::internal::WireFormat::SkipField(
+              input, tag, mutable_unknown_fields()));
+        break;
+      }
+    }
+  }
+  return true;
+#undef DO_
+}
+
+void OneofDescriptorProto::SerializeWithCachedSizes(
+    ::google::protobuf::io::CodedOutputStream* output) const {
+  // optional string name = 1;
+  if (_has_bit(0)) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->name().data(), this->name().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    ::google::protobuf::internal::WireFormatLite::WriteString(
+      1, this->name(), output);
+  }
+  
+  if (!unknown_fields().empty()) {
+    ::google::protobuf::internal::WireFormat::SerializeUnknownFields(
+        unknown_fields(), output);
+  }
+}
+
+::google::protobuf::uint8* OneofDescriptorProto::SerializeWithCachedSizesToArray(
+    ::google::protobuf::uint8* target) const {
+  // optional string name = 1;
+  if (_has_bit(0)) {
+    ::google::protobuf::internal::WireFormat::VerifyUTF8String(
+      this->name().data(), this->name().length(),
+      ::google::protobuf::internal::WireFormat::SERIALIZE);
+    target =
+      ::google::protobuf::internal::WireFormatLite::WriteStringToArray(
+        1, this->name(), target);
+  }
+  
+  if (!unknown_fields().empty()) {
+    target = ::google::protobuf::internal::WireFormat::SerializeUnknownFieldsToArray(
+        unknown_fields(), target);
+  }
+  return target;
+}
+
+int OneofDescriptorProto::ByteSize() const {
+  int total_size = 0;
+  
+  if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    // optional string name = 1;
+    if (has_name()) {
+      total_size += 1 +
+        ::google::protobuf::internal::WireFormatLite::StringSize(
+          this->name());
+    }
+    
+  }
+  if (!unknown_fields().empty()) {
+    total_size +=
+      ::google::protobuf::internal::WireFormat::ComputeUnknownFieldsSize(
+        unknown_fields());
+  }
+  GOOGLE_SAFE_CONCURRENT_WRITES_BEGIN();
+  _cached_size_ = total_size;
+  GOOGLE_SAFE_CONCURRENT_WRITES_END();
+  return total_size;
+}
+
+void OneofDescriptorProto::MergeFrom(const ::google::protobuf::Message& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  const OneofDescriptorProto* source =
+    ::google::protobuf::internal::dynamic_cast_if_available<const OneofDescriptorProto*>(
+      &from);
+  if (source == NULL) {
+    ::google::protobuf::internal::ReflectionOps::Merge(from, this);
+  } else {
+    MergeFrom(*source);
+  }
+}
+
+void OneofDescriptorProto::MergeFrom(const OneofDescriptorProto& from) {
+  GOOGLE_CHECK_NE(&from, this);
+  if (from._has_bits_[0 / 32] & (0xffu << (0 % 32))) {
+    if (from._has_bit(0)) {
+      set_name(from.name());
+    }
+  }
+  mutable_unknown_fields()->MergeFrom(from.unknown_fields());
+}
+
+void OneofDescriptorProto::CopyFrom(const ::google::protobuf::Message& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+void OneofDescriptorProto::CopyFrom(const OneofDescriptorProto& from) {
+  if (&from == this) return;
+  Clear();
+  MergeFrom(from);
+}
+
+bool OneofDescriptorProto::IsInitialized() const {
+  
+  return true;
+}
+
+void OneofDescriptorProto::Swap(OneofDescriptorProto* other) {
+  if (other != this) {
+    std::swap(name_, other->name_);
+    std::swap(_has_bits_[0], other->_has_bits_[0]);
+    _unknown_fields_.Swap(&other->_unknown_fields_);
+    std::swap(_cached_size_, other->_cached_size_);
+  }
+}
+
+::google::protobuf::Metadata OneofDescriptorProto::GetMetadata() const {
+  protobuf_AssignDescriptorsOnce();
+  ::google::protobuf::Metadata metadata;
+  metadata.descriptor = OneofDescriptorProto_descriptor_;
+  metadata.reflection = OneofDescriptorProto_reflection_;
+  return metadata;
+}
+
+
 // ===================================================================
 
 const ::std::string EnumDescriptorProto::_default_name_;
@@ -2814,6 +3225,7 @@ EnumDescriptorProto::EnumDescriptorProto(const EnumDescriptorProto& from)
 
 void EnumDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   options_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -2865,6 +3277,7 @@ void EnumDescriptorProto::Clear() {
   }
   value_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -2897,6 +3310,9 @@ bool EnumDescriptorProto::MergePartialFromCodedStream(
          parse_value:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_value()));
+          if (!this->value(this->value_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -2912,6 +3328,9 @@ bool EnumDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -3084,6 +3503,11 @@ bool EnumDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool EnumDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void EnumDescriptorProto::Swap(EnumDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -3092,6 +3516,7 @@ void EnumDescriptorProto::Swap(EnumDescriptorProto* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -3130,6 +3555,7 @@ EnumValueDescriptorProto::EnumValueDescriptorProto(const EnumValueDescriptorProt
 
 void EnumValueDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   number_ = 0;
   options_ = NULL;
@@ -3182,6 +3608,7 @@ void EnumValueDescriptorProto::Clear() {
     }
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -3230,6 +3657,9 @@ bool EnumValueDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -3397,6 +3827,11 @@ bool EnumValueDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool EnumValueDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void EnumValueDescriptorProto::Swap(EnumValueDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -3405,6 +3840,7 @@ void EnumValueDescriptorProto::Swap(EnumValueDescriptorProto* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -3443,6 +3879,7 @@ ServiceDescriptorProto::ServiceDescriptorProto(const ServiceDescriptorProto& fro
 
 void ServiceDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   options_ = NULL;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -3494,6 +3931,7 @@ void ServiceDescriptorProto::Clear() {
   }
   method_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -3526,6 +3964,9 @@ bool ServiceDescriptorProto::MergePartialFromCodedStream(
          parse_method:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_method()));
+          if (!this->method(this->method_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -3541,6 +3982,9 @@ bool ServiceDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -3713,6 +4157,11 @@ bool ServiceDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool ServiceDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void ServiceDescriptorProto::Swap(ServiceDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -3721,6 +4170,7 @@ void ServiceDescriptorProto::Swap(ServiceDescriptorProto* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -3762,6 +4212,7 @@ MethodDescriptorProto::MethodDescriptorProto(const MethodDescriptorProto& from)
 
 void MethodDescriptorProto::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_ = const_cast< ::std::string*>(&_default_name_);
   input_type_ = const_cast< ::std::string*>(&_default_input_type_);
   output_type_ = const_cast< ::std::string*>(&_default_output_type_);
@@ -3830,6 +4281,7 @@ void MethodDescriptorProto::Clear() {
     }
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -3896,6 +4348,9 @@ bool MethodDescriptorProto::MergePartialFromCodedStream(
          parse_options:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                input, mutable_options()));
+          if (!this->options().IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -4101,6 +4556,11 @@ bool MethodDescriptorProto::IsInitialized() const {
   return true;
 }
 
+bool MethodDescriptorProto::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void MethodDescriptorProto::Swap(MethodDescriptorProto* other) {
   if (other != this) {
     std::swap(name_, other->name_);
@@ -4110,6 +4570,7 @@ void MethodDescriptorProto::Swap(MethodDescriptorProto* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -4176,6 +4637,7 @@ FileOptions::FileOptions(const FileOptions& from)
 
 void FileOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   java_package_ = const_cast< ::std::string*>(&_default_java_package_);
   java_outer_classname_ = const_cast< ::std::string*>(&_default_java_outer_classname_);
   java_multiple_files_ = false;
@@ -4242,6 +4704,7 @@ void FileOptions::Clear() {
   }
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -4376,6 +4839,9 @@ bool FileOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -4662,6 +5128,12 @@ bool FileOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool FileOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void FileOptions::Swap(FileOptions* other) {
   if (other != this) {
     std::swap(java_package_, other->java_package_);
@@ -4675,6 +5147,7 @@ void FileOptions::Swap(FileOptions* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -4693,6 +5166,7 @@ void FileOptions::Swap(FileOptions* other) {
 #ifndef _MSC_VER
 const int MessageOptions::kMessageSetWireFormatFieldNumber;
 const int MessageOptions::kNoStandardDescriptorAccessorFieldNumber;
+const int MessageOptions::kMapEntryFieldNumber;
 const int MessageOptions::kUninterpretedOptionFieldNumber;
 #endif  // !_MSC_VER
 
@@ -4712,8 +5186,10 @@ MessageOptions::MessageOptions(const MessageOptions& from)
 
 void MessageOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   message_set_wire_format_ = false;
   no_standard_descriptor_accessor_ = false;
+  map_entry_ = false;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -4751,9 +5227,11 @@ void MessageOptions::Clear() {
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     message_set_wire_format_ = false;
     no_standard_descriptor_accessor_ = false;
+    map_entry_ = false;
   }
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -4790,6 +5268,22 @@ bool MessageOptions::MergePartialFromCodedStream(
         } else {
           goto handle_uninterpreted;
         }
+        if (input->ExpectTag(56)) goto parse_map_entry;
+        break;
+      }
+      
+      // optional bool map_entry = 7 [default = false];
+      case 7: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_map_entry:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &map_entry_)));
+          _set_bit(2);
+        } else {
+          goto handle_uninterpreted;
+        }
         if (input->ExpectTag(7994)) goto parse_uninterpreted_option;
         break;
       }
@@ -4801,6 +5295,9 @@ bool MessageOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -4842,6 +5339,11 @@ void MessageOptions::SerializeWithCachedSizes(
     ::google::protobuf::internal::WireFormatLite::WriteBool(2, this->no_standard_descriptor_accessor(), output);
   }
   
+  // optional bool map_entry = 7 [default = false];
+  if (_has_bit(2)) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(7, this->map_entry(), output);
+  }
+  
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
   for (int i = 0; i < this->uninterpreted_option_size(); i++) {
     ::google::protobuf::internal::WireFormatLite::WriteMessageMaybeToArray(
@@ -4870,6 +5372,11 @@ void MessageOptions::SerializeWithCachedSizes(
     target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(2, this->no_standard_descriptor_accessor(), target);
   }
   
+  // optional bool map_entry = 7 [default = false];
+  if (_has_bit(2)) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(7, this->map_entry(), target);
+  }
+  
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
   for (int i = 0; i < this->uninterpreted_option_size(); i++) {
     target = ::google::protobuf::internal::WireFormatLite::
@@ -4902,6 +5409,11 @@ int MessageOptions::ByteSize() const {
       total_size += 1 + 1;
     }
     
+    // optional bool map_entry = 7 [default = false];
+    if (has_map_entry()) {
+      total_size += 1 + 1;
+    }
+    
   }
   // repeated .google.protobuf.UninterpretedOption uninterpreted_option = 999;
   total_size += 2 * this->uninterpreted_option_size();
@@ -4946,6 +5458,9 @@ void MessageOptions::MergeFrom(const MessageOptions& from) {
     if (from._has_bit(1)) {
       set_no_standard_descriptor_accessor(from.no_standard_descriptor_accessor());
     }
+    if (from._has_bit(2)) {
+      set_map_entry(from.map_entry());
+    }
   }
   _extensions_.MergeFrom(from._extensions_);
   mutable_unknown_fields()->MergeFrom(from.unknown_fields());
@@ -4972,14 +5487,22 @@ bool MessageOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool MessageOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void MessageOptions::Swap(MessageOptions* other) {
   if (other != this) {
     std::swap(message_set_wire_format_, other->message_set_wire_format_);
     std::swap(no_standard_descriptor_accessor_, other->no_standard_descriptor_accessor_);
+    std::swap(map_entry_, other->map_entry_);
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -5022,6 +5545,7 @@ const ::std::string FieldOptions::_default_experimental_map_key_;
 #ifndef _MSC_VER
 const int FieldOptions::kCtypeFieldNumber;
 const int FieldOptions::kPackedFieldNumber;
+const int FieldOptions::kContiguousFieldNumber;
 const int FieldOptions::kDeprecatedFieldNumber;
 const int FieldOptions::kExperimentalMapKeyFieldNumber;
 const int FieldOptions::kUninterpretedOptionFieldNumber;
@@ -5043,8 +5567,10 @@ FieldOptions::FieldOptions(const FieldOptions& from)
 
 void FieldOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ctype_ = 0;
   packed_ = false;
+  contiguous_ = false;
   deprecated_ = false;
   experimental_map_key_ = const_cast< ::std::string*>(&_default_experimental_map_key_);
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -5087,8 +5613,9 @@ void FieldOptions::Clear() {
   if (_has_bits_[0 / 32] & (0xffu << (0 % 32))) {
     ctype_ = 0;
     packed_ = false;
+    contiguous_ = false;
     deprecated_ = false;
-    if (_has_bit(3)) {
+    if (_has_bit(4)) {
       if (experimental_map_key_ != &_default_experimental_map_key_) {
         experimental_map_key_->clear();
       }
@@ -5096,6 +5623,7 @@ void FieldOptions::Clear() {
   }
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -5149,6 +5677,22 @@ bool FieldOptions::MergePartialFromCodedStream(
           DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
                    bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
                  input, &deprecated_)));
+          _set_bit(3);
+        } else {
+          goto handle_uninterpreted;
+        }
+        if (input->ExpectTag(32)) goto parse_contiguous;
+        break;
+      }
+      
+      // optional bool contiguous = 4 [default = false];
+      case 4: {
+        if (::google::protobuf::internal::WireFormatLite::GetTagWireType(tag) ==
+            ::google::protobuf::internal::WireFormatLite::WIRETYPE_VARINT) {
+         parse_contiguous:
+          DO_((::google::protobuf::internal::WireFormatLite::ReadPrimitive<
+                   bool, ::google::protobuf::internal::WireFormatLite::TYPE_BOOL>(
+                 input, &contiguous_)));
           _set_bit(2);
         } else {
           goto handle_uninterpreted;
@@ -5181,6 +5725,9 @@ bool FieldOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -5224,12 +5771,17 @@ void FieldOptions::SerializeWithCachedSizes(
   }
   
   // optional bool deprecated = 3 [default = false];
-  if (_has_bit(2)) {
+  if (_has_bit(3)) {
     ::google::protobuf::internal::WireFormatLite::WriteBool(3, this->deprecated(), output);
   }
   
+  // optional bool contiguous = 4 [default = false];
+  if (_has_bit(2)) {
+    ::google::protobuf::internal::WireFormatLite::WriteBool(4, this->contiguous(), output);
+  }
+  
   // optional string experimental_map_key = 9;
-  if (_has_bit(3)) {
+  if (_has_bit(4)) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->experimental_map_key().data(), this->experimental_map_key().length(),
       ::google::protobuf::internal::WireFormat::SERIALIZE);
@@ -5267,12 +5819,17 @@ void FieldOptions::SerializeWithCachedSizes(
   }
   
   // optional bool deprecated = 3 [default = false];
-  if (_has_bit(2)) {
+  if (_has_bit(3)) {
     target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(3, this->deprecated(), target);
   }
   
+  // optional bool contiguous = 4 [default = false];
+  if (_has_bit(2)) {
+    target = ::google::protobuf::internal::WireFormatLite::WriteBoolToArray(4, this->contiguous(), target);
+  }
+  
   // optional string experimental_map_key = 9;
-  if (_has_bit(3)) {
+  if (_has_bit(4)) {
     ::google::protobuf::internal::WireFormat::VerifyUTF8String(
       this->experimental_map_key().data(), this->experimental_map_key().length(),
       ::google::protobuf::internal::WireFormat::SERIALIZE);
@@ -5314,6 +5871,11 @@ int FieldOptions::ByteSize() const {
       total_size += 1 + 1;
     }
     
+    // optional bool contiguous = 4 [default = false];
+    if (has_contiguous()) {
+      total_size += 1 + 1;
+    }
+    
     // optional bool deprecated = 3 [default = false];
     if (has_deprecated()) {
       total_size += 1 + 1;
@@ -5371,9 +5933,12 @@ void FieldOptions::MergeFrom(const FieldOptions& from) {
       set_packed(from.packed());
     }
     if (from._has_bit(2)) {
-      set_deprecated(from.deprecated());
+      set_contiguous(from.contiguous());
     }
     if (from._has_bit(3)) {
+      set_deprecated(from.deprecated());
+    }
+    if (from._has_bit(4)) {
       set_experimental_map_key(from.experimental_map_key());
     }
   }
@@ -5402,16 +5967,24 @@ bool FieldOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool FieldOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void FieldOptions::Swap(FieldOptions* other) {
   if (other != this) {
     std::swap(ctype_, other->ctype_);
     std::swap(packed_, other->packed_);
+    std::swap(contiguous_, other->contiguous_);
     std::swap(deprecated_, other->deprecated_);
     std::swap(experimental_map_key_, other->experimental_map_key_);
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -5447,6 +6020,7 @@ EnumOptions::EnumOptions(const EnumOptions& from)
 
 void EnumOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -5483,6 +6057,7 @@ void EnumOptions::Clear() {
   _extensions_.Clear();
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -5499,6 +6074,9 @@ bool EnumOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -5630,12 +6208,19 @@ bool EnumOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool EnumOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void EnumOptions::Swap(EnumOptions* other) {
   if (other != this) {
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -5671,6 +6256,7 @@ EnumValueOptions::EnumValueOptions(const EnumValueOptions& from)
 
 void EnumValueOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -5707,6 +6293,7 @@ void EnumValueOptions::Clear() {
   _extensions_.Clear();
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -5723,6 +6310,9 @@ bool EnumValueOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -5854,12 +6444,19 @@ bool EnumValueOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool EnumValueOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void EnumValueOptions::Swap(EnumValueOptions* other) {
   if (other != this) {
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -5895,6 +6492,7 @@ ServiceOptions::ServiceOptions(const ServiceOptions& from)
 
 void ServiceOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -5931,6 +6529,7 @@ void ServiceOptions::Clear() {
   _extensions_.Clear();
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -5947,6 +6546,9 @@ bool ServiceOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -6078,12 +6680,19 @@ bool ServiceOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool ServiceOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void ServiceOptions::Swap(ServiceOptions* other) {
   if (other != this) {
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -6119,6 +6728,7 @@ MethodOptions::MethodOptions(const MethodOptions& from)
 
 void MethodOptions::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
 }
 
@@ -6155,6 +6765,7 @@ void MethodOptions::Clear() {
   _extensions_.Clear();
   uninterpreted_option_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -6171,6 +6782,9 @@ bool MethodOptions::MergePartialFromCodedStream(
          parse_uninterpreted_option:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_uninterpreted_option()));
+          if (!this->uninterpreted_option(this->uninterpreted_option_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -6302,12 +6916,19 @@ bool MethodOptions::IsInitialized() const {
   if (!_extensions_.IsInitialized()) return false;  return true;
 }
 
+bool MethodOptions::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if (!_extensions_.IsInitialized()) return false;
+  return true;
+}
+
 void MethodOptions::Swap(MethodOptions* other) {
   if (other != this) {
     uninterpreted_option_.Swap(&other->uninterpreted_option_);
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
     _extensions_.Swap(&other->_extensions_);
   }
 }
@@ -6345,6 +6966,7 @@ UninterpretedOption_NamePart::UninterpretedOption_NamePart(const UninterpretedOp
 
 void UninterpretedOption_NamePart::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   name_part_ = const_cast< ::std::string*>(&_default_name_part_);
   is_extension_ = false;
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
@@ -6392,6 +7014,7 @@ void UninterpretedOption_NamePart::Clear() {
     is_extension_ = false;
   }
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -6566,6 +7189,12 @@ bool UninterpretedOption_NamePart::IsInitialized() const {
   return true;
 }
 
+bool UninterpretedOption_NamePart::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  if ((_has_bits_[0] & 0x00000003) != 0x00000003) return false;
+  return true;
+}
+
 void UninterpretedOption_NamePart::Swap(UninterpretedOption_NamePart* other) {
   if (other != this) {
     std::swap(name_part_, other->name_part_);
@@ -6573,6 +7202,7 @@ void UninterpretedOption_NamePart::Swap(UninterpretedOption_NamePart* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -6614,6 +7244,7 @@ UninterpretedOption::UninterpretedOption(const UninterpretedOption& from)
 
 void UninterpretedOption::SharedCtor() {
   _cached_size_ = 0;
+  _children_initialized_ = true;
   identifier_value_ = const_cast< ::std::string*>(&_default_identifier_value_);
   positive_int_value_ = GOOGLE_ULONGLONG(0);
   negative_int_value_ = GOOGLE_LONGLONG(0);
@@ -6675,6 +7306,7 @@ void UninterpretedOption::Clear() {
   }
   name_.Clear();
   ::memset(_has_bits_, 0, sizeof(_has_bits_));
+  _children_initialized_ = true;
   mutable_unknown_fields()->Clear();
 }
 
@@ -6691,6 +7323,9 @@ bool UninterpretedOption::MergePartialFromCodedStream(
          parse_name:
           DO_(::google::protobuf::internal::WireFormatLite::ReadMessageNoVirtual(
                 input, add_name()));
+          if (!this->name(this->name_size() - 1).IsInitializedAfterParse()) {
+            _children_initialized_ = false;
+          }
         } else {
           goto handle_uninterpreted;
         }
@@ -6998,6 +7633,11 @@ bool UninterpretedOption::IsInitialized() const {
   return true;
 }
 
+bool UninterpretedOption::IsInitializedAfterParse() const {
+  if (!_children_initialized_) return IsInitialized();
+  return true;
+}
+
 void UninterpretedOption::Swap(UninterpretedOption* other) {
   if (other != this) {
     name_.Swap(&other->name_);
@@ -7009,6 +7649,7 @@ void UninterpretedOption::Swap(UninterpretedOption* other) {
     std::swap(_has_bits_[0], other->_has_bits_[0]);
     _unknown_fields_.Swap(&other->_unknown_fields_);
     std::swap(_cached_size_, other->_cached_size_);
+    std::swap(_children_initialized_, other->_children_initialized_);
   }
 }
 
@@ -1352,6 +1352,134 @@ TEST_F(NestedDescriptorTest, FindEnumValueByName) {
 
 // ===================================================================
 
+// Test oneofs.
+class OneofDescriptorTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    // Build a file that looks like:
+    //
+    //   package garply;
+    //   message TestOneof {
+    //     optional int32 a = 1;
+    //     oneof foo {
+    //       string b = 2;
+    //       TestOneof c = 3;
+    //     }
+    //     oneof bar {
+    //       float d = 4;
+    //     }
+    //   }
+
+    FileDescriptorProto baz_file;
+    ASSERT_TRUE(TextFormat::ParseFromString(
+      "name: \"baz.proto\" "
+      "package: \"garply\" "
+      "message_type {"
+      "  name: \"TestOneof\""
+      "  field { name:\"a\" number:1 label:LABEL_OPTIONAL type:TYPE_INT32 }"
+      "  field { name:\"b\" number:2 label:LABEL_OPTIONAL type:TYPE_STRING"
+      "          oneof_index:0 }"
+      "  field { name:\"c\" number:3 label:LABEL_OPTIONAL"
+      "          type_name:\"TestOneof\" oneof_index:0 }"
+      "  field { name:\"d\" number:4 label:LABEL_OPTIONAL type:TYPE_FLOAT"
+      "          oneof_index:1 }"
+      "  oneof_decl { name:\"foo\" }"
+      "  oneof_decl { name:\"bar\" }"
+      "}",
+      &baz_file));
+
+    baz_file_ = pool_.BuildFile(baz_file);
+    ASSERT_TRUE(baz_file_ != NULL);
+
+    ASSERT_EQ(1, baz_file_->message_type_count());
+    oneof_message_ = baz_file_->message_type(0);
+    ASSERT_EQ(2, oneof_message_->oneof_decl_count());
+    oneof_ = oneof_message_->oneof_decl(0);
+    oneof2_ = oneof_message_->oneof_decl(1);
+
+    ASSERT_EQ(4, oneof_message_->field_count());
+    a_ = oneof_message_->field(0);
+    b_ = oneof_message_->field(1);
+    c_ = oneof_message_->field(2);
+    d_ = oneof_message_->field(3);
+  }
+
+  DescriptorPool pool_;
+
+  const FileDescriptor* baz_file_;
+
+  const Descriptor* oneof_message_;
+
+  const OneofDescriptor* oneof_;
+  const OneofDescriptor* oneof2_;
+  const FieldDescriptor* a_;
+  const FieldDescriptor* b_;
+  const FieldDescriptor* c_;
+  const FieldDescriptor* d_;
+};
+
+TEST_F(OneofDescriptorTest, Normal) {
+  EXPECT_EQ("foo", oneof_->name());
+  EXPECT_EQ("garply.TestOneof.foo", oneof_->full_name());
+  EXPECT_EQ(0, oneof_->index());
+  EXPECT_EQ(1, oneof2_->index());
+  EXPECT_EQ(oneof_message_, oneof_->containing_type());
+
+  ASSERT_EQ(2, oneof_->field_count());
+  EXPECT_EQ(b_, oneof_->field(0));
+  EXPECT_EQ(c_, oneof_->field(1));
+  ASSERT_EQ(1, oneof2_->field_count());
+  EXPECT_EQ(d_, oneof2_->field(0));
+
+  EXPECT_TRUE(a_->containing_oneof() == NULL);
+  EXPECT_EQ(oneof_, b_->containing_oneof());
+  EXPECT_EQ(oneof_, c_->containing_oneof());
+  EXPECT_EQ(oneof2_, d_->containing_oneof());
+  EXPECT_EQ(0, b_->index_in_oneof());
+  EXPECT_EQ(1, c_->index_in_oneof());
+}
+
+TEST_F(OneofDescriptorTest, FindByName) {
+  EXPECT_EQ(oneof_, oneof_message_->FindOneofByName("foo"));
+  EXPECT_EQ(oneof2_, oneof_message_->FindOneofByName("bar"));
+  EXPECT_TRUE(oneof_message_->FindOneofByName("no_such_oneof") == NULL);
+  EXPECT_TRUE(oneof_message_->FindOneofByName("a") == NULL);
+  EXPECT_TRUE(oneof_message_->FindFieldByName("foo") == NULL);
+
+  EXPECT_EQ(oneof_, pool_.FindOneofByName("garply.TestOneof.foo"));
+  EXPECT_TRUE(pool_.FindOneofByName("garply.TestOneof") == NULL);
+}
+
+TEST_F(OneofDescriptorTest, CopyTo) {
+  FileDescriptorProto copy;
+  baz_file_->CopyTo(&copy);
+
+  const DescriptorProto& message = copy.message_type(0);
+  ASSERT_EQ(2, message.oneof_decl_size());
+  EXPECT_EQ("foo", message.oneof_decl(0).name());
+  EXPECT_FALSE(message.field(0).has_oneof_index());
+  EXPECT_EQ(0, message.field(1).oneof_index());
+  EXPECT_EQ(0, message.field(2).oneof_index());
+  EXPECT_EQ(1, message.field(3).oneof_index());
+}
+
+TEST_F(OneofDescriptorTest, DebugString) {
+  EXPECT_EQ(
+    "message TestOneof {\n"
+    "  optional int32 a = 1;\n"
+    "  oneof foo {\n"
+    "    string b = 2;\n"
+    "    .garply.TestOneof c = 3;\n"
+    "  }\n"
+    "  oneof bar {\n"
+    "    float d = 4;\n"
+    "  }\n"
+    "}\n",
+    oneof_message_->DebugString());
+}
+
+// ===================================================================
+
 // Test extensions.
 class ExtensionDescriptorTest : public testing::Test {
  protected:
@@ -2586,6 +2714,68 @@ TEST_F(ValidationErrorTest, ExtensionMissingExtendee) {
       "extension field.\n");
 }
 
+TEST_F(ValidationErrorTest, OneofIndexOutOfRange) {
+  BuildFileWithErrors(
+    "name: \"foo.proto\" "
+    "message_type {"
+    "  name: \"Foo\""
+    "  field { name:\"foo\" number:1 label:LABEL_OPTIONAL type:TYPE_INT32"
+    "          oneof_index:1 }"
+    "  oneof_decl { name:\"bar\" }"
+    "}",
+
+    "foo.proto: Foo.foo: OTHER: FieldDescriptorProto.oneof_index 1 is out of "
+      "range for type \"Foo\".\n"
+    "foo.proto: Foo.bar: NAME: Oneof must have at least one field.\n");
+}
+
+TEST_F(ValidationErrorTest, OneofFieldNotOptional) {
+  BuildFileWithErrors(
+    "name: \"foo.proto\" "
+    "message_type {"
+    "  name: \"Foo\""
+    "  field { name:\"foo\" number:1 label:LABEL_REPEATED type:TYPE_INT32"
+    "          oneof_index:0 }"
+    "  field { name:\"baz\" number:2 label:LABEL_OPTIONAL type:TYPE_INT32"
+    "          oneof_index:0 }"
+    "  oneof_decl { name:\"bar\" }"
+    "}",
+
+    "foo.proto: Foo.foo: OTHER: Fields of oneofs must be optional.\n");
+}
+
+TEST_F(ValidationErrorTest, OneofFieldsNotConsecutive) {
+  BuildFileWithErrors(
+    "name: \"foo.proto\" "
+    "message_type {"
+    "  name: \"Foo\""
+    "  field { name:\"foo\" number:1 label:LABEL_OPTIONAL type:TYPE_INT32"
+    "          oneof_index:0 }"
+    "  field { name:\"bar\" number:2 label:LABEL_OPTIONAL type:TYPE_INT32 }"
+    "  field { name:\"baz\" number:3 label:LABEL_OPTIONAL type:TYPE_INT32"
+    "          oneof_index:0 }"
+    "  oneof_decl { name:\"qux\" }"
+    "}",
+
+    "foo.proto: Foo.baz: OTHER: Fields in the same oneof must be defined "
+      "consecutively. \"bar\" cannot be defined before the completion of the "
+      "\"qux\" oneof definition.\n");
+}
+
+TEST_F(ValidationErrorTest, OneofIndexOnExtension) {
+  BuildFileWithErrors(
+    "name: \"foo.proto\" "
+    "message_type {"
+    "  name: \"Foo\""
+    "  extension_range { start: 10 end: 20 }"
+    "  extension { name:\"foo\" number:10 label:LABEL_OPTIONAL"
+    "              type:TYPE_INT32 extendee:\"Foo\" oneof_index:0 }"
+    "}",
+
+    "foo.proto: Foo.foo: OTHER: FieldDescriptorProto.oneof_index should not "
+      "be set for extensions.\n");
+}
+
 TEST_F(ValidationErrorTest, NonExtensionWithExtendee) {
   BuildFileWithErrors(
     "name: \"foo.proto\" "
@@ -3064,6 +3254,43 @@ TEST_F(ValidationErrorTest, IllegalPackedField) {
         );
 }
 
+TEST_F(ValidationErrorTest, IllegalContiguousField) {
+  BuildFileWithErrors(
+    "name: \"foo.proto\" "
+    "message_type {\n"
+    "  name: \"Foo\""
+    "  field { name:\"contiguous_int32\" number:1 label:LABEL_REPEATED "
+    "          type:TYPE_INT32 "
+    "          options { uninterpreted_option {"
+    "            name { name_part: \"contiguous\" is_extension: false }"
+    "            identifier_value: \"true\" }}}\n"
+    "  field { name:\"optional_message\" number:2 label:LABEL_OPTIONAL "
+    "          type_name: \"Foo\""
+    "          options { uninterpreted_option {"
+    "            name { name_part: \"contiguous\" is_extension: false }"
+    "            identifier_value: \"true\" }}}\n"
+    "  field { name:\"repeated_message\" number:3 label:LABEL_REPEATED "
+    "          type_name: \"Foo\""
+    "          options { uninterpreted_option {"
+    "            name { name_part: \"contiguous\" is_extension: false }"
+    "            identifier_value: \"true\" }}}\n"
+    "  extension_range { start: 10 end: 20 }"
+    "}"
+    "extension { name:\"contiguous_extension\" number:10 "
+    "            label:LABEL_REPEATED type_name:\"Foo\" extendee:\"Foo\""
+    "            options { uninterpreted_option {"
+    "              name { name_part: \"contiguous\" is_extension: false }"
+    "              identifier_value: \"true\" }}}",
+
+    "foo.proto: Foo.contiguous_int32: TYPE: [contiguous = true] can only be "
+        "specified for repeated message fields which are not extensions.\n"
+    "foo.proto: Foo.optional_message: TYPE: [contiguous = true] can only be "
+        "specified for repeated message fields which are not extensions.\n"
+    "foo.proto: contiguous_extension: TYPE: [contiguous = true] can only be "
+        "specified for repeated message fields which are not extensions.\n"
+        );
+}
+
 TEST_F(ValidationErrorTest, OptionWrongType) {
   BuildFileWithErrors(
     "name: \"foo.proto\" "
@@ -74,6 +74,9 @@
 #include <google/protobuf/generated_message_reflection.h>
 #include <google/protobuf/reflection_ops.h>
 #include <google/protobuf/repeated_field.h>
+#include <google/protobuf/map_field.h>
+#include <google/protobuf/slab_repeated_field.h>
+#include <google/protobuf/repeated_string_piece_field.h>
 #include <google/protobuf/extension_set.h>
 #include <google/protobuf/wire_format.h>
 
@@ -83,6 +86,11 @@ namespace protobuf {
 using internal::WireFormat;
 using internal::ExtensionSet;
 using internal::GeneratedMessageReflection;
+using internal::IsMapField;
+using internal::IsSlabField;
+using internal::IsStringPieceField;
+using internal::MapFieldBase;
+using internal::SlabRepeatedFieldBase;
 
 
 // ===================================================================
@@ -103,10 +111,17 @@ int FieldSpaceUsed(const FieldDescriptor* field) {
       case FD::CPPTYPE_FLOAT  : return sizeof(RepeatedField<float   >);
       case FD::CPPTYPE_BOOL   : return sizeof(RepeatedField<bool    >);
       case FD::CPPTYPE_ENUM   : return sizeof(RepeatedField<int     >);
-      case FD::CPPTYPE_MESSAGE: return sizeof(RepeatedPtrField<Message>);
+      case FD::CPPTYPE_MESSAGE:
+        // Reflection expects map fields to have an index after the entries.
+        if (IsMapField(field)) return sizeof(MapFieldBase);
+        // Likewise, contiguous fields have slabs after the elements.
+        if (IsSlabField(field)) return sizeof(SlabRepeatedFieldBase);
+        return sizeof(RepeatedPtrField<Message>);
 
       case FD::CPPTYPE_STRING:
         switch (field->options().ctype()) {
+          case FieldOptions::STRING_PIECE:
+            return sizeof(RepeatedStringPieceField);
           default:  // TODO(kenton):  Support other string reps.
           case FieldOptions::STRING:
             return sizeof(RepeatedPtrField<string>);
@@ -166,6 +181,7 @@ class DynamicMessage : public Message {
   struct TypeInfo {
     int size;
     int has_bits_offset;
+    int oneof_case_offset;
     int unknown_fields_offset;
     int extensions_offset;
 
@@ -239,8 +255,16 @@ DynamicMessage::DynamicMessage(const TypeInfo* type_info)
     new(OffsetToPointer(type_info_->extensions_offset)) ExtensionSet;
   }
 
+  // Every oneof starts out with no member set, so the members sharing its
+  // slot are left unconstructed.
+  for (int i = 0; i < descriptor->oneof_decl_count(); i++) {
+    new(OffsetToPointer(type_info_->oneof_case_offset + sizeof(uint32) * i))
+        uint32(0);
+  }
+
   for (int i = 0; i < descriptor->field_count(); i++) {
     const FieldDescriptor* field = descriptor->field(i);
+    if (field->containing_oneof() != NULL) continue;
     void* field_ptr = OffsetToPointer(type_info_->offsets[i]);
     switch (field->cpp_type()) {
 #define HANDLE_TYPE(CPPTYPE, TYPE)                                           \
@@ -283,6 +307,8 @@ DynamicMessage::DynamicMessage(const TypeInfo* type_info)
                       type_info_->offsets[i]));
                 new(field_ptr) string*(default_value);
               }
+            } else if (IsStringPieceField(field)) {
+              new(field_ptr) RepeatedStringPieceField();
             } else {
               new(field_ptr) RepeatedPtrField<string>();
             }
@@ -293,6 +319,10 @@ DynamicMessage::DynamicMessage(const TypeInfo* type_info)
       case FieldDescriptor::CPPTYPE_MESSAGE: {
         if (!field->is_repeated()) {
           new(field_ptr) Message*(NULL);
+        } else if (IsMapField(field)) {
+          new(field_ptr) MapFieldBase();
+        } else if (IsSlabField(field)) {
+          new(field_ptr) SlabRepeatedFieldBase();
         } else {
           new(field_ptr) RepeatedPtrField<Message>();
         }
@@ -313,6 +343,29 @@ DynamicMessage::~DynamicMessage() {
       OffsetToPointer(type_info_->extensions_offset))->~ExtensionSet();
   }
 
+  // The set member of each oneof, if any, owns its string or message.  The
+  // prototype never has a oneof member set.
+  for (int i = 0; i < descriptor->oneof_decl_count(); i++) {
+    const OneofDescriptor* oneof = descriptor->oneof_decl(i);
+    uint32 oneof_case = *reinterpret_cast<const uint32*>(
+        OffsetToPointer(type_info_->oneof_case_offset + sizeof(uint32) * i));
+    if (oneof_case == 0) continue;
+
+    const FieldDescriptor* field = descriptor->FindFieldByNumber(oneof_case);
+    GOOGLE_DCHECK(field != NULL && field->containing_oneof() == oneof);
+    void* field_ptr = OffsetToPointer(type_info_->offsets[field->index()]);
+    if (field->cpp_type() == FieldDescriptor::CPPTYPE_STRING) {
+      switch (field->options().ctype()) {
+        default:  // TODO(kenton):  Support other string reps.
+        case FieldOptions::STRING:
+          delete *reinterpret_cast<string**>(field_ptr);
+          break;
+      }
+    } else if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE) {
+      delete *reinterpret_cast<Message**>(field_ptr);
+    }
+  }
+
   // We need to manually run the destructors for repeated fields and strings,
   // just as we ran their constructors in the the DynamicMessage constructor.
   // Additionally, if any singular embedded messages have been allocated, we
@@ -321,6 +374,7 @@ DynamicMessage::~DynamicMessage() {
   // be touched.
   for (int i = 0; i < descriptor->field_count(); i++) {
     const FieldDescriptor* field = descriptor->field(i);
+    if (field->containing_oneof() != NULL) continue;
     void* field_ptr = OffsetToPointer(type_info_->offsets[i]);
 
     if (field->is_repeated()) {
@@ -343,6 +397,10 @@ DynamicMessage::~DynamicMessage() {
 
         case FieldDescriptor::CPPTYPE_STRING:
           switch (field->options().ctype()) {
+            case FieldOptions::STRING_PIECE:
+              reinterpret_cast<RepeatedStringPieceField*>(field_ptr)
+                  ->~RepeatedStringPieceField();
+              break;
             default:  // TODO(kenton):  Support other string reps.
             case FieldOptions::STRING:
               reinterpret_cast<RepeatedPtrField<string>*>(field_ptr)
@@ -352,8 +410,15 @@ DynamicMessage::~DynamicMessage() {
           break;
 
         case FieldDescriptor::CPPTYPE_MESSAGE:
-          reinterpret_cast<RepeatedPtrField<Message>*>(field_ptr)
-              ->~RepeatedPtrField<Message>();
+          if (IsMapField(field)) {
+            reinterpret_cast<MapFieldBase*>(field_ptr)->~MapFieldBase();
+          } else if (IsSlabField(field)) {
+            reinterpret_cast<SlabRepeatedFieldBase*>(field_ptr)
+                ->~SlabRepeatedFieldBase();
+          } else {
+            reinterpret_cast<RepeatedPtrField<Message>*>(field_ptr)
+                ->~RepeatedPtrField<Message>();
+          }
           break;
       }
 
@@ -391,7 +456,7 @@ void DynamicMessage::CrossLinkPrototypes() {
     void* field_ptr = OffsetToPointer(type_info_->offsets[i]);
 
     if (field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE &&
-        !field->is_repeated()) {
+        !field->is_repeated() && field->containing_oneof() == NULL) {
       // For fields with message types, we need to cross-link with the
       // prototype for the field's type.
       // For singular fields, the field is just a pointer which should
@@ -482,6 +547,7 @@ const Message* DynamicMessageFactory::GetPrototypeNoLock(
   //   this block.
   // - A big bitfield containing a bit for each field indicating whether
   //   or not that field is set.
+  // - An array of uint32s recording which member of each oneof is set.
 
   // Compute size and offsets.
   int* offsets = new int[type->field_count()];
@@ -500,6 +566,15 @@ const Message* DynamicMessageFactory::GetPrototypeNoLock(
   size += has_bits_array_size * sizeof(uint32);
   size = AlignOffset(size);
 
+  // The oneof cases, if any.
+  if (type->oneof_decl_count() > 0) {
+    type_info->oneof_case_offset = size;
+    size += type->oneof_decl_count() * sizeof(uint32);
+    size = AlignOffset(size);
+  } else {
+    type_info->oneof_case_offset = -1;
+  }
+
   // The ExtensionSet, if any.
   if (type->extension_range_count() > 0) {
     type_info->extensions_offset = size;
@@ -510,10 +585,23 @@ const Message* DynamicMessageFactory::GetPrototypeNoLock(
     type_info->extensions_offset = -1;
   }
 
-  // All the fields.
+  // All the fields.  The members of a oneof are defined consecutively and
+  // share one slot, sized for the largest of them.
   for (int i = 0; i < type->field_count(); i++) {
-    // Make sure field is aligned to avoid bus errors.
+    const OneofDescriptor* oneof = type->field(i)->containing_oneof();
+    if (oneof != NULL && oneof->field(0) != type->field(i)) {
+      offsets[i] = offsets[oneof->field(0)->index()];
+      continue;
+    }
+
     int field_size = FieldSpaceUsed(type->field(i));
+    if (oneof != NULL) {
+      for (int j = 1; j < oneof->field_count(); j++) {
+        field_size = max(field_size, FieldSpaceUsed(oneof->field(j)));
+      }
+    }
+
+    // Make sure field is aligned to avoid bus errors.
     size = AlignTo(size, min(kSafeAlignment, field_size));
     offsets[i] = size;
     size += field_size;
@@ -546,7 +634,8 @@ const Message* DynamicMessageFactory::GetPrototypeNoLock(
       type_info->extensions_offset,
       type_info->pool,
       this,
-      type_info->size));
+      type_info->size,
+      type_info->oneof_case_offset));
 
   // Cross link prototypes.
   prototype->CrossLinkPrototypes();
@@ -158,5 +158,84 @@ TEST_F(DynamicMessageTest, SpaceUsed) {
   EXPECT_LT(initial_space_used, message->SpaceUsed());
 }
 
+TEST_F(DynamicMessageTest, Oneof) {
+  // Check that oneof members share storage, and that only the set member
+  // is freed.
+  const Descriptor* descriptor =
+    pool_.FindMessageTypeByName("protobuf_unittest.TestOneof");
+  ASSERT_TRUE(descriptor != NULL);
+  scoped_ptr<Message> message(factory_.GetPrototype(descriptor)->New());
+  const Reflection* reflection = message->GetReflection();
+  const FieldDescriptor* foo_int = descriptor->FindFieldByName("foo_int");
+  const FieldDescriptor* foo_string =
+    descriptor->FindFieldByName("foo_string");
+  const FieldDescriptor* foo_message =
+    descriptor->FindFieldByName("foo_message");
+  const FieldDescriptor* after = descriptor->FindFieldByName("after");
+
+  EXPECT_EQ("abc", reflection->GetString(*message, foo_string));
+
+  reflection->SetString(message.get(), foo_string, "hello");
+  reflection->SetString(message.get(), after, "world");
+  reflection->SetInt32(message.get(), foo_int, 123);
+  EXPECT_FALSE(reflection->HasField(*message, foo_string));
+  EXPECT_EQ(123, reflection->GetInt32(*message, foo_int));
+  EXPECT_EQ("world", reflection->GetString(*message, after));
+
+  reflection->MutableMessage(message.get(), foo_message);
+  EXPECT_TRUE(reflection->HasField(*message, foo_message));
+  EXPECT_FALSE(reflection->HasField(*message, foo_int));
+
+  // Round-trip through the generated class.
+  unittest::TestOneof generated;
+  generated.set_foo_string("parsed");
+  ASSERT_TRUE(message->ParseFromString(generated.SerializeAsString()));
+  EXPECT_TRUE(reflection->HasField(*message, foo_string));
+  EXPECT_FALSE(reflection->HasField(*message, foo_message));
+  EXPECT_EQ("parsed", reflection->GetString(*message, foo_string));
+  EXPECT_EQ(generated.SerializeAsString(), message->SerializeAsString());
+
+  scoped_ptr<Message> message2(message->New());
+  message2->GetReflection()->Swap(message.get(), message2.get());
+  EXPECT_FALSE(reflection->HasField(*message, foo_string));
+  EXPECT_EQ("parsed", reflection->GetString(*message2, foo_string));
+}
+
+TEST_F(DynamicMessageTest, Contiguous) {
+  // Contiguous fields read and write like any other repeated message field,
+  // whether elements come from parsing or from reflection.
+  const Descriptor* descriptor =
+    pool_.FindMessageTypeByName("protobuf_unittest.TestContiguous");
+  ASSERT_TRUE(descriptor != NULL);
+  scoped_ptr<Message> message(factory_.GetPrototype(descriptor)->New());
+  const Reflection* reflection = message->GetReflection();
+  const FieldDescriptor* items = descriptor->FindFieldByName("items");
+  const FieldDescriptor* bb = items->message_type()->FindFieldByName("bb");
+
+  unittest::TestContiguous generated;
+  generated.add_items()->set_bb(1);
+  generated.add_items()->set_bb(2);
+  ASSERT_TRUE(message->ParseFromString(generated.SerializeAsString()));
+  EXPECT_EQ(2, reflection->FieldSize(*message, items));
+
+  Message* added = reflection->AddMessage(message.get(), items);
+  added->GetReflection()->SetInt32(added, bb, 3);
+  EXPECT_EQ(3, reflection->FieldSize(*message, items));
+  const Message& second = reflection->GetRepeatedMessage(*message, items, 1);
+  EXPECT_EQ(2, second.GetReflection()->GetInt32(second, bb));
+
+  // Elements added through reflection are reachable from the generated
+  // class too.
+  unittest::TestContiguous round_trip;
+  ASSERT_TRUE(round_trip.ParseFromString(message->SerializeAsString()));
+  ASSERT_EQ(3, round_trip.items_size());
+  EXPECT_EQ(3, round_trip.items(2).bb());
+
+  scoped_ptr<Message> message2(message->New());
+  reflection->Swap(message.get(), message2.get());
+  EXPECT_EQ(0, reflection->FieldSize(*message, items));
+  EXPECT_EQ(3, reflection->FieldSize(*message2, items));
+}
+
 }  // namespace protobuf
 }  // namespace google
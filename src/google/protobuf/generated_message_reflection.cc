@@ -39,6 +39,9 @@
 #include <google/protobuf/repeated_field.h>
 #include <google/protobuf/extension_set.h>
 #include <google/protobuf/generated_message_util.h>
+#include <google/protobuf/map_field.h>
+#include <google/protobuf/slab_repeated_field.h>
+#include <google/protobuf/repeated_string_piece_field.h>
 #include <google/protobuf/stubs/common.h>
 
 namespace google {
@@ -74,6 +77,40 @@ const string& NameOfEnum(const EnumDescriptor* descriptor, int value) {
   return (d == NULL ? kEmptyString : d->name());
 }
 
+bool IsMapField(const FieldDescriptor* field) {
+  if (field->is_extension() ||
+      field->type() != FieldDescriptor::TYPE_MESSAGE ||
+      !field->message_type()->options().map_entry()) {
+    return false;
+  }
+  const FieldDescriptor* key = field->experimental_map_key();
+  if (key == NULL || key->name() != "key") return false;
+  switch (key->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_INT32:
+    case FieldDescriptor::CPPTYPE_INT64:
+    case FieldDescriptor::CPPTYPE_UINT32:
+    case FieldDescriptor::CPPTYPE_UINT64:
+    case FieldDescriptor::CPPTYPE_BOOL:
+    case FieldDescriptor::CPPTYPE_ENUM:
+    case FieldDescriptor::CPPTYPE_STRING:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsSlabField(const FieldDescriptor* field) {
+  return field->is_repeated() && !field->is_extension() &&
+         field->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE &&
+         field->options().contiguous() && !IsMapField(field);
+}
+
+bool IsStringPieceField(const FieldDescriptor* field) {
+  return field->is_repeated() && !field->is_extension() &&
+         field->cpp_type() == FieldDescriptor::CPPTYPE_STRING &&
+         field->options().ctype() == FieldOptions::STRING_PIECE;
+}
+
 // ===================================================================
 // Helpers for reporting usage errors (e.g. trying to use GetInt32() on
 // a string field).
@@ -177,7 +214,8 @@ GeneratedMessageReflection::GeneratedMessageReflection(
     int extensions_offset,
     const DescriptorPool* descriptor_pool,
     MessageFactory* factory,
-    int object_size)
+    int object_size,
+    int oneof_case_offset)
   : descriptor_       (descriptor),
     default_instance_ (default_instance),
     offsets_          (offsets),
@@ -185,6 +223,7 @@ GeneratedMessageReflection::GeneratedMessageReflection(
     unknown_fields_offset_(unknown_fields_offset),
     extensions_offset_(extensions_offset),
     object_size_      (object_size),
+    oneof_case_offset_(oneof_case_offset),
     descriptor_pool_  ((descriptor_pool == NULL) ?
                          DescriptorPool::generated_pool() :
                          descriptor_pool),
@@ -240,6 +279,10 @@ int GeneratedMessageReflection::SpaceUsed(const Message& message) const {
 
         case FieldDescriptor::CPPTYPE_STRING:
           switch (field->options().ctype()) {
+            case FieldOptions::STRING_PIECE:
+              total_size += GetRaw<RepeatedStringPieceField>(message, field)
+                              .SpaceUsedExcludingSelf();
+              break;
             default:  // TODO(kenton):  Support other string reps.
             case FieldOptions::STRING:
               total_size += GetRaw<RepeatedPtrField<string> >(message, field)
@@ -257,6 +300,12 @@ int GeneratedMessageReflection::SpaceUsed(const Message& message) const {
           break;
       }
     } else {
+      // Only the set member of a oneof occupies its storage.
+      if (field->containing_oneof() != NULL &&
+          !HasOneofField(message, field)) {
+        continue;
+      }
+
       switch (field->cpp_type()) {
         case FieldDescriptor::CPPTYPE_INT32 :
         case FieldDescriptor::CPPTYPE_INT64 :
@@ -277,10 +326,10 @@ int GeneratedMessageReflection::SpaceUsed(const Message& message) const {
 
               // Initially, the string points to the default value stored in
               // the prototype. Only count the string if it has been changed
-              // from the default value.
-              const string* default_ptr = DefaultRaw<const string*>(field);
-
-              if (ptr != default_ptr) {
+              // from the default value.  A set oneof member always owns its
+              // string.
+              if (field->containing_oneof() != NULL ||
+                  ptr != DefaultRaw<const string*>(field)) {
                 // string fields are represented by just a pointer, so also
                 // include sizeof(string) as well.
                 total_size += sizeof(*ptr) + StringSpaceUsedExcludingSelf(*ptr);
@@ -340,6 +389,10 @@ void GeneratedMessageReflection::Swap(
 
   for (int i = 0; i < descriptor_->field_count(); i++) {
     const FieldDescriptor* field = descriptor_->field(i);
+    if (field->containing_oneof() != NULL) {
+      // Swapped below, one oneof at a time.
+      continue;
+    }
     if (field->is_repeated()) {
       switch (field->cpp_type()) {
 #define SWAP_ARRAYS(CPPTYPE, TYPE)                                           \
@@ -360,8 +413,21 @@ void GeneratedMessageReflection::Swap(
 
         case FieldDescriptor::CPPTYPE_STRING:
         case FieldDescriptor::CPPTYPE_MESSAGE:
+          if (IsStringPieceField(field)) {
+            MutableRaw<RepeatedStringPieceField>(message1, field)->Swap(
+                MutableRaw<RepeatedStringPieceField>(message2, field));
+            break;
+          }
+          if (IsSlabField(field)) {
+            // The slabs must go along with the elements they hold.
+            MutableRaw<SlabRepeatedFieldBase>(message1, field)->Swap(
+                MutableRaw<SlabRepeatedFieldBase>(message2, field));
+            break;
+          }
           MutableRaw<RepeatedPtrFieldBase>(message1, field)->Swap(
               MutableRaw<RepeatedPtrFieldBase>(message2, field));
+          InvalidateMapIndex(message1, field);
+          InvalidateMapIndex(message2, field);
           break;
 
         default:
@@ -402,6 +468,10 @@ void GeneratedMessageReflection::Swap(
     }
   }
 
+  for (int i = 0; i < descriptor_->oneof_decl_count(); i++) {
+    SwapOneof(message1, message2, descriptor_->oneof_decl(i));
+  }
+
   if (extensions_offset_ != -1) {
     MutableExtensionSet(message1)->Swap(MutableExtensionSet(message2));
   }
@@ -418,6 +488,8 @@ bool GeneratedMessageReflection::HasField(const Message& message,
 
   if (field->is_extension()) {
     return GetExtensionSet(message).Has(field->number());
+  } else if (field->containing_oneof() != NULL) {
+    return HasOneofField(message, field);
   } else {
     return HasBit(message, field);
   }
@@ -447,6 +519,10 @@ int GeneratedMessageReflection::FieldSize(const Message& message,
 #undef HANDLE_TYPE
 
       case FieldDescriptor::CPPTYPE_STRING:
+        if (IsStringPieceField(field)) {
+          return GetRaw<RepeatedStringPieceField>(message, field).size();
+        }
+        return GetRaw<RepeatedPtrFieldBase>(message, field).size();
       case FieldDescriptor::CPPTYPE_MESSAGE:
         return GetRaw<RepeatedPtrFieldBase>(message, field).size();
     }
@@ -462,6 +538,10 @@ void GeneratedMessageReflection::ClearField(
 
   if (field->is_extension()) {
     MutableExtensionSet(message)->ClearExtension(field->number());
+  } else if (field->containing_oneof() != NULL) {
+    if (HasOneofField(*message, field)) {
+      ClearOneof(message, field->containing_oneof());
+    }
   } else if (!field->is_repeated()) {
     if (HasBit(*message, field)) {
       ClearBit(message, field);
@@ -530,6 +610,9 @@ void GeneratedMessageReflection::ClearField(
 
       case FieldDescriptor::CPPTYPE_STRING: {
         switch (field->options().ctype()) {
+          case FieldOptions::STRING_PIECE:
+            MutableRaw<RepeatedStringPieceField>(message, field)->Clear();
+            break;
           default:  // TODO(kenton):  Support other string reps.
           case FieldOptions::STRING:
             MutableRaw<RepeatedPtrField<string> >(message, field)->Clear();
@@ -543,6 +626,7 @@ void GeneratedMessageReflection::ClearField(
         // so we use RepeatedPtrFieldBase directly.
         MutableRaw<RepeatedPtrFieldBase>(message, field)
             ->Clear<GenericTypeHandler<Message> >();
+        InvalidateMapIndex(message, field);
         break;
       }
     }
@@ -576,6 +660,9 @@ void GeneratedMessageReflection::RemoveLast(
 
       case FieldDescriptor::CPPTYPE_STRING:
         switch (field->options().ctype()) {
+          case FieldOptions::STRING_PIECE:
+            MutableRaw<RepeatedStringPieceField>(message, field)->RemoveLast();
+            break;
           default:  // TODO(kenton):  Support other string reps.
           case FieldOptions::STRING:
             MutableRaw<RepeatedPtrField<string> >(message, field)->RemoveLast();
@@ -586,6 +673,7 @@ void GeneratedMessageReflection::RemoveLast(
       case FieldDescriptor::CPPTYPE_MESSAGE:
         MutableRaw<RepeatedPtrFieldBase>(message, field)
             ->RemoveLast<GenericTypeHandler<Message> >();
+        InvalidateMapIndex(message, field);
         break;
     }
   }
@@ -621,8 +709,14 @@ void GeneratedMessageReflection::SwapElements(
 
       case FieldDescriptor::CPPTYPE_STRING:
       case FieldDescriptor::CPPTYPE_MESSAGE:
+        if (IsStringPieceField(field)) {
+          MutableRaw<RepeatedStringPieceField>(message, field)
+              ->SwapElements(index1, index2);
+          break;
+        }
         MutableRaw<RepeatedPtrFieldBase>(message, field)
             ->SwapElements(index1, index2);
+        InvalidateMapIndex(message, field);
         break;
     }
   }
@@ -652,6 +746,10 @@ void GeneratedMessageReflection::ListFields(
       if (FieldSize(message, field) > 0) {
         output->push_back(field);
       }
+    } else if (field->containing_oneof() != NULL) {
+      if (HasOneofField(message, field)) {
+        output->push_back(field);
+      }
     } else {
       if (HasBit(message, field)) {
         output->push_back(field);
@@ -678,6 +776,9 @@ void GeneratedMessageReflection::ListFields(
     if (field->is_extension()) {                                             \
       return GetExtensionSet(message).Get##TYPENAME(                         \
         field->number(), field->default_value_##PASSTYPE());                 \
+    } else if (field->containing_oneof() != NULL &&                          \
+               !HasOneofField(message, field)) {                             \
+      return field->default_value_##PASSTYPE();                              \
     } else {                                                                 \
       return GetField<TYPE>(message, field);                                 \
     }                                                                        \
@@ -749,6 +850,9 @@ string GeneratedMessageReflection::GetString(
   if (field->is_extension()) {
     return GetExtensionSet(message).GetString(field->number(),
                                               field->default_value_string());
+  } else if (field->containing_oneof() != NULL &&
+             !HasOneofField(message, field)) {
+    return field->default_value_string();
   } else {
     switch (field->options().ctype()) {
       default:  // TODO(kenton):  Support other string reps.
@@ -768,6 +872,9 @@ const string& GeneratedMessageReflection::GetStringReference(
   if (field->is_extension()) {
     return GetExtensionSet(message).GetString(field->number(),
                                               field->default_value_string());
+  } else if (field->containing_oneof() != NULL &&
+             !HasOneofField(message, field)) {
+    return field->default_value_string();
   } else {
     switch (field->options().ctype()) {
       default:  // TODO(kenton):  Support other string reps.
@@ -792,6 +899,15 @@ void GeneratedMessageReflection::SetString(
     switch (field->options().ctype()) {
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING: {
+        if (field->containing_oneof() != NULL) {
+          if (!HasOneofField(*message, field)) {
+            ClearOneof(message, field->containing_oneof());
+            SetOneofCase(message, field);
+            *MutableRaw<string*>(message, field) = new string;
+          }
+          (*MutableRaw<string*>(message, field))->assign(value);
+          break;
+        }
         string** ptr = MutableField<string*>(message, field);
         if (*ptr == DefaultRaw<const string*>(field)) {
           *ptr = new string(value);
@@ -812,6 +928,9 @@ string GeneratedMessageReflection::GetRepeatedString(
     return GetExtensionSet(message).GetRepeatedString(field->number(), index);
   } else {
     switch (field->options().ctype()) {
+      case FieldOptions::STRING_PIECE:
+        return GetRaw<RepeatedStringPieceField>(message, field)
+            .Get(index).ToString();
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING:
         return GetRepeatedPtrField<string>(message, field, index);
@@ -830,6 +949,10 @@ const string& GeneratedMessageReflection::GetRepeatedStringReference(
     return GetExtensionSet(message).GetRepeatedString(field->number(), index);
   } else {
     switch (field->options().ctype()) {
+      case FieldOptions::STRING_PIECE:
+        GetRaw<RepeatedStringPieceField>(message, field)
+            .Get(index).CopyToString(scratch);
+        return *scratch;
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING:
         return GetRepeatedPtrField<string>(message, field, index);
@@ -850,6 +973,10 @@ void GeneratedMessageReflection::SetRepeatedString(
       field->number(), index, value);
   } else {
     switch (field->options().ctype()) {
+      case FieldOptions::STRING_PIECE:
+        MutableRaw<RepeatedStringPieceField>(message, field)
+            ->Set(index, value.data(), value.size());
+        break;
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING:
         *MutableRepeatedField<string>(message, field, index) = value;
@@ -868,6 +995,10 @@ void GeneratedMessageReflection::AddString(
                                             field->type(), value, field);
   } else {
     switch (field->options().ctype()) {
+      case FieldOptions::STRING_PIECE:
+        MutableRaw<RepeatedStringPieceField>(message, field)
+            ->Add(value.data(), value.size());
+        break;
       default:  // TODO(kenton):  Support other string reps.
       case FieldOptions::STRING:
         *AddField<string>(message, field) = value;
@@ -887,6 +1018,9 @@ const EnumValueDescriptor* GeneratedMessageReflection::GetEnum(
   if (field->is_extension()) {
     value = GetExtensionSet(message).GetEnum(
       field->number(), field->default_value_enum()->number());
+  } else if (field->containing_oneof() != NULL &&
+             !HasOneofField(message, field)) {
+    value = field->default_value_enum()->number();
   } else {
     value = GetField<int>(message, field);
   }
@@ -968,6 +1102,11 @@ const Message& GeneratedMessageReflection::GetMessage(
         GetExtensionSet(message).GetMessage(
           field->number(), field->message_type(),
           factory == NULL ? message_factory_ : factory));
+  } else if (field->containing_oneof() != NULL) {
+    if (!HasOneofField(message, field)) {
+      return *GetMessagePrototype(field);
+    }
+    return *GetRaw<const Message*>(message, field);
   } else {
     const Message* result = GetRaw<const Message*>(message, field);
     if (result == NULL) {
@@ -986,6 +1125,14 @@ Message* GeneratedMessageReflection::MutableMessage(
     return static_cast<Message*>(
         MutableExtensionSet(message)->MutableMessage(field,
           factory == NULL ? message_factory_ : factory));
+  } else if (field->containing_oneof() != NULL) {
+    Message** result = MutableRaw<Message*>(message, field);
+    if (!HasOneofField(*message, field)) {
+      ClearOneof(message, field->containing_oneof());
+      SetOneofCase(message, field);
+      *result = GetMessagePrototype(field)->New();
+    }
+    return *result;
   } else {
     Message** result = MutableField<Message*>(message, field);
     if (*result == NULL) {
@@ -1018,6 +1165,8 @@ Message* GeneratedMessageReflection::MutableRepeatedMessage(
         MutableExtensionSet(message)->MutableRepeatedMessage(
           field->number(), index));
   } else {
+    // The caller may change the entry's key.
+    InvalidateMapIndex(message, field);
     return MutableRaw<RepeatedPtrFieldBase>(message, field)
         ->Mutable<GenericTypeHandler<Message> >(index);
   }
@@ -1034,6 +1183,8 @@ Message* GeneratedMessageReflection::AddMessage(
     return static_cast<Message*>(
         MutableExtensionSet(message)->AddMessage(field, factory));
   } else {
+    InvalidateMapIndex(message, field);
+
     // We can't use AddField<Message>() because RepeatedPtrFieldBase doesn't
     // know how to allocate one.
     RepeatedPtrFieldBase* repeated =
@@ -1120,6 +1271,11 @@ inline const Type& GeneratedMessageReflection::DefaultRaw(
   return *reinterpret_cast<const Type*>(ptr);
 }
 
+inline const Message* GeneratedMessageReflection::GetMessagePrototype(
+    const FieldDescriptor* field) const {
+  return message_factory_->GetPrototype(field->message_type());
+}
+
 inline const uint32* GeneratedMessageReflection::GetHasBits(
     const Message& message) const {
   const void* ptr = reinterpret_cast<const uint8*>(&message) + has_bits_offset_;
@@ -1162,6 +1318,100 @@ inline void GeneratedMessageReflection::ClearBit(
   MutableHasBits(message)[field->index() / 32] &= ~(1 << (field->index() % 32));
 }
 
+// Simple accessors for manipulating _oneof_case_.
+inline uint32 GeneratedMessageReflection::GetOneofCase(
+    const Message& message, const OneofDescriptor* oneof) const {
+  GOOGLE_DCHECK_NE(oneof_case_offset_, -1);
+  const void* ptr = reinterpret_cast<const uint8*>(&message) +
+                    oneof_case_offset_;
+  return reinterpret_cast<const uint32*>(ptr)[oneof->index()];
+}
+
+inline uint32* GeneratedMessageReflection::MutableOneofCase(
+    Message* message, const OneofDescriptor* oneof) const {
+  GOOGLE_DCHECK_NE(oneof_case_offset_, -1);
+  void* ptr = reinterpret_cast<uint8*>(message) + oneof_case_offset_;
+  return &reinterpret_cast<uint32*>(ptr)[oneof->index()];
+}
+
+inline bool GeneratedMessageReflection::HasOneofField(
+    const Message& message, const FieldDescriptor* field) const {
+  return GetOneofCase(message, field->containing_oneof()) ==
+         static_cast<uint32>(field->number());
+}
+
+inline void GeneratedMessageReflection::SetOneofCase(
+    Message* message, const FieldDescriptor* field) const {
+  *MutableOneofCase(message, field->containing_oneof()) = field->number();
+}
+
+void GeneratedMessageReflection::ClearOneof(
+    Message* message, const OneofDescriptor* oneof) const {
+  uint32 oneof_case = GetOneofCase(*message, oneof);
+  if (oneof_case == 0) return;
+
+  // Only strings and messages own memory that must be released; all other
+  // members can simply be abandoned.
+  const FieldDescriptor* field = descriptor_->FindFieldByNumber(oneof_case);
+  switch (field->cpp_type()) {
+    case FieldDescriptor::CPPTYPE_STRING:
+      switch (field->options().ctype()) {
+        default:  // TODO(kenton):  Support other string reps.
+        case FieldOptions::STRING:
+          delete *MutableRaw<string*>(message, field);
+          break;
+      }
+      break;
+
+    case FieldDescriptor::CPPTYPE_MESSAGE:
+      delete *MutableRaw<Message*>(message, field);
+      break;
+
+    default:
+      break;
+  }
+
+  *MutableOneofCase(message, oneof) = 0;
+}
+
+void GeneratedMessageReflection::SwapOneof(
+    Message* message1, Message* message2,
+    const OneofDescriptor* oneof) const {
+  // All members share one slot, so swapping as many bytes as the largest
+  // member occupies swaps whichever members are set, including owned
+  // pointers.
+  int slot_size = 0;
+  for (int i = 0; i < oneof->field_count(); i++) {
+    int size;
+    switch (oneof->field(i)->cpp_type()) {
+      case FieldDescriptor::CPPTYPE_INT32 : size = sizeof(int32 ); break;
+      case FieldDescriptor::CPPTYPE_INT64 : size = sizeof(int64 ); break;
+      case FieldDescriptor::CPPTYPE_UINT32: size = sizeof(uint32); break;
+      case FieldDescriptor::CPPTYPE_UINT64: size = sizeof(uint64); break;
+      case FieldDescriptor::CPPTYPE_DOUBLE: size = sizeof(double); break;
+      case FieldDescriptor::CPPTYPE_FLOAT : size = sizeof(float ); break;
+      case FieldDescriptor::CPPTYPE_BOOL  : size = sizeof(bool  ); break;
+      case FieldDescriptor::CPPTYPE_ENUM  : size = sizeof(int   ); break;
+      default:                              size = sizeof(void* ); break;
+    }
+    slot_size = max(slot_size, size);
+  }
+
+  const FieldDescriptor* first = oneof->field(0);
+  uint8* slot1 = MutableRaw<uint8>(message1, first);
+  uint8* slot2 = MutableRaw<uint8>(message2, first);
+  std::swap_ranges(slot1, slot1 + slot_size, slot2);
+  std::swap(*MutableOneofCase(message1, oneof),
+            *MutableOneofCase(message2, oneof));
+}
+
+inline void GeneratedMessageReflection::InvalidateMapIndex(
+    Message* message, const FieldDescriptor* field) const {
+  if (IsMapField(field)) {
+    MutableRaw<MapFieldBase>(message, field)->InvalidateIndex();
+  }
+}
+
 // Template implementations of basic accessors.  Inline because each
 // template instance is only called from one location.  These are
 // used for all types except messages.
@@ -1174,6 +1424,14 @@ inline const Type& GeneratedMessageReflection::GetField(
 template <typename Type>
 inline void GeneratedMessageReflection::SetField(
     Message* message, const FieldDescriptor* field, const Type& value) const {
+  if (field->containing_oneof() != NULL) {
+    if (!HasOneofField(*message, field)) {
+      ClearOneof(message, field->containing_oneof());
+      SetOneofCase(message, field);
+    }
+    *MutableRaw<Type>(message, field) = value;
+    return;
+  }
   *MutableRaw<Type>(message, field) = value;
   SetBit(message, field);
 }
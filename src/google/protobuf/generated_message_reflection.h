@@ -119,6 +119,12 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   //   factory:       MessageFactory to use to construct extension messages.
   //   object_size:   The size of a message object of this type, as measured
   //                  by sizeof().
+  //   oneof_case_offset:  Offset in the message of an array of uint32s of size
+  //                  descriptor->oneof_decl_count(), or -1 if the message type
+  //                  has no oneofs.  Element i holds the field number of the
+  //                  member of oneof i which is currently set, or zero if none
+  //                  is.  All members of a oneof share a single slot, so their
+  //                  entries in the offsets array must be identical.
   GeneratedMessageReflection(const Descriptor* descriptor,
                              const Message* default_instance,
                              const int offsets[],
@@ -127,7 +133,8 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
                              int extensions_offset,
                              const DescriptorPool* pool,
                              MessageFactory* factory,
-                             int object_size);
+                             int object_size,
+                             int oneof_case_offset = -1);
   ~GeneratedMessageReflection();
 
   // implements Reflection -------------------------------------------
@@ -281,6 +288,7 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   int unknown_fields_offset_;
   int extensions_offset_;
   int object_size_;
+  int oneof_case_offset_;
 
   const DescriptorPool* descriptor_pool_;
   MessageFactory* message_factory_;
@@ -307,6 +315,25 @@ class LIBPROTOBUF_EXPORT GeneratedMessageReflection : public Reflection {
   inline void ClearBit(Message* message,
                        const FieldDescriptor* field) const;
 
+  // Oneof members have no has-bit of their own; instead, the oneof records
+  // which of its members is set.  ClearOneof() frees the set member, if any.
+  inline uint32 GetOneofCase(const Message& message,
+                             const OneofDescriptor* oneof) const;
+  inline uint32* MutableOneofCase(Message* message,
+                                  const OneofDescriptor* oneof) const;
+  inline bool HasOneofField(const Message& message,
+                            const FieldDescriptor* field) const;
+  inline void SetOneofCase(Message* message,
+                           const FieldDescriptor* field) const;
+  void ClearOneof(Message* message, const OneofDescriptor* oneof) const;
+  void SwapOneof(Message* message1, Message* message2,
+                 const OneofDescriptor* oneof) const;
+
+  // Map fields index their entries, and must be told when reflection has
+  // changed them.  Does nothing for other fields.
+  inline void InvalidateMapIndex(Message* message,
+                                 const FieldDescriptor* field) const;
+
   template <typename Type>
   inline const Type& GetField(const Message& message,
                               const FieldDescriptor* field) const;
@@ -412,6 +439,24 @@ bool ParseNamedEnum(const EnumDescriptor* descriptor,
   return true;
 }
 
+// Returns true if the field is a map field stored in a MapField, in
+// generated and dynamic messages alike, rather than in a RepeatedPtrField:
+// a field declared as "map<K, V>", i.e. whose entry type has the map_entry
+// option, with an experimental_map_key naming a "key" field of an integer,
+// bool, enum or string type.
+LIBPROTOBUF_EXPORT bool IsMapField(const FieldDescriptor* field);
+
+// Returns true if the field is stored in a SlabRepeatedField, in generated
+// and dynamic messages alike, rather than in a RepeatedPtrField:  a repeated
+// message field with the contiguous option which is not a map field.
+LIBPROTOBUF_EXPORT bool IsSlabField(const FieldDescriptor* field);
+
+// Returns true if the field is stored in a RepeatedStringPieceField, in
+// generated and dynamic messages alike, rather than in a
+// RepeatedPtrField<string>:  a repeated string or bytes field with
+// ctype=STRING_PIECE which is not an extension.
+LIBPROTOBUF_EXPORT bool IsStringPieceField(const FieldDescriptor* field);
+
 // Just a wrapper around printing the name of a value. The main point of this
 // function is not to be inlined, so that you can do this without including
 // descriptor.h.
@@ -207,6 +207,72 @@ TEST(GeneratedMessageReflectionTest, SwapUnknown) {
   EXPECT_EQ(1, message2.unknown_fields().field_count());
 }
 
+TEST(GeneratedMessageReflectionTest, Oneof) {
+  unittest::TestOneof message;
+  const Descriptor* descriptor = message.GetDescriptor();
+  const Reflection* reflection = message.GetReflection();
+  const FieldDescriptor* foo_int = descriptor->FindFieldByName("foo_int");
+  const FieldDescriptor* foo_string =
+    descriptor->FindFieldByName("foo_string");
+  const FieldDescriptor* foo_message =
+    descriptor->FindFieldByName("foo_message");
+  const FieldDescriptor* bar_bool = descriptor->FindFieldByName("bar_bool");
+
+  // Unset members read as their defaults.
+  EXPECT_FALSE(reflection->HasField(message, foo_int));
+  EXPECT_EQ(0, reflection->GetInt32(message, foo_int));
+  EXPECT_EQ("abc", reflection->GetString(message, foo_string));
+  EXPECT_EQ(&unittest::TestAllTypes::default_instance(),
+            &reflection->GetMessage(message, foo_message));
+
+  reflection->SetInt32(&message, foo_int, 123);
+  EXPECT_TRUE(reflection->HasField(message, foo_int));
+  EXPECT_EQ(123, message.foo_int());
+
+  // Setting another member replaces the first.
+  reflection->SetString(&message, foo_string, "hello");
+  EXPECT_FALSE(reflection->HasField(message, foo_int));
+  EXPECT_EQ(0, reflection->GetInt32(message, foo_int));
+  EXPECT_EQ("hello", message.foo_string());
+
+  reflection->MutableMessage(&message, foo_message);
+  message.mutable_foo_message()->set_optional_int32(5);
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message.foo_case());
+  EXPECT_EQ("abc", reflection->GetString(message, foo_string));
+  EXPECT_EQ(5, message.foo_message().optional_int32());
+
+  reflection->SetBool(&message, bar_bool, true);
+  vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  ASSERT_EQ(2, fields.size());
+  EXPECT_EQ(foo_message, fields[0]);
+  EXPECT_EQ(bar_bool, fields[1]);
+
+  // Clearing an unset member leaves the set one alone.
+  reflection->ClearField(&message, foo_string);
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message.foo_case());
+  reflection->ClearField(&message, foo_message);
+  EXPECT_EQ(unittest::TestOneof::FOO_NOT_SET, message.foo_case());
+}
+
+TEST(GeneratedMessageReflectionTest, SwapOneof) {
+  unittest::TestOneof message1, message2;
+
+  message1.set_foo_string("hello");
+  message1.set_bar_bool(true);
+  message2.mutable_foo_message()->set_optional_int32(5);
+
+  const Reflection* reflection = message1.GetReflection();
+  reflection->Swap(&message1, &message2);
+
+  EXPECT_EQ(unittest::TestOneof::kFooMessage, message1.foo_case());
+  EXPECT_EQ(5, message1.foo_message().optional_int32());
+  EXPECT_EQ(unittest::TestOneof::BAR_NOT_SET, message1.bar_case());
+  EXPECT_EQ(unittest::TestOneof::kFooString, message2.foo_case());
+  EXPECT_EQ("hello", message2.foo_string());
+  EXPECT_TRUE(message2.bar_bool());
+}
+
 TEST(GeneratedMessageReflectionTest, RemoveLast) {
   unittest::TestAllTypes message;
   TestUtil::ReflectionTester reflection_tester(
@@ -45,6 +45,20 @@
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/stubs/stl_util-inl.h>
 
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+#include <google/protobuf/stubs/once.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#else
+#error "No suitable threading library available."
+#endif
+#endif  // GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
 
 namespace google {
 namespace protobuf {
@@ -55,9 +69,188 @@ namespace {
 static const int kMaxVarintBytes = 10;
 static const int kMaxVarint32Bytes = 5;
 
+// Every counter in CodedStreamCounters.
+uint64 CodedStreamCounters::* const kAllCounters[] = {
+  &CodedStreamCounters::varint32_fallbacks,
+  &CodedStreamCounters::varint32_slow_reads,
+  &CodedStreamCounters::varint64_fallbacks,
+  &CodedStreamCounters::varint64_slow_reads,
+  &CodedStreamCounters::little_endian_fallbacks,
+  &CodedStreamCounters::tag_fallbacks,
+  &CodedStreamCounters::tag_slow_reads,
+  &CodedStreamCounters::string_fallbacks,
+  &CodedStreamCounters::string_fallback_bytes,
+  &CodedStreamCounters::raw_bytes_read,
+  &CodedStreamCounters::limit_pushes,
+  &CodedStreamCounters::input_refreshes,
+  &CodedStreamCounters::input_bytes_refreshed,
+  &CodedStreamCounters::varint32_slow_writes,
+  &CodedStreamCounters::varint64_slow_writes,
+  &CodedStreamCounters::little_endian_slow_writes,
+  &CodedStreamCounters::raw_bytes_written,
+  &CodedStreamCounters::output_refreshes,
+  &CodedStreamCounters::output_bytes_refreshed,
+};
+
+GOOGLE_COMPILE_ASSERT(
+    sizeof(kAllCounters) / sizeof(kAllCounters[0]) ==
+        sizeof(CodedStreamCounters) / sizeof(uint64),
+    kAllCounters_must_list_every_counter);
+
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+
+// One thread's counters.  Only that thread writes to them.
+struct ThreadCounters {
+  CodedStreamCounters counters;
+  ThreadCounters* previous;
+  ThreadCounters* next;
+};
+
+// Guards live_counters and retired_counters.
+internal::Mutex* counters_mutex = NULL;
+// The counters of every thread which has counted anything and not exited.
+ThreadCounters* live_counters = NULL;
+// The totals of the threads which have exited.
+CodedStreamCounters* retired_counters = NULL;
+
+GOOGLE_PROTOBUF_DECLARE_ONCE(counters_once);
+
+#ifdef _WIN32
+
+// Windows has no destructors for thread-local slots, so the counters of a
+// thread which exits stay on live_counters.
+DWORD counters_slot;
+
+void InitCounters() {
+  counters_mutex = new internal::Mutex;
+  retired_counters = new CodedStreamCounters;
+  counters_slot = TlsAlloc();
+}
+
+inline ThreadCounters* GetThreadCounters() {
+  return reinterpret_cast<ThreadCounters*>(TlsGetValue(counters_slot));
+}
+
+inline void SetThreadCounters(ThreadCounters* counters) {
+  TlsSetValue(counters_slot, counters);
+}
+
+#else
+
+pthread_key_t counters_slot;
+
+// Called when a thread exits.
+void RetireThreadCounters(void* arg) {
+  ThreadCounters* counters = reinterpret_cast<ThreadCounters*>(arg);
+  {
+    internal::MutexLock lock(counters_mutex);
+    retired_counters->Add(counters->counters);
+    if (counters->previous != NULL) {
+      counters->previous->next = counters->next;
+    } else {
+      live_counters = counters->next;
+    }
+    if (counters->next != NULL) {
+      counters->next->previous = counters->previous;
+    }
+  }
+  delete counters;
+}
+
+void InitCounters() {
+  counters_mutex = new internal::Mutex;
+  retired_counters = new CodedStreamCounters;
+  pthread_key_create(&counters_slot, &RetireThreadCounters);
+}
+
+inline ThreadCounters* GetThreadCounters() {
+  return reinterpret_cast<ThreadCounters*>(pthread_getspecific(counters_slot));
+}
+
+inline void SetThreadCounters(ThreadCounters* counters) {
+  pthread_setspecific(counters_slot, counters);
+}
+
+#endif
+
+// Returns the current thread's counters, creating them if need be.
+CodedStreamCounters* CurrentCounters() {
+  GoogleOnceInit(&counters_once, &InitCounters);
+  ThreadCounters* counters = GetThreadCounters();
+  if (counters == NULL) {
+    counters = new ThreadCounters;
+    counters->previous = NULL;
+    {
+      internal::MutexLock lock(counters_mutex);
+      counters->next = live_counters;
+      if (live_counters != NULL) live_counters->previous = counters;
+      live_counters = counters;
+    }
+    SetThreadCounters(counters);
+  }
+  return &counters->counters;
+}
+
+#define COUNT(COUNTER, AMOUNT) (CurrentCounters()->COUNTER += (AMOUNT))
+
+#else  // GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+
+#define COUNT(COUNTER, AMOUNT)
+
+#endif  // !GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
 
 }  // namespace
 
+// CodedStreamCounters ===============================================
+
+CodedStreamCounters::CodedStreamCounters() {
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kAllCounters); i++) {
+    this->*kAllCounters[i] = 0;
+  }
+}
+
+bool CodedStreamCounters::Enabled() {
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+  return true;
+#else
+  return false;
+#endif
+}
+
+CodedStreamCounters CodedStreamCounters::Snapshot() {
+  CodedStreamCounters result;
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+  GoogleOnceInit(&counters_once, &InitCounters);
+  internal::MutexLock lock(counters_mutex);
+  result.Add(*retired_counters);
+  for (ThreadCounters* counters = live_counters; counters != NULL;
+       counters = counters->next) {
+    result.Add(counters->counters);
+  }
+#endif
+  return result;
+}
+
+CodedStreamCounters CodedStreamCounters::ThisThread() {
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+  return *CurrentCounters();
+#else
+  return CodedStreamCounters();
+#endif
+}
+
+void CodedStreamCounters::Add(const CodedStreamCounters& other) {
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kAllCounters); i++) {
+    this->*kAllCounters[i] += other.*kAllCounters[i];
+  }
+}
+
+void CodedStreamCounters::Subtract(const CodedStreamCounters& other) {
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kAllCounters); i++) {
+    this->*kAllCounters[i] -= other.*kAllCounters[i];
+  }
+}
+
 // CodedInputStream ==================================================
 
 
@@ -93,6 +286,7 @@ CodedInputStream::Limit CodedInputStream::PushLimit(int byte_limit) {
       (BufferSize() + buffer_size_after_limit_);
 
   Limit old_limit = current_limit_;
+  COUNT(limit_pushes, 1);
 
   // security: byte_limit is possibly evil, so check for negative values
   // and overflow.
@@ -197,6 +391,7 @@ bool CodedInputStream::GetDirectBufferPointer(const void** data, int* size) {
 }
 
 bool CodedInputStream::ReadRaw(void* buffer, int size) {
+  COUNT(raw_bytes_read, size);
   int current_buffer_size;
   while ((current_buffer_size = BufferSize()) < size) {
     // Reading past end of buffer.  Copy what we have, then refresh.
@@ -219,6 +414,8 @@ bool CodedInputStream::ReadString(string* buffer, int size) {
 }
 
 bool CodedInputStream::ReadStringFallback(string* buffer, int size) {
+  COUNT(string_fallbacks, 1);
+  COUNT(string_fallback_bytes, size);
   if (!buffer->empty()) {
     buffer->clear();
   }
@@ -246,6 +443,7 @@ bool CodedInputStream::ReadStringFallback(string* buffer, int size) {
 
 bool CodedInputStream::ReadLittleEndian32Fallback(uint32* value) {
   uint8 bytes[sizeof(*value)];
+  COUNT(little_endian_fallbacks, 1);
 
   const uint8* ptr;
   if (BufferSize() >= sizeof(*value)) {
@@ -263,6 +461,7 @@ bool CodedInputStream::ReadLittleEndian32Fallback(uint32* value) {
 
 bool CodedInputStream::ReadLittleEndian64Fallback(uint64* value) {
   uint8 bytes[sizeof(*value)];
+  COUNT(little_endian_fallbacks, 1);
 
   const uint8* ptr;
   if (BufferSize() >= sizeof(*value)) {
@@ -313,6 +512,7 @@ inline const uint8* ReadVarint32FromArray(const uint8* buffer, uint32* value) {
 }  // namespace
 
 bool CodedInputStream::ReadVarint32Slow(uint32* value) {
+  COUNT(varint32_slow_reads, 1);
   uint64 result;
   // Directly invoke ReadVarint64Fallback, since we already tried to optimize
   // for one-byte varints.
@@ -322,6 +522,7 @@ bool CodedInputStream::ReadVarint32Slow(uint32* value) {
 }
 
 bool CodedInputStream::ReadVarint32Fallback(uint32* value) {
+  COUNT(varint32_fallbacks, 1);
   if (BufferSize() >= kMaxVarintBytes ||
       // Optimization:  If the varint ends at exactly the end of the buffer,
       // we can detect that and still use the fast path.
@@ -339,6 +540,7 @@ bool CodedInputStream::ReadVarint32Fallback(uint32* value) {
 }
 
 uint32 CodedInputStream::ReadTagSlow() {
+  COUNT(tag_slow_reads, 1);
   if (buffer_ == buffer_end_) {
     // Call refresh.
     if (!Refresh()) {
@@ -365,6 +567,7 @@ uint32 CodedInputStream::ReadTagSlow() {
 }
 
 uint32 CodedInputStream::ReadTagFallback() {
+  COUNT(tag_fallbacks, 1);
   if (BufferSize() >= kMaxVarintBytes ||
       // Optimization:  If the varint ends at exactly the end of the buffer,
       // we can detect that and still use the fast path.
@@ -393,6 +596,7 @@ uint32 CodedInputStream::ReadTagFallback() {
 }
 
 bool CodedInputStream::ReadVarint64Slow(uint64* value) {
+  COUNT(varint64_slow_reads, 1);
   // Slow path:  This read might cross the end of the buffer, so we
   // need to check and refresh the buffer if and when it does.
 
@@ -416,6 +620,7 @@ bool CodedInputStream::ReadVarint64Slow(uint64* value) {
 }
 
 bool CodedInputStream::ReadVarint64Fallback(uint64* value) {
+  COUNT(varint64_fallbacks, 1);
   if (BufferSize() >= kMaxVarintBytes ||
       // Optimization:  If the varint ends at exactly the end of the buffer,
       // we can detect that and still use the fast path.
@@ -458,6 +663,7 @@ bool CodedInputStream::ReadVarint64Fallback(uint64* value) {
 
 bool CodedInputStream::Refresh() {
   GOOGLE_DCHECK_EQ(0, BufferSize());
+  COUNT(input_refreshes, 1);
 
   if (buffer_size_after_limit_ > 0 || overflow_bytes_ > 0 ||
       total_bytes_read_ == current_limit_) {
@@ -493,6 +699,7 @@ bool CodedInputStream::Refresh() {
     buffer_ = reinterpret_cast<const uint8*>(void_buffer);
     buffer_end_ = buffer_ + buffer_size;
     GOOGLE_CHECK_GE(buffer_size, 0);
+    COUNT(input_bytes_refreshed, buffer_size);
 
     if (total_bytes_read_ <= INT_MAX - buffer_size) {
       total_bytes_read_ += buffer_size;
@@ -564,6 +771,7 @@ bool CodedOutputStream::GetDirectBufferPointer(void** data, int* size) {
 }
 
 void CodedOutputStream::WriteRaw(const void* data, int size) {
+  COUNT(raw_bytes_written, size);
   while (buffer_size_ < size) {
     memcpy(buffer_, data, buffer_size_);
     size -= buffer_size_;
@@ -593,6 +801,7 @@ void CodedOutputStream::WriteLittleEndian32(uint32 value) {
   if (use_fast) {
     Advance(sizeof(value));
   } else {
+    COUNT(little_endian_slow_writes, 1);
     WriteRaw(bytes, sizeof(value));
   }
 }
@@ -608,6 +817,7 @@ void CodedOutputStream::WriteLittleEndian64(uint64 value) {
   if (use_fast) {
     Advance(sizeof(value));
   } else {
+    COUNT(little_endian_slow_writes, 1);
     WriteRaw(bytes, sizeof(value));
   }
 }
@@ -653,6 +863,7 @@ void CodedOutputStream::WriteVarint32(uint32 value) {
   } else {
     // Slow path:  This write might cross the end of the buffer, so we
     // compose the bytes first then use WriteRaw().
+    COUNT(varint32_slow_writes, 1);
     uint8 bytes[kMaxVarint32Bytes];
     int size = 0;
     while (value > 0x7F) {
@@ -753,6 +964,7 @@ void CodedOutputStream::WriteVarint64(uint64 value) {
   } else {
     // Slow path:  This write might cross the end of the buffer, so we
     // compose the bytes first then use WriteRaw().
+    COUNT(varint64_slow_writes, 1);
     uint8 bytes[kMaxVarintBytes];
     int size = 0;
     while (value > 0x7F) {
@@ -770,8 +982,10 @@ uint8* CodedOutputStream::WriteVarint64ToArray(
 }
 
 bool CodedOutputStream::Refresh() {
+  COUNT(output_refreshes, 1);
   void* void_buffer;
   if (output_->Next(&void_buffer, &buffer_size_)) {
+    COUNT(output_bytes_refreshed, buffer_size_);
     buffer_ = reinterpret_cast<uint8*>(void_buffer);
     total_bytes_ += buffer_size_;
     return true;
@@ -825,6 +1039,8 @@ int CodedOutputStream::VarintSize64(uint64 value) {
   }
 }
 
+#undef COUNT
+
 }  // namespace io
 }  // namespace protobuf
 }  // namespace google
@@ -300,6 +300,9 @@ class LIBPROTOBUF_EXPORT CodedInputStream {
   // stack is hit, or -1 if no limits are in place.
   int BytesUntilLimit();
 
+  // Returns the number of bytes read since the stream was constructed.
+  int CurrentPosition() const;
+
   // Total Bytes Limit -----------------------------------------------
   // To prevent malicious users from sending excessively large messages
   // and causing integer overflows or memory exhaustion, CodedInputStream
@@ -707,6 +710,63 @@ class LIBPROTOBUF_EXPORT CodedOutputStream {
   static int VarintSize32Fallback(uint32 value);
 };
 
+// Counts how often CodedInputStream and CodedOutputStream leave their fast
+// paths, and how many bytes they move.  The counters are only kept if the
+// library is compiled with GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS defined,
+// e.g. by configuring with CXXFLAGS=-DGOOGLE_PROTOBUF_CODED_STREAM_COUNTERS.
+// Otherwise they are always zero and the streams pay nothing for them.  The
+// layout of the streams is the same either way, so code which uses the
+// library need not be compiled with the same setting.
+//
+// Each thread counts into its own set of counters, without locking.
+// Snapshot() adds them up.  To measure some piece of work, take a snapshot
+// before and after it and Subtract() the first from the second.
+struct LIBPROTOBUF_EXPORT CodedStreamCounters {
+  CodedStreamCounters();
+
+  // Returns true if the library was compiled with the counters.
+  static bool Enabled();
+
+  // Returns the totals over all threads, including ones which have exited.
+  // The most recent counts made by other threads may be missing.
+  static CodedStreamCounters Snapshot();
+
+  // Returns the counts made by the calling thread only.
+  static CodedStreamCounters ThisThread();
+
+  // Adds or subtracts each of other's counters to or from this one's.
+  void Add(const CodedStreamCounters& other);
+  void Subtract(const CodedStreamCounters& other);
+
+  // CodedInputStream.  Each "fallback" counts the reads which the inline
+  // code in this header could not handle; each "slow" read is a fallback
+  // which also had to cross the end of the buffer.  A slow read may in turn
+  // count as another kind of fallback.
+  uint64 varint32_fallbacks;           // ReadVarint32Fallback()
+  uint64 varint32_slow_reads;          // ReadVarint32Slow()
+  uint64 varint64_fallbacks;           // ReadVarint64Fallback()
+  uint64 varint64_slow_reads;          // ReadVarint64Slow()
+  uint64 little_endian_fallbacks;      // ReadLittleEndian{32,64}Fallback()
+  uint64 tag_fallbacks;                // ReadTagFallback()
+  uint64 tag_slow_reads;               // ReadTagSlow()
+  uint64 string_fallbacks;             // ReadStringFallback()
+  uint64 string_fallback_bytes;        //   and the bytes it was asked for
+  uint64 raw_bytes_read;               // Bytes asked of ReadRaw()
+  uint64 limit_pushes;                 // PushLimit()
+  uint64 input_refreshes;              // Refresh()
+  uint64 input_bytes_refreshed;        //   and the bytes it got
+
+  // CodedOutputStream.  A slow write is one which had to compose its bytes
+  // elsewhere and copy them with WriteRaw(), because the buffer was nearly
+  // full.
+  uint64 varint32_slow_writes;         // WriteVarint32()
+  uint64 varint64_slow_writes;         // WriteVarint64()
+  uint64 little_endian_slow_writes;    // WriteLittleEndian{32,64}()
+  uint64 raw_bytes_written;            // Bytes given to WriteRaw()
+  uint64 output_refreshes;             // Refresh()
+  uint64 output_bytes_refreshed;       //   and the bytes it got
+};
+
 // inline methods ====================================================
 // The vast majority of varints are only one byte.  These inline
 // methods optimize for that case.
@@ -1035,6 +1095,10 @@ inline uint32 CodedInputStream::BufferSize() const {
   return buffer_end_ - buffer_;
 }
 
+inline int CodedInputStream::CurrentPosition() const {
+  return total_bytes_read_ - (BufferSize() + buffer_size_after_limit_);
+}
+
 inline CodedInputStream::CodedInputStream(ZeroCopyInputStream* input)
   : input_(input),
     buffer_(NULL),
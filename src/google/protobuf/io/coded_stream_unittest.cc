@@ -1094,6 +1094,75 @@ TEST_F(CodedStreamTest, InputOver2G) {
   EXPECT_EQ(0, errors.size());
 }
 
+// -------------------------------------------------------------------
+// Counters
+
+TEST_F(CodedStreamTest, Counters) {
+  // Uses three-byte buffers, so that each value crosses the end of one.
+  CodedStreamCounters before = CodedStreamCounters::ThisThread();
+  int size;
+  {
+    ArrayOutputStream output(buffer_, sizeof(buffer_), 3);
+    CodedOutputStream coded_output(&output);
+    coded_output.WriteVarint32(300);
+    coded_output.WriteLittleEndian32(1234);
+    coded_output.WriteString("hello");
+    size = coded_output.ByteCount();
+  }
+  EXPECT_EQ(11, size);
+  {
+    ArrayInputStream input(buffer_, size, 3);
+    CodedInputStream coded_input(&input);
+    CodedInputStream::Limit limit = coded_input.PushLimit(size);
+    uint32 value;
+    EXPECT_TRUE(coded_input.ReadVarint32(&value));
+    EXPECT_EQ(300, value);
+    EXPECT_TRUE(coded_input.ReadLittleEndian32(&value));
+    EXPECT_EQ(1234, value);
+    string str;
+    EXPECT_TRUE(coded_input.ReadString(&str, 5));
+    EXPECT_EQ("hello", str);
+    coded_input.PopLimit(limit);
+  }
+  CodedStreamCounters counters = CodedStreamCounters::ThisThread();
+  counters.Subtract(before);
+
+#ifdef GOOGLE_PROTOBUF_CODED_STREAM_COUNTERS
+  // protobuf-coded-stream-counters-test must link its own coded_stream.cc
+  // rather than the library's.
+  ASSERT_TRUE(CodedStreamCounters::Enabled());
+#endif
+  if (!CodedStreamCounters::Enabled()) {
+    EXPECT_EQ(0, counters.limit_pushes);
+    EXPECT_EQ(0, counters.input_refreshes);
+    EXPECT_EQ(0, counters.raw_bytes_written);
+    EXPECT_EQ(0, CodedStreamCounters::Snapshot().output_refreshes);
+    return;
+  }
+
+  EXPECT_EQ(1, counters.varint32_fallbacks);
+  EXPECT_EQ(1, counters.varint32_slow_reads);
+  EXPECT_EQ(1, counters.little_endian_fallbacks);
+  EXPECT_EQ(1, counters.string_fallbacks);
+  EXPECT_EQ(5, counters.string_fallback_bytes);
+  EXPECT_EQ(4, counters.raw_bytes_read);
+  EXPECT_EQ(1, counters.limit_pushes);
+  EXPECT_EQ(size, counters.input_bytes_refreshed);
+  EXPECT_EQ(0, counters.tag_fallbacks);
+
+  EXPECT_EQ(1, counters.varint32_slow_writes);
+  EXPECT_EQ(0, counters.varint64_slow_writes);
+  EXPECT_EQ(1, counters.little_endian_slow_writes);
+  EXPECT_EQ(2 + 4 + 5, counters.raw_bytes_written);
+  EXPECT_EQ(4, counters.output_refreshes);
+  EXPECT_EQ(12, counters.output_bytes_refreshed);
+
+  // This thread's counts are part of the totals.
+  CodedStreamCounters totals = CodedStreamCounters::Snapshot();
+  EXPECT_GE(totals.limit_pushes, counters.limit_pushes);
+  EXPECT_GE(totals.output_bytes_refreshed, counters.output_bytes_refreshed);
+}
+
 // ===================================================================
 
 
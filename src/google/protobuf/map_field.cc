@@ -0,0 +1,78 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/map_field.h>
+
+#include <algorithm>
+
+namespace google {
+namespace protobuf {
+namespace internal {
+
+MapFieldBase::MapFieldBase()
+  : index_(NULL),
+    index_capacity_(0),
+    index_size_(0),
+    indexed_entries_(0),
+    index_valid_(true) {}
+
+MapFieldBase::~MapFieldBase() {
+  delete [] index_;
+}
+
+void MapFieldBase::ResetIndex(int min_size) {
+  // Start at a quarter full, so that the table can double in size before
+  // it must be rebuilt.
+  int capacity = 0;
+  if (min_size > 0) {
+    capacity = 8;
+    while (capacity < min_size * 4) capacity *= 2;
+  }
+  if (capacity > index_capacity_) {
+    delete [] index_;
+    index_ = new int[capacity];
+    index_capacity_ = capacity;
+  }
+  std::fill(index_, index_ + index_capacity_, -1);
+  index_size_ = 0;
+  indexed_entries_ = 0;
+}
+
+void MapFieldBase::SwapIndex(MapFieldBase* other) {
+  std::swap(index_, other->index_);
+  std::swap(index_capacity_, other->index_capacity_);
+  std::swap(index_size_, other->index_size_);
+  std::swap(indexed_entries_, other->indexed_entries_);
+  std::swap(index_valid_, other->index_valid_);
+}
+
+}  // namespace internal
+}  // namespace protobuf
+}  // namespace google
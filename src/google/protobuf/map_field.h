@@ -0,0 +1,406 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// MapField is the storage generated code uses for map fields, e.g.:
+//   map<string, int32> counts = 1;
+//
+// On the wire, and to reflection, a map field is a repeated field of entry
+// messages, each with a "key" field (number 1) and a "value" field (number
+// 2).  The parser lowers the map syntax to exactly that:
+//   message CountsEntry {
+//     optional string key = 1;
+//     optional int32 value = 2;
+//   }
+//   repeated CountsEntry counts = 1 [experimental_map_key = "key"];
+// and marks CountsEntry with the map_entry message option.  Only fields
+// declared with the map syntax are stored in a MapField; a hand-written
+// repeated field with experimental_map_key, even one named "key", stays an
+// ordinary repeated field.  See internal::IsMapField().
+//
+// MapField keeps the entries in a RepeatedPtrField, in the order they were
+// added, plus a hash index of their positions by key, so that lookups take
+// constant time.  Parsing adds each entry to the index as it is read, so no
+// separate pass is needed to build it.  The index holds positions, not
+// copies of the keys, so it costs one int per slot.
+//
+// A key appears at most once: if the same key is parsed, merged or
+// inserted again, the later entry replaces the earlier one, as for any map.
+// Reflection can still add a second entry with a key which is already
+// present.  Lookups then find the later entry, and the earlier one stays in
+// entries() until the next call to a non-const method of the MapField,
+// which removes it.
+//
+// Lookups may rebuild the index if the entries were changed through
+// reflection, so like other const methods of messages they are not safe to
+// call from several threads at once unless the map has been looked up since
+// it last changed.  They never change the entries themselves.
+
+#ifndef GOOGLE_PROTOBUF_MAP_FIELD_H__
+#define GOOGLE_PROTOBUF_MAP_FIELD_H__
+
+#include <string>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/repeated_field.h>
+
+namespace google {
+namespace protobuf {
+
+namespace internal {
+
+// The part of MapField which does not depend on the key and entry types.
+// Reflection and DynamicMessage see map fields as this, and through it as
+// a repeated message field.
+class LIBPROTOBUF_EXPORT MapFieldBase {
+ public:
+  MapFieldBase();
+  ~MapFieldBase();
+
+  // Called by reflection after it has changed the entries, which makes the
+  // index be rebuilt the next time it is needed.
+  void InvalidateIndex() { index_valid_ = false; }
+
+ protected:
+  // Must be first:  reflection finds the repeated field at the offset of
+  // the map field.  The entries are of the generated entry type; see
+  // MapField::entries().
+  RepeatedPtrField<MessageLite> entries_;
+
+  // Open-addressed hash table of positions in entries_, with -1 marking
+  // empty slots.  index_capacity_ is zero or a power of two, and at most
+  // half the slots are used.  index_size_ is the number of keys in the
+  // index, and indexed_entries_ the number of entries it was built from;
+  // they differ if reflection has added entries with duplicate keys.
+  int* index_;
+  int index_capacity_;
+  int index_size_;
+  int indexed_entries_;
+  bool index_valid_;
+
+  // Makes the table empty, with room for at least the given number of
+  // entries before it must grow.  Keeps the current table if it is big
+  // enough.
+  void ResetIndex(int min_size);
+  void SwapIndex(MapFieldBase* other);
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MapFieldBase);
+};
+
+// Hash functions for the types map keys may have.
+inline size_t HashMapKey(uint64 key) {
+  key *= GOOGLE_ULONGLONG(0x9e3779b97f4a7c15);
+  return static_cast<size_t>(key ^ (key >> 32));
+}
+inline size_t HashMapKey(int64 key) {
+  return HashMapKey(static_cast<uint64>(key));
+}
+inline size_t HashMapKey(uint32 key) {
+  return HashMapKey(static_cast<uint64>(key));
+}
+inline size_t HashMapKey(int32 key) {
+  return HashMapKey(static_cast<uint64>(static_cast<uint32>(key)));
+}
+inline size_t HashMapKey(bool key) {
+  return HashMapKey(static_cast<uint64>(key));
+}
+inline size_t HashMapKey(const string& key) {
+  size_t result = 0;
+  for (int i = 0; i < key.size(); i++) {
+    result = 5 * result + static_cast<unsigned char>(key[i]);
+  }
+  return HashMapKey(static_cast<uint64>(result));
+}
+
+}  // namespace internal
+
+// Key is the C++ type of the key field (e.g. int32 or string) and Entry
+// the generated entry message type.
+template <typename Key, typename Entry>
+class MapField : public internal::MapFieldBase {
+ public:
+  typedef typename RepeatedPtrField<Entry>::const_iterator const_iterator;
+
+  MapField() {}
+  ~MapField() {}
+
+  int size() const { return entries().size(); }
+  bool empty() const { return size() == 0; }
+
+  // Returns the entry with the given key, or NULL if there is none.  Does
+  // not change the entries, even if some of them have the same key.
+  const Entry* Find(const Key& key) const;
+  bool Contains(const Key& key) const { return Find(key) != NULL; }
+
+  // Returns the entry with the given key, adding one if there is none.
+  // The entry's key must not be changed.
+  Entry* Mutable(const Key& key);
+
+  // Removes the entry with the given key, returning false if there is
+  // none.  The last entry takes the place of the one removed.
+  bool Erase(const Key& key);
+
+  void Clear();
+  void MergeFrom(const MapField& other);
+  void Swap(MapField* other);
+
+  // The entries, in no particular order.
+  const RepeatedPtrField<Entry>& entries() const {
+    return *reinterpret_cast<const RepeatedPtrField<Entry>*>(&entries_);
+  }
+  const_iterator begin() const { return entries().begin(); }
+  const_iterator end() const { return entries().end(); }
+
+  int SpaceUsedExcludingSelf() const {
+    return entries().SpaceUsedExcludingSelf() +
+           index_capacity_ * sizeof(index_[0]);
+  }
+
+  // Used by generated parsing code:  AddEntry() returns a new entry to
+  // parse into, and IndexLastEntry() adds it to the index once parsed,
+  // replacing any earlier entry with the same key.
+  Entry* AddEntry() { return mutable_entries()->Add(); }
+  void IndexLastEntry();
+
+ private:
+  RepeatedPtrField<Entry>* mutable_entries() {
+    return reinterpret_cast<RepeatedPtrField<Entry>*>(&entries_);
+  }
+
+  // Returns the slot holding the key's position, or the empty slot where
+  // it would go.  The index must have room.
+  int FindSlot(const Key& key) const;
+  // Rebuilds the index if it is out of date.  For each key, the index holds
+  // the position of the last entry with that key.
+  void EnsureIndex() const;
+  void BuildIndex();
+  // Brings the index up to date and removes entries whose keys appear again
+  // later, so that each key appears once.  Used by the non-const methods.
+  void EnsureUnique();
+  // Rebuilds the index, dropping all but the last entry for each key.
+  void RebuildIndex();
+  // Adds the last entry, whose key is not already present.
+  void InsertLast();
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MapField);
+};
+
+// implementation ====================================================
+
+template <typename Key, typename Entry>
+int MapField<Key, Entry>::FindSlot(const Key& key) const {
+  int mask = index_capacity_ - 1;
+  int slot = internal::HashMapKey(key) & mask;
+  while (index_[slot] != -1 && entries().Get(index_[slot]).key() != key) {
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+template <typename Key, typename Entry>
+inline void MapField<Key, Entry>::EnsureIndex() const {
+  // Entries added or removed through the repeated view show up as a
+  // change in size; other changes must call InvalidateIndex().
+  if (!index_valid_ || indexed_entries_ != size()) {
+    const_cast<MapField*>(this)->BuildIndex();
+  }
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::BuildIndex() {
+  int n = size();
+  ResetIndex(n);
+  for (int i = 0; i < n; i++) {
+    int slot = FindSlot(entries().Get(i).key());
+    if (index_[slot] == -1) ++index_size_;
+    // A later entry for the same key hides the earlier one.
+    index_[slot] = i;
+  }
+  indexed_entries_ = n;
+  index_valid_ = true;
+}
+
+template <typename Key, typename Entry>
+inline void MapField<Key, Entry>::EnsureUnique() {
+  EnsureIndex();
+  if (index_size_ != indexed_entries_) RebuildIndex();
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::RebuildIndex() {
+  RepeatedPtrField<Entry>* entries = mutable_entries();
+  int n = entries->size();
+  ResetIndex(n);
+
+  // Move the entries to keep to the front, in order, and the replaced ones
+  // to the back.
+  int kept = 0;
+  for (int i = 0; i < n; i++) {
+    int slot = FindSlot(entries->Get(i).key());
+    if (index_[slot] != -1) {
+      // A later entry for the same key replaces the earlier one in place.
+      entries->SwapElements(index_[slot], i);
+    } else {
+      entries->SwapElements(kept, i);
+      index_[slot] = kept++;
+    }
+  }
+  while (entries->size() > kept) {
+    entries->RemoveLast();
+  }
+  index_size_ = kept;
+  indexed_entries_ = kept;
+  index_valid_ = true;
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::InsertLast() {
+  if ((index_size_ + 1) * 2 > index_capacity_) {
+    RebuildIndex();
+    return;
+  }
+  int last = size() - 1;
+  index_[FindSlot(entries().Get(last).key())] = last;
+  ++index_size_;
+  ++indexed_entries_;
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::IndexLastEntry() {
+  // If the index is out of date, it will be rebuilt when next needed.
+  if (!index_valid_ || index_size_ != indexed_entries_ ||
+      indexed_entries_ != size() - 1) {
+    return;
+  }
+  if (index_capacity_ == 0) {
+    RebuildIndex();
+    return;
+  }
+
+  RepeatedPtrField<Entry>* entries = mutable_entries();
+  int last = entries->size() - 1;
+  int slot = FindSlot(entries->Get(last).key());
+  if (index_[slot] != -1) {
+    entries->SwapElements(index_[slot], last);
+    entries->RemoveLast();
+  } else {
+    InsertLast();
+  }
+}
+
+template <typename Key, typename Entry>
+const Entry* MapField<Key, Entry>::Find(const Key& key) const {
+  EnsureIndex();
+  if (index_capacity_ == 0) return NULL;
+  int position = index_[FindSlot(key)];
+  return position == -1 ? NULL : &entries().Get(position);
+}
+
+template <typename Key, typename Entry>
+Entry* MapField<Key, Entry>::Mutable(const Key& key) {
+  EnsureUnique();
+  if (index_capacity_ != 0) {
+    int position = index_[FindSlot(key)];
+    if (position != -1) return mutable_entries()->Mutable(position);
+  }
+  Entry* entry = mutable_entries()->Add();
+  entry->set_key(key);
+  InsertLast();
+  return entry;
+}
+
+template <typename Key, typename Entry>
+bool MapField<Key, Entry>::Erase(const Key& key) {
+  EnsureUnique();
+  if (index_capacity_ == 0) return false;
+  int slot = FindSlot(key);
+  int position = index_[slot];
+  if (position == -1) return false;
+
+  // Move the last entry into the hole.
+  RepeatedPtrField<Entry>* entries = mutable_entries();
+  int last = entries->size() - 1;
+  if (position != last) {
+    index_[FindSlot(entries->Get(last).key())] = position;
+    entries->SwapElements(position, last);
+  }
+  entries->RemoveLast();
+  --index_size_;
+  --indexed_entries_;
+
+  // Empty the slot, shifting back later slots in the same run which would
+  // otherwise no longer be reachable (linear probing deletion).
+  int mask = index_capacity_ - 1;
+  int next = slot;
+  while (true) {
+    next = (next + 1) & mask;
+    if (index_[next] == -1) break;
+    int home = internal::HashMapKey(entries->Get(index_[next]).key()) & mask;
+    // Move the entry back unless its home slot lies cyclically in
+    // (slot, next].
+    bool reachable = slot <= next ? (slot < home && home <= next)
+                                  : (slot < home || home <= next);
+    if (!reachable) {
+      index_[slot] = index_[next];
+      slot = next;
+    }
+  }
+  index_[slot] = -1;
+  return true;
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::Clear() {
+  mutable_entries()->Clear();
+  if (index_size_ != 0 || !index_valid_) ResetIndex(0);
+  index_size_ = 0;
+  indexed_entries_ = 0;
+  index_valid_ = true;
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::MergeFrom(const MapField& other) {
+  GOOGLE_CHECK_NE(&other, this);
+  for (int i = 0; i < other.size(); i++) {
+    const Entry& entry = other.entries().Get(i);
+    Mutable(entry.key())->CopyFrom(entry);
+  }
+}
+
+template <typename Key, typename Entry>
+void MapField<Key, Entry>::Swap(MapField* other) {
+  mutable_entries()->Swap(other->mutable_entries());
+  SwapIndex(other);
+}
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_MAP_FIELD_H__
@@ -0,0 +1,331 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/map_field.h>
+
+#include <map>
+#include <string>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/unittest_map.pb.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+using protobuf_unittest::TestMap;
+using protobuf_unittest::TestMapHandWritten;
+using protobuf_unittest::TestMapNamedKey;
+using protobuf_unittest::TestMap_Int32ToInt32Entry;
+using protobuf_unittest::TestMap_StringToStringEntry;
+using protobuf_unittest::TestMap_Uint64ToMessageEntry;
+
+TEST(MapFieldTest, Int32Keys) {
+  TestMap message;
+  MapField<int32, TestMap_Int32ToInt32Entry>* map =
+      message.mutable_int32_to_int32();
+  EXPECT_TRUE(map->empty());
+  EXPECT_TRUE(map->Find(1) == NULL);
+  EXPECT_FALSE(map->Erase(1));
+
+  map->Mutable(1)->set_value(10);
+  map->Mutable(-2)->set_value(20);
+  map->Mutable(1)->set_value(11);
+  EXPECT_EQ(2, map->size());
+  EXPECT_EQ(2, message.int32_to_int32_size());
+
+  ASSERT_TRUE(map->Find(1) != NULL);
+  EXPECT_EQ(1, map->Find(1)->key());
+  EXPECT_EQ(11, map->Find(1)->value());
+  EXPECT_EQ(20, map->Find(-2)->value());
+  EXPECT_FALSE(map->Contains(3));
+
+  EXPECT_TRUE(map->Erase(1));
+  EXPECT_FALSE(map->Contains(1));
+  EXPECT_EQ(1, map->size());
+  EXPECT_EQ(-2, message.int32_to_int32(0).key());
+
+  message.clear_int32_to_int32();
+  EXPECT_EQ(0, map->size());
+  EXPECT_FALSE(map->Contains(-2));
+}
+
+TEST(MapFieldTest, OtherKeyTypes) {
+  TestMap message;
+  message.mutable_string_to_string()->Mutable("foo")->set_value("bar");
+  message.mutable_string_to_string()->Mutable("")->set_value("empty");
+  message.mutable_uint64_to_message()->Mutable(kuint64max)
+      ->mutable_value()->set_a(5);
+  message.mutable_enum_to_bool()->Mutable(protobuf_unittest::MAP_ENUM_BAR)
+      ->set_value(true);
+  message.mutable_bool_to_enum()->Mutable(false)
+      ->set_value(protobuf_unittest::MAP_ENUM_BAZ);
+
+  EXPECT_EQ("bar", message.string_to_string().Find("foo")->value());
+  EXPECT_EQ("empty", message.string_to_string().Find("")->value());
+  EXPECT_TRUE(message.string_to_string().Find("baz") == NULL);
+  EXPECT_EQ(5, message.uint64_to_message().Find(kuint64max)->value().a());
+  EXPECT_TRUE(message.enum_to_bool().Find(protobuf_unittest::MAP_ENUM_BAR)
+                  ->value());
+  EXPECT_FALSE(message.enum_to_bool().Contains(
+      protobuf_unittest::MAP_ENUM_FOO));
+  EXPECT_EQ(protobuf_unittest::MAP_ENUM_BAZ,
+            message.bool_to_enum().Find(false)->value());
+  EXPECT_FALSE(message.bool_to_enum().Contains(true));
+}
+
+TEST(MapFieldTest, MatchesStdMap) {
+  // Random inserts and erases, with few enough keys that the same ones
+  // come up often, and enough operations that the index grows.
+  TestMap message;
+  MapField<int32, TestMap_Int32ToInt32Entry>* map =
+      message.mutable_int32_to_int32();
+  std::map<int32, int32> expected;
+
+  uint32 seed = 12345;
+  for (int i = 0; i < 20000; i++) {
+    seed = seed * 1103515245 + 12345;
+    int32 key = (seed >> 8) % 1000;
+    if ((seed >> 4) % 3 == 0) {
+      EXPECT_EQ(expected.erase(key) != 0, map->Erase(key));
+    } else {
+      map->Mutable(key)->set_value(i);
+      expected[key] = i;
+    }
+
+    if (i % 1000 == 0) {
+      ASSERT_EQ(expected.size(), map->size());
+      for (int32 j = 0; j < 1000; j++) {
+        const TestMap_Int32ToInt32Entry* entry = map->Find(j);
+        std::map<int32, int32>::const_iterator iter = expected.find(j);
+        if (iter == expected.end()) {
+          EXPECT_TRUE(entry == NULL) << j;
+        } else {
+          ASSERT_TRUE(entry != NULL) << j;
+          EXPECT_EQ(iter->second, entry->value());
+        }
+      }
+    }
+  }
+}
+
+TEST(MapFieldTest, ParseReplacesDuplicateKeys) {
+  TestMap message1, message2;
+  for (int i = 0; i < 100; i++) {
+    message1.mutable_int32_to_int32()->Mutable(i)->set_value(i);
+  }
+  for (int i = 50; i < 150; i++) {
+    message2.mutable_int32_to_int32()->Mutable(i)->set_value(-i);
+  }
+  message1.mutable_string_to_string()->Mutable("a")->set_value("1");
+  message2.mutable_string_to_string()->Mutable("a")->set_value("2");
+
+  // Concatenating the encodings gives one message with both sets of
+  // entries; the later value for each key replaces the earlier one.
+  TestMap parsed;
+  ASSERT_TRUE(parsed.ParseFromString(message1.SerializeAsString() +
+                                     message2.SerializeAsString()));
+  EXPECT_EQ(150, parsed.int32_to_int32_size());
+  for (int i = 0; i < 150; i++) {
+    ASSERT_TRUE(parsed.int32_to_int32().Find(i) != NULL) << i;
+    EXPECT_EQ(i < 50 ? i : -i, parsed.int32_to_int32().Find(i)->value());
+  }
+  EXPECT_EQ(1, parsed.string_to_string_size());
+  EXPECT_EQ("2", parsed.string_to_string().Find("a")->value());
+
+  // Entries keep their first position.
+  EXPECT_EQ(0, parsed.int32_to_int32(0).key());
+  EXPECT_EQ(50, parsed.int32_to_int32(50).key());
+  EXPECT_EQ(-50, parsed.int32_to_int32(50).value());
+}
+
+TEST(MapFieldTest, SerializeAndParse) {
+  TestMap message;
+  message.mutable_int32_to_int32()->Mutable(3)->set_value(4);
+  message.mutable_string_to_string()->Mutable("x")->set_value("y");
+  message.mutable_uint64_to_message()->Mutable(7)->mutable_value()
+      ->add_b("z");
+
+  string data = message.SerializeAsString();
+  EXPECT_EQ(message.ByteSize(), data.size());
+
+  TestMap parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(4, parsed.int32_to_int32().Find(3)->value());
+  EXPECT_EQ("y", parsed.string_to_string().Find("x")->value());
+  EXPECT_EQ("z", parsed.uint64_to_message().Find(7)->value().b(0));
+  EXPECT_EQ(data, parsed.SerializeAsString());
+
+  // On the wire, the map is a repeated field of entries.
+  TestMap small;
+  small.mutable_string_to_string()->Mutable("x")->set_value("y");
+  EXPECT_EQ(string("\x12\x06\x0a\x01x\x12\x01y", 8),
+            small.SerializeAsString());
+}
+
+TEST(MapFieldTest, MergeSwapAndCopy) {
+  TestMap message1, message2;
+  message1.mutable_int32_to_int32()->Mutable(1)->set_value(1);
+  message1.mutable_int32_to_int32()->Mutable(2)->set_value(2);
+  message2.mutable_int32_to_int32()->Mutable(2)->set_value(20);
+  message2.mutable_int32_to_int32()->Mutable(3)->set_value(30);
+
+  message1.MergeFrom(message2);
+  EXPECT_EQ(3, message1.int32_to_int32_size());
+  EXPECT_EQ(1, message1.int32_to_int32().Find(1)->value());
+  EXPECT_EQ(20, message1.int32_to_int32().Find(2)->value());
+  EXPECT_EQ(30, message1.int32_to_int32().Find(3)->value());
+
+  message1.Swap(&message2);
+  EXPECT_EQ(2, message1.int32_to_int32_size());
+  EXPECT_EQ(3, message2.int32_to_int32_size());
+  EXPECT_FALSE(message1.int32_to_int32().Contains(1));
+  EXPECT_TRUE(message2.int32_to_int32().Contains(1));
+
+  message1.CopyFrom(message2);
+  EXPECT_EQ(3, message1.int32_to_int32_size());
+  EXPECT_EQ(1, message1.int32_to_int32().Find(1)->value());
+}
+
+TEST(MapFieldTest, Descriptors) {
+  const Descriptor* descriptor = TestMap::descriptor();
+  const FieldDescriptor* field = descriptor->FindFieldByName("int32_to_int32");
+  ASSERT_TRUE(field != NULL);
+  EXPECT_TRUE(field->is_repeated());
+  EXPECT_EQ(TestMap_Int32ToInt32Entry::descriptor(), field->message_type());
+  EXPECT_EQ(field->message_type()->FindFieldByName("key"),
+            field->experimental_map_key());
+  EXPECT_TRUE(internal::IsMapField(field));
+
+  EXPECT_FALSE(internal::IsMapField(
+      TestMapNamedKey::descriptor()->FindFieldByName("items")));
+
+  // A named key leaves an ordinary repeated field.
+  TestMapNamedKey named;
+  named.add_items()->set_name("a");
+  named.add_items()->set_name("a");
+  EXPECT_EQ(2, named.items_size());
+
+  // So does a hand-written entry type; it keeps the repeated accessors.
+  EXPECT_FALSE(internal::IsMapField(
+      TestMapHandWritten::descriptor()->FindFieldByName("entries")));
+  TestMapHandWritten hand_written;
+  hand_written.add_entries()->set_key(1);
+  hand_written.add_entries()->set_key(1);
+  hand_written.mutable_entries(1)->set_value("b");
+  EXPECT_EQ(2, hand_written.entries_size());
+  EXPECT_EQ("b", hand_written.entries(1).value());
+}
+
+TEST(MapFieldTest, Reflection) {
+  TestMap message;
+  const Reflection* reflection = message.GetReflection();
+  const FieldDescriptor* field =
+      TestMap::descriptor()->FindFieldByName("string_to_string");
+  message.mutable_string_to_string()->Mutable("a")->set_value("1");
+
+  EXPECT_EQ(1, reflection->FieldSize(message, field));
+  EXPECT_EQ(&message.string_to_string(0),
+            &reflection->GetRepeatedMessage(message, field, 0));
+
+  // Entries added and changed through reflection are found by key.
+  TestMap_StringToStringEntry* entry =
+      static_cast<TestMap_StringToStringEntry*>(
+          reflection->AddMessage(&message, field));
+  entry->set_key("b");
+  entry->set_value("2");
+  EXPECT_EQ("2", message.string_to_string().Find("b")->value());
+
+  static_cast<TestMap_StringToStringEntry*>(
+      reflection->MutableRepeatedMessage(&message, field, 0))->set_key("c");
+  EXPECT_FALSE(message.string_to_string().Contains("a"));
+  EXPECT_EQ("1", message.string_to_string().Find("c")->value());
+
+  reflection->SwapElements(&message, field, 0, 1);
+  EXPECT_EQ("1", message.string_to_string().Find("c")->value());
+  EXPECT_EQ("2", message.string_to_string().Find("b")->value());
+
+  reflection->RemoveLast(&message, field);
+  EXPECT_FALSE(message.string_to_string().Contains("c"));
+  EXPECT_TRUE(message.string_to_string().Contains("b"));
+
+  // Adding a duplicate key through reflection keeps the later entry.  A
+  // lookup leaves both entries where reflection can see them; the next
+  // change through the map removes the earlier one.
+  entry = static_cast<TestMap_StringToStringEntry*>(
+      reflection->AddMessage(&message, field));
+  entry->set_key("b");
+  entry->set_value("3");
+  EXPECT_EQ("3", message.string_to_string().Find("b")->value());
+  EXPECT_EQ(2, reflection->FieldSize(message, field));
+  EXPECT_EQ("2", message.string_to_string(0).value());
+  message.mutable_string_to_string()->Mutable("e");
+  EXPECT_EQ(2, message.string_to_string_size());
+  EXPECT_EQ("3", message.string_to_string().Find("b")->value());
+  EXPECT_TRUE(message.string_to_string().Erase("e"));
+  EXPECT_EQ(1, message.string_to_string_size());
+
+  reflection->ClearField(&message, field);
+  EXPECT_FALSE(message.string_to_string().Contains("b"));
+  message.mutable_string_to_string()->Mutable("d");
+  EXPECT_EQ(1, message.string_to_string_size());
+}
+
+TEST(MapFieldTest, DynamicMessage) {
+  TestMap message;
+  for (int i = 0; i < 10; i++) {
+    message.mutable_int32_to_int32()->Mutable(i)->set_value(i * i);
+    message.mutable_uint64_to_message()->Mutable(i)->mutable_value()
+        ->set_a(i);
+  }
+  string data = message.SerializeAsString();
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> dynamic(
+      factory.GetPrototype(TestMap::descriptor())->New());
+  ASSERT_TRUE(dynamic->ParseFromString(data));
+  const FieldDescriptor* field =
+      TestMap::descriptor()->FindFieldByName("int32_to_int32");
+  EXPECT_EQ(10, dynamic->GetReflection()->FieldSize(*dynamic, field));
+  EXPECT_EQ(data, dynamic->SerializeAsString());
+
+  TestMap copy;
+  copy.CopyFrom(*dynamic);
+  EXPECT_EQ(81, copy.int32_to_int32().Find(9)->value());
+  EXPECT_EQ(9, copy.uint64_to_message().Find(9)->value().a());
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -153,6 +153,7 @@ class MessageFactory;
 // Defined in other files.
 class Descriptor;            // descriptor.h
 class FieldDescriptor;       // descriptor.h
+class OneofDescriptor;       // descriptor.h
 class EnumDescriptor;        // descriptor.h
 class EnumValueDescriptor;   // descriptor.h
 namespace io {
@@ -0,0 +1,115 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/message_batch.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/message_profiler.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+
+MessageBatch::MessageBatch(const MessageLite& prototype)
+  : prototype_(&prototype),
+    size_(0) {}
+
+MessageBatch::~MessageBatch() {
+  STLDeleteElements(&messages_);
+}
+
+bool MessageBatch::ParseDelimitedFromArray(const void* data, int size) {
+  return Parse(data, size, true);
+}
+
+bool MessageBatch::ParsePartialDelimitedFromArray(const void* data,
+                                                  int size) {
+  return Parse(data, size, false);
+}
+
+bool MessageBatch::ParseDelimitedFromString(const string& data) {
+  return Parse(data.data(), data.size(), true);
+}
+
+bool MessageBatch::ParsePartialDelimitedFromString(const string& data) {
+  return Parse(data.data(), data.size(), false);
+}
+
+void MessageBatch::ReleaseUnused() {
+  for (int i = size_; i < messages_.size(); i++) {
+    delete messages_[i];
+  }
+  messages_.resize(size_);
+}
+
+bool MessageBatch::Parse(const void* data, int size, bool check_initialized) {
+  size_ = 0;
+
+  io::CodedInputStream input(reinterpret_cast<const uint8*>(data), size);
+  // The buffer is already in memory, so the usual limit on the total size
+  // of a message only gets in the way.
+  input.SetTotalBytesLimit(size, -1);
+
+  while (input.BytesUntilLimit() > 0) {
+    uint32 length;
+    if (!input.ReadVarint32(&length)) return false;
+    if (length > static_cast<uint32>(input.BytesUntilLimit())) return false;
+
+    MessageLite* message;
+    if (size_ < messages_.size()) {
+      message = messages_[size_];
+      message->Clear();
+    } else {
+      message = prototype_->New();
+      messages_.push_back(message);
+    }
+
+    io::CodedInputStream::Limit limit = input.PushLimit(length);
+    {
+      internal::MessageProfileScope profile_scope(message, NULL, &input);
+      if (!message->MergePartialFromCodedStream(&input)) return false;
+    }
+    if (!input.ConsumedEntireMessage()) return false;
+    input.PopLimit(limit);
+
+    if (check_initialized && !message->IsInitializedAfterParse()) {
+      GOOGLE_LOG(ERROR) << "Can't parse message " << size_ << " of batch of "
+                           "type \"" << message->GetTypeName() << "\" because "
+                           "it is missing required fields: "
+                        << message->InitializationErrorString();
+      return false;
+    }
+    ++size_;
+  }
+  return true;
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,138 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// MessageBatch parses a buffer holding many length-delimited messages of the
+// same type, each preceded by its size as a varint, which is how streams of
+// small messages such as log records or RPC batches are usually framed.
+// Parsing them one at a time with ParseFromArray() sets up a new
+// CodedInputStream for every message, and a consumer which allocates a new
+// message each time also pays for the allocation and for every string and
+// sub-message inside it.  A MessageBatch reads the whole buffer with one
+// CodedInputStream, and keeps its messages when it is cleared, so parsing
+// the next batch into it reuses their memory.  For example:
+//   TypedMessageBatch<LogRecord> batch;
+//   while (ReadNextBuffer(&buffer)) {
+//     if (!batch.ParseDelimitedFromString(buffer)) return false;
+//     for (int i = 0; i < batch.size(); i++) {
+//       Process(batch.Get(i));
+//     }
+//   }
+//
+// The buffer can be written with CodedOutputStream, by calling
+// WriteVarint32(message.ByteSize()) and then
+// message.SerializeWithCachedSizes() for each message.
+
+#ifndef GOOGLE_PROTOBUF_MESSAGE_BATCH_H__
+#define GOOGLE_PROTOBUF_MESSAGE_BATCH_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class LIBPROTOBUF_EXPORT MessageBatch {
+ public:
+  // The batch's messages are created with prototype.New().  The prototype
+  // is not owned, and must outlive the batch.
+  explicit MessageBatch(const MessageLite& prototype);
+  ~MessageBatch();
+
+  // Replaces the contents of the batch with the messages in the given
+  // buffer.  Messages left over from earlier batches are cleared and
+  // reused before any new ones are allocated.  Returns false if the buffer
+  // is malformed or, unless the Partial variant is used, if a message is
+  // missing required fields.  On failure, the batch holds the messages
+  // which were parsed before the one that failed.
+  bool ParseDelimitedFromArray(const void* data, int size);
+  bool ParsePartialDelimitedFromArray(const void* data, int size);
+  bool ParseDelimitedFromString(const string& data);
+  bool ParsePartialDelimitedFromString(const string& data);
+
+  // Number of messages in the batch.
+  int size() const { return size_; }
+
+  const MessageLite& Get(int index) const;
+  MessageLite* Mutable(int index);
+
+  // Empties the batch.  The messages are kept, to be reused by the next
+  // parse; they are cleared as they are reused, not here.
+  void Clear() { size_ = 0; }
+
+  // Deletes the messages kept for reuse, which may hold on to a lot of
+  // memory after an unusually large batch.
+  void ReleaseUnused();
+
+ private:
+  bool Parse(const void* data, int size, bool check_initialized);
+
+  const MessageLite* prototype_;
+  vector<MessageLite*> messages_;  // The first size_ are in the batch.
+  int size_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageBatch);
+};
+
+// A MessageBatch of generated messages of a known type.
+template <typename Type>
+class TypedMessageBatch : public MessageBatch {
+ public:
+  TypedMessageBatch() : MessageBatch(Type::default_instance()) {}
+
+  const Type& Get(int index) const {
+    return *down_cast<const Type*>(&MessageBatch::Get(index));
+  }
+  Type* Mutable(int index) {
+    return down_cast<Type*>(MessageBatch::Mutable(index));
+  }
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TypedMessageBatch);
+};
+
+// ===================================================================
+// inline methods
+
+inline const MessageLite& MessageBatch::Get(int index) const {
+  GOOGLE_DCHECK_LT(index, size_);
+  return *messages_[index];
+}
+
+inline MessageLite* MessageBatch::Mutable(int index) {
+  GOOGLE_DCHECK_LT(index, size_);
+  return messages_[index];
+}
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_MESSAGE_BATCH_H__
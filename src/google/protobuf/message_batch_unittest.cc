@@ -0,0 +1,233 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/message_batch.h>
+
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/stubs/strutil.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Appends message to *output, preceded by its size.
+void AppendDelimited(const MessageLite& message, string* output) {
+  io::StringOutputStream string_output(output);
+  io::CodedOutputStream coded_output(&string_output);
+  coded_output.WriteVarint32(message.ByteSize());
+  message.SerializeWithCachedSizes(&coded_output);
+}
+
+// Returns a buffer of count delimited messages, each of which differs from
+// the last.
+string MakeBuffer(int count) {
+  string data;
+  for (int i = 0; i < count; i++) {
+    unittest::TestAllTypes message;
+    if (i % 2 == 0) TestUtil::SetAllFields(&message);
+    message.set_optional_int32(i);
+    message.add_repeated_string("element " + SimpleItoa(i));
+    AppendDelimited(message, &data);
+  }
+  return data;
+}
+
+void ExpectBatchMatches(int count, const TypedMessageBatch<
+                                        unittest::TestAllTypes>& batch) {
+  ASSERT_EQ(count, batch.size());
+  for (int i = 0; i < count; i++) {
+    unittest::TestAllTypes expected;
+    if (i % 2 == 0) TestUtil::SetAllFields(&expected);
+    expected.set_optional_int32(i);
+    expected.add_repeated_string("element " + SimpleItoa(i));
+    EXPECT_EQ(expected.SerializeAsString(), batch.Get(i).SerializeAsString());
+  }
+}
+
+TEST(MessageBatchTest, Parse) {
+  TypedMessageBatch<unittest::TestAllTypes> batch;
+  EXPECT_EQ(0, batch.size());
+  ASSERT_TRUE(batch.ParseDelimitedFromString(MakeBuffer(100)));
+  ExpectBatchMatches(100, batch);
+
+  batch.Mutable(3)->set_optional_int32(-3);
+  EXPECT_EQ(-3, batch.Get(3).optional_int32());
+}
+
+TEST(MessageBatchTest, ParseEmpty) {
+  TypedMessageBatch<unittest::TestAllTypes> batch;
+  ASSERT_TRUE(batch.ParseDelimitedFromString(MakeBuffer(5)));
+  ASSERT_TRUE(batch.ParseDelimitedFromArray(NULL, 0));
+  EXPECT_EQ(0, batch.size());
+
+  // An empty message takes just its size.
+  unittest::TestAllTypes empty;
+  string data;
+  AppendDelimited(empty, &data);
+  AppendDelimited(empty, &data);
+  EXPECT_EQ(2, data.size());
+  ASSERT_TRUE(batch.ParseDelimitedFromString(data));
+  ASSERT_EQ(2, batch.size());
+  EXPECT_EQ(0, batch.Get(0).ByteSize());
+  EXPECT_EQ(0, batch.Get(1).ByteSize());
+}
+
+TEST(MessageBatchTest, ReusesMessages) {
+  TypedMessageBatch<unittest::TestAllTypes> batch;
+  ASSERT_TRUE(batch.ParseDelimitedFromString(MakeBuffer(10)));
+  vector<const unittest::TestAllTypes*> messages;
+  for (int i = 0; i < batch.size(); i++) {
+    messages.push_back(&batch.Get(i));
+  }
+
+  // Parsing a smaller batch reuses the same messages, with nothing left over
+  // from their previous contents.
+  string data;
+  for (int i = 0; i < 4; i++) {
+    unittest::TestAllTypes message;
+    message.set_optional_string("small");
+    AppendDelimited(message, &data);
+  }
+  ASSERT_TRUE(batch.ParseDelimitedFromString(data));
+  ASSERT_EQ(4, batch.size());
+  for (int i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(messages[i], &batch.Get(i));
+    EXPECT_EQ("small", batch.Get(i).optional_string());
+    EXPECT_FALSE(batch.Get(i).has_optional_int32());
+    EXPECT_EQ(0, batch.Get(i).repeated_string_size());
+  }
+
+  // The rest are still there to be reused.
+  ASSERT_TRUE(batch.ParseDelimitedFromString(MakeBuffer(10)));
+  ExpectBatchMatches(10, batch);
+  for (int i = 0; i < batch.size(); i++) {
+    EXPECT_EQ(messages[i], &batch.Get(i));
+  }
+
+  batch.Clear();
+  EXPECT_EQ(0, batch.size());
+  batch.ReleaseUnused();
+  ASSERT_TRUE(batch.ParseDelimitedFromString(MakeBuffer(3)));
+  ExpectBatchMatches(3, batch);
+}
+
+TEST(MessageBatchTest, ParseMalformed) {
+  string data = MakeBuffer(10);
+  TypedMessageBatch<unittest::TestAllTypes> batch;
+
+  // Truncating the last message leaves the ones before it.
+  EXPECT_FALSE(batch.ParseDelimitedFromArray(data.data(), data.size() - 1));
+  ExpectBatchMatches(9, batch);
+
+  // So does a size which runs past the end of the buffer.
+  string bad_size = MakeBuffer(2);
+  bad_size.push_back(100);
+  bad_size.append(10, '\0');
+  EXPECT_FALSE(batch.ParseDelimitedFromString(bad_size));
+  ExpectBatchMatches(2, batch);
+
+  // A truncated size.
+  bad_size = MakeBuffer(2);
+  bad_size.push_back('\x80');
+  EXPECT_FALSE(batch.ParseDelimitedFromString(bad_size));
+  ExpectBatchMatches(2, batch);
+
+  // A message which ends in the middle of a field.
+  unittest::TestAllTypes message;
+  message.set_optional_string("truncated");
+  string element = message.SerializeAsString();
+  data = MakeBuffer(1);
+  data.push_back(element.size() - 1);
+  data.append(element, 0, element.size() - 1);
+  data += MakeBuffer(1);
+  EXPECT_FALSE(batch.ParseDelimitedFromString(data));
+  ExpectBatchMatches(1, batch);
+}
+
+#ifndef PROTOBUF_TEST_NO_DESCRIPTORS
+
+TEST(MessageBatchTest, RequiredFields) {
+  string data;
+  unittest::TestRequired message;
+  message.set_a(1);
+  message.set_b(2);
+  message.set_c(3);
+  AppendDelimited(message, &data);
+  message.clear_b();
+  AppendDelimited(message, &data);
+
+  TypedMessageBatch<unittest::TestRequired> batch;
+  vector<string> errors;
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(batch.ParseDelimitedFromString(data));
+    errors = log.GetMessages(ERROR);
+  }
+  EXPECT_EQ(1, batch.size());
+  ASSERT_EQ(1, errors.size());
+  EXPECT_EQ("Can't parse message 1 of batch of type "
+            "\"protobuf_unittest.TestRequired\" because it is missing "
+            "required fields: b",
+            errors[0]);
+
+  ASSERT_TRUE(batch.ParsePartialDelimitedFromString(data));
+  ASSERT_EQ(2, batch.size());
+  EXPECT_TRUE(batch.Get(0).IsInitialized());
+  EXPECT_FALSE(batch.Get(1).IsInitialized());
+}
+
+TEST(MessageBatchTest, DynamicMessage) {
+  DynamicMessageFactory factory;
+  const Message* prototype =
+      factory.GetPrototype(unittest::TestAllTypes::descriptor());
+  MessageBatch batch(*prototype);
+  string data = MakeBuffer(20);
+  ASSERT_TRUE(batch.ParseDelimitedFromString(data));
+  ASSERT_EQ(20, batch.size());
+
+  string reserialized;
+  for (int i = 0; i < batch.size(); i++) {
+    AppendDelimited(batch.Get(i), &reserialized);
+  }
+  EXPECT_EQ(data, reserialized);
+}
+
+#endif  // !PROTOBUF_TEST_NO_DESCRIPTORS
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -35,6 +35,7 @@
 
 #include <google/protobuf/message_lite.h>
 #include <string>
+#include <google/protobuf/message_profiler.h>
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream_impl.h>
@@ -45,6 +46,10 @@ namespace protobuf {
 
 MessageLite::~MessageLite() {}
 
+bool MessageLite::IsInitializedAfterParse() const {
+  return IsInitialized();
+}
+
 string MessageLite::InitializationErrorString() const {
   return "(cannot determine missing fields for lite message)";
 }
@@ -90,6 +95,35 @@ string InitializationErrorMessage(const char* action,
   return result;
 }
 
+// The entry points below make their calls to the generated methods through
+// these, so that each is reported to the installed MessageProfiler, if any.
+// Generated code which reports its own calls is not counted twice.
+inline bool ProfiledMergePartialFromCodedStream(io::CodedInputStream* input,
+                                                MessageLite* message) {
+  internal::MessageProfileScope profile_scope(message, NULL, input);
+  return message->MergePartialFromCodedStream(input);
+}
+
+inline int ProfiledByteSize(const MessageLite& message) {
+  internal::MessageProfileScope profile_scope(&message, NULL,
+                                              MessageProfiler::BYTE_SIZE);
+  return message.ByteSize();
+}
+
+inline void ProfiledSerializeWithCachedSizes(const MessageLite& message,
+                                             io::CodedOutputStream* output) {
+  internal::MessageProfileScope profile_scope(&message, NULL,
+                                              MessageProfiler::SERIALIZE);
+  message.SerializeWithCachedSizes(output);
+}
+
+inline uint8* ProfiledSerializeWithCachedSizesToArray(
+    const MessageLite& message, uint8* target) {
+  internal::MessageProfileScope profile_scope(&message, NULL,
+                                              MessageProfiler::SERIALIZE);
+  return message.SerializeWithCachedSizesToArray(target);
+}
+
 // Several of the Parse methods below just do one thing and then call another
 // method.  In a naive implementation, we might have ParseFromString() call
 // ParseFromArray() which would call ParseFromZeroCopyStream() which would call
@@ -118,7 +152,7 @@ inline bool InlineParsePartialFromArray(const void* data, int size,
 
 bool InlineMergeFromCodedStream(io::CodedInputStream* input,
                                 MessageLite* message) {
-  if (!message->MergePartialFromCodedStream(input)) return false;
+  if (!ProfiledMergePartialFromCodedStream(input, message)) return false;
   if (!message->IsInitialized()) {
     GOOGLE_LOG(ERROR) << InitializationErrorMessage("parse", *message);
     return false;
@@ -129,13 +163,18 @@ bool InlineMergeFromCodedStream(io::CodedInputStream* input,
 bool InlineParseFromCodedStream(io::CodedInputStream* input,
                                 MessageLite* message) {
   message->Clear();
-  return InlineMergeFromCodedStream(input, message);
+  if (!ProfiledMergePartialFromCodedStream(input, message)) return false;
+  if (!message->IsInitializedAfterParse()) {
+    GOOGLE_LOG(ERROR) << InitializationErrorMessage("parse", *message);
+    return false;
+  }
+  return true;
 }
 
 bool InlineParsePartialFromCodedStream(io::CodedInputStream* input,
                                        MessageLite* message) {
   message->Clear();
-  return message->MergePartialFromCodedStream(input);
+  return ProfiledMergePartialFromCodedStream(input, message);
 }
 
 bool InlineParseFromArray(const void* data, int size, MessageLite* message) {
@@ -232,17 +271,17 @@ bool MessageLite::SerializeToCodedStream(io::CodedOutputStream* output) const {
 
 bool MessageLite::SerializePartialToCodedStream(
     io::CodedOutputStream* output) const {
-  const int size = ByteSize();  // Force size to be cached.
+  const int size = ProfiledByteSize(*this);  // Force size to be cached.
   uint8* buffer = output->GetDirectBufferForNBytesAndAdvance(size);
   if (buffer != NULL) {
-    uint8* end = SerializeWithCachedSizesToArray(buffer);
+    uint8* end = ProfiledSerializeWithCachedSizesToArray(*this, buffer);
     if (end - buffer != size) {
       ByteSizeConsistencyError(size, ByteSize(), end - buffer);
     }
     return true;
   } else {
     int original_byte_count = output->ByteCount();
-    SerializeWithCachedSizes(output);
+    ProfiledSerializeWithCachedSizes(*this, output);
     if (output->HadError()) {
       return false;
     }
@@ -276,10 +315,10 @@ bool MessageLite::AppendToString(string* output) const {
 
 bool MessageLite::AppendPartialToString(string* output) const {
   int old_size = output->size();
-  int byte_size = ByteSize();
+  int byte_size = ProfiledByteSize(*this);
   STLStringResizeUninitialized(output, old_size + byte_size);
   uint8* start = reinterpret_cast<uint8*>(string_as_array(output) + old_size);
-  uint8* end = SerializeWithCachedSizesToArray(start);
+  uint8* end = ProfiledSerializeWithCachedSizesToArray(*this, start);
   if (end - start != byte_size) {
     ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
   }
@@ -302,10 +341,10 @@ bool MessageLite::SerializeToArray(void* data, int size) const {
 }
 
 bool MessageLite::SerializePartialToArray(void* data, int size) const {
-  int byte_size = ByteSize();
+  int byte_size = ProfiledByteSize(*this);
   if (size < byte_size) return false;
   uint8* start = reinterpret_cast<uint8*>(data);
-  uint8* end = SerializeWithCachedSizesToArray(start);
+  uint8* end = ProfiledSerializeWithCachedSizesToArray(*this, start);
   if (end - start != byte_size) {
     ByteSizeConsistencyError(byte_size, ByteSize(), end - start);
   }
@@ -92,6 +92,15 @@ class LIBPROTOBUF_EXPORT MessageLite {
   // Quickly check if all required fields have values set.
   virtual bool IsInitialized() const = 0;
 
+  // Like IsInitialized(), but only valid immediately after the message has
+  // been Clear()ed and then parsed.  Generated classes which optimize for
+  // speed record, while parsing, whether every sub-message they read was
+  // itself initialized, so this only has to check their own required fields
+  // rather than walk the whole tree again.  The default implementation just
+  // calls IsInitialized().  The Parse*() methods use this; Merge*() methods
+  // can't, since the message may have been modified before the merge.
+  virtual bool IsInitializedAfterParse() const;
+
   // This is not implemented for Lite messages -- it just returns "(cannot
   // determine missing fields for lite message)".  However, it is implemented
   // for full messages.  See message.h.
@@ -0,0 +1,389 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/message_profiler.h>
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/stubs/hash.h>
+#include <google/protobuf/stubs/once.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#define snprintf _snprintf    // see comment in strutil.cc
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#include <time.h>
+#include <sys/time.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+namespace google {
+namespace protobuf {
+
+MessageProfiler::~MessageProfiler() {}
+
+const char* MessageProfiler::OperationName(Operation operation) {
+  switch (operation) {
+    case PARSE:     return "parse";
+    case SERIALIZE: return "serialize";
+    case BYTE_SIZE: return "byte_size";
+    default:        break;
+  }
+  GOOGLE_LOG(DFATAL) << "Unknown operation: " << operation;
+  return "unknown";
+}
+
+namespace internal {
+
+MessageProfiler* message_profiler = NULL;
+
+namespace {
+
+// The innermost MessageProfileScope which is reporting, per thread.
+
+#ifdef _WIN32
+
+DWORD current_scope_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(current_scope_slot_once);
+LARGE_INTEGER ticks_per_second;
+
+void InitCurrentScopeSlot() {
+  current_scope_slot = TlsAlloc();
+  QueryPerformanceFrequency(&ticks_per_second);
+}
+
+inline void* GetCurrentScope() {
+  return TlsGetValue(current_scope_slot);
+}
+
+inline void SetCurrentScope(void* scope) {
+  TlsSetValue(current_scope_slot, scope);
+}
+
+int64 NowNanoseconds() {
+  LARGE_INTEGER ticks;
+  QueryPerformanceCounter(&ticks);
+  // Split to avoid overflowing when the counter runs at several GHz.
+  int64 seconds = ticks.QuadPart / ticks_per_second.QuadPart;
+  int64 remainder = ticks.QuadPart % ticks_per_second.QuadPart;
+  return seconds * 1000000000 +
+         remainder * 1000000000 / ticks_per_second.QuadPart;
+}
+
+#else
+
+pthread_key_t current_scope_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(current_scope_slot_once);
+
+void InitCurrentScopeSlot() {
+  // Scopes live on the stack, so there is nothing to clean up.
+  pthread_key_create(&current_scope_slot, NULL);
+}
+
+inline void* GetCurrentScope() {
+  return pthread_getspecific(current_scope_slot);
+}
+
+inline void SetCurrentScope(void* scope) {
+  pthread_setspecific(current_scope_slot, scope);
+}
+
+int64 NowNanoseconds() {
+#ifdef CLOCK_MONOTONIC
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64>(now.tv_sec) * 1000000000 + now.tv_nsec;
+#else
+  struct timeval now;
+  gettimeofday(&now, NULL);
+  return static_cast<int64>(now.tv_sec) * 1000000000 + now.tv_usec * 1000;
+#endif
+}
+
+#endif
+
+}  // namespace
+
+void MessageProfileScope::Begin(const MessageLite* message,
+                                const char* type_name,
+                                MessageProfiler::Operation operation,
+                                const io::CodedInputStream* input) {
+  GoogleOnceInit(&current_scope_slot_once, &InitCurrentScopeSlot);
+  parent_ = reinterpret_cast<MessageProfileScope*>(GetCurrentScope());
+  if (parent_ != NULL && parent_->message_ == message &&
+      parent_->operation_ == operation) {
+    // The same call, seen from an entry point and again from the method it
+    // called.  Let the outer scope report it, under the more precise name.
+    if (parent_->type_name_ == NULL) parent_->type_name_ = type_name;
+    profiler_ = NULL;
+    return;
+  }
+
+  message_ = message;
+  type_name_ = type_name;
+  operation_ = operation;
+  input_ = input;
+  start_position_ = input == NULL ? 0 : input->CurrentPosition();
+  child_nanoseconds_ = 0;
+  SetCurrentScope(this);
+  start_time_ = NowNanoseconds();
+}
+
+void MessageProfileScope::End() {
+  int64 nanoseconds = NowNanoseconds() - start_time_;
+  SetCurrentScope(parent_);
+  if (parent_ != NULL) parent_->child_nanoseconds_ += nanoseconds;
+
+  MessageProfiler::Sample sample;
+  sample.operation = operation_;
+  sample.bytes = input_ == NULL ? message_->GetCachedSize()
+                                : input_->CurrentPosition() - start_position_;
+  sample.nanoseconds = nanoseconds;
+  sample.self_nanoseconds = nanoseconds - child_nanoseconds_;
+
+  if (type_name_ != NULL) {
+    sample.type_name = type_name_;
+    profiler_->Record(sample);
+  } else {
+    string type_name = message_->GetTypeName();
+    sample.type_name = type_name.c_str();
+    profiler_->Record(sample);
+  }
+}
+
+}  // namespace internal
+
+MessageProfiler* SetMessageProfiler(MessageProfiler* profiler) {
+  MessageProfiler* old = internal::message_profiler;
+  internal::message_profiler = profiler;
+  return old;
+}
+
+// ===================================================================
+
+namespace {
+
+// Formats a duration, e.g. "12.3us".
+string FormatNanoseconds(int64 nanoseconds) {
+  char buffer[32];
+  if (nanoseconds < 1000) {
+    snprintf(buffer, sizeof(buffer), "%dns", static_cast<int>(nanoseconds));
+  } else if (nanoseconds < GOOGLE_LONGLONG(1000000)) {
+    snprintf(buffer, sizeof(buffer), "%.1fus", nanoseconds / 1e3);
+  } else if (nanoseconds < GOOGLE_LONGLONG(1000000000)) {
+    snprintf(buffer, sizeof(buffer), "%.1fms", nanoseconds / 1e6);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%.1fs", nanoseconds / 1e9);
+  }
+  return buffer;
+}
+
+string FormatInt64(int64 value) {
+  char buffer[32];
+  snprintf(buffer, sizeof(buffer), "%.0f", static_cast<double>(value));
+  return buffer;
+}
+
+// Returns the upper bound of the histogram bucket containing the given
+// fraction of calls.
+string Percentile(const MessageProfileCollector::Stats& stats,
+                  double fraction) {
+  int64 seen = 0;
+  for (int i = 0; i < MessageProfileCollector::kHistogramBuckets - 1; i++) {
+    seen += stats.histogram[i];
+    if (seen >= stats.calls * fraction) {
+      return "<" + FormatNanoseconds(GOOGLE_LONGLONG(1) << i);
+    }
+  }
+  return ">=" + FormatNanoseconds(
+      GOOGLE_LONGLONG(1) << (MessageProfileCollector::kHistogramBuckets - 2));
+}
+
+}  // namespace
+
+MessageProfileCollector::Stats::Stats()
+  : calls(0), bytes(0), nanoseconds(0), self_nanoseconds(0) {
+  for (int i = 0; i < kHistogramBuckets; i++) {
+    histogram[i] = 0;
+  }
+}
+
+struct MessageProfileCollector::TypeStats {
+  string name;
+  Stats stats[NUM_OPERATIONS];
+};
+
+// Keyed by TypeStats::name, so that samples can be looked up without
+// copying their names.
+struct MessageProfileCollector::Table {
+  typedef hash_map<const char*, TypeStats*,
+                   hash<const char*>, streq> Map;
+  Map types;
+};
+
+MessageProfileCollector::MessageProfileCollector()
+  : table_(new Table) {}
+
+MessageProfileCollector::~MessageProfileCollector() {
+  Reset();
+  delete table_;
+}
+
+void MessageProfileCollector::Record(const Sample& sample) {
+  int bucket = 0;
+  while (bucket < kHistogramBuckets - 1 &&
+         sample.nanoseconds >= (GOOGLE_LONGLONG(1) << bucket)) {
+    ++bucket;
+  }
+
+  MutexLock lock(&mutex_);
+  TypeStats* type;
+  Table::Map::iterator iter = table_->types.find(sample.type_name);
+  if (iter != table_->types.end()) {
+    type = iter->second;
+  } else {
+    type = new TypeStats;
+    type->name = sample.type_name;
+    table_->types[type->name.c_str()] = type;
+  }
+
+  Stats* stats = &type->stats[sample.operation];
+  ++stats->calls;
+  stats->bytes += sample.bytes;
+  stats->nanoseconds += sample.nanoseconds;
+  stats->self_nanoseconds += sample.self_nanoseconds;
+  ++stats->histogram[bucket];
+}
+
+MessageProfileCollector::Stats MessageProfileCollector::GetStats(
+    const string& type_name, Operation operation) const {
+  MutexLock lock(&mutex_);
+  Table::Map::const_iterator iter = table_->types.find(type_name.c_str());
+  if (iter == table_->types.end()) return Stats();
+  return iter->second->stats[operation];
+}
+
+void MessageProfileCollector::Reset() {
+  MutexLock lock(&mutex_);
+  vector<TypeStats*> types;
+  for (Table::Map::const_iterator iter = table_->types.begin();
+       iter != table_->types.end(); ++iter) {
+    types.push_back(iter->second);
+  }
+  table_->types.clear();
+  STLDeleteElements(&types);
+}
+
+namespace {
+
+struct ReportEntry {
+  const string* type_name;
+  MessageProfiler::Operation operation;
+  MessageProfileCollector::Stats stats;
+};
+
+struct BySelfTimeDescending {
+  bool operator()(const ReportEntry& a, const ReportEntry& b) const {
+    if (a.stats.self_nanoseconds != b.stats.self_nanoseconds) {
+      return a.stats.self_nanoseconds > b.stats.self_nanoseconds;
+    }
+    if (*a.type_name != *b.type_name) return *a.type_name < *b.type_name;
+    return a.operation < b.operation;
+  }
+};
+
+}  // namespace
+
+string MessageProfileCollector::Report() const {
+  MutexLock lock(&mutex_);
+
+  vector<ReportEntry> entries;
+  int64 total_self_nanoseconds = 0;
+  for (Table::Map::const_iterator iter = table_->types.begin();
+       iter != table_->types.end(); ++iter) {
+    for (int i = 0; i < NUM_OPERATIONS; i++) {
+      const Stats& stats = iter->second->stats[i];
+      if (stats.calls == 0) continue;
+      ReportEntry entry;
+      entry.type_name = &iter->second->name;
+      entry.operation = static_cast<Operation>(i);
+      entry.stats = stats;
+      entries.push_back(entry);
+      total_self_nanoseconds += stats.self_nanoseconds;
+    }
+  }
+  sort(entries.begin(), entries.end(), BySelfTimeDescending());
+
+  string result = "Message profile (" + FormatNanoseconds(
+      total_self_nanoseconds) + " total), by self time:\n";
+  for (int i = 0; i < entries.size(); i++) {
+    const ReportEntry& entry = entries[i];
+    const Stats& stats = entry.stats;
+    char percent[16];
+    snprintf(percent, sizeof(percent), "%.1f%%",
+             total_self_nanoseconds == 0 ? 0.0 :
+             100.0 * stats.self_nanoseconds / total_self_nanoseconds);
+
+    result += "\n" + *entry.type_name + " " + OperationName(entry.operation);
+    result += "\n  calls: " + FormatInt64(stats.calls) +
+              "  bytes: " + FormatInt64(stats.bytes) +
+              "  total: " + FormatNanoseconds(stats.nanoseconds) +
+              "  self: " + FormatNanoseconds(stats.self_nanoseconds) +
+              " (" + percent + ")";
+    result += "\n  p50: " + Percentile(stats, 0.5) +
+              "  p90: " + Percentile(stats, 0.9) +
+              "  p99: " + Percentile(stats, 0.99);
+    result += "\n  histogram:";
+    for (int j = 0; j < kHistogramBuckets; j++) {
+      if (stats.histogram[j] == 0) continue;
+      if (j < kHistogramBuckets - 1) {
+        result += " <" + FormatNanoseconds(GOOGLE_LONGLONG(1) << j);
+      } else {
+        result += " >=" + FormatNanoseconds(GOOGLE_LONGLONG(1) << (j - 1));
+      }
+      result += ":" + FormatInt64(stats.histogram[j]);
+    }
+    result += "\n";
+  }
+  return result;
+}
+
+}  // namespace protobuf
+}  // namespace google
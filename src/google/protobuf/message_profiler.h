@@ -0,0 +1,233 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Per-message-type profiling of parsing and serialization.
+//
+// Once a MessageProfiler is installed with SetMessageProfiler(), it is told
+// about every parse, serialization and size computation as it finishes:
+// which message type, how many bytes, and how long it took.  There are two
+// ways calls get reported:
+//
+//   * The MessageLite entry points (ParseFromString(), SerializeToString(),
+//     SerializeToCodedStream() and the like) report the top-level message
+//     of every call, whatever code was generated for it.  Nothing needs to
+//     be rebuilt to use this.
+//
+//   * Code generated with the "profile_messages" option, e.g.:
+//       protoc --cpp_out=profile_messages:outdir foo.proto
+//     also reports each embedded message as it is parsed, serialized or
+//     sized.  The time spent in an embedded message is included in the
+//     total time of the message containing it, but not in its self time.
+//
+// When no profiler is installed, each reporting point costs a load and a
+// branch.
+//
+// MessageProfileCollector is a MessageProfiler which keeps call counts,
+// byte counts and latency histograms for each type, and prints them as a
+// text report:
+//
+//   MessageProfileCollector collector;
+//   SetMessageProfiler(&collector);
+//   ... run the workload ...
+//   SetMessageProfiler(NULL);
+//   cerr << collector.Report();
+
+#ifndef GOOGLE_PROTOBUF_MESSAGE_PROFILER_H__
+#define GOOGLE_PROTOBUF_MESSAGE_PROFILER_H__
+
+#include <string>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+class MessageLite;
+namespace io {
+  class CodedInputStream;
+}
+
+// Receives one Sample for each profiled call.  Record() may be called from
+// any number of threads at once.
+class LIBPROTOBUF_EXPORT MessageProfiler {
+ public:
+  enum Operation {
+    PARSE,      // MergePartialFromCodedStream()
+    SERIALIZE,  // SerializeWithCachedSizes() and ...ToArray()
+    BYTE_SIZE,  // ByteSize()
+
+    NUM_OPERATIONS
+  };
+
+  struct Sample {
+    // Full name of the message type, e.g. "foo.bar.Baz".  Only valid for the
+    // duration of the call to Record().
+    const char* type_name;
+    Operation operation;
+    // Bytes parsed or serialized.  For BYTE_SIZE, the size computed.
+    int64 bytes;
+    // Wall time spent in the call, and that time less the time spent in
+    // calls for embedded messages which were themselves reported.
+    int64 nanoseconds;
+    int64 self_nanoseconds;
+  };
+
+  inline MessageProfiler() {}
+  virtual ~MessageProfiler();
+
+  virtual void Record(const Sample& sample) = 0;
+
+  // Returns the name of the operation as used in reports: "parse",
+  // "serialize" or "byte_size".
+  static const char* OperationName(Operation operation);
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageProfiler);
+};
+
+// Installs the profiler which receives all samples, replacing the current
+// one, which is returned.  NULL turns profiling off.  The profiler is not
+// owned, and must stay alive until calls which started while it was
+// installed have finished.  Like SetLogHandler(), this is not meant to be
+// called concurrently with itself.
+LIBPROTOBUF_EXPORT MessageProfiler* SetMessageProfiler(
+    MessageProfiler* profiler);
+
+// A MessageProfiler which aggregates samples by message type and operation.
+class LIBPROTOBUF_EXPORT MessageProfileCollector : public MessageProfiler {
+ public:
+  // Latency histograms have one bucket per power of two nanoseconds:
+  // bucket 0 counts calls under 1ns, bucket i calls in [2^(i-1), 2^i) ns,
+  // and the last bucket everything longer.
+  static const int kHistogramBuckets = 32;
+
+  struct Stats {
+    Stats();
+
+    int64 calls;
+    int64 bytes;
+    int64 nanoseconds;
+    int64 self_nanoseconds;
+    int64 histogram[kHistogramBuckets];
+  };
+
+  MessageProfileCollector();
+  ~MessageProfileCollector();
+
+  // Returns the totals for one type and operation.  All are zero if nothing
+  // was recorded.
+  Stats GetStats(const string& type_name, Operation operation) const;
+
+  // Returns a report of everything recorded, with the types and operations
+  // which took the most self time first.  For each, it shows the totals,
+  // percentiles estimated from the histogram, and the histogram itself.
+  string Report() const;
+
+  // Forgets everything recorded.
+  void Reset();
+
+  // implements MessageProfiler ----------------------------------------
+  void Record(const Sample& sample);
+
+ private:
+  struct TypeStats;
+  struct Table;
+
+  mutable internal::Mutex mutex_;
+  Table* table_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageProfileCollector);
+};
+
+namespace internal {
+
+// The installed profiler.  Use SetMessageProfiler() to change it.
+LIBPROTOBUF_EXPORT extern MessageProfiler* message_profiler;
+
+// Times one call and reports it to the installed profiler, if any, when it
+// goes out of scope.  Used by generated code and MessageLite; not for
+// general use.
+//
+// If type_name is NULL, the message's GetTypeName() is used.  A scope for
+// the same message and operation as the scope enclosing it on the same
+// thread reports nothing, so an entry point and the generated method it
+// calls count as one call.
+class LIBPROTOBUF_EXPORT MessageProfileScope {
+ public:
+  // For SERIALIZE and BYTE_SIZE.  The byte count reported is the message's
+  // cached size when the scope ends.
+  inline MessageProfileScope(const MessageLite* message,
+                             const char* type_name,
+                             MessageProfiler::Operation operation)
+      : profiler_(message_profiler) {
+    if (profiler_ != NULL) Begin(message, type_name, operation, NULL);
+  }
+
+  // For PARSE.  The byte count reported is how far the input advanced.
+  inline MessageProfileScope(const MessageLite* message,
+                             const char* type_name,
+                             const io::CodedInputStream* input)
+      : profiler_(message_profiler) {
+    if (profiler_ != NULL) {
+      Begin(message, type_name, MessageProfiler::PARSE, input);
+    }
+  }
+
+  inline ~MessageProfileScope() {
+    if (profiler_ != NULL) End();
+  }
+
+ private:
+  void Begin(const MessageLite* message, const char* type_name,
+             MessageProfiler::Operation operation,
+             const io::CodedInputStream* input);
+  void End();
+
+  // NULL if this scope reports nothing.
+  MessageProfiler* profiler_;
+
+  // The rest are only set if profiler_ is non-NULL.
+  const MessageLite* message_;
+  const char* type_name_;
+  MessageProfiler::Operation operation_;
+  const io::CodedInputStream* input_;
+  int start_position_;
+  int64 start_time_;
+  int64 child_nanoseconds_;
+  MessageProfileScope* parent_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(MessageProfileScope);
+};
+
+}  // namespace internal
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_MESSAGE_PROFILER_H__
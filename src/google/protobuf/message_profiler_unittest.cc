@@ -0,0 +1,317 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/message_profiler.h>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_profile.pb.h>
+#include <google/protobuf/test_util.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+using protobuf_unittest::TestProfileInner;
+using protobuf_unittest::TestProfileMessageSet;
+using protobuf_unittest::TestProfileMessageSetExtension;
+using protobuf_unittest::TestProfileOuter;
+
+class MessageProfilerTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    EXPECT_TRUE(SetMessageProfiler(&collector_) == NULL);
+  }
+
+  virtual void TearDown() {
+    EXPECT_TRUE(SetMessageProfiler(NULL) == &collector_);
+  }
+
+  int64 Calls(const string& type_name, MessageProfiler::Operation operation) {
+    return collector_.GetStats(type_name, operation).calls;
+  }
+
+  int64 Bytes(const string& type_name, MessageProfiler::Operation operation) {
+    return collector_.GetStats(type_name, operation).bytes;
+  }
+
+  void SetOuter(TestProfileOuter* message) {
+    message->set_id(12);
+    message->mutable_inner()->set_name("inner");
+    message->add_items()->set_value(1);
+    message->add_items()->set_name("second");
+  }
+
+  MessageProfileCollector collector_;
+};
+
+TEST_F(MessageProfilerTest, EntryPoints) {
+  // unittest.proto is compiled without profile_messages, so only the
+  // top-level calls are reported.
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+
+  string data;
+  ASSERT_TRUE(message.SerializeToString(&data));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestAllTypes",
+                     MessageProfiler::BYTE_SIZE));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestAllTypes",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestAllTypes",
+                               MessageProfiler::SERIALIZE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestAllTypes",
+                               MessageProfiler::BYTE_SIZE));
+
+  unittest::TestAllTypes parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestAllTypes",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestAllTypes",
+                               MessageProfiler::PARSE));
+
+  EXPECT_EQ(0, Calls("protobuf_unittest.TestAllTypes.NestedMessage",
+                     MessageProfiler::PARSE));
+}
+
+TEST_F(MessageProfilerTest, ParseFromStreamCountsOnlyMessageBytes) {
+  unittest::TestAllTypes message;
+  message.set_optional_int32(1);
+  string data = message.SerializeAsString();
+  collector_.Reset();
+
+  // The stream holds more than the message; only what is parsed counts.
+  string input = data + "trailing bytes";
+  io::CodedInputStream coded_input(
+      reinterpret_cast<const uint8*>(input.data()), input.size());
+  io::CodedInputStream::Limit limit = coded_input.PushLimit(data.size());
+  ASSERT_TRUE(message.ParseFromCodedStream(&coded_input));
+  coded_input.PopLimit(limit);
+  EXPECT_EQ(data.size(), coded_input.CurrentPosition());
+
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestAllTypes",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestAllTypes",
+                               MessageProfiler::PARSE));
+}
+
+TEST_F(MessageProfilerTest, GeneratedHooks) {
+  TestProfileOuter message;
+  SetOuter(&message);
+
+  string data;
+  ASSERT_TRUE(message.SerializeToString(&data));
+
+  // The entry point and the generated methods report the outer message
+  // once, and each embedded message is reported on its own.
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::BYTE_SIZE));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(3, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::BYTE_SIZE));
+  EXPECT_EQ(3, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestProfileOuter",
+                               MessageProfiler::SERIALIZE));
+  int inner_bytes = message.inner().GetCachedSize() +
+                    message.items(0).GetCachedSize() +
+                    message.items(1).GetCachedSize();
+  EXPECT_EQ(inner_bytes, Bytes("protobuf_unittest.TestProfileInner",
+                               MessageProfiler::SERIALIZE));
+
+  TestProfileOuter parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(3, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestProfileOuter",
+                               MessageProfiler::PARSE));
+  EXPECT_EQ(inner_bytes, Bytes("protobuf_unittest.TestProfileInner",
+                               MessageProfiler::PARSE));
+
+  // Time spent in the embedded messages is not the outer message's own.
+  MessageProfileCollector::Stats outer =
+      collector_.GetStats("protobuf_unittest.TestProfileOuter",
+                          MessageProfiler::PARSE);
+  EXPECT_LE(outer.self_nanoseconds, outer.nanoseconds);
+  EXPECT_GE(outer.self_nanoseconds, 0);
+}
+
+TEST_F(MessageProfilerTest, GeneratedHooksWithoutDirectBuffer) {
+  TestProfileOuter message;
+  SetOuter(&message);
+
+  // One-byte buffers force the stream-based serialization path.
+  char buffer[256];
+  int size;
+  {
+    io::ArrayOutputStream raw_output(buffer, sizeof(buffer), 1);
+    io::CodedOutputStream output(&raw_output);
+    ASSERT_TRUE(message.SerializeToCodedStream(&output));
+    size = output.ByteCount();
+  }
+  string data(buffer, size);
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(3, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::SERIALIZE));
+
+  // Calling a generated method directly reports it too.
+  collector_.Reset();
+  io::ArrayInputStream raw_input(data.data(), data.size(), 1);
+  io::CodedInputStream input(&raw_input);
+  TestProfileOuter parsed;
+  ASSERT_TRUE(parsed.MergePartialFromCodedStream(&input));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(3, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestProfileOuter",
+                               MessageProfiler::PARSE));
+}
+
+TEST_F(MessageProfilerTest, MessageSet) {
+  TestProfileMessageSet message_set;
+  message_set.MutableExtension(
+      TestProfileMessageSetExtension::message_set_extension)->set_i(123);
+
+  string data;
+  ASSERT_TRUE(message_set.SerializeToString(&data));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileMessageSet",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileMessageSetExtension",
+                     MessageProfiler::SERIALIZE));
+
+  TestProfileMessageSet parsed;
+  ASSERT_TRUE(parsed.ParseFromString(data));
+  EXPECT_EQ(1, Calls("protobuf_unittest.TestProfileMessageSet",
+                     MessageProfiler::PARSE));
+  EXPECT_EQ(data.size(), Bytes("protobuf_unittest.TestProfileMessageSet",
+                               MessageProfiler::PARSE));
+}
+
+TEST_F(MessageProfilerTest, NothingReportedWhenNotInstalled) {
+  EXPECT_TRUE(SetMessageProfiler(NULL) == &collector_);
+
+  TestProfileOuter message;
+  SetOuter(&message);
+  string data = message.SerializeAsString();
+  EXPECT_TRUE(message.ParseFromString(data));
+
+  EXPECT_TRUE(SetMessageProfiler(&collector_) == NULL);
+  EXPECT_EQ(0, Calls("protobuf_unittest.TestProfileOuter",
+                     MessageProfiler::SERIALIZE));
+  EXPECT_EQ(0, Calls("protobuf_unittest.TestProfileInner",
+                     MessageProfiler::PARSE));
+}
+
+TEST_F(MessageProfilerTest, Histogram) {
+  EXPECT_TRUE(SetMessageProfiler(NULL) == &collector_);
+
+  MessageProfiler::Sample sample;
+  sample.type_name = "foo.Bar";
+  sample.operation = MessageProfiler::SERIALIZE;
+  sample.bytes = 10;
+  const int64 kNanoseconds[] = { 0, 1, 3, 3, 1000, GOOGLE_LONGLONG(1) << 40 };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kNanoseconds); i++) {
+    sample.nanoseconds = kNanoseconds[i];
+    sample.self_nanoseconds = kNanoseconds[i] / 2;
+    collector_.Record(sample);
+  }
+
+  MessageProfileCollector::Stats stats =
+      collector_.GetStats("foo.Bar", MessageProfiler::SERIALIZE);
+  EXPECT_EQ(6, stats.calls);
+  EXPECT_EQ(60, stats.bytes);
+  EXPECT_EQ(1007 + (GOOGLE_LONGLONG(1) << 40), stats.nanoseconds);
+  EXPECT_EQ(0 + 0 + 1 + 1 + 500 + (GOOGLE_LONGLONG(1) << 39),
+            stats.self_nanoseconds);
+  EXPECT_EQ(1, stats.histogram[0]);   // < 1ns
+  EXPECT_EQ(1, stats.histogram[1]);   // [1, 2)
+  EXPECT_EQ(2, stats.histogram[2]);   // [2, 4)
+  EXPECT_EQ(1, stats.histogram[10]);  // [512, 1024)
+  EXPECT_EQ(1, stats.histogram[MessageProfileCollector::kHistogramBuckets - 1]);
+
+  EXPECT_EQ(0, collector_.GetStats("foo.Bar", MessageProfiler::PARSE).calls);
+  EXPECT_EQ(0, collector_.GetStats("foo.Baz",
+                                   MessageProfiler::SERIALIZE).calls);
+
+  collector_.Reset();
+  EXPECT_EQ(0, collector_.GetStats("foo.Bar",
+                                   MessageProfiler::SERIALIZE).calls);
+
+  EXPECT_TRUE(SetMessageProfiler(&collector_) == NULL);
+}
+
+TEST_F(MessageProfilerTest, Report) {
+  EXPECT_TRUE(SetMessageProfiler(NULL) == &collector_);
+
+  MessageProfiler::Sample sample;
+  sample.type_name = "foo.Small";
+  sample.operation = MessageProfiler::PARSE;
+  sample.bytes = 5;
+  sample.nanoseconds = 100;
+  sample.self_nanoseconds = 100;
+  collector_.Record(sample);
+  sample.type_name = "foo.Large";
+  sample.operation = MessageProfiler::BYTE_SIZE;
+  sample.bytes = 5000;
+  sample.nanoseconds = 2500000;
+  sample.self_nanoseconds = 2000000;
+  collector_.Record(sample);
+  collector_.Record(sample);
+
+  string report = collector_.Report();
+  // The type with the most self time comes first.
+  string::size_type large = report.find("foo.Large byte_size\n");
+  string::size_type small = report.find("foo.Small parse\n");
+  ASSERT_NE(string::npos, large);
+  ASSERT_NE(string::npos, small);
+  EXPECT_LT(large, small);
+
+  EXPECT_NE(string::npos, report.find(
+      "  calls: 2  bytes: 10000  total: 5.0ms  self: 4.0ms (100.0%)\n"))
+      << report;
+  EXPECT_NE(string::npos, report.find(
+      "  p50: <4.2ms  p90: <4.2ms  p99: <4.2ms\n")) << report;
+  EXPECT_NE(string::npos, report.find("  histogram: <4.2ms:2\n")) << report;
+  EXPECT_NE(string::npos, report.find("  histogram: <128ns:1\n")) << report;
+
+  EXPECT_TRUE(SetMessageProfiler(&collector_) == NULL);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
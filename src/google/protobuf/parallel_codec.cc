@@ -0,0 +1,519 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/parallel_codec.h>
+
+#include <pthread.h>
+#include <utility>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/generated_message_reflection.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/rpc/executor.h>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/stubs/closure_pool.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+#include <google/protobuf/stubs/strutil.h>
+
+namespace google {
+namespace protobuf {
+
+using internal::WireFormat;
+using internal::WireFormatLite;
+using io::CodedOutputStream;
+
+namespace {
+
+// Elements are handed out to threads in chunks of about this many bytes, so
+// that each task is big enough to be worth queuing.
+static const int kChunkBytes = 64 << 10;
+
+// Before their sizes are known, elements are handed out this many at a time.
+static const int kChunkElements = 512;
+
+// A job split into numbered chunks, each of which may run on any thread.
+class ChunkedJob {
+ public:
+  virtual ~ChunkedJob() {}
+
+  // Returns false if the chunk failed, in which case chunks not yet
+  // started are skipped.
+  virtual bool RunChunk(int chunk) = 0;
+};
+
+// State shared by the calling thread and the executor's tasks.  It is
+// reference counted because a task may not start until after every chunk
+// is done and the caller has returned; such a task finds nothing to do but
+// still touches the state.
+struct ParallelRun {
+  pthread_mutex_t mutex;
+  pthread_cond_t all_finished;
+
+  ChunkedJob* job;  // Only used by threads which have claimed a chunk.
+  int num_chunks;
+  int next_chunk;
+  int finished;
+  bool ok;
+  int refs;
+};
+
+// Claims and runs chunks until none are left.
+void RunChunks(ParallelRun* run) {
+  pthread_mutex_lock(&run->mutex);
+  while (run->next_chunk < run->num_chunks) {
+    int chunk = run->next_chunk++;
+    bool skip = !run->ok;
+    pthread_mutex_unlock(&run->mutex);
+
+    bool ok = skip || run->job->RunChunk(chunk);
+
+    pthread_mutex_lock(&run->mutex);
+    if (!ok) run->ok = false;
+    if (++run->finished == run->num_chunks) {
+      pthread_cond_signal(&run->all_finished);
+    }
+  }
+  pthread_mutex_unlock(&run->mutex);
+}
+
+void ReleaseRun(ParallelRun* run) {
+  pthread_mutex_lock(&run->mutex);
+  bool last = --run->refs == 0;
+  pthread_mutex_unlock(&run->mutex);
+  if (last) {
+    pthread_cond_destroy(&run->all_finished);
+    pthread_mutex_destroy(&run->mutex);
+    delete run;
+  }
+}
+
+void RunChunksAndRelease(ParallelRun* run) {
+  RunChunks(run);
+  ReleaseRun(run);
+}
+
+// Runs every chunk of the job, on the calling thread and on the executor,
+// and returns once all of them have finished.  Returns false if any chunk
+// failed.
+bool RunInParallel(rpc::Executor* executor, int num_chunks, ChunkedJob* job) {
+  if (num_chunks == 0) return true;
+
+  ParallelRun* run = new ParallelRun;
+  pthread_mutex_init(&run->mutex, NULL);
+  pthread_cond_init(&run->all_finished, NULL);
+  run->job = job;
+  run->num_chunks = num_chunks;
+  run->next_chunk = 0;
+  run->finished = 0;
+  run->ok = true;
+
+  // Each task keeps taking chunks until none are left, so one task per
+  // executor thread is enough.  The calling thread takes chunks too.
+  int num_tasks = min(num_chunks - 1, executor->num_threads());
+  run->refs = num_tasks + 1;
+  for (int i = 0; i < num_tasks; i++) {
+    executor->Add(NewPooledCallback(&RunChunksAndRelease, run));
+  }
+
+  RunChunks(run);
+
+  pthread_mutex_lock(&run->mutex);
+  while (run->finished < run->num_chunks) {
+    pthread_cond_wait(&run->all_finished, &run->mutex);
+  }
+  bool ok = run->ok;
+  pthread_mutex_unlock(&run->mutex);
+
+  ReleaseRun(run);
+  return ok;
+}
+
+// -------------------------------------------------------------------
+
+// Can the elements of this field be parsed in parallel?
+bool IsParallelField(const FieldDescriptor* field) {
+  return field != NULL &&
+         field->is_repeated() &&
+         field->type() == FieldDescriptor::TYPE_MESSAGE &&
+         !internal::IsMapField(field);
+}
+
+struct Element {
+  const uint8* data;
+  int size;
+  const FieldDescriptor* field;
+  int index;  // In the field.
+  Message* message;
+};
+
+void LogMissingFields(const Message& message, const vector<string>& errors) {
+  GOOGLE_LOG(ERROR) << "Can't parse message of type \"" << message.GetTypeName()
+                    << "\" because it is missing required fields: "
+                    << JoinStrings(errors, ", ");
+}
+
+class ParseJob : public ChunkedJob {
+ public:
+  ParseJob(const vector<Element>* elements, const vector<int>* chunk_starts,
+           bool check_initialized)
+    : elements_(elements),
+      chunk_starts_(chunk_starts),
+      check_initialized_(check_initialized) {}
+
+  // Names of required fields found missing, if that is why a chunk failed.
+  const vector<string>& missing_fields() const { return missing_fields_; }
+
+  bool RunChunk(int chunk) {
+    int end = chunk + 1 < chunk_starts_->size() ?
+        (*chunk_starts_)[chunk + 1] : elements_->size();
+    for (int i = (*chunk_starts_)[chunk]; i < end; i++) {
+      const Element& element = (*elements_)[i];
+      io::CodedInputStream input(element.data, element.size);
+      if (!element.message->MergePartialFromCodedStream(&input) ||
+          !input.ConsumedEntireMessage()) {
+        return false;
+      }
+      if (check_initialized_ && !element.message->IsInitializedAfterParse()) {
+        vector<string> errors;
+        element.message->FindInitializationErrors(&errors);
+        string prefix = element.field->name() + "[" +
+                        SimpleItoa(element.index) + "].";
+        MutexLock lock(&mutex_);
+        for (int j = 0; j < errors.size(); j++) {
+          missing_fields_.push_back(prefix + errors[j]);
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  const vector<Element>* elements_;
+  const vector<int>* chunk_starts_;
+  bool check_initialized_;
+
+  Mutex mutex_;
+  vector<string> missing_fields_;
+};
+
+bool ParseParallel(const void* data, int size, Message* message,
+                   rpc::Executor* executor, bool check_initialized) {
+  const uint8* buffer = reinterpret_cast<const uint8*>(data);
+  const Descriptor* descriptor = message->GetDescriptor();
+  const Reflection* reflection = message->GetReflection();
+  message->Clear();
+
+  // Find where every element of the repeated message fields is.  The other
+  // fields are gathered into runs of adjacent fields, which are parsed on
+  // this thread.
+  vector<Element> elements;
+  vector<pair<int, int> > others;
+  {
+    io::CodedInputStream input(buffer, size);
+    input.SetTotalBytesLimit(size, -1);
+
+    // Most tags belong to the same field as the one before.
+    int last_number = 0;
+    const FieldDescriptor* last_field = NULL;
+
+    while (true) {
+      int start = input.CurrentPosition();
+      uint32 tag = input.ReadTag();
+      if (tag == 0) break;
+
+      int number = WireFormatLite::GetTagFieldNumber(tag);
+      if (number != last_number) {
+        last_number = number;
+        last_field = descriptor->FindFieldByNumber(number);
+        if (!IsParallelField(last_field)) last_field = NULL;
+      }
+
+      if (last_field != NULL &&
+          WireFormatLite::GetTagWireType(tag) ==
+          WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+        uint32 length;
+        if (!input.ReadVarint32(&length)) return false;
+        if (length > static_cast<uint32>(input.BytesUntilLimit())) {
+          return false;
+        }
+        Element element;
+        element.data = buffer + input.CurrentPosition();
+        element.size = length;
+        element.field = last_field;
+        element.message = NULL;
+        elements.push_back(element);
+        input.Skip(length);
+      } else {
+        if (!WireFormatLite::SkipField(&input, tag)) return false;
+        int end = input.CurrentPosition();
+        if (!others.empty() && others.back().second == start) {
+          others.back().second = end;
+        } else {
+          others.push_back(make_pair(start, end));
+        }
+      }
+    }
+    if (!input.ConsumedEntireMessage()) return false;
+  }
+
+  for (int i = 0; i < others.size(); i++) {
+    io::CodedInputStream input(buffer + others[i].first,
+                               others[i].second - others[i].first);
+    if (!message->MergePartialFromCodedStream(&input) ||
+        !input.ConsumedEntireMessage()) {
+      return false;
+    }
+  }
+  // The repeated fields are still empty, so this only checks the rest.
+  if (check_initialized && !message->IsInitialized()) {
+    vector<string> errors;
+    message->FindInitializationErrors(&errors);
+    LogMissingFields(*message, errors);
+    return false;
+  }
+
+  // Add the elements up front, since the repeated fields themselves must
+  // not be modified from several threads.  Then split them into chunks.
+  vector<int> chunk_starts;
+  int chunk_bytes = kChunkBytes;
+  for (int i = 0; i < elements.size(); i++) {
+    Element* element = &elements[i];
+    element->index = reflection->FieldSize(*message, element->field);
+    element->message = reflection->AddMessage(message, element->field);
+    if (chunk_bytes >= kChunkBytes) {
+      chunk_starts.push_back(i);
+      chunk_bytes = 0;
+    }
+    chunk_bytes += element->size;
+  }
+
+  ParseJob job(&elements, &chunk_starts, check_initialized);
+  if (!RunInParallel(executor, chunk_starts.size(), &job)) {
+    if (!job.missing_fields().empty()) {
+      LogMissingFields(*message, job.missing_fields());
+    }
+    return false;
+  }
+  return true;
+}
+
+// -------------------------------------------------------------------
+
+struct OutputElement {
+  const Message* message;
+  uint32 tag;
+  int size;       // Of the element itself, not counting its tag and length.
+  uint8* target;  // Where its tag goes.
+};
+
+class SizeJob : public ChunkedJob {
+ public:
+  explicit SizeJob(vector<OutputElement>* elements) : elements_(elements) {}
+
+  bool RunChunk(int chunk) {
+    int end = min<int>((chunk + 1) * kChunkElements, elements_->size());
+    for (int i = chunk * kChunkElements; i < end; i++) {
+      OutputElement* element = &(*elements_)[i];
+      element->size = element->message->ByteSize();
+    }
+    return true;
+  }
+
+ private:
+  vector<OutputElement>* elements_;
+};
+
+class WriteJob : public ChunkedJob {
+ public:
+  WriteJob(const vector<OutputElement>* elements,
+           const vector<int>* chunk_starts)
+    : elements_(elements),
+      chunk_starts_(chunk_starts) {}
+
+  bool RunChunk(int chunk) {
+    int end = chunk + 1 < chunk_starts_->size() ?
+        (*chunk_starts_)[chunk + 1] : elements_->size();
+    for (int i = (*chunk_starts_)[chunk]; i < end; i++) {
+      const OutputElement& element = (*elements_)[i];
+      uint8* target =
+          CodedOutputStream::WriteTagToArray(element.tag, element.target);
+      target = CodedOutputStream::WriteVarint32ToArray(element.size, target);
+      uint8* end = element.message->SerializeWithCachedSizesToArray(target);
+      GOOGLE_CHECK_EQ(end - target, element.size)
+          << "Byte size calculation and serialization were inconsistent.  "
+             "This may indicate a bug in protocol buffers or it may be "
+             "caused by concurrent modification of the message.";
+    }
+    return true;
+  }
+
+ private:
+  const vector<OutputElement>* elements_;
+  const vector<int>* chunk_starts_;
+};
+
+bool SerializeInParallel(const Message& message, rpc::Executor* executor,
+                         string* output) {
+  const Descriptor* descriptor = message.GetDescriptor();
+  const Reflection* reflection = message.GetReflection();
+  if (descriptor->options().message_set_wire_format()) {
+    return message.SerializePartialToString(output);
+  }
+
+  // Fields are written in the order ListFields() returns them, which is
+  // also the order SerializeWithCachedSizes() uses.
+  vector<const FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+
+  vector<OutputElement> elements;
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->is_extension() || !IsParallelField(field)) continue;
+    int count = reflection->FieldSize(message, field);
+    for (int j = 0; j < count; j++) {
+      OutputElement element;
+      element.message = &reflection->GetRepeatedMessage(message, field, j);
+      element.tag = WireFormat::MakeTag(field);
+      element.size = 0;
+      element.target = NULL;
+      elements.push_back(element);
+    }
+  }
+
+  SizeJob size_job(&elements);
+  RunInParallel(executor,
+                (elements.size() + kChunkElements - 1) / kChunkElements,
+                &size_job);
+
+  // Add up the sizes.  The other fields are measured here, which also
+  // caches the sizes of any messages inside them.
+  vector<int> field_sizes(fields.size(), 0);
+  int64 total_size = 0;
+  int next_element = 0;
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->is_extension() || !IsParallelField(field)) {
+      field_sizes[i] = WireFormat::FieldByteSize(field, message);
+      total_size += field_sizes[i];
+      continue;
+    }
+    int count = reflection->FieldSize(message, field);
+    for (int j = 0; j < count; j++) {
+      const OutputElement& element = elements[next_element++];
+      total_size += CodedOutputStream::VarintSize32(element.tag) +
+                    CodedOutputStream::VarintSize32(element.size) +
+                    element.size;
+    }
+  }
+  const UnknownFieldSet& unknown_fields = reflection->GetUnknownFields(message);
+  total_size += WireFormat::ComputeUnknownFieldsSize(unknown_fields);
+
+  if (total_size > kint32max) {
+    GOOGLE_LOG(ERROR) << "Message of type \"" << message.GetTypeName()
+                      << "\" is too large to serialize: " << total_size
+                      << " bytes.";
+    return false;
+  }
+
+  output->clear();
+  STLStringResizeUninitialized(output, total_size);
+  uint8* target = reinterpret_cast<uint8*>(string_as_array(output));
+
+  // Write the other fields here, and find where each element goes.
+  next_element = 0;
+  for (int i = 0; i < fields.size(); i++) {
+    const FieldDescriptor* field = fields[i];
+    if (field->is_extension() || !IsParallelField(field)) {
+      io::ArrayOutputStream array_output(target, field_sizes[i]);
+      io::CodedOutputStream coded_output(&array_output);
+      WireFormat::SerializeFieldWithCachedSizes(field, message, &coded_output);
+      GOOGLE_CHECK(!coded_output.HadError());
+      GOOGLE_CHECK_EQ(coded_output.ByteCount(), field_sizes[i]);
+      target += field_sizes[i];
+      continue;
+    }
+    int count = reflection->FieldSize(message, field);
+    for (int j = 0; j < count; j++) {
+      OutputElement* element = &elements[next_element++];
+      element->target = target;
+      target += CodedOutputStream::VarintSize32(element->tag) +
+                CodedOutputStream::VarintSize32(element->size) +
+                element->size;
+    }
+  }
+  WireFormat::SerializeUnknownFieldsToArray(unknown_fields, target);
+
+  vector<int> chunk_starts;
+  int chunk_bytes = kChunkBytes;
+  for (int i = 0; i < elements.size(); i++) {
+    if (chunk_bytes >= kChunkBytes) {
+      chunk_starts.push_back(i);
+      chunk_bytes = 0;
+    }
+    chunk_bytes += elements[i].size;
+  }
+
+  WriteJob write_job(&elements, &chunk_starts);
+  RunInParallel(executor, chunk_starts.size(), &write_job);
+  return true;
+}
+
+}  // namespace
+
+bool ParseParallel(const void* data, int size, Message* message,
+                   rpc::Executor* executor) {
+  return ParseParallel(data, size, message, executor, true);
+}
+
+bool ParsePartialParallel(const void* data, int size, Message* message,
+                          rpc::Executor* executor) {
+  return ParseParallel(data, size, message, executor, false);
+}
+
+bool SerializeParallel(const Message& message, rpc::Executor* executor,
+                       string* output) {
+  GOOGLE_DCHECK(message.IsInitialized())
+      << "Can't serialize message of type \"" << message.GetTypeName()
+      << "\" because it is missing required fields: "
+      << message.InitializationErrorString();
+  return SerializePartialParallel(message, executor, output);
+}
+
+bool SerializePartialParallel(const Message& message, rpc::Executor* executor,
+                              string* output) {
+  return SerializeInParallel(message, executor, output);
+}
+
+}  // namespace protobuf
+}  // namespace google
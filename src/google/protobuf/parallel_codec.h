@@ -0,0 +1,109 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Functions which spread the parsing or serialization of one large message
+// over several threads.  They are meant for messages made up mostly of one
+// long repeated field, such as a batch holding hundreds of thousands of
+// records:
+//   message Batch {
+//     repeated Record records = 1;
+//   }
+// which Message::ParseFromArray() parses on a single core.
+//
+// Each element of a repeated message field is length-delimited, so a quick
+// scan of the top-level message finds where every element begins and ends
+// without parsing it.  The elements are then added to the message up front
+// and parsed in chunks of roughly equal size, some on the calling thread and
+// the rest on the executor's threads.  The result is the same as that of
+// the equivalent ParseFromArray() call.
+//
+// Serialization works the other way around.  The sizes of the elements are
+// computed in parallel, which tells where in the output each element goes,
+// and then disjoint ranges of the output are written in parallel with
+// SerializeWithCachedSizesToArray().  The output is the same as that of
+// SerializeToString().
+//
+// These work with generated and dynamic messages alike, since they only
+// use reflection to find or add the elements.  Map fields, groups and
+// extensions are handled on the calling thread along with the rest of the
+// message.
+//
+// The total bytes limit of CodedInputStream applies to each element
+// separately rather than to the whole input, which is already in memory.
+//
+// This implementation requires pthreads.
+
+#ifndef GOOGLE_PROTOBUF_PARALLEL_CODEC_H__
+#define GOOGLE_PROTOBUF_PARALLEL_CODEC_H__
+
+#include <string>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+  class Message;                       // message.h
+  namespace rpc {
+    class Executor;                    // rpc/executor.h
+  }
+}
+
+namespace protobuf {
+
+// Like message->ParseFromArray(data, size), but parses the elements of the
+// message's repeated message fields on several threads.  The calling thread
+// parses chunks too, and only waits for chunks which other threads have
+// already started, so this may be called from one of the executor's own
+// threads.
+LIBPROTOBUF_EXPORT bool ParseParallel(const void* data, int size,
+                                      Message* message,
+                                      rpc::Executor* executor);
+
+// Like ParseParallel(), but doesn't check that required fields are set.
+LIBPROTOBUF_EXPORT bool ParsePartialParallel(const void* data, int size,
+                                             Message* message,
+                                             rpc::Executor* executor);
+
+// Like message.SerializeToString(output), but computes the sizes of the
+// elements of the message's repeated message fields, and writes them, on
+// several threads.  The message must not be modified until this returns.
+// Returns false if the message is too large to serialize.
+LIBPROTOBUF_EXPORT bool SerializeParallel(const Message& message,
+                                          rpc::Executor* executor,
+                                          string* output);
+
+// Like SerializeParallel(), but doesn't check that required fields are set.
+LIBPROTOBUF_EXPORT bool SerializePartialParallel(const Message& message,
+                                                 rpc::Executor* executor,
+                                                 string* output);
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_PARALLEL_CODEC_H__
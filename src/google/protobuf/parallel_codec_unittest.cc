@@ -0,0 +1,298 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/parallel_codec.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/rpc/executor.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/test_util.h>
+#include <google/protobuf/stubs/common.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+// Counts the tasks passed to another executor.
+class CountingExecutor : public rpc::Executor {
+ public:
+  explicit CountingExecutor(rpc::Executor* executor)
+    : executor_(executor), count_(0) {}
+
+  int count() const { return count_; }
+
+  // implements Executor ---------------------------------------------
+  void Add(Closure* task) {
+    ++count_;  // Only the calling thread adds tasks.
+    executor_->Add(task);
+  }
+  int num_threads() const { return executor_->num_threads(); }
+
+ private:
+  rpc::Executor* executor_;
+  int count_;
+};
+
+class ParallelCodecTest : public testing::Test {
+ protected:
+  ParallelCodecTest() : executor_(4) {}
+
+  // Builds a message whose repeated message fields are large enough to be
+  // split into many chunks.
+  virtual void SetUp() {
+    TestUtil::SetAllFields(&message_);
+    for (int i = 0; i < 20000; i++) {
+      message_.add_repeated_nested_message()->set_bb(i);
+      message_.add_repeated_foreign_message()->set_c(i * 7);
+    }
+    data_ = message_.SerializeAsString();
+  }
+
+  rpc::WorkStealingExecutor executor_;
+  unittest::TestAllTypes message_;
+  string data_;
+};
+
+TEST_F(ParallelCodecTest, Parse) {
+  unittest::TestAllTypes message;
+  ASSERT_TRUE(ParseParallel(data_.data(), data_.size(), &message,
+                            &executor_));
+  EXPECT_EQ(data_, message.SerializeAsString());
+
+  // Parsing again replaces the contents.
+  ASSERT_TRUE(ParseParallel(data_.data(), data_.size(), &message,
+                            &executor_));
+  EXPECT_EQ(data_, message.SerializeAsString());
+}
+
+TEST_F(ParallelCodecTest, OneTaskPerThread) {
+  // The message is split into many more chunks than there are threads.
+  for (int i = 0; i < 200000; i++) {
+    message_.add_repeated_nested_message()->set_bb(i);
+  }
+  data_ = message_.SerializeAsString();
+  ASSERT_GT(data_.size(), 16 * 64 << 10);
+
+  CountingExecutor executor(&executor_);
+  unittest::TestAllTypes message;
+  ASSERT_TRUE(ParseParallel(data_.data(), data_.size(), &message, &executor));
+  EXPECT_EQ(data_, message.SerializeAsString());
+  EXPECT_GT(executor.count(), 0);
+  EXPECT_LE(executor.count(), executor_.num_threads());
+
+  string output;
+  int count = executor.count();
+  ASSERT_TRUE(SerializeParallel(message, &executor, &output));
+  EXPECT_EQ(data_, output);
+  // Serializing computes sizes and writes in two parallel passes.
+  EXPECT_LE(executor.count() - count, 2 * executor_.num_threads());
+}
+
+TEST_F(ParallelCodecTest, ParseSmallMessage) {
+  unittest::TestAllTypes message;
+  TestUtil::SetAllFields(&message);
+  string data = message.SerializeAsString();
+
+  unittest::TestAllTypes parsed;
+  ASSERT_TRUE(ParseParallel(data.data(), data.size(), &parsed, &executor_));
+  TestUtil::ExpectAllFieldsSet(parsed);
+
+  ASSERT_TRUE(ParseParallel(NULL, 0, &parsed, &executor_));
+  EXPECT_EQ(0, parsed.ByteSize());
+}
+
+TEST_F(ParallelCodecTest, ParseDynamicMessage) {
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> message(
+      factory.GetPrototype(unittest::TestAllTypes::descriptor())->New());
+  ASSERT_TRUE(ParseParallel(data_.data(), data_.size(), message.get(),
+                            &executor_));
+  EXPECT_EQ(data_, message->SerializeAsString());
+}
+
+TEST_F(ParallelCodecTest, ParseFieldsSplitAcrossInput) {
+  // Elements of the same field need not be adjacent, and a singular field
+  // which appears more than once is merged as usual.
+  unittest::TestAllTypes first, second;
+  first.add_repeated_nested_message()->set_bb(1);
+  first.mutable_optional_nested_message()->set_bb(2);
+  second.add_repeated_nested_message()->set_bb(3);
+  second.set_optional_int32(4);
+  string data = first.SerializeAsString() + data_ + second.SerializeAsString();
+
+  unittest::TestAllTypes expected;
+  ASSERT_TRUE(expected.ParseFromString(data));
+  unittest::TestAllTypes message;
+  ASSERT_TRUE(ParseParallel(data.data(), data.size(), &message, &executor_));
+  EXPECT_EQ(expected.SerializeAsString(), message.SerializeAsString());
+}
+
+TEST_F(ParallelCodecTest, ParseMalformed) {
+  unittest::TestAllTypes message;
+  EXPECT_FALSE(ParseParallel(data_.data(), data_.size() - 1, &message,
+                             &executor_));
+
+  // Corrupt an element in the middle of the input.
+  string data = data_;
+  unittest::TestAllTypes::NestedMessage nested;
+  nested.set_bb(10000);
+  string element = nested.SerializeAsString();
+  string::size_type position = data.find(element);
+  ASSERT_NE(string::npos, position);
+  data[position] = 0;
+  EXPECT_FALSE(ParseParallel(data.data(), data.size(), &message, &executor_));
+}
+
+TEST_F(ParallelCodecTest, RequiredFields) {
+  unittest::TestRequiredForeign message;
+  for (int i = 0; i < 30000; i++) {
+    unittest::TestRequired* element = message.add_repeated_message();
+    element->set_a(i);
+    element->set_b(i);
+    element->set_c(i);
+  }
+  message.mutable_repeated_message(12345)->clear_b();
+  string data = message.SerializePartialAsString();
+
+  unittest::TestRequiredForeign parsed;
+  vector<string> errors;
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(ParseParallel(data.data(), data.size(), &parsed,
+                               &executor_));
+    errors = log.GetMessages(ERROR);
+  }
+  ASSERT_EQ(1, errors.size());
+  EXPECT_EQ("Can't parse message of type "
+            "\"protobuf_unittest.TestRequiredForeign\" because it is missing "
+            "required fields: repeated_message[12345].b",
+            errors[0]);
+
+  ASSERT_TRUE(ParsePartialParallel(data.data(), data.size(), &parsed,
+                                   &executor_));
+  EXPECT_EQ(data, parsed.SerializePartialAsString());
+
+  message.mutable_repeated_message(12345)->set_b(1);
+  data = message.SerializeAsString();
+  ASSERT_TRUE(ParseParallel(data.data(), data.size(), &parsed, &executor_));
+  EXPECT_EQ(data, parsed.SerializeAsString());
+}
+
+TEST_F(ParallelCodecTest, RequiredFieldsOutsideRepeatedFields) {
+  unittest::TestRequiredForeign message;
+  message.mutable_optional_message()->set_a(1);
+  string data = message.SerializePartialAsString();
+
+  unittest::TestRequiredForeign parsed;
+  vector<string> errors;
+  {
+    ScopedMemoryLog log;
+    EXPECT_FALSE(ParseParallel(data.data(), data.size(), &parsed,
+                               &executor_));
+    errors = log.GetMessages(ERROR);
+  }
+  ASSERT_EQ(1, errors.size());
+  EXPECT_EQ("Can't parse message of type "
+            "\"protobuf_unittest.TestRequiredForeign\" because it is missing "
+            "required fields: optional_message.b, optional_message.c",
+            errors[0]);
+}
+
+TEST_F(ParallelCodecTest, Serialize) {
+  string data;
+  ASSERT_TRUE(SerializeParallel(message_, &executor_, &data));
+  EXPECT_EQ(data_, data);
+
+  // Serializing again replaces the output.
+  ASSERT_TRUE(SerializeParallel(message_, &executor_, &data));
+  EXPECT_EQ(data_, data);
+}
+
+TEST_F(ParallelCodecTest, SerializeSmallMessage) {
+  unittest::TestAllTypes message;
+  string data = "garbage";
+  ASSERT_TRUE(SerializeParallel(message, &executor_, &data));
+  EXPECT_EQ("", data);
+
+  TestUtil::SetAllFields(&message);
+  ASSERT_TRUE(SerializeParallel(message, &executor_, &data));
+  EXPECT_EQ(message.SerializeAsString(), data);
+}
+
+TEST_F(ParallelCodecTest, SerializeDynamicMessage) {
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> message(
+      factory.GetPrototype(unittest::TestAllTypes::descriptor())->New());
+  ASSERT_TRUE(message->ParseFromString(data_));
+  string data;
+  ASSERT_TRUE(SerializeParallel(*message, &executor_, &data));
+  EXPECT_EQ(data_, data);
+}
+
+TEST_F(ParallelCodecTest, SerializeExtensionsAndUnknownFields) {
+  unittest::TestAllExtensions message;
+  TestUtil::SetAllExtensions(&message);
+  for (int i = 0; i < 5000; i++) {
+    message.AddExtension(unittest::repeated_nested_message_extension)
+        ->set_bb(i);
+  }
+  message.mutable_unknown_fields()->AddVarint(123456, 7);
+  message.mutable_unknown_fields()->AddLengthDelimited(123457, "unknown");
+
+  string data;
+  ASSERT_TRUE(SerializeParallel(message, &executor_, &data));
+  EXPECT_EQ(message.SerializeAsString(), data);
+}
+
+TEST_F(ParallelCodecTest, SerializePartial) {
+  unittest::TestRequiredForeign message;
+  for (int i = 0; i < 30000; i++) {
+    unittest::TestRequired* element = message.add_repeated_message();
+    element->set_a(i);
+    element->set_c(i);
+  }
+  message.set_dummy(5);
+  string data;
+  ASSERT_TRUE(SerializePartialParallel(message, &executor_, &data));
+  EXPECT_EQ(message.SerializePartialAsString(), data);
+
+  unittest::TestRequiredForeign parsed;
+  ASSERT_TRUE(ParsePartialParallel(data.data(), data.size(), &parsed,
+                                   &executor_));
+  EXPECT_EQ(data, parsed.SerializePartialAsString());
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
@@ -44,6 +44,8 @@ void RepeatedPtrFieldBase::Reserve(int new_size) {
 
   void** old_elements = elements_;
   total_size_ = max(total_size_ * 2, new_size);
+  internal::SampleAllocation(AllocationProfiler::REPEATED_ARRAY,
+                             total_size_ * sizeof(elements_[0]));
   elements_ = new void*[total_size_];
   memcpy(elements_, old_elements, allocated_size_ * sizeof(elements_[0]));
   if (old_elements != initial_space_) {
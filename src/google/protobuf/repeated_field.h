@@ -49,6 +49,7 @@
 #include <string>
 #include <iterator>
 #include <google/protobuf/stubs/common.h>
+#include <google/protobuf/allocation_profiler.h>
 #include <google/protobuf/message_lite.h>
 
 namespace google {
@@ -652,6 +653,8 @@ inline typename TypeHandler::Type* RepeatedPtrFieldBase::Add() {
   }
   if (allocated_size_ == total_size_) Reserve(total_size_ + 1);
   ++allocated_size_;
+  internal::SampleAllocation(AllocationProfiler::REPEATED_ELEMENT,
+                             sizeof(typename TypeHandler::Type));
   typename TypeHandler::Type* result = TypeHandler::New();
   elements_[current_size_++] = result;
   return result;
@@ -40,6 +40,7 @@
 #include <vector>
 
 #include <google/protobuf/repeated_field.h>
+#include <google/protobuf/repeated_string_piece_field.h>
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/unittest.pb.h>
@@ -547,6 +548,133 @@ TEST(RepeatedPtrField, MutableDataIsMutable) {
   EXPECT_EQ("2", field.Get(0));
 }
 
+// ===================================================================
+// Tests for RepeatedStringPieceField.
+
+TEST(RepeatedStringPieceField, Small) {
+  RepeatedStringPieceField field;
+
+  EXPECT_EQ(field.size(), 0);
+
+  field.Add("foo");
+  EXPECT_EQ(field.size(), 1);
+  EXPECT_EQ("foo", field.Get(0).ToString());
+
+  field.Add(string("ba\0r", 4));
+  field.Add("");
+  EXPECT_EQ(field.size(), 3);
+  EXPECT_EQ("foo", field.Get(0).ToString());
+  EXPECT_EQ(string("ba\0r", 4), field.Get(1).ToString());
+  EXPECT_TRUE(field.Get(2).empty());
+  EXPECT_EQ(7, field.bytes_size());
+
+  field.RemoveLast();
+  field.RemoveLast();
+  EXPECT_EQ(field.size(), 1);
+  EXPECT_EQ(3, field.bytes_size());
+
+  field.Clear();
+  EXPECT_EQ(field.size(), 0);
+  EXPECT_EQ(0, field.bytes_size());
+}
+
+TEST(RepeatedStringPieceField, Large) {
+  RepeatedStringPieceField field;
+
+  for (int i = 0; i < 1000; i++) {
+    field.Add(SimpleItoa(i));
+  }
+
+  ASSERT_EQ(field.size(), 1000);
+  for (int i = 0; i < 1000; i++) {
+    EXPECT_EQ(SimpleItoa(i), field.Get(i).ToString());
+  }
+}
+
+TEST(RepeatedStringPieceField, Set) {
+  RepeatedStringPieceField field;
+  field.Add("a");
+  field.Add("bb");
+  field.Add("ccc");
+
+  // Longer, shorter, then the same length.
+  field.Set(0, "xxxx");
+  field.Set(1, "");
+  field.Set(2, "yyy");
+  EXPECT_EQ("xxxx", field.Get(0).ToString());
+  EXPECT_EQ("", field.Get(1).ToString());
+  EXPECT_EQ("yyy", field.Get(2).ToString());
+  EXPECT_EQ(7, field.bytes_size());
+}
+
+TEST(RepeatedStringPieceField, AddAndSetFromSelf) {
+  // Values may come from the field itself, even if it has to grow.
+  RepeatedStringPieceField field;
+  field.Add("abcdefgh");
+  for (int i = 0; i < 10; i++) {
+    field.Add(field.Get(field.size() - 1));
+  }
+  EXPECT_EQ(11, field.size());
+  EXPECT_EQ("abcdefgh", field.Get(10).ToString());
+
+  field.Set(0, field.Get(5));
+  field.Set(1, StringPiece(field.Get(2).data(), 3));
+  EXPECT_EQ("abcdefgh", field.Get(0).ToString());
+  EXPECT_EQ("abc", field.Get(1).ToString());
+}
+
+TEST(RepeatedStringPieceField, SwapElements) {
+  RepeatedStringPieceField field;
+  field.Add("ab");
+  field.Add("cd");
+  field.Add("efghi");
+
+  field.SwapElements(0, 1);
+  EXPECT_EQ("cd", field.Get(0).ToString());
+  EXPECT_EQ("ab", field.Get(1).ToString());
+
+  field.SwapElements(0, 2);
+  EXPECT_EQ("efghi", field.Get(0).ToString());
+  EXPECT_EQ("ab", field.Get(1).ToString());
+  EXPECT_EQ("cd", field.Get(2).ToString());
+}
+
+TEST(RepeatedStringPieceField, MergeFromAndSwap) {
+  RepeatedStringPieceField source, destination;
+  source.Add("4");
+  source.Add("56");
+  destination.Add("1");
+  destination.Add("23");
+
+  destination.MergeFrom(source);
+  ASSERT_EQ(4, destination.size());
+  EXPECT_EQ("1", destination.Get(0).ToString());
+  EXPECT_EQ("23", destination.Get(1).ToString());
+  EXPECT_EQ("4", destination.Get(2).ToString());
+  EXPECT_EQ("56", destination.Get(3).ToString());
+
+  source.Swap(&destination);
+  EXPECT_EQ(4, source.size());
+  EXPECT_EQ(2, destination.size());
+  EXPECT_EQ("56", source.Get(3).ToString());
+  EXPECT_EQ("56", destination.Get(1).ToString());
+}
+
+TEST(RepeatedStringPieceField, ClearKeepsSpace) {
+  RepeatedStringPieceField field;
+  field.Reserve(100, 1000);
+  int space_used = field.SpaceUsedExcludingSelf();
+  EXPECT_LE(1000, space_used);
+
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 100; i++) {
+      field.Add("0123456789");
+    }
+    EXPECT_EQ(space_used, field.SpaceUsedExcludingSelf());
+    field.Clear();
+  }
+}
+
 // ===================================================================
 
 // Iterator tests stolen from net/proto/proto-array_unittest.
@@ -0,0 +1,144 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/repeated_string_piece_field.h>
+
+#include <algorithm>
+
+#include <google/protobuf/allocation_profiler.h>
+
+namespace google {
+namespace protobuf {
+
+RepeatedStringPieceField::RepeatedStringPieceField()
+  : bytes_(NULL),
+    bytes_size_(0),
+    bytes_capacity_(0) {}
+
+RepeatedStringPieceField::~RepeatedStringPieceField() {
+  delete [] bytes_;
+}
+
+void RepeatedStringPieceField::Add(const char* value, int size) {
+  if (value >= bytes_ && value < bytes_ + bytes_size_) {
+    // Growing the buffer would free the value out from under us.
+    int offset = value - bytes_;
+    ReserveBytes(bytes_size_ + size);
+    char* target = AddUninitialized(size);
+    memcpy(target, bytes_ + offset, size);
+  } else {
+    memcpy(AddUninitialized(size), value, size);
+  }
+}
+
+void RepeatedStringPieceField::Set(int index, const char* value, int size) {
+  if (value >= bytes_ && value < bytes_ + bytes_size_) {
+    // The value may be moved by the splice below.
+    string copy(value, size);
+    Set(index, copy.data(), size);
+    return;
+  }
+
+  int begin = start(index);
+  int old_end = ends_.Get(index);
+  int delta = size - (old_end - begin);
+  if (delta != 0) {
+    // Shift everything after the element to make it the right size.
+    if (delta > 0) ReserveBytes(bytes_size_ + delta);
+    memmove(bytes_ + old_end + delta, bytes_ + old_end, bytes_size_ - old_end);
+    bytes_size_ += delta;
+    for (int i = index; i < ends_.size(); i++) {
+      ends_.Set(i, ends_.Get(i) + delta);
+    }
+  }
+  memcpy(bytes_ + begin, value, size);
+}
+
+void RepeatedStringPieceField::MergeFrom(
+    const RepeatedStringPieceField& other) {
+  GOOGLE_CHECK_NE(&other, this);
+  if (other.size() == 0) return;
+  Reserve(size() + other.size(), bytes_size_ + other.bytes_size_);
+  memcpy(bytes_ + bytes_size_, other.bytes_, other.bytes_size_);
+  for (int i = 0; i < other.size(); i++) {
+    ends_.AddAlreadyReserved(bytes_size_ + other.ends_.Get(i));
+  }
+  bytes_size_ += other.bytes_size_;
+}
+
+void RepeatedStringPieceField::Reserve(int new_size, int new_bytes) {
+  ends_.Reserve(new_size);
+  ReserveBytes(new_bytes);
+}
+
+void RepeatedStringPieceField::Swap(RepeatedStringPieceField* other) {
+  std::swap(bytes_, other->bytes_);
+  std::swap(bytes_size_, other->bytes_size_);
+  std::swap(bytes_capacity_, other->bytes_capacity_);
+  ends_.Swap(&other->ends_);
+}
+
+void RepeatedStringPieceField::SwapElements(int index1, int index2) {
+  if (index1 == index2) return;
+  StringPiece value1 = Get(index1);
+  StringPiece value2 = Get(index2);
+  if (value1.size() == value2.size()) {
+    // Same size, so the elements can be swapped in place.
+    char* data1 = bytes_ + start(index1);
+    char* data2 = bytes_ + start(index2);
+    for (int i = 0; i < value1.size(); i++) {
+      std::swap(data1[i], data2[i]);
+    }
+  } else {
+    string copy1 = value1.ToString();
+    string copy2 = value2.ToString();
+    Set(index1, copy2.data(), copy2.size());
+    Set(index2, copy1.data(), copy1.size());
+  }
+}
+
+int RepeatedStringPieceField::SpaceUsedExcludingSelf() const {
+  return bytes_capacity_ + ends_.SpaceUsedExcludingSelf();
+}
+
+void RepeatedStringPieceField::ReserveBytes(int new_bytes) {
+  if (bytes_capacity_ >= new_bytes) return;
+
+  char* old_bytes = bytes_;
+  bytes_capacity_ = max(bytes_capacity_ * 2, new_bytes);
+  internal::SampleAllocation(AllocationProfiler::REPEATED_ARRAY,
+                             bytes_capacity_);
+  bytes_ = new char[bytes_capacity_];
+  memcpy(bytes_, old_bytes, bytes_size_);
+  delete [] old_bytes;
+}
+
+}  // namespace protobuf
+}  // namespace google
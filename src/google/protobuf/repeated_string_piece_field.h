@@ -0,0 +1,134 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// RepeatedStringPieceField is the storage generated code uses for repeated
+// string and bytes fields with ctype=STRING_PIECE, e.g.:
+//   repeated string keywords = 1 [ctype = STRING_PIECE];
+//
+// A RepeatedPtrField<string> allocates a string object, and usually a
+// buffer for its contents, per element.  A RepeatedStringPieceField keeps
+// all of its elements back to back in one buffer, with an array of offsets
+// saying where each ends, so that a long list of short strings costs two
+// allocations rather than thousands.  Parsing copies each element straight
+// from the input into the buffer, and Clear() keeps both arrays for reuse.
+//
+// Elements are read as StringPieces which point into the buffer.  Adding,
+// setting or removing elements may move the buffer, so a StringPiece is only
+// valid until the field is next modified.  Set() and SwapElements() on
+// elements of different lengths have to move every element after them, so
+// they take time linear in the size of the field; build fields with Add().
+
+#ifndef GOOGLE_PROTOBUF_REPEATED_STRING_PIECE_FIELD_H__
+#define GOOGLE_PROTOBUF_REPEATED_STRING_PIECE_FIELD_H__
+
+#include <string>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stringpiece.h>
+#include <google/protobuf/repeated_field.h>
+
+namespace google {
+namespace protobuf {
+
+class LIBPROTOBUF_EXPORT RepeatedStringPieceField {
+ public:
+  RepeatedStringPieceField();
+  ~RepeatedStringPieceField();
+
+  int size() const { return ends_.size(); }
+
+  StringPiece Get(int index) const;
+  void Set(int index, const char* value, int size);
+  void Set(int index, const StringPiece& value) {
+    Set(index, value.data(), value.size());
+  }
+  void Add(const char* value, int size);
+  void Add(const StringPiece& value) { Add(value.data(), value.size()); }
+  // Adds an element of the given size and returns its bytes for the caller
+  // to fill in.  The pointer is valid until the field is next modified.
+  char* AddUninitialized(int size);
+  void RemoveLast();
+  void Clear();
+  void MergeFrom(const RepeatedStringPieceField& other);
+
+  // Makes room for the field to grow to the given number of elements,
+  // holding the given total number of bytes, without allocating again.
+  void Reserve(int new_size, int new_bytes);
+
+  void Swap(RepeatedStringPieceField* other);
+  void SwapElements(int index1, int index2);
+
+  // Total size of all elements, in bytes.
+  int bytes_size() const { return bytes_size_; }
+
+  // Returns the number of bytes used by the field, excluding sizeof(*this).
+  int SpaceUsedExcludingSelf() const;
+
+ private:
+  char* bytes_;        // All elements, back to back.
+  int bytes_size_;
+  int bytes_capacity_;
+  RepeatedField<int> ends_;  // The offset just past each element.
+
+  int start(int index) const { return index == 0 ? 0 : ends_.Get(index - 1); }
+  void ReserveBytes(int new_bytes);
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(RepeatedStringPieceField);
+};
+
+// implementation ====================================================
+
+inline StringPiece RepeatedStringPieceField::Get(int index) const {
+  int begin = start(index);
+  return StringPiece(bytes_ + begin, ends_.Get(index) - begin);
+}
+
+inline char* RepeatedStringPieceField::AddUninitialized(int size) {
+  if (bytes_capacity_ - bytes_size_ < size) ReserveBytes(bytes_size_ + size);
+  char* result = bytes_ + bytes_size_;
+  bytes_size_ += size;
+  ends_.Add(bytes_size_);
+  return result;
+}
+
+inline void RepeatedStringPieceField::RemoveLast() {
+  GOOGLE_DCHECK_GT(size(), 0);
+  bytes_size_ = start(size() - 1);
+  ends_.RemoveLast();
+}
+
+inline void RepeatedStringPieceField::Clear() {
+  bytes_size_ = 0;
+  ends_.Clear();
+}
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_REPEATED_STRING_PIECE_FIELD_H__
@@ -0,0 +1,364 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Counts the heap allocations made per callback and per in-process RPC, and
+// times them, comparing NewCallback() with the closures in closure_pool.h.
+// Usage:
+//   callback-benchmark [call_count]
+// Each result is printed on one line of "name=value" pairs.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <new>
+
+#include <google/protobuf/rpc/executor.h>
+#include <google/protobuf/rpc/local_rpc_channel.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/stubs/closure_pool.h>
+#include <google/protobuf/stubs/common.h>
+
+// Every allocation in the process goes through these, so that the benchmark
+// can count them.
+namespace {
+volatile long allocation_count = 0;
+
+inline void CountAllocation() {
+#ifdef __GNUC__
+  __sync_fetch_and_add(&allocation_count, 1);
+#else
+  ++allocation_count;
+#endif
+}
+
+void* Allocate(size_t size) {
+  CountAllocation();
+  void* result = malloc(size == 0 ? 1 : size);
+  if (result == NULL) throw std::bad_alloc();
+  return result;
+}
+}  // namespace
+
+void* operator new(size_t size) { return Allocate(size); }
+void* operator new[](size_t size) { return Allocate(size); }
+void operator delete(void* pointer) throw() { free(pointer); }
+void operator delete[](void* pointer) throw() { free(pointer); }
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+namespace {
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// Accumulates the allocations and time of one measurement.
+class Measurement {
+ public:
+  explicit Measurement(int count)
+    : count_(count), allocations_(allocation_count), start_(Now()) {}
+
+  // Prints the results, preceded by "labels".
+  void Report(const char* labels) {
+    double elapsed = Now() - start_;
+    long allocations = allocation_count - allocations_;
+    printf("%s calls=%d allocations_per_call=%.2f ns_per_call=%.1f\n",
+           labels, count_, static_cast<double>(allocations) / count_,
+           elapsed / count_ * 1e9);
+  }
+
+ private:
+  int count_;
+  long allocations_;
+  double start_;
+};
+
+int counter = 0;
+
+void Increment(int* value) { ++*value; }
+
+// -------------------------------------------------------------------
+
+void BenchmarkClosures(int count) {
+  // Warm up the free list.
+  NewPooledCallback(&Increment, &counter)->Run();
+
+  {
+    Measurement measurement(count);
+    for (int i = 0; i < count; i++) {
+      NewCallback(&Increment, &counter)->Run();
+    }
+    measurement.Report("kind=closure closure=NewCallback");
+  }
+  {
+    Measurement measurement(count);
+    for (int i = 0; i < count; i++) {
+      NewPooledCallback(&Increment, &counter)->Run();
+    }
+    measurement.Report("kind=closure closure=NewPooledCallback");
+  }
+  {
+    ClosureStorage storage;
+    Measurement measurement(count);
+    for (int i = 0; i < count; i++) {
+      NewCallbackIn(&storage, &Increment, &counter)->Run();
+    }
+    measurement.Report("kind=closure closure=NewCallbackIn");
+  }
+}
+
+// -------------------------------------------------------------------
+
+// Builds an EchoService whose one method takes and returns an empty
+// message.
+const FileDescriptor* BuildEchoFile(DescriptorPool* pool) {
+  FileDescriptorProto file;
+  file.set_name("callback_benchmark.proto");
+  file.set_package("callback_benchmark");
+  file.add_message_type()->set_name("Empty");
+
+  ServiceDescriptorProto* service = file.add_service();
+  service->set_name("EchoService");
+  MethodDescriptorProto* method = service->add_method();
+  method->set_name("Echo");
+  method->set_input_type(".callback_benchmark.Empty");
+  method->set_output_type(".callback_benchmark.Empty");
+
+  return pool->BuildFile(file);
+}
+
+class EchoService : public Service {
+ public:
+  EchoService(const ServiceDescriptor* descriptor, const Message* prototype)
+    : descriptor_(descriptor), prototype_(prototype) {}
+
+  // implements Service ----------------------------------------------
+
+  const ServiceDescriptor* GetDescriptor() { return descriptor_; }
+
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done) {
+    done->Run();
+  }
+
+  const Message& GetRequestPrototype(const MethodDescriptor* method) const {
+    return *prototype_;
+  }
+  const Message& GetResponsePrototype(const MethodDescriptor* method) const {
+    return *prototype_;
+  }
+
+ private:
+  const ServiceDescriptor* descriptor_;
+  const Message* prototype_;
+};
+
+// Lets the main thread wait for a callback run by another thread.
+class Waiter {
+ public:
+  Waiter() : signaled_(false) {
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&cond_, NULL);
+  }
+  ~Waiter() {
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  void Signal() {
+    pthread_mutex_lock(&mutex_);
+    signaled_ = true;
+    pthread_cond_signal(&cond_);
+    pthread_mutex_unlock(&mutex_);
+  }
+
+  void Wait() {
+    pthread_mutex_lock(&mutex_);
+    while (!signaled_) pthread_cond_wait(&cond_, &mutex_);
+    signaled_ = false;
+    pthread_mutex_unlock(&mutex_);
+  }
+
+ private:
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+  bool signaled_;
+};
+
+enum DoneKind {
+  DONE_NEW_CALLBACK,
+  DONE_POOLED,
+  DONE_IN_STORAGE
+};
+
+const char* const kDoneKindNames[] = {
+  "NewCallback", "NewPooledCallback", "NewCallbackIn"
+};
+
+const char* const kModeNames[] = { "share", "copy", "serialize" };
+
+// Makes calls one after another through a LocalRpcChannel, creating each
+// call's "done" as "done_kind" says.
+class CallLoop {
+ public:
+  CallLoop(LocalRpcChannel* channel, bool wait,
+           const MethodDescriptor* method, const Message& prototype,
+           DoneKind done_kind)
+    : channel_(channel), wait_(wait), method_(method),
+      request_(prototype.New()), response_(prototype.New()),
+      done_kind_(done_kind) {}
+
+  void Run(int count) {
+    for (int i = 0; i < count; i++) {
+      controller_.Reset();
+      channel_->CallMethod(method_, &controller_, request_.get(),
+                           response_.get(), NewDone());
+      if (wait_) waiter_.Wait();
+      GOOGLE_CHECK(!controller_.Failed()) << controller_.ErrorText();
+    }
+  }
+
+ private:
+  Closure* NewDone() {
+    // If waiting, "done" wakes us up; otherwise it runs before CallMethod()
+    // returns.
+    if (wait_) {
+      switch (done_kind_) {
+        case DONE_NEW_CALLBACK:
+          return NewCallback(&waiter_, &Waiter::Signal);
+        case DONE_POOLED:
+          return NewPooledCallback(&waiter_, &Waiter::Signal);
+        case DONE_IN_STORAGE:
+          return NewCallbackIn(&storage_, &waiter_, &Waiter::Signal);
+      }
+    } else {
+      switch (done_kind_) {
+        case DONE_NEW_CALLBACK:
+          return NewCallback(&Increment, &counter);
+        case DONE_POOLED:
+          return NewPooledCallback(&Increment, &counter);
+        case DONE_IN_STORAGE:
+          return NewCallbackIn(&storage_, &Increment, &counter);
+      }
+    }
+    GOOGLE_LOG(FATAL) << "Can't get here.";
+    return NULL;
+  }
+
+  LocalRpcChannel* channel_;
+  bool wait_;
+  const MethodDescriptor* method_;
+  scoped_ptr<Message> request_;
+  scoped_ptr<Message> response_;
+  DoneKind done_kind_;
+  LocalRpcController controller_;
+  Waiter waiter_;
+  ClosureStorage storage_;
+};
+
+void BenchmarkCalls(const char* executor_name, LocalRpcChannel* channel,
+                    LocalRpcChannel::HandoffMode mode, bool wait,
+                    const MethodDescriptor* method, const Message& prototype,
+                    DoneKind done_kind, int count) {
+  CallLoop loop(channel, wait, method, prototype, done_kind);
+  // Warm up the free lists.
+  loop.Run(100);
+
+  Measurement measurement(count);
+  loop.Run(count);
+
+  char labels[200];
+  snprintf(labels, sizeof(labels),
+           "kind=local_rpc executor=%s mode=%s done=%s",
+           executor_name, kModeNames[mode], kDoneKindNames[done_kind]);
+  measurement.Report(labels);
+}
+
+int Main(int argc, char* argv[]) {
+  int count = argc > 1 ? atoi(argv[1]) : 1000000;
+  if (count <= 0) {
+    fprintf(stderr, "Usage: %s [call_count]\n", argv[0]);
+    return 1;
+  }
+
+  BenchmarkClosures(count);
+
+  DescriptorPool pool;
+  const FileDescriptor* file = BuildEchoFile(&pool);
+  GOOGLE_CHECK(file != NULL);
+  DynamicMessageFactory factory(&pool);
+  const Message* prototype = factory.GetPrototype(file->message_type(0));
+  const MethodDescriptor* method = file->service(0)->method(0);
+  EchoService service(file->service(0), prototype);
+
+  WorkStealingExecutor executor(1);
+  LocalRpcChannel::HandoffMode modes[] = {
+    LocalRpcChannel::SHARE, LocalRpcChannel::COPY, LocalRpcChannel::SERIALIZE
+  };
+  DoneKind done_kinds[] = { DONE_NEW_CALLBACK, DONE_POOLED, DONE_IN_STORAGE };
+
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(modes); i++) {
+    LocalRpcChannel inline_channel(NULL, modes[i]);
+    inline_channel.RegisterService(&service);
+    LocalRpcChannel executor_channel(&executor, modes[i]);
+    executor_channel.RegisterService(&service);
+
+    for (int j = 0; j < GOOGLE_ARRAYSIZE(done_kinds); j++) {
+      BenchmarkCalls("none", &inline_channel, modes[i], false, method,
+                     *prototype, done_kinds[j], count);
+    }
+    // Every call hops to the executor's thread and back, so make fewer.
+    for (int j = 0; j < GOOGLE_ARRAYSIZE(done_kinds); j++) {
+      BenchmarkCalls("work_stealing", &executor_channel, modes[i], true,
+                     method, *prototype, done_kinds[j], count / 10);
+    }
+  }
+
+  return 0;
+}
+
+}  // namespace
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  return google::protobuf::rpc::Main(argc, argv);
+}
@@ -0,0 +1,303 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/rpc/executor.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include <deque>
+#include <vector>
+
+#include <google/protobuf/stubs/once.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+Executor::~Executor() {}
+
+// ===================================================================
+
+// Identifies the worker running on the current thread, if any.  The key is
+// shared by all executors, so check the worker's owner before using it.
+static pthread_key_t current_worker_key;
+GOOGLE_PROTOBUF_DECLARE_ONCE(current_worker_key_once);
+
+static void InitCurrentWorkerKey() {
+  pthread_key_create(&current_worker_key, NULL);
+}
+
+// Adds "increment" to *value and returns the result, as one atomic
+// operation with a full memory barrier.  An increment of zero just reads.
+static inline int AtomicAdd(volatile int* value, int increment) {
+  return __sync_add_and_fetch(value, increment);
+}
+
+// State shared by all of the workers.  Adding and taking a task only locks
+// the queue involved and updates "queued"; "mutex" is taken only by workers
+// going to sleep and by Add() when there is one to wake up.
+struct WorkStealingExecutor::State {
+  // Number of tasks pushed onto a queue and not yet taken from one.  Add()
+  // counts a task after pushing it, so a worker which sees a positive count
+  // can find the task; the count is briefly negative if the task is taken
+  // before it is counted.  Atomic.
+  volatile int queued;
+  // Number of workers in "idle".  Atomic; changed only under "mutex".
+  volatile int idle;
+  // Queue that the next task added from outside goes on.  Atomic.
+  volatile int next_worker;
+
+  Mutex mutex;
+  // Workers which are sleeping, or about to.  Protected by "mutex".
+  vector<Worker*> idle_workers;
+  bool shutting_down;  // Protected by "mutex".
+};
+
+class WorkStealingExecutor::Worker {
+ public:
+  Worker(WorkStealingExecutor* owner, int index)
+    : owner_(owner), index_(index) {
+    if (pipe(wakeup_pipe_) != 0) {
+      GOOGLE_LOG(FATAL) << "pipe: " << strerror(errno);
+    }
+  }
+
+  ~Worker() {
+    close(wakeup_pipe_[0]);
+    close(wakeup_pipe_[1]);
+  }
+
+  void Start() {
+    int result = pthread_create(&thread_, NULL, &Worker::ThreadMain, this);
+    if (result != 0) {
+      GOOGLE_LOG(FATAL) << "pthread_create: " << strerror(result);
+    }
+  }
+
+  void Join() { pthread_join(thread_, NULL); }
+
+  // Queue operations.  Tasks are pushed at the back.  The owning thread pops
+  // from the back; other threads steal from the front.
+  void Push(Closure* task) {
+    MutexLock lock(&mutex_);
+    tasks_.push_back(task);
+  }
+  Closure* PopNewest() {
+    MutexLock lock(&mutex_);
+    if (tasks_.empty()) return NULL;
+    Closure* task = tasks_.back();
+    tasks_.pop_back();
+    return task;
+  }
+  Closure* StealOldest() {
+    MutexLock lock(&mutex_);
+    if (tasks_.empty()) return NULL;
+    Closure* task = tasks_.front();
+    tasks_.pop_front();
+    return task;
+  }
+
+  // Wakes the worker from Sleep(), or keeps its next Sleep() from sleeping.
+  // Called once for each time the worker is taken off the idle list by
+  // another thread.
+  void WakeUp() {
+    char byte = 0;
+    while (write(wakeup_pipe_[1], &byte, 1) < 0 && errno == EINTR) {}
+  }
+
+  WorkStealingExecutor* owner() const { return owner_; }
+  int index() const { return index_; }
+
+ private:
+  static void* ThreadMain(void* arg) {
+    Worker* worker = reinterpret_cast<Worker*>(arg);
+    pthread_setspecific(current_worker_key, worker);
+    worker->Run();
+    return NULL;
+  }
+
+  void Run() {
+    State* state = owner_->state_;
+    while (true) {
+      Closure* task = owner_->TakeTask(this);
+      if (task != NULL) {
+        task->Run();
+        continue;
+      }
+
+      {
+        MutexLock lock(&state->mutex);
+        if (state->shutting_down) {
+          // Only the executor's own tasks can add more now, and they add
+          // them to their own queues, so the count only has to be checked
+          // once all of those are done.
+          if (AtomicAdd(&state->queued, 0) <= 0) return;
+          continue;
+        }
+        state->idle_workers.push_back(this);
+        AtomicAdd(&state->idle, 1);
+      }
+
+      // An Add() which counted its task before we went on the idle list may
+      // not have seen us there, but then we see its task here.  If someone
+      // else has already taken us off the list, Sleep() just consumes their
+      // wakeup.
+      if (AtomicAdd(&state->queued, 0) <= 0 || !owner_->RemoveIdle(this)) {
+        Sleep();
+      }
+    }
+  }
+
+  void Sleep() {
+    char byte;
+    while (read(wakeup_pipe_[0], &byte, 1) < 0 && errno == EINTR) {}
+  }
+
+  WorkStealingExecutor* owner_;
+  int index_;
+  pthread_t thread_;
+
+  Mutex mutex_;
+  deque<Closure*> tasks_;
+
+  int wakeup_pipe_[2];
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Worker);
+};
+
+// -------------------------------------------------------------------
+
+WorkStealingExecutor::WorkStealingExecutor(int num_threads)
+  : state_(new State) {
+  GOOGLE_CHECK_GT(num_threads, 0);
+  ::google::protobuf::GoogleOnceInit(&current_worker_key_once,
+                                     &InitCurrentWorkerKey);
+
+  state_->queued = 0;
+  state_->idle = 0;
+  state_->next_worker = 0;
+  state_->shutting_down = false;
+
+  // Workers look at each other's queues, so create them all before starting
+  // any.
+  for (int i = 0; i < num_threads; i++) {
+    workers_.push_back(new Worker(this, i));
+  }
+  for (int i = 0; i < num_threads; i++) {
+    workers_[i]->Start();
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  GOOGLE_CHECK(pthread_getspecific(current_worker_key) == NULL ||
+               reinterpret_cast<Worker*>(
+                 pthread_getspecific(current_worker_key))->owner() != this)
+    << "A WorkStealingExecutor cannot be destroyed by one of its own tasks.";
+
+  {
+    MutexLock lock(&state_->mutex);
+    state_->shutting_down = true;
+    for (int i = 0; i < state_->idle_workers.size(); i++) {
+      state_->idle_workers[i]->WakeUp();
+    }
+    AtomicAdd(&state_->idle, -static_cast<int>(state_->idle_workers.size()));
+    state_->idle_workers.clear();
+  }
+
+  for (int i = 0; i < workers_.size(); i++) {
+    workers_[i]->Join();
+  }
+  for (int i = 0; i < workers_.size(); i++) {
+    delete workers_[i];
+  }
+  delete state_;
+}
+
+void WorkStealingExecutor::Add(Closure* task) {
+  Worker* current =
+    reinterpret_cast<Worker*>(pthread_getspecific(current_worker_key));
+
+  Worker* target;
+  if (current != NULL && current->owner() == this) {
+    target = current;
+  } else {
+    unsigned int next = AtomicAdd(&state_->next_worker, 1);
+    target = workers_[next % workers_.size()];
+  }
+  target->Push(task);
+  AtomicAdd(&state_->queued, 1);
+
+  // A worker which goes idle after the count above sees the task itself, so
+  // only one which was already idle needs waking.
+  if (AtomicAdd(&state_->idle, 0) > 0) {
+    Worker* idle_worker = NULL;
+    {
+      MutexLock lock(&state_->mutex);
+      if (!state_->idle_workers.empty()) {
+        idle_worker = state_->idle_workers.back();
+        state_->idle_workers.pop_back();
+        AtomicAdd(&state_->idle, -1);
+      }
+    }
+    if (idle_worker != NULL) idle_worker->WakeUp();
+  }
+}
+
+int WorkStealingExecutor::num_threads() const {
+  return workers_.size();
+}
+
+Closure* WorkStealingExecutor::TakeTask(Worker* worker) {
+  Closure* task = worker->PopNewest();
+  for (int i = 1; task == NULL && i < workers_.size(); i++) {
+    task = workers_[(worker->index() + i) % workers_.size()]->StealOldest();
+  }
+  if (task != NULL) AtomicAdd(&state_->queued, -1);
+  return task;
+}
+
+bool WorkStealingExecutor::RemoveIdle(Worker* worker) {
+  MutexLock lock(&state_->mutex);
+  vector<Worker*>* idle_workers = &state_->idle_workers;
+  for (int i = 0; i < idle_workers->size(); i++) {
+    if ((*idle_workers)[i] == worker) {
+      idle_workers->erase(idle_workers->begin() + i);
+      AtomicAdd(&state_->idle, -1);
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,115 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Executors run closures on some set of threads.  WorkStealingExecutor is a
+// fixed-size thread pool meant for short tasks which themselves queue more
+// tasks, such as RPCs made from inside RPC handlers.
+//
+// This implementation requires pthreads.
+
+#ifndef GOOGLE_PROTOBUF_RPC_EXECUTOR_H__
+#define GOOGLE_PROTOBUF_RPC_EXECUTOR_H__
+
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+// Defined in this file.
+class Executor;
+class WorkStealingExecutor;
+
+// Abstract interface for something that runs closures.
+class LIBPROTOBUF_EXPORT Executor {
+ public:
+  inline Executor() {}
+  virtual ~Executor();
+
+  // Arranges for task->Run() to be called, possibly on another thread and
+  // possibly before Add() returns.  The task must clean up after itself when
+  // run, i.e. it must have been created with NewCallback() (or one of the
+  // functions in closure_pool.h) rather than NewPermanentCallback().  May
+  // be called from any thread.
+  virtual void Add(Closure* task) = 0;
+
+  // Returns how many tasks the executor can run at once.  Callers which
+  // split work into tasks use it to avoid queuing more tasks than can make
+  // progress.
+  virtual int num_threads() const = 0;
+
+ private:
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Executor);
+};
+
+// Runs tasks on a fixed number of threads.  Each thread has its own queue.
+// A task added from one of the executor's own threads goes on that thread's
+// queue, and each thread runs the newest task on its own queue first, so a
+// chain of calls tends to stay on one thread, with warm caches.  A thread
+// whose queue is empty takes the oldest task from another thread's queue.
+// Tasks added from outside are spread over the queues in turn.
+class LIBPROTOBUF_EXPORT WorkStealingExecutor : public Executor {
+ public:
+  // Starts "num_threads" threads.  num_threads must be positive.
+  explicit WorkStealingExecutor(int num_threads);
+
+  // Runs every task already queued, along with any tasks those tasks add,
+  // then stops the threads.  Must not be called from one of the executor's
+  // own threads.
+  ~WorkStealingExecutor();
+
+  // implements Executor ---------------------------------------------
+  void Add(Closure* task);
+  int num_threads() const;
+
+ private:
+  class Worker;
+  struct State;
+
+  // Removes and returns a task for "worker" to run, or NULL if every queue
+  // is empty.
+  Closure* TakeTask(Worker* worker);
+
+  // Takes "worker" off the list of sleeping workers.  Returns false if it
+  // was not on the list.
+  bool RemoveIdle(Worker* worker);
+
+  vector<Worker*> workers_;
+  State* state_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(WorkStealingExecutor);
+};
+
+}  // namespace rpc
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_RPC_EXECUTOR_H__
@@ -0,0 +1,212 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/rpc/executor.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+#include <google/protobuf/stubs/common.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+namespace {
+
+// Records what the tasks did.
+class Recorder {
+ public:
+  Recorder() : count_(0) {}
+
+  void Increment() {
+    internal::MutexLock lock(&mutex_);
+    ++count_;
+  }
+
+  void Record(int value) {
+    internal::MutexLock lock(&mutex_);
+    values_.push_back(value);
+    threads_.push_back(pthread_self());
+  }
+
+  int count() {
+    internal::MutexLock lock(&mutex_);
+    return count_;
+  }
+
+  vector<int> values() {
+    internal::MutexLock lock(&mutex_);
+    return values_;
+  }
+
+  vector<pthread_t> threads() {
+    internal::MutexLock lock(&mutex_);
+    return threads_;
+  }
+
+  // Waits (up to ten seconds) for the count to reach "count".
+  bool WaitFor(int count) {
+    for (int i = 0; i < 10000; i++) {
+      if (this->count() >= count) return true;
+      usleep(1000);
+    }
+    return false;
+  }
+
+ private:
+  internal::Mutex mutex_;
+  int count_;
+  vector<int> values_;
+  vector<pthread_t> threads_;
+};
+
+// Adds two copies of itself with "depth - 1", down to depth zero, where it
+// counts itself.  (NewCallback() binds at most two arguments.)
+class FanOutTask : public Closure {
+ public:
+  FanOutTask(Executor* executor, Recorder* recorder, int depth)
+    : executor_(executor), recorder_(recorder), depth_(depth) {}
+
+  void Run() {
+    if (depth_ == 0) {
+      recorder_->Increment();
+    } else {
+      for (int i = 0; i < 2; i++) {
+        executor_->Add(new FanOutTask(executor_, recorder_, depth_ - 1));
+      }
+    }
+    delete this;
+  }
+
+ private:
+  Executor* executor_;
+  Recorder* recorder_;
+  int depth_;
+};
+
+void RecordValue(Recorder* recorder, int value) {
+  recorder->Record(value);
+  recorder->Increment();
+}
+
+// Adds tasks recording 1, 2 and 3, in that order.
+void AddThree(Executor* executor, Recorder* recorder) {
+  for (int i = 1; i <= 3; i++) {
+    executor->Add(NewCallback(&RecordValue, recorder, i));
+  }
+}
+
+void SlowTask(Recorder* recorder, int value) {
+  usleep(20000);
+  RecordValue(recorder, value);
+}
+
+// Adds eight tasks which take a while each.
+void AddSlowTasks(Executor* executor, Recorder* recorder) {
+  for (int i = 0; i < 8; i++) {
+    executor->Add(NewCallback(&SlowTask, recorder, i));
+  }
+}
+
+TEST(WorkStealingExecutorTest, RunsEveryTask) {
+  WorkStealingExecutor executor(4);
+  EXPECT_EQ(4, executor.num_threads());
+  Recorder recorder;
+  for (int i = 0; i < 10000; i++) {
+    executor.Add(NewCallback(&recorder, &Recorder::Increment));
+  }
+  EXPECT_TRUE(recorder.WaitFor(10000));
+}
+
+TEST(WorkStealingExecutorTest, RunsOnItsOwnThreads) {
+  WorkStealingExecutor executor(2);
+  Recorder recorder;
+  for (int i = 0; i < 100; i++) {
+    executor.Add(NewCallback(&RecordValue, &recorder, i));
+  }
+  ASSERT_TRUE(recorder.WaitFor(100));
+
+  vector<pthread_t> threads = recorder.threads();
+  for (int i = 0; i < threads.size(); i++) {
+    EXPECT_FALSE(pthread_equal(pthread_self(), threads[i]));
+  }
+}
+
+TEST(WorkStealingExecutorTest, TasksAddingTasks) {
+  Recorder recorder;
+  {
+    WorkStealingExecutor executor(4);
+    executor.Add(new FanOutTask(&executor, &recorder, 12));
+    // The destructor waits for everything, including tasks added by tasks.
+  }
+  EXPECT_EQ(1 << 12, recorder.count());
+}
+
+TEST(WorkStealingExecutorTest, NewestLocalTaskFirst) {
+  // With one thread there is nobody to steal, so tasks added by a task run
+  // newest first.
+  WorkStealingExecutor executor(1);
+  Recorder recorder;
+  executor.Add(NewCallback(&AddThree, static_cast<Executor*>(&executor),
+                           &recorder));
+  ASSERT_TRUE(recorder.WaitFor(3));
+
+  vector<int> values = recorder.values();
+  ASSERT_EQ(3, values.size());
+  EXPECT_EQ(3, values[0]);
+  EXPECT_EQ(2, values[1]);
+  EXPECT_EQ(1, values[2]);
+}
+
+TEST(WorkStealingExecutorTest, IdleThreadsSteal) {
+  // One task queues slow tasks on its own thread; the idle threads must take
+  // some of them.
+  WorkStealingExecutor executor(4);
+  Recorder recorder;
+  executor.Add(NewCallback(&AddSlowTasks, static_cast<Executor*>(&executor),
+                           &recorder));
+  ASSERT_TRUE(recorder.WaitFor(8));
+
+  vector<pthread_t> threads = recorder.threads();
+  int others = 0;
+  for (int i = 1; i < threads.size(); i++) {
+    if (!pthread_equal(threads[0], threads[i])) ++others;
+  }
+  EXPECT_GT(others, 0);
+}
+
+}  // namespace
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
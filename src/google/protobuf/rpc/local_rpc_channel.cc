@@ -0,0 +1,335 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/rpc/local_rpc_channel.h>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/rpc/executor.h>
+#include <google/protobuf/stubs/closure_pool.h>
+#include <google/protobuf/stubs/map-util.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+namespace {
+
+// Copies "from" into "to", which may be of a different class.  Unless "mode"
+// is SERIALIZE, messages of the same type are copied directly.  On failure,
+// returns false and sets "error".
+bool HandOver(const Message& from, Message* to,
+              LocalRpcChannel::HandoffMode mode, string* error) {
+  if (mode != LocalRpcChannel::SERIALIZE &&
+      from.GetDescriptor() == to->GetDescriptor()) {
+    to->CopyFrom(from);
+    return true;
+  }
+
+  // The types come from different DescriptorPools (or we were asked to), so
+  // go through the wire format.
+  string data;
+  if (!from.SerializePartialToString(&data) ||
+      !to->ParsePartialFromString(data)) {
+    *error = "Could not convert message of type \"" +
+             from.GetDescriptor()->full_name() + "\" to \"" +
+             to->GetDescriptor()->full_name() + "\".";
+    return false;
+  }
+  if (mode == LocalRpcChannel::SERIALIZE && !to->IsInitialized()) {
+    *error = "Message of type \"" + to->GetDescriptor()->full_name() +
+             "\" is missing required fields: " +
+             to->InitializationErrorString();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// ===================================================================
+
+// The closure returned by BeginCall().  NewPermanentCallback() won't do:
+// its Run() reads the closure after calling the method, by which time
+// "done" may have deleted the controller, and the closure with it.
+class LocalRpcController::FinishCallClosure : public Closure {
+ public:
+  explicit FinishCallClosure(LocalRpcController* controller)
+    : controller_(controller) {}
+
+  void Run() { controller_->FinishCall(); }
+
+ private:
+  LocalRpcController* controller_;
+};
+
+LocalRpcController::LocalRpcController()
+  : failed_(false), canceled_(false), cancel_callback_(NULL), done_(NULL),
+    finish_call_(new FinishCallClosure(this)) {
+}
+
+LocalRpcController::~LocalRpcController() {
+  delete finish_call_;
+}
+
+void LocalRpcController::Reset() {
+  MutexLock lock(&mutex_);
+  GOOGLE_CHECK(done_ == NULL) << "Reset() called while a call is in progress.";
+  failed_ = false;
+  error_text_.clear();
+  canceled_ = false;
+  cancel_callback_ = NULL;
+}
+
+bool LocalRpcController::Failed() const {
+  MutexLock lock(&mutex_);
+  return failed_;
+}
+
+string LocalRpcController::ErrorText() const {
+  MutexLock lock(&mutex_);
+  return error_text_;
+}
+
+void LocalRpcController::StartCancel() {
+  Closure* callback;
+  {
+    MutexLock lock(&mutex_);
+    // Canceling a call that has finished does nothing.
+    if (done_ == NULL || canceled_) return;
+    canceled_ = true;
+    callback = cancel_callback_;
+    cancel_callback_ = NULL;
+  }
+  if (callback != NULL) callback->Run();
+}
+
+void LocalRpcController::SetFailed(const string& reason) {
+  MutexLock lock(&mutex_);
+  failed_ = true;
+  error_text_ = reason;
+}
+
+bool LocalRpcController::IsCanceled() const {
+  MutexLock lock(&mutex_);
+  return canceled_;
+}
+
+void LocalRpcController::NotifyOnCancel(Closure* callback) {
+  {
+    MutexLock lock(&mutex_);
+    if (!canceled_) {
+      cancel_callback_ = callback;
+      return;
+    }
+  }
+  callback->Run();
+}
+
+Closure* LocalRpcController::BeginCall(Closure* done) {
+  MutexLock lock(&mutex_);
+  GOOGLE_CHECK(done_ == NULL)
+    << "A LocalRpcController can only be used for one call at a time.";
+  done_ = done;
+  return finish_call_;
+}
+
+void LocalRpcController::FinishCall() {
+  Closure* callback;
+  Closure* done;
+  {
+    MutexLock lock(&mutex_);
+    callback = cancel_callback_;
+    cancel_callback_ = NULL;
+    done = done_;
+    done_ = NULL;
+  }
+  if (callback != NULL) callback->Run();
+  // "done" may delete the controller, so it must come last.
+  done->Run();
+}
+
+// ===================================================================
+
+// A call which needs more than a direct call to the service:  either it goes
+// through the executor, or its messages must be copied.
+class LocalRpcChannel::Call {
+ public:
+  Call(Service* service, const MethodDescriptor* method,
+       LocalRpcController* controller, const Message* request,
+       Message* response, Closure* finish, bool share, HandoffMode mode)
+    : service_(service), method_(method), controller_(controller),
+      request_(request), response_(response), finish_(finish),
+      share_(share), mode_(mode) {}
+
+  // Returns a closure which calls Run(), for the executor.
+  Closure* NewRunClosure() {
+    return NewCallbackIn(&run_storage_, this, &Call::Run);
+  }
+
+  // Calls the service.  Deletes the Call once it is no longer needed.
+  void Run() {
+    if (share_) {
+      service_->CallMethod(method_, controller_, request_, response_,
+                           finish_);
+      delete this;
+      return;
+    }
+
+    service_request_.reset(service_->GetRequestPrototype(method_).New());
+    service_response_.reset(service_->GetResponsePrototype(method_).New());
+    string error;
+    if (!HandOver(*request_, service_request_.get(), mode_, &error)) {
+      controller_->SetFailed(error);
+      Closure* finish = finish_;
+      delete this;
+      finish->Run();
+      return;
+    }
+    service_->CallMethod(method_, controller_, service_request_.get(),
+                         service_response_.get(),
+                         NewCallbackIn(&finish_storage_, this, &Call::Finish));
+  }
+
+ private:
+  // Called by the service when it is done with a call whose messages were
+  // copied.
+  void Finish() {
+    if (!controller_->Failed()) {
+      response_->Clear();
+      string error;
+      if (!HandOver(*service_response_, response_, mode_, &error)) {
+        controller_->SetFailed(error);
+      }
+    }
+    Closure* finish = finish_;
+    delete this;
+    finish->Run();
+  }
+
+  Service* service_;
+  const MethodDescriptor* method_;
+  LocalRpcController* controller_;
+  const Message* request_;
+  Message* response_;
+  Closure* finish_;
+  bool share_;
+  HandoffMode mode_;
+
+  // The service's own copies of the messages, unless shared.
+  scoped_ptr<Message> service_request_;
+  scoped_ptr<Message> service_response_;
+
+  // Hold the closures which call Run() and Finish().
+  ClosureStorage run_storage_;
+  ClosureStorage finish_storage_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(Call);
+};
+
+// -------------------------------------------------------------------
+
+LocalRpcChannel::LocalRpcChannel(Executor* executor, HandoffMode mode)
+  : executor_(executor), mode_(mode) {}
+
+LocalRpcChannel::~LocalRpcChannel() {}
+
+bool LocalRpcChannel::RegisterService(Service* service) {
+  const ServiceDescriptor* descriptor = service->GetDescriptor();
+  if (!InsertIfNotPresent(&services_by_name_, descriptor->full_name(),
+                          service)) {
+    GOOGLE_LOG(ERROR) << "Service already registered: "
+                      << descriptor->full_name();
+    return false;
+  }
+  services_[descriptor] = service;
+  return true;
+}
+
+bool LocalRpcChannel::FindMethod(
+    const MethodDescriptor* method, Service** service,
+    const MethodDescriptor** service_method) const {
+  *service = FindPtrOrNull(services_, method->service());
+  if (*service != NULL) {
+    *service_method = method;
+    return true;
+  }
+
+  *service = FindPtrOrNull(services_by_name_, method->service()->full_name());
+  if (*service == NULL) return false;
+  *service_method =
+    (*service)->GetDescriptor()->FindMethodByName(method->name());
+  return *service_method != NULL;
+}
+
+void LocalRpcChannel::CallMethod(const MethodDescriptor* method,
+                                 RpcController* controller,
+                                 const Message* request,
+                                 Message* response,
+                                 Closure* done) {
+  LocalRpcController* local_controller =
+    down_cast<LocalRpcController*>(controller);
+
+  Service* service;
+  const MethodDescriptor* service_method;
+  if (!FindMethod(method, &service, &service_method)) {
+    controller->SetFailed("Method not found: " + method->full_name());
+    done->Run();
+    return;
+  }
+
+  Closure* finish = local_controller->BeginCall(done);
+
+  // Messages of the service's own classes can be handed over as they are.
+  bool share = mode_ == SHARE &&
+    request->GetReflection() ==
+      service->GetRequestPrototype(service_method).GetReflection() &&
+    response->GetReflection() ==
+      service->GetResponsePrototype(service_method).GetReflection();
+
+  if (share && executor_ == NULL) {
+    // The fast path:  just call the service.
+    service->CallMethod(service_method, controller, request, response,
+                        finish);
+    return;
+  }
+
+  Call* call = new Call(service, service_method, local_controller, request,
+                        response, finish, share, mode_);
+  if (executor_ == NULL) {
+    call->Run();
+  } else {
+    executor_->Add(call->NewRunClosure());
+  }
+}
+
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,187 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// An RpcChannel which calls Services in the same process directly, without
+// serializing anything.  Useful when a client and a server that would
+// normally talk over the network are linked into one binary: the call costs
+// about as much as a virtual function call, yet either side can be moved to
+// another process later by swapping in a different channel.
+//
+// Example:
+//   MyServiceImpl service;
+//   LocalRpcChannel channel;
+//   channel.RegisterService(&service);
+//
+//   MyService::Stub stub(&channel);
+//   LocalRpcController controller;
+//   stub.Foo(&controller, &request, &response, NewCallback(&HandleResponse));
+//
+// How messages reach the service depends on the channel's HandoffMode; see
+// below.  The client's LocalRpcController is passed to the service as is.
+//
+// By default calls run in the calling thread, and "done" runs in whichever
+// thread the service calls it from.  Given an Executor, the channel instead
+// queues each call there and returns at once.
+
+#ifndef GOOGLE_PROTOBUF_RPC_LOCAL_RPC_CHANNEL_H__
+#define GOOGLE_PROTOBUF_RPC_LOCAL_RPC_CHANNEL_H__
+
+#include <string>
+#include <google/protobuf/service.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/hash.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+class Executor;  // executor.h
+
+// Defined in this file.
+class LocalRpcController;
+class LocalRpcChannel;
+
+// RpcController used as both the client and the server controller of a
+// local call:  StartCancel() by the client is seen by IsCanceled() in the
+// service, and SetFailed() by the service is seen by Failed() in the client.
+// All methods may be called from any thread.
+class LIBPROTOBUF_EXPORT LocalRpcController : public RpcController {
+ public:
+  LocalRpcController();
+  ~LocalRpcController();
+
+  // implements RpcController ----------------------------------------
+
+  void Reset();
+  bool Failed() const;
+  string ErrorText() const;
+  void StartCancel();
+  void SetFailed(const string& reason);
+  bool IsCanceled() const;
+  void NotifyOnCancel(Closure* callback);
+
+ private:
+  friend class LocalRpcChannel;
+  class FinishCallClosure;
+
+  // Starts a call which will finish by running "done".  Returns the closure
+  // to give the service in place of "done"; it runs the cancel callback, if
+  // any is still pending, before "done".  The closure is owned by the
+  // controller, so starting a call allocates nothing.
+  Closure* BeginCall(Closure* done);
+  void FinishCall();
+
+  mutable internal::Mutex mutex_;
+  bool failed_;
+  string error_text_;
+  bool canceled_;
+  Closure* cancel_callback_;
+
+  // While a call is in progress, the caller's "done".
+  Closure* done_;
+  // Permanent closure which calls FinishCall().
+  FinishCallClosure* finish_call_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LocalRpcController);
+};
+
+class LIBPROTOBUF_EXPORT LocalRpcChannel : public RpcChannel {
+ public:
+  // How request and response messages are handed to the service.
+  enum HandoffMode {
+    // The service gets the caller's own request and response objects, as
+    // long as they are of the classes the service expects (i.e. they share
+    // its prototypes' Reflection).  Nothing is copied; the RpcChannel rules
+    // already forbid the caller from touching either message until "done"
+    // runs.  If the classes differ (say, the caller uses DynamicMessage),
+    // the messages are copied as with COPY.
+    SHARE,
+    // The service gets its own request and response objects.  The request
+    // is copied in with CopyFrom() and the response copied back out the same
+    // way before "done" runs.  Use this when the service might keep pointers
+    // to the messages after calling "done".
+    COPY,
+    // Like COPY, but the messages are serialized and parsed rather than
+    // copied, exactly as a remote call would see them.  Mainly useful for
+    // testing.  A request or response missing required fields fails the
+    // call.
+    SERIALIZE
+  };
+
+  // "executor" may be NULL, in which case calls run in the calling thread.
+  // The channel does not take ownership of the executor.
+  explicit LocalRpcChannel(Executor* executor = NULL,
+                           HandoffMode mode = SHARE);
+  ~LocalRpcChannel();
+
+  // Makes the methods of "service" callable through this channel.  The
+  // channel does not take ownership; the service must outlive it.  All
+  // services must be registered before the first call.  Returns false if a
+  // service with the same full name is already registered.
+  bool RegisterService(Service* service);
+
+  // implements RpcChannel -------------------------------------------
+
+  // Calls the registered service implementing "method"'s service, or fails
+  // the call if there is none.  "controller" must be a LocalRpcController;
+  // it is passed to the service.
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done);
+
+ private:
+  class Call;
+
+  // Finds the service and method to call for "method", which may come from a
+  // different DescriptorPool than the service's own descriptors.  Returns
+  // false if there is no such service or method.
+  bool FindMethod(const MethodDescriptor* method, Service** service,
+                  const MethodDescriptor** service_method) const;
+
+  Executor* executor_;
+  HandoffMode mode_;
+
+  // Registered services, by descriptor for the usual case where the client
+  // and service share descriptors, and by full name for the rest.
+  typedef hash_map<const ServiceDescriptor*, Service*> ServiceMap;
+  ServiceMap services_;
+  typedef hash_map<string, Service*> ServiceNameMap;
+  ServiceNameMap services_by_name_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LocalRpcChannel);
+};
+
+}  // namespace rpc
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_RPC_LOCAL_RPC_CHANNEL_H__
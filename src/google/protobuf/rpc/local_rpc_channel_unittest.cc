@@ -0,0 +1,432 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// The test service is protobuf_unittest.TestService, whose messages are
+// empty; the tests carry their data in unknown fields.
+
+#include <google/protobuf/rpc/local_rpc_channel.h>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/rpc/executor.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_import.pb.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/stubs/common.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+namespace {
+
+// Unknown field numbers used by the tests.
+const int kValueField = 1;    // Echoed back by Foo.
+const int kFailField = 2;     // Makes Foo fail.
+
+int64 GetValue(const Message& message) {
+  const UnknownFieldSet& fields = message.GetReflection()->GetUnknownFields(
+    message);
+  for (int i = 0; i < fields.field_count(); i++) {
+    if (fields.field(i).number() == kValueField) {
+      return fields.field(i).varint();
+    }
+  }
+  return -1;
+}
+
+void SetValue(Message* message, int64 value) {
+  message->GetReflection()->MutableUnknownFields(message)->AddVarint(
+    kValueField, value);
+}
+
+// Counts callbacks, so that tests can wait for calls to finish.
+class Counter {
+ public:
+  Counter() : count_(0) {}
+
+  void Increment() {
+    internal::MutexLock lock(&mutex_);
+    ++count_;
+  }
+
+  int count() {
+    internal::MutexLock lock(&mutex_);
+    return count_;
+  }
+
+  // Waits (up to ten seconds) for the count to reach "count".
+  bool WaitFor(int count) {
+    for (int i = 0; i < 10000; i++) {
+      if (this->count() >= count) return true;
+      usleep(1000);
+    }
+    return false;
+  }
+
+ private:
+  internal::Mutex mutex_;
+  int count_;
+};
+
+// Foo echoes the request's unknown fields (or fails, if asked to) and
+// remembers which messages and thread it was called with.  Bar holds on to
+// its call until the test releases it.
+class TestServiceImpl : public protobuf_unittest::TestService {
+ public:
+  TestServiceImpl()
+    : foo_request_(NULL), foo_response_(NULL), bar_controller_(NULL),
+      bar_done_(NULL) {}
+
+  // implements TestService ------------------------------------------
+
+  void Foo(RpcController* controller,
+           const protobuf_unittest::FooRequest* request,
+           protobuf_unittest::FooResponse* response,
+           Closure* done) {
+    {
+      internal::MutexLock lock(&mutex_);
+      foo_request_ = request;
+      foo_response_ = response;
+      foo_thread_ = pthread_self();
+    }
+    const UnknownFieldSet& fields = request->unknown_fields();
+    for (int i = 0; i < fields.field_count(); i++) {
+      if (fields.field(i).number() == kFailField) {
+        controller->SetFailed("Failed on purpose.");
+      }
+    }
+    response->mutable_unknown_fields()->MergeFrom(fields);
+    done->Run();
+  }
+
+  void Bar(RpcController* controller,
+           const protobuf_unittest::BarRequest* request,
+           protobuf_unittest::BarResponse* response,
+           Closure* done) {
+    bar_controller_ = controller;
+    bar_done_ = done;
+  }
+
+  // -----------------------------------------------------------------
+
+  const Message* foo_request_;
+  const Message* foo_response_;
+  pthread_t foo_thread_;
+  RpcController* bar_controller_;
+  Closure* bar_done_;
+
+ private:
+  internal::Mutex mutex_;
+};
+
+class LocalRpcChannelTest : public testing::Test {
+ protected:
+  void SetUp() {
+    foo_ = protobuf_unittest::TestService::descriptor()->FindMethodByName(
+      "Foo");
+  }
+
+  // Calls Foo through "channel" with the given value, and returns the
+  // value echoed back, or -1 if the call failed.
+  int64 CallFoo(RpcChannel* channel, int64 value) {
+    protobuf_unittest::TestService::Stub stub(channel);
+    protobuf_unittest::FooRequest request;
+    protobuf_unittest::FooResponse response;
+    SetValue(&request, value);
+    LocalRpcController controller;
+    Counter done;
+    stub.Foo(&controller, &request, &response,
+             NewCallback(&done, &Counter::Increment));
+    EXPECT_TRUE(done.WaitFor(1));
+    if (controller.Failed()) return -1;
+    return GetValue(response);
+  }
+
+  TestServiceImpl service_;
+  const MethodDescriptor* foo_;
+};
+
+TEST_F(LocalRpcChannelTest, SharedMessages) {
+  LocalRpcChannel channel;
+  ASSERT_TRUE(channel.RegisterService(&service_));
+
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  SetValue(&request, 42);
+  LocalRpcController controller;
+  Counter done;
+  channel.CallMethod(foo_, &controller, &request, &response,
+                     NewCallback(&done, &Counter::Increment));
+
+  // The call ran before CallMethod() returned, on the caller's own objects.
+  EXPECT_EQ(1, done.count());
+  EXPECT_FALSE(controller.Failed());
+  EXPECT_EQ(&request, service_.foo_request_);
+  EXPECT_EQ(&response, service_.foo_response_);
+  EXPECT_TRUE(pthread_equal(pthread_self(), service_.foo_thread_));
+  EXPECT_EQ(42, GetValue(response));
+}
+
+TEST_F(LocalRpcChannelTest, CopiedMessages) {
+  LocalRpcChannel::HandoffMode modes[] = {
+    LocalRpcChannel::COPY, LocalRpcChannel::SERIALIZE
+  };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(modes); i++) {
+    LocalRpcChannel channel(NULL, modes[i]);
+    ASSERT_TRUE(channel.RegisterService(&service_));
+
+    protobuf_unittest::FooRequest request;
+    protobuf_unittest::FooResponse response;
+    SetValue(&request, 42);
+    LocalRpcController controller;
+    Counter done;
+    channel.CallMethod(foo_, &controller, &request, &response,
+                       NewCallback(&done, &Counter::Increment));
+
+    EXPECT_EQ(1, done.count());
+    EXPECT_FALSE(controller.Failed());
+    EXPECT_NE(&request, service_.foo_request_);
+    EXPECT_NE(&response, service_.foo_response_);
+    EXPECT_EQ(42, GetValue(response));
+  }
+}
+
+TEST_F(LocalRpcChannelTest, DynamicMessages) {
+  // The service's classes differ from the caller's, so the messages are
+  // copied even though sharing was asked for.
+  LocalRpcChannel channel;
+  ASSERT_TRUE(channel.RegisterService(&service_));
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> request(
+    factory.GetPrototype(protobuf_unittest::FooRequest::descriptor())->New());
+  scoped_ptr<Message> response(
+    factory.GetPrototype(protobuf_unittest::FooResponse::descriptor())->New());
+  SetValue(request.get(), 42);
+  LocalRpcController controller;
+  Counter done;
+  channel.CallMethod(foo_, &controller, request.get(), response.get(),
+                     NewCallback(&done, &Counter::Increment));
+
+  EXPECT_EQ(1, done.count());
+  EXPECT_FALSE(controller.Failed());
+  EXPECT_NE(request.get(), service_.foo_request_);
+  EXPECT_EQ(42, GetValue(*response));
+}
+
+TEST_F(LocalRpcChannelTest, OtherDescriptorPool) {
+  // The caller's descriptors come from a separate pool, so the method is
+  // found by name and the messages go through the wire format.
+  DescriptorPool pool;
+  FileDescriptorProto file;
+  protobuf_unittest_import::ImportMessage::descriptor()->file()->CopyTo(&file);
+  ASSERT_TRUE(pool.BuildFile(file) != NULL);
+  protobuf_unittest::TestService::descriptor()->file()->CopyTo(&file);
+  ASSERT_TRUE(pool.BuildFile(file) != NULL);
+
+  const MethodDescriptor* foo =
+    pool.FindMethodByName("protobuf_unittest.TestService.Foo");
+  ASSERT_TRUE(foo != NULL);
+  ASSERT_NE(foo_, foo);
+
+  LocalRpcChannel channel;
+  ASSERT_TRUE(channel.RegisterService(&service_));
+
+  DynamicMessageFactory factory;
+  scoped_ptr<Message> request(
+    factory.GetPrototype(foo->input_type())->New());
+  scoped_ptr<Message> response(
+    factory.GetPrototype(foo->output_type())->New());
+  SetValue(request.get(), 42);
+  LocalRpcController controller;
+  Counter done;
+  channel.CallMethod(foo, &controller, request.get(), response.get(),
+                     NewCallback(&done, &Counter::Increment));
+
+  EXPECT_EQ(1, done.count());
+  EXPECT_FALSE(controller.Failed());
+  EXPECT_EQ(42, GetValue(*response));
+}
+
+TEST_F(LocalRpcChannelTest, Failure) {
+  LocalRpcChannel::HandoffMode modes[] = {
+    LocalRpcChannel::SHARE, LocalRpcChannel::COPY, LocalRpcChannel::SERIALIZE
+  };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(modes); i++) {
+    LocalRpcChannel channel(NULL, modes[i]);
+    ASSERT_TRUE(channel.RegisterService(&service_));
+
+    protobuf_unittest::FooRequest request;
+    protobuf_unittest::FooResponse response;
+    request.mutable_unknown_fields()->AddVarint(kFailField, 1);
+    LocalRpcController controller;
+    Counter done;
+    channel.CallMethod(foo_, &controller, &request, &response,
+                       NewCallback(&done, &Counter::Increment));
+
+    EXPECT_EQ(1, done.count());
+    EXPECT_TRUE(controller.Failed());
+    EXPECT_EQ("Failed on purpose.", controller.ErrorText());
+  }
+}
+
+TEST_F(LocalRpcChannelTest, MethodNotFound) {
+  LocalRpcChannel channel;
+  EXPECT_EQ(-1, CallFoo(&channel, 1));
+
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  LocalRpcController controller;
+  Counter done;
+  channel.CallMethod(foo_, &controller, &request, &response,
+                     NewCallback(&done, &Counter::Increment));
+  EXPECT_EQ(1, done.count());
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Method not found: protobuf_unittest.TestService.Foo",
+            controller.ErrorText());
+}
+
+TEST_F(LocalRpcChannelTest, DuplicateService) {
+  LocalRpcChannel channel;
+  EXPECT_TRUE(channel.RegisterService(&service_));
+  TestServiceImpl other;
+  EXPECT_FALSE(channel.RegisterService(&other));
+}
+
+TEST_F(LocalRpcChannelTest, Executor) {
+  LocalRpcChannel::HandoffMode modes[] = {
+    LocalRpcChannel::SHARE, LocalRpcChannel::COPY, LocalRpcChannel::SERIALIZE
+  };
+  WorkStealingExecutor executor(4);
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(modes); i++) {
+    LocalRpcChannel channel(&executor, modes[i]);
+    ASSERT_TRUE(channel.RegisterService(&service_));
+    EXPECT_EQ(123, CallFoo(&channel, 123));
+    EXPECT_FALSE(pthread_equal(pthread_self(), service_.foo_thread_));
+  }
+}
+
+TEST_F(LocalRpcChannelTest, ManyCallsOnExecutor) {
+  WorkStealingExecutor executor(4);
+  LocalRpcChannel channel(&executor);
+  ASSERT_TRUE(channel.RegisterService(&service_));
+  protobuf_unittest::TestService::Stub stub(&channel);
+
+  const int kCalls = 1000;
+  vector<protobuf_unittest::FooRequest> requests(kCalls);
+  vector<protobuf_unittest::FooResponse> responses(kCalls);
+  vector<LocalRpcController*> controllers;
+  Counter done;
+  for (int i = 0; i < kCalls; i++) {
+    controllers.push_back(new LocalRpcController);
+    SetValue(&requests[i], i);
+    stub.Foo(controllers[i], &requests[i], &responses[i],
+             NewCallback(&done, &Counter::Increment));
+  }
+  ASSERT_TRUE(done.WaitFor(kCalls));
+
+  for (int i = 0; i < kCalls; i++) {
+    EXPECT_FALSE(controllers[i]->Failed());
+    EXPECT_EQ(i, GetValue(responses[i]));
+    delete controllers[i];
+  }
+}
+
+TEST_F(LocalRpcChannelTest, Cancel) {
+  LocalRpcChannel channel;
+  ASSERT_TRUE(channel.RegisterService(&service_));
+  protobuf_unittest::TestService::Stub stub(&channel);
+
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  LocalRpcController controller;
+  Counter done;
+  stub.Bar(&controller, &request, &response,
+           NewCallback(&done, &Counter::Increment));
+  ASSERT_TRUE(service_.bar_done_ != NULL);
+  EXPECT_EQ(&controller, service_.bar_controller_);
+
+  Counter canceled;
+  service_.bar_controller_->NotifyOnCancel(
+    NewCallback(&canceled, &Counter::Increment));
+  EXPECT_FALSE(service_.bar_controller_->IsCanceled());
+
+  controller.StartCancel();
+  EXPECT_TRUE(service_.bar_controller_->IsCanceled());
+  EXPECT_EQ(1, canceled.count());
+  EXPECT_EQ(0, done.count());
+
+  service_.bar_controller_->SetFailed("Canceled.");
+  service_.bar_done_->Run();
+  EXPECT_EQ(1, done.count());
+  // The cancel callback is not run again.
+  EXPECT_EQ(1, canceled.count());
+  EXPECT_TRUE(controller.Failed());
+
+  // Canceling a finished call does nothing.
+  controller.StartCancel();
+  controller.Reset();
+  EXPECT_FALSE(controller.IsCanceled());
+}
+
+TEST_F(LocalRpcChannelTest, CancelCallbackRunsOnCompletion) {
+  LocalRpcChannel channel;
+  ASSERT_TRUE(channel.RegisterService(&service_));
+  protobuf_unittest::TestService::Stub stub(&channel);
+
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  LocalRpcController controller;
+  Counter done;
+  stub.Bar(&controller, &request, &response,
+           NewCallback(&done, &Counter::Increment));
+  ASSERT_TRUE(service_.bar_done_ != NULL);
+
+  Counter canceled;
+  service_.bar_controller_->NotifyOnCancel(
+    NewCallback(&canceled, &Counter::Increment));
+  service_.bar_done_->Run();
+  EXPECT_EQ(1, canceled.count());
+  EXPECT_EQ(1, done.count());
+  EXPECT_FALSE(controller.IsCanceled());
+}
+
+}  // namespace
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,1229 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/rpc/socket_rpc.h>
+
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <map>
+#include <set>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/stubs/closure_pool.h>
+#include <google/protobuf/stubs/map-util.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+using internal::WireFormatLite;
+
+namespace {
+
+// Frame kinds and field numbers; see the description of Frame in the header.
+enum FrameKind {
+  FRAME_REQUEST = 0,
+  FRAME_RESPONSE = 1,
+  FRAME_CANCEL = 2
+};
+
+const int kCallIdField = 1;
+const int kKindField = 2;
+const int kMethodField = 3;
+const int kErrorField = 4;
+const int kPayloadField = 5;
+
+// Size of the buffers between each socket and the coded streams.  Frames
+// queued while a write is in progress collect in the output buffer and are
+// sent together.
+const int kBufferSize = 64 << 10;
+
+#ifdef MSG_NOSIGNAL
+const int kSendFlags = MSG_NOSIGNAL;
+#else
+const int kSendFlags = 0;
+#endif
+
+void* RunClosure(void* closure) {
+  reinterpret_cast<Closure*>(closure)->Run();
+  return NULL;
+}
+
+// Starts a thread running "body", which must delete itself when run (i.e.
+// be created with NewCallback()).
+pthread_t StartThread(Closure* body) {
+  pthread_t thread;
+  int result = pthread_create(&thread, NULL, &RunClosure, body);
+  if (result != 0) {
+    GOOGLE_LOG(FATAL) << "pthread_create: " << strerror(result);
+  }
+  return thread;
+}
+
+// Sets the options we want on every socket.
+void ConfigureSocket(int socket, bool is_tcp) {
+  int one = 1;
+  if (is_tcp) {
+    // Frames are already batched; don't let Nagle's algorithm delay them.
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+#ifdef SO_NOSIGPIPE
+  setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+}
+
+// Fills in a sockaddr_un for "path".  Returns false if the path is too long.
+bool MakeUnixAddress(const string& path, struct sockaddr_un* address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address->sun_path)) {
+    GOOGLE_LOG(ERROR) << "Socket path too long: " << path;
+    return false;
+  }
+  memcpy(address->sun_path, path.data(), path.size());
+  return true;
+}
+
+// Writes a complete frame.  "method", "error" and "payload" are omitted if
+// NULL.
+void WriteFrame(io::CodedOutputStream* output, uint64 call_id, FrameKind kind,
+                const string* method, const string* error,
+                const Message* payload) {
+  // All field numbers are small enough for one-byte tags.
+  int size = 1 + io::CodedOutputStream::VarintSize64(call_id);
+  if (kind != FRAME_REQUEST) size += 2;
+  if (method != NULL) size += 1 + WireFormatLite::StringSize(*method);
+  if (error != NULL) size += 1 + WireFormatLite::StringSize(*error);
+  int payload_size = 0;
+  if (payload != NULL) {
+    payload_size = payload->ByteSize();
+    size += 1 + io::CodedOutputStream::VarintSize32(payload_size) +
+            payload_size;
+  }
+
+  output->WriteVarint32(size);
+  WireFormatLite::WriteUInt64(kCallIdField, call_id, output);
+  if (kind != FRAME_REQUEST) {
+    WireFormatLite::WriteEnum(kKindField, kind, output);
+  }
+  if (method != NULL) {
+    WireFormatLite::WriteString(kMethodField, *method, output);
+  }
+  if (error != NULL) {
+    WireFormatLite::WriteString(kErrorField, *error, output);
+  }
+  if (payload != NULL) {
+    // Serialize straight into the socket's buffer.
+    WireFormatLite::WriteTag(kPayloadField,
+                             WireFormatLite::WIRETYPE_LENGTH_DELIMITED, output);
+    output->WriteVarint32(payload_size);
+    payload->SerializeWithCachedSizes(output);
+  }
+}
+
+// Parses a payload into "message", which is cleared first.  Returns false if
+// the bytes are malformed.  If they are well-formed but the message is
+// missing required fields, returns true and sets "error".
+bool ReadMessage(io::CodedInputStream* input, Message* message,
+                 string* error) {
+  if (!message->ParsePartialFromCodedStream(input) ||
+      !input->ConsumedEntireMessage()) {
+    return false;
+  }
+  if (!message->IsInitialized()) {
+    *error = "Message of type \"" + message->GetDescriptor()->full_name() +
+             "\" is missing required fields: " +
+             message->InitializationErrorString();
+  }
+  return true;
+}
+
+// ===================================================================
+
+// An entry in a socket's output queue.
+class OutgoingFrame {
+ public:
+  virtual ~OutgoingFrame() {}
+
+  // Writes the frame, length prefix included.
+  virtual void Write(io::CodedOutputStream* output) = 0;
+
+  // Called right after Write(), or instead of it if the socket has failed.
+  // The writer does not touch the frame afterwards.
+  virtual void Done() = 0;
+};
+
+// Writes frames to a socket on behalf of any number of threads.
+class FrameWriter {
+ public:
+  explicit FrameWriter(int socket)
+    : socket_(socket), writing_(false), failed_(false),
+      copying_output_(socket), output_(&copying_output_, kBufferSize) {}
+  ~FrameWriter() {}
+
+  // Queues "frame".  If no other thread is writing, the calling thread then
+  // writes everything in the queue, including frames other threads add in
+  // the meantime, and flushes the socket once the queue runs dry.  Under
+  // load this sends many frames per write() without any thread waiting for
+  // a timer.  If the socket has failed, frame->Done() is called right away.
+  void Write(OutgoingFrame* frame) {
+    {
+      MutexLock lock(&mutex_);
+      if (!failed_) {
+        queue_.push_back(frame);
+        if (writing_) return;
+        writing_ = true;
+        frame = NULL;
+      }
+    }
+    if (frame != NULL) {
+      frame->Done();
+    } else {
+      WriteQueue();
+    }
+  }
+
+  // Makes all further writes fail.  Frames already queued are handed to
+  // Done() without being written.
+  void Fail() {
+    MutexLock lock(&mutex_);
+    failed_ = true;
+  }
+
+ private:
+  // Writes the byte stream to the socket.
+  class SocketOutput : public io::CopyingOutputStream {
+   public:
+    explicit SocketOutput(int socket) : socket_(socket) {}
+
+    bool Write(const void* buffer, int size) {
+      const char* data = reinterpret_cast<const char*>(buffer);
+      while (size > 0) {
+        int bytes;
+        do {
+          bytes = send(socket_, data, size, kSendFlags);
+        } while (bytes < 0 && errno == EINTR);
+        if (bytes <= 0) return false;
+        data += bytes;
+        size -= bytes;
+      }
+      return true;
+    }
+
+   private:
+    int socket_;
+  };
+
+  void WriteQueue() {
+    vector<OutgoingFrame*> batch;
+    while (true) {
+      bool ok;
+      {
+        MutexLock lock(&mutex_);
+        if (queue_.empty()) {
+          writing_ = false;
+          return;
+        }
+        batch.swap(queue_);
+        ok = !failed_;
+      }
+
+      if (ok) {
+        io::CodedOutputStream output(&output_);
+        for (int i = 0; i < batch.size(); i++) {
+          batch[i]->Write(&output);
+          batch[i]->Done();
+        }
+        ok = !output.HadError();
+      } else {
+        for (int i = 0; i < batch.size(); i++) {
+          batch[i]->Done();
+        }
+      }
+      batch.clear();
+
+      if (ok) {
+        bool more;
+        {
+          MutexLock lock(&mutex_);
+          more = !queue_.empty();
+        }
+        if (!more) ok = output_.Flush();
+      }
+      if (!ok) {
+        MutexLock lock(&mutex_);
+        if (!failed_) {
+          failed_ = true;
+          // Wakes up the socket's reader, which fails everything else.
+          shutdown(socket_, SHUT_RDWR);
+        }
+      }
+    }
+  }
+
+  const int socket_;
+  Mutex mutex_;
+  vector<OutgoingFrame*> queue_;
+  bool writing_;
+  bool failed_;
+
+  // Used only by the thread which set writing_.
+  SocketOutput copying_output_;
+  io::CopyingOutputStreamAdaptor output_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FrameWriter);
+};
+
+// Header fields of an incoming frame.
+struct FrameHeader {
+  uint64 call_id;
+  int kind;
+  string method;
+  bool has_error;
+  string error;
+  bool has_payload;
+};
+
+// Reads frames from a socket until it is closed or sends something
+// malformed, handing each to the subclass.
+class FrameReader {
+ public:
+  FrameReader() {}
+  virtual ~FrameReader() {}
+
+ protected:
+  // Reads frames from "socket" until end-of-stream or an error.
+  void ReadFrames(int socket) {
+    io::FileInputStream raw_input(socket, kBufferSize);
+    FrameHeader header;
+    while (ReadFrame(&raw_input, &header)) {}
+  }
+
+  // Called when a frame's payload is reached, with "input" limited to the
+  // payload.  Returns false if the payload is malformed.
+  virtual bool ReadPayload(const FrameHeader& header,
+                           io::CodedInputStream* input) = 0;
+
+  // Called after the whole frame has been read.
+  virtual void HandleFrame(const FrameHeader& header) = 0;
+
+  // Consumes the rest of a payload which is not wanted.
+  static bool SkipPayload(io::CodedInputStream* input) {
+    return input->Skip(input->BytesUntilLimit());
+  }
+
+ private:
+  bool ReadFrame(io::ZeroCopyInputStream* raw_input, FrameHeader* header) {
+    // A fresh CodedInputStream per frame, so that the total bytes limit
+    // applies to frames rather than to the whole connection.
+    io::CodedInputStream input(raw_input);
+    uint32 size;
+    if (!input.ReadVarint32(&size)) return false;
+    io::CodedInputStream::Limit frame_limit = input.PushLimit(size);
+
+    header->call_id = 0;
+    header->kind = FRAME_REQUEST;
+    header->method.clear();
+    header->has_error = false;
+    header->error.clear();
+    header->has_payload = false;
+
+    while (uint32 tag = input.ReadTag()) {
+      bool ok;
+      switch (WireFormatLite::GetTagFieldNumber(tag)) {
+        case kCallIdField:
+          ok = input.ReadVarint64(&header->call_id);
+          break;
+        case kKindField: {
+          uint32 kind;
+          ok = input.ReadVarint32(&kind);
+          header->kind = kind;
+          break;
+        }
+        case kMethodField:
+          ok = WireFormatLite::ReadString(&input, &header->method);
+          break;
+        case kErrorField:
+          header->has_error = true;
+          ok = WireFormatLite::ReadString(&input, &header->error);
+          break;
+        case kPayloadField: {
+          uint32 length;
+          if (WireFormatLite::GetTagWireType(tag) !=
+                WireFormatLite::WIRETYPE_LENGTH_DELIMITED ||
+              !input.ReadVarint32(&length)) {
+            return false;
+          }
+          header->has_payload = true;
+          io::CodedInputStream::Limit payload_limit = input.PushLimit(length);
+          ok = ReadPayload(*header, &input);
+          input.PopLimit(payload_limit);
+          break;
+        }
+        default:
+          ok = WireFormatLite::SkipField(&input, tag);
+          break;
+      }
+      if (!ok) return false;
+    }
+    if (!input.ConsumedEntireMessage()) return false;
+    input.PopLimit(frame_limit);
+
+    HandleFrame(*header);
+    return true;
+  }
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FrameReader);
+};
+
+// A request to cancel a call, on its way to the server.
+class CancelFrame : public OutgoingFrame {
+ public:
+  explicit CancelFrame(uint64 call_id) : call_id_(call_id) {}
+
+  void Write(io::CodedOutputStream* output) {
+    WriteFrame(output, call_id_, FRAME_CANCEL, NULL, NULL, NULL);
+  }
+  void Done() { delete this; }
+
+ private:
+  uint64 call_id_;
+};
+
+}  // namespace
+
+// ===================================================================
+
+SocketRpcController::SocketRpcController()
+  : failed_(false), canceled_(false), cancel_callback_(NULL),
+    channel_(NULL), call_id_(0) {}
+
+SocketRpcController::~SocketRpcController() {}
+
+void SocketRpcController::Reset() {
+  MutexLock lock(&mutex_);
+  GOOGLE_CHECK(channel_ == NULL) << "Reset() called while a call is in progress.";
+  failed_ = false;
+  error_text_.clear();
+  canceled_ = false;
+  cancel_callback_ = NULL;
+}
+
+bool SocketRpcController::Failed() const {
+  MutexLock lock(&mutex_);
+  return failed_;
+}
+
+string SocketRpcController::ErrorText() const {
+  MutexLock lock(&mutex_);
+  return error_text_;
+}
+
+void SocketRpcController::StartCancel() {
+  SocketRpcChannel* channel;
+  uint64 call_id;
+  {
+    MutexLock lock(&mutex_);
+    channel = channel_;
+    call_id = call_id_;
+  }
+  // If the call finishes in the meantime, the server ignores the request.
+  if (channel != NULL) channel->SendCancel(call_id);
+}
+
+void SocketRpcController::SetFailed(const string& reason) {
+  MutexLock lock(&mutex_);
+  failed_ = true;
+  error_text_ = reason;
+}
+
+bool SocketRpcController::IsCanceled() const {
+  MutexLock lock(&mutex_);
+  return canceled_;
+}
+
+void SocketRpcController::NotifyOnCancel(Closure* callback) {
+  {
+    MutexLock lock(&mutex_);
+    if (!canceled_) {
+      cancel_callback_ = callback;
+      return;
+    }
+  }
+  callback->Run();
+}
+
+Closure* SocketRpcController::Cancel() {
+  MutexLock lock(&mutex_);
+  canceled_ = true;
+  Closure* callback = cancel_callback_;
+  cancel_callback_ = NULL;
+  return callback;
+}
+
+void SocketRpcController::RunCancelCallback() {
+  Closure* callback;
+  {
+    MutexLock lock(&mutex_);
+    callback = cancel_callback_;
+    cancel_callback_ = NULL;
+  }
+  if (callback != NULL) callback->Run();
+}
+
+// ===================================================================
+
+// A call made on a SocketRpcChannel which has not completed yet.
+class SocketRpcChannel::PendingCall : public OutgoingFrame {
+ public:
+  PendingCall(Connection* connection, uint64 call_id,
+              const MethodDescriptor* method,
+              SocketRpcController* controller,
+              const Message* request, Message* response, Closure* done)
+    : connection_(connection), call_id_(call_id), method_(method),
+      controller_(controller), request_(request), response_(response),
+      done_(done), written_(false), finished_(false) {}
+
+  // implements OutgoingFrame ----------------------------------------
+  void Write(io::CodedOutputStream* output) {
+    WriteFrame(output, call_id_, FRAME_REQUEST, &method_->full_name(), NULL,
+               request_);
+  }
+  void Done();
+
+ private:
+  friend class Connection;
+
+  Connection* connection_;
+  const uint64 call_id_;
+  const MethodDescriptor* method_;
+  SocketRpcController* controller_;
+  const Message* request_;
+  Message* response_;
+  Closure* done_;
+
+  // The call completes once the request has been written and the response
+  // (or an error) has arrived, whichever comes last.  Until then, the caller
+  // may not touch the request.  Both are guarded by the connection's mutex.
+  bool written_;
+  bool finished_;
+  string error_;
+};
+
+// The client end of a socket.
+class SocketRpcChannel::Connection : public FrameReader {
+ public:
+  Connection(SocketRpcChannel* channel, int socket)
+    : channel_(channel), socket_(socket), writer_(socket), closed_(false),
+      next_call_id_(1), current_call_(NULL) {
+    reader_thread_ = StartThread(NewCallback(this, &Connection::Run));
+  }
+
+  ~Connection() {
+    // Wake up the reader, which fails all calls in progress.
+    shutdown(socket_, SHUT_RDWR);
+    pthread_join(reader_thread_, NULL);
+    close(socket_);
+  }
+
+  void StartCall(const MethodDescriptor* method,
+                 SocketRpcController* controller,
+                 const Message* request, Message* response, Closure* done) {
+    PendingCall* call;
+    {
+      MutexLock lock(&mutex_);
+      if (closed_) {
+        call = NULL;
+      } else {
+        call = new PendingCall(this, next_call_id_++, method, controller,
+                               request, response, done);
+        pending_[call->call_id_] = call;
+      }
+    }
+    if (call == NULL) {
+      controller->SetFailed("Connection closed.");
+      done->Run();
+      return;
+    }
+
+    {
+      MutexLock lock(&controller->mutex_);
+      controller->channel_ = channel_;
+      controller->call_id_ = call->call_id_;
+    }
+    writer_.Write(call);
+  }
+
+  void SendCancel(uint64 call_id) {
+    writer_.Write(new CancelFrame(call_id));
+  }
+
+  // Called by PendingCall::Done().
+  void CallWritten(PendingCall* call) {
+    bool finished;
+    {
+      MutexLock lock(&mutex_);
+      call->written_ = true;
+      finished = call->finished_;
+    }
+    if (finished) Complete(call);
+  }
+
+ private:
+  void Run() {
+    ReadFrames(socket_);
+
+    // The connection is gone; fail everything still in progress, including
+    // a call whose response could not be parsed.
+    writer_.Fail();
+    vector<PendingCall*> completed;
+    {
+      MutexLock lock(&mutex_);
+      closed_ = true;
+      if (current_call_ != NULL) {
+        pending_[current_call_->call_id_] = current_call_;
+        current_call_ = NULL;
+      }
+      for (map<uint64, PendingCall*>::iterator iter = pending_.begin();
+           iter != pending_.end(); ++iter) {
+        PendingCall* call = iter->second;
+        call->finished_ = true;
+        if (call->error_.empty()) call->error_ = "Connection closed.";
+        if (call->written_) completed.push_back(call);
+      }
+      pending_.clear();
+    }
+    for (int i = 0; i < completed.size(); i++) {
+      Complete(completed[i]);
+    }
+  }
+
+  // implements FrameReader ------------------------------------------
+
+  bool ReadPayload(const FrameHeader& header, io::CodedInputStream* input) {
+    if (header.kind != FRAME_RESPONSE) return false;
+    {
+      MutexLock lock(&mutex_);
+      current_call_ = FindPtrOrNull(pending_, header.call_id);
+      if (current_call_ != NULL) pending_.erase(header.call_id);
+    }
+    if (current_call_ == NULL) return SkipPayload(input);
+
+    // The response is parsed straight out of the socket's buffer.  If it is
+    // malformed, the reader gives up on the connection and Run() fails the
+    // call.
+    if (!ReadMessage(input, current_call_->response_,
+                     &current_call_->error_)) {
+      current_call_->error_ = "Malformed response.";
+      return false;
+    }
+    return true;
+  }
+
+  void HandleFrame(const FrameHeader& header) {
+    if (header.kind != FRAME_RESPONSE) return;
+
+    PendingCall* call = current_call_;
+    current_call_ = NULL;
+    bool written;
+    {
+      MutexLock lock(&mutex_);
+      if (call == NULL) {
+        // A response with no payload.
+        call = FindPtrOrNull(pending_, header.call_id);
+        if (call == NULL) return;
+        pending_.erase(header.call_id);
+      }
+      if (header.has_error) call->error_ = header.error;
+      call->finished_ = true;
+      written = call->written_;
+    }
+    if (written) Complete(call);
+  }
+
+  // Reports the result of a call and deletes it.
+  void Complete(PendingCall* call) {
+    SocketRpcController* controller = call->controller_;
+    {
+      MutexLock lock(&controller->mutex_);
+      if (!call->error_.empty()) {
+        controller->failed_ = true;
+        controller->error_text_ = call->error_;
+      }
+      controller->channel_ = NULL;
+    }
+    Closure* done = call->done_;
+    delete call;
+    done->Run();
+  }
+
+  SocketRpcChannel* channel_;
+  const int socket_;
+  FrameWriter writer_;
+  pthread_t reader_thread_;
+
+  Mutex mutex_;
+  bool closed_;
+  uint64 next_call_id_;
+  map<uint64, PendingCall*> pending_;
+
+  // Used only by the reader thread:  the call whose response is being read.
+  PendingCall* current_call_;
+};
+
+void SocketRpcChannel::PendingCall::Done() {
+  connection_->CallWritten(this);
+}
+
+SocketRpcChannel::SocketRpcChannel(int socket)
+  : connection_(new Connection(this, socket)) {}
+
+SocketRpcChannel::~SocketRpcChannel() {
+  delete connection_;
+}
+
+SocketRpcChannel* SocketRpcChannel::ConnectUnix(const string& path) {
+  struct sockaddr_un address;
+  if (!MakeUnixAddress(path, &address)) return NULL;
+
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0) {
+    GOOGLE_LOG(ERROR) << "socket: " << strerror(errno);
+    return NULL;
+  }
+  if (connect(sock, reinterpret_cast<struct sockaddr*>(&address),
+              sizeof(address)) != 0) {
+    GOOGLE_LOG(ERROR) << "connect(" << path << "): " << strerror(errno);
+    close(sock);
+    return NULL;
+  }
+  ConfigureSocket(sock, false);
+  return new SocketRpcChannel(sock);
+}
+
+SocketRpcChannel* SocketRpcChannel::ConnectTcp(const string& host, int port) {
+  struct addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  char port_text[16];
+  snprintf(port_text, sizeof(port_text), "%d", port);
+
+  struct addrinfo* addresses;
+  int result = getaddrinfo(host.c_str(), port_text, &hints, &addresses);
+  if (result != 0) {
+    GOOGLE_LOG(ERROR) << "getaddrinfo(" << host << "): "
+                      << gai_strerror(result);
+    return NULL;
+  }
+
+  int sock = -1;
+  for (struct addrinfo* address = addresses; address != NULL;
+       address = address->ai_next) {
+    sock = socket(address->ai_family, address->ai_socktype,
+                  address->ai_protocol);
+    if (sock < 0) continue;
+    if (connect(sock, address->ai_addr, address->ai_addrlen) == 0) break;
+    close(sock);
+    sock = -1;
+  }
+  freeaddrinfo(addresses);
+
+  if (sock < 0) {
+    GOOGLE_LOG(ERROR) << "Could not connect to " << host << ":" << port << ".";
+    return NULL;
+  }
+  ConfigureSocket(sock, true);
+  return new SocketRpcChannel(sock);
+}
+
+void SocketRpcChannel::CallMethod(const MethodDescriptor* method,
+                                  RpcController* controller,
+                                  const Message* request,
+                                  Message* response,
+                                  Closure* done) {
+  connection_->StartCall(method,
+                         down_cast<SocketRpcController*>(controller),
+                         request, response, done);
+}
+
+void SocketRpcChannel::SendCancel(uint64 call_id) {
+  connection_->SendCancel(call_id);
+}
+
+// ===================================================================
+
+// Tracks the listening sockets and open connections of a server.
+class SocketRpcServer::Acceptor {
+ public:
+  explicit Acceptor(SocketRpcServer* server)
+    : server_(server), shutting_down_(false), connection_count_(0) {
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&no_connections_, NULL);
+    if (pipe(wakeup_pipe_) != 0) {
+      GOOGLE_LOG(FATAL) << "pipe: " << strerror(errno);
+    }
+  }
+
+  ~Acceptor() {
+    close(wakeup_pipe_[0]);
+    close(wakeup_pipe_[1]);
+    pthread_cond_destroy(&no_connections_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  // Starts accepting connections on a socket which is already listening.
+  void AddListener(int socket, bool is_tcp, const string& unix_path) {
+    Listener listener;
+    listener.socket = socket;
+    listener.is_tcp = is_tcp;
+    listener.unix_path = unix_path;
+    listeners_.push_back(listener);
+    listeners_.back().thread =
+      StartThread(NewCallback(this, &Acceptor::AcceptLoop, socket, is_tcp));
+  }
+
+  // See SocketRpcServer::Shutdown().
+  void Shutdown();
+
+  // Called by the last reference to a Connection before it deletes the
+  // connection, and again after.
+  void RemoveConnection(Connection* connection);
+  void ConnectionDeleted();
+
+ private:
+  struct Listener {
+    int socket;
+    bool is_tcp;
+    string unix_path;
+    pthread_t thread;
+  };
+
+  void AcceptLoop(int listen_socket, bool is_tcp);
+
+  SocketRpcServer* server_;
+  vector<Listener> listeners_;
+
+  // Becomes readable when the listeners should stop.
+  int wakeup_pipe_[2];
+
+  pthread_mutex_t mutex_;
+  pthread_cond_t no_connections_;
+  bool shutting_down_;
+  // The connections which still have references.  connection_count_ also
+  // counts the ones which have been removed but not yet deleted.
+  set<Connection*> connections_;
+  int connection_count_;
+};
+
+// A call received by the server which has not been answered yet.
+class SocketRpcServer::ServerCall : public OutgoingFrame {
+ public:
+  ServerCall(Connection* connection, uint64 call_id)
+    : connection_(connection), call_id_(call_id) {}
+
+  // implements OutgoingFrame ----------------------------------------
+  void Write(io::CodedOutputStream* output) {
+    if (controller_.Failed()) {
+      string error = controller_.ErrorText();
+      WriteFrame(output, call_id_, FRAME_RESPONSE, NULL, &error, NULL);
+    } else {
+      WriteFrame(output, call_id_, FRAME_RESPONSE, NULL, NULL,
+                 response_.get());
+    }
+  }
+  void Done();
+
+ private:
+  friend class Connection;
+
+  Connection* connection_;
+  const uint64 call_id_;
+  const MethodEntry* entry_;
+  SocketRpcController controller_;
+  scoped_ptr<Message> request_;
+  scoped_ptr<Message> response_;
+  // Holds the "done" closure given to the service.
+  ClosureStorage done_storage_;
+};
+
+// The server end of a socket.  Reference counted:  the reader thread holds
+// one reference, each call in progress holds another, and Shutdown() holds
+// one while it closes the socket.
+class SocketRpcServer::Connection : public FrameReader {
+ public:
+  Connection(SocketRpcServer* server, Acceptor* acceptor, int socket)
+    : server_(server), acceptor_(acceptor), socket_(socket),
+      writer_(socket), refs_(1), current_call_(NULL) {}
+
+  ~Connection() {
+    close(socket_);
+  }
+
+  void Start() {
+    pthread_detach(StartThread(NewCallback(this, &Connection::Run)));
+  }
+
+  // Wakes up the reader thread so that it stops reading.
+  void Close() {
+    shutdown(socket_, SHUT_RDWR);
+  }
+
+  void Ref() {
+    MutexLock lock(&mutex_);
+    ++refs_;
+  }
+
+  // Like Ref(), but fails if the last reference is already gone, which
+  // means the connection is about to be deleted.
+  bool RefIfReferenced() {
+    MutexLock lock(&mutex_);
+    if (refs_ == 0) return false;
+    ++refs_;
+    return true;
+  }
+
+  void Unref() {
+    bool last;
+    {
+      MutexLock lock(&mutex_);
+      last = --refs_ == 0;
+    }
+    if (last) {
+      Acceptor* acceptor = acceptor_;
+      acceptor->RemoveConnection(this);
+      delete this;
+      acceptor->ConnectionDeleted();
+    }
+  }
+
+ private:
+  void Run() {
+    ReadFrames(socket_);
+    writer_.Fail();
+    delete current_call_;
+    current_call_ = NULL;
+    Unref();
+  }
+
+  // implements FrameReader ------------------------------------------
+
+  bool ReadPayload(const FrameHeader& header, io::CodedInputStream* input) {
+    if (header.kind != FRAME_REQUEST) return false;
+    delete current_call_;
+    current_call_ = NewCall(header);
+    if (current_call_->entry_ == NULL) return SkipPayload(input);
+
+    string error;
+    if (!ReadMessage(input, current_call_->request_.get(), &error)) {
+      return false;
+    }
+    if (!error.empty()) current_call_->controller_.SetFailed(error);
+    return true;
+  }
+
+  void HandleFrame(const FrameHeader& header) {
+    if (header.kind == FRAME_CANCEL) {
+      Closure* callback = NULL;
+      {
+        MutexLock lock(&mutex_);
+        ServerCall* call = FindPtrOrNull(in_progress_, header.call_id);
+        if (call != NULL) callback = call->controller_.Cancel();
+      }
+      if (callback != NULL) callback->Run();
+      return;
+    }
+    if (header.kind != FRAME_REQUEST) return;
+
+    // A request with no payload has an empty request message.
+    ServerCall* call =
+      current_call_ != NULL ? current_call_ : NewCall(header);
+    current_call_ = NULL;
+
+    Ref();
+    if (call->entry_ == NULL) {
+      call->controller_.SetFailed("Method not found: " + header.method);
+    }
+    if (call->controller_.Failed()) {
+      SendResponse(call);
+      return;
+    }
+
+    {
+      MutexLock lock(&mutex_);
+      in_progress_[call->call_id_] = call;
+    }
+    call->entry_->service->CallMethod(
+      call->entry_->method, &call->controller_,
+      call->request_.get(), call->response_.get(),
+      NewCallbackIn(&call->done_storage_, this, &Connection::FinishCall,
+                    call));
+  }
+
+  ServerCall* NewCall(const FrameHeader& header) {
+    ServerCall* call = new ServerCall(this, header.call_id);
+    call->entry_ = server_->FindMethod(header.method);
+    if (call->entry_ != NULL) {
+      Service* service = call->entry_->service;
+      const MethodDescriptor* method = call->entry_->method;
+      call->request_.reset(service->GetRequestPrototype(method).New());
+      call->response_.reset(service->GetResponsePrototype(method).New());
+    }
+    return call;
+  }
+
+  // The "done" callback of each call.
+  void FinishCall(ServerCall* call) {
+    {
+      MutexLock lock(&mutex_);
+      in_progress_.erase(call->call_id_);
+    }
+    call->controller_.RunCancelCallback();
+    SendResponse(call);
+  }
+
+  void SendResponse(ServerCall* call) {
+    // The writer may go on to write other threads' responses after this one
+    // is done, so hold a reference until it returns.
+    Ref();
+    writer_.Write(call);
+    Unref();
+  }
+
+  SocketRpcServer* server_;
+  Acceptor* acceptor_;
+  const int socket_;
+  FrameWriter writer_;
+
+  Mutex mutex_;
+  int refs_;
+  map<uint64, ServerCall*> in_progress_;
+
+  // Used only by the reader thread:  the call whose request is being read.
+  ServerCall* current_call_;
+};
+
+void SocketRpcServer::ServerCall::Done() {
+  Connection* connection = connection_;
+  delete this;
+  connection->Unref();
+}
+
+void SocketRpcServer::Acceptor::AcceptLoop(int listen_socket, bool is_tcp) {
+  struct pollfd fds[2];
+  fds[0].fd = listen_socket;
+  fds[0].events = POLLIN;
+  fds[1].fd = wakeup_pipe_[0];
+  fds[1].events = POLLIN;
+
+  while (true) {
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      GOOGLE_LOG(ERROR) << "poll: " << strerror(errno);
+      return;
+    }
+    if (fds[1].revents != 0) return;
+    if (fds[0].revents == 0) continue;
+
+    int sock = accept(listen_socket, NULL, NULL);
+    if (sock < 0) {
+      if (errno != EINTR && errno != EAGAIN && errno != ECONNABORTED) {
+        GOOGLE_LOG(ERROR) << "accept: " << strerror(errno);
+      }
+      continue;
+    }
+    ConfigureSocket(sock, is_tcp);
+
+    Connection* connection = new Connection(server_, this, sock);
+    pthread_mutex_lock(&mutex_);
+    if (shutting_down_) {
+      pthread_mutex_unlock(&mutex_);
+      delete connection;
+      return;
+    }
+    connections_.insert(connection);
+    ++connection_count_;
+    pthread_mutex_unlock(&mutex_);
+    connection->Start();
+  }
+}
+
+void SocketRpcServer::Acceptor::Shutdown() {
+  pthread_mutex_lock(&mutex_);
+  shutting_down_ = true;
+  pthread_mutex_unlock(&mutex_);
+
+  // Stop the listeners.
+  if (!listeners_.empty()) {
+    char byte = 0;
+    while (write(wakeup_pipe_[1], &byte, 1) < 0 && errno == EINTR) {}
+  }
+  for (int i = 0; i < listeners_.size(); i++) {
+    pthread_join(listeners_[i].thread, NULL);
+    close(listeners_[i].socket);
+    if (!listeners_[i].is_tcp) unlink(listeners_[i].unix_path.c_str());
+  }
+  listeners_.clear();
+
+  // Close the connections and wait for their calls to finish.  Each one is
+  // referenced while it is closed, so that it can't be deleted in between.
+  vector<Connection*> open_connections;
+  pthread_mutex_lock(&mutex_);
+  for (set<Connection*>::iterator iter = connections_.begin();
+       iter != connections_.end(); ++iter) {
+    if ((*iter)->RefIfReferenced()) open_connections.push_back(*iter);
+  }
+  pthread_mutex_unlock(&mutex_);
+  for (int i = 0; i < open_connections.size(); i++) {
+    open_connections[i]->Close();
+    open_connections[i]->Unref();
+  }
+
+  pthread_mutex_lock(&mutex_);
+  while (connection_count_ > 0) {
+    pthread_cond_wait(&no_connections_, &mutex_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void SocketRpcServer::Acceptor::RemoveConnection(Connection* connection) {
+  pthread_mutex_lock(&mutex_);
+  connections_.erase(connection);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void SocketRpcServer::Acceptor::ConnectionDeleted() {
+  pthread_mutex_lock(&mutex_);
+  if (--connection_count_ == 0) pthread_cond_broadcast(&no_connections_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+SocketRpcServer::SocketRpcServer()
+  : acceptor_(new Acceptor(this)) {}
+
+SocketRpcServer::~SocketRpcServer() {
+  Shutdown();
+  delete acceptor_;
+}
+
+bool SocketRpcServer::RegisterService(Service* service) {
+  const ServiceDescriptor* descriptor = service->GetDescriptor();
+  for (int i = 0; i < descriptor->method_count(); i++) {
+    if (methods_.count(descriptor->method(i)->full_name()) > 0) return false;
+  }
+  for (int i = 0; i < descriptor->method_count(); i++) {
+    MethodEntry* entry = &methods_[descriptor->method(i)->full_name()];
+    entry->service = service;
+    entry->method = descriptor->method(i);
+  }
+  return true;
+}
+
+const SocketRpcServer::MethodEntry* SocketRpcServer::FindMethod(
+    const string& full_name) const {
+  MethodMap::const_iterator iter = methods_.find(full_name);
+  return iter == methods_.end() ? NULL : &iter->second;
+}
+
+bool SocketRpcServer::ListenUnix(const string& path) {
+  struct sockaddr_un address;
+  if (!MakeUnixAddress(path, &address)) return false;
+
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (sock < 0) {
+    GOOGLE_LOG(ERROR) << "socket: " << strerror(errno);
+    return false;
+  }
+  if (bind(sock, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(sock, SOMAXCONN) != 0) {
+    GOOGLE_LOG(ERROR) << "Could not listen on " << path << ": "
+                      << strerror(errno);
+    close(sock);
+    return false;
+  }
+  acceptor_->AddListener(sock, false, path);
+  return true;
+}
+
+int SocketRpcServer::ListenTcp(int port) {
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0) {
+    GOOGLE_LOG(ERROR) << "socket: " << strerror(errno);
+    return -1;
+  }
+  int one = 1;
+  setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  struct sockaddr_in address;
+  memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t address_size = sizeof(address);
+  if (bind(sock, reinterpret_cast<struct sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(sock, SOMAXCONN) != 0 ||
+      getsockname(sock, reinterpret_cast<struct sockaddr*>(&address),
+                  &address_size) != 0) {
+    GOOGLE_LOG(ERROR) << "Could not listen on port " << port << ": "
+                      << strerror(errno);
+    close(sock);
+    return -1;
+  }
+  acceptor_->AddListener(sock, true, "");
+  return ntohs(address.sin_port);
+}
+
+void SocketRpcServer::Shutdown() {
+  acceptor_->Shutdown();
+}
+
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,233 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// A reference implementation of the RPC interfaces in service.h, carrying
+// calls over a Unix domain socket or a TCP connection.  It is meant for
+// talking to processes on the same machine (or to serve as a starting point
+// for other transports); it makes no attempt at security, authentication or
+// flow control.
+//
+// Calls are asynchronous:  SocketRpcChannel::CallMethod() queues the request
+// and returns, and "done" is called once the response arrives.  Any number of
+// calls may be outstanding on one channel at once.  Each carries an ID, so the
+// server may answer them in any order.  Small calls made close together are
+// written to the socket together, so a burst of N calls costs roughly one
+// write() rather than N.
+//
+// Example:
+//   // Server
+//   MyServiceImpl service;
+//   SocketRpcServer server;
+//   server.RegisterService(&service);
+//   server.ListenUnix("/tmp/my_service.sock");
+//
+//   // Client
+//   scoped_ptr<SocketRpcChannel> channel(
+//     SocketRpcChannel::ConnectUnix("/tmp/my_service.sock"));
+//   MyService::Stub stub(channel.get());
+//   SocketRpcController controller;
+//   stub.Foo(&controller, &request, &response, NewCallback(&HandleResponse));
+//
+// Wire format:  Each message sent in either direction is a "frame", written
+// as a varint byte count followed by that many bytes which parse as:
+//   message Frame {
+//     optional uint64 call_id = 1;
+//     optional Kind kind = 2 [default = REQUEST];
+//     optional string method = 3;   // Full method name; requests only.
+//     optional string error = 4;    // Set on responses to failed calls.
+//     optional bytes payload = 5;   // The request or response message.
+//     enum Kind { REQUEST = 0; RESPONSE = 1; CANCEL = 2; }
+//   }
+// Fields are always written in field number order, so the payload can be
+// parsed directly out of the socket's buffer without copying it first.
+//
+// Threading:  Each channel and each server-side connection has one thread
+// reading from its socket.  Client "done" callbacks and server Service
+// methods run on that thread, so they should not block; a server method that
+// wants to take its time should call "done" later from some other thread.
+// Writes are done by whichever thread queues a frame while no other thread is
+// writing to that socket.
+//
+// This implementation requires POSIX sockets and pthreads.
+
+#ifndef GOOGLE_PROTOBUF_RPC_SOCKET_RPC_H__
+#define GOOGLE_PROTOBUF_RPC_SOCKET_RPC_H__
+
+#include <string>
+#include <google/protobuf/service.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/hash.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+
+// Defined in this file.
+class SocketRpcController;
+class SocketRpcChannel;
+class SocketRpcServer;
+
+// RpcController used on both ends of a socket RPC.  Clients must pass a
+// SocketRpcController to SocketRpcChannel::CallMethod(); servers pass one to
+// every Service method they call.
+class LIBPROTOBUF_EXPORT SocketRpcController : public RpcController {
+ public:
+  SocketRpcController();
+  ~SocketRpcController();
+
+  // implements RpcController ----------------------------------------
+
+  void Reset();
+  bool Failed() const;
+  string ErrorText() const;
+  void StartCancel();
+  void SetFailed(const string& reason);
+  bool IsCanceled() const;
+  void NotifyOnCancel(Closure* callback);
+
+ private:
+  friend class SocketRpcChannel;
+  friend class SocketRpcServer;
+
+  // Marks a server-side call as canceled.  Returns the cancel callback, which
+  // the caller must run, or NULL if it has been taken already.
+  Closure* Cancel();
+  // Runs the cancel callback of a server-side call that has completed, if it
+  // has not been run already.
+  void RunCancelCallback();
+
+  mutable internal::Mutex mutex_;
+  bool failed_;
+  string error_text_;
+  bool canceled_;
+  Closure* cancel_callback_;
+
+  // Client side:  while a call is in progress, the channel it was made on
+  // and its ID, so that StartCancel() can tell the server.
+  SocketRpcChannel* channel_;
+  uint64 call_id_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SocketRpcController);
+};
+
+// An RpcChannel which sends calls over a connected stream socket to a
+// SocketRpcServer.  CallMethod() may be called from any thread.
+class LIBPROTOBUF_EXPORT SocketRpcChannel : public RpcChannel {
+ public:
+  // Takes ownership of a connected socket.
+  explicit SocketRpcChannel(int socket);
+
+  // Fails any calls still in progress (running their callbacks) and closes
+  // the socket.  Must not be called while another thread is inside
+  // CallMethod().
+  ~SocketRpcChannel();
+
+  // Connect to a server listening on the given Unix domain socket path, or on
+  // the given TCP host and port.  Return NULL (and log why) on failure.
+  static SocketRpcChannel* ConnectUnix(const string& path);
+  static SocketRpcChannel* ConnectTcp(const string& host, int port);
+
+  // implements RpcChannel -------------------------------------------
+
+  // "controller" must be a SocketRpcController.  If the connection has
+  // already failed, "done" is called before CallMethod() returns.
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done);
+
+ private:
+  friend class SocketRpcController;
+  class Connection;
+  class PendingCall;
+
+  void SendCancel(uint64 call_id);
+
+  Connection* connection_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SocketRpcChannel);
+};
+
+// Accepts connections from SocketRpcChannels and dispatches the calls made on
+// them to registered Services.
+class LIBPROTOBUF_EXPORT SocketRpcServer {
+ public:
+  SocketRpcServer();
+  // Calls Shutdown().
+  ~SocketRpcServer();
+
+  // Makes the methods of "service" callable by clients.  The server does not
+  // take ownership; the service must outlive it.  All services must be
+  // registered before the server starts listening.  Returns false if a
+  // service with the same full name is already registered.
+  bool RegisterService(Service* service);
+
+  // Starts accepting connections on a Unix domain socket at "path", which
+  // must not exist yet.  Returns false (and logs why) on failure.
+  bool ListenUnix(const string& path);
+
+  // Starts accepting connections on the given TCP port of the loopback
+  // interface.  If "port" is zero, the system picks a free one.  Returns the
+  // port actually used, or -1 (and logs why) on failure.
+  int ListenTcp(int port);
+
+  // Stops accepting connections, closes all open ones, and waits for every
+  // call in progress to finish.  Service methods which have not yet called
+  // "done" must still do so, or this blocks forever.
+  void Shutdown();
+
+ private:
+  class Connection;
+  class ServerCall;
+  class Acceptor;
+  friend class Connection;
+  friend class ServerCall;
+
+  struct MethodEntry {
+    Service* service;
+    const MethodDescriptor* method;
+  };
+  typedef hash_map<string, MethodEntry> MethodMap;
+
+  // Looks up a method by full name.  Returns NULL if there is none.
+  const MethodEntry* FindMethod(const string& full_name) const;
+
+  MethodMap methods_;
+  Acceptor* acceptor_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SocketRpcServer);
+};
+
+}  // namespace rpc
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_RPC_SOCKET_RPC_H__
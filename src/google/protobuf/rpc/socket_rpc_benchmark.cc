@@ -0,0 +1,325 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Measures the latency and throughput of SocketRpcChannel on this machine,
+// over both a Unix domain socket and TCP loopback.  The server runs in the
+// same process.  Usage:
+//   socket-rpc-benchmark [call_count]
+// Each result is printed on one line of "name=value" pairs.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/rpc/socket_rpc.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+namespace {
+
+double Now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+// Builds an EchoService whose one method takes and returns a message holding
+// a single bytes field.
+const FileDescriptor* BuildEchoFile(DescriptorPool* pool) {
+  FileDescriptorProto file;
+  file.set_name("socket_rpc_benchmark.proto");
+  file.set_package("socket_rpc_benchmark");
+
+  DescriptorProto* message = file.add_message_type();
+  message->set_name("Payload");
+  FieldDescriptorProto* field = message->add_field();
+  field->set_name("data");
+  field->set_number(1);
+  field->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+  field->set_type(FieldDescriptorProto::TYPE_BYTES);
+
+  ServiceDescriptorProto* service = file.add_service();
+  service->set_name("EchoService");
+  MethodDescriptorProto* method = service->add_method();
+  method->set_name("Echo");
+  method->set_input_type(".socket_rpc_benchmark.Payload");
+  method->set_output_type(".socket_rpc_benchmark.Payload");
+
+  return pool->BuildFile(file);
+}
+
+class EchoService : public Service {
+ public:
+  EchoService(const ServiceDescriptor* descriptor, const Message* prototype)
+    : descriptor_(descriptor), prototype_(prototype) {}
+
+  // implements Service ----------------------------------------------
+
+  const ServiceDescriptor* GetDescriptor() { return descriptor_; }
+
+  void CallMethod(const MethodDescriptor* method,
+                  RpcController* controller,
+                  const Message* request,
+                  Message* response,
+                  Closure* done) {
+    response->CopyFrom(*request);
+    done->Run();
+  }
+
+  const Message& GetRequestPrototype(const MethodDescriptor* method) const {
+    return *prototype_;
+  }
+  const Message& GetResponsePrototype(const MethodDescriptor* method) const {
+    return *prototype_;
+  }
+
+ private:
+  const ServiceDescriptor* descriptor_;
+  const Message* prototype_;
+};
+
+// Lets the main thread wait for a callback run by the channel's thread.
+class Waiter {
+ public:
+  Waiter() : signaled_(false) {
+    pthread_mutex_init(&mutex_, NULL);
+    pthread_cond_init(&cond_, NULL);
+  }
+  ~Waiter() {
+    pthread_cond_destroy(&cond_);
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  void Signal() {
+    pthread_mutex_lock(&mutex_);
+    signaled_ = true;
+    pthread_cond_signal(&cond_);
+    pthread_mutex_unlock(&mutex_);
+  }
+
+  void Wait() {
+    pthread_mutex_lock(&mutex_);
+    while (!signaled_) pthread_cond_wait(&cond_, &mutex_);
+    signaled_ = false;
+    pthread_mutex_unlock(&mutex_);
+  }
+
+ private:
+  pthread_mutex_t mutex_;
+  pthread_cond_t cond_;
+  bool signaled_;
+};
+
+// Makes "count" calls one after another and reports the latency of each.
+void RunLatency(const char* transport, RpcChannel* channel,
+                const MethodDescriptor* method, const Message& request,
+                int payload_size, int count) {
+  SocketRpcController controller;
+  scoped_ptr<Message> response(request.New());
+  Waiter waiter;
+  vector<double> latencies;
+
+  for (int i = 0; i < count; i++) {
+    controller.Reset();
+    double start = Now();
+    channel->CallMethod(method, &controller, &request, response.get(),
+                        NewCallback(&waiter, &Waiter::Signal));
+    waiter.Wait();
+    latencies.push_back(Now() - start);
+    GOOGLE_CHECK(!controller.Failed()) << controller.ErrorText();
+  }
+
+  sort(latencies.begin(), latencies.end());
+  double total = 0;
+  for (int i = 0; i < latencies.size(); i++) total += latencies[i];
+  printf("transport=%s mode=latency payload_bytes=%d calls=%d "
+         "mean_us=%.1f p50_us=%.1f p99_us=%.1f\n",
+         transport, payload_size, count, total / count * 1e6,
+         latencies[count / 2] * 1e6, latencies[count * 99 / 100] * 1e6);
+}
+
+// Keeps "depth" calls in flight until "count" have completed, and reports
+// the rate.  Each completed call starts the next one from its callback.
+class ThroughputRun {
+ public:
+  ThroughputRun(RpcChannel* channel, const MethodDescriptor* method,
+                const Message& request, int count, int depth)
+    : channel_(channel), method_(method), request_(request),
+      count_(count), started_(0), finished_(0) {
+    for (int i = 0; i < depth; i++) {
+      controllers_.push_back(new SocketRpcController);
+      responses_.push_back(request.New());
+    }
+  }
+  ~ThroughputRun() {
+    STLDeleteElements(&controllers_);
+    STLDeleteElements(&responses_);
+  }
+
+  // Returns the elapsed time.
+  double Run() {
+    double start = Now();
+    for (int i = 0; i < controllers_.size(); i++) StartCall(i);
+    waiter_.Wait();
+    return Now() - start;
+  }
+
+ private:
+  void StartCall(int slot) {
+    {
+      internal::MutexLock lock(&mutex_);
+      if (started_ == count_) return;
+      ++started_;
+    }
+    controllers_[slot]->Reset();
+    channel_->CallMethod(method_, controllers_[slot], &request_,
+                         responses_[slot],
+                         NewCallback(this, &ThroughputRun::CallDone, slot));
+  }
+
+  void CallDone(int slot) {
+    GOOGLE_CHECK(!controllers_[slot]->Failed())
+      << controllers_[slot]->ErrorText();
+    bool all_done;
+    {
+      internal::MutexLock lock(&mutex_);
+      all_done = ++finished_ == count_;
+    }
+    if (all_done) {
+      waiter_.Signal();
+    } else {
+      StartCall(slot);
+    }
+  }
+
+  RpcChannel* channel_;
+  const MethodDescriptor* method_;
+  const Message& request_;
+  vector<SocketRpcController*> controllers_;
+  vector<Message*> responses_;
+  Waiter waiter_;
+
+  internal::Mutex mutex_;
+  const int count_;
+  int started_;
+  int finished_;
+};
+
+void RunThroughput(const char* transport, RpcChannel* channel,
+                   const MethodDescriptor* method, const Message& request,
+                   int payload_size, int count, int depth) {
+  ThroughputRun run(channel, method, request, count, depth);
+  double seconds = run.Run();
+  printf("transport=%s mode=throughput payload_bytes=%d calls=%d depth=%d "
+         "calls_per_sec=%.0f mb_per_sec=%.1f\n",
+         transport, payload_size, count, depth, count / seconds,
+         2.0 * count * payload_size / seconds / (1 << 20));
+}
+
+void RunAll(const char* transport, RpcChannel* channel,
+            const MethodDescriptor* method, const Message& prototype,
+            int call_count) {
+  const int kPayloadSizes[] = { 16, 1024, 64 << 10 };
+  for (int i = 0; i < GOOGLE_ARRAYSIZE(kPayloadSizes); i++) {
+    int size = kPayloadSizes[i];
+    // Keep the run time roughly the same for large payloads.
+    int count = size > 4096 ? call_count / 10 : call_count;
+
+    scoped_ptr<Message> request(prototype.New());
+    request->GetReflection()->SetString(
+      request.get(), prototype.GetDescriptor()->field(0), string(size, 'x'));
+
+    RunLatency(transport, channel, method, *request, size, count);
+    RunThroughput(transport, channel, method, *request, size, count, 1);
+    RunThroughput(transport, channel, method, *request, size, count, 64);
+  }
+}
+
+int Main(int argc, char* argv[]) {
+  int call_count = argc > 1 ? atoi(argv[1]) : 20000;
+
+  DescriptorPool pool;
+  const FileDescriptor* file = BuildEchoFile(&pool);
+  GOOGLE_CHECK(file != NULL);
+  DynamicMessageFactory factory(&pool);
+  const Message* prototype =
+    factory.GetPrototype(file->FindMessageTypeByName("Payload"));
+  const ServiceDescriptor* service_descriptor = file->service(0);
+  const MethodDescriptor* method = service_descriptor->method(0);
+
+  EchoService service(service_descriptor, prototype);
+  SocketRpcServer server;
+  server.RegisterService(&service);
+
+  char unix_path[64];
+  snprintf(unix_path, sizeof(unix_path), "/tmp/socket_rpc_benchmark.%d",
+           static_cast<int>(getpid()));
+  unlink(unix_path);
+  GOOGLE_CHECK(server.ListenUnix(unix_path));
+  int port = server.ListenTcp(0);
+  GOOGLE_CHECK_GT(port, 0);
+
+  {
+    scoped_ptr<SocketRpcChannel> channel(
+      SocketRpcChannel::ConnectUnix(unix_path));
+    GOOGLE_CHECK(channel != NULL);
+    RunAll("unix", channel.get(), method, *prototype, call_count);
+  }
+  {
+    scoped_ptr<SocketRpcChannel> channel(
+      SocketRpcChannel::ConnectTcp("127.0.0.1", port));
+    GOOGLE_CHECK(channel != NULL);
+    RunAll("tcp", channel.get(), method, *prototype, call_count);
+  }
+
+  server.Shutdown();
+  return 0;
+}
+
+}  // namespace
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
+
+int main(int argc, char* argv[]) {
+  return google::protobuf::rpc::Main(argc, argv);
+}
@@ -0,0 +1,436 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// The test service is protobuf_unittest.TestService, whose messages are
+// empty; the tests carry their data in unknown fields, which the messages
+// preserve through parsing and serialization.
+
+#include <google/protobuf/rpc/socket_rpc.h>
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/unittest_custom_options.pb.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/stubs/stl_util-inl.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace rpc {
+namespace {
+
+// Unknown field numbers used by the tests.
+const int kValueField = 1;    // Echoed back by Foo.
+const int kFailField = 2;     // Makes Foo fail.
+
+int64 GetValue(const Message& message) {
+  const UnknownFieldSet& fields = message.GetReflection()->GetUnknownFields(
+    message);
+  for (int i = 0; i < fields.field_count(); i++) {
+    if (fields.field(i).number() == kValueField) {
+      return fields.field(i).varint();
+    }
+  }
+  return -1;
+}
+
+void SetValue(Message* message, int64 value) {
+  message->GetReflection()->MutableUnknownFields(message)->AddVarint(
+    kValueField, value);
+}
+
+// Counts callbacks, so that tests can wait for calls to finish.
+class Counter {
+ public:
+  Counter() : count_(0) {}
+
+  void Increment() {
+    internal::MutexLock lock(&mutex_);
+    ++count_;
+  }
+
+  int count() {
+    internal::MutexLock lock(&mutex_);
+    return count_;
+  }
+
+  // Waits (up to ten seconds) for the count to reach "count".
+  bool WaitFor(int count) {
+    for (int i = 0; i < 10000; i++) {
+      if (this->count() >= count) return true;
+      usleep(1000);
+    }
+    return false;
+  }
+
+ private:
+  internal::Mutex mutex_;
+  int count_;
+};
+
+// Foo echoes the request's unknown fields (or fails, if asked to).  Bar
+// holds on to its calls until the test releases them.
+class TestServiceImpl : public protobuf_unittest::TestService {
+ public:
+  TestServiceImpl() {}
+
+  struct HeldCall {
+    RpcController* controller;
+    const protobuf_unittest::BarRequest* request;
+    protobuf_unittest::BarResponse* response;
+    Closure* done;
+  };
+
+  // implements TestService ------------------------------------------
+
+  void Foo(RpcController* controller,
+           const protobuf_unittest::FooRequest* request,
+           protobuf_unittest::FooResponse* response,
+           Closure* done) {
+    const UnknownFieldSet& fields = request->unknown_fields();
+    for (int i = 0; i < fields.field_count(); i++) {
+      if (fields.field(i).number() == kFailField) {
+        controller->SetFailed("Failed on purpose.");
+      }
+    }
+    response->mutable_unknown_fields()->MergeFrom(fields);
+    done->Run();
+  }
+
+  void Bar(RpcController* controller,
+           const protobuf_unittest::BarRequest* request,
+           protobuf_unittest::BarResponse* response,
+           Closure* done) {
+    HeldCall call = { controller, request, response, done };
+    internal::MutexLock lock(&mutex_);
+    held_.push_back(call);
+  }
+
+  // -----------------------------------------------------------------
+
+  // Waits for "count" calls to Bar() to arrive, then returns them.
+  vector<HeldCall> WaitForHeldCalls(int count) {
+    for (int i = 0; i < 10000; i++) {
+      {
+        internal::MutexLock lock(&mutex_);
+        if (held_.size() >= count) {
+          vector<HeldCall> result;
+          result.swap(held_);
+          return result;
+        }
+      }
+      usleep(1000);
+    }
+    ADD_FAILURE() << "Timed out waiting for calls to Bar().";
+    return vector<HeldCall>();
+  }
+
+ private:
+  internal::Mutex mutex_;
+  vector<HeldCall> held_;
+};
+
+class SocketRpcTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    ASSERT_TRUE(server_.RegisterService(&service_));
+  }
+
+  void ConnectUnix() {
+    string path = TestTempDir() + "/socket_rpc_unittest.sock";
+    unlink(path.c_str());
+    ASSERT_TRUE(server_.ListenUnix(path));
+    channel_.reset(SocketRpcChannel::ConnectUnix(path));
+    ASSERT_TRUE(channel_ != NULL);
+    stub_.reset(new protobuf_unittest::TestService::Stub(channel_.get()));
+  }
+
+  void ConnectTcp() {
+    int port = server_.ListenTcp(0);
+    ASSERT_GT(port, 0);
+    channel_.reset(SocketRpcChannel::ConnectTcp("localhost", port));
+    ASSERT_TRUE(channel_ != NULL);
+    stub_.reset(new protobuf_unittest::TestService::Stub(channel_.get()));
+  }
+
+  // Declared first so that it is destroyed last.
+  TestServiceImpl service_;
+  SocketRpcServer server_;
+  scoped_ptr<SocketRpcChannel> channel_;
+  scoped_ptr<protobuf_unittest::TestService::Stub> stub_;
+  Counter done_count_;
+};
+
+TEST_F(SocketRpcTest, UnixSocket) {
+  ConnectUnix();
+
+  SocketRpcController controller;
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  SetValue(&request, 123);
+  stub_->Foo(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+  ASSERT_TRUE(done_count_.WaitFor(1));
+
+  EXPECT_FALSE(controller.Failed());
+  EXPECT_EQ(123, GetValue(response));
+}
+
+TEST_F(SocketRpcTest, Pipelining) {
+  // Many calls in flight at once on one connection, over TCP this time.
+  ConnectTcp();
+
+  const int kCallCount = 500;
+  vector<SocketRpcController*> controllers;
+  vector<protobuf_unittest::FooRequest*> requests;
+  vector<protobuf_unittest::FooResponse*> responses;
+  for (int i = 0; i < kCallCount; i++) {
+    controllers.push_back(new SocketRpcController);
+    requests.push_back(new protobuf_unittest::FooRequest);
+    responses.push_back(new protobuf_unittest::FooResponse);
+    SetValue(requests[i], i);
+    stub_->Foo(controllers[i], requests[i], responses[i],
+               NewCallback(&done_count_, &Counter::Increment));
+  }
+  ASSERT_TRUE(done_count_.WaitFor(kCallCount));
+
+  for (int i = 0; i < kCallCount; i++) {
+    EXPECT_FALSE(controllers[i]->Failed());
+    EXPECT_EQ(i, GetValue(*responses[i]));
+  }
+  STLDeleteElements(&controllers);
+  STLDeleteElements(&requests);
+  STLDeleteElements(&responses);
+}
+
+TEST_F(SocketRpcTest, OutOfOrderResponses) {
+  ConnectUnix();
+
+  const int kCallCount = 3;
+  SocketRpcController controllers[kCallCount];
+  protobuf_unittest::BarRequest requests[kCallCount];
+  protobuf_unittest::BarResponse responses[kCallCount];
+  for (int i = 0; i < kCallCount; i++) {
+    SetValue(&requests[i], i);
+    stub_->Bar(&controllers[i], &requests[i], &responses[i],
+               NewCallback(&done_count_, &Counter::Increment));
+  }
+
+  // Answer the calls last-to-first.
+  vector<TestServiceImpl::HeldCall> held =
+    service_.WaitForHeldCalls(kCallCount);
+  ASSERT_EQ(kCallCount, held.size());
+  for (int i = kCallCount - 1; i >= 0; i--) {
+    SetValue(held[i].response, GetValue(*held[i].request) * 10);
+    held[i].done->Run();
+    ASSERT_TRUE(done_count_.WaitFor(kCallCount - i));
+    EXPECT_EQ(i * 10, GetValue(responses[i]));
+  }
+}
+
+TEST_F(SocketRpcTest, Failure) {
+  ConnectUnix();
+
+  SocketRpcController controller;
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  request.mutable_unknown_fields()->AddVarint(kFailField, 1);
+  stub_->Foo(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+  ASSERT_TRUE(done_count_.WaitFor(1));
+
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Failed on purpose.", controller.ErrorText());
+
+  // The connection is still usable.
+  controller.Reset();
+  request.Clear();
+  SetValue(&request, 5);
+  stub_->Foo(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+  ASSERT_TRUE(done_count_.WaitFor(2));
+  EXPECT_FALSE(controller.Failed());
+  EXPECT_EQ(5, GetValue(response));
+}
+
+TEST_F(SocketRpcTest, UnknownMethod) {
+  ConnectUnix();
+
+  // A method of a service the server does not have.
+  const MethodDescriptor* method =
+    protobuf_unittest::TestServiceWithCustomOptions::descriptor()->method(0);
+  SocketRpcController controller;
+  protobuf_unittest::CustomOptionFooRequest request;
+  protobuf_unittest::CustomOptionFooResponse response;
+  channel_->CallMethod(method, &controller, &request, &response,
+                       NewCallback(&done_count_, &Counter::Increment));
+  ASSERT_TRUE(done_count_.WaitFor(1));
+
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Method not found: " + method->full_name(), controller.ErrorText());
+}
+
+TEST_F(SocketRpcTest, Cancel) {
+  ConnectUnix();
+
+  SocketRpcController controller;
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  stub_->Bar(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+
+  vector<TestServiceImpl::HeldCall> held = service_.WaitForHeldCalls(1);
+  ASSERT_EQ(1, held.size());
+  RpcController* server_controller = held[0].controller;
+  Counter cancel_count;
+  server_controller->NotifyOnCancel(
+    NewCallback(&cancel_count, &Counter::Increment));
+
+  controller.StartCancel();
+  ASSERT_TRUE(cancel_count.WaitFor(1));
+  EXPECT_TRUE(server_controller->IsCanceled());
+
+  server_controller->SetFailed("Canceled.");
+  held[0].done->Run();
+  ASSERT_TRUE(done_count_.WaitFor(1));
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Canceled.", controller.ErrorText());
+}
+
+TEST_F(SocketRpcTest, DestroyChannelFailsCalls) {
+  ConnectUnix();
+
+  SocketRpcController controller;
+  protobuf_unittest::BarRequest request;
+  protobuf_unittest::BarResponse response;
+  stub_->Bar(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+  vector<TestServiceImpl::HeldCall> held = service_.WaitForHeldCalls(1);
+  ASSERT_EQ(1, held.size());
+
+  stub_.reset();
+  channel_.reset();
+  ASSERT_EQ(1, done_count_.count());
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Connection closed.", controller.ErrorText());
+
+  // The server can still finish the call; the response goes nowhere.
+  held[0].done->Run();
+}
+
+TEST_F(SocketRpcTest, MalformedResponse) {
+  // The "server" is the other end of a socket pair, which answers the first
+  // call with a payload holding a truncated varint.
+  int sockets[2];
+  ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sockets));
+  channel_.reset(new SocketRpcChannel(sockets[0]));
+  stub_.reset(new protobuf_unittest::TestService::Stub(channel_.get()));
+
+  SocketRpcController controller;
+  protobuf_unittest::FooRequest request;
+  protobuf_unittest::FooResponse response;
+  stub_->Foo(&controller, &request, &response,
+             NewCallback(&done_count_, &Counter::Increment));
+
+  // Wait for the request, whose call ID is 1.
+  char buffer[256];
+  ASSERT_GT(read(sockets[1], buffer, sizeof(buffer)), 0);
+  // call_id = 1, kind = FRAME_RESPONSE, payload = { 0x08 }
+  const char kResponse[] = "\x07\x08\x01\x10\x01\x2a\x01\x08";
+  ASSERT_EQ(sizeof(kResponse) - 1,
+            write(sockets[1], kResponse, sizeof(kResponse) - 1));
+
+  ASSERT_TRUE(done_count_.WaitFor(1));
+  EXPECT_TRUE(controller.Failed());
+  EXPECT_EQ("Malformed response.", controller.ErrorText());
+
+  stub_.reset();
+  channel_.reset();
+  close(sockets[1]);
+  EXPECT_EQ(1, done_count_.count());
+}
+
+void* DeleteChannels(void* channels) {
+  STLDeleteElements(static_cast<vector<SocketRpcChannel*>*>(channels));
+  return NULL;
+}
+
+TEST_F(SocketRpcTest, ShutdownWhileClientsDisconnect) {
+  // Each connection goes away either through Shutdown() closing it or
+  // through its client disconnecting first; both at once must be safe.
+  const int kRounds = 20;
+  const int kChannelCount = 10;
+  for (int round = 0; round < kRounds; round++) {
+    SocketRpcServer server;
+    ASSERT_TRUE(server.RegisterService(&service_));
+    int port = server.ListenTcp(0);
+    ASSERT_GT(port, 0);
+
+    // One call on each channel makes sure that the server has accepted it.
+    vector<SocketRpcChannel*> channels;
+    SocketRpcController controller;
+    protobuf_unittest::FooRequest request;
+    protobuf_unittest::FooResponse response;
+    Counter done_count;
+    for (int i = 0; i < kChannelCount; i++) {
+      channels.push_back(SocketRpcChannel::ConnectTcp("localhost", port));
+      ASSERT_TRUE(channels.back() != NULL);
+      controller.Reset();
+      protobuf_unittest::TestService::Stub stub(channels.back());
+      stub.Foo(&controller, &request, &response,
+               NewCallback(&done_count, &Counter::Increment));
+      ASSERT_TRUE(done_count.WaitFor(i + 1));
+    }
+
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, &DeleteChannels, &channels));
+    server.Shutdown();
+    pthread_join(thread, NULL);
+    EXPECT_TRUE(channels.empty());
+  }
+}
+
+TEST_F(SocketRpcTest, ConnectFailure) {
+  string path = TestTempDir() + "/no_such_socket";
+  EXPECT_TRUE(SocketRpcChannel::ConnectUnix(path) == NULL);
+}
+
+}  // namespace
+}  // namespace rpc
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,127 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/slab_repeated_field.h>
+
+#include <algorithm>
+
+#include <google/protobuf/allocation_profiler.h>
+
+namespace google {
+namespace protobuf {
+namespace internal {
+
+#ifndef _MSC_VER  // MSVC doesn't need this and won't even accept it.
+const int SlabRepeatedFieldBase::kMinSlabElements;
+#endif
+
+SlabRepeatedFieldBase::SlabRepeatedFieldBase()
+  : slabs_(NULL),
+    slab_capacity_(0),
+    element_size_(0) {}
+
+SlabRepeatedFieldBase::~SlabRepeatedFieldBase() {
+  // Take every element, cleared ones included, away from elements_ so that
+  // its destructor does not try to free the ones which live in slabs.
+  while (elements_.ClearedCount() > 0) {
+    DestroyElement(elements_.ReleaseCleared());
+  }
+  while (elements_.size() > 0) {
+    DestroyElement(elements_.ReleaseLast());
+  }
+
+  while (slabs_ != NULL) {
+    Slab* next = slabs_->next;
+    operator delete(slabs_);
+    slabs_ = next;
+  }
+}
+
+void SlabRepeatedFieldBase::Swap(SlabRepeatedFieldBase* other) {
+  elements_.Swap(&other->elements_);
+  std::swap(slabs_, other->slabs_);
+  std::swap(slab_capacity_, other->slab_capacity_);
+  std::swap(element_size_, other->element_size_);
+}
+
+void* SlabRepeatedFieldBase::AllocateElement(int element_size) {
+  if (slabs_ == NULL || slabs_->used == slabs_->capacity) {
+    AddSlab(element_size, 1);
+  }
+  return slabs_->data() + element_size * slabs_->used++;
+}
+
+void SlabRepeatedFieldBase::ReserveElements(int element_size, int count) {
+  if (slabs_ == NULL || slabs_->capacity - slabs_->used < count) {
+    AddSlab(element_size, count);
+  }
+}
+
+void SlabRepeatedFieldBase::AddSlab(int element_size, int min_elements) {
+  GOOGLE_DCHECK(element_size_ == 0 || element_size_ == element_size);
+  element_size_ = element_size;
+
+  // Each slab at least doubles the total capacity, so that there are few
+  // slabs for InSlab() to look through.
+  int capacity = std::max(std::max(min_elements, kMinSlabElements),
+                          slab_capacity_);
+  int bytes = kHeaderSize + capacity * element_size;
+  SampleAllocation(AllocationProfiler::REPEATED_ELEMENT, bytes);
+
+  Slab* slab = reinterpret_cast<Slab*>(operator new(bytes));
+  slab->next = slabs_;
+  slab->capacity = capacity;
+  slab->used = 0;
+  slabs_ = slab;
+  slab_capacity_ += capacity;
+}
+
+bool SlabRepeatedFieldBase::InSlab(const MessageLite* element) const {
+  const char* address = reinterpret_cast<const char*>(element);
+  for (Slab* slab = slabs_; slab != NULL; slab = slab->next) {
+    const char* begin = slab->data();
+    if (address >= begin && address < begin + slab->used * element_size_) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void SlabRepeatedFieldBase::DestroyElement(MessageLite* element) const {
+  if (InSlab(element)) {
+    element->~MessageLite();
+  } else {
+    delete element;
+  }
+}
+
+}  // namespace internal
+}  // namespace protobuf
+}  // namespace google
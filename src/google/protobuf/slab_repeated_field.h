@@ -0,0 +1,207 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// SlabRepeatedField is the storage generated code uses for repeated message
+// fields with the "contiguous" option, e.g.:
+//   repeated Point points = 1 [contiguous = true];
+//
+// A RepeatedPtrField allocates each of its elements separately, so walking
+// a long list of sub-messages chases pointers all over the heap.  A
+// SlabRepeatedField instead constructs its elements in slabs:  blocks of
+// memory holding many elements each, so that consecutive elements are
+// usually adjacent in memory.  Slabs grow geometrically, and Reserve() can
+// make sure that the next elements added share a single slab.
+//
+// Elements never move once added, so pointers to them stay valid for as
+// long as they would in a RepeatedPtrField.  As with RepeatedPtrField,
+// Clear() and RemoveLast() keep the cleared elements to be reused by later
+// calls to Add(), so a field that is cleared and refilled (e.g. by parsing
+// into the same message over and over) reuses its slabs rather than
+// allocating again.
+//
+// Because elements cannot be handed out of or into a slab, there are no
+// AddAllocated() or ReleaseLast() methods.  Everything else is read through
+// elements(), the same RepeatedPtrField view reflection uses.
+
+#ifndef GOOGLE_PROTOBUF_SLAB_REPEATED_FIELD_H__
+#define GOOGLE_PROTOBUF_SLAB_REPEATED_FIELD_H__
+
+#include <new>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/message_lite.h>
+#include <google/protobuf/repeated_field.h>
+
+namespace google {
+namespace protobuf {
+
+namespace internal {
+
+// The part of SlabRepeatedField which does not depend on the element type.
+// Reflection and DynamicMessage see contiguous fields as this, and through
+// it as a repeated message field.  Elements added through reflection are
+// allocated separately, and freed separately.
+class LIBPROTOBUF_EXPORT SlabRepeatedFieldBase {
+ public:
+  SlabRepeatedFieldBase();
+  ~SlabRepeatedFieldBase();
+
+  // Swaps the elements along with the slabs holding them.
+  void Swap(SlabRepeatedFieldBase* other);
+
+  // Returns the number of elements which fit in the slabs.
+  int SlabCapacity() const { return slab_capacity_; }
+
+ protected:
+  // Must be first:  reflection finds the repeated field at the offset of
+  // the slab field.  The elements are of the generated message type; see
+  // SlabRepeatedField::elements().
+  RepeatedPtrField<MessageLite> elements_;
+
+  // Returns memory for one element of the given size, which must be the
+  // same for every call, adding a slab if the newest one is full.
+  void* AllocateElement(int element_size);
+  // Makes sure that the next count calls to AllocateElement() return
+  // memory from a single slab.
+  void ReserveElements(int element_size, int count);
+
+ private:
+  struct Slab {
+    Slab* next;      // The next older slab.
+    int capacity;    // Number of elements that fit.
+    int used;        // Number of elements constructed so far.
+    char* data() {
+      return reinterpret_cast<char*>(this) + kHeaderSize;
+    }
+  };
+  // Keeps the elements aligned for any type they may contain.
+  static const int kHeaderSize = (sizeof(Slab) + 7) & ~7;
+  static const int kMinSlabElements = 8;
+
+  Slab* slabs_;        // The newest slab, which is the one still filling.
+  int slab_capacity_;  // Total capacity of all slabs.
+  int element_size_;
+
+  // Adds a slab, which becomes the newest one, with room for at least
+  // min_elements.
+  void AddSlab(int element_size, int min_elements);
+  // Does the element live in one of the slabs?
+  bool InSlab(const MessageLite* element) const;
+  // Destroys an element, freeing it only if it was allocated separately.
+  void DestroyElement(MessageLite* element) const;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SlabRepeatedFieldBase);
+};
+
+}  // namespace internal
+
+// Element is the generated message type of the field.
+template <typename Element>
+class SlabRepeatedField : public internal::SlabRepeatedFieldBase {
+ public:
+  typedef typename RepeatedPtrField<Element>::iterator iterator;
+  typedef typename RepeatedPtrField<Element>::const_iterator const_iterator;
+
+  SlabRepeatedField() {}
+  ~SlabRepeatedField() {}
+
+  int size() const { return elements().size(); }
+
+  const Element& Get(int index) const { return elements().Get(index); }
+  Element* Mutable(int index) { return mutable_elements()->Mutable(index); }
+  Element* Add();
+  void RemoveLast() { mutable_elements()->RemoveLast(); }
+  void Clear() { mutable_elements()->Clear(); }
+  void MergeFrom(const SlabRepeatedField& other);
+
+  // Makes room for the field to grow to at least the given size without
+  // allocating again.  Elements added after a call to Reserve() on an empty
+  // (or cleared) field are all placed in a single slab.
+  void Reserve(int new_size);
+
+  void Swap(SlabRepeatedField* other) { SlabRepeatedFieldBase::Swap(other); }
+  void SwapElements(int index1, int index2) {
+    mutable_elements()->SwapElements(index1, index2);
+  }
+
+  // The elements, in order.
+  const RepeatedPtrField<Element>& elements() const {
+    return *reinterpret_cast<const RepeatedPtrField<Element>*>(&elements_);
+  }
+
+  iterator begin() { return mutable_elements()->begin(); }
+  const_iterator begin() const { return elements().begin(); }
+  iterator end() { return mutable_elements()->end(); }
+  const_iterator end() const { return elements().end(); }
+
+ private:
+  RepeatedPtrField<Element>* mutable_elements() {
+    return reinterpret_cast<RepeatedPtrField<Element>*>(&elements_);
+  }
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SlabRepeatedField);
+};
+
+// implementation ====================================================
+
+template <typename Element>
+inline Element* SlabRepeatedField<Element>::Add() {
+  RepeatedPtrField<Element>* elements = mutable_elements();
+  if (elements->ClearedCount() > 0) {
+    // Reuse the oldest cleared element, which is the next one in order.
+    return elements->Add();
+  }
+  Element* result = new(AllocateElement(sizeof(Element))) Element;
+  elements->AddAllocated(result);
+  return result;
+}
+
+template <typename Element>
+void SlabRepeatedField<Element>::MergeFrom(const SlabRepeatedField& other) {
+  GOOGLE_CHECK_NE(&other, this);
+  Reserve(size() + other.size());
+  for (int i = 0; i < other.size(); i++) {
+    Add()->MergeFrom(other.Get(i));
+  }
+}
+
+template <typename Element>
+void SlabRepeatedField<Element>::Reserve(int new_size) {
+  RepeatedPtrField<Element>* elements = mutable_elements();
+  // Cleared elements will be reused first, so they need no new space.
+  int to_allocate = new_size - size() - elements->ClearedCount();
+  if (to_allocate <= 0) return;
+  elements->Reserve(new_size);
+  ReserveElements(sizeof(Element), to_allocate);
+}
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_SLAB_REPEATED_FIELD_H__
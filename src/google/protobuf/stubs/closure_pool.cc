@@ -0,0 +1,151 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/stubs/closure_pool.h>
+#include <google/protobuf/stubs/once.h>
+
+#include "config.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN  // We only need minimal includes
+#include <windows.h>
+#elif defined(HAVE_PTHREAD)
+#include <pthread.h>
+#else
+#error "No suitable threading library available."
+#endif
+
+namespace google {
+namespace protobuf {
+namespace internal {
+
+namespace {
+
+// Blocks beyond this many on one thread's list are freed rather than kept.
+// A thread which only runs callbacks made by other threads would otherwise
+// collect them without bound.
+const int kMaxFreeBlocks = 256;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head;
+  int size;
+};
+
+void DeleteFreeList(void* arg) {
+  FreeList* list = reinterpret_cast<FreeList*>(arg);
+  while (list->head != NULL) {
+    FreeBlock* block = list->head;
+    list->head = block->next;
+    operator delete(block);
+  }
+  delete list;
+}
+
+#ifdef _WIN32
+
+// Windows has no destructors for thread-local slots, so the blocks kept by
+// a thread which exits are leaked.
+DWORD free_list_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(free_list_slot_once);
+
+void InitFreeListSlot() {
+  free_list_slot = TlsAlloc();
+}
+
+inline FreeList* GetFreeList() {
+  return reinterpret_cast<FreeList*>(TlsGetValue(free_list_slot));
+}
+
+inline void SetFreeList(FreeList* list) {
+  TlsSetValue(free_list_slot, list);
+}
+
+#else
+
+pthread_key_t free_list_slot;
+GOOGLE_PROTOBUF_DECLARE_ONCE(free_list_slot_once);
+
+void InitFreeListSlot() {
+  pthread_key_create(&free_list_slot, &DeleteFreeList);
+}
+
+inline FreeList* GetFreeList() {
+  return reinterpret_cast<FreeList*>(pthread_getspecific(free_list_slot));
+}
+
+inline void SetFreeList(FreeList* list) {
+  pthread_setspecific(free_list_slot, list);
+}
+
+#endif
+
+// Returns the current thread's list, creating it if need be.
+FreeList* CurrentFreeList() {
+  GoogleOnceInit(&free_list_slot_once, &InitFreeListSlot);
+  FreeList* list = GetFreeList();
+  if (list == NULL) {
+    list = new FreeList;
+    list->head = NULL;
+    list->size = 0;
+    SetFreeList(list);
+  }
+  return list;
+}
+
+}  // namespace
+
+void* AllocateClosureBlock() {
+  FreeList* list = CurrentFreeList();
+  FreeBlock* block = list->head;
+  if (block == NULL) return operator new(sizeof(ClosureStorage));
+  list->head = block->next;
+  --list->size;
+  return block;
+}
+
+void ReleaseClosureBlock(void* memory) {
+  FreeList* list = CurrentFreeList();
+  if (list->size >= kMaxFreeBlocks) {
+    operator delete(memory);
+    return;
+  }
+  FreeBlock* block = reinterpret_cast<FreeBlock*>(memory);
+  block->next = list->head;
+  list->head = block;
+  ++list->size;
+}
+
+}  // namespace internal
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,322 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// Closures which don't need a heap allocation of their own.
+//
+// NewCallback() allocates a closure object every time it is called, which
+// adds up when a callback is made for every RPC.  The functions here build
+// the same kind of one-shot closure in memory that is already at hand:
+//
+//   NewCallbackIn(&storage, ...) builds the closure in a ClosureStorage
+//   owned by the caller, typically a member of a per-call object that
+//   exists anyway:
+//     class PendingCall {
+//       ...
+//       ClosureStorage done_storage_;
+//     };
+//     service->Foo(controller, request, response,
+//                  NewCallbackIn(&call->done_storage_,
+//                                this, &Handler::FooDone, call));
+//
+//   NewPooledCallback(...) takes its memory from a free list kept by each
+//   thread, and gives it back (to the list of the thread that runs it) when
+//   run.  Once the lists are warm, it allocates nothing.
+//
+// Both take the same arguments as NewCallback(), with up to three bound
+// arguments.  The closure, bound arguments included, must fit in a
+// ClosureStorage; that is checked at compile time, and is the case for any
+// arguments no bigger than a pointer.  Like those from NewCallback(), the
+// closures may be run only once.  They release their memory before calling
+// the function, so a callback may build a new closure in its own storage.
+
+#ifndef GOOGLE_PROTOBUF_STUBS_CLOSURE_POOL_H__
+#define GOOGLE_PROTOBUF_STUBS_CLOSURE_POOL_H__
+
+#include <new>
+#include <google/protobuf/stubs/common.h>
+
+namespace google {
+namespace protobuf {
+
+// Raw memory big enough for a closure with three pointer-sized arguments
+// bound to a method.  The closure built in it keeps a pointer to it until
+// the closure is run.
+class ClosureStorage {
+ public:
+  static const int kSize = 64;
+
+  inline ClosureStorage() {}
+
+  inline void* data() { return data_.bytes; }
+
+ private:
+  union {
+    char bytes[kSize];
+    // For alignment.
+    void* pointer;
+    void (*function)();
+    double float_value;
+    int64 int_value;
+  } data_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ClosureStorage);
+};
+
+namespace internal {
+
+// Gets a block of sizeof(ClosureStorage) bytes from the current thread's
+// free list, allocating one if the list is empty.
+LIBPROTOBUF_EXPORT void* AllocateClosureBlock();
+// Puts a block from AllocateClosureBlock() on the current thread's free
+// list, or frees it if the list is full.
+LIBPROTOBUF_EXPORT void ReleaseClosureBlock(void* block);
+
+// The bound calls.  Each holds a function or method and its arguments.
+struct FunctionCall0 {
+  void (*function)();
+  void operator()() const { function(); }
+};
+template <typename Arg1>
+struct FunctionCall1 {
+  void (*function)(Arg1);
+  Arg1 arg1;
+  void operator()() const { function(arg1); }
+};
+template <typename Arg1, typename Arg2>
+struct FunctionCall2 {
+  void (*function)(Arg1, Arg2);
+  Arg1 arg1;
+  Arg2 arg2;
+  void operator()() const { function(arg1, arg2); }
+};
+template <typename Arg1, typename Arg2, typename Arg3>
+struct FunctionCall3 {
+  void (*function)(Arg1, Arg2, Arg3);
+  Arg1 arg1;
+  Arg2 arg2;
+  Arg3 arg3;
+  void operator()() const { function(arg1, arg2, arg3); }
+};
+template <typename Class>
+struct MethodCall0 {
+  Class* object;
+  void (Class::*method)();
+  void operator()() const { (object->*method)(); }
+};
+template <typename Class, typename Arg1>
+struct MethodCall1 {
+  Class* object;
+  void (Class::*method)(Arg1);
+  Arg1 arg1;
+  void operator()() const { (object->*method)(arg1); }
+};
+template <typename Class, typename Arg1, typename Arg2>
+struct MethodCall2 {
+  Class* object;
+  void (Class::*method)(Arg1, Arg2);
+  Arg1 arg1;
+  Arg2 arg2;
+  void operator()() const { (object->*method)(arg1, arg2); }
+};
+template <typename Class, typename Arg1, typename Arg2, typename Arg3>
+struct MethodCall3 {
+  Class* object;
+  void (Class::*method)(Arg1, Arg2, Arg3);
+  Arg1 arg1;
+  Arg2 arg2;
+  Arg3 arg3;
+  void operator()() const { (object->*method)(arg1, arg2, arg3); }
+};
+
+// A one-shot closure living in memory it does not own.  When run, it
+// destroys itself, returns the memory to the pool if it came from there,
+// and only then makes the call.
+template <typename Call>
+class PlacedClosure : public Closure {
+ public:
+  PlacedClosure(const Call& call, bool pooled)
+    : call_(call), pooled_(pooled) {}
+  ~PlacedClosure() {}
+
+  void Run() {
+    Call call = call_;
+    bool pooled = pooled_;
+    this->~PlacedClosure();
+    if (pooled) ReleaseClosureBlock(this);
+    call();
+  }
+
+ private:
+  Call call_;
+  bool pooled_;
+};
+
+template <typename Call>
+inline Closure* PlaceClosure(void* memory, const Call& call, bool pooled) {
+  GOOGLE_COMPILE_ASSERT(sizeof(PlacedClosure<Call>) <= ClosureStorage::kSize,
+                        closure_too_large_for_ClosureStorage);
+  return new(memory) PlacedClosure<Call>(call, pooled);
+}
+
+}  // namespace internal
+
+// -------------------------------------------------------------------
+// NewCallbackIn():  builds the closure in "storage", which must stay valid
+// until the closure is run.  See the top of this file.
+
+inline Closure* NewCallbackIn(ClosureStorage* storage, void (*function)()) {
+  internal::FunctionCall0 call = { function };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Arg1>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              void (*function)(Arg1), Arg1 arg1) {
+  internal::FunctionCall1<Arg1> call = { function, arg1 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Arg1, typename Arg2>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              void (*function)(Arg1, Arg2),
+                              Arg1 arg1, Arg2 arg2) {
+  internal::FunctionCall2<Arg1, Arg2> call = { function, arg1, arg2 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Arg1, typename Arg2, typename Arg3>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              void (*function)(Arg1, Arg2, Arg3),
+                              Arg1 arg1, Arg2 arg2, Arg3 arg3) {
+  internal::FunctionCall3<Arg1, Arg2, Arg3> call =
+    { function, arg1, arg2, arg3 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Class>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              Class* object, void (Class::*method)()) {
+  internal::MethodCall0<Class> call = { object, method };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Class, typename Arg1>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              Class* object, void (Class::*method)(Arg1),
+                              Arg1 arg1) {
+  internal::MethodCall1<Class, Arg1> call = { object, method, arg1 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Class, typename Arg1, typename Arg2>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              Class* object,
+                              void (Class::*method)(Arg1, Arg2),
+                              Arg1 arg1, Arg2 arg2) {
+  internal::MethodCall2<Class, Arg1, Arg2> call =
+    { object, method, arg1, arg2 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+template <typename Class, typename Arg1, typename Arg2, typename Arg3>
+inline Closure* NewCallbackIn(ClosureStorage* storage,
+                              Class* object,
+                              void (Class::*method)(Arg1, Arg2, Arg3),
+                              Arg1 arg1, Arg2 arg2, Arg3 arg3) {
+  internal::MethodCall3<Class, Arg1, Arg2, Arg3> call =
+    { object, method, arg1, arg2, arg3 };
+  return internal::PlaceClosure(storage->data(), call, false);
+}
+
+// -------------------------------------------------------------------
+// NewPooledCallback():  builds the closure in memory from the current
+// thread's free list.  See the top of this file.
+
+inline Closure* NewPooledCallback(void (*function)()) {
+  internal::FunctionCall0 call = { function };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Arg1>
+inline Closure* NewPooledCallback(void (*function)(Arg1), Arg1 arg1) {
+  internal::FunctionCall1<Arg1> call = { function, arg1 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Arg1, typename Arg2>
+inline Closure* NewPooledCallback(void (*function)(Arg1, Arg2),
+                                  Arg1 arg1, Arg2 arg2) {
+  internal::FunctionCall2<Arg1, Arg2> call = { function, arg1, arg2 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Arg1, typename Arg2, typename Arg3>
+inline Closure* NewPooledCallback(void (*function)(Arg1, Arg2, Arg3),
+                                  Arg1 arg1, Arg2 arg2, Arg3 arg3) {
+  internal::FunctionCall3<Arg1, Arg2, Arg3> call =
+    { function, arg1, arg2, arg3 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Class>
+inline Closure* NewPooledCallback(Class* object, void (Class::*method)()) {
+  internal::MethodCall0<Class> call = { object, method };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Class, typename Arg1>
+inline Closure* NewPooledCallback(Class* object, void (Class::*method)(Arg1),
+                                  Arg1 arg1) {
+  internal::MethodCall1<Class, Arg1> call = { object, method, arg1 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Class, typename Arg1, typename Arg2>
+inline Closure* NewPooledCallback(Class* object,
+                                  void (Class::*method)(Arg1, Arg2),
+                                  Arg1 arg1, Arg2 arg2) {
+  internal::MethodCall2<Class, Arg1, Arg2> call =
+    { object, method, arg1, arg2 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+template <typename Class, typename Arg1, typename Arg2, typename Arg3>
+inline Closure* NewPooledCallback(Class* object,
+                                  void (Class::*method)(Arg1, Arg2, Arg3),
+                                  Arg1 arg1, Arg2 arg2, Arg3 arg3) {
+  internal::MethodCall3<Class, Arg1, Arg2, Arg3> call =
+    { object, method, arg1, arg2, arg3 };
+  return internal::PlaceClosure(internal::AllocateClosureBlock(), call, true);
+}
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_STUBS_CLOSURE_POOL_H__
@@ -0,0 +1,217 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/stubs/closure_pool.h>
+
+#include <set>
+#include <vector>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+class ClosurePoolTest : public testing::Test {
+ public:
+  void SetA123Method()   { a_ = 123; }
+  static void SetA123Function() { current_instance_->a_ = 123; }
+
+  void SetAMethod(int a)         { a_ = a; }
+  static void SetAFunction(int a)         { current_instance_->a_ = a; }
+
+  void SetABMethod(int a, const char* b)  { a_ = a; b_ = b; }
+  static void SetABFunction(int a, const char* b) {
+    current_instance_->a_ = a;
+    current_instance_->b_ = b;
+  }
+
+  void SetABCMethod(int a, const char* b, double c) {
+    a_ = a; b_ = b; c_ = c;
+  }
+  static void SetABCFunction(int a, const char* b, double c) {
+    current_instance_->a_ = a;
+    current_instance_->b_ = b;
+    current_instance_->c_ = c;
+  }
+
+  // Counts down to zero, building each next callback in the storage the
+  // current one was built in.
+  void CountDown(int n) {
+    a_ = n;
+    if (n > 0) {
+      next_ = NewCallbackIn(&storage_, this, &ClosurePoolTest::CountDown,
+                            n - 1);
+    } else {
+      next_ = NULL;
+    }
+  }
+
+  virtual void SetUp() {
+    current_instance_ = this;
+    a_ = 0;
+    b_ = NULL;
+    c_ = 0;
+    next_ = NULL;
+  }
+
+  int a_;
+  const char* b_;
+  double c_;
+  ClosureStorage storage_;
+  Closure* next_;
+
+  static ClosurePoolTest* current_instance_;
+};
+
+ClosurePoolTest* ClosurePoolTest::current_instance_ = NULL;
+
+TEST_F(ClosurePoolTest, InStorageFunctions) {
+  const char* cstr = "hello";
+
+  Closure* closure = NewCallbackIn(&storage_, &SetA123Function);
+  EXPECT_EQ(storage_.data(), static_cast<void*>(closure));
+  closure->Run();
+  EXPECT_EQ(123, a_);
+
+  NewCallbackIn(&storage_, &SetAFunction, 456)->Run();
+  EXPECT_EQ(456, a_);
+
+  NewCallbackIn(&storage_, &SetABFunction, 789, cstr)->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+
+  NewCallbackIn(&storage_, &SetABCFunction, 12, cstr, 3.5)->Run();
+  EXPECT_EQ(12, a_);
+  EXPECT_EQ(3.5, c_);
+}
+
+TEST_F(ClosurePoolTest, InStorageMethods) {
+  const char* cstr = "hello";
+
+  NewCallbackIn(&storage_, current_instance_,
+                &ClosurePoolTest::SetA123Method)->Run();
+  EXPECT_EQ(123, a_);
+
+  NewCallbackIn(&storage_, current_instance_,
+                &ClosurePoolTest::SetAMethod, 456)->Run();
+  EXPECT_EQ(456, a_);
+
+  NewCallbackIn(&storage_, current_instance_,
+                &ClosurePoolTest::SetABMethod, 789, cstr)->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+
+  NewCallbackIn(&storage_, current_instance_,
+                &ClosurePoolTest::SetABCMethod, 12, cstr, 3.5)->Run();
+  EXPECT_EQ(12, a_);
+  EXPECT_EQ(cstr, b_);
+  EXPECT_EQ(3.5, c_);
+}
+
+TEST_F(ClosurePoolTest, CallbackReusesItsStorage) {
+  next_ = NewCallbackIn(&storage_, current_instance_,
+                        &ClosurePoolTest::CountDown, 5);
+  int runs = 0;
+  while (next_ != NULL) {
+    next_->Run();
+    ++runs;
+  }
+  EXPECT_EQ(6, runs);
+  EXPECT_EQ(0, a_);
+}
+
+TEST_F(ClosurePoolTest, PooledFunctions) {
+  const char* cstr = "hello";
+
+  NewPooledCallback(&SetA123Function)->Run();
+  EXPECT_EQ(123, a_);
+
+  NewPooledCallback(&SetAFunction, 456)->Run();
+  EXPECT_EQ(456, a_);
+
+  NewPooledCallback(&SetABFunction, 789, cstr)->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+
+  NewPooledCallback(&SetABCFunction, 12, cstr, 3.5)->Run();
+  EXPECT_EQ(12, a_);
+  EXPECT_EQ(3.5, c_);
+}
+
+TEST_F(ClosurePoolTest, PooledMethods) {
+  const char* cstr = "hello";
+
+  NewPooledCallback(current_instance_, &ClosurePoolTest::SetA123Method)->Run();
+  EXPECT_EQ(123, a_);
+
+  NewPooledCallback(current_instance_,
+                    &ClosurePoolTest::SetAMethod, 456)->Run();
+  EXPECT_EQ(456, a_);
+
+  NewPooledCallback(current_instance_,
+                    &ClosurePoolTest::SetABMethod, 789, cstr)->Run();
+  EXPECT_EQ(789, a_);
+  EXPECT_EQ(cstr, b_);
+
+  NewPooledCallback(current_instance_,
+                    &ClosurePoolTest::SetABCMethod, 12, cstr, 3.5)->Run();
+  EXPECT_EQ(12, a_);
+  EXPECT_EQ(cstr, b_);
+  EXPECT_EQ(3.5, c_);
+}
+
+TEST_F(ClosurePoolTest, PooledMemoryIsReused) {
+  Closure* first = NewPooledCallback(&SetAFunction, 1);
+  first->Run();
+  // The block just released is the first one handed out again.
+  Closure* second = NewPooledCallback(&SetAFunction, 2);
+  EXPECT_EQ(first, second);
+  second->Run();
+  EXPECT_EQ(2, a_);
+
+  // Many outstanding callbacks get distinct blocks.
+  vector<Closure*> closures;
+  set<Closure*> distinct;
+  for (int i = 0; i < 1000; i++) {
+    closures.push_back(NewPooledCallback(&SetAFunction, i));
+    distinct.insert(closures.back());
+  }
+  EXPECT_EQ(closures.size(), distinct.size());
+  for (int i = 0; i < closures.size(); i++) {
+    closures[i]->Run();
+  }
+  EXPECT_EQ(999, a_);
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
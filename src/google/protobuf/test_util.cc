@@ -330,6 +330,8 @@ void TestUtil::ExpectAllFieldsSet(const unittest::TestAllTypes& message) {
 #ifndef PROTOBUF_TEST_NO_DESCRIPTORS
   ASSERT_EQ(2, message.repeated_string_piece_size());
   ASSERT_EQ(2, message.repeated_cord_size());
+  EXPECT_EQ("224", message.repeated_string_piece(0).ToString());
+  EXPECT_EQ("324", message.repeated_string_piece(1).ToString());
 #endif
 
   EXPECT_EQ(201  , message.repeated_int32   (0));
@@ -602,6 +604,8 @@ void TestUtil::ExpectRepeatedFieldsModified(
 #ifndef PROTOBUF_TEST_NO_DESCRIPTORS
   ASSERT_EQ(2, message.repeated_string_piece_size());
   ASSERT_EQ(2, message.repeated_cord_size());
+  EXPECT_EQ("224", message.repeated_string_piece(0).ToString());
+  EXPECT_EQ("524", message.repeated_string_piece(1).ToString());
 #endif
 
   EXPECT_EQ(201  , message.repeated_int32   (0));
@@ -1876,6 +1880,8 @@ void TestUtil::ExpectRepeatedsSwapped(
 #ifndef PROTOBUF_TEST_NO_DESCRIPTORS
   ASSERT_EQ(2, message.repeated_string_piece_size());
   ASSERT_EQ(2, message.repeated_cord_size());
+  EXPECT_EQ("324", message.repeated_string_piece(0).ToString());
+  EXPECT_EQ("224", message.repeated_string_piece(1).ToString());
 #endif
 
   // Test that the first element and second element are flipped.
@@ -34,6 +34,7 @@
 
 #include <google/protobuf/stubs/common.h>
 #include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/allocation_profiler.h>
 #include <google/protobuf/stubs/stl_util-inl.h>
 #include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/io/zero_copy_stream.h>
@@ -122,6 +123,8 @@ string* UnknownFieldSet::AddLengthDelimited(int number) {
   UnknownField field;
   field.number_ = number;
   field.type_ = UnknownField::TYPE_LENGTH_DELIMITED;
+  internal::SampleAllocation(AllocationProfiler::UNKNOWN_FIELD,
+                             sizeof(string));
   field.length_delimited_ = new string;
   fields_->push_back(field);
   return field.length_delimited_;
@@ -33,6 +33,7 @@
 //  Sanjay Ghemawat, Jeff Dean, and others.
 
 #include <google/protobuf/wire_format_lite_inl.h>
+#include <google/protobuf/repeated_string_piece_field.h>
 
 #include <stack>
 #include <string>
@@ -290,6 +291,14 @@ void WireFormatLite::WriteBytes(int field_number, const string& value,
   output->WriteVarint32(value.size());
   output->WriteString(value);
 }
+void WireFormatLite::WriteStringPiece(int field_number,
+                                      const StringPiece& value,
+                                      io::CodedOutputStream* output) {
+  WriteTag(field_number, WIRETYPE_LENGTH_DELIMITED, output);
+  output->WriteVarint32(value.size());
+  output->WriteRaw(value.data(), value.size());
+}
+
 
 
 void WireFormatLite::WriteGroup(int field_number,
@@ -354,6 +363,29 @@ bool WireFormatLite::ReadBytes(io::CodedInputStream* input,
   return input->InternalReadStringInline(value, length);
 }
 
+bool WireFormatLite::ReadStringPiece(io::CodedInputStream* input,
+                                     RepeatedStringPieceField* value) {
+  uint32 length;
+  if (!input->ReadVarint32(&length)) return false;
+  int size = length;
+  if (size < 0) return false;  // security: size is often user-supplied
+
+  const void* data;
+  int buffer_size;
+  input->GetDirectBufferPointerInline(&data, &buffer_size);
+  if (buffer_size >= size) {
+    value->Add(static_cast<const char*>(data), size);
+    return input->Skip(size);
+  }
+
+  // The value straddles buffers.  Read it into a string first rather than
+  // growing the field by a length that the input may not really contain.
+  string buffer;
+  if (!input->ReadString(&buffer, size)) return false;
+  value->Add(buffer.data(), size);
+  return true;
+}
+
 }  // namespace internal
 }  // namespace protobuf
 }  // namespace google
@@ -42,11 +42,13 @@
 
 #include <string>
 #include <google/protobuf/message_lite.h>
+#include <google/protobuf/stubs/stringpiece.h>
 
 namespace google {
 
 namespace protobuf {
   template <typename T> class RepeatedField;  // repeated_field.h
+  class RepeatedStringPieceField;   // repeated_string_piece_field.h
   namespace io {
     class CodedInputStream;             // coded_stream.h
     class CodedOutputStream;            // coded_stream.h
@@ -291,6 +293,10 @@ class LIBPROTOBUF_EXPORT WireFormatLite {
   static bool ReadString(input, string* value);
   static bool ReadBytes (input, string* value);
 
+  // Reads a string or bytes value and adds it to the end of a repeated
+  // ctype=STRING_PIECE field, copying it from the input only once.
+  static bool ReadStringPiece(input, RepeatedStringPieceField* value);
+
   static inline bool ReadGroup  (field_number, input, MessageLite* value);
   static inline bool ReadMessage(input, MessageLite* value);
 
@@ -342,6 +348,9 @@ class LIBPROTOBUF_EXPORT WireFormatLite {
 
   static void WriteString(field_number, const string& value, output);
   static void WriteBytes (field_number, const string& value, output);
+  // Writes a string or bytes value held outside a string.
+  static void WriteStringPiece(
+    field_number, const StringPiece& value, output);
 
   static void WriteGroup(
     field_number, const MessageLite& value, output);
@@ -420,6 +429,8 @@ class LIBPROTOBUF_EXPORT WireFormatLite {
     field_number, const string& value, output) INL;
   static inline uint8* WriteBytesToArray(
     field_number, const string& value, output) INL;
+  static inline uint8* WriteStringPieceToArray(
+    field_number, const StringPiece& value, output) INL;
 
   static inline uint8* WriteGroupToArray(
       field_number, const MessageLite& value, output) INL;
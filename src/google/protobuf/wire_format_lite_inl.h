@@ -654,6 +654,15 @@ inline uint8* WireFormatLite::WriteBytesToArray(int field_number,
   target = io::CodedOutputStream::WriteVarint32ToArray(value.size(), target);
   return io::CodedOutputStream::WriteStringToArray(value, target);
 }
+inline uint8* WireFormatLite::WriteStringPieceToArray(int field_number,
+                                                      const StringPiece& value,
+                                                      uint8* target) {
+  target = WriteTagToArray(field_number, WIRETYPE_LENGTH_DELIMITED, target);
+  target = io::CodedOutputStream::WriteVarint32ToArray(value.size(), target);
+  return io::CodedOutputStream::WriteRawToArray(value.data(), value.size(),
+                                                target);
+}
+
 
 
 inline uint8* WireFormatLite::WriteGroupToArray(int field_number,
@@ -0,0 +1,329 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/wire_patch.h>
+
+#include <algorithm>
+#include <set>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/wire_format_lite_inl.h>
+
+namespace google {
+namespace protobuf {
+
+using internal::WireFormatLite;
+using io::CodedInputStream;
+using io::CodedOutputStream;
+
+namespace {
+
+static const int kMaxVarintBytes = 10;
+static const int kMaxVarint32Bytes = 5;
+
+void AppendVarint32(uint32 value, string* output) {
+  uint8 buffer[kMaxVarint32Bytes];
+  uint8* end = CodedOutputStream::WriteVarint32ToArray(value, buffer);
+  output->append(reinterpret_cast<char*>(buffer), end - buffer);
+}
+
+void AppendRange(const char* data, int begin, int end, string* output) {
+  if (end > begin) output->append(data + begin, end - begin);
+}
+
+// Is "prefix" the path of "path" or of a message containing it?
+bool IsPrefix(const vector<int>& prefix, const vector<int>& path) {
+  return prefix.size() <= path.size() &&
+         equal(prefix.begin(), prefix.end(), path.begin());
+}
+
+}  // namespace
+
+WirePatch::WirePatch() {}
+WirePatch::~WirePatch() {}
+
+WirePatch::Operation* WirePatch::AddOperation(
+    Kind kind, const vector<int>& path,
+    WireFormatLite::WireType wire_type) {
+  GOOGLE_CHECK(!path.empty()) << "WirePatch paths must not be empty.";
+  for (int i = 0; i < path.size(); i++) {
+    GOOGLE_CHECK_GT(path[i], 0) << "Invalid field number in WirePatch path.";
+  }
+
+  operations_.push_back(Operation());
+  Operation* operation = &operations_.back();
+  operation->kind = kind;
+  operation->path = path;
+  operation->wire_type = wire_type;
+  return operation;
+}
+
+void WirePatch::ReplaceVarint(const vector<int>& path, uint64 value) {
+  uint8 buffer[kMaxVarintBytes];
+  uint8* end = CodedOutputStream::WriteVarint64ToArray(value, buffer);
+  AddOperation(REPLACE, path, WireFormatLite::WIRETYPE_VARINT)
+      ->value.assign(reinterpret_cast<char*>(buffer), end - buffer);
+}
+
+void WirePatch::ReplaceFixed32(const vector<int>& path, uint32 value) {
+  uint8 buffer[sizeof(value)];
+  CodedOutputStream::WriteLittleEndian32ToArray(value, buffer);
+  AddOperation(REPLACE, path, WireFormatLite::WIRETYPE_FIXED32)
+      ->value.assign(reinterpret_cast<char*>(buffer), sizeof(buffer));
+}
+
+void WirePatch::ReplaceFixed64(const vector<int>& path, uint64 value) {
+  uint8 buffer[sizeof(value)];
+  CodedOutputStream::WriteLittleEndian64ToArray(value, buffer);
+  AddOperation(REPLACE, path, WireFormatLite::WIRETYPE_FIXED64)
+      ->value.assign(reinterpret_cast<char*>(buffer), sizeof(buffer));
+}
+
+void WirePatch::ReplaceLengthDelimited(const vector<int>& path,
+                                       const string& value) {
+  Operation* operation =
+      AddOperation(REPLACE, path, WireFormatLite::WIRETYPE_LENGTH_DELIMITED);
+  AppendVarint32(value.size(), &operation->value);
+  operation->value.append(value);
+}
+
+void WirePatch::AppendVarint(const vector<int>& path, uint64 value) {
+  ReplaceVarint(path, value);
+  operations_.back().kind = APPEND;
+}
+
+void WirePatch::AppendFixed32(const vector<int>& path, uint32 value) {
+  ReplaceFixed32(path, value);
+  operations_.back().kind = APPEND;
+}
+
+void WirePatch::AppendFixed64(const vector<int>& path, uint64 value) {
+  ReplaceFixed64(path, value);
+  operations_.back().kind = APPEND;
+}
+
+void WirePatch::AppendLengthDelimited(const vector<int>& path,
+                                      const string& value) {
+  ReplaceLengthDelimited(path, value);
+  operations_.back().kind = APPEND;
+}
+
+void WirePatch::Remove(const vector<int>& path) {
+  // The wire type is unused; any occurrence is removed.
+  AddOperation(REMOVE, path, WireFormatLite::WIRETYPE_VARINT);
+}
+
+void WirePatch::Clear() {
+  operations_.clear();
+}
+
+bool WirePatch::Apply(const string& input, string* output) const {
+  return Apply(input.data(), input.size(), output);
+}
+
+bool WirePatch::Apply(const void* data, int size, string* output) const {
+  // A replacement or removal cancels the operations added before it on the
+  // same field or on fields inside it.
+  vector<const Operation*> operations;
+  operations.reserve(operations_.size());
+  for (int i = 0; i < operations_.size(); i++) {
+    bool cancelled = false;
+    for (int j = i + 1; j < operations_.size() && !cancelled; j++) {
+      cancelled = operations_[j].kind != APPEND &&
+                  IsPrefix(operations_[j].path, operations_[i].path);
+    }
+    if (!cancelled) operations.push_back(&operations_[i]);
+  }
+
+  output->clear();
+  CodedInputStream input(reinterpret_cast<const uint8*>(data), size);
+  // The buffer is already in memory, so the usual limit on the total size
+  // of a message only gets in the way.
+  input.SetTotalBytesLimit(size, -1);
+  return PatchMessage(&input, reinterpret_cast<const char*>(data),
+                      operations, 0, output);
+}
+
+void WirePatch::WriteValue(const Operation& operation, int depth,
+                           string* output) {
+  AppendVarint32(WireFormatLite::MakeTag(operation.path[depth],
+                                         operation.wire_type),
+                 output);
+  output->append(operation.value);
+}
+
+bool WirePatch::PatchMessage(CodedInputStream* input, const char* data,
+                             const vector<const Operation*>& operations,
+                             int depth, string* output) {
+  // Fields which an operation ending here removes or replaces, and embedded
+  // message fields which an operation passes through and which have been
+  // found in the input.
+  set<int> dropped;
+  set<int> found;
+  for (int i = 0; i < operations.size(); i++) {
+    const Operation* operation = operations[i];
+    if (operation->path.size() == depth + 1 && operation->kind != APPEND) {
+      dropped.insert(operation->path[depth]);
+    }
+  }
+
+  vector<bool> written(operations.size(), false);
+  vector<const Operation*> children;
+
+  // Start of the bytes which have been read but not yet copied to output.
+  int copy_from = input->CurrentPosition();
+
+  while (true) {
+    int field_start = input->CurrentPosition();
+    uint32 tag = input->ReadTag();
+    if (tag == 0) break;
+    if (WireFormatLite::GetTagWireType(tag) ==
+        WireFormatLite::WIRETYPE_END_GROUP) {
+      return false;
+    }
+    int field_number = WireFormatLite::GetTagFieldNumber(tag);
+
+    if (dropped.count(field_number) > 0) {
+      AppendRange(data, copy_from, field_start, output);
+      if (!WireFormatLite::SkipField(input, tag)) return false;
+
+      // A replacement takes the place of the first occurrence.
+      for (int i = 0; i < operations.size(); i++) {
+        const Operation* operation = operations[i];
+        if (operation->kind == REPLACE && !written[i] &&
+            operation->path.size() == depth + 1 &&
+            operation->path[depth] == field_number) {
+          WriteValue(*operation, depth, output);
+          written[i] = true;
+        }
+      }
+      copy_from = input->CurrentPosition();
+      continue;
+    }
+
+    children.clear();
+    for (int i = 0; i < operations.size(); i++) {
+      const Operation* operation = operations[i];
+      if (operation->path.size() > depth + 1 &&
+          operation->path[depth] == field_number) {
+        children.push_back(operation);
+      }
+    }
+
+    if (children.empty()) {
+      // Leave the field where it is; it is copied along with its neighbors.
+      if (!WireFormatLite::SkipField(input, tag)) return false;
+      continue;
+    }
+
+    if (WireFormatLite::GetTagWireType(tag) !=
+        WireFormatLite::WIRETYPE_LENGTH_DELIMITED) {
+      return false;
+    }
+    uint32 length;
+    if (!input->ReadVarint32(&length)) return false;
+    // PushLimit() would quietly shorten a length which runs past the end of
+    // the enclosing message.
+    if (length > static_cast<uint32>(input->BytesUntilLimit())) return false;
+    if (!input->IncrementRecursionDepth()) return false;
+    CodedInputStream::Limit limit = input->PushLimit(length);
+
+    // The new length isn't known until the contents are written, so the
+    // contents are patched into a temporary first.
+    string contents;
+    if (!PatchMessage(input, data, children, depth + 1, &contents)) {
+      return false;
+    }
+
+    input->PopLimit(limit);
+    input->DecrementRecursionDepth();
+
+    AppendRange(data, copy_from, field_start, output);
+    AppendVarint32(tag, output);
+    AppendVarint32(contents.size(), output);
+    output->append(contents);
+    copy_from = input->CurrentPosition();
+    found.insert(field_number);
+  }
+
+  if (!input->ConsumedEntireMessage()) return false;
+  AppendRange(data, copy_from, input->CurrentPosition(), output);
+
+  // Whatever has not been written yet goes at the end of the message, in the
+  // order in which the operations were added.
+  set<int> created;
+  for (int i = 0; i < operations.size(); i++) {
+    const Operation* operation = operations[i];
+    int field_number = operation->path[depth];
+
+    if (operation->path.size() == depth + 1) {
+      if (operation->kind == APPEND ||
+          (operation->kind == REPLACE && !written[i])) {
+        WriteValue(*operation, depth, output);
+      }
+      continue;
+    }
+
+    if (dropped.count(field_number) > 0 || found.count(field_number) > 0 ||
+        created.count(field_number) > 0) {
+      continue;
+    }
+    created.insert(field_number);
+
+    // Build the missing message by patching an empty one.
+    children.clear();
+    for (int j = i; j < operations.size(); j++) {
+      if (operations[j]->path.size() > depth + 1 &&
+          operations[j]->path[depth] == field_number) {
+        children.push_back(operations[j]);
+      }
+    }
+    CodedInputStream empty(NULL, 0);
+    string contents;
+    if (!PatchMessage(&empty, NULL, children, depth + 1, &contents)) {
+      return false;
+    }
+
+    // If the operations were all removals there is nothing to create.
+    if (!contents.empty()) {
+      AppendVarint32(WireFormatLite::MakeTag(
+                         field_number,
+                         WireFormatLite::WIRETYPE_LENGTH_DELIMITED),
+                     output);
+      AppendVarint32(contents.size(), output);
+      output->append(contents);
+    }
+  }
+
+  return true;
+}
+
+}  // namespace protobuf
+}  // namespace google
@@ -0,0 +1,154 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+// WirePatch edits messages in their serialized form.  It is meant for
+// programs like routers which forward large messages and only need to
+// rewrite one or two fields, such as a hop count or a trace ID, on the way
+// through.  Parsing the message, changing it and serializing it again
+// costs time in proportion to the whole message; WirePatch instead scans
+// the bytes with a CodedInputStream, copies every range it doesn't touch
+// verbatim, and rewrites only the fields named by its operations and the
+// length prefixes of the sub-messages containing them.  No message objects
+// are created, so it works without generated code or descriptors.
+//
+// Fields are named by paths of field numbers, starting from the top-level
+// message.  Every number but the last names an embedded message field.
+// For example, if field 3 of the top-level message is a Header, and field
+// 2 of Header is a hop count, then this sets the hop count:
+//   WirePatch patch;
+//   vector<int> path;
+//   path.push_back(3);
+//   path.push_back(2);
+//   patch.ReplaceVarint(path, hops + 1);
+//   patch.Apply(input, &output);
+//
+// Values are given in their wire form: a sint32 must be ZigZag-encoded
+// first (see WireFormatLite::ZigZagEncode32()), a negative int32 must be
+// sign-extended to 64 bits, and an embedded message is passed as its
+// serialized bytes.
+//
+// If an embedded message field along a path occurs several times, as the
+// elements of a repeated field do, the operation applies to every
+// occurrence.  If it does not occur at all, Replace and Append operations
+// create it.  Paths can't pass through groups.
+
+#ifndef GOOGLE_PROTOBUF_WIRE_PATCH_H__
+#define GOOGLE_PROTOBUF_WIRE_PATCH_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/stubs/common.h>
+#include <google/protobuf/wire_format_lite.h>
+
+namespace google {
+namespace protobuf {
+  namespace io {
+    class CodedInputStream;            // coded_stream.h
+  }
+}
+
+namespace protobuf {
+
+class LIBPROTOBUF_EXPORT WirePatch {
+ public:
+  WirePatch();
+  ~WirePatch();
+
+  // Replaces the field at the given path.  Every existing occurrence of the
+  // field is removed, and the new value is written where the first of them
+  // was, or at the end of the containing message if there were none.
+  void ReplaceVarint(const vector<int>& path, uint64 value);
+  void ReplaceFixed32(const vector<int>& path, uint32 value);
+  void ReplaceFixed64(const vector<int>& path, uint64 value);
+  void ReplaceLengthDelimited(const vector<int>& path, const string& value);
+
+  // Adds an occurrence of the field at the given path to the end of the
+  // containing message.  For a repeated field this adds an element.
+  void AppendVarint(const vector<int>& path, uint64 value);
+  void AppendFixed32(const vector<int>& path, uint32 value);
+  void AppendFixed64(const vector<int>& path, uint64 value);
+  void AppendLengthDelimited(const vector<int>& path, const string& value);
+
+  // Removes every occurrence of the field at the given path.  Operations
+  // on fields inside a field which is removed or replaced are ignored.
+  void Remove(const vector<int>& path);
+
+  // Discards all operations.
+  void Clear();
+  bool empty() const { return operations_.empty(); }
+
+  // Applies the operations, in the order they were added, to the serialized
+  // message in the input and stores the result in *output, which must not
+  // overlap the input.  A Replace or Remove cancels every operation added
+  // before it on the same field or on fields inside it; e.g. Append() then
+  // Replace() on one path leaves only the replacement.  Returns false if the
+  // input is malformed or if a path passes through a field which is not
+  // length-delimited.
+  bool Apply(const string& input, string* output) const;
+  bool Apply(const void* data, int size, string* output) const;
+
+ private:
+  enum Kind {
+    REPLACE,
+    APPEND,
+    REMOVE
+  };
+
+  struct Operation {
+    Kind kind;
+    vector<int> path;
+    internal::WireFormatLite::WireType wire_type;
+    string value;  // Already encoded, including any length prefix.
+  };
+
+  Operation* AddOperation(Kind kind, const vector<int>& path,
+                          internal::WireFormatLite::WireType wire_type);
+
+  // Copies the message which the input is positioned at, up to the current
+  // limit, into *output while applying the given operations, whose paths
+  // all lead through this message.  depth is the index in those paths of
+  // the fields of this message.
+  static bool PatchMessage(io::CodedInputStream* input, const char* data,
+                           const vector<const Operation*>& operations,
+                           int depth, string* output);
+
+  // Writes the field operation->path[depth] with operation's value.
+  static void WriteValue(const Operation& operation, int depth,
+                         string* output);
+
+  vector<Operation> operations_;
+
+  GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(WirePatch);
+};
+
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_WIRE_PATCH_H__
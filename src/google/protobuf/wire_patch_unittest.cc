@@ -0,0 +1,292 @@
+// Protocol Buffers - Google's data interchange format
+// Copyright 2008 Google Inc.  All rights reserved.
+// http://code.google.com/p/protobuf/
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <google/protobuf/wire_patch.h>
+
+#include <google/protobuf/unittest.pb.h>
+#include <google/protobuf/test_util.h>
+
+#include <google/protobuf/testing/googletest.h>
+#include <gtest/gtest.h>
+
+namespace google {
+namespace protobuf {
+namespace {
+
+vector<int> Path(int a) {
+  vector<int> path;
+  path.push_back(a);
+  return path;
+}
+
+vector<int> Path(int a, int b) {
+  vector<int> path = Path(a);
+  path.push_back(b);
+  return path;
+}
+
+class WirePatchTest : public testing::Test {
+ protected:
+  virtual void SetUp() {
+    TestUtil::SetAllFields(&message_);
+    data_ = message_.SerializeAsString();
+  }
+
+  unittest::TestAllTypes message_;
+  string data_;
+};
+
+TEST_F(WirePatchTest, EmptyPatchCopiesInput) {
+  WirePatch patch;
+  string output;
+  EXPECT_TRUE(patch.Apply(data_, &output));
+  EXPECT_EQ(data_, output);
+}
+
+TEST_F(WirePatchTest, ReplaceInPlace) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1), 12345);
+  patch.ReplaceFixed32(Path(7), 54321);
+  patch.ReplaceFixed64(Path(8), GOOGLE_ULONGLONG(1) << 40);
+  patch.ReplaceLengthDelimited(Path(14), "a much longer replacement string");
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  // Replacements take the place of the old values, so the result is the
+  // same as serializing the modified message.
+  message_.set_optional_int32(12345);
+  message_.set_optional_fixed32(54321);
+  message_.set_optional_fixed64(GOOGLE_ULONGLONG(1) << 40);
+  message_.set_optional_string("a much longer replacement string");
+  EXPECT_EQ(message_.SerializeAsString(), output);
+}
+
+TEST_F(WirePatchTest, ReplaceNested) {
+  // The new value is a longer varint, so the length prefix of the nested
+  // message has to change.
+  WirePatch patch;
+  patch.ReplaceVarint(Path(18, 1), 1 << 20);
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  message_.mutable_optional_nested_message()->set_bb(1 << 20);
+  EXPECT_EQ(message_.SerializeAsString(), output);
+}
+
+TEST_F(WirePatchTest, ReplaceInEveryOccurrence) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(48, 1), 7);
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  ASSERT_EQ(2, message_.repeated_nested_message_size());
+  message_.mutable_repeated_nested_message(0)->set_bb(7);
+  message_.mutable_repeated_nested_message(1)->set_bb(7);
+  EXPECT_EQ(message_.SerializeAsString(), output);
+}
+
+TEST_F(WirePatchTest, ReplaceMissingField) {
+  message_.clear_optional_int32();
+  data_ = message_.SerializeAsString();
+
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1), static_cast<uint64>(-5));
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  unittest::TestAllTypes result;
+  ASSERT_TRUE(result.ParseFromString(output));
+  message_.set_optional_int32(-5);
+  EXPECT_EQ(message_.DebugString(), result.DebugString());
+}
+
+TEST_F(WirePatchTest, CreateMissingMessages) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(18, 1), 3);
+  patch.ReplaceVarint(Path(19, 1), 4);
+  patch.Remove(Path(20, 8));
+
+  string output;
+  ASSERT_TRUE(patch.Apply(NULL, 0, &output));
+
+  unittest::TestAllTypes result;
+  ASSERT_TRUE(result.ParseFromString(output));
+  EXPECT_EQ(3, result.optional_nested_message().bb());
+  EXPECT_EQ(4, result.optional_foreign_message().c());
+  // A removal alone does not create anything.
+  EXPECT_FALSE(result.has_optional_import_message());
+}
+
+TEST_F(WirePatchTest, Remove) {
+  WirePatch patch;
+  patch.Remove(Path(14));
+  patch.Remove(Path(31));
+  patch.Remove(Path(18, 1));
+  patch.Remove(Path(12345));
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  message_.clear_optional_string();
+  message_.clear_repeated_int32();
+  message_.mutable_optional_nested_message()->clear_bb();
+  EXPECT_EQ(message_.SerializeAsString(), output);
+}
+
+TEST_F(WirePatchTest, RemoveOverridesNestedOperations) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(18, 1), 3);
+  patch.Remove(Path(18));
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+  message_.clear_optional_nested_message();
+  EXPECT_EQ(message_.SerializeAsString(), output);
+
+  ASSERT_TRUE(patch.Apply(NULL, 0, &output));
+  EXPECT_EQ("", output);
+}
+
+TEST_F(WirePatchTest, LaterOperationsCancelEarlierOnes) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1), 5);
+  patch.Remove(Path(1));
+  patch.AppendVarint(Path(31), 5);
+  patch.ReplaceVarint(Path(31), 6);
+  patch.ReplaceVarint(Path(2), 7);
+  patch.ReplaceVarint(Path(2), 8);
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  unittest::TestAllTypes result;
+  ASSERT_TRUE(result.ParseFromString(output));
+  message_.clear_optional_int32();
+  message_.clear_repeated_int32();
+  message_.add_repeated_int32(6);
+  message_.set_optional_int64(8);
+  EXPECT_EQ(message_.DebugString(), result.DebugString());
+
+  // A removal after the replacement it cancels creates nothing.
+  ASSERT_TRUE(patch.Apply(NULL, 0, &output));
+  ASSERT_TRUE(result.ParseFromString(output));
+  EXPECT_FALSE(result.has_optional_int32());
+  ASSERT_EQ(1, result.repeated_int32_size());
+  EXPECT_EQ(6, result.repeated_int32(0));
+}
+
+TEST_F(WirePatchTest, LargeInput) {
+  // Inputs aren't subject to CodedInputStream's default 64MB limit.
+  message_.set_optional_bytes(string(65 << 20, 'x'));
+  data_ = message_.SerializeAsString();
+
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1), 12345);
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+  message_.set_optional_int32(12345);
+  EXPECT_TRUE(message_.SerializeAsString() == output);
+}
+
+TEST_F(WirePatchTest, Append) {
+  unittest::TestAllTypes::NestedMessage nested;
+  nested.set_bb(99);
+
+  WirePatch patch;
+  patch.AppendVarint(Path(31), 5);
+  patch.AppendVarint(Path(31), 6);
+  patch.AppendLengthDelimited(Path(48), nested.SerializeAsString());
+
+  string output;
+  ASSERT_TRUE(patch.Apply(data_, &output));
+
+  unittest::TestAllTypes result;
+  ASSERT_TRUE(result.ParseFromString(output));
+  message_.add_repeated_int32(5);
+  message_.add_repeated_int32(6);
+  message_.add_repeated_nested_message()->set_bb(99);
+  EXPECT_EQ(message_.DebugString(), result.DebugString());
+}
+
+TEST_F(WirePatchTest, UnknownFieldsCopied) {
+  // Fields the patch doesn't touch are copied byte for byte, whether or not
+  // the reader would know them.
+  unittest::TestEmptyMessage empty;
+  ASSERT_TRUE(empty.ParseFromString(data_));
+  string unknown = empty.SerializeAsString();
+
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1), 1);
+  string output;
+  ASSERT_TRUE(patch.Apply(unknown, &output));
+
+  message_.set_optional_int32(1);
+  EXPECT_EQ(message_.SerializeAsString(), output);
+}
+
+TEST_F(WirePatchTest, MalformedInput) {
+  WirePatch patch;
+  patch.ReplaceVarint(Path(18, 1), 3);
+  string output;
+
+  // Truncated.
+  EXPECT_FALSE(patch.Apply(data_.substr(0, data_.size() - 1), &output));
+
+  // An embedded message whose length runs past the end of the input.
+  WirePatch nested_patch;
+  nested_patch.ReplaceVarint(Path(18, 1), 3);
+  unittest::TestAllTypes message;
+  message.mutable_optional_nested_message()->set_bb(1);
+  string data = message.SerializeAsString();
+  data[2] = 10;
+  EXPECT_FALSE(nested_patch.Apply(data, &output));
+}
+
+TEST_F(WirePatchTest, PathThroughNonMessage) {
+  string output;
+
+  WirePatch patch;
+  patch.ReplaceVarint(Path(1, 1), 3);
+  EXPECT_FALSE(patch.Apply(data_, &output));
+
+  // Groups can't be entered either.
+  WirePatch group_patch;
+  group_patch.ReplaceVarint(Path(16, 17), 3);
+  EXPECT_FALSE(group_patch.Apply(data_, &output));
+}
+
+}  // namespace
+}  // namespace protobuf
+}  // namespace google
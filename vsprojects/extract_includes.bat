@@ -9,6 +9,9 @@ md include\google\protobuf\compiler\java
 md include\google\protobuf\compiler\python
 copy ..\src\google\protobuf\stubs\common.h include\google\protobuf\stubs\common.h
 copy ..\src\google\protobuf\stubs\once.h include\google\protobuf\stubs\once.h
+copy ..\src\google\protobuf\stubs\stringpiece.h include\google\protobuf\stubs\stringpiece.h
+copy ..\src\google\protobuf\allocation_profiler.h include\google\protobuf\allocation_profiler.h
+copy ..\src\google\protobuf\columnar.h include\google\protobuf\columnar.h
 copy ..\src\google\protobuf\descriptor.h include\google\protobuf\descriptor.h
 copy ..\src\google\protobuf\descriptor.pb.h include\google\protobuf\descriptor.pb.h
 copy ..\src\google\protobuf\descriptor_database.h include\google\protobuf\descriptor_database.h
@@ -16,16 +19,22 @@ copy ..\src\google\protobuf\dynamic_message.h include\google\protobuf\dynamic_me
 copy ..\src\google\protobuf\extension_set.h include\google\protobuf\extension_set.h
 copy ..\src\google\protobuf\generated_message_util.h include\google\protobuf\generated_message_util.h
 copy ..\src\google\protobuf\generated_message_reflection.h include\google\protobuf\generated_message_reflection.h
+copy ..\src\google\protobuf\map_field.h include\google\protobuf\map_field.h
 copy ..\src\google\protobuf\message.h include\google\protobuf\message.h
+copy ..\src\google\protobuf\message_batch.h include\google\protobuf\message_batch.h
 copy ..\src\google\protobuf\message_lite.h include\google\protobuf\message_lite.h
+copy ..\src\google\protobuf\message_profiler.h include\google\protobuf\message_profiler.h
 copy ..\src\google\protobuf\reflection_ops.h include\google\protobuf\reflection_ops.h
 copy ..\src\google\protobuf\repeated_field.h include\google\protobuf\repeated_field.h
+copy ..\src\google\protobuf\repeated_string_piece_field.h include\google\protobuf\repeated_string_piece_field.h
+copy ..\src\google\protobuf\slab_repeated_field.h include\google\protobuf\slab_repeated_field.h
 copy ..\src\google\protobuf\service.h include\google\protobuf\service.h
 copy ..\src\google\protobuf\text_format.h include\google\protobuf\text_format.h
 copy ..\src\google\protobuf\unknown_field_set.h include\google\protobuf\unknown_field_set.h
 copy ..\src\google\protobuf\wire_format.h include\google\protobuf\wire_format.h
 copy ..\src\google\protobuf\wire_format_lite.h include\google\protobuf\wire_format_lite.h
 copy ..\src\google\protobuf\wire_format_lite_inl.h include\google\protobuf\wire_format_lite_inl.h
+copy ..\src\google\protobuf\wire_patch.h include\google\protobuf\wire_patch.h
 copy ..\src\google\protobuf\io\coded_stream.h include\google\protobuf\io\coded_stream.h
 copy ..\src\google\protobuf\io\gzip_stream.h include\google\protobuf\io\gzip_stream.h
 copy ..\src\google\protobuf\io\printer.h include\google\protobuf\io\printer.h